@@ -0,0 +1,1852 @@
+// ==================================================================
+// @(#)bench.c
+//
+// Generic Data Structures (libgds): benchmark application.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+// Usage: gds_bench [-n SIZE] [BENCH ...]
+//
+// Each benchmark is identified by "suite:name". When arguments are
+// given, only the benchmarks whose identifier starts with one of
+// them are run (e.g. "trie" or "radix-tree:bulk").
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <libgds/gds.h>
+#include <libgds/array.h>
+#include <libgds/assoc_array.h>
+#include <libgds/bit_vector.h>
+#include <libgds/bloom_blocked.h>
+#include <libgds/bloom_filter.h>
+#include <libgds/bloom_hash.h>
+#include <libgds/btree.h>
+#include <libgds/calendar_queue.h>
+#include <libgds/cuckoo_filter.h>
+#include <libgds/fifo.h>
+#include <libgds/fifo_mpmc.h>
+#include <libgds/fifo_spsc.h>
+#include <libgds/heap.h>
+#include <libgds/memory.h>
+#include <libgds/radix-tree.h>
+#include <libgds/sha1.h>
+#include <libgds/timer_wheel.h>
+#include <libgds/trie.h>
+#include <libgds/trie_dico.h>
+
+#define BENCH_DEFAULT_SIZE 1000000
+
+/** Benchmark function. The argument is the problem size. */
+typedef void (*bench_f)(unsigned int size);
+
+typedef struct {
+  const char * id;
+  bench_f      run;
+} bench_t;
+
+// -----[ _bench_time ]----------------------------------------------
+/**
+ * Return the current time in seconds.
+ */
+static double _bench_time()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec/1000000.0;
+}
+
+// -----[ _bench_report ]--------------------------------------------
+static void _bench_report(const char * what, unsigned int num_ops,
+			  double duration)
+{
+  printf("  %-32s %10u ops %9.3f s %12.0f ops/s\n",
+	 what, num_ops, duration,
+	 (duration > 0)?num_ops/duration:0);
+}
+
+// -----[ _bench_settle ]--------------------------------------------
+/**
+ * Let the allocator process the memory freed by a run before the
+ * next one is timed. The glibc allocator merges the small chunks
+ * that were freed only at the next large allocation: a run that
+ * follows the destruction of a large structure would otherwise be
+ * charged for it.
+ */
+static void _bench_settle()
+{
+  volatile char * block= (volatile char *) MALLOC(1 << 20);
+  block[0]= 0;
+  FREE((void *) block);
+}
+
+// -----[ _bench_mix ]-----------------------------------------------
+/**
+ * Bijective mixing of a 32-bit integer. Used to generate distinct
+ * pseudo-random keys from a sequence number.
+ */
+static inline uint32_t _bench_mix(uint32_t x)
+{
+  x^= x >> 16;
+  x*= 0x7feb352dU;
+  x^= x >> 15;
+  x*= 0x846ca68bU;
+  x^= x >> 16;
+  return x;
+}
+
+// -----[ _bench_shuffle ]-------------------------------------------
+static void _bench_shuffle(void * array, size_t num, size_t size)
+{
+  char tmp[64];
+  char * base= (char *) array;
+  size_t index, other;
+
+  for (index= num; index > 1; index--) {
+    other= random() % index;
+    memcpy(tmp, base+(index-1)*size, size);
+    memcpy(base+(index-1)*size, base+other*size, size);
+    memcpy(base+other*size, tmp, size);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// TRIE / RADIX-TREE / TRIE-DICO LOADING
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _bench_prefixes ]------------------------------------------
+/**
+ * Generate 'size' distinct prefixes in increasing key order. Prefix
+ * lengths range from 16 to 32, with a majority of /24 as in a
+ * routing table.
+ */
+static gds_trie_bulk_item_t * _bench_prefixes(unsigned int size)
+{
+  gds_trie_bulk_item_t * items= (gds_trie_bulk_item_t *)
+    MALLOC(size*sizeof(gds_trie_bulk_item_t));
+  gds_trie_t * trie= trie_create(NULL);
+  unsigned int index= 0, seq= 0;
+  trie_key_len_t key_len;
+  uint32_t key;
+
+  while (index < size) {
+    key= _bench_mix(seq++);
+    key_len= (key % 4 != 0)?24:16+(key % 17);
+    key&= ~((uint32_t) 0) << (32-key_len);
+    if (trie_insert(trie, key, key_len, NULL, 0) != TRIE_SUCCESS)
+      continue;
+    items[index].key= key;
+    items[index].key_len= key_len;
+    items[index].data= (void *) (size_t) (index+1);
+    index++;
+  }
+  trie_destroy(&trie);
+  return items;
+}
+
+// -----[ _bench_prefixes_sort_cb ]----------------------------------
+static int _bench_prefixes_sort_cb(const void * item1, const void * item2)
+{
+  const gds_trie_bulk_item_t * i1= (const gds_trie_bulk_item_t *) item1;
+  const gds_trie_bulk_item_t * i2= (const gds_trie_bulk_item_t *) item2;
+  if (i1->key != i2->key)
+    return (i1->key < i2->key)?-1:1;
+  return (int) i1->key_len - (int) i2->key_len;
+}
+
+// -----[ bench_trie_load ]------------------------------------------
+static void bench_trie_load(unsigned int size)
+{
+  gds_trie_bulk_item_t * items= _bench_prefixes(size);
+  gds_trie_t * trie;
+  unsigned int index;
+  double start;
+
+  trie= trie_create(NULL);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    trie_insert(trie, items[index].key, items[index].key_len,
+		items[index].data, 0);
+  _bench_report("trie_insert (random order)", size, _bench_time()-start);
+  trie_destroy(&trie);
+  _bench_settle();
+
+  trie= trie_create(NULL);
+  start= _bench_time();
+  trie_bulk_load(trie, items, size);
+  _bench_report("trie_bulk_load (unsorted)", size, _bench_time()-start);
+  trie_destroy(&trie);
+  _bench_settle();
+
+  qsort(items, size, sizeof(gds_trie_bulk_item_t), _bench_prefixes_sort_cb);
+  trie= trie_create(NULL);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    trie_insert(trie, items[index].key, items[index].key_len,
+		items[index].data, 0);
+  _bench_report("trie_insert (sorted)", size, _bench_time()-start);
+  trie_destroy(&trie);
+  _bench_settle();
+
+  trie= trie_create(NULL);
+  start= _bench_time();
+  trie_bulk_load(trie, items, size);
+  _bench_report("trie_bulk_load (sorted)", size, _bench_time()-start);
+  trie_destroy(&trie);
+
+  FREE(items);
+}
+
+// -----[ bench_radix_tree_load ]------------------------------------
+static void bench_radix_tree_load(unsigned int size)
+{
+  gds_trie_bulk_item_t * prefixes= _bench_prefixes(size);
+  gds_radix_tree_bulk_item_t * items= (gds_radix_tree_bulk_item_t *)
+    MALLOC(size*sizeof(gds_radix_tree_bulk_item_t));
+  gds_radix_tree_t * tree;
+  unsigned int index;
+  double start;
+
+  for (index= 0; index < size; index++) {
+    items[index].key= prefixes[index].key;
+    items[index].key_len= prefixes[index].key_len;
+    items[index].data= prefixes[index].data;
+  }
+  FREE(prefixes);
+
+  tree= radix_tree_create(32, NULL);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    radix_tree_add(tree, items[index].key, items[index].key_len,
+		   items[index].data);
+  _bench_report("radix_tree_add (random order)", size, _bench_time()-start);
+  radix_tree_destroy(&tree);
+  _bench_settle();
+
+  tree= radix_tree_create(32, NULL);
+  start= _bench_time();
+  radix_tree_bulk_load(tree, items, size);
+  _bench_report("radix_tree_bulk_load (unsorted)", size,
+		_bench_time()-start);
+  radix_tree_destroy(&tree);
+  _bench_settle();
+
+  qsort(items, size, sizeof(gds_radix_tree_bulk_item_t),
+	_bench_prefixes_sort_cb);
+  tree= radix_tree_create(32, NULL);
+  start= _bench_time();
+  radix_tree_bulk_load(tree, items, size);
+  _bench_report("radix_tree_bulk_load (sorted)", size, _bench_time()-start);
+  radix_tree_destroy(&tree);
+
+  FREE(items);
+}
+
+// -----[ _bench_dico_sort_cb ]--------------------------------------
+static int _bench_dico_sort_cb(const void * item1, const void * item2)
+{
+  return strcmp(((const gds_trie_dico_bulk_item_t *) item1)->key,
+		((const gds_trie_dico_bulk_item_t *) item2)->key);
+}
+
+// -----[ bench_trie_dico_load ]-------------------------------------
+/**
+ * Keys are community-like strings "as<N>:<M>" that share long
+ * prefixes.
+ */
+static void bench_trie_dico_load(unsigned int size)
+{
+  gds_trie_dico_bulk_item_t * items= (gds_trie_dico_bulk_item_t *)
+    MALLOC(size*sizeof(gds_trie_dico_bulk_item_t));
+  char * keys= (char *) MALLOC(size*24);
+  char * sorted_keys;
+  gds_trie_dico_t * dico;
+  unsigned int index;
+  uint32_t value;
+  double start;
+
+  for (index= 0; index < size; index++) {
+    value= _bench_mix(index);
+    snprintf(keys+index*24, 24, "as%u:%u", value % 65536, index);
+    items[index].key= keys+index*24;
+    items[index].data= (void *) (size_t) (index+1);
+  }
+  _bench_shuffle(items, size, sizeof(gds_trie_dico_bulk_item_t));
+
+  dico= trie_dico_create(NULL);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    trie_dico_insert(dico, items[index].key, items[index].data, 0);
+  _bench_report("trie_dico_insert (random order)", size,
+		_bench_time()-start);
+  trie_dico_destroy(&dico);
+  _bench_settle();
+
+  dico= trie_dico_create(NULL);
+  start= _bench_time();
+  trie_dico_bulk_load(dico, items, size);
+  _bench_report("trie_dico_bulk_load (unsorted)", size,
+		_bench_time()-start);
+  trie_dico_destroy(&dico);
+  _bench_settle();
+
+  // Sorted input, with keys stored in order as in a sorted file
+  qsort(items, size, sizeof(gds_trie_dico_bulk_item_t), _bench_dico_sort_cb);
+  sorted_keys= (char *) MALLOC(size*24);
+  for (index= 0; index < size; index++) {
+    strcpy(sorted_keys+index*24, items[index].key);
+    items[index].key= sorted_keys+index*24;
+  }
+  dico= trie_dico_create(NULL);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    trie_dico_insert(dico, items[index].key, items[index].data, 0);
+  _bench_report("trie_dico_insert (sorted)", size, _bench_time()-start);
+  trie_dico_destroy(&dico);
+  _bench_settle();
+
+  dico= trie_dico_create(NULL);
+  start= _bench_time();
+  trie_dico_bulk_load(dico, items, size);
+  _bench_report("trie_dico_bulk_load (sorted)", size, _bench_time()-start);
+  trie_dico_destroy(&dico);
+
+  FREE(sorted_keys);
+  FREE(keys);
+  FREE(items);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// BIT VECTOR
+//
+/////////////////////////////////////////////////////////////////////
+
+#define BENCH_BIT_VECTOR_ROUNDS 20
+
+// -----[ bench_bit_vector_ops ]-------------------------------------
+/**
+ * Whole-vector operations on two vectors of 64.size bits, with the
+ * generic and the SIMD kernels. Throughput is in 64-bit words.
+ */
+static void bench_bit_vector_ops(unsigned int size)
+{
+  unsigned int num_bits= (size > (MAX_UINT32_T >> 6))?MAX_UINT32_T:size*64;
+  gds_bit_vector_t * bv1= bit_vector_create(num_bits);
+  gds_bit_vector_t * bv2= bit_vector_create(num_bits);
+  gds_bit_vector_t * res= bit_vector_create(num_bits);
+  gds_bit_vector_t * copy;
+  unsigned int index, round, count, total= 0;
+  int simd;
+  double start;
+
+  for (index= 0; index < num_bits; index+= 3) {
+    bit_vector_set(bv1, _bench_mix(index) % num_bits);
+    bit_vector_set(bv2, _bench_mix(index+1) % num_bits);
+  }
+  copy= bit_vector_copy(bv1);
+
+  for (simd= 0; simd <= 1; simd++) {
+    if (bit_vector_use_simd(simd) != simd) {
+      printf("  (SIMD kernels not available)\n");
+      break;
+    }
+    printf("  %s kernels\n", simd?"SIMD":"generic");
+    start= _bench_time();
+    for (round= 0; round < BENCH_BIT_VECTOR_ROUNDS; round++)
+      bit_vector_and_to(res, bv1, bv2);
+    _bench_report("bit_vector_and_to", size*BENCH_BIT_VECTOR_ROUNDS,
+		  _bench_time()-start);
+    start= _bench_time();
+    for (round= 0; round < BENCH_BIT_VECTOR_ROUNDS; round++)
+      bit_vector_or(res, bv2);
+    _bench_report("bit_vector_or", size*BENCH_BIT_VECTOR_ROUNDS,
+		  _bench_time()-start);
+    start= _bench_time();
+    for (round= 0; round < BENCH_BIT_VECTOR_ROUNDS; round++)
+      total+= bit_vector_popcount(bv1);
+    _bench_report("bit_vector_popcount", size*BENCH_BIT_VECTOR_ROUNDS,
+		  _bench_time()-start);
+    start= _bench_time();
+    for (round= 0; round < BENCH_BIT_VECTOR_ROUNDS; round++) {
+      bit_vector_and_count(bv1, bv2, &count);
+      total+= count;
+    }
+    _bench_report("bit_vector_and_count", size*BENCH_BIT_VECTOR_ROUNDS,
+		  _bench_time()-start);
+    start= _bench_time();
+    for (round= 0; round < BENCH_BIT_VECTOR_ROUNDS; round++)
+      total+= bit_vector_equals(bv1, copy);
+    _bench_report("bit_vector_equals", size*BENCH_BIT_VECTOR_ROUNDS,
+		  _bench_time()-start);
+  }
+  bit_vector_use_simd(1);
+  if (total == 0)
+    printf("  (unlikely checksum)\n");
+
+  bit_vector_destroy(&bv1);
+  bit_vector_destroy(&bv2);
+  bit_vector_destroy(&res);
+  bit_vector_destroy(&copy);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// BLOOM FILTER
+//
+/////////////////////////////////////////////////////////////////////
+
+#define BENCH_BLOOM_NUM_HASHES 7
+
+// -----[ _bench_bloom_hash ]----------------------------------------
+static void _bench_bloom_hash(const char * what, uint8_t mode,
+			      const char * keys, unsigned int size)
+{
+  SBloomFilterHash * hash;
+  uint32_t indices[BENCH_BLOOM_NUM_HASHES];
+  uint32_t sum= 0;
+  unsigned int index;
+  double start;
+
+  hash= bloom_hash_create_mode(size*10, BENCH_BLOOM_NUM_HASHES, mode);
+  start= _bench_time();
+  for (index= 0; index < size; index++) {
+    bloom_hash_get_indices(hash, (const uint8_t *) keys+index*16,
+			   strlen(keys+index*16), indices);
+    sum+= indices[0];
+  }
+  _bench_report(what, size, _bench_time()-start);
+  bloom_hash_destroy(&hash);
+  if (sum == 0)
+    printf("  (unlikely checksum)\n");
+}
+
+// -----[ bench_bloom_filter_hash ]----------------------------------
+/**
+ * Index generation and filter operations with 10 bits per key and
+ * 7 hash functions.
+ */
+static void bench_bloom_filter_hash(unsigned int size)
+{
+  char * keys= (char *) MALLOC(size*16);
+  SBloomFilter * filter;
+  unsigned int index, num_found= 0;
+  double start;
+
+  for (index= 0; index < size; index++)
+    snprintf(keys+index*16, 16, "key-%u", _bench_mix(index));
+
+  _bench_bloom_hash("bloom_hash (double hashing)", BLOOM_HASH_DOUBLE,
+		    keys, size);
+  _bench_bloom_hash("bloom_hash (sha1)", BLOOM_HASH_SHA1, keys, size);
+
+  filter= bloom_filter_create(size*10, BENCH_BLOOM_NUM_HASHES);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    bloom_filter_add(filter, (uint8_t *) keys+index*16,
+		     strlen(keys+index*16));
+  _bench_report("bloom_filter_add", size, _bench_time()-start);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    num_found+= bloom_filter_is_member(filter, (uint8_t *) keys+index*16,
+				       strlen(keys+index*16));
+  _bench_report("bloom_filter_is_member", size, _bench_time()-start);
+  bloom_filter_destroy(&filter);
+  if (num_found != size)
+    printf("  error: %u keys not found\n", size-num_found);
+
+  FREE(keys);
+}
+
+// -----[ _bench_bloom_line ]----------------------------------------
+static void _bench_bloom_line(const char * what, unsigned int bits_per_key,
+			      unsigned int size, double add_time,
+			      double query_time, unsigned int num_fp)
+{
+  printf("  %-14s %2u bits/key %8.4f%% FP %12.0f add/s %12.0f query/s\n",
+	 what, bits_per_key, 100.0*num_fp/size,
+	 (add_time > 0)?size/add_time:0, (query_time > 0)?size/query_time:0);
+}
+
+// -----[ bench_bloom_filter_blocked ]-------------------------------
+/**
+ * False positive rate vs throughput of the blocked Bloom filter
+ * compared to SBloomFilter, for several bits per key. Each filter
+ * holds 'size' keys and is queried with 'size' other keys, so that
+ * the query time is that of (mostly) negative lookups.
+ */
+static void bench_bloom_filter_blocked(unsigned int size)
+{
+  static const unsigned int BITS_PER_KEY[]= { 8, 10, 16 };
+  static const unsigned int NUM_HASHES[]= { 6, 7, 11 };
+  char * keys= (char *) MALLOC(size*2*16);
+  char * others= keys+size*16;
+  SBloomFilter * filter;
+  gds_bloom_blocked_t * blocked;
+  unsigned int index, config, num_fp;
+  double start, add_time;
+
+  for (index= 0; index < size; index++) {
+    snprintf(keys+index*16, 16, "key-%u", _bench_mix(index));
+    snprintf(others+index*16, 16, "other-%u", _bench_mix(index));
+  }
+
+  for (config= 0; config < sizeof(BITS_PER_KEY)/sizeof(BITS_PER_KEY[0]);
+       config++) {
+    filter= bloom_filter_create(size*BITS_PER_KEY[config],
+				NUM_HASHES[config]);
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      bloom_filter_add(filter, (uint8_t *) keys+index*16,
+		       strlen(keys+index*16));
+    add_time= _bench_time()-start;
+    num_fp= 0;
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      num_fp+= bloom_filter_is_member(filter, (uint8_t *) others+index*16,
+				      strlen(others+index*16));
+    _bench_bloom_line("bloom_filter", BITS_PER_KEY[config], size,
+		      add_time, _bench_time()-start, num_fp);
+    bloom_filter_destroy(&filter);
+
+    blocked= bloom_blocked_create((uint64_t) size*BITS_PER_KEY[config],
+				  NUM_HASHES[config]);
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      bloom_blocked_add(blocked, (uint8_t *) keys+index*16,
+			strlen(keys+index*16));
+    add_time= _bench_time()-start;
+    num_fp= 0;
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      num_fp+= bloom_blocked_is_member(blocked, (uint8_t *) others+index*16,
+				       strlen(others+index*16));
+    _bench_bloom_line("bloom_blocked", BITS_PER_KEY[config], size,
+		      add_time, _bench_time()-start, num_fp);
+    bloom_blocked_destroy(&blocked);
+  }
+
+  FREE(keys);
+}
+
+// -----[ bench_bloom_filter_batch ]---------------------------------
+/**
+ * Membership of 'size' keys in a filter that holds 'size' keys, one
+ * at a time and by batches of 1024 keys. Queried keys alternate
+ * between members and non-members.
+ */
+static void bench_bloom_filter_batch(unsigned int size)
+{
+  const unsigned int batch= 1024;
+  char * keys= (char *) MALLOC(size*2*16);
+  uint8_t ** key_ptrs= (uint8_t **) MALLOC(size*2*sizeof(uint8_t *));
+  uint32_t * key_lens= (uint32_t *) MALLOC(size*2*sizeof(uint32_t));
+  uint8_t * results= (uint8_t *) MALLOC(batch);
+  SBloomFilter * filter;
+  unsigned int index, offset, num, num_found;
+  double start;
+
+  // Members are stored first, key i+size is a non-member
+  for (index= 0; index < size*2; index++)
+    snprintf(keys+index*16, 16, "key-%u", _bench_mix(index));
+  for (index= 0; index < size; index++) {
+    key_ptrs[index]= (uint8_t *) keys+index*16;
+    key_lens[index]= strlen(keys+index*16);
+  }
+
+  filter= bloom_filter_create_optimal(size, 0.01);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    bloom_filter_add(filter, key_ptrs[index], key_lens[index]);
+  _bench_report("bloom_filter_add", size, _bench_time()-start);
+  bloom_filter_destroy(&filter);
+
+  filter= bloom_filter_create_optimal(size, 0.01);
+  start= _bench_time();
+  for (offset= 0; offset < size; offset+= batch)
+    bloom_filter_add_batch(filter, key_ptrs+offset, key_lens+offset,
+			   (size-offset < batch)?size-offset:batch);
+  _bench_report("bloom_filter_add_batch", size, _bench_time()-start);
+
+  // Queries: member, non-member, member, ...
+  for (index= 0; index < size; index++) {
+    key_ptrs[size+index]= (uint8_t *) keys+
+      ((index & 1)?size+index:index)*16;
+    key_lens[size+index]= strlen((char *) key_ptrs[size+index]);
+  }
+  num_found= 0;
+  start= _bench_time();
+  for (index= size; index < size*2; index++)
+    num_found+= bloom_filter_is_member(filter, key_ptrs[index],
+				       key_lens[index]);
+  _bench_report("bloom_filter_is_member", size, _bench_time()-start);
+  printf("  (%u found)\n", num_found);
+
+  num_found= 0;
+  start= _bench_time();
+  for (offset= 0; offset < size; offset+= batch) {
+    num= (size-offset < batch)?size-offset:batch;
+    bloom_filter_is_member_batch(filter, key_ptrs+size+offset,
+				 key_lens+size+offset, num, results);
+    for (index= 0; index < num; index++)
+      num_found+= results[index];
+  }
+  _bench_report("bloom_filter_is_member_batch", size, _bench_time()-start);
+  printf("  (%u found)\n", num_found);
+  bloom_filter_destroy(&filter);
+
+  FREE(results);
+  FREE(key_lens);
+  FREE(key_ptrs);
+  FREE(keys);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// CUCKOO FILTER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _bench_cuckoo_line ]---------------------------------------
+static void _bench_cuckoo_line(const char * what, double bits_per_key,
+			       unsigned int size, double add_time,
+			       double query_time, double remove_time,
+			       unsigned int num_fp)
+{
+  printf("  %-14s %5.1f bits/key %8.4f%% FP %12.0f add/s %12.0f query/s",
+	 what, bits_per_key, 100.0*num_fp/size,
+	 (add_time > 0)?size/add_time:0, (query_time > 0)?size/query_time:0);
+  if (remove_time > 0)
+    printf(" %12.0f remove/s", size/remove_time);
+  printf("\n");
+}
+
+// -----[ bench_cuckoo_filter ]--------------------------------------
+/**
+ * Space, false positive rate and throughput of the cuckoo filter
+ * compared to SBloomFilter. For each fingerprint length, the Bloom
+ * filter gets the same number of bits as the cuckoo filter (and the
+ * optimal number of hashes for that size). Each filter holds 'size'
+ * keys and is queried with 'size' other keys.
+ */
+static void bench_cuckoo_filter(unsigned int size)
+{
+  static const unsigned int FP_BITS[]= { 8, 16 };
+  char * keys= (char *) MALLOC(size*2*16);
+  char * others= keys+size*16;
+  gds_cuckoo_filter_t * cuckoo;
+  gds_cuckoo_filter_stats_t stats;
+  SBloomFilter * filter;
+  unsigned int index, config, num_fp, num_hashes;
+  double start, add_time, query_time;
+
+  for (index= 0; index < size; index++) {
+    snprintf(keys+index*16, 16, "key-%u", _bench_mix(index));
+    snprintf(others+index*16, 16, "other-%u", _bench_mix(index));
+  }
+
+  for (config= 0; config < sizeof(FP_BITS)/sizeof(FP_BITS[0]); config++) {
+    cuckoo= cuckoo_filter_create(size, FP_BITS[config]);
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      if (cuckoo_filter_add(cuckoo, (uint8_t *) keys+index*16,
+			    strlen(keys+index*16)) < 0)
+	break;
+    add_time= _bench_time()-start;
+    if (index < size)
+      printf("  error: cuckoo filter full after %u keys\n", index);
+    num_fp= 0;
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      num_fp+= cuckoo_filter_is_member(cuckoo, (uint8_t *) others+index*16,
+				       strlen(others+index*16));
+    query_time= _bench_time()-start;
+    cuckoo_filter_stats(cuckoo, &stats);
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      cuckoo_filter_remove(cuckoo, (uint8_t *) keys+index*16,
+			   strlen(keys+index*16));
+    _bench_cuckoo_line("cuckoo_filter", stats.bits_per_item, size,
+		       add_time, query_time, _bench_time()-start, num_fp);
+    cuckoo_filter_destroy(&cuckoo);
+
+    num_hashes= (unsigned int) (stats.bits_per_item * 0.6931 + 0.5);
+    filter= bloom_filter_create((uint32_t) (stats.size*8), num_hashes);
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      bloom_filter_add(filter, (uint8_t *) keys+index*16,
+		       strlen(keys+index*16));
+    add_time= _bench_time()-start;
+    num_fp= 0;
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      num_fp+= bloom_filter_is_member(filter, (uint8_t *) others+index*16,
+				      strlen(others+index*16));
+    _bench_cuckoo_line("bloom_filter", stats.bits_per_item, size,
+		       add_time, _bench_time()-start, 0, num_fp);
+    bloom_filter_destroy(&filter);
+  }
+
+  FREE(keys);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// SHA-1
+//
+/////////////////////////////////////////////////////////////////////
+
+#define BENCH_SHA1_BYTES (64*1024*1024)
+
+// -----[ bench_sha1_batch ]-----------------------------------------
+/**
+ * Throughput of sha1_batch() with each implementation, by message
+ * size. The number of messages is 'size' (at most) and the total
+ * amount of data hashed per size is BENCH_SHA1_BYTES.
+ */
+static void bench_sha1_batch(unsigned int size)
+{
+  static const uint32_t MSG_SIZES[]= { 16, 64, 256, 1024, 4096 };
+  static const struct {
+    const char * name;
+    int          mask;
+  } IMPLS[]= {
+    { "scalar", 0 },
+    { "sse2 x4", SHA1_ACCEL_SSE2 },
+    { "avx2 x8", SHA1_ACCEL_SSE2 | SHA1_ACCEL_AVX2 },
+    { "sha-ni", SHA1_ACCEL_SHANI },
+  };
+  unsigned int num_msgs, index, impl, config, round, num_rounds;
+  const uint8_t ** inputs;
+  uint32_t * lengths;
+  uint8_t (* digests)[20];
+  uint8_t * data;
+  double start, duration;
+
+  num_msgs= (size < BENCH_SHA1_BYTES / 4096) ? size : BENCH_SHA1_BYTES / 4096;
+  data= (uint8_t *) MALLOC((size_t) num_msgs * 4096);
+  for (index= 0; index < num_msgs * 4096; index++)
+    data[index]= (uint8_t) _bench_mix(index);
+  inputs= (const uint8_t **) MALLOC(num_msgs * sizeof(uint8_t *));
+  lengths= (uint32_t *) MALLOC(num_msgs * sizeof(uint32_t));
+  digests= (uint8_t (*)[20]) MALLOC(num_msgs * 20);
+
+  for (config= 0; config < sizeof(MSG_SIZES)/sizeof(MSG_SIZES[0]);
+       config++) {
+    for (index= 0; index < num_msgs; index++) {
+      inputs[index]= data + (size_t) index * MSG_SIZES[config];
+      lengths[index]= MSG_SIZES[config];
+    }
+    num_rounds= BENCH_SHA1_BYTES / (num_msgs * MSG_SIZES[config]);
+    if (num_rounds == 0)
+      num_rounds= 1;
+    for (impl= 0; impl < sizeof(IMPLS)/sizeof(IMPLS[0]); impl++) {
+      if (sha1_use_accel(IMPLS[impl].mask) != IMPLS[impl].mask) {
+	printf("  %4u bytes %-8s not supported\n", MSG_SIZES[config],
+	       IMPLS[impl].name);
+	continue;
+      }
+      start= _bench_time();
+      for (round= 0; round < num_rounds; round++)
+	sha1_batch(inputs, lengths, num_msgs, digests);
+      duration= _bench_time()-start;
+      printf("  %4u bytes %-8s %12.0f msg/s %8.1f MB/s\n",
+	     MSG_SIZES[config], IMPLS[impl].name,
+	     (duration > 0)?num_rounds*(double)num_msgs/duration:0,
+	     (duration > 0)?num_rounds*(double)num_msgs*MSG_SIZES[config]/
+	     duration/1e6:0);
+    }
+  }
+  sha1_use_accel(SHA1_ACCEL_ALL);
+
+  FREE(digests);
+  FREE(lengths);
+  FREE(inputs);
+  FREE(data);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// FIFO
+//
+/////////////////////////////////////////////////////////////////////
+
+#define BENCH_FIFO_CAPACITY 1024
+#define BENCH_FIFO_BATCH    32
+
+/**
+ * Queue shared by two threads: either a gds_fifo_t protected by a
+ * mutex or a lock-free SPSC queue, used one item at a time or by
+ * batches of BENCH_FIFO_BATCH items.
+ */
+typedef struct {
+  const char      * name;
+  int               batch;
+  gds_fifo_t      * fifo;
+  pthread_mutex_t   lock;
+  gds_fifo_spsc_t * spsc;
+} _bench_queue_t;
+
+typedef struct {
+  _bench_queue_t * queues[2];
+  unsigned int     num_items;
+} _bench_fifo_ctx_t;
+
+// -----[ _bench_queue_init ]----------------------------------------
+static void _bench_queue_init(_bench_queue_t * queue, unsigned int kind)
+{
+  static const char * NAMES[]= { "mutex fifo", "spsc", "spsc batch" };
+  memset(queue, 0, sizeof(_bench_queue_t));
+  queue->name= NAMES[kind];
+  if (kind == 0) {
+    queue->fifo= fifo_create(BENCH_FIFO_CAPACITY, NULL);
+    pthread_mutex_init(&queue->lock, NULL);
+  } else {
+    queue->spsc= fifo_spsc_create(BENCH_FIFO_CAPACITY, NULL);
+    queue->batch= (kind == 2);
+  }
+}
+
+// -----[ _bench_queue_done ]----------------------------------------
+static void _bench_queue_done(_bench_queue_t * queue)
+{
+  if (queue->fifo != NULL) {
+    fifo_destroy(&queue->fifo);
+    pthread_mutex_destroy(&queue->lock);
+  }
+  fifo_spsc_destroy(&queue->spsc);
+}
+
+// -----[ _bench_queue_push ]----------------------------------------
+/**
+ * Push up to num_items items. Yield the processor if the queue is
+ * full. Return the number of items pushed.
+ */
+static unsigned int _bench_queue_push(_bench_queue_t * queue,
+				      void ** items, unsigned int num_items)
+{
+  unsigned int num= 0;
+  int result;
+
+  if (queue->fifo != NULL) {
+    pthread_mutex_lock(&queue->lock);
+    result= fifo_push(queue->fifo, items[0]);
+    pthread_mutex_unlock(&queue->lock);
+    num= (result == 0)?1:0;
+  } else if (queue->batch)
+    num= fifo_spsc_push_n(queue->spsc, items, num_items);
+  else if (fifo_spsc_push(queue->spsc, items[0]) == 0)
+    num= 1;
+  if (num == 0)
+    sched_yield();
+  return num;
+}
+
+// -----[ _bench_queue_pop ]-----------------------------------------
+static unsigned int _bench_queue_pop(_bench_queue_t * queue,
+				     void ** items, unsigned int num_items)
+{
+  unsigned int num= 0;
+
+  if (queue->fifo != NULL) {
+    pthread_mutex_lock(&queue->lock);
+    if (fifo_depth(queue->fifo) > 0) {
+      items[0]= fifo_pop(queue->fifo);
+      num= 1;
+    }
+    pthread_mutex_unlock(&queue->lock);
+  } else if (queue->batch)
+    num= fifo_spsc_pop_n(queue->spsc, items, num_items);
+  else if (fifo_spsc_pop(queue->spsc, &items[0]) == 0)
+    num= 1;
+  if (num == 0)
+    sched_yield();
+  return num;
+}
+
+// -----[ _bench_fifo_producer ]-------------------------------------
+static void * _bench_fifo_producer(void * ctx)
+{
+  _bench_fifo_ctx_t * fctx= (_bench_fifo_ctx_t *) ctx;
+  void * items[BENCH_FIFO_BATCH];
+  unsigned int index, num, next= 0;
+
+  while (next < fctx->num_items) {
+    num= fctx->num_items - next;
+    if (num > BENCH_FIFO_BATCH)
+      num= BENCH_FIFO_BATCH;
+    for (index= 0; index < num; index++)
+      items[index]= (void *) (size_t) (next+index);
+    // Do not lose the items that could not be pushed
+    index= 0;
+    while (index < num)
+      index+= _bench_queue_push(fctx->queues[0], items+index, num-index);
+    next+= num;
+  }
+  return NULL;
+}
+
+// -----[ _bench_fifo_echo ]-----------------------------------------
+/**
+ * Send back every item received (latency measurement).
+ */
+static void * _bench_fifo_echo(void * ctx)
+{
+  _bench_fifo_ctx_t * fctx= (_bench_fifo_ctx_t *) ctx;
+  unsigned int index;
+  void * item;
+
+  for (index= 0; index < fctx->num_items; index++) {
+    while (_bench_queue_pop(fctx->queues[0], &item, 1) == 0)
+      ;
+    while (_bench_queue_push(fctx->queues[1], &item, 1) == 0)
+      ;
+  }
+  return NULL;
+}
+
+// -----[ bench_fifo_spsc ]------------------------------------------
+/**
+ * Throughput of a transfer of 'size' items from a producer thread
+ * to a consumer thread, then round-trip latency between two
+ * threads, for a mutex-protected gds_fifo_t and for the SPSC queue.
+ */
+static void bench_fifo_spsc(unsigned int size)
+{
+  _bench_queue_t queues[2];
+  _bench_fifo_ctx_t ctx;
+  void * items[BENCH_FIFO_BATCH];
+  unsigned int kind, index, received;
+  pthread_t thread;
+  size_t sum, expected;
+  double start, duration;
+
+  expected= ((size_t) size)*(size-1)/2;
+  for (kind= 0; kind < 3; kind++) {
+    _bench_queue_init(&queues[0], kind);
+    ctx.queues[0]= &queues[0];
+    ctx.num_items= size;
+    start= _bench_time();
+    pthread_create(&thread, NULL, _bench_fifo_producer, &ctx);
+    sum= 0;
+    for (received= 0; received < size; )
+      for (index= _bench_queue_pop(&queues[0], items, BENCH_FIFO_BATCH);
+	   index > 0; index--, received++)
+	sum+= (size_t) items[index-1];
+    pthread_join(thread, NULL);
+    duration= _bench_time()-start;
+    _bench_report(queues[0].name, size, duration);
+    if (sum != expected)
+      printf("  error: incorrect items received\n");
+    _bench_queue_done(&queues[0]);
+  }
+
+  ctx.num_items= size / 20;
+  for (kind= 0; kind < 2; kind++) {
+    _bench_queue_init(&queues[0], kind);
+    _bench_queue_init(&queues[1], kind);
+    ctx.queues[0]= &queues[0];
+    ctx.queues[1]= &queues[1];
+    start= _bench_time();
+    pthread_create(&thread, NULL, _bench_fifo_echo, &ctx);
+    for (index= 0; index < ctx.num_items; index++) {
+      items[0]= (void *) (size_t) index;
+      while (_bench_queue_push(&queues[0], items, 1) == 0)
+	;
+      while (_bench_queue_pop(&queues[1], items, 1) == 0)
+	;
+    }
+    pthread_join(thread, NULL);
+    duration= _bench_time()-start;
+    printf("  %-32s %10u rtt %9.3f s %12.0f ns/rtt\n",
+	   queues[0].name, ctx.num_items, duration,
+	   (ctx.num_items > 0)?duration*1e9/ctx.num_items:0);
+    _bench_queue_done(&queues[0]);
+    _bench_queue_done(&queues[1]);
+  }
+}
+
+#define BENCH_MPMC_MAX_THREADS 4
+
+typedef struct {
+  unsigned int      kind;
+  gds_fifo_t      * fifo;
+  pthread_mutex_t * lock;
+  gds_fifo_mpmc_t * mpmc;
+  unsigned int      num_items;
+  unsigned int    * claimed;
+  size_t            sum;
+} _bench_mpmc_ctx_t;
+
+// -----[ _bench_mpmc_producer ]-------------------------------------
+static void * _bench_mpmc_producer(void * arg)
+{
+  _bench_mpmc_ctx_t * ctx= (_bench_mpmc_ctx_t *) arg;
+  unsigned int index;
+  int result;
+
+  for (index= 0; index < ctx->num_items; index++) {
+    switch (ctx->kind) {
+    case 0:
+      do {
+	pthread_mutex_lock(ctx->lock);
+	result= fifo_push(ctx->fifo, (void *) (size_t) index);
+	pthread_mutex_unlock(ctx->lock);
+	if (result != 0)
+	  sched_yield();
+      } while (result != 0);
+      break;
+    case 1:
+      while (fifo_mpmc_try_push(ctx->mpmc, (void *) (size_t) index) < 0)
+	sched_yield();
+      break;
+    default:
+      fifo_mpmc_push(ctx->mpmc, (void *) (size_t) index);
+    }
+  }
+  return NULL;
+}
+
+// -----[ _bench_mpmc_consumer ]-------------------------------------
+static void * _bench_mpmc_consumer(void * arg)
+{
+  _bench_mpmc_ctx_t * ctx= (_bench_mpmc_ctx_t *) arg;
+  void * item= NULL;
+
+  ctx->sum= 0;
+  while (__atomic_fetch_add(ctx->claimed, 1, __ATOMIC_RELAXED) <
+	 ctx->num_items) {
+    switch (ctx->kind) {
+    case 0:
+      for (;;) {
+	pthread_mutex_lock(ctx->lock);
+	if (fifo_depth(ctx->fifo) > 0) {
+	  item= fifo_pop(ctx->fifo);
+	  pthread_mutex_unlock(ctx->lock);
+	  break;
+	}
+	pthread_mutex_unlock(ctx->lock);
+	sched_yield();
+      }
+      break;
+    case 1:
+      while (fifo_mpmc_try_pop(ctx->mpmc, &item) < 0)
+	sched_yield();
+      break;
+    default:
+      item= fifo_mpmc_pop(ctx->mpmc);
+    }
+    ctx->sum+= (size_t) item;
+  }
+  return NULL;
+}
+
+// -----[ bench_fifo_mpmc ]------------------------------------------
+/**
+ * Throughput of a transfer of 'size' items from N producer threads
+ * to N consumer threads, for a mutex-protected gds_fifo_t and for
+ * the MPMC queue (non-blocking with sched_yield() or blocking).
+ */
+static void bench_fifo_mpmc(unsigned int size)
+{
+  static const char * NAMES[]= { "mutex fifo", "mpmc try", "mpmc blocking" };
+  _bench_mpmc_ctx_t producers[BENCH_MPMC_MAX_THREADS];
+  _bench_mpmc_ctx_t consumers[BENCH_MPMC_MAX_THREADS];
+  pthread_t threads[2*BENCH_MPMC_MAX_THREADS];
+  pthread_mutex_t lock;
+  gds_fifo_t * fifo;
+  gds_fifo_mpmc_t * mpmc;
+  unsigned int kind, num_threads, index, claimed;
+  size_t sum, expected;
+  double start, duration;
+  char what[64];
+
+  for (num_threads= 1; num_threads <= BENCH_MPMC_MAX_THREADS;
+       num_threads*= 2) {
+    expected= num_threads *
+      (((size_t) size / num_threads)*(size / num_threads - 1)/2);
+    for (kind= 0; kind < 3; kind++) {
+      fifo= fifo_create(BENCH_FIFO_CAPACITY, NULL);
+      pthread_mutex_init(&lock, NULL);
+      mpmc= fifo_mpmc_create(BENCH_FIFO_CAPACITY, NULL);
+      claimed= 0;
+      start= _bench_time();
+      for (index= 0; index < num_threads; index++) {
+	consumers[index].kind= producers[index].kind= kind;
+	consumers[index].fifo= producers[index].fifo= fifo;
+	consumers[index].lock= producers[index].lock= &lock;
+	consumers[index].mpmc= producers[index].mpmc= mpmc;
+	producers[index].num_items= size / num_threads;
+	consumers[index].num_items= num_threads * (size / num_threads);
+	consumers[index].claimed= &claimed;
+	pthread_create(&threads[index], NULL, _bench_mpmc_consumer,
+		       &consumers[index]);
+	pthread_create(&threads[num_threads+index], NULL,
+		       _bench_mpmc_producer, &producers[index]);
+      }
+      sum= 0;
+      for (index= 0; index < num_threads; index++) {
+	pthread_join(threads[index], NULL);
+	pthread_join(threads[num_threads+index], NULL);
+	sum+= consumers[index].sum;
+      }
+      duration= _bench_time()-start;
+      snprintf(what, sizeof(what), "%s %ux%u", NAMES[kind],
+	       num_threads, num_threads);
+      _bench_report(what, num_threads * (size / num_threads), duration);
+      if (sum != expected)
+	printf("  error: incorrect items received\n");
+      fifo_mpmc_destroy(&mpmc);
+      pthread_mutex_destroy(&lock);
+      fifo_destroy(&fifo);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// HEAP
+//
+/////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  uint32_t time;
+  uint32_t seq;   /* tie-breaker, events are distinct */
+} _bench_event_t;
+
+// -----[ _bench_event_cmp ]-----------------------------------------
+static inline int _bench_event_cmp(const _bench_event_t * e1,
+				   const _bench_event_t * e2)
+{
+  if (e1->time != e2->time)
+    return (e1->time < e2->time)?-1:1;
+  if (e1->seq != e2->seq)
+    return (e1->seq < e2->seq)?-1:1;
+  return 0;
+}
+
+// -----[ _bench_heap_cmp ]------------------------------------------
+static int _bench_heap_cmp(const void * item1, const void * item2)
+{
+  return _bench_event_cmp((const _bench_event_t *) item1,
+			  (const _bench_event_t *) item2);
+}
+
+// -----[ _bench_array_cmp ]-----------------------------------------
+static int _bench_array_cmp(const void * item1, const void * item2,
+			    unsigned int item_size)
+{
+  return _bench_event_cmp(*((_bench_event_t * const *) item1),
+			  *((_bench_event_t * const *) item2));
+}
+
+// -----[ bench_heap_events ]----------------------------------------
+/**
+ * Discrete-event scheduling ("hold" model): with N pending events,
+ * repeatedly remove the earliest event and schedule a new one at a
+ * random time in the future. Compare a sorted ptr_array_t with the
+ * heap. Also measure the construction of the heap (insertions or
+ * heap_build()) and random decrease-key operations.
+ */
+static void bench_heap_events(unsigned int size)
+{
+  static const unsigned int PENDING[]= { 1000, 10000, 100000 };
+  unsigned int config, num_pending, num_ops, num_array_ops, index, seq;
+  _bench_event_t * events, * event;
+  gds_heap_handle_t * handles;
+  void ** items;
+  ptr_array_t * array;
+  gds_heap_t * heap;
+  double start, duration;
+  char what[64];
+
+  num_ops= size/10;
+  for (config= 0; config < sizeof(PENDING)/sizeof(PENDING[0]); config++) {
+    num_pending= PENDING[config];
+    events= (_bench_event_t *) MALLOC(num_pending*sizeof(_bench_event_t));
+    handles= (gds_heap_handle_t *)
+      MALLOC(num_pending*sizeof(gds_heap_handle_t));
+    items= (void **) MALLOC(num_pending*sizeof(void *));
+
+    // Sorted array
+    array= ptr_array_create(ARRAY_OPTION_SORTED, _bench_array_cmp,
+			    NULL, NULL);
+    for (seq= 0; seq < num_pending; seq++) {
+      events[seq].time= _bench_mix(seq) % 1000000;
+      events[seq].seq= seq;
+      event= &events[seq];
+      ptr_array_add(array, &event);
+    }
+    // Each operation is linear: limit the running time
+    num_array_ops= num_ops / (num_pending / 1000);
+    start= _bench_time();
+    for (index= 0; index < num_array_ops; index++, seq++) {
+      ptr_array_get_at(array, 0, &event);
+      ptr_array_remove_at(array, 0);
+      event->time+= 1 + _bench_mix(seq) % 1000000;
+      event->seq= seq;
+      ptr_array_add(array, &event);
+    }
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "sorted array hold (n=%u)", num_pending);
+    _bench_report(what, num_array_ops, duration);
+    ptr_array_destroy(&array);
+
+    // Heap, built by successive insertions
+    heap= heap_create(0, _bench_heap_cmp, NULL);
+    for (seq= 0; seq < num_pending; seq++) {
+      events[seq].time= _bench_mix(seq) % 1000000;
+      events[seq].seq= seq;
+    }
+    start= _bench_time();
+    for (index= 0; index < num_pending; index++)
+      handles[index]= heap_insert(heap, &events[index]);
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "heap insert (n=%u)", num_pending);
+    _bench_report(what, num_pending, duration);
+    start= _bench_time();
+    for (index= 0; index < num_ops; index++, seq++) {
+      event= (_bench_event_t *) heap_pop(heap);
+      event->time+= 1 + _bench_mix(seq) % 1000000;
+      event->seq= seq;
+      handles[event-events]= heap_insert(heap, event);
+    }
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "heap hold (n=%u)", num_pending);
+    _bench_report(what, num_ops, duration);
+
+    // Decrease-key on random events
+    start= _bench_time();
+    for (index= 0; index < num_ops; index++, seq++) {
+      event= &events[_bench_mix(seq) % num_pending];
+      event->time-= event->time / 4;
+      heap_update(heap, handles[event-events]);
+    }
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "heap decrease-key (n=%u)", num_pending);
+    _bench_report(what, num_ops, duration);
+    heap_destroy(&heap);
+
+    // Heap, built at once
+    heap= heap_create(num_pending, _bench_heap_cmp, NULL);
+    for (index= 0; index < num_pending; index++)
+      items[index]= &events[index];
+    start= _bench_time();
+    heap_build(heap, items, num_pending, handles);
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "heap build (n=%u)", num_pending);
+    _bench_report(what, num_pending, duration);
+    heap_destroy(&heap);
+
+    FREE(items);
+    FREE(handles);
+    FREE(events);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// TIMER WHEEL
+//
+/////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  gds_timer_t timer;
+} _bench_timer_t;
+
+typedef struct {
+  gds_timer_wheel_t * wheel;
+  uint64_t            now;
+  uint32_t            seq;
+} _bench_timer_ctx_t;
+
+// -----[ _bench_timer_fire ]----------------------------------------
+static void _bench_timer_fire(gds_timer_t * timer, void * ctx)
+{
+  _bench_timer_ctx_t * bench= (_bench_timer_ctx_t *) ctx;
+
+  timer_wheel_schedule(bench->wheel, timer,
+		       bench->now + 1 + _bench_mix(bench->seq++) % 1000000);
+}
+
+// -----[ bench_timer_wheel_events ]---------------------------------
+/**
+ * Discrete-event scheduling ("hold" model, see bench_heap_events())
+ * with the heap, the timing wheel (integer times, tick of 1) and the
+ * calendar queue (floating-point times). The wheel is advanced by
+ * steps of about the average interval between events, and each
+ * expired timer is scheduled again. Also measure the scheduling and
+ * cancellation of timers.
+ */
+static void bench_timer_wheel_events(unsigned int size)
+{
+  static const unsigned int PENDING[]= { 1000, 100000, 1000000 };
+  unsigned int config, num_pending, num_ops, index;
+  uint64_t num_fired, step;
+  _bench_event_t * events, * event;
+  _bench_timer_t * timers;
+  gds_calendar_event_t * cevents, * cevent;
+  _bench_timer_ctx_t ctx;
+  gds_calendar_queue_t * queue;
+  gds_heap_t * heap;
+  double start, duration;
+  uint32_t seq;
+  char what[64];
+
+  num_ops= size/10;
+  for (config= 0; config < sizeof(PENDING)/sizeof(PENDING[0]); config++) {
+    num_pending= PENDING[config];
+
+    // Heap
+    events= (_bench_event_t *) MALLOC(num_pending*sizeof(_bench_event_t));
+    heap= heap_create(num_pending, _bench_heap_cmp, NULL);
+    for (seq= 0; seq < num_pending; seq++) {
+      events[seq].time= _bench_mix(seq) % 1000000;
+      events[seq].seq= seq;
+      heap_insert(heap, &events[seq]);
+    }
+    start= _bench_time();
+    for (index= 0; index < num_ops; index++, seq++) {
+      event= (_bench_event_t *) heap_pop(heap);
+      event->time+= 1 + _bench_mix(seq) % 1000000;
+      event->seq= seq;
+      heap_insert(heap, event);
+    }
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "heap hold (n=%u)", num_pending);
+    _bench_report(what, num_ops, duration);
+    heap_destroy(&heap);
+    FREE(events);
+
+    // Timing wheel: 4 levels of 64 slots cover the delays
+    timers= (_bench_timer_t *) MALLOC(num_pending*sizeof(_bench_timer_t));
+    ctx.wheel= timer_wheel_create(1, 4, 6, 0);
+    ctx.now= 0;
+    for (seq= 0; seq < num_pending; seq++) {
+      timer_init(&timers[seq].timer);
+      timer_wheel_schedule(ctx.wheel, &timers[seq].timer,
+			   _bench_mix(seq) % 1000000);
+    }
+    ctx.seq= seq;
+    step= 1 + 500000/num_pending;
+    num_fired= 0;
+    start= _bench_time();
+    while (num_fired < num_ops) {
+      ctx.now+= step;
+      num_fired+= timer_wheel_advance(ctx.wheel, ctx.now,
+				      _bench_timer_fire, &ctx);
+    }
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "timer wheel hold (n=%u)", num_pending);
+    _bench_report(what, (unsigned int) num_fired, duration);
+
+    // Cancel and schedule random timers
+    start= _bench_time();
+    for (index= 0; index < num_ops; index++, ctx.seq++) {
+      timer_wheel_cancel(ctx.wheel,
+			 &timers[_bench_mix(ctx.seq) % num_pending].timer);
+      timer_wheel_schedule(ctx.wheel,
+			   &timers[_bench_mix(ctx.seq) % num_pending].timer,
+			   ctx.now + 1 + _bench_mix(ctx.seq+1) % 1000000);
+    }
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "timer wheel cancel (n=%u)", num_pending);
+    _bench_report(what, num_ops, duration);
+    timer_wheel_destroy(&ctx.wheel);
+    FREE(timers);
+
+    // Calendar queue
+    cevents= (gds_calendar_event_t *)
+      MALLOC(num_pending*sizeof(gds_calendar_event_t));
+    queue= calendar_queue_create(1000000.0/num_pending, 0);
+    for (seq= 0; seq < num_pending; seq++) {
+      cevents[seq].time= (_bench_mix(seq) % 1000000) / 1.1;
+      calendar_queue_insert(queue, &cevents[seq]);
+    }
+    start= _bench_time();
+    for (index= 0; index < num_ops; index++, seq++) {
+      cevent= calendar_queue_pop(queue);
+      cevent->time+= (1 + _bench_mix(seq) % 1000000) / 1.1;
+      calendar_queue_insert(queue, cevent);
+    }
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "calendar queue hold (n=%u)", num_pending);
+    _bench_report(what, num_ops, duration);
+    calendar_queue_destroy(&queue);
+    FREE(cevents);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// B+-TREE
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _bench_btree_cmp ]-----------------------------------------
+/** Keys are integers stored in the pointers. */
+static int _bench_btree_cmp(const void * key1, const void * key2)
+{
+  return (key1 < key2)?-1:((key1 > key2)?1:0);
+}
+
+// -----[ _bench_key_array_cmp ]-------------------------------------
+static int _bench_key_array_cmp(const void * item1, const void * item2,
+				unsigned int item_size)
+{
+  return _bench_btree_cmp(*((void * const *) item1),
+			  *((void * const *) item2));
+}
+
+// -----[ _bench_keys_sort_cb ]--------------------------------------
+static int _bench_keys_sort_cb(const void * item1, const void * item2)
+{
+  return _bench_btree_cmp(*((void * const *) item1),
+			  *((void * const *) item2));
+}
+
+// -----[ bench_btree_ops ]------------------------------------------
+/**
+ * Ordered map of integer keys: insertion in random order in a sorted
+ * ptr_array_t and in B+-trees with various node sizes, then lookups,
+ * a full scan and a bulk load of the B+-tree.
+ */
+static void bench_btree_ops(unsigned int size)
+{
+  static const unsigned int NODE_SIZES[]= { 8, 32, 128 };
+  unsigned int num_array, config, index;
+  void ** keys;
+  ptr_array_t * array;
+  gds_btree_t * tree;
+  gds_btree_iter_t iter;
+  double start, duration;
+  char what[64];
+  void * key;
+
+  keys= (void **) MALLOC(size*sizeof(void *));
+  for (index= 0; index < size; index++)
+    keys[index]= (void *) (size_t) _bench_mix(index);
+
+  // Each insertion is linear: limit the running time
+  num_array= (size > 20000)?20000:size;
+  array= ptr_array_create(ARRAY_OPTION_SORTED, _bench_key_array_cmp,
+			  NULL, NULL);
+  start= _bench_time();
+  for (index= 0; index < num_array; index++)
+    ptr_array_add(array, &keys[index]);
+  duration= _bench_time()-start;
+  snprintf(what, sizeof(what), "sorted array insert (n=%u)", num_array);
+  _bench_report(what, num_array, duration);
+  ptr_array_destroy(&array);
+
+  for (config= 0; config < sizeof(NODE_SIZES)/sizeof(NODE_SIZES[0]);
+       config++) {
+    tree= btree_create(NODE_SIZES[config], _bench_btree_cmp, NULL);
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      btree_insert(tree, keys[index], NULL);
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "btree insert (node=%u)",
+	     NODE_SIZES[config]);
+    _bench_report(what, size, duration);
+
+    start= _bench_time();
+    for (index= 0; index < size; index++)
+      btree_get(tree, keys[_bench_mix(index+size) % size]);
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "btree lookup (node=%u)",
+	     NODE_SIZES[config]);
+    _bench_report(what, size, duration);
+
+    start= _bench_time();
+    btree_range(tree, NULL, NULL, 0, &iter);
+    while (btree_iter_next(&iter, &key, NULL) == 0)
+      ;
+    duration= _bench_time()-start;
+    snprintf(what, sizeof(what), "btree scan (node=%u)",
+	     NODE_SIZES[config]);
+    _bench_report(what, size, duration);
+    btree_destroy(&tree);
+  }
+
+  // Bulk load from the sorted keys
+  qsort(keys, size, sizeof(void *), _bench_keys_sort_cb);
+  tree= btree_create(0, _bench_btree_cmp, NULL);
+  start= _bench_time();
+  btree_load(tree, keys, NULL, size);
+  duration= _bench_time()-start;
+  _bench_report("btree load", size, duration);
+  btree_destroy(&tree);
+
+  FREE(keys);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// ASSOCIATIVE ARRAY
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _bench_str_array_cmp ]-------------------------------------
+static int _bench_str_array_cmp(const void * item1, const void * item2,
+				unsigned int item_size)
+{
+  return strcmp(*((char * const *) item1), *((char * const *) item2));
+}
+
+// -----[ bench_assoc_array_ops ]------------------------------------
+/**
+ * Attribute map with string keys: insertion and lookup in the
+ * associative array, compared with a sorted ptr_array_t of strings
+ * (the former implementation), then an enumeration in key order.
+ */
+static void bench_assoc_array_ops(unsigned int size)
+{
+  unsigned int num_array, index, pos;
+  gds_assoc_array_t * assoc;
+  ptr_array_t * array;
+  gds_enum_t * enu;
+  char ** keys;
+  double start, duration;
+  char what[64];
+
+  keys= (char **) MALLOC(size*sizeof(char *));
+  for (index= 0; index < size; index++) {
+    keys[index]= (char *) MALLOC(24);
+    snprintf(keys[index], 24, "attr-%08x", _bench_mix(index));
+  }
+
+  // Each insertion is linear: limit the running time
+  num_array= (size > 20000)?20000:size;
+  array= ptr_array_create(ARRAY_OPTION_SORTED, _bench_str_array_cmp,
+			  NULL, NULL);
+  start= _bench_time();
+  for (index= 0; index < num_array; index++)
+    ptr_array_add(array, &keys[index]);
+  duration= _bench_time()-start;
+  snprintf(what, sizeof(what), "sorted array insert (n=%u)", num_array);
+  _bench_report(what, num_array, duration);
+  start= _bench_time();
+  for (index= 0; index < num_array; index++)
+    ptr_array_sorted_find_index(array, &keys[_bench_mix(index) % num_array],
+				&pos);
+  duration= _bench_time()-start;
+  snprintf(what, sizeof(what), "sorted array lookup (n=%u)", num_array);
+  _bench_report(what, num_array, duration);
+  ptr_array_destroy(&array);
+
+  assoc= assoc_array_create(NULL);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    assoc_array_set(assoc, keys[index], keys[index]);
+  duration= _bench_time()-start;
+  _bench_report("assoc_array_set", size, duration);
+  start= _bench_time();
+  for (index= 0; index < size; index++)
+    assoc_array_get(assoc, keys[_bench_mix(index) % size]);
+  duration= _bench_time()-start;
+  _bench_report("assoc_array_get", size, duration);
+  start= _bench_time();
+  enu= assoc_array_get_sorted_keys_enum(assoc);
+  while (enum_has_next(enu))
+    enum_get_next(enu);
+  enum_destroy(&enu);
+  duration= _bench_time()-start;
+  _bench_report("sorted keys enum", size, duration);
+  assoc_array_destroy(&assoc);
+
+  for (index= 0; index < size; index++)
+    FREE(keys[index]);
+  FREE(keys);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// CURSORS
+//
+/////////////////////////////////////////////////////////////////////
+
+/** Sum of the traversed items, keeps the traversals from being
+ * optimized away. */
+static size_t _bench_checksum;
+
+// -----[ bench_cursor_traversal ]-----------------------------------
+/**
+ * Traversal of a ptr_array_t and of a trie with an enumeration (two
+ * indirect calls per item), with the batched enumeration and with a
+ * cursor (GDS_FOREACH). Then, enumerations of a prefix that are
+ * stopped after the first item.
+ */
+static void bench_cursor_traversal(unsigned int size)
+{
+  gds_trie_bulk_item_t * items= _bench_prefixes(size);
+  ptr_array_t * array= ptr_array_create_ref(0);
+  gds_trie_t * trie= trie_create(NULL);
+  ptr_array_cursor_t array_cursor;
+  gds_trie_cursor_t trie_cursor;
+  void * item, * batch[64];
+  trie_key_t key;
+  trie_key_len_t key_len;
+  unsigned int index, num;
+  gds_enum_t * enu;
+  double start;
+
+  for (index= 0; index < size; index++) {
+    item= (void *) (size_t) index;
+    ptr_array_append(array, item);
+    trie_insert(trie, items[index].key, items[index].key_len,
+		items[index].data, 0);
+  }
+
+  start= _bench_time();
+  enu= _array_get_enum((array_t *) array);
+  while (enum_has_next(enu))
+    _bench_checksum+= (size_t) *((void **) enum_get_next(enu));
+  enum_destroy(&enu);
+  _bench_report("ptr_array enum", size, _bench_time()-start);
+
+  start= _bench_time();
+  enu= _array_get_enum((array_t *) array);
+  while ((num= enum_get_next_n(enu, batch, 64)) > 0)
+    for (index= 0; index < num; index++)
+      _bench_checksum+= (size_t) *((void **) batch[index]);
+  enum_destroy(&enu);
+  _bench_report("ptr_array enum (batch of 64)", size, _bench_time()-start);
+
+  start= _bench_time();
+  GDS_FOREACH(ptr_array, array_cursor, array, &item)
+    _bench_checksum+= (size_t) item;
+  _bench_report("ptr_array cursor", size, _bench_time()-start);
+
+  start= _bench_time();
+  enu= trie_get_enum(trie);
+  while (enum_has_next(enu))
+    _bench_checksum+= (size_t) *((void **) enum_get_next(enu));
+  enum_destroy(&enu);
+  _bench_report("trie enum", size, _bench_time()-start);
+
+  start= _bench_time();
+  GDS_FOREACH(trie, trie_cursor, trie, &key, &key_len, &item)
+    _bench_checksum+= (size_t) item + key + key_len;
+  _bench_report("trie cursor", size, _bench_time()-start);
+
+  // Early termination: first item of 1000 prefix enumerations
+  start= _bench_time();
+  for (index= 0; index < 1000; index++) {
+    enu= trie_get_prefix_enum(trie, items[index % size].key, 8);
+    if (enum_has_next(enu))
+      _bench_checksum+= (size_t) *((void **) enum_get_next(enu));
+    enum_destroy(&enu);
+  }
+  _bench_report("trie prefix enum (first item)", 1000, _bench_time()-start);
+
+  trie_destroy(&trie);
+  ptr_array_destroy(&array);
+  FREE(items);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// PARALLEL TRAVERSAL
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _bench_pool_init ]-----------------------------------------
+static void _bench_pool_init(void * part, void * ctx)
+{
+  *((size_t *) part)= 0;
+}
+
+// -----[ _bench_pool_merge ]----------------------------------------
+static void _bench_pool_merge(void * ctx, void * part)
+{
+  *((size_t *) ctx)+= *((size_t *) part);
+}
+
+// -----[ _bench_pool_work ]-----------------------------------------
+/** Some work per item, so that the traversal is not memory-bound. */
+static inline size_t _bench_pool_work(uint32_t x)
+{
+  unsigned int index;
+
+  for (index= 0; index < 16; index++)
+    x= _bench_mix(x);
+  return x;
+}
+
+// -----[ _bench_pool_array_cb ]-------------------------------------
+static int _bench_pool_array_cb(const void * item, const void * ctx)
+{
+  *((size_t *) ctx)+= _bench_pool_work(*((const uint32_t *) item));
+  return 0;
+}
+
+// -----[ _bench_pool_trie_cb ]--------------------------------------
+static int _bench_pool_trie_cb(trie_key_t key, trie_key_len_t key_len,
+			       void * data, void * ctx)
+{
+  *((size_t *) ctx)+= _bench_pool_work(key);
+  return 0;
+}
+
+// -----[ _bench_pool_run ]------------------------------------------
+static void _bench_pool_run(gds_pool_t * pool, uint32_array_t * array,
+			    gds_trie_t * trie, unsigned int size)
+{
+  gds_pool_reducer_t reducer= {
+    sizeof(size_t), _bench_pool_init, _bench_pool_merge
+  };
+  char what[64];
+  double start;
+  size_t sum;
+
+  sum= 0;
+  start= _bench_time();
+  uint32_array_parallel_for_each(array, pool, _bench_pool_array_cb,
+				 &sum, &reducer, 0);
+  snprintf(what, sizeof(what), "array parallel (%u workers)",
+	   pool_num_workers(pool));
+  _bench_report(what, size, _bench_time()-start);
+  _bench_checksum+= sum;
+
+  sum= 0;
+  start= _bench_time();
+  trie_parallel_for_each(trie, pool, _bench_pool_trie_cb, &sum,
+			 &reducer, 0);
+  snprintf(what, sizeof(what), "trie parallel (%u workers)",
+	   pool_num_workers(pool));
+  _bench_report(what, size, _bench_time()-start);
+  _bench_checksum+= sum;
+}
+
+// -----[ bench_pool_for_each ]--------------------------------------
+/**
+ * Sequential traversal of an array and of a trie, then parallel
+ * traversals with a pool of 1 worker (overhead of the pool) and with
+ * a pool of one worker per processor. Each worker sums its items in
+ * its own partial result.
+ */
+static void bench_pool_for_each(unsigned int size)
+{
+  gds_trie_bulk_item_t * items= _bench_prefixes(size);
+  uint32_array_t * array= uint32_array_create(0);
+  gds_trie_t * trie= trie_create(NULL);
+  gds_pool_t * pool;
+  unsigned int index;
+  size_t sum;
+  double start;
+
+  for (index= 0; index < size; index++) {
+    uint32_array_append(array, items[index].key);
+    trie_insert(trie, items[index].key, items[index].key_len,
+		items[index].data, 0);
+  }
+
+  sum= 0;
+  start= _bench_time();
+  uint32_array_for_each(array, _bench_pool_array_cb, &sum);
+  _bench_report("array for-each", size, _bench_time()-start);
+  _bench_checksum+= sum;
+
+  sum= 0;
+  start= _bench_time();
+  trie_for_each(trie, _bench_pool_trie_cb, &sum);
+  _bench_report("trie for-each", size, _bench_time()-start);
+  _bench_checksum+= sum;
+
+  pool= pool_create(1);
+  _bench_pool_run(pool, array, trie, size);
+  pool_destroy(&pool);
+  pool= pool_create(0);
+  _bench_pool_run(pool, array, trie, size);
+  pool_destroy(&pool);
+
+  trie_destroy(&trie);
+  uint32_array_destroy(&array);
+  FREE(items);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// MAIN
+//
+/////////////////////////////////////////////////////////////////////
+
+static bench_t BENCHMARKS[]= {
+  { "trie:load", bench_trie_load },
+  { "radix-tree:load", bench_radix_tree_load },
+  { "trie-dico:load", bench_trie_dico_load },
+  { "bit-vector:ops", bench_bit_vector_ops },
+  { "bloom-filter:hash", bench_bloom_filter_hash },
+  { "bloom-filter:blocked", bench_bloom_filter_blocked },
+  { "bloom-filter:batch", bench_bloom_filter_batch },
+  { "cuckoo-filter:compare", bench_cuckoo_filter },
+  { "sha1:batch", bench_sha1_batch },
+  { "fifo:spsc", bench_fifo_spsc },
+  { "fifo:mpmc", bench_fifo_mpmc },
+  { "heap:events", bench_heap_events },
+  { "timer-wheel:events", bench_timer_wheel_events },
+  { "btree:ops", bench_btree_ops },
+  { "assoc-array:ops", bench_assoc_array_ops },
+  { "cursor:traversal", bench_cursor_traversal },
+  { "pool:for-each", bench_pool_for_each },
+};
+#define NUM_BENCHMARKS (sizeof(BENCHMARKS)/sizeof(BENCHMARKS[0]))
+
+// -----[ _bench_selected ]------------------------------------------
+static int _bench_selected(const char * id, int argc, char * argv[])
+{
+  int index;
+
+  if (argc == 0)
+    return 1;
+  for (index= 0; index < argc; index++)
+    if (!strncmp(id, argv[index], strlen(argv[index])))
+      return 1;
+  return 0;
+}
+
+// -----[ main ]-----------------------------------------------------
+int main(int argc, char * argv[])
+{
+  unsigned int size= BENCH_DEFAULT_SIZE;
+  unsigned int index;
+
+  argc--;
+  argv++;
+  if ((argc >= 2) && !strcmp(argv[0], "-n")) {
+    size= (unsigned int) strtoul(argv[1], NULL, 10);
+    argc-= 2;
+    argv+= 2;
+  }
+  if (size == 0) {
+    fprintf(stderr, "usage: gds_bench [-n SIZE] [BENCH ...]\n");
+    return EXIT_FAILURE;
+  }
+
+  srandom(2007);
+  gds_init(0);
+
+  for (index= 0; index < NUM_BENCHMARKS; index++) {
+    if (!_bench_selected(BENCHMARKS[index].id, argc, argv))
+      continue;
+    printf("%s (size=%u)\n", BENCHMARKS[index].id, size);
+    BENCHMARKS[index].run(size);
+  }
+
+  gds_destroy();
+  return EXIT_SUCCESS;
+}
@@ -431,6 +431,677 @@ static int test_fifo_grow()
   return UTEST_SUCCESS;
 }
 
+#include <pthread.h>
+#include <sched.h>
+#include <libgds/fifo_spsc.h>
+
+// -----[ test_fifo_spsc_basic ]-------------------------------------
+static int test_fifo_spsc_basic()
+{
+  gds_fifo_spsc_t * fifo;
+  unsigned int index, round;
+  void * item;
+
+  UTEST_ASSERT(fifo_spsc_create(0, NULL) == NULL,
+		"should not create FIFO with capacity 0");
+  fifo= fifo_spsc_create(FIFO_NITEMS, NULL);
+  UTEST_ASSERT(fifo != NULL, "fifo_spsc_create() returned a NULL pointer");
+  UTEST_ASSERT(fifo_spsc_capacity(fifo) == 8,
+		"capacity should be rounded up to a power of 2");
+  UTEST_ASSERT(fifo_spsc_pop(fifo, &item) < 0,
+		"should not pop from empty FIFO");
+
+  // Wrap around the ring several times
+  for (round= 0; round < 5; round++) {
+    for (index= 0; index < 8; index++)
+      UTEST_ASSERT(fifo_spsc_push(fifo, (void *)(size_t)(round*8+index)) == 0,
+		    "could not push data onto FIFO");
+    UTEST_ASSERT(fifo_spsc_push(fifo, (void *) 255) < 0,
+		  "should not allow pushing more than FIFO capacity");
+    UTEST_ASSERT(fifo_spsc_depth(fifo) == 8, "incorrect depth returned");
+    for (index= 0; index < 5; index++) {
+      UTEST_ASSERT((fifo_spsc_pop(fifo, &item) == 0) &&
+		    ((size_t) item == round*8+index),
+		    "incorrect value pop'ed");
+    }
+    for (; index < 8; index++)
+      fifo_spsc_pop(fifo, &item);
+    UTEST_ASSERT(fifo_spsc_depth(fifo) == 0, "incorrect depth returned");
+  }
+  fifo_spsc_destroy(&fifo);
+  UTEST_ASSERT(fifo == NULL, "destroyed FIFO should be NULL");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_fifo_spsc_batch ]-------------------------------------
+static int test_fifo_spsc_batch()
+{
+  gds_fifo_spsc_t * fifo= fifo_spsc_create(16, NULL);
+  void * in[16], * out[16];
+  unsigned int index, round;
+  size_t next_in= 0, next_out= 0;
+  uint32_t num;
+
+  // Batches of 5 or 7 items wrap at various positions
+  for (round= 0; round < 20; round++) {
+    for (index= 0; index < 16; index++)
+      in[index]= (void *) (next_in+index);
+    num= fifo_spsc_push_n(fifo, in, (round & 1)?7:5);
+    next_in+= num;
+    UTEST_ASSERT(num == ((round & 1)?7:5), "incorrect number pushed");
+    num= fifo_spsc_pop_n(fifo, out, (round & 1)?6:5);
+    for (index= 0; index < num; index++) {
+      UTEST_ASSERT(out[index] == (void *) next_out,
+		    "incorrect value pop'ed");
+      next_out++;
+    }
+  }
+  UTEST_ASSERT(fifo_spsc_depth(fifo) == next_in - next_out,
+		"incorrect depth returned");
+
+  // Partial push when full, partial pop when empty
+  num= fifo_spsc_push_n(fifo, in, 16);
+  UTEST_ASSERT(num == 16 - (next_in - next_out),
+		"push should be limited by the free space (%u)", num);
+  UTEST_ASSERT(fifo_spsc_push_n(fifo, in, 1) == 0,
+		"should not push onto full FIFO");
+  UTEST_ASSERT(fifo_spsc_pop_n(fifo, out, 16) == 16,
+		"incorrect number pop'ed");
+  UTEST_ASSERT(fifo_spsc_pop_n(fifo, out, 16) == 0,
+		"should not pop from empty FIFO");
+  fifo_spsc_destroy(&fifo);
+  return UTEST_SUCCESS;
+}
+
+#define FIFO_SPSC_NUM_TRANSFERS 1000000
+
+// -----[ _test_fifo_spsc_producer ]---------------------------------
+static void * _test_fifo_spsc_producer(void * ctx)
+{
+  gds_fifo_spsc_t * fifo= (gds_fifo_spsc_t *) ctx;
+  void * items[13];
+  size_t next= 1;
+  unsigned int index, num;
+
+  while (next <= FIFO_SPSC_NUM_TRANSFERS) {
+    if (next & 1) {
+      if (fifo_spsc_push(fifo, (void *) next) == 0)
+	next++;
+      else
+	sched_yield();
+      continue;
+    }
+    num= 13;
+    if (next + num > FIFO_SPSC_NUM_TRANSFERS + 1)
+      num= FIFO_SPSC_NUM_TRANSFERS + 1 - next;
+    for (index= 0; index < num; index++)
+      items[index]= (void *) (next+index);
+    num= fifo_spsc_push_n(fifo, items, num);
+    if (num == 0)
+      sched_yield();
+    next+= num;
+  }
+  return NULL;
+}
+
+// -----[ test_fifo_spsc_threads ]-----------------------------------
+/**
+ * A producer thread transfers a sequence of values to the consumer
+ * (this thread), which checks that none is lost or reordered.
+ */
+static int test_fifo_spsc_threads()
+{
+  gds_fifo_spsc_t * fifo= fifo_spsc_create(64, NULL);
+  pthread_t producer;
+  void * items[7];
+  size_t next= 1;
+  unsigned int index, num;
+  int ordered= 1;
+
+  UTEST_ASSERT(pthread_create(&producer, NULL, _test_fifo_spsc_producer,
+			      fifo) == 0, "could not create thread");
+  while (next <= FIFO_SPSC_NUM_TRANSFERS) {
+    if (next % 3 == 0) {
+      if (fifo_spsc_pop(fifo, &items[0]) == 0) {
+	ordered&= (items[0] == (void *) next);
+	next++;
+      } else
+	sched_yield();
+      continue;
+    }
+    num= fifo_spsc_pop_n(fifo, items, 7);
+    if (num == 0)
+      sched_yield();
+    for (index= 0; index < num; index++, next++)
+      ordered&= (items[index] == (void *) next);
+  }
+  pthread_join(producer, NULL);
+  UTEST_ASSERT(ordered, "values lost or reordered");
+  UTEST_ASSERT(fifo_spsc_depth(fifo) == 0, "FIFO should be empty");
+  fifo_spsc_destroy(&fifo);
+  return UTEST_SUCCESS;
+}
+
+#include <libgds/fifo_mpmc.h>
+
+// -----[ test_fifo_mpmc_basic ]-------------------------------------
+static int test_fifo_mpmc_basic()
+{
+  gds_fifo_mpmc_t * fifo;
+  unsigned int index, round;
+  void * item;
+
+  UTEST_ASSERT(fifo_mpmc_create(0, NULL) == NULL,
+		"should not create FIFO with capacity 0");
+  fifo= fifo_mpmc_create(1, NULL);
+  UTEST_ASSERT(fifo_mpmc_capacity(fifo) == 2,
+		"capacity should be at least 2");
+  fifo_mpmc_destroy(&fifo);
+
+  fifo= fifo_mpmc_create(FIFO_NITEMS, NULL);
+  UTEST_ASSERT(fifo != NULL, "fifo_mpmc_create() returned a NULL pointer");
+  UTEST_ASSERT(fifo_mpmc_capacity(fifo) == 8,
+		"capacity should be rounded up to a power of 2");
+  UTEST_ASSERT(fifo_mpmc_try_pop(fifo, &item) < 0,
+		"should not pop from empty FIFO");
+
+  // Wrap around the ring several times
+  for (round= 0; round < 5; round++) {
+    for (index= 0; index < 8; index++) {
+      if (index & 1)
+	fifo_mpmc_push(fifo, (void *)(size_t)(round*8+index));
+      else
+	UTEST_ASSERT(fifo_mpmc_try_push(fifo,
+					(void *)(size_t)(round*8+index)) == 0,
+		      "could not push data onto FIFO");
+    }
+    UTEST_ASSERT(fifo_mpmc_try_push(fifo, (void *) 255) < 0,
+		  "should not allow pushing more than FIFO capacity");
+    UTEST_ASSERT(fifo_mpmc_depth(fifo) == 8, "incorrect depth returned");
+    for (index= 0; index < 8; index++) {
+      if (index & 1) {
+	UTEST_ASSERT((fifo_mpmc_try_pop(fifo, &item) == 0) &&
+		      ((size_t) item == round*8+index),
+		      "incorrect value pop'ed");
+      } else {
+	UTEST_ASSERT((size_t) fifo_mpmc_pop(fifo) == round*8+index,
+		      "incorrect value pop'ed");
+      }
+    }
+    UTEST_ASSERT(fifo_mpmc_depth(fifo) == 0, "incorrect depth returned");
+  }
+  fifo_mpmc_destroy(&fifo);
+  UTEST_ASSERT(fifo == NULL, "destroyed FIFO should be NULL");
+  return UTEST_SUCCESS;
+}
+
+#define FIFO_MPMC_NUM_THREADS 4
+#define FIFO_MPMC_NUM_ITEMS   100000
+
+typedef struct {
+  gds_fifo_mpmc_t * fifo;
+  unsigned int      id;
+  int               blocking;
+  unsigned int    * claimed;
+  unsigned int    * received;
+  int               ordered;
+} _test_fifo_mpmc_ctx_t;
+
+// -----[ _test_fifo_mpmc_producer ]---------------------------------
+static void * _test_fifo_mpmc_producer(void * arg)
+{
+  _test_fifo_mpmc_ctx_t * ctx= (_test_fifo_mpmc_ctx_t *) arg;
+  size_t index, value;
+
+  for (index= 1; index <= FIFO_MPMC_NUM_ITEMS; index++) {
+    value= (((size_t) ctx->id) << 24) | index;
+    if (ctx->blocking)
+      fifo_mpmc_push(ctx->fifo, (void *) value);
+    else
+      while (fifo_mpmc_try_push(ctx->fifo, (void *) value) < 0)
+	sched_yield();
+  }
+  return NULL;
+}
+
+// -----[ _test_fifo_mpmc_consumer ]---------------------------------
+/**
+ * Pop items until all of them have been claimed. The items of a
+ * given producer must be received in increasing order.
+ */
+static void * _test_fifo_mpmc_consumer(void * arg)
+{
+  _test_fifo_mpmc_ctx_t * ctx= (_test_fifo_mpmc_ctx_t *) arg;
+  size_t last[FIFO_MPMC_NUM_THREADS];
+  size_t value;
+  unsigned int producer;
+
+  memset(last, 0, sizeof(last));
+  while (__atomic_fetch_add(ctx->claimed, 1, __ATOMIC_RELAXED) <
+	 FIFO_MPMC_NUM_THREADS*FIFO_MPMC_NUM_ITEMS) {
+    value= (size_t) fifo_mpmc_pop(ctx->fifo);
+    producer= value >> 24;
+    if ((producer >= FIFO_MPMC_NUM_THREADS) ||
+	((value & 0xffffff) <= last[producer])) {
+      ctx->ordered= 0;
+      continue;
+    }
+    last[producer]= value & 0xffffff;
+    __atomic_add_fetch(&ctx->received[producer], 1, __ATOMIC_RELAXED);
+  }
+  return NULL;
+}
+
+// -----[ test_fifo_mpmc_stress ]------------------------------------
+/**
+ * Several producers and consumers share a small queue, so that they
+ * frequently find it full or empty. The producers use the blocking,
+ * then the non-blocking push.
+ */
+static int test_fifo_mpmc_stress()
+{
+  _test_fifo_mpmc_ctx_t producers[FIFO_MPMC_NUM_THREADS];
+  _test_fifo_mpmc_ctx_t consumers[FIFO_MPMC_NUM_THREADS];
+  pthread_t threads[2*FIFO_MPMC_NUM_THREADS];
+  unsigned int received[FIFO_MPMC_NUM_THREADS];
+  unsigned int index, claimed;
+  int blocking;
+  gds_fifo_mpmc_t * fifo;
+
+  for (blocking= 1; blocking >= 0; blocking--) {
+    fifo= fifo_mpmc_create(16, NULL);
+    claimed= 0;
+    memset(received, 0, sizeof(received));
+    for (index= 0; index < FIFO_MPMC_NUM_THREADS; index++) {
+      consumers[index].fifo= fifo;
+      consumers[index].claimed= &claimed;
+      consumers[index].received= received;
+      consumers[index].ordered= 1;
+      pthread_create(&threads[index], NULL, _test_fifo_mpmc_consumer,
+		     &consumers[index]);
+    }
+    for (index= 0; index < FIFO_MPMC_NUM_THREADS; index++) {
+      producers[index].fifo= fifo;
+      producers[index].id= index;
+      producers[index].blocking= blocking;
+      pthread_create(&threads[FIFO_MPMC_NUM_THREADS+index], NULL,
+		     _test_fifo_mpmc_producer, &producers[index]);
+    }
+    for (index= 0; index < 2*FIFO_MPMC_NUM_THREADS; index++)
+      pthread_join(threads[index], NULL);
+
+    for (index= 0; index < FIFO_MPMC_NUM_THREADS; index++) {
+      UTEST_ASSERT(consumers[index].ordered,
+		    "items received out of order (blocking=%d)", blocking);
+      UTEST_ASSERT(received[index] == FIFO_MPMC_NUM_ITEMS,
+		    "items lost from producer %u (%u, blocking=%d)",
+		    index, received[index], blocking);
+    }
+    UTEST_ASSERT(fifo_mpmc_depth(fifo) == 0, "FIFO should be empty");
+    fifo_mpmc_destroy(&fifo);
+  }
+  return UTEST_SUCCESS;
+}
+
+/////////////////////////////////////////////////////////////////////
+// GDS_CHECK_HEAP
+/////////////////////////////////////////////////////////////////////
+
+#include <libgds/heap.h>
+
+#define HEAP_NITEMS 1000
+
+// -----[ _test_heap_cmp ]-------------------------------------------
+static int _test_heap_cmp(const void * item1, const void * item2)
+{
+  unsigned int key1= *((const unsigned int *) item1);
+  unsigned int key2= *((const unsigned int *) item2);
+  return (key1 < key2)?-1:((key1 > key2)?1:0);
+}
+
+// -----[ _test_heap_check ]-----------------------------------------
+/**
+ * Pop all the items and check that they come out in increasing
+ * order.
+ */
+static int _test_heap_check(gds_heap_t * heap, unsigned int num_items)
+{
+  unsigned int * item, last= 0;
+
+  while ((item= (unsigned int *) heap_pop(heap)) != NULL) {
+    if (*item < last)
+      return -1;
+    last= *item;
+    num_items--;
+  }
+  return (num_items == 0)?0:-1;
+}
+
+// -----[ test_heap_basic ]------------------------------------------
+static int test_heap_basic()
+{
+  unsigned int keys[HEAP_NITEMS];
+  gds_heap_t * heap= heap_create(0, _test_heap_cmp, NULL);
+  unsigned int index;
+
+  UTEST_ASSERT(heap_peek(heap) == NULL, "empty heap should have no top");
+  UTEST_ASSERT(heap_pop(heap) == NULL, "should not pop from empty heap");
+  for (index= 0; index < HEAP_NITEMS; index++) {
+    keys[index]= random() % 500;
+    heap_insert(heap, &keys[index]);
+  }
+  UTEST_ASSERT(heap_size(heap) == HEAP_NITEMS, "incorrect size");
+  UTEST_ASSERT(_test_heap_check(heap, HEAP_NITEMS) == 0,
+		"items not popped in order");
+  heap_destroy(&heap);
+  UTEST_ASSERT(heap == NULL, "destroyed heap should be NULL");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_heap_update ]-----------------------------------------
+static int test_heap_update()
+{
+  unsigned int keys[HEAP_NITEMS];
+  gds_heap_handle_t handles[HEAP_NITEMS];
+  gds_heap_t * heap= heap_create(16, _test_heap_cmp, NULL);
+  unsigned int index, num_items= HEAP_NITEMS;
+
+  for (index= 0; index < HEAP_NITEMS; index++) {
+    keys[index]= 1000 + random() % 100000;
+    handles[index]= heap_insert(heap, &keys[index]);
+  }
+
+  // Decrease-key, then increase-key
+  keys[17]= 5;
+  UTEST_ASSERT(heap_update(heap, handles[17]) == 0, "could not update");
+  UTEST_ASSERT(heap_peek(heap) == &keys[17], "incorrect top after update");
+  for (index= 0; index < HEAP_NITEMS; index+= 3) {
+    keys[index]= (index % 2)?keys[index]/2:keys[index]*2;
+    heap_update(heap, handles[index]);
+  }
+
+  // Remove by handle
+  for (index= 1; index < HEAP_NITEMS; index+= 7, num_items--)
+    UTEST_ASSERT(heap_remove(heap, handles[index]) == &keys[index],
+		  "incorrect item removed");
+  UTEST_ASSERT(heap_remove(heap, handles[1]) == NULL,
+		"handle should not be valid after removal");
+  UTEST_ASSERT(heap_get(heap, handles[1]) == NULL,
+		"handle should not be valid after removal");
+  UTEST_ASSERT(heap_update(heap, HEAP_NITEMS) == -1,
+		"should not update unknown handle");
+  UTEST_ASSERT(heap_get(heap, handles[2]) == &keys[2],
+		"incorrect item returned");
+  UTEST_ASSERT(heap_size(heap) == num_items, "incorrect size");
+  UTEST_ASSERT(_test_heap_check(heap, num_items) == 0,
+		"items not popped in order");
+  heap_destroy(&heap);
+  return UTEST_SUCCESS;
+}
+
+/////////////////////////////////////////////////////////////////////
+// GDS_CHECK_TIMER_WHEEL
+/////////////////////////////////////////////////////////////////////
+
+#include <libgds/calendar_queue.h>
+#include <libgds/timer_wheel.h>
+
+#define TIMER_WHEEL_NTIMERS 2000
+#define CALENDAR_QUEUE_NEVENTS 2000
+
+typedef struct {
+  gds_timer_t  timer;
+  unsigned int index;
+  unsigned int num_fired;
+} _test_timer_t;
+
+typedef struct {
+  gds_timer_wheel_t * wheel;
+  uint64_t            tick;
+  uint64_t            now;
+  uint64_t            last_tick;
+  unsigned int        num_errors;
+} _test_timer_ctx_t;
+
+// -----[ _test_timer_tick ]-----------------------------------------
+static inline uint64_t _test_timer_tick(uint64_t time, uint64_t tick)
+{
+  return (time + tick - 1) / tick;
+}
+
+// -----[ _test_timer_fire ]-----------------------------------------
+/**
+ * Check that the timer is neither early nor out of order (except the
+ * timers that were scheduled expired, with an index multiple of 11,
+ * which fire first). Timers with an index multiple of 5 are
+ * rescheduled once.
+ */
+static void _test_timer_fire(gds_timer_t * timer, void * ctx)
+{
+  _test_timer_ctx_t * test= (_test_timer_ctx_t *) ctx;
+  _test_timer_t * t= DLLIST_ENTRY(timer, _test_timer_t, timer);
+  uint64_t tick= _test_timer_tick(timer_expires(timer), test->tick);
+
+  if (timer_is_active(timer) || (tick > test->now / test->tick))
+    test->num_errors++;
+  if ((t->index % 11 != 0) || (t->num_fired > 0)) {
+    if (tick < test->last_tick)
+      test->num_errors++;
+    test->last_tick= tick;
+  }
+  t->num_fired++;
+  if ((t->index % 5 == 0) && (t->num_fired == 1))
+    timer_wheel_schedule(test->wheel, timer,
+			 test->now + 1 + random() % 3000);
+}
+
+// -----[ _test_timer_wheel ]----------------------------------------
+static int _test_timer_wheel(uint64_t tick, unsigned int num_levels,
+			     unsigned int bits, uint64_t max_delay,
+			     uint64_t max_step)
+{
+  _test_timer_t timers[TIMER_WHEEL_NTIMERS];
+  _test_timer_ctx_t ctx;
+  uint64_t num_fired= 0, num_expected= 0;
+  unsigned int index, num_rounds= 0;
+
+  ctx.wheel= timer_wheel_create(tick, num_levels, bits, 1000);
+  UTEST_ASSERT(ctx.wheel != NULL, "could not create wheel");
+  ctx.tick= tick;
+  ctx.now= 1000;
+  ctx.last_tick= 0;
+  ctx.num_errors= 0;
+  for (index= 0; index < TIMER_WHEEL_NTIMERS; index++) {
+    timers[index].index= index;
+    timers[index].num_fired= 0;
+    timer_init(&timers[index].timer);
+    // Some timers are already expired
+    if (index % 11 == 0)
+      timer_wheel_schedule(ctx.wheel, &timers[index].timer,
+			   random() % 1000);
+    else
+      timer_wheel_schedule(ctx.wheel, &timers[index].timer,
+			   1001 + random() % max_delay);
+  }
+  // Reschedule (earlier or later) and cancel some timers
+  for (index= 3; index < TIMER_WHEEL_NTIMERS; index+= 13)
+    timer_wheel_schedule(ctx.wheel, &timers[index].timer,
+			 1001 + random() % max_delay);
+  for (index= 1; index < TIMER_WHEEL_NTIMERS; index+= 7)
+    UTEST_ASSERT(timer_wheel_cancel(ctx.wheel, &timers[index].timer) == 0,
+		  "could not cancel timer");
+  UTEST_ASSERT(timer_wheel_cancel(ctx.wheel, &timers[1].timer) == -1,
+		"should not cancel inactive timer");
+  for (index= 0; index < TIMER_WHEEL_NTIMERS; index++)
+    if (index % 7 != 1)
+      num_expected+= (index % 5 == 0)?2:1;
+
+  while ((timer_wheel_num_timers(ctx.wheel) > 0) && (num_rounds < 100000)) {
+    ctx.now+= random() % max_step;
+    num_fired+= timer_wheel_advance(ctx.wheel, ctx.now,
+				    _test_timer_fire, &ctx);
+    UTEST_ASSERT(timer_wheel_time(ctx.wheel) == (ctx.now / tick) * tick,
+		  "incorrect wheel time");
+    // No expired timer is left behind
+    for (index= 0; index < TIMER_WHEEL_NTIMERS; index++)
+      if (timer_is_active(&timers[index].timer) &&
+	  (_test_timer_tick(timer_expires(&timers[index].timer), tick) <=
+	   ctx.now / tick))
+	ctx.num_errors++;
+    num_rounds++;
+  }
+  UTEST_ASSERT(ctx.num_errors == 0, "timers fired early, late or unordered");
+  UTEST_ASSERT(num_fired == num_expected, "incorrect number of timers fired");
+  for (index= 0; index < TIMER_WHEEL_NTIMERS; index++) {
+    if (index % 7 == 1) {
+      UTEST_ASSERT(timers[index].num_fired == 0,
+		    "cancelled timer should not fire");
+    } else {
+      UTEST_ASSERT(timers[index].num_fired == ((index % 5 == 0)?2:1),
+		    "timer should fire once per schedule");
+    }
+  }
+  timer_wheel_destroy(&ctx.wheel);
+  UTEST_ASSERT(ctx.wheel == NULL, "destroyed wheel should be NULL");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_timer_wheel_basic ]-----------------------------------
+static int test_timer_wheel_basic()
+{
+  UTEST_ASSERT(timer_wheel_create(0, 2, 4, 0) == NULL,
+		"should not accept null tick");
+  UTEST_ASSERT(timer_wheel_create(1, TIMER_WHEEL_MAX_LEVELS+1, 4, 0) == NULL,
+		"should not accept too many levels");
+  UTEST_ASSERT(timer_wheel_create(1, 2, TIMER_WHEEL_MAX_BITS+1, 0) == NULL,
+		"should not accept too many bits");
+  // Most timers are beyond the range of the wheel (256 ticks)
+  return _test_timer_wheel(1, 2, 4, 5000, 40);
+}
+
+// -----[ test_timer_wheel_tick ]------------------------------------
+static int test_timer_wheel_tick()
+{
+  return _test_timer_wheel(10, 3, 6, 100000, 500);
+}
+
+// -----[ test_calendar_queue_basic ]--------------------------------
+static int test_calendar_queue_basic()
+{
+  gds_calendar_event_t events[CALENDAR_QUEUE_NEVENTS];
+  gds_calendar_event_t * event, * last= NULL, early;
+  gds_calendar_queue_t * queue;
+  unsigned int index, num_events= 0;
+
+  UTEST_ASSERT(calendar_queue_create(0, 0) == NULL,
+		"should not accept null width");
+  queue= calendar_queue_create(1, 0);
+  UTEST_ASSERT(calendar_queue_pop(queue) == NULL,
+		"should not pop from empty queue");
+  // Many events have the same time
+  for (index= 0; index < CALENDAR_QUEUE_NEVENTS; index++) {
+    events[index].time= (random() % 500) / 4.0;
+    UTEST_ASSERT(calendar_queue_insert(queue, &events[index]) == 0,
+		  "could not insert event");
+  }
+  for (index= 2; index < CALENDAR_QUEUE_NEVENTS; index+= 9)
+    calendar_queue_remove(queue, &events[index]);
+  UTEST_ASSERT(calendar_queue_size(queue) ==
+		CALENDAR_QUEUE_NEVENTS - (CALENDAR_QUEUE_NEVENTS+6)/9,
+		"incorrect size");
+  while ((event= calendar_queue_peek(queue)) != NULL) {
+    UTEST_ASSERT(calendar_queue_pop(queue) == event,
+		  "popped event should be the peeked one");
+    UTEST_ASSERT((event - events) % 9 != 2, "removed event popped");
+    UTEST_ASSERT((last == NULL) || (last->time < event->time) ||
+		  ((last->time == event->time) && (last < event)),
+		  "events not popped in order");
+    last= event;
+    num_events++;
+    if (num_events == 100) {
+      early.time= last->time - 1;
+      UTEST_ASSERT(calendar_queue_insert(queue, &early) == -1,
+		    "should not insert event before last extracted event");
+    }
+  }
+  UTEST_ASSERT(num_events == CALENDAR_QUEUE_NEVENTS -
+		(CALENDAR_QUEUE_NEVENTS+6)/9, "incorrect number of events");
+  calendar_queue_destroy(&queue);
+  UTEST_ASSERT(queue == NULL, "destroyed queue should be NULL");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_calendar_queue_hold ]---------------------------------
+/**
+ * Hold model: the earliest event is rescheduled at a later time.
+ * The queue is then grown and emptied, which changes the number of
+ * buckets and their width.
+ */
+static int test_calendar_queue_hold()
+{
+  gds_calendar_event_t events[CALENDAR_QUEUE_NEVENTS];
+  gds_calendar_queue_t * queue= calendar_queue_create(1000, 0);
+  gds_calendar_event_t * event;
+  double last_time= 0;
+  unsigned int index, num_events= 0;
+
+  for (index= 0; index < CALENDAR_QUEUE_NEVENTS/10; index++) {
+    events[index].time= (random() % 100000) / 100.0;
+    calendar_queue_insert(queue, &events[index]);
+  }
+  for (index= 0; index < 50000; index++) {
+    event= calendar_queue_pop(queue);
+    UTEST_ASSERT(event->time >= last_time, "events not popped in order");
+    last_time= event->time;
+    event->time+= (random() % 100000) / 100.0;
+    calendar_queue_insert(queue, event);
+    // Grow the queue during the second half
+    if ((index >= 25000) && (index % 25 == 0) &&
+	(num_events + CALENDAR_QUEUE_NEVENTS/10 < CALENDAR_QUEUE_NEVENTS)) {
+      event= &events[CALENDAR_QUEUE_NEVENTS/10 + num_events++];
+      event->time= last_time + (random() % 100) / 100.0;
+      calendar_queue_insert(queue, event);
+    }
+  }
+  UTEST_ASSERT(calendar_queue_size(queue) ==
+		CALENDAR_QUEUE_NEVENTS/10 + num_events, "incorrect size");
+  while ((event= calendar_queue_pop(queue)) != NULL) {
+    UTEST_ASSERT(event->time >= last_time, "events not popped in order");
+    last_time= event->time;
+  }
+  UTEST_ASSERT(calendar_queue_size(queue) == 0, "queue should be empty");
+  calendar_queue_destroy(&queue);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_heap_build ]------------------------------------------
+static int test_heap_build()
+{
+  unsigned int keys[HEAP_NITEMS];
+  void * items[HEAP_NITEMS];
+  gds_heap_handle_t handles[HEAP_NITEMS];
+  gds_heap_t * heap= heap_create(0, _test_heap_cmp, NULL);
+  unsigned int index;
+
+  for (index= 0; index < HEAP_NITEMS; index++) {
+    keys[index]= random() % 100000;
+    items[index]= &keys[index];
+  }
+  heap_insert(heap, &keys[0]);
+  heap_build(heap, items+1, HEAP_NITEMS-1, handles);
+  UTEST_ASSERT(heap_size(heap) == HEAP_NITEMS, "incorrect size");
+  for (index= 1; index < HEAP_NITEMS; index++)
+    UTEST_ASSERT(heap_get(heap, handles[index-1]) == &keys[index],
+		  "incorrect handle returned");
+  keys[500]= 0;
+  heap_update(heap, handles[499]);
+  UTEST_ASSERT(heap_pop(heap) == &keys[500], "incorrect top after update");
+  UTEST_ASSERT(_test_heap_check(heap, HEAP_NITEMS-1) == 0,
+		"items not popped in order");
+  heap_destroy(&heap);
+  return UTEST_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
 // GDS_CHECK_STACK
 /////////////////////////////////////////////////////////////////////
@@ -584,6 +1255,53 @@ static int test_enum_template()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_enum_get_next_n ]-------------------------------------
+static int test_enum_get_next_n()
+{
+  int value= 5;
+  int_enum_t * int_enu= int_enum_create(&value,
+					_int_enum_has_next,
+					_int_enum_get_next,
+					_int_enum_destroy);
+  uint32_array_t * array= uint32_array_create(0);
+  void * items[7];
+  unsigned int index, num, count;
+  gds_enum_t * enu;
+
+  // Without batched operation: elements are obtained one by one
+  UTEST_ASSERT(enum_get_next_n(int_enu, items, 3) == 3,
+		"enum_get_next_n() should return 3 elements");
+  UTEST_ASSERT(items[0] == (void *) 55, "incorrect element returned");
+  UTEST_ASSERT(enum_get_next_n(int_enu, items, 3) == 2,
+		"enum_get_next_n() should return 2 elements");
+  UTEST_ASSERT(enum_get_next_n(int_enu, items, 3) == 0,
+		"enum_get_next_n() should return no element");
+  int_enum_destroy(&int_enu);
+
+  // With batched operation, mixed with enum_get_next()
+  for (index= 0; index < 100; index++)
+    uint32_array_append(array, index);
+  enu= uint32_array_get_enum(array);
+  UTEST_ASSERT(enu->ops.get_next_n != NULL,
+		"array enumeration should provide batched operation");
+  UTEST_ASSERT(*((uint32_t *) enum_get_next(enu)) == 0,
+		"incorrect element returned");
+  count= 1;
+  while ((num= enum_get_next_n(enu, items, 7)) > 0) {
+    for (index= 0; index < num; index++)
+      UTEST_ASSERT(*((uint32_t *) items[index]) == count+index,
+		    "incorrect element returned");
+    count+= num;
+    UTEST_ASSERT((num == 7) || (count == 100),
+		  "enum_get_next_n() returned too few elements");
+  }
+  UTEST_ASSERT(count == 100, "incorrect number of elements returned");
+  UTEST_ASSERT(!enum_has_next(enu), "enum_has_next() should fail");
+  enum_destroy(&enu);
+  uint32_array_destroy(&array);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 // GDS_CHECK_ARRAY
@@ -1001,6 +1719,124 @@ static int test_assoc_enum_values()
   return UTEST_SUCCESS;
 }
 
+// -----[ _test_assoc_destroy ]--------------------------------------
+static unsigned int _assoc_num_destroyed;
+static void _test_assoc_destroy(void * item)
+{
+  _assoc_num_destroyed++;
+}
+
+// -----[ test_assoc_large ]-----------------------------------------
+/**
+ * Enough keys to grow the hash table several times. Keys are added
+ * in decreasing order, so that the insertion and key orders differ.
+ * The value of "keyN" is N+1.
+ */
+static int test_assoc_large()
+{
+  gds_assoc_array_t * array= assoc_array_create(_test_assoc_destroy);
+  char key[16], * current, * last;
+  unsigned int index, count;
+  gds_enum_t * enu;
+
+  _assoc_num_destroyed= 0;
+  for (index= 0; index < 5000; index++) {
+    snprintf(key, sizeof(key), "key%u", 4999-index);
+    assoc_array_set(array, key, (void *) (size_t) (5000-index));
+  }
+  UTEST_ASSERT(assoc_array_length(array) == 5000, "incorrect length");
+  for (index= 0; index < 5000; index++) {
+    snprintf(key, sizeof(key), "key%u", index);
+    UTEST_ASSERT(assoc_array_get(array, key) == (void *) (size_t) (index+1),
+		  "incorrect value returned for \"%s\"", key);
+  }
+  UTEST_ASSERT(assoc_array_get(array, "key5000") == NULL,
+		"should not return value for missing key");
+
+  // Replace values: the previous values are destroyed
+  for (index= 0; index < 5000; index+= 2) {
+    snprintf(key, sizeof(key), "key%u", index);
+    assoc_array_set(array, key, NULL);
+  }
+  UTEST_ASSERT(_assoc_num_destroyed == 2500, "values not destroyed");
+  UTEST_ASSERT(assoc_array_length(array) == 5000, "incorrect length");
+
+  // Enumerations in insertion order, then in key order
+  count= 0;
+  enu= assoc_array_get_values_enum(array);
+  while (enum_has_next(enu)) {
+    index= 4999-count;
+    UTEST_ASSERT(enum_get_next(enu) ==
+		  ((index % 2)?(void *) (size_t) (index+1):NULL),
+		  "values not enumerated in insertion order");
+    count++;
+  }
+  enum_destroy(&enu);
+  UTEST_ASSERT(count == 5000, "incorrect number of items enumerated");
+  assoc_array_set(array, "a", NULL);
+  last= NULL;
+  count= 0;
+  enu= assoc_array_get_sorted_keys_enum(array);
+  while (enum_has_next(enu)) {
+    current= (char *) enum_get_next(enu);
+    UTEST_ASSERT((last == NULL) || (strcmp(last, current) < 0),
+		  "keys not enumerated in order");
+    last= current;
+    count++;
+  }
+  enum_destroy(&enu);
+  UTEST_ASSERT(count == 5001, "incorrect number of items enumerated");
+  assoc_array_destroy(&array);
+  UTEST_ASSERT(_assoc_num_destroyed == 2500+5001, "values not destroyed");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_assoc_cursor ]----------------------------------------
+static int test_assoc_cursor()
+{
+  gds_assoc_array_t * array= assoc_array_create(NULL);
+  gds_assoc_array_cursor_t cursor;
+  char key[16], last[16];
+  const char * cur_key;
+  void * value, * items[16];
+  unsigned int index, count, num;
+  gds_enum_t * enu;
+
+  for (index= 0; index < 1000; index++) {
+    snprintf(key, sizeof(key), "key%u", 999-index);
+    assoc_array_set(array, key, (void *) (size_t) index);
+  }
+  count= 0;
+  GDS_FOREACH(assoc_array, cursor, array, &cur_key, &value) {
+    snprintf(key, sizeof(key), "key%u", 999-count);
+    UTEST_ASSERT(!strcmp(cur_key, key) && (value == (void *) (size_t) count),
+		  "pairs not traversed in insertion order");
+    count++;
+  }
+  UTEST_ASSERT(count == 1000, "incorrect number of pairs traversed");
+  count= 0;
+  GDS_FOREACH(assoc_array, cursor, array, NULL, &value)
+    count++;
+  UTEST_ASSERT(count == 1000, "incorrect number of pairs traversed");
+
+  // Batched enumeration of the values in the order of the keys
+  count= 0;
+  enu= assoc_array_get_sorted_values_enum(array);
+  while ((num= enum_get_next_n(enu, items, 16)) > 0) {
+    for (index= 0; index < num; index++, count++) {
+      snprintf(key, sizeof(key), "key%u",
+	       999 - (unsigned int) (size_t) items[index]);
+      UTEST_ASSERT((count == 0) || (strcmp(last, key) < 0),
+		    "values not enumerated in the order of the keys");
+      strcpy(last, key);
+    }
+  }
+  enum_destroy(&enu);
+  UTEST_ASSERT(count == 1000, "incorrect number of values enumerated");
+  assoc_array_destroy(&array);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 // GDS_CHECK_PTR_ARRAY
@@ -1160,74 +1996,390 @@ static int test_ptr_array_template_sorted()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_ptr_array_cursor ]------------------------------------
+static int test_ptr_array_cursor()
+{
+  ptr_array_t * array= ptr_array_create_ref(0);
+  int_array_t * int_array= int_array_create(0);
+  ptr_array_cursor_t cursor;
+  int_array_cursor_t int_cursor;
+  unsigned int index, count;
+  void * item;
+  int value;
+
+  count= 0;
+  GDS_FOREACH(ptr_array, cursor, array, &item)
+    count++;
+  UTEST_ASSERT(count == 0, "empty array should not be traversed");
+
+  for (index= 0; index < 100; index++) {
+    item= (void *) (size_t) (index+1);
+    ptr_array_append(array, item);
+    int_array_append(int_array, -((int) index));
+  }
+  count= 0;
+  GDS_FOREACH(ptr_array, cursor, array, &item) {
+    UTEST_ASSERT(item == (void *) (size_t) (count+1),
+		  "incorrect item %u returned by cursor", count);
+    count++;
+  }
+  UTEST_ASSERT(count == 100, "incorrect number of items traversed");
+  count= 0;
+  GDS_FOREACH(int_array, int_cursor, int_array, &value) {
+    UTEST_ASSERT(value == -((int) count),
+		  "incorrect item %u returned by cursor", count);
+    count++;
+  }
+  UTEST_ASSERT(count == 100, "incorrect number of items traversed");
+  int_array_destroy(&int_array);
+  ptr_array_destroy(&array);
+  return UTEST_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
-// GDS_CHECK_LIST
+// GDS_CHECK_BTREE
 /////////////////////////////////////////////////////////////////////
 
-#define LIST_NITEMS 1024
-size_t LIST_ITEMS[LIST_NITEMS];
+#include <libgds/btree.h>
 
-// -----[ test_list_init ]-------------------------------------------
-int test_list_init()
+#define BTREE_NKEYS 2000
+
+static unsigned int BTREE_KEYS[BTREE_NKEYS];
+static unsigned int _btree_num_destroyed;
+
+// -----[ _test_btree_cmp ]------------------------------------------
+static int _test_btree_cmp(const void * key1, const void * key2)
 {
-  unsigned int index;
+  unsigned int k1= *((const unsigned int *) key1);
+  unsigned int k2= *((const unsigned int *) key2);
+  return (k1 < k2)?-1:((k1 > k2)?1:0);
+}
 
-  for (index= 0; index < LIST_NITEMS; index++) {
-    if ((index & 1) != 0) {
-      LIST_ITEMS[index]= LIST_NITEMS-(index/2)-1;
-    } else {
-      LIST_ITEMS[index]= index/2;
-    }
+// -----[ _test_btree_destroy ]--------------------------------------
+static void _test_btree_destroy(void * key, void * value)
+{
+  _btree_num_destroyed++;
+}
+
+// -----[ _test_btree_check ]----------------------------------------
+/**
+ * Check that the keys of a range are the even keys from first to
+ * last (the keys of BTREE_KEYS are twice their index), and that the
+ * values are the keys. An empty range is denoted by last= first-2.
+ */
+static int _test_btree_check(gds_btree_t * tree, unsigned int lower,
+			     unsigned int upper, int flags,
+			     unsigned int first, unsigned int last)
+{
+  gds_btree_iter_t iter;
+  void * key, * value;
+  unsigned int expected= first;
+
+  btree_range(tree, &lower, &upper, flags, &iter);
+  while (btree_iter_next(&iter, &key, &value) == 0) {
+    if ((*((unsigned int *) key) != expected) || (key != value))
+      return -1;
+    expected+= 2;
   }
+  return (expected == last+2)?0:-1;
+}
+
+// -----[ test_btree_basic ]-----------------------------------------
+static int test_btree_basic()
+{
+  unsigned int order[BTREE_NKEYS];
+  gds_btree_t * tree;
+  gds_btree_iter_t iter;
+  unsigned int index, tmp, swap, num_keys= BTREE_NKEYS;
+  void * key, * last;
+
+  UTEST_ASSERT(btree_create(3, _test_btree_cmp, NULL) == NULL,
+		"should not accept too small nodes");
+  UTEST_ASSERT(btree_create(BTREE_MAX_NODE_SIZE+1, _test_btree_cmp,
+			    NULL) == NULL,
+		"should not accept too large nodes");
+  for (index= 0; index < BTREE_NKEYS; index++) {
+    BTREE_KEYS[index]= 2*index;
+    order[index]= index;
+  }
+  for (index= BTREE_NKEYS-1; index > 0; index--) {
+    tmp= random() % (index+1);
+    swap= order[index];
+    order[index]= order[tmp];
+    order[tmp]= swap;
+  }
+
+  // Small nodes for many splits and merges
+  _btree_num_destroyed= 0;
+  tree= btree_create(4, _test_btree_cmp, _test_btree_destroy);
+  for (index= 0; index < BTREE_NKEYS; index++)
+    UTEST_ASSERT(btree_insert(tree, &BTREE_KEYS[order[index]],
+			      &BTREE_KEYS[order[index]]) == 0,
+		  "could not insert key");
+  UTEST_ASSERT(btree_insert(tree, &BTREE_KEYS[5], NULL) == -1,
+		"should not insert duplicate key");
+  UTEST_ASSERT(btree_size(tree) == BTREE_NKEYS, "incorrect size");
+  for (index= 0; index < BTREE_NKEYS; index++)
+    UTEST_ASSERT(btree_get(tree, &BTREE_KEYS[index]) == &BTREE_KEYS[index],
+		  "incorrect value returned");
+  tmp= 1;
+  UTEST_ASSERT(btree_get(tree, &tmp) == NULL,
+		"should not find missing key");
+
+  // Remove half of the keys in random order
+  for (index= 0; index < BTREE_NKEYS; index+= 2, num_keys--)
+    UTEST_ASSERT(btree_remove(tree, &BTREE_KEYS[order[index]]) == 0,
+		  "could not remove key");
+  UTEST_ASSERT(btree_remove(tree, &BTREE_KEYS[order[0]]) == -1,
+		"should not remove missing key");
+  UTEST_ASSERT(btree_size(tree) == num_keys, "incorrect size");
+  UTEST_ASSERT(_btree_num_destroyed == BTREE_NKEYS-num_keys,
+		"destroy callback not called");
+  for (index= 0; index < BTREE_NKEYS; index++)
+    UTEST_ASSERT((btree_get(tree, &BTREE_KEYS[order[index]]) == NULL) ==
+		  (index % 2 == 0), "incorrect lookup after removal");
+  last= NULL;
+  tmp= 0;
+  btree_range(tree, NULL, NULL, 0, &iter);
+  while (btree_iter_next(&iter, &key, NULL) == 0) {
+    UTEST_ASSERT((last == NULL) || (_test_btree_cmp(last, key) < 0),
+		  "keys not traversed in order");
+    last= key;
+    tmp++;
+  }
+  UTEST_ASSERT(tmp == num_keys, "incorrect number of keys traversed");
 
+  for (index= 1; index < BTREE_NKEYS; index+= 2)
+    btree_remove(tree, &BTREE_KEYS[order[index]]);
+  UTEST_ASSERT(btree_size(tree) == 0, "tree should be empty");
+  btree_range(tree, NULL, NULL, 0, &iter);
+  UTEST_ASSERT(!btree_iter_has_next(&iter), "empty tree has no key");
+  btree_insert(tree, &BTREE_KEYS[0], NULL);
+  btree_destroy(&tree);
+  UTEST_ASSERT(tree == NULL, "destroyed tree should be NULL");
+  UTEST_ASSERT(_btree_num_destroyed == BTREE_NKEYS+1,
+		"destroy callback not called");
   return UTEST_SUCCESS;
 }
 
-// -----[ test_list_basic ] -----------------------------------------
-/**
- *
- */
-int test_list_basic()
+// -----[ test_btree_range ]-----------------------------------------
+static int test_btree_range()
 {
-  gds_list_t * list;
+  void * keys[BTREE_NKEYS], * swap;
+  gds_btree_t * tree= btree_create(0, _test_btree_cmp, NULL);
+  unsigned int odd[BTREE_NKEYS];
   unsigned int index;
-  void * data;
-
-  test_list_init();
-
-  list= list_create(NULL, NULL, 1);
-  UTEST_ASSERT(list != NULL, "list_create() returned NULL pointer");
 
-  // Add values
-  for (index= 0; index < LIST_NITEMS; index++) {
-    UTEST_ASSERT(list_add(list, (void *) LIST_ITEMS[index]) >= 0,
-		 "incorrect return value in list_add()");
-    UTEST_ASSERT(list_length(list) == index+1,
-		 "incorrect list length returned (%d)", list_length(list),
-		 index+1);
+  for (index= 0; index < BTREE_NKEYS; index++) {
+    BTREE_KEYS[index]= 2*index;
+    keys[index]= &BTREE_KEYS[index];
   }
-
-  // Get content
-  for (index= 0; index < LIST_NITEMS; index++) {
-    data= list_get_at(list, index);
-    UTEST_ASSERT((size_t) data == index,
-		  "incorrect value for list_get_index() %d=>%d",
-		  (size_t) data, index);
+  swap= keys[10];
+  keys[10]= keys[11];
+  keys[11]= swap;
+  UTEST_ASSERT(btree_load(tree, keys, keys, BTREE_NKEYS) == -1,
+		"should not load unsorted keys");
+  keys[11]= keys[10];
+  keys[10]= swap;
+  UTEST_ASSERT(btree_load(tree, keys, keys, BTREE_NKEYS) == 0,
+		"could not load keys");
+  UTEST_ASSERT(btree_load(tree, keys, keys, BTREE_NKEYS) == -1,
+		"should not load non-empty tree");
+  UTEST_ASSERT(btree_size(tree) == BTREE_NKEYS, "incorrect size");
+
+  UTEST_ASSERT(_test_btree_check(tree, 10, 20, 0, 10, 20) == 0,
+		"incorrect range [10,20]");
+  UTEST_ASSERT(_test_btree_check(tree, 10, 20, BTREE_EXCLUDE_LOWER,
+				 12, 20) == 0, "incorrect range ]10,20]");
+  UTEST_ASSERT(_test_btree_check(tree, 10, 20, BTREE_EXCLUDE_UPPER,
+				 10, 18) == 0, "incorrect range [10,20[");
+  UTEST_ASSERT(_test_btree_check(tree, 11, 21,
+				 BTREE_EXCLUDE_LOWER | BTREE_EXCLUDE_UPPER,
+				 12, 20) == 0, "incorrect range ]11,21[");
+  UTEST_ASSERT(_test_btree_check(tree, 0, 2*BTREE_NKEYS, 0,
+				 0, 2*(BTREE_NKEYS-1)) == 0,
+		"incorrect range over all keys");
+  UTEST_ASSERT(_test_btree_check(tree, 2*BTREE_NKEYS, 3*BTREE_NKEYS, 0,
+				 0, -2) == 0, "range after last key");
+  UTEST_ASSERT(_test_btree_check(tree, 20, 20, BTREE_EXCLUDE_LOWER,
+				 0, -2) == 0, "empty range ]20,20]");
+
+  // Insert after the load
+  for (index= 0; index < BTREE_NKEYS; index++) {
+    odd[index]= 2*index+1;
+    UTEST_ASSERT(btree_insert(tree, &odd[index], NULL) == 0,
+		  "could not insert key");
   }
-
-  list_destroy(&list);
-
+  for (index= 0; index < 2*BTREE_NKEYS; index+= 3)
+    UTEST_ASSERT(btree_get(tree, (index % 2)?&odd[index/2]:
+			   &BTREE_KEYS[index/2]) ==
+		  ((index % 2)?NULL:&BTREE_KEYS[index/2]),
+		  "incorrect value returned");
+  UTEST_ASSERT(btree_size(tree) == 2*BTREE_NKEYS, "incorrect size");
+  btree_destroy(&tree);
   return UTEST_SUCCESS;
 }
 
-/////////////////////////////////////////////////////////////////////
-// GDS_CHECK_DLLIST
-/////////////////////////////////////////////////////////////////////
-
-// -----[ _test_dllist_for_each ]------------------------------------
-static int _test_dllist_for_each(void * pUserData, void * pContext)
+// -----[ test_btree_enum ]------------------------------------------
+static int test_btree_enum()
 {
-  return 0;
+  gds_btree_t * tree= btree_create(8, _test_btree_cmp, NULL);
+  unsigned int index, count= 0, lower= 100, upper= 200;
+  gds_enum_t * enu;
+  unsigned int * key;
+
+  for (index= 0; index < BTREE_NKEYS; index++) {
+    BTREE_KEYS[index]= 2*index;
+    btree_insert(tree, &BTREE_KEYS[index], (void *) (size_t) index);
+  }
+  enu= btree_get_keys_enum(tree);
+  while (enum_has_next(enu)) {
+    key= (unsigned int *) enum_get_next(enu);
+    UTEST_ASSERT(*key == 2*count, "incorrect key enumerated");
+    count++;
+  }
+  enum_destroy(&enu);
+  UTEST_ASSERT(count == BTREE_NKEYS, "incorrect number of keys enumerated");
+
+  count= 0;
+  enu= btree_get_range_enum(tree, &lower, &upper, BTREE_EXCLUDE_UPPER,
+			    BTREE_ENUM_VALUES);
+  while (enum_has_next(enu)) {
+    UTEST_ASSERT((size_t) enum_get_next(enu) == 50+count,
+		  "incorrect value enumerated");
+    count++;
+  }
+  enum_destroy(&enu);
+  UTEST_ASSERT(count == 50, "incorrect number of values enumerated");
+  btree_destroy(&tree);
+  return UTEST_SUCCESS;
+}
+
+// -----[ _test_btree_str_cmp ]--------------------------------------
+static int _test_btree_str_cmp(const void * key1, const void * key2)
+{
+  return strcmp((const char *) key1, (const char *) key2);
+}
+
+// -----[ _test_btree_str_destroy ]----------------------------------
+static void _test_btree_str_destroy(void * key, void * value)
+{
+  _btree_num_destroyed++;
+  free(key);
+}
+
+// -----[ test_btree_owned_keys ]------------------------------------
+/**
+ * The keys are owned by the tree and freed when removed, while the
+ * internal nodes use them as separators. The tree is built both by
+ * insertions and by a bulk load.
+ */
+static int test_btree_owned_keys()
+{
+  gds_btree_t * tree;
+  char * keys[200];
+  char buf[16];
+  unsigned int index, pass;
+
+  for (pass= 0; pass < 2; pass++) {
+    _btree_num_destroyed= 0;
+    tree= btree_create(4, _test_btree_str_cmp, _test_btree_str_destroy);
+    for (index= 0; index < 200; index++) {
+      snprintf(buf, sizeof(buf), "%05u", index);
+      keys[index]= strdup(buf);
+      if (pass == 0)
+	UTEST_ASSERT(btree_insert(tree, keys[index], NULL) == 0,
+		     "key insertion should succeed");
+    }
+    if (pass == 1)
+      UTEST_ASSERT(btree_load(tree, (void * const *) keys, NULL, 200) == 0,
+		   "bulk load should succeed");
+    for (index= 0; index < 200; index+= 3) {
+      snprintf(buf, sizeof(buf), "%05u", index);
+      UTEST_ASSERT(btree_remove(tree, buf) == 0,
+		   "key removal should succeed");
+    }
+    for (index= 0; index < 200; index++) {
+      snprintf(buf, sizeof(buf), "%05u", index);
+      UTEST_ASSERT((btree_remove(tree, buf) == 0) == ((index % 3) != 0),
+		   "only the remaining keys should be removed");
+    }
+    UTEST_ASSERT(btree_size(tree) == 0, "tree should be empty");
+    UTEST_ASSERT(_btree_num_destroyed == 200,
+		 "all the keys should be destroyed");
+    btree_destroy(&tree);
+  }
+  return UTEST_SUCCESS;
+}
+
+/////////////////////////////////////////////////////////////////////
+// GDS_CHECK_LIST
+/////////////////////////////////////////////////////////////////////
+
+#define LIST_NITEMS 1024
+size_t LIST_ITEMS[LIST_NITEMS];
+
+// -----[ test_list_init ]-------------------------------------------
+int test_list_init()
+{
+  unsigned int index;
+
+  for (index= 0; index < LIST_NITEMS; index++) {
+    if ((index & 1) != 0) {
+      LIST_ITEMS[index]= LIST_NITEMS-(index/2)-1;
+    } else {
+      LIST_ITEMS[index]= index/2;
+    }
+  }
+
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_list_basic ] -----------------------------------------
+/**
+ *
+ */
+int test_list_basic()
+{
+  gds_list_t * list;
+  unsigned int index;
+  void * data;
+
+  test_list_init();
+
+  list= list_create(NULL, NULL, 1);
+  UTEST_ASSERT(list != NULL, "list_create() returned NULL pointer");
+
+  // Add values
+  for (index= 0; index < LIST_NITEMS; index++) {
+    UTEST_ASSERT(list_add(list, (void *) LIST_ITEMS[index]) >= 0,
+		 "incorrect return value in list_add()");
+    UTEST_ASSERT(list_length(list) == index+1,
+		 "incorrect list length returned (%d)", list_length(list),
+		 index+1);
+  }
+
+  // Get content
+  for (index= 0; index < LIST_NITEMS; index++) {
+    data= list_get_at(list, index);
+    UTEST_ASSERT((size_t) data == index,
+		  "incorrect value for list_get_index() %d=>%d",
+		  (size_t) data, index);
+  }
+
+  list_destroy(&list);
+
+  return UTEST_SUCCESS;
+}
+
+/////////////////////////////////////////////////////////////////////
+// GDS_CHECK_DLLIST
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _test_dllist_for_each ]------------------------------------
+static int _test_dllist_for_each(void * pUserData, void * pContext)
+{
+  return 0;
 }
 
 #define DLLIST_NUM_ITEMS 1024
@@ -1270,6 +2422,183 @@ int test_dllist_basic()
   return UTEST_SUCCESS;
 }
 
+// -----[ _test_dllist_check ]---------------------------------------
+/**
+ * Check the content of a list, walking it in both directions.
+ */
+static int _test_dllist_check(gds_dllist_t * list, const size_t * values,
+			      unsigned int num_values)
+{
+  gds_dllist_item_t * item;
+  unsigned int index;
+
+  if (dllist_size(list) != num_values)
+    return -1;
+  item= dllist_head(list);
+  for (index= 0; index < num_values; index++, item= item->next)
+    if ((item == NULL) || (item->user_data != (void *) values[index]))
+      return -1;
+  if (item != NULL)
+    return -1;
+  item= dllist_tail(list);
+  for (index= num_values; index > 0; index--, item= item->prev)
+    if ((item == NULL) || (item->user_data != (void *) values[index-1]))
+      return -1;
+  return (item == NULL)?0:-1;
+}
+
+// -----[ test_dllist_handles ]--------------------------------------
+int test_dllist_handles()
+{
+  static const size_t VALUES1[]= { 55, 1, 110, 2, 3, 666 };
+  static const size_t VALUES2[]= { 1, 110, 3 };
+  static const size_t VALUES3[]= { 3, 110, 1 };
+  static const size_t VALUES4[]= { 3, 7, 8, 110, 1, 9 };
+  gds_dllist_t * list= dllist_create(NULL);
+  gds_dllist_t * other= dllist_create(NULL);
+  gds_dllist_t * intrusive= dllist_create_intrusive(NULL);
+  gds_dllist_item_t * item1, * item2, * item3, * item110;
+  void * data;
+
+  // Index-based functions
+  item1= dllist_append(list, (void *) 1);
+  item2= dllist_append(list, (void *) 2);
+  item3= dllist_append(list, (void *) 3);
+  UTEST_ASSERT(dllist_insert(list, 0, (void *) 55) == 0,
+		"could not insert at head");
+  UTEST_ASSERT(dllist_insert(list, 2, (void *) 110) == 0,
+		"could not insert in list");
+  UTEST_ASSERT(dllist_insert(list, 5, (void *) 666) == 0,
+		"could not insert at tail");
+  UTEST_ASSERT(dllist_insert(list, 7, (void *) 777) == -1,
+		"should not insert beyond tail");
+  UTEST_ASSERT(_test_dllist_check(list, VALUES1, 6) == 0,
+		"incorrect content after insertions");
+  UTEST_ASSERT((dllist_get(list, 4, &data) == 0) && (data == (void *) 3),
+		"incorrect value returned at 4");
+  UTEST_ASSERT(dllist_get(list, 6, &data) == -1,
+		"should not get value beyond tail");
+  UTEST_ASSERT(dllist_remove(list, 0) == 0, "could not remove head");
+  UTEST_ASSERT(dllist_remove(list, 4) == 0, "could not remove tail");
+  UTEST_ASSERT(dllist_remove(list, 4) == -1,
+		"should not remove beyond tail");
+
+  // Handle-based functions
+  dllist_remove_item(list, item2);
+  UTEST_ASSERT(_test_dllist_check(list, VALUES2, 3) == 0,
+		"incorrect content after removals");
+  item110= item1->next;
+  dllist_unlink(list, item3);
+  dllist_insert_after(list, NULL, item3);
+  dllist_unlink(list, item1);
+  dllist_insert_before(list, NULL, item1);
+  UTEST_ASSERT(_test_dllist_check(list, VALUES3, 3) == 0,
+		"incorrect content after moves");
+
+  // Splice
+  dllist_append(other, (void *) 7);
+  dllist_append(other, (void *) 8);
+  UTEST_ASSERT(dllist_splice(list, item110, other) == 0,
+		"could not splice list");
+  UTEST_ASSERT(dllist_size(other) == 0, "source list should be empty");
+  dllist_append(other, (void *) 9);
+  UTEST_ASSERT(dllist_splice(list, NULL, other) == 0,
+		"could not splice list");
+  UTEST_ASSERT(_test_dllist_check(list, VALUES4, 6) == 0,
+		"incorrect content after splice");
+  UTEST_ASSERT(dllist_splice(other, NULL, list) == 0,
+		"could not splice list");
+  UTEST_ASSERT(_test_dllist_check(other, VALUES4, 6) == 0,
+		"incorrect content after splice in empty list");
+  UTEST_ASSERT(_test_dllist_check(list, NULL, 0) == 0,
+		"source list should be empty");
+  UTEST_ASSERT(dllist_splice(intrusive, NULL, other) == -1,
+		"should not splice lists of different kinds");
+
+  dllist_destroy(&intrusive);
+  dllist_destroy(&other);
+  dllist_destroy(&list);
+  return UTEST_SUCCESS;
+}
+
+typedef struct {
+  int               value;
+  gds_dllist_item_t node;
+} _test_dllist_entry_t;
+
+static unsigned int _dllist_destroy_count;
+
+// -----[ _test_dllist_intrusive_destroy ]---------------------------
+static void _test_dllist_intrusive_destroy(void * item)
+{
+  DLLIST_ENTRY(item, _test_dllist_entry_t, node)->value= -1;
+  _dllist_destroy_count++;
+}
+
+// -----[ _test_dllist_intrusive_sum ]-------------------------------
+static int _test_dllist_intrusive_sum(void * item, void * ctx)
+{
+  *((int *) ctx)+= DLLIST_ENTRY(item, _test_dllist_entry_t, node)->value;
+  return 0;
+}
+
+// -----[ test_dllist_intrusive ]------------------------------------
+int test_dllist_intrusive()
+{
+  _test_dllist_entry_t entries[8];
+  gds_dllist_t * list=
+    dllist_create_intrusive(_test_dllist_intrusive_destroy);
+  gds_dllist_item_t * item;
+  unsigned int index;
+  void * data;
+  int sum;
+
+  for (index= 0; index < 8; index++) {
+    entries[index].value= index;
+    dllist_insert_before(list, NULL, &entries[index].node);
+  }
+  UTEST_ASSERT(dllist_size(list) == 8, "incorrect size");
+
+  // Data cannot be added without an embedded item
+  UTEST_ASSERT(dllist_append(list, &entries[0]) == NULL,
+		"dllist_append() should fail on an intrusive list");
+  UTEST_ASSERT(dllist_insert(list, 0, &entries[0]) == -1,
+		"dllist_insert() should fail on an intrusive list");
+  UTEST_ASSERT(dllist_size(list) == 8, "incorrect size");
+
+  // Unlink 0, 3 and 7 => (1, 2, 4, 5, 6)
+  dllist_unlink(list, &entries[0].node);
+  dllist_unlink(list, &entries[3].node);
+  dllist_unlink(list, &entries[7].node);
+  UTEST_ASSERT(dllist_size(list) == 5, "incorrect size after unlink");
+  UTEST_ASSERT(entries[3].value == 3, "unlink should not destroy item");
+
+  // Re-insert 3 at head and 0 after 6 => (3, 1, 2, 4, 5, 6, 0)
+  dllist_insert_after(list, NULL, &entries[3].node);
+  dllist_insert_after(list, &entries[6].node, &entries[0].node);
+  UTEST_ASSERT(dllist_tail(list) == &entries[0].node,
+		"incorrect tail");
+  UTEST_ASSERT((dllist_get(list, 2, &data) == 0) &&
+		(data == &entries[2].node), "incorrect item returned at 2");
+  item= dllist_head(list);
+  UTEST_ASSERT(DLLIST_ENTRY(item, _test_dllist_entry_t, node) == &entries[3],
+		"incorrect enclosing structure");
+  sum= 0;
+  dllist_for_each(list, &sum, _test_dllist_intrusive_sum);
+  UTEST_ASSERT(sum == 21, "incorrect for-each sum (%d)", sum);
+
+  dllist_remove_item(list, &entries[4].node);
+  UTEST_ASSERT((entries[4].value == -1) && (_dllist_destroy_count == 1),
+		"destroy callback should be called on removal");
+  _dllist_destroy_count= 0;
+  dllist_destroy(&list);
+  UTEST_ASSERT(_dllist_destroy_count == 6,
+		"destroy callback should be called for each item");
+  UTEST_ASSERT((entries[7].value == 7) && (entries[6].value == -1),
+		"incorrect items destroyed");
+  return UTEST_SUCCESS;
+}
+
 // ----- test_dllist ------------------------------------------------
 /**
  * Purpose of the test:
@@ -1551,6 +2880,314 @@ static int test_radix_ipv4()
   return UTEST_SUCCESS;
 }
 
+// -----[ _test_radix_dir24_8_check ]--------------------------------
+static int _test_radix_dir24_8_check(gds_radix_tree_t * tree,
+				     gds_dir24_8_t * table)
+{
+  unsigned int index;
+  uint32_t key;
+
+  for (index= 0; index < 100000; index++) {
+    key= (uint32_t) random() ^ ((uint32_t) random() << 16);
+    if (index % 3 == 1)
+      key&= 0x00ffffff;
+    else if (index % 3 == 2)
+      key= IPV4_TO_INT(10, 1, 0, 0) | (key & 0x0000ffff);
+    if (dir24_8_lookup(table, key) != radix_tree_get_best(tree, key, 32))
+      return -1;
+  }
+  for (index= 0; index < RADIX_NITEMS; index++) {
+    key= (uint32_t) RADIX_ITEMS[index];
+    if ((dir24_8_lookup(table, key) != radix_tree_get_best(tree, key, 32)) ||
+	(dir24_8_lookup(table, key+1) !=
+	 radix_tree_get_best(tree, key+1, 32)))
+      return -1;
+  }
+  return 0;
+}
+
+// -----[ test_radix_dir24_8 ]---------------------------------------
+static int test_radix_dir24_8()
+{
+  gds_radix_tree_t * tree= radix_tree_create(32, NULL);
+  gds_dir24_8_t * table;
+  unsigned int index;
+
+  radix_tree_add(tree, IPV4_TO_INT(0, 0, 0, 0), 0, (void *) 1);
+  radix_tree_add(tree, IPV4_TO_INT(10, 0, 0, 0), 8, (void *) 2);
+  radix_tree_add(tree, IPV4_TO_INT(10, 1, 0, 0), 16, (void *) 3);
+  radix_tree_add(tree, IPV4_TO_INT(10, 1, 1, 0), 24, (void *) 4);
+  radix_tree_add(tree, IPV4_TO_INT(10, 1, 1, 128), 25, (void *) 5);
+  radix_tree_add(tree, IPV4_TO_INT(10, 1, 1, 130), 32, (void *) 6);
+  radix_tree_add(tree, IPV4_TO_INT(10, 1, 2, 0), 23, (void *) 7);
+  for (index= 0; index < RADIX_NITEMS; index++)
+    radix_tree_add(tree, (uint32_t) RADIX_ITEMS[index], 32,
+		   (void *) (size_t) (index+10));
+
+  table= radix_tree_compile_dir24_8(tree);
+  UTEST_ASSERT(table != NULL, "DIR-24-8 table should not be NULL");
+  UTEST_ASSERT(dir24_8_num_chunks(table) > 0,
+		"DIR-24-8 table should use second level chunks");
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(10, 1, 1, 130)) == (void *) 6,
+		"incorrect DIR-24-8 lookup result");
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(10, 1, 1, 129)) == (void *) 5,
+		"incorrect DIR-24-8 lookup result");
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(10, 1, 1, 1)) == (void *) 4,
+		"incorrect DIR-24-8 lookup result");
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(10, 1, 3, 1)) == (void *) 7,
+		"incorrect DIR-24-8 lookup result");
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(10, 2, 0, 1)) == (void *) 2,
+		"incorrect DIR-24-8 lookup result");
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(1, 2, 3, 4)) == (void *) 1,
+		"incorrect DIR-24-8 lookup result");
+  UTEST_ASSERT(_test_radix_dir24_8_check(tree, table) == 0,
+		"DIR-24-8 lookup differs from radix_tree_get_best()");
+
+  // Incremental updates
+  radix_tree_remove(tree, IPV4_TO_INT(10, 1, 1, 128), 25, 1);
+  dir24_8_update(table, IPV4_TO_INT(10, 1, 1, 128), 25);
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(10, 1, 1, 129)) == (void *) 4,
+		"incorrect DIR-24-8 lookup result after remove");
+  radix_tree_remove(tree, IPV4_TO_INT(10, 1, 1, 130), 32, 1);
+  dir24_8_update(table, IPV4_TO_INT(10, 1, 1, 130), 32);
+  radix_tree_add(tree, IPV4_TO_INT(10, 1, 0, 0), 20, (void *) 8);
+  dir24_8_update(table, IPV4_TO_INT(10, 1, 0, 0), 20);
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(10, 1, 1, 130)) == (void *) 4,
+		"incorrect DIR-24-8 lookup result after remove");
+  UTEST_ASSERT(dir24_8_lookup(table, IPV4_TO_INT(10, 1, 4, 1)) == (void *) 8,
+		"incorrect DIR-24-8 lookup result after add");
+  for (index= 0; index < RADIX_NITEMS; index+= 2) {
+    radix_tree_remove(tree, (uint32_t) RADIX_ITEMS[index], 32, 1);
+    dir24_8_update(table, (uint32_t) RADIX_ITEMS[index], 32);
+  }
+  radix_tree_remove(tree, IPV4_TO_INT(10, 0, 0, 0), 8, 1);
+  dir24_8_update(table, IPV4_TO_INT(10, 0, 0, 0), 8);
+  UTEST_ASSERT(_test_radix_dir24_8_check(tree, table) == 0,
+		"DIR-24-8 lookup differs from radix_tree_get_best()");
+  UTEST_ASSERT(dir24_8_update(table, 0, 33) < 0,
+		"dir24_8_update() should fail with invalid prefix length");
+
+  dir24_8_destroy(&table);
+  UTEST_ASSERT(table == NULL, "destroyed DIR-24-8 table should be NULL");
+
+  // Only 32-bit radix-trees can be compiled
+  radix_tree_destroy(&tree);
+  tree= radix_tree_create(16, NULL);
+  UTEST_ASSERT(radix_tree_compile_dir24_8(tree) == NULL,
+		"DIR-24-8 table should only be built from 32-bit keys");
+  radix_tree_destroy(&tree);
+  return UTEST_SUCCESS;
+}
+
+#define RADIX_BULK_NITEMS 2000
+
+// -----[ test_radix_bulk_load ]-------------------------------------
+static int test_radix_bulk_load()
+{
+  gds_radix_tree_bulk_item_t items[RADIX_BULK_NITEMS];
+  gds_radix_tree_t * tree= radix_tree_create(32, NULL);
+  gds_radix_tree_t * ref= radix_tree_create(32, NULL);
+  unsigned int index, num_items= 0;
+  uint32_t key;
+
+  for (index= 0; index < RADIX_BULK_NITEMS; index++) {
+    items[num_items].key= ((uint32_t) (random() % 16) << 28) |
+      ((uint32_t) random() & 0x0fffffff);
+    items[num_items].key_len= 1 + random() % 32;
+    items[num_items].data= (void *) (size_t) (index+1);
+    if (radix_tree_get_exact(ref, items[num_items].key,
+			     items[num_items].key_len) == NULL) {
+      radix_tree_add(ref, items[num_items].key, items[num_items].key_len,
+		     items[num_items].data);
+      num_items++;
+    }
+  }
+  UTEST_ASSERT(radix_tree_bulk_load(tree, items, num_items) == 0,
+	       "bulk load should succeed");
+  UTEST_ASSERT(radix_tree_num_nodes(tree, 0) == radix_tree_num_nodes(ref, 0),
+	       "bulk loaded tree should have %d nodes (not %d)",
+	       radix_tree_num_nodes(ref, 0), radix_tree_num_nodes(tree, 0));
+  for (index= 0; index < 10000; index++) {
+    key= (uint32_t) random() ^ ((uint32_t) random() << 16);
+    UTEST_ASSERT(radix_tree_get_best(tree, key, 32) ==
+		 radix_tree_get_best(ref, key, 32),
+		 "best match differs for %u", key);
+  }
+  for (index= 0; index < num_items; index+= 2)
+    UTEST_ASSERT(radix_tree_remove(tree, items[index].key,
+				   items[index].key_len, 1) == 0,
+		 "could not remove %u/%u",
+		 items[index].key, items[index].key_len);
+  for (index= 1; index < num_items; index+= 2)
+    UTEST_ASSERT(radix_tree_get_exact(tree, items[index].key,
+				      items[index].key_len)
+		 == items[index].data,
+		 "exact match failed for %u/%u after remove",
+		 items[index].key, items[index].key_len);
+  radix_tree_destroy(&tree);
+  radix_tree_destroy(&ref);
+
+  // Keys longer than the tree's key length and duplicate keys
+  tree= radix_tree_create(16, NULL);
+  items[0].key= 0x1234;
+  items[0].key_len= 16;
+  items[1].key= 0x1200;
+  items[1].key_len= 8;
+  UTEST_ASSERT(radix_tree_bulk_load(tree, items, 2) == 0,
+	       "bulk load should succeed");
+  UTEST_ASSERT((radix_tree_get_best(tree, 0x12ff, 16) == items[1].data) &&
+	       (radix_tree_get_exact(tree, 0x1234, 16) == items[0].data),
+	       "incorrect lookup result in 16-bit tree");
+  radix_tree_destroy(&tree);
+  tree= radix_tree_create(16, NULL);
+  items[1].key_len= 17;
+  UTEST_ASSERT(radix_tree_bulk_load(tree, items, 2) < 0,
+	       "bulk load should fail with too long key");
+  items[1]= items[0];
+  UTEST_ASSERT(radix_tree_bulk_load(tree, items, 2) < 0,
+	       "bulk load should fail with duplicate key");
+  UTEST_ASSERT(radix_tree_num_nodes(tree, 0) == 0,
+	       "tree should remain empty after failed bulk load");
+
+  // Same failures in a non-empty tree
+  radix_tree_add(tree, 0x5600, 8, items[0].data);
+  items[1].key= 0x1200;
+  items[1].key_len= 17;
+  UTEST_ASSERT(radix_tree_bulk_load(tree, items, 2) < 0,
+	       "bulk load should fail with too long key (non-empty tree)");
+  UTEST_ASSERT(radix_tree_get_exact(tree, 0x1234, 16) == items[0].data,
+	       "key before the too long key should be added");
+  items[1].key= 0x5600;
+  items[1].key_len= 8;
+  UTEST_ASSERT(radix_tree_bulk_load(tree, items + 1, 1) < 0,
+	       "bulk load should fail with existing key");
+  items[1]= items[0];
+  UTEST_ASSERT(radix_tree_bulk_load(tree, items, 2) < 0,
+	       "bulk load should fail with duplicate key (non-empty tree)");
+  radix_tree_destroy(&tree);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_radix_cursor ]----------------------------------------
+static int test_radix_cursor()
+{
+  gds_radix_tree_t * tree= radix_tree_create(32, NULL);
+  gds_radix_tree_cursor_t cursor;
+  uint32_t key, last_key= 0;
+  uint8_t key_len, last_key_len= 0;
+  unsigned int index, num_items= 0, count= 0;
+  void * data;
+  gds_enum_t * enu;
+
+  GDS_FOREACH(radix_tree, cursor, tree, &key, &key_len, &data)
+    count++;
+  UTEST_ASSERT(count == 0, "empty tree should not be traversed");
+
+  // Random prefixes, including the default one
+  for (index= 0; index < 2000; index++) {
+    key_len= random() % 33;
+    key= ((uint32_t) (random() % 16) << 28) |
+      ((uint32_t) random() & 0x0fffffff);
+    key= (key_len == 0)?0:(key & (0xffffffffU << (32-key_len)));
+    if (radix_tree_get_exact(tree, key, key_len) == NULL) {
+      radix_tree_add(tree, key, key_len, (void *) (size_t) (index+1));
+      num_items++;
+    }
+  }
+
+  // Keys in increasing order, a prefix before the longer ones
+  GDS_FOREACH(radix_tree, cursor, tree, &key, &key_len, &data) {
+    UTEST_ASSERT((count == 0) || (key > last_key) ||
+		 ((key == last_key) && (key_len > last_key_len)),
+		 "prefixes not traversed in order");
+    UTEST_ASSERT(radix_tree_get_exact(tree, key, key_len) == data,
+		 "incorrect data returned for %u/%u", key, key_len);
+    last_key= key;
+    last_key_len= key_len;
+    count++;
+  }
+  UTEST_ASSERT(count == num_items,
+	       "incorrect number of items traversed (%u vs %u)",
+	       count, num_items);
+
+  // The enumeration follows the same order
+  enu= radix_tree_get_enum(tree);
+  radix_tree_cursor_init(&cursor, tree);
+  while (radix_tree_cursor_next(&cursor, NULL, NULL, &data))
+    UTEST_ASSERT(enum_has_next(enu) && (*((void **) enum_get_next(enu)) == data),
+		 "enumeration and cursor differ");
+  UTEST_ASSERT(!enum_has_next(enu), "enumeration and cursor differ");
+  enum_destroy(&enu);
+  radix_tree_destroy(&tree);
+  return UTEST_SUCCESS;
+}
+
+// -----[ _test_radix_for_each_stop ]--------------------------------
+static int _test_radix_for_each_stop(uint32_t key, uint8_t key_len,
+				     void * data, void * ctx)
+{
+  unsigned int * count= (unsigned int *) ctx;
+  return (++(*count) == 10)?1:0;
+}
+
+// -----[ test_radix_prefix_enum ]-----------------------------------
+static int test_radix_prefix_enum()
+{
+  gds_radix_tree_t * tree= radix_tree_create(32, NULL);
+  gds_radix_tree_cursor_t cursor;
+  uint32_t key, prefix, mask;
+  uint8_t key_len, prefix_len;
+  unsigned int index, count;
+  void * data;
+  gds_enum_t * enu;
+
+  for (index= 0; index < 2000; index++) {
+    key_len= random() % 33;
+    key= ((uint32_t) (random() % 16) << 28) |
+      ((uint32_t) random() & 0x0fffffff);
+    key= (key_len == 0)?0:(key & (0xffffffffU << (32-key_len)));
+    if (radix_tree_get_exact(tree, key, key_len) == NULL)
+      radix_tree_add(tree, key, key_len, (void *) (size_t) (index+1));
+  }
+
+  // The enumeration follows the cursor, restricted to the prefix
+  for (index= 0; index < 200; index++) {
+    prefix= ((uint32_t) (random() % 16) << 28) |
+      ((uint32_t) random() & 0x0fffffff);
+    prefix_len= (index == 0)?0:random() % 9;
+    mask= (prefix_len == 0)?0:(0xffffffffU << (32-prefix_len));
+    enu= radix_tree_get_prefix_enum(tree, prefix, prefix_len);
+    count= 0;
+    GDS_FOREACH(radix_tree, cursor, tree, &key, &key_len, &data) {
+      if ((key_len < prefix_len) || ((key & mask) != (prefix & mask)))
+	continue;
+      UTEST_ASSERT(enum_has_next(enu) &&
+		   (*((void **) enum_get_next(enu)) == data),
+		   "prefix enumeration differs for %u/%u",
+		   prefix, prefix_len);
+      count++;
+    }
+    UTEST_ASSERT(!enum_has_next(enu),
+		 "prefix enumeration returned too many items");
+    enum_destroy(&enu);
+    UTEST_ASSERT((index > 0) || (count > 0),
+		 "enumeration of the whole tree should not be empty");
+  }
+  enu= radix_tree_get_prefix_enum(tree, 0, 33);
+  UTEST_ASSERT(!enum_has_next(enu),
+	       "enumeration with too long prefix should be empty");
+  enum_destroy(&enu);
+
+  // Early termination of the for-each traversal
+  count= 0;
+  UTEST_ASSERT(radix_tree_for_each(tree, _test_radix_for_each_stop,
+				   &count) == 1,
+	       "for-each should return the callback result");
+  UTEST_ASSERT(count == 10, "for-each should stop after 10 items");
+  radix_tree_destroy(&tree);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 // GDS_CHECK_TOKENIZER
@@ -2447,6 +4084,214 @@ static int test_trie_complex()
   return UTEST_SUCCESS;
 }
 
+#define TRIE_BULK_NITEMS 2000
+
+// -----[ test_trie_bulk_load ]--------------------------------------
+static int test_trie_bulk_load()
+{
+  gds_trie_bulk_item_t items[TRIE_BULK_NITEMS];
+  gds_trie_bulk_item_t sorted[]= {
+    { IPV4_TO_INT(0, 0, 0, 0), 0, (void *) 1 },
+    { IPV4_TO_INT(10, 0, 0, 0), 8, (void *) 2 },
+    { IPV4_TO_INT(10, 1, 0, 0), 16, (void *) 3 },
+    { IPV4_TO_INT(10, 1, 2, 0), 24, (void *) 4 },
+    { IPV4_TO_INT(10, 128, 0, 0), 9, (void *) 5 },
+    { IPV4_TO_INT(192, 168, 0, 0), 16, (void *) 6 },
+  };
+  unsigned int num_sorted= sizeof(sorted)/sizeof(sorted[0]);
+  gds_trie_t * trie= trie_create(NULL);
+  gds_trie_t * ref= trie_create(NULL);
+  unsigned int index, num_items= 0;
+
+  // Unsorted keys with clustered prefixes and unmasked bits
+  for (index= 0; index < TRIE_BULK_NITEMS; index++) {
+    items[num_items].key= ((uint32_t) (random() % 16) << 28) |
+      ((uint32_t) random() & 0x0fffffff);
+    items[num_items].key_len= 1 + random() % 32;
+    items[num_items].data= (void *) (size_t) (index+1);
+    if (trie_insert(ref, items[num_items].key, items[num_items].key_len,
+		    items[num_items].data, 0) == TRIE_SUCCESS)
+      num_items++;
+  }
+  UTEST_ASSERT(trie_bulk_load(trie, items, num_items) == TRIE_SUCCESS,
+	       "bulk load should succeed");
+  UTEST_ASSERT(trie_num_nodes(trie, 0) == trie_num_nodes(ref, 0),
+	       "bulk loaded trie should have %d nodes (not %d)",
+	       trie_num_nodes(ref, 0), trie_num_nodes(trie, 0));
+  for (index= 0; index < num_items; index++)
+    UTEST_ASSERT(trie_find_exact(trie, items[index].key,
+				 items[index].key_len) == items[index].data,
+		 "exact match failed for %u/%u",
+		 items[index].key, items[index].key_len);
+  for (index= 0; index < num_items; index+= 2)
+    UTEST_ASSERT(trie_remove(trie, items[index].key,
+			     items[index].key_len) == TRIE_SUCCESS,
+		 "could not remove %u/%u",
+		 items[index].key, items[index].key_len);
+  for (index= 1; index < num_items; index+= 2)
+    UTEST_ASSERT(trie_find_exact(trie, items[index].key,
+				 items[index].key_len) == items[index].data,
+		 "exact match failed for %u/%u after remove",
+		 items[index].key, items[index].key_len);
+  trie_destroy(&trie);
+  trie_destroy(&ref);
+
+  // Sorted keys
+  trie= trie_create(NULL);
+  UTEST_ASSERT(trie_bulk_load(trie, sorted, num_sorted) == TRIE_SUCCESS,
+	       "bulk load should succeed");
+  UTEST_ASSERT(trie_num_nodes(trie, 1) == num_sorted,
+	       "bulk loaded trie should have %u keys", num_sorted);
+  UTEST_ASSERT(trie_find_best(trie, IPV4_TO_INT(10, 1, 2, 3), 32) ==
+	       (void *) 4, "best match failed");
+  UTEST_ASSERT(trie_find_best(trie, IPV4_TO_INT(10, 200, 2, 3), 32) ==
+	       (void *) 5, "best match failed");
+  UTEST_ASSERT(trie_find_best(trie, IPV4_TO_INT(11, 0, 0, 0), 32) ==
+	       (void *) 1, "best match failed");
+
+  // Non-empty trie: the load stops at the first existing key
+  items[0].key= IPV4_TO_INT(10, 0, 0, 0);
+  items[0].key_len= 7;
+  items[0].data= (void *) 20;
+  items[1]= sorted[0];
+  items[1].data= (void *) 10;
+  items[2].key= IPV4_TO_INT(172, 16, 0, 0);
+  items[2].key_len= 12;
+  items[2].data= (void *) 30;
+  UTEST_ASSERT(trie_bulk_load(trie, items, 3) == TRIE_ERROR_DUPLICATE,
+	       "bulk load should report duplicate key");
+  UTEST_ASSERT(trie_find_exact(trie, 0, 0) == (void *) 1,
+	       "existing key should not be replaced");
+  UTEST_ASSERT(trie_find_exact(trie, IPV4_TO_INT(10, 0, 0, 0), 7) ==
+	       (void *) 20, "key before the duplicate should be inserted");
+  UTEST_ASSERT(trie_find_exact(trie, IPV4_TO_INT(172, 16, 0, 0), 12) ==
+	       NULL, "key after the duplicate should not be inserted");
+  trie_destroy(&trie);
+
+  // Duplicate keys
+  trie= trie_create(NULL);
+  sorted[2].key= IPV4_TO_INT(10, 1, 255, 255);
+  UTEST_ASSERT(trie_bulk_load(trie, sorted+2, 2) == TRIE_SUCCESS,
+	       "bulk load should succeed");
+  trie_destroy(&trie);
+  trie= trie_create(NULL);
+  sorted[3]= sorted[2];
+  UTEST_ASSERT(trie_bulk_load(trie, sorted, num_sorted) ==
+	       TRIE_ERROR_DUPLICATE, "bulk load should report duplicate key");
+  UTEST_ASSERT(trie_num_nodes(trie, 0) == 0,
+	       "trie should remain empty after failed bulk load");
+  trie_destroy(&trie);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_trie_cursor ]-------------------------------------
+static int test_trie_cursor()
+{
+  gds_trie_t * trie= trie_create(NULL);
+  gds_trie_cursor_t cursor;
+  trie_key_t key, last_key= 0;
+  trie_key_len_t key_len, last_key_len= 0;
+  unsigned int index, num_items= 0, count= 0;
+  void * data;
+
+  GDS_FOREACH(trie, cursor, trie, &key, &key_len, &data)
+    count++;
+  UTEST_ASSERT(count == 0, "empty trie should not be traversed");
+
+  // Random prefixes, including the default one
+  for (index= 0; index < 2000; index++) {
+    key= ((uint32_t) (random() % 16) << 28) |
+      ((uint32_t) random() & 0x0fffffff);
+    key_len= random() % 33;
+    if (trie_insert(trie, key, key_len, (void *) (size_t) (index+1), 0)
+	== TRIE_SUCCESS)
+      num_items++;
+  }
+
+  // Keys in increasing order, a prefix before the longer ones
+  GDS_FOREACH(trie, cursor, trie, &key, &key_len, &data) {
+    UTEST_ASSERT((count == 0) || (key > last_key) ||
+		  ((key == last_key) && (key_len > last_key_len)),
+		  "prefixes not traversed in order");
+    UTEST_ASSERT(trie_find_exact(trie, key, key_len) == data,
+		  "incorrect data returned for %u/%u", key, key_len);
+    last_key= key;
+    last_key_len= key_len;
+    count++;
+  }
+  UTEST_ASSERT(count == num_items,
+		"incorrect number of items traversed (%u vs %u)",
+		count, num_items);
+  count= 0;
+  GDS_FOREACH(trie, cursor, trie, NULL, NULL, &data)
+    count++;
+  UTEST_ASSERT(count == num_items, "incorrect number of items traversed");
+  trie_destroy(&trie);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_trie_prefix_enum ]--------------------------------
+static int test_trie_prefix_enum()
+{
+  gds_trie_t * trie= trie_create(NULL);
+  gds_trie_cursor_t cursor;
+  trie_key_t key, prefix, mask;
+  trie_key_len_t key_len, prefix_len;
+  unsigned int index, count;
+  void * data;
+  gds_enum_t * enu;
+
+  for (index= 0; index < 2000; index++)
+    trie_insert(trie, ((uint32_t) (random() % 16) << 28) |
+		((uint32_t) random() & 0x0fffffff), random() % 33,
+		(void *) (size_t) (index+1), 0);
+
+  // The enumeration follows the cursor, restricted to the prefix
+  for (index= 0; index < 200; index++) {
+    prefix= ((uint32_t) (random() % 16) << 28) |
+      ((uint32_t) random() & 0x0fffffff);
+    prefix_len= (index == 0)?0:random() % 9;
+    mask= (prefix_len == 0)?0:(0xffffffffU << (32-prefix_len));
+    enu= trie_get_prefix_enum(trie, prefix, prefix_len);
+    count= 0;
+    GDS_FOREACH(trie, cursor, trie, &key, &key_len, &data) {
+      if ((key_len < prefix_len) || ((key & mask) != (prefix & mask)))
+	continue;
+      UTEST_ASSERT(enum_has_next(enu) &&
+		    (*((void **) enum_get_next(enu)) == data),
+		    "prefix enumeration differs for %u/%u",
+		    prefix, prefix_len);
+      count++;
+    }
+    UTEST_ASSERT(!enum_has_next(enu),
+		  "prefix enumeration returned too many items");
+    enum_destroy(&enu);
+    UTEST_ASSERT((index > 0) || (count > 0),
+		  "enumeration of the whole trie should not be empty");
+  }
+
+  // Early termination and prefix not in the trie
+  enu= trie_get_enum(trie);
+  UTEST_ASSERT(enum_has_next(enu), "enumeration should not be empty");
+  enum_get_next(enu);
+  enum_destroy(&enu);
+  trie_destroy(&trie);
+  trie= trie_create(NULL);
+  trie_insert(trie, IPV4_TO_INT(10, 0, 0, 0), 8, (void *) 1, 0);
+  trie_insert(trie, IPV4_TO_INT(10, 1, 0, 0), 16, (void *) 2, 0);
+  enu= trie_get_prefix_enum(trie, IPV4_TO_INT(10, 0, 0, 0), 9);
+  UTEST_ASSERT(enum_has_next(enu) &&
+		(*((void **) enum_get_next(enu)) == (void *) 2) &&
+		!enum_has_next(enu),
+		"prefix enumeration should only return 10.1/16");
+  enum_destroy(&enu);
+  enu= trie_get_prefix_enum(trie, IPV4_TO_INT(10, 128, 0, 0), 9);
+  UTEST_ASSERT(!enum_has_next(enu), "prefix enumeration should be empty");
+  enum_destroy(&enu);
+  trie_destroy(&trie);
+  return UTEST_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
 // GDS_CHECK_TRIE_DICT
 /////////////////////////////////////////////////////////////////////
@@ -2804,19 +4649,145 @@ static int test_trie_dict_remove_missing()
   return UTEST_SUCCESS;
 }
 
-static int test_trie_dict_foreach()
+// -----[ _test_trie_dict_foreach_cb ]-------------------------------
+static int _test_trie_dict_foreach_cb(trie_dico_key_t key,
+				      void * data, void * ctx)
 {
-  return UTEST_SKIPPED;
+  char * prev_key= (char *) ctx;
+  if (strcmp(prev_key, key) >= 0)
+    return -1;
+  if ((size_t) data != strlen(key))
+    return -1;
+  strcpy(prev_key, key);
+  return 0;
 }
 
-static int test_trie_dict_array()
+static int test_trie_dict_foreach()
 {
   gds_trie_dico_t * dict= trie_dico_create(NULL);
-  ptr_array_t * array;
-  UTEST_ASSERT(trie_dico_insert(dict, "ab", (void *) 1, 0)
-	       == TRIE_DICO_SUCCESS,
-	       "could not insert item");
-  UTEST_ASSERT(trie_dico_insert(dict, "abcd", (void *) 2, 0)
+  char * keys[]= { "abcd", "ab", "b", "abcdef", "abef", "a", "abcdxy",
+		   "\xff\x01", "ba" };
+  char prev_key[16]= "";
+  unsigned int index;
+
+  for (index= 0; index < sizeof(keys)/sizeof(keys[0]); index++)
+    UTEST_ASSERT(trie_dico_insert(dict, keys[index],
+				  (void *) strlen(keys[index]), 0)
+		 == TRIE_DICO_SUCCESS,
+		 "could not insert item");
+  UTEST_ASSERT(trie_dico_for_each(dict, _test_trie_dict_foreach_cb,
+				  prev_key) == 0,
+	       "keys should be traversed in lexicographic order");
+  UTEST_ASSERT(strcmp(prev_key, "\xff\x01") == 0,
+	       "last traversed key should be \"\\xff\\x01\"");
+  trie_dico_destroy(&dict);
+  return UTEST_SUCCESS;
+}
+
+#define TRIE_DICT_NKEYS 5000
+static char TRIE_DICT_KEYS[TRIE_DICT_NKEYS][10];
+
+// -----[ _test_trie_dict_random_count_cb ]--------------------------
+static int _test_trie_dict_random_count_cb(trie_dico_key_t key,
+					   void * data, void * ctx)
+{
+  if (strcmp(TRIE_DICT_KEYS[(size_t) data - 1], key))
+    return -1;
+  (*((unsigned int *) ctx))++;
+  return 0;
+}
+
+// -----[ test_trie_dict_random ]------------------------------------
+/**
+ * Insert and remove a large number of random keys. The first byte
+ * of the keys takes any value so that all the node types are used
+ * near the root.
+ */
+static int test_trie_dict_random()
+{
+  gds_trie_dico_t * dict= trie_dico_create(NULL);
+  unsigned int index, len, pos, count, num_keys= 0;
+
+  for (index= 0; index < TRIE_DICT_NKEYS; index++) {
+    len= 1 + random() % 8;
+    TRIE_DICT_KEYS[index][0]= 1 + random() % 255;
+    for (pos= 1; pos < len; pos++)
+      TRIE_DICT_KEYS[index][pos]= 'a' + random() % 4;
+    TRIE_DICT_KEYS[index][len]= '\0';
+    if (trie_dico_find_exact(dict, TRIE_DICT_KEYS[index]) != NULL) {
+      UTEST_ASSERT(trie_dico_insert(dict, TRIE_DICT_KEYS[index],
+				    (void *) (size_t) (index+1), 0)
+		   == TRIE_DICO_ERROR_DUPLICATE,
+		   "insertion of existing key should fail");
+      TRIE_DICT_KEYS[index][0]= '\0';
+      continue;
+    }
+    UTEST_ASSERT(trie_dico_insert(dict, TRIE_DICT_KEYS[index],
+				  (void *) (size_t) (index+1), 0)
+		 == TRIE_DICO_SUCCESS,
+		 "could not insert item");
+    num_keys++;
+  }
+
+  for (index= 0; index < TRIE_DICT_NKEYS; index++)
+    if (TRIE_DICT_KEYS[index][0] != '\0')
+      UTEST_ASSERT(trie_dico_find_exact(dict, TRIE_DICT_KEYS[index])
+		   == (void *) (size_t) (index+1),
+		   "find did not return correct data");
+  count= 0;
+  UTEST_ASSERT(trie_dico_for_each(dict, _test_trie_dict_random_count_cb,
+				  &count) == 0,
+	       "for-each returned incorrect key");
+  UTEST_ASSERT(count == num_keys,
+	       "for-each traversed %u keys instead of %u", count, num_keys);
+  UTEST_ASSERT(trie_dico_num_nodes(dict, 1) == num_keys,
+	       "dict should have %u nodes with data", num_keys);
+
+  // Remove half of the keys
+  for (index= 0; index < TRIE_DICT_NKEYS; index+= 2) {
+    if (TRIE_DICT_KEYS[index][0] == '\0')
+      continue;
+    UTEST_ASSERT(trie_dico_remove(dict, TRIE_DICT_KEYS[index])
+		 == TRIE_DICO_SUCCESS,
+		 "could not remove item");
+    UTEST_ASSERT(trie_dico_remove(dict, TRIE_DICT_KEYS[index])
+		 == TRIE_DICO_ERROR_NO_MATCH,
+		 "should return an error (no-match)");
+    TRIE_DICT_KEYS[index][0]= '\0';
+    num_keys--;
+  }
+  for (index= 1; index < TRIE_DICT_NKEYS; index+= 2)
+    if (TRIE_DICT_KEYS[index][0] != '\0')
+      UTEST_ASSERT(trie_dico_find_exact(dict, TRIE_DICT_KEYS[index])
+		   == (void *) (size_t) (index+1),
+		   "find did not return correct data");
+  count= 0;
+  UTEST_ASSERT(trie_dico_for_each(dict, _test_trie_dict_random_count_cb,
+				  &count) == 0,
+	       "for-each returned incorrect key");
+  UTEST_ASSERT(count == num_keys,
+	       "for-each traversed %u keys instead of %u", count, num_keys);
+
+  // Remove remaining keys
+  for (index= 1; index < TRIE_DICT_NKEYS; index+= 2)
+    if (TRIE_DICT_KEYS[index][0] != '\0')
+      UTEST_ASSERT(trie_dico_remove(dict, TRIE_DICT_KEYS[index])
+		   == TRIE_DICO_SUCCESS,
+		   "could not remove item");
+  UTEST_ASSERT(trie_dico_num_nodes(dict, 0) == 0,
+	       "empty dict should have no node");
+  trie_dico_destroy(&dict);
+  return UTEST_SUCCESS;
+}
+
+static int test_trie_dict_array()
+{
+  gds_trie_dico_t * dict= trie_dico_create(NULL);
+  ptr_array_t * array;
+  UTEST_ASSERT(trie_dico_insert(dict, "ab", (void *) 1, 0)
+	       == TRIE_DICO_SUCCESS,
+	       "could not insert item");
+  UTEST_ASSERT(trie_dico_insert(dict, "abcd", (void *) 2, 0)
 	       == TRIE_DICO_SUCCESS,
 	       "could not insert item");
   UTEST_ASSERT(trie_dico_insert(dict, "abef", (void *) 3, 0)
@@ -2841,6 +4812,9 @@ static int test_trie_dict_array()
 static int test_trie_dict_enum()
 {
   gds_trie_dico_t * dict= trie_dico_create(NULL);
+  const size_t ORDER[]= { 1, 2, 4, 5, 3 };
+  const char * KEYS[]= { "ab", "abcd", "abcdef", "abcdgh", "abef" };
+  unsigned int count= 0;
   gds_enum_t * enu;
   UTEST_ASSERT(trie_dico_insert(dict, "ab", (void *) 1, 0)
 	       == TRIE_DICO_SUCCESS,
@@ -2859,14 +4833,492 @@ static int test_trie_dict_enum()
 	       "could not insert item");
   enu= trie_dico_get_enum(dict);
   UTEST_ASSERT(enu != NULL, "enumeration should not be NULL");
+  // Lazy enumeration in lexicographic order of the keys
   while (enum_has_next(enu)) {
-    printf("%zu\n", *((size_t *) enum_get_next(enu)));
+    UTEST_ASSERT(count < 5, "too many items enumerated");
+    UTEST_ASSERT(*((size_t *) enum_get_next(enu)) == ORDER[count],
+		 "items not enumerated in key order");
+    UTEST_ASSERT(!strcmp(trie_dico_enum_get_key(enu), KEYS[count]),
+		 "incorrect key for item %u", count);
+    count++;
   }
+  UTEST_ASSERT(count == 5, "incorrect number of items enumerated");
   enum_destroy(&enu);
   trie_dico_destroy(&dict);
   return UTEST_SUCCESS;  
 }
 
+// -----[ _test_trie_dict_prefix_init ]------------------------------
+static gds_trie_dico_t * _test_trie_dict_prefix_init()
+{
+  gds_trie_dico_t * dict= trie_dico_create(NULL);
+  trie_dico_insert(dict, "as65000:20", (void *) 3, 0);
+  trie_dico_insert(dict, "as65000:1", (void *) 1, 0);
+  trie_dico_insert(dict, "as65001:1", (void *) 5, 0);
+  trie_dico_insert(dict, "as65000:100", (void *) 2, 0);
+  trie_dico_insert(dict, "as65000", (void *) 6, 0);
+  trie_dico_insert(dict, "as65000:3", (void *) 4, 0);
+  trie_dico_insert(dict, "as6", (void *) 7, 0);
+  return dict;
+}
+
+// -----[ _test_trie_dict_prefix_cb ]--------------------------------
+static int _test_trie_dict_prefix_cb(trie_dico_key_t key,
+				     void * data, void * ctx)
+{
+  size_t * values= (size_t *) ctx;
+  values[++values[0]]= (size_t) data;
+  return 0;
+}
+
+// -----[ test_trie_dict_prefix ]------------------------------------
+static int test_trie_dict_prefix()
+{
+  gds_trie_dico_t * dict= _test_trie_dict_prefix_init();
+  size_t values[8];
+
+  values[0]= 0;
+  UTEST_ASSERT(trie_dico_for_each_prefix(dict, "as65000:", 0,
+					 _test_trie_dict_prefix_cb,
+					 values) == 0,
+	       "for-each-prefix should succeed");
+  UTEST_ASSERT((values[0] == 4) && (values[1] == 1) && (values[2] == 2) &&
+	       (values[3] == 3) && (values[4] == 4),
+	       "for-each-prefix returned incorrect keys");
+  values[0]= 0;
+  trie_dico_for_each_prefix(dict, "as6500", 2,
+			    _test_trie_dict_prefix_cb, values);
+  UTEST_ASSERT((values[0] == 2) && (values[1] == 6) && (values[2] == 1),
+	       "for-each-prefix did not respect the limit");
+  values[0]= 0;
+  trie_dico_for_each_prefix(dict, "as65002", 0,
+			    _test_trie_dict_prefix_cb, values);
+  UTEST_ASSERT(values[0] == 0,
+	       "for-each-prefix should not traverse any key");
+  values[0]= 0;
+  trie_dico_for_each_prefix(dict, "", 0, _test_trie_dict_prefix_cb, values);
+  UTEST_ASSERT(values[0] == 7,
+	       "for-each-prefix should traverse all the keys");
+  trie_dico_destroy(&dict);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_trie_dict_prefix_enum ]-------------------------------
+static int test_trie_dict_prefix_enum()
+{
+  gds_trie_dico_t * dict= _test_trie_dict_prefix_init();
+  char * keys[]= { "as65000:1", "as65000:100", "as65000:20" };
+  gds_enum_t * enu;
+  unsigned int count= 0;
+  size_t data;
+
+  enu= trie_dico_get_prefix_enum(dict, "as65000:", 3);
+  UTEST_ASSERT(enu != NULL, "enumeration should not be NULL");
+  while (enum_has_next(enu)) {
+    data= *((size_t *) enum_get_next(enu));
+    UTEST_ASSERT(count < 3, "enumeration did not respect the limit");
+    UTEST_ASSERT(data == count+1,
+		 "enumeration returned incorrect data (%zu)", data);
+    UTEST_ASSERT(!strcmp(trie_dico_enum_get_key(enu), keys[count]),
+		 "enumeration returned incorrect key \"%s\"",
+		 trie_dico_enum_get_key(enu));
+    count++;
+  }
+  UTEST_ASSERT(count == 3, "enumeration should return 3 items");
+  enum_destroy(&enu);
+
+  enu= trie_dico_get_prefix_enum(dict, "as650001", 0);
+  UTEST_ASSERT(!enum_has_next(enu), "enumeration should be empty");
+  enum_destroy(&enu);
+
+  count= 0;
+  enu= trie_dico_get_prefix_enum(dict, "as", 0);
+  while (enum_has_next(enu)) {
+    enum_get_next(enu);
+    count++;
+  }
+  UTEST_ASSERT(count == 7, "enumeration should return 7 items");
+  enum_destroy(&enu);
+  trie_dico_destroy(&dict);
+  return UTEST_SUCCESS;
+}
+
+// -----[ _test_trie_dict_frozen_check ]-----------------------------
+static int _test_trie_dict_frozen_check(gds_trie_dico_t * dict,
+					gds_trie_dico_frozen_t * frozen)
+{
+  char * prefixes[]= { "", "as", "as6500", "as65000:", "as65002", "b" };
+  size_t dict_values[TRIE_DICT_NKEYS+8];
+  size_t frozen_values[TRIE_DICT_NKEYS+8];
+  char key[12];
+  unsigned int index, pos;
+
+  for (index= 0; index < TRIE_DICT_NKEYS; index++) {
+    if (TRIE_DICT_KEYS[index][0] == '\0')
+      continue;
+    UTEST_ASSERT(trie_dico_frozen_find_exact(frozen, TRIE_DICT_KEYS[index])
+		 == (void *) (size_t) (index+1),
+		 "frozen exact lookup failed for key %u", index);
+  }
+  for (index= 0; index < TRIE_DICT_NKEYS; index++) {
+    for (pos= 0; pos < 1 + random() % 10; pos++)
+      key[pos]= 'a' + random() % 5;
+    key[pos]= '\0';
+    UTEST_ASSERT(trie_dico_frozen_find_exact(frozen, key) ==
+		 trie_dico_find_exact(dict, key),
+		 "frozen exact lookup differs for \"%s\"", key);
+    UTEST_ASSERT(trie_dico_frozen_find_best(frozen, key) ==
+		 trie_dico_find_best(dict, key),
+		 "frozen best lookup differs for \"%s\"", key);
+  }
+  for (index= 0; index < sizeof(prefixes)/sizeof(prefixes[0]); index++) {
+    dict_values[0]= 0;
+    frozen_values[0]= 0;
+    trie_dico_for_each_prefix(dict, prefixes[index], 0,
+			      _test_trie_dict_prefix_cb, dict_values);
+    trie_dico_frozen_for_each_prefix(frozen, prefixes[index], 0,
+				     _test_trie_dict_prefix_cb,
+				     frozen_values);
+    UTEST_ASSERT(!memcmp(dict_values, frozen_values,
+			 (dict_values[0]+1)*sizeof(size_t)),
+		 "frozen prefix traversal differs for \"%s\"",
+		 prefixes[index]);
+  }
+  frozen_values[0]= 0;
+  trie_dico_frozen_for_each_prefix(frozen, "as6500", 2,
+				   _test_trie_dict_prefix_cb, frozen_values);
+  UTEST_ASSERT(frozen_values[0] == 2,
+	       "frozen prefix traversal did not respect the limit");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_trie_dict_freeze ]------------------------------------
+/**
+ * Freeze a dictionary with random keys, check that the frozen
+ * dictionary answers like the original one, then save it to a file,
+ * load it back and check it again.
+ */
+static int test_trie_dict_freeze()
+{
+  gds_trie_dico_t * dict= _test_trie_dict_prefix_init();
+  gds_trie_dico_frozen_t * frozen;
+  char filename[]= "/tmp/gds-check-XXXXXX";
+  unsigned int index, pos, num_keys= 7;
+  int fd;
+
+  for (index= 0; index < TRIE_DICT_NKEYS; index++) {
+    for (pos= 0; pos < 1 + random() % 9; pos++)
+      TRIE_DICT_KEYS[index][pos]= 'a' + random() % 5;
+    TRIE_DICT_KEYS[index][pos]= '\0';
+    if (trie_dico_insert(dict, TRIE_DICT_KEYS[index],
+			 (void *) (size_t) (index+1), 0) != 0)
+      TRIE_DICT_KEYS[index][0]= '\0';
+    else
+      num_keys++;
+  }
+
+  frozen= trie_dico_freeze(dict);
+  UTEST_ASSERT(frozen != NULL, "frozen dictionary should not be NULL");
+  UTEST_ASSERT(trie_dico_frozen_num_keys(frozen) == num_keys,
+	       "frozen dictionary should contain %u keys", num_keys);
+  if (_test_trie_dict_frozen_check(dict, frozen) != UTEST_SUCCESS)
+    return UTEST_FAILURE;
+
+  fd= mkstemp(filename);
+  UTEST_ASSERT(fd >= 0, "could not create temporary file");
+  close(fd);
+  UTEST_ASSERT(trie_dico_frozen_save(frozen, filename) == 0,
+	       "frozen dictionary could not be saved");
+  trie_dico_frozen_destroy(&frozen);
+  UTEST_ASSERT(frozen == NULL, "destroyed frozen dictionary should be NULL");
+  frozen= trie_dico_frozen_load(filename);
+  unlink(filename);
+  UTEST_ASSERT(frozen != NULL, "frozen dictionary could not be loaded");
+  if (_test_trie_dict_frozen_check(dict, frozen) != UTEST_SUCCESS)
+    return UTEST_FAILURE;
+  trie_dico_frozen_destroy(&frozen);
+  trie_dico_destroy(&dict);
+
+  dict= trie_dico_create(NULL);
+  frozen= trie_dico_freeze(dict);
+  UTEST_ASSERT(trie_dico_frozen_num_keys(frozen) == 0,
+	       "empty frozen dictionary should contain no key");
+  UTEST_ASSERT((trie_dico_frozen_find_exact(frozen, "") == NULL) &&
+	       (trie_dico_frozen_find_best(frozen, "abc") == NULL),
+	       "empty frozen dictionary should not match any key");
+  trie_dico_frozen_destroy(&frozen);
+  trie_dico_destroy(&dict);
+  return UTEST_SUCCESS;
+}
+
+// -----[ _test_trie_dict_patch ]-----------------------------------
+/** Overwrite bytes of a file. */
+static int _test_trie_dict_patch(const char * filename, long offset,
+				 const void * bytes, size_t len)
+{
+  FILE * file= fopen(filename, "r+b");
+  int result= 0;
+
+  if (file == NULL)
+    return -1;
+  if ((fseek(file, offset, SEEK_SET) != 0) ||
+      (fwrite(bytes, 1, len, file) != len))
+    result= -1;
+  if (fclose(file) != 0)
+    result= -1;
+  return result;
+}
+
+// -----[ test_trie_dict_freeze_corrupted ]--------------------------
+/**
+ * A file whose header describes sections that do not fit in the
+ * file must be rejected. The offsets are those of the fields of the
+ * image header (number of keys, offset of the LOUDS bit-vector and
+ * offset of the values).
+ */
+static int test_trie_dict_freeze_corrupted()
+{
+  static const long OFFSETS[]= { 16, 24, 96 };
+  gds_trie_dico_t * dict= _test_trie_dict_prefix_init();
+  gds_trie_dico_frozen_t * frozen= trie_dico_freeze(dict);
+  char filename[]= "/tmp/gds-check-XXXXXX";
+  uint64_t size= trie_dico_frozen_size(frozen);
+  uint64_t value;
+  unsigned int index;
+  int fd;
+
+  fd= mkstemp(filename);
+  UTEST_ASSERT(fd >= 0, "could not create temporary file");
+  close(fd);
+  for (index= 0; index < sizeof(OFFSETS)/sizeof(OFFSETS[0]); index++) {
+    UTEST_ASSERT(trie_dico_frozen_save(frozen, filename) == 0,
+		 "frozen dictionary could not be saved");
+    value= (index == 0)?0xffffffff:size-4;
+    UTEST_ASSERT(_test_trie_dict_patch(filename, OFFSETS[index], &value,
+				       (index == 0)?4:8) == 0,
+		 "could not patch the file");
+    UTEST_ASSERT(trie_dico_frozen_load(filename) == NULL,
+		 "corrupted file (offset %ld) should be rejected",
+		 OFFSETS[index]);
+  }
+  unlink(filename);
+  trie_dico_frozen_destroy(&frozen);
+  trie_dico_destroy(&dict);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_trie_dict_freeze_corrupted_bits ]---------------------
+/**
+ * A file whose bit-vectors do not match their rank and select
+ * samples, or the numbers of nodes, keys and paths of the header,
+ * must be rejected. A bit is flipped in the first byte of a section
+ * whose offset is read in the image header (LOUDS bit-vector, select
+ * samples, data bit-vector and ranks, path bit-vector and ranks).
+ */
+static int test_trie_dict_freeze_corrupted_bits()
+{
+  static const long OFFSETS[]= { 24, 32, 48, 56, 64, 72 };
+  gds_trie_dico_t * dict= _test_trie_dict_prefix_init();
+  gds_trie_dico_frozen_t * frozen= trie_dico_freeze(dict);
+  char filename[]= "/tmp/gds-check-XXXXXX";
+  uint64_t section;
+  uint8_t byte;
+  unsigned int index;
+  FILE * file;
+  int fd;
+
+  fd= mkstemp(filename);
+  UTEST_ASSERT(fd >= 0, "could not create temporary file");
+  close(fd);
+  for (index= 0; index < sizeof(OFFSETS)/sizeof(OFFSETS[0]); index++) {
+    UTEST_ASSERT(trie_dico_frozen_save(frozen, filename) == 0,
+		 "frozen dictionary could not be saved");
+    file= fopen(filename, "rb");
+    UTEST_ASSERT(file != NULL, "could not open the file");
+    UTEST_ASSERT((fseek(file, OFFSETS[index], SEEK_SET) == 0) &&
+		 (fread(&section, sizeof(section), 1, file) == 1) &&
+		 (fseek(file, (long) section, SEEK_SET) == 0) &&
+		 (fread(&byte, 1, 1, file) == 1),
+		 "could not read the file");
+    fclose(file);
+    byte^= 1;
+    UTEST_ASSERT(_test_trie_dict_patch(filename, (long) section,
+				       &byte, 1) == 0,
+		 "could not patch the file");
+    UTEST_ASSERT(trie_dico_frozen_load(filename) == NULL,
+		 "corrupted section (offset %ld) should be rejected",
+		 OFFSETS[index]);
+  }
+  unlink(filename);
+  trie_dico_frozen_destroy(&frozen);
+  trie_dico_destroy(&dict);
+  return UTEST_SUCCESS;
+}
+
+// -----[ _test_trie_dict_bulk_cb ]----------------------------------
+static int _test_trie_dict_bulk_cb(trie_dico_key_t key,
+				   void * data, void * ctx)
+{
+  gds_trie_dico_bulk_item_t ** item= (gds_trie_dico_bulk_item_t **) ctx;
+  (*item)->key= TRIE_DICT_KEYS[(size_t) data - 1];
+  (*item)->data= data;
+  (*item)++;
+  return 0;
+}
+
+// -----[ _test_trie_dict_bulk_cmp ]---------------------------------
+/**
+ * Check that two dictionaries contain the same keys, in the same
+ * order.
+ */
+static int _test_trie_dict_bulk_cmp(gds_trie_dico_t * dict,
+				    gds_trie_dico_t * ref)
+{
+  static gds_trie_dico_bulk_item_t items1[TRIE_DICT_NKEYS];
+  static gds_trie_dico_bulk_item_t items2[TRIE_DICT_NKEYS];
+  gds_trie_dico_bulk_item_t * item1= items1, * item2= items2;
+  unsigned int index;
+
+  trie_dico_for_each(dict, _test_trie_dict_bulk_cb, &item1);
+  trie_dico_for_each(ref, _test_trie_dict_bulk_cb, &item2);
+  if (item1-items1 != item2-items2)
+    return -1;
+  for (index= 0; index < item1-items1; index++)
+    if (items1[index].data != items2[index].data)
+      return -1;
+  if (trie_dico_num_nodes(dict, 0) != trie_dico_num_nodes(ref, 0))
+    return -1;
+  return 0;
+}
+
+// -----[ test_trie_dict_bulk_load ]---------------------------------
+static int test_trie_dict_bulk_load()
+{
+  static gds_trie_dico_bulk_item_t items[TRIE_DICT_NKEYS];
+  gds_trie_dico_bulk_item_t extra[3];
+  gds_trie_dico_bulk_item_t * item;
+  gds_trie_dico_t * dict= trie_dico_create(NULL);
+  gds_trie_dico_t * ref= trie_dico_create(NULL);
+  unsigned int index, pos, num_items= 0;
+
+  // Unsorted keys
+  for (index= 0; index < TRIE_DICT_NKEYS; index++) {
+    for (pos= 0; pos < 1 + random() % 9; pos++)
+      TRIE_DICT_KEYS[index][pos]= 'a' + random() % 5;
+    TRIE_DICT_KEYS[index][0]+= random() % 64;
+    TRIE_DICT_KEYS[index][pos]= '\0';
+    if (trie_dico_insert(ref, TRIE_DICT_KEYS[index],
+			 (void *) (size_t) (index+1), 0) != 0) {
+      TRIE_DICT_KEYS[index][0]= '\0';
+      continue;
+    }
+    items[num_items].key= TRIE_DICT_KEYS[index];
+    items[num_items].data= (void *) (size_t) (index+1);
+    num_items++;
+  }
+  UTEST_ASSERT(trie_dico_bulk_load(dict, items, num_items)
+	       == TRIE_DICO_SUCCESS, "bulk load should succeed");
+  UTEST_ASSERT(_test_trie_dict_bulk_cmp(dict, ref) == 0,
+	       "bulk loaded dictionary differs");
+
+  // Modify the bulk loaded nodes
+  for (index= 0; index < TRIE_DICT_NKEYS; index+= 2) {
+    if (TRIE_DICT_KEYS[index][0] == '\0')
+      continue;
+    UTEST_ASSERT((trie_dico_remove(dict, TRIE_DICT_KEYS[index]) == 0) &&
+		 (trie_dico_remove(ref, TRIE_DICT_KEYS[index]) == 0),
+		 "could not remove key \"%s\"", TRIE_DICT_KEYS[index]);
+    TRIE_DICT_KEYS[index][1]= '\0';
+    if (trie_dico_insert(ref, TRIE_DICT_KEYS[index],
+			 (void *) (size_t) (index+1), 0) != 0) {
+      TRIE_DICT_KEYS[index][0]= '\0';
+      continue;
+    }
+    UTEST_ASSERT(trie_dico_insert(dict, TRIE_DICT_KEYS[index],
+				  (void *) (size_t) (index+1), 0) == 0,
+		 "could not insert key \"%s\"", TRIE_DICT_KEYS[index]);
+  }
+  UTEST_ASSERT(_test_trie_dict_bulk_cmp(dict, ref) == 0,
+	       "modified bulk loaded dictionary differs");
+  trie_dico_destroy(&dict);
+
+  // Sorted keys
+  item= items;
+  trie_dico_for_each(ref, _test_trie_dict_bulk_cb, &item);
+  dict= trie_dico_create(NULL);
+  UTEST_ASSERT(trie_dico_bulk_load(dict, items, item-items)
+	       == TRIE_DICO_SUCCESS, "bulk load should succeed");
+  UTEST_ASSERT(_test_trie_dict_bulk_cmp(dict, ref) == 0,
+	       "bulk loaded dictionary differs");
+
+  // Non-empty dictionary: the load stops at the first existing key
+  extra[0].key= "bulk-load-a";
+  extra[0].data= (void *) 1;
+  extra[1]= items[0];
+  extra[2].key= "bulk-load-b";
+  extra[2].data= (void *) 2;
+  UTEST_ASSERT(trie_dico_bulk_load(dict, extra, 3)
+	       == TRIE_DICO_ERROR_DUPLICATE,
+	       "bulk load should report duplicate key");
+  UTEST_ASSERT(trie_dico_find_exact(dict, "bulk-load-a") == (void *) 1,
+	       "key before the duplicate should be inserted");
+  UTEST_ASSERT(trie_dico_find_exact(dict, "bulk-load-b") == NULL,
+	       "key after the duplicate should not be inserted");
+  trie_dico_destroy(&dict);
+
+  // Duplicate keys
+  dict= trie_dico_create(NULL);
+  items[1]= items[0];
+  UTEST_ASSERT(trie_dico_bulk_load(dict, items, 3)
+	       == TRIE_DICO_ERROR_DUPLICATE,
+	       "bulk load should report duplicate key");
+  UTEST_ASSERT(trie_dico_find_exact(dict, items[0].key) == NULL,
+	       "dictionary should remain empty after failed bulk load");
+  trie_dico_destroy(&dict);
+  trie_dico_destroy(&ref);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_trie_dict_bulk_load_long ]----------------------------
+/**
+ * Unsorted keys that share prefixes longer than 8 bytes, so that
+ * they are sorted on several 8-byte chunks. A key that appears twice
+ * at distant positions must be detected.
+ */
+static int test_trie_dict_bulk_load_long()
+{
+  static gds_trie_dico_bulk_item_t items[1000];
+  static char keys[1000][32];
+  gds_trie_dico_t * dict;
+  unsigned int index;
+
+  for (index= 0; index < 1000; index++) {
+    snprintf(keys[index], sizeof(keys[index]), "%s%u",
+	     (index % 3)?"common-prefix/":"common-prefix/sub/",
+	     (index*7919) % 1000);
+    items[index].key= keys[index];
+    items[index].data= (void *) (size_t) (index+1);
+  }
+  dict= trie_dico_create(NULL);
+  UTEST_ASSERT(trie_dico_bulk_load(dict, items, 1000) == TRIE_DICO_SUCCESS,
+	       "bulk load should succeed");
+  for (index= 0; index < 1000; index++)
+    UTEST_ASSERT(trie_dico_find_exact(dict, keys[index]) ==
+		 (void *) (size_t) (index+1),
+		 "exact match failed for \"%s\"", keys[index]);
+  trie_dico_destroy(&dict);
+
+  dict= trie_dico_create(NULL);
+  items[999].key= keys[1];
+  UTEST_ASSERT(trie_dico_bulk_load(dict, items, 1000)
+	       == TRIE_DICO_ERROR_DUPLICATE,
+	       "bulk load should report duplicate key");
+  UTEST_ASSERT(trie_dico_find_exact(dict, keys[0]) == NULL,
+	       "dictionary should remain empty after failed bulk load");
+  trie_dico_destroy(&dict);
+  return UTEST_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
 // GDS_CHECK_CLI
 /////////////////////////////////////////////////////////////////////
@@ -3880,6 +6332,48 @@ static int test_hash_set_enum()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_hash_set_cursor ]-----------------------------------------
+static int test_hash_set_cursor()
+{
+  gds_hash_set_t * hash= hash_set_create(100, 0.0, _hash_cmp,
+					 _hash_set_destroy, _hash_compute);
+  gds_hash_set_cursor_t cursor;
+  gds_enum_t * enu;
+  void * item, * items[32];
+  size_t sum;
+  unsigned int index, count, num;
+
+  count= 0;
+  GDS_FOREACH(hash_set, cursor, hash, &item)
+    count++;
+  UTEST_ASSERT(count == 0, "empty hash-set should not be traversed");
+  for (index= 1; index <= 500; index++)
+    hash_set_add(hash, (void *) (size_t) index);
+  count= 0;
+  sum= 0;
+  GDS_FOREACH(hash_set, cursor, hash, &item) {
+    sum+= (size_t) item;
+    count++;
+  }
+  UTEST_ASSERT((count == 500) && (sum == 500*501/2),
+		"incorrect items traversed by cursor");
+
+  // Batched enumeration
+  count= 0;
+  sum= 0;
+  enu= hash_set_get_enum(hash);
+  while ((num= enum_get_next_n(enu, items, 32)) > 0) {
+    for (index= 0; index < num; index++)
+      sum+= *((size_t *) items[index]);
+    count+= num;
+  }
+  enum_destroy(&enu);
+  UTEST_ASSERT((count == 500) && (sum == 500*501/2),
+		"incorrect items enumerated");
+  hash_set_destroy(&hash);
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_hash_set_strings ]----------------------------------------
 static int test_hash_set_strings()
 {
@@ -4147,70 +6641,651 @@ int test_bit_vector_equality()
   return UTEST_SUCCESS;
 }
 
+int test_bit_vector_popcount()
+{
+  gds_bit_vector_t * bv;
 
-/////////////////////////////////////////////////////////////////////
-// GDS_CHECK_BLOOM_FILTER
-/////////////////////////////////////////////////////////////////////
-#include <libgds/sha1.h>
-#include <libgds/bloom_hash.h>
-#include <libgds/bloom_filter.h>
+  bv= bit_vector_create(65);
+  UTEST_ASSERT(bit_vector_popcount(bv) == 0, "empty bit vector count");
+  _test_bit_vector_set(bv);
+  UTEST_ASSERT(bit_vector_popcount(bv) == 10, "bit vector count should be 10");
+  bit_vector_clear(bv, 64);
+  UTEST_ASSERT(bit_vector_popcount(bv) == 9, "bit vector count should be 9");
+  bit_vector_destroy(&bv);
+  UTEST_ASSERT(bit_vector_popcount(NULL) == 0, "NULL bit vector count");
+  return UTEST_SUCCESS;
+}
 
-static char *msg[] = {
-    "abc",
-    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
-    NULL
-};
+static const char * BIT_VECTOR_ANDNOT_RESULT=
+  "01000000000000000000000000000000010000000000000000000000000000001";
 
-static char *val[] = {
-    "a9993e364706816aba3e25717850c26c9cd0d89d",
-    "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
-    "34aa973cd4c4daa4f61eeb2bdbad27316534016f"
-};
+int test_bit_vector_andnot_count()
+{
+  gds_bit_vector_t * bv1;
+  gds_bit_vector_t * bv2;
+  gds_bit_vector_t * bv3;
+  unsigned int count;
+  char * str;
 
-static uint8_t uResByte[] = {
-  0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78,
-  0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d
-};
+  bv1= bit_vector_create(65);
+  bv2= bit_vector_create(65);
+  bv3= bit_vector_create(65);
+  _test_bit_vector_set(bv1);
+  _test_bit_vector_set_xor(bv2);
 
-/**
- * those are the standard FIPS-180-1 (sha1) test vectors
- */
-int sha1_check()
-{
-    int i, j;
-    char output[41];
-    SSHA1Context ctx;
-    unsigned char buf[1000];
-    unsigned char sha1sum[20];
+  UTEST_ASSERT(bit_vector_and_count(bv1, bv2, &count) == 0,
+	       "'and_count' operation failed");
+  UTEST_ASSERT(count == 7, "'and_count' should be 7 (%u)", count);
 
-  for( i = 0; i < 3; i++ ) {
-    sha1_starts( &ctx );
-    if( i < 2 ) {
-        sha1_update( &ctx, (uint8_t *) msg[i],
-                     strlen( msg[i] ) );
-    } else {
-        memset( buf, 'a', 1000 );
-        for( j = 0; j < 1000; j++ ) {
-            sha1_update( &ctx, (uint8_t *) buf, 1000 );
-        }
-    }
-    sha1_finish( &ctx, sha1sum );
+  // Out-of-place: bv3 = bv1 & ~bv2, operands are unchanged
+  UTEST_ASSERT(bit_vector_andnot_to(bv3, bv1, bv2) == 0,
+	       "'andnot' operation failed");
+  str= bit_vector_to_string(bv3);
+  UTEST_ASSERT(strcmp(str, BIT_VECTOR_ANDNOT_RESULT) == 0,
+	       "'andnot' operation not conform");
+  FREE(str);
+  str= bit_vector_to_string(bv1);
+  UTEST_ASSERT(strcmp(str, BIT_VECTOR_INIT) == 0,
+	       "out-of-place operation modified its operand");
+  FREE(str);
 
-    for( j = 0; j < 20; j++ ) {
-        snprintf( output + j * 2, 41-j*2, "%02x", sha1sum[j] );
-    }
-    if( memcmp( output, val[i], 40 ) ) {
-        return -1;
-    }
+  // bv3 = bv1 ^ bv2, then in-place andnot
+  UTEST_ASSERT(bit_vector_xor_to(bv3, bv1, bv2) == 0,
+	       "'xor' operation failed");
+  str= bit_vector_to_string(bv3);
+  UTEST_ASSERT(strcmp(str, BIT_VECTOR_XOR_RESULT) == 0,
+	       "'xor' operation not conform");
+  FREE(str);
+  UTEST_ASSERT(bit_vector_andnot(bv1, bv2) == 0, "'andnot' operation failed");
+  UTEST_ASSERT(bit_vector_and_count(bv1, bv2, &count) == 0 && (count == 0),
+	       "'andnot' result should not intersect bv2");
+  bit_vector_destroy(&bv3);
+
+  bv3= bit_vector_create(64);
+  UTEST_ASSERT(bit_vector_and_count(bv1, bv3, &count) < 0,
+	       "'and_count' should fail on different lengths");
+  UTEST_ASSERT(bit_vector_or_to(bv3, bv1, bv2) < 0,
+	       "'or' should fail on different lengths");
+  bit_vector_destroy(&bv1);
+  bit_vector_destroy(&bv2);
+  bit_vector_destroy(&bv3);
+  return UTEST_SUCCESS;
+}
+
+/**
+ * The SIMD and generic kernels must give the same results.
+ */
+int test_bit_vector_simd()
+{
+  gds_bit_vector_t * bv1= bit_vector_create(10007);
+  gds_bit_vector_t * bv2= bit_vector_create(10007);
+  gds_bit_vector_t * res[2][4];
+  unsigned int count[2][3];
+  unsigned int index, pass, op;
+  uint32_t x= 12345;
+
+  for (index= 0; index < 10007; index++) {
+    x= x * 1103515245 + 12345;
+    if (x & 0x10000)
+      bit_vector_set(bv1, index);
+    if (x & 0x20000)
+      bit_vector_set(bv2, index);
   }
-  return 0;
+  for (pass= 0; pass < 2; pass++) {
+    bit_vector_use_simd(pass == 0);
+    for (op= 0; op < 4; op++)
+      res[pass][op]= bit_vector_create(10007);
+    bit_vector_and_to(res[pass][0], bv1, bv2);
+    bit_vector_or_to(res[pass][1], bv1, bv2);
+    bit_vector_xor_to(res[pass][2], bv1, bv2);
+    bit_vector_andnot_to(res[pass][3], bv1, bv2);
+    count[pass][0]= bit_vector_popcount(bv1);
+    count[pass][1]= bit_vector_popcount(res[pass][1]);
+    bit_vector_and_count(bv1, bv2, &count[pass][2]);
+  }
+  bit_vector_use_simd(1);
+  for (op= 0; op < 4; op++) {
+    UTEST_ASSERT(bit_vector_equals(res[0][op], res[1][op]),
+		 "SIMD and generic results differ (op %u)", op);
+    bit_vector_destroy(&res[0][op]);
+    bit_vector_destroy(&res[1][op]);
+  }
+  UTEST_ASSERT(memcmp(count[0], count[1], sizeof(count[0])) == 0,
+	       "SIMD and generic counts differ");
+  UTEST_ASSERT(count[0][2] == count[0][0] + bit_vector_popcount(bv2) -
+	       count[0][1], "|A&B| should be |A|+|B|-|A|B|");
+  bit_vector_destroy(&bv1);
+  bit_vector_destroy(&bv2);
+  return UTEST_SUCCESS;
 }
 
-/*int _bloom_print_for_each(void * pItem, void * pCtx)
+static int _test_bit_vector_foreach(unsigned int index, void * ctx)
 {
-  uint32_t uItem = *(uint32_t *) pItem;
-
-  printf("%02x|", uItem);
+  unsigned int * count= (unsigned int *) ctx;
+  if (index >= 1000)
+    return 1;
+  (*count)++;
+  return 0;
+}
+
+/**
+ * Set bits iteration: next_set_bit and for_each_set_bit.
+ */
+int test_bit_vector_set_bits()
+{
+  gds_bit_vector_t * bv= bit_vector_create(10007);
+  unsigned int index, count= 0;
+  int64_t pos;
+
+  for (index= 0; index < 10007; index+= 7)
+    bit_vector_set(bv, index);
+  bit_vector_set(bv, 10006);
+  index= 0;
+  for (pos= bit_vector_next_set_bit(bv, 0); pos >= 0;
+       pos= bit_vector_next_set_bit(bv, pos+1)) {
+    UTEST_ASSERT(pos == ((index < 1430)?index*7:10006),
+		 "incorrect set bit (%u)", (unsigned int) pos);
+    index++;
+  }
+  UTEST_ASSERT(index == 1431, "incorrect number of set bits (%u)", index);
+  UTEST_ASSERT(bit_vector_next_set_bit(bv, 10007) == -1,
+	       "should return -1 after the end");
+  UTEST_ASSERT(bit_vector_for_each_set_bit(bv, _test_bit_vector_foreach,
+					   &count) == 1,
+	       "for_each should return the value of the callback");
+  UTEST_ASSERT(count == 143, "for_each should stop at 1000 (%u)", count);
+  bit_vector_destroy(&bv);
+  return UTEST_SUCCESS;
+}
+
+/**
+ * Rank and select, with and without the index, are compared with
+ * a naive computation.
+ */
+int test_bit_vector_rank_select()
+{
+  gds_bit_vector_t * bv= bit_vector_create(100003);
+  unsigned int index, rank, pass;
+  uint32_t x= 4321;
+
+  // Sparse and dense regions
+  for (index= 0; index < 100003; index++) {
+    x= x * 1103515245 + 12345;
+    if ((index < 50000) ? ((x & 0x70000) == 0) : ((x & 0x10000) != 0))
+      bit_vector_set(bv, index);
+  }
+  for (pass= 0; pass < 2; pass++) {
+    if (pass == 1)
+      UTEST_ASSERT(bit_vector_build_index(bv) == 0,
+		   "index should be built");
+    rank= 0;
+    for (index= 0; index < 100003; index++) {
+      UTEST_ASSERT(bit_vector_rank(bv, index) == rank,
+		   "incorrect rank at %u (pass %u)", index, pass);
+      if (bit_vector_get(bv, index)) {
+	UTEST_ASSERT(bit_vector_select(bv, rank) == index,
+		     "incorrect select of %u (pass %u)", rank, pass);
+	rank++;
+      }
+    }
+    UTEST_ASSERT(bit_vector_rank(bv, 100003) == rank,
+		 "incorrect rank at the end");
+    UTEST_ASSERT(bit_vector_select(bv, rank) == -1,
+		 "select beyond the last bit should fail");
+  }
+  // Index must not be used after a modification
+  bit_vector_clear(bv, (unsigned int) bit_vector_select(bv, 0));
+  UTEST_ASSERT(bit_vector_rank(bv, 100003) == rank - 1,
+	       "rank should follow modifications");
+  bit_vector_destroy(&bv);
+  return UTEST_SUCCESS;
+}
+
+/////////////////////////////////////////////////////////////////////
+// GDS_CHECK_ROARING
+/////////////////////////////////////////////////////////////////////
+#include <libgds/roaring.h>
+
+#define ROARING_TEST_SIZE (4*65536)
+
+/**
+ * Fill a bitmap and a reference bit vector with a sparse chunk, a
+ * dense chunk, an empty chunk and a chunk with runs.
+ */
+static void _test_roaring_fill(gds_roaring_t * bitmap,
+			       gds_bit_vector_t * ref, uint32_t seed)
+{
+  uint32_t index, x= seed;
+
+  for (index= 0; index < 1000; index++) {
+    x= x * 1103515245 + 12345;
+    roaring_add(bitmap, (x >> 8) % 65536);
+    bit_vector_set(ref, (x >> 8) % 65536);
+  }
+  for (index= 0; index < 20000; index++) {
+    x= x * 1103515245 + 12345;
+    roaring_add(bitmap, 65536 + (x >> 8) % 65536);
+    bit_vector_set(ref, 65536 + (x >> 8) % 65536);
+  }
+  for (index= 3*65536 + (seed % 100); index < ROARING_TEST_SIZE;
+       index+= 1000 + (seed % 7))
+    for (x= index; (x < index + 300) && (x < ROARING_TEST_SIZE); x++) {
+      roaring_add(bitmap, x);
+      bit_vector_set(ref, x);
+    }
+}
+
+/** Compare a bitmap with a reference bit vector. */
+static int _test_roaring_check(gds_roaring_t * bitmap,
+			       gds_bit_vector_t * ref)
+{
+  int64_t value, index;
+
+  if (roaring_cardinality(bitmap) != bit_vector_popcount(ref))
+    return 0;
+  index= bit_vector_next_set_bit(ref, 0);
+  for (value= roaring_next(bitmap, 0); value >= 0;
+       value= roaring_next(bitmap, value+1)) {
+    if (value != index)
+      return 0;
+    index= bit_vector_next_set_bit(ref, index+1);
+  }
+  return (index == -1);
+}
+
+/**
+ * Add, remove and contains, across array/bitmap conversions.
+ */
+int test_roaring_add_remove()
+{
+  gds_roaring_t * bitmap= roaring_create();
+  gds_bit_vector_t * ref= bit_vector_create(ROARING_TEST_SIZE);
+  uint32_t index;
+
+  UTEST_ASSERT(roaring_cardinality(bitmap) == 0, "bitmap should be empty");
+  UTEST_ASSERT(roaring_next(bitmap, 0) == -1, "bitmap should be empty");
+  _test_roaring_fill(bitmap, ref, 1);
+  UTEST_ASSERT(_test_roaring_check(bitmap, ref),
+	       "bitmap differs from reference");
+  UTEST_ASSERT(roaring_add(bitmap, 65536) == !bit_vector_get(ref, 65536),
+	       "add should tell if the value was added");
+  bit_vector_set(ref, 65536);
+  for (index= 0; index < ROARING_TEST_SIZE; index++)
+    UTEST_ASSERT(roaring_contains(bitmap, index) ==
+		 bit_vector_get(ref, index), "incorrect membership of %u",
+		 index);
+  // Empty the dense chunk (bitmap -> array -> nothing)
+  for (index= 65536; index < 2*65536; index++) {
+    UTEST_ASSERT(roaring_remove(bitmap, index) ==
+		 bit_vector_get(ref, index),
+		 "remove should tell if the value was removed");
+    bit_vector_clear(ref, index);
+  }
+  UTEST_ASSERT(_test_roaring_check(bitmap, ref),
+	       "bitmap differs from reference after removal");
+  UTEST_ASSERT(roaring_add(bitmap, 0xffffffff) == 1, "should add 2^32-1");
+  UTEST_ASSERT(roaring_contains(bitmap, 0xffffffff), "should contain 2^32-1");
+  UTEST_ASSERT(roaring_next(bitmap, 4*65536) == 0xffffffff,
+	       "next should return 2^32-1");
+  UTEST_ASSERT(roaring_next(bitmap, ((uint64_t) 1) << 32) == -1,
+	       "next should return -1 after 2^32-1");
+  bit_vector_destroy(&ref);
+  roaring_destroy(&bitmap);
+  UTEST_ASSERT(bitmap == NULL, "destroyed bitmap should be NULL");
+  return UTEST_SUCCESS;
+}
+
+/**
+ * Run containers behave as the other containers.
+ */
+int test_roaring_runs()
+{
+  gds_roaring_t * bitmap= roaring_create();
+  gds_roaring_t * copy;
+  gds_bit_vector_t * ref= bit_vector_create(ROARING_TEST_SIZE);
+  uint32_t index, x= 77;
+
+  _test_roaring_fill(bitmap, ref, 1);
+  copy= roaring_copy(bitmap);
+  UTEST_ASSERT(roaring_run_optimize(bitmap) == 1,
+	       "only the last chunk should be converted to runs");
+  UTEST_ASSERT(roaring_equals(bitmap, copy),
+	       "run containers should have the same values");
+  UTEST_ASSERT(_test_roaring_check(bitmap, ref),
+	       "bitmap differs from reference");
+  // Split, extend and merge runs
+  for (index= 0; index < 5000; index++) {
+    x= x * 1103515245 + 12345;
+    if (x & 0x100000) {
+      roaring_add(bitmap, 3*65536 + (x >> 8) % 65536);
+      bit_vector_set(ref, 3*65536 + (x >> 8) % 65536);
+    } else {
+      roaring_remove(bitmap, 3*65536 + (x >> 8) % 65536);
+      bit_vector_clear(ref, 3*65536 + (x >> 8) % 65536);
+    }
+  }
+  UTEST_ASSERT(_test_roaring_check(bitmap, ref),
+	       "bitmap differs from reference after updates");
+  for (index= 3*65536; index < ROARING_TEST_SIZE; index++)
+    UTEST_ASSERT(roaring_contains(bitmap, index) ==
+		 bit_vector_get(ref, index), "incorrect membership of %u",
+		 index);
+  roaring_run_optimize(bitmap);
+  UTEST_ASSERT(_test_roaring_check(bitmap, ref),
+	       "bitmap differs from reference after optimization");
+  roaring_destroy(&copy);
+  bit_vector_destroy(&ref);
+  roaring_destroy(&bitmap);
+  return UTEST_SUCCESS;
+}
+
+/**
+ * and/or/xor/andnot, with all combinations of container types.
+ */
+int test_roaring_binary_operations()
+{
+  gds_roaring_t * bitmap1= roaring_create();
+  gds_roaring_t * bitmap2= roaring_create();
+  gds_roaring_t * result;
+  gds_bit_vector_t * ref1= bit_vector_create(ROARING_TEST_SIZE);
+  gds_bit_vector_t * ref2= bit_vector_create(ROARING_TEST_SIZE);
+  gds_bit_vector_t * ref;
+  unsigned int op, pass;
+
+  _test_roaring_fill(bitmap1, ref1, 1);
+  _test_roaring_fill(bitmap2, ref2, 2);
+  roaring_remove(bitmap2, roaring_next(bitmap2, 0));
+  bit_vector_clear(ref2, bit_vector_next_set_bit(ref2, 0));
+  for (pass= 0; pass < 3; pass++) {
+    if (pass == 1)
+      roaring_run_optimize(bitmap1);
+    else if (pass == 2)
+      roaring_run_optimize(bitmap2);
+    for (op= 0; op < 4; op++) {
+      result= roaring_copy(bitmap1);
+      ref= bit_vector_copy(ref1);
+      switch (op) {
+      case 0:
+	roaring_and(result, bitmap2); bit_vector_and(ref, ref2); break;
+      case 1:
+	roaring_or(result, bitmap2); bit_vector_or(ref, ref2); break;
+      case 2:
+	roaring_xor(result, bitmap2); bit_vector_xor(ref, ref2); break;
+      default:
+	roaring_andnot(result, bitmap2); bit_vector_andnot(ref, ref2);
+      }
+      UTEST_ASSERT(_test_roaring_check(result, ref),
+		   "incorrect result (op %u, pass %u)", op, pass);
+      roaring_destroy(&result);
+      bit_vector_destroy(&ref);
+    }
+  }
+  result= roaring_copy(bitmap1);
+  roaring_xor(result, result);
+  UTEST_ASSERT(roaring_cardinality(result) == 0,
+	       "x xor x should be empty");
+  UTEST_ASSERT(roaring_and(result, NULL) < 0, "should fail with NULL");
+  roaring_destroy(&result);
+  bit_vector_destroy(&ref1);
+  bit_vector_destroy(&ref2);
+  roaring_destroy(&bitmap1);
+  roaring_destroy(&bitmap2);
+  return UTEST_SUCCESS;
+}
+
+static int _test_roaring_foreach(uint32_t value, void * ctx)
+{
+  uint64_t * sum= (uint64_t *) ctx;
+  if (value >= 3*65536)
+    return 2;
+  *sum+= value;
+  return 0;
+}
+
+/**
+ * for_each visits the values in order and can be stopped.
+ */
+int test_roaring_for_each()
+{
+  gds_roaring_t * bitmap= roaring_create();
+  gds_bit_vector_t * ref= bit_vector_create(ROARING_TEST_SIZE);
+  uint64_t sum= 0, expected= 0;
+  int64_t index;
+
+  _test_roaring_fill(bitmap, ref, 3);
+  for (index= bit_vector_next_set_bit(ref, 0);
+       (index >= 0) && (index < 3*65536);
+       index= bit_vector_next_set_bit(ref, index+1))
+    expected+= index;
+  UTEST_ASSERT(roaring_for_each(bitmap, _test_roaring_foreach, &sum) == 2,
+	       "for_each should return the value of the callback");
+  UTEST_ASSERT(sum == expected, "incorrect sum of values");
+  bit_vector_destroy(&ref);
+  roaring_destroy(&bitmap);
+  return UTEST_SUCCESS;
+}
+
+/**
+ * The serialized format must be the portable Roaring format.
+ */
+int test_roaring_serialization()
+{
+  static const uint8_t EXPECTED_ARRAY[]= {
+    0x3a, 0x30, 0, 0, 1, 0, 0, 0, 0, 0, 2, 0, 16, 0, 0, 0,
+    1, 0, 2, 0, 3, 0 };
+  static const uint8_t EXPECTED_RUN[]= {
+    0x3b, 0x30, 0, 0, 1, 0, 0, 9, 0, 1, 0, 1, 0, 9, 0 };
+  gds_roaring_t * bitmap= roaring_create();
+  gds_roaring_t * copy;
+  gds_bit_vector_t * ref= bit_vector_create(ROARING_TEST_SIZE);
+  uint8_t buffer[32];
+  uint8_t * big;
+  size_t size;
+  uint32_t index;
+
+  for (index= 1; index <= 3; index++)
+    roaring_add(bitmap, index);
+  UTEST_ASSERT(roaring_serialized_size(bitmap) == sizeof(EXPECTED_ARRAY),
+	       "incorrect serialized size");
+  UTEST_ASSERT((roaring_serialize(bitmap, buffer) == sizeof(EXPECTED_ARRAY))
+	       && !memcmp(buffer, EXPECTED_ARRAY, sizeof(EXPECTED_ARRAY)),
+	       "incorrect serialization (array)");
+  for (index= 4; index <= 10; index++)
+    roaring_add(bitmap, index);
+  roaring_run_optimize(bitmap);
+  UTEST_ASSERT((roaring_serialize(bitmap, buffer) == sizeof(EXPECTED_RUN))
+	       && !memcmp(buffer, EXPECTED_RUN, sizeof(EXPECTED_RUN)),
+	       "incorrect serialization (run)");
+  copy= roaring_deserialize(buffer, sizeof(EXPECTED_RUN));
+  UTEST_ASSERT((copy != NULL) && roaring_equals(bitmap, copy),
+	       "deserialized bitmap differs");
+  roaring_destroy(&copy);
+  UTEST_ASSERT(roaring_deserialize(buffer, sizeof(EXPECTED_RUN)-1) == NULL,
+	       "truncated buffer should be rejected");
+  roaring_destroy(&bitmap);
+
+  // All container types, with and without runs
+  bitmap= roaring_create();
+  _test_roaring_fill(bitmap, ref, 5);
+  for (index= 0; index < 2; index++) {
+    if (index == 1)
+      roaring_run_optimize(bitmap);
+    size= roaring_serialized_size(bitmap);
+    big= (uint8_t *) MALLOC(size);
+    UTEST_ASSERT(roaring_serialize(bitmap, big) == size,
+		 "incorrect serialized size");
+    copy= roaring_deserialize(big, size);
+    UTEST_ASSERT((copy != NULL) && _test_roaring_check(copy, ref),
+		 "deserialized bitmap differs from reference");
+    roaring_destroy(&copy);
+    big[0]^= 0xff;
+    UTEST_ASSERT(roaring_deserialize(big, size) == NULL,
+		 "invalid cookie should be rejected");
+    FREE(big);
+  }
+  bit_vector_destroy(&ref);
+  roaring_destroy(&bitmap);
+  return UTEST_SUCCESS;
+}
+
+/**
+ * The last value of a container (0xffff) must not restart the
+ * traversal of the container when it is serialized.
+ */
+int test_roaring_serialization_last()
+{
+  static const uint32_t VALUES[]= { 3, 65535, 65536, 131071,
+				    0xfffffff0, 0xffffffff };
+  gds_roaring_t * bitmap= roaring_create();
+  gds_roaring_t * copy;
+  uint8_t * buffer;
+  size_t size;
+  unsigned int index;
+
+  for (index= 0; index < sizeof(VALUES)/sizeof(VALUES[0]); index++)
+    roaring_add(bitmap, VALUES[index]);
+  size= roaring_serialized_size(bitmap);
+  buffer= (uint8_t *) MALLOC(size);
+  UTEST_ASSERT(roaring_serialize(bitmap, buffer) == size,
+	       "incorrect serialized size");
+  copy= roaring_deserialize(buffer, size);
+  UTEST_ASSERT((copy != NULL) && roaring_equals(bitmap, copy),
+	       "deserialized bitmap differs");
+  UTEST_ASSERT(roaring_cardinality(copy) ==
+	       sizeof(VALUES)/sizeof(VALUES[0]),
+	       "incorrect cardinality");
+  for (index= 0; index < sizeof(VALUES)/sizeof(VALUES[0]); index++)
+    UTEST_ASSERT(roaring_contains(copy, VALUES[index]),
+		 "%u should be part of the bitmap", VALUES[index]);
+  roaring_destroy(&copy);
+  FREE(buffer);
+  roaring_destroy(&bitmap);
+  return UTEST_SUCCESS;
+}
+
+/////////////////////////////////////////////////////////////////////
+// GDS_CHECK_BLOOM_FILTER
+/////////////////////////////////////////////////////////////////////
+#include <libgds/sha1.h>
+#include <libgds/bloom_hash.h>
+#include <libgds/bloom_filter.h>
+
+static char *msg[] = {
+    "abc",
+    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+    NULL
+};
+
+static char *val[] = {
+    "a9993e364706816aba3e25717850c26c9cd0d89d",
+    "84983e441c3bd26ebaae4aa1f95129e5e54670f1",
+    "34aa973cd4c4daa4f61eeb2bdbad27316534016f"
+};
+
+static uint8_t uResByte[] = {
+  0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78,
+  0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d
+};
+
+/**
+ * those are the standard FIPS-180-1 (sha1) test vectors
+ */
+int sha1_check()
+{
+    int i, j;
+    char output[41];
+    SSHA1Context ctx;
+    unsigned char buf[1000];
+    unsigned char sha1sum[20];
+
+  for( i = 0; i < 3; i++ ) {
+    sha1_starts( &ctx );
+    if( i < 2 ) {
+        sha1_update( &ctx, (uint8_t *) msg[i],
+                     strlen( msg[i] ) );
+    } else {
+        memset( buf, 'a', 1000 );
+        for( j = 0; j < 1000; j++ ) {
+            sha1_update( &ctx, (uint8_t *) buf, 1000 );
+        }
+    }
+    sha1_finish( &ctx, sha1sum );
+
+    for( j = 0; j < 20; j++ ) {
+        snprintf( output + j * 2, 41-j*2, "%02x", sha1sum[j] );
+    }
+    if( memcmp( output, val[i], 40 ) ) {
+        return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * FIPS-180-1 vectors with each implementation.
+ */
+int test_sha1_vectors()
+{
+  static const int MASKS[]= { 0, SHA1_ACCEL_SHANI, SHA1_ACCEL_ALL };
+  unsigned int index;
+
+  for (index= 0; index < sizeof(MASKS)/sizeof(MASKS[0]); index++) {
+    sha1_use_accel(MASKS[index]);
+    UTEST_ASSERT(sha1_check() == 0, "incorrect digest (accel=%x)",
+		 sha1_use_accel(MASKS[index]));
+  }
+  sha1_use_accel(SHA1_ACCEL_ALL);
+  return UTEST_SUCCESS;
+}
+
+/**
+ * Batch hashing (scalar, multi-buffer and SHA extensions) must give
+ * the same digests as sha1_update on messages of all lengths.
+ */
+int test_sha1_batch()
+{
+  static const int MASKS[]= { 0, SHA1_ACCEL_SSE2,
+			      SHA1_ACCEL_SSE2 | SHA1_ACCEL_AVX2,
+			      SHA1_ACCEL_ALL };
+  uint8_t data[300];
+  const uint8_t * inputs[300];
+  uint32_t lengths[300];
+  uint8_t expected[300][20], digests[300][20];
+  SSHA1Context ctx;
+  unsigned int index;
+
+  for (index= 0; index < 300; index++)
+    data[index]= (uint8_t) (index * 7 + 3);
+  sha1_use_accel(0);
+  for (index= 0; index < 300; index++) {
+    // Messages in decreasing length, lanes finish at different times
+    lengths[index]= 299 - index;
+    inputs[index]= data + index / 2;
+    sha1_starts(&ctx);
+    sha1_update(&ctx, inputs[index], lengths[index]);
+    sha1_finish(&ctx, expected[index]);
+  }
+  for (index= 0; index < sizeof(MASKS)/sizeof(MASKS[0]); index++) {
+    sha1_use_accel(MASKS[index]);
+    memset(digests, 0, sizeof(digests));
+    sha1_batch(inputs, lengths, 300, digests);
+    UTEST_ASSERT(!memcmp(digests, expected, sizeof(expected)),
+		 "incorrect batch digest (accel=%x)",
+		 sha1_use_accel(MASKS[index]));
+    sha1_batch(inputs, lengths, 3, digests);
+    UTEST_ASSERT(!memcmp(digests, expected, 3 * 20),
+		 "incorrect batch digest with idle lanes (accel=%x)",
+		 sha1_use_accel(MASKS[index]));
+  }
+  sha1_use_accel(SHA1_ACCEL_ALL);
+  return UTEST_SUCCESS;
+}
+
+/*int _bloom_print_for_each(void * pItem, void * pCtx)
+{
+  uint32_t uItem = *(uint32_t *) pItem;
+
+  printf("%02x|", uItem);
   return 0;
 }*/
 
@@ -4218,7 +7293,13 @@ int test_bloom_hash_creation_destruction()
 {
   SBloomFilterHash * pBloomHash;
 
-  UTEST_ASSERT(bloom_hash_create(10000000, 21) == NULL, "sha1 signature is 20 byte long. ");
+  UTEST_ASSERT(bloom_hash_create_mode(10000000, 21, BLOOM_HASH_SHA1) == NULL,
+	       "sha1 signature is 20 byte long. ");
+  UTEST_ASSERT(bloom_hash_create(10000000, 0) == NULL,
+	       "at least one hash is required");
+  pBloomHash = bloom_hash_create(10000000, 100);
+  UTEST_ASSERT(pBloomHash != NULL, "double hashing is not limited to 20 hashes");
+  bloom_hash_destroy(&pBloomHash);
   pBloomHash = bloom_hash_create(10, 20);
   bloom_hash_destroy(&pBloomHash);
   UTEST_ASSERT(pBloomHash==NULL, "Bloom Hash not well destroyed");
@@ -4235,24 +7316,79 @@ int test_bloom_hash_insertion()
   uint8_t uCpt;
   uint32_t uByte;
 
-  pBloomHash = bloom_hash_create(MAX_UINT32_T, 20);
+  pBloomHash = bloom_hash_create_mode(MAX_UINT32_T, 20, BLOOM_HASH_SHA1);
   uArray = bloom_hash_get(pBloomHash, (uint8_t*)msg[0], strlen(msg[0]));
   for (uCpt = 0; uCpt < 20; uCpt++) {
     uByte= uArray->data[uCpt];
     if (uByte != uResByte[uCpt] ) {
+      uint32_array_destroy(&uArray);
       bloom_hash_destroy(&pBloomHash);
       return UTEST_FAILURE;
     }
   }
+  uint32_array_destroy(&uArray);
   bloom_hash_destroy(&pBloomHash);
   return UTEST_SUCCESS;
 }
 
+/**
+ * Double hashing: indices must be in range, deterministic and
+ * spread over the whole range.
+ */
+int test_bloom_hash_indices()
+{
+  SBloomFilterHash * pBloomHash;
+  uint32_t auIndices1[64], auIndices2[64];
+  uint32_array_t * uArray;
+  uint8_t auSeen[1000];
+  unsigned int uCpt, uNbrSeen= 0;
+  uint64_t auDigest1[2], auDigest2[2];
+
+  pBloomHash = bloom_hash_create(1000, 64);
+  UTEST_ASSERT(bloom_hash_get_nbr(pBloomHash) == 64,
+	       "incorrect number of hashes");
+  UTEST_ASSERT(bloom_hash_get_indices(pBloomHash, (uint8_t*)msg[1],
+				      strlen(msg[1]), auIndices1) == 0,
+	       "could not compute indices");
+  UTEST_ASSERT(bloom_hash_get_indices(pBloomHash, (uint8_t*)msg[1],
+				      strlen(msg[1]), auIndices2) == 0,
+	       "could not compute indices");
+  memset(auSeen, 0, sizeof(auSeen));
+  for (uCpt= 0; uCpt < 64; uCpt++) {
+    UTEST_ASSERT(auIndices1[uCpt] < 1000, "index out of range");
+    UTEST_ASSERT(auIndices1[uCpt] == auIndices2[uCpt],
+		 "indices should be deterministic");
+    if (!auSeen[auIndices1[uCpt]]++)
+      uNbrSeen++;
+  }
+  UTEST_ASSERT(uNbrSeen > 50, "indices are poorly distributed");
+
+  uArray = bloom_hash_get(pBloomHash, (uint8_t*)msg[1], strlen(msg[1]));
+  UTEST_ASSERT(uint32_array_size(uArray) == 64, "incorrect array size");
+  UTEST_ASSERT(memcmp(uArray->data, auIndices1, sizeof(auIndices1)) == 0,
+	       "bloom_hash_get and bloom_hash_get_indices should agree");
+  uint32_array_destroy(&uArray);
+  bloom_hash_destroy(&pBloomHash);
+
+  // Empty key, different seeds, one-byte difference
+  bloom_hash_128(NULL, 0, 0, auDigest1);
+  bloom_hash_128(NULL, 0, 1, auDigest2);
+  UTEST_ASSERT(auDigest1[0] != auDigest2[0], "seed should change the digest");
+  bloom_hash_128((uint8_t*)"abcdefghijklmnopq", 17, 0, auDigest1);
+  bloom_hash_128((uint8_t*)"abcdefghijklmnopr", 17, 0, auDigest2);
+  UTEST_ASSERT((auDigest1[0] != auDigest2[0]) &&
+	       (auDigest1[1] != auDigest2[1]), "digests should differ");
+  return UTEST_SUCCESS;
+}
+
 int test_bloom_filter_creation_destruction()
 {
   SBloomFilter * pBloomFilter;
 
-  UTEST_ASSERT(bloom_filter_create(1000, 21) == NULL, "bloom filter can't have more than 20 hashes with sha1");
+  UTEST_ASSERT(bloom_filter_create(1000, 0) == NULL, "bloom filter needs at least one hash");
+  pBloomFilter = bloom_filter_create(1000, 40);
+  UTEST_ASSERT(pBloomFilter != NULL, "bloom filter can have more than 20 hashes");
+  bloom_filter_destroy(&pBloomFilter);
   pBloomFilter = bloom_filter_create(1000, 20);
   bloom_filter_destroy(&pBloomFilter);
   UTEST_ASSERT(pBloomFilter==NULL, "pBloomFilter not well destroyed");
@@ -4280,6 +7416,9 @@ int test_bloom_filter_membership()
 {
   SBloomFilter * pBloomFilter;
 
+  char acKey[16];
+  unsigned int uCpt, uNbrFP= 0;
+
   pBloomFilter = bloom_filter_create(30, 9);
 
 /*  bloom_filter_add_array(pBloomFilter, (uint8_t**)msg);
@@ -4290,6 +7429,37 @@ int test_bloom_filter_membership()
 
   bloom_filter_destroy(&pBloomFilter);
 
+  // 1000 keys, 10 bits per key, 7 hashes => ~0.8% false positives
+  pBloomFilter = bloom_filter_create(10000, 7);
+  for (uCpt= 0; uCpt < 1000; uCpt++) {
+    snprintf(acKey, sizeof(acKey), "key-%u", uCpt);
+    bloom_filter_add(pBloomFilter, (uint8_t*)acKey, strlen(acKey));
+  }
+  for (uCpt= 0; uCpt < 1000; uCpt++) {
+    snprintf(acKey, sizeof(acKey), "key-%u", uCpt);
+    UTEST_ASSERT(bloom_filter_is_member(pBloomFilter, (uint8_t*)acKey,
+					strlen(acKey)),
+		 "%s should be part of the bloom filter.", acKey);
+  }
+  for (uCpt= 0; uCpt < 10000; uCpt++) {
+    snprintf(acKey, sizeof(acKey), "other-%u", uCpt);
+    if (bloom_filter_is_member(pBloomFilter, (uint8_t*)acKey, strlen(acKey)))
+      uNbrFP++;
+  }
+  UTEST_ASSERT(uNbrFP < 300, "too many false positives (%u)", uNbrFP);
+  bloom_filter_destroy(&pBloomFilter);
+
+  // More hashes than the stack buffer
+  pBloomFilter = bloom_filter_create(10000, 50);
+  bloom_filter_add(pBloomFilter, (uint8_t*)msg[0], strlen(msg[0]));
+  UTEST_ASSERT(bloom_filter_is_member(pBloomFilter, (uint8_t*)msg[0],
+				      strlen(msg[0])),
+	       "%s should be part of the bloom filter.", msg[0]);
+  UTEST_ASSERT(!bloom_filter_is_member(pBloomFilter, (uint8_t*)msg[1],
+				       strlen(msg[1])),
+	       "%s should not be part of the bloom filter.", msg[1]);
+  bloom_filter_destroy(&pBloomFilter);
+
   return UTEST_SUCCESS;
 }
 
@@ -4297,6 +7467,786 @@ int test_bloom_filter_binary_operations()
 {
   return UTEST_SKIPPED;
 }
+
+int test_bloom_filter_sizing()
+{
+  SBloomFilter * pBloomFilter;
+  uint32_t uSize, uNbrHash;
+
+  UTEST_ASSERT(bloom_filter_optimal_params(1000, 0.01, &uSize, &uNbrHash) == 0,
+	       "could not compute parameters");
+  UTEST_ASSERT((uSize == 9586) && (uNbrHash == 7),
+	       "incorrect parameters (%u bits, %u hashes)", uSize, uNbrHash);
+  UTEST_ASSERT(bloom_filter_optimal_params(0, 0.01, &uSize, &uNbrHash) < 0,
+	       "number of keys should be > 0");
+  UTEST_ASSERT(bloom_filter_optimal_params(1000, 0, &uSize, &uNbrHash) < 0,
+	       "false positive rate should be > 0");
+  UTEST_ASSERT(bloom_filter_optimal_params(1000, 1, &uSize, &uNbrHash) < 0,
+	       "false positive rate should be < 1");
+  UTEST_ASSERT(bloom_filter_optimal_params(MAX_UINT32_T, 0.0001,
+					   &uSize, &uNbrHash) < 0,
+	       "filter should be too large");
+  pBloomFilter= bloom_filter_create_optimal(1000, 0.01);
+  UTEST_ASSERT(pBloomFilter != NULL, "could not create filter");
+  bloom_filter_destroy(&pBloomFilter);
+  return UTEST_SUCCESS;
+}
+
+int test_bloom_filter_stats()
+{
+  SBloomFilter * pBloomFilter;
+  SBloomFilterStats tStats;
+  char acKey[16];
+  unsigned int uCpt, uNbrFP= 0;
+
+  pBloomFilter= bloom_filter_create_optimal(2000, 0.01);
+  UTEST_ASSERT(bloom_filter_stats(pBloomFilter, &tStats) == 0,
+	       "could not compute stats");
+  UTEST_ASSERT((tStats.uNbrBitsSet == 0) && (tStats.dFillRatio == 0) &&
+	       (tStats.dFPRate == 0) && (tStats.dCardinality == 0),
+	       "empty filter stats are incorrect");
+  for (uCpt= 0; uCpt < 2000; uCpt++) {
+    snprintf(acKey, sizeof(acKey), "key-%u", uCpt);
+    bloom_filter_add(pBloomFilter, (uint8_t*)acKey, strlen(acKey));
+  }
+  for (uCpt= 0; uCpt < 20000; uCpt++) {
+    snprintf(acKey, sizeof(acKey), "other-%u", uCpt);
+    if (bloom_filter_is_member(pBloomFilter, (uint8_t*)acKey, strlen(acKey)))
+      uNbrFP++;
+  }
+  bloom_filter_stats(pBloomFilter, &tStats);
+  UTEST_ASSERT((tStats.dFillRatio > 0.45) && (tStats.dFillRatio < 0.55),
+	       "fill ratio should be close to 1/2 (%f)", tStats.dFillRatio);
+  UTEST_ASSERT((tStats.dCardinality > 1900) && (tStats.dCardinality < 2100),
+	       "cardinality should be close to 2000 (%f)", tStats.dCardinality);
+  UTEST_ASSERT((tStats.dFPRate > 0.005) && (tStats.dFPRate < 0.02),
+	       "FP rate should be close to 1%% (%f)", tStats.dFPRate);
+  UTEST_ASSERT(uNbrFP < 400, "too many false positives (%u)", uNbrFP);
+  bloom_filter_destroy(&pBloomFilter);
+  UTEST_ASSERT(bloom_filter_stats(NULL, &tStats) < 0, "NULL filter");
+  return UTEST_SUCCESS;
+}
+
+int test_bloom_filter_batch()
+{
+  SBloomFilter * pBloomFilter;
+  SBloomFilter * pBloomFilter2;
+  char acKeys[100][16];
+  uint8_t * apuKeys[100];
+  uint32_t auKeyLens[100];
+  uint8_t auResults[100];
+  unsigned int uCpt;
+
+  for (uCpt= 0; uCpt < 100; uCpt++) {
+    snprintf(acKeys[uCpt], sizeof(acKeys[uCpt]), "key-%u", uCpt);
+    apuKeys[uCpt]= (uint8_t *) acKeys[uCpt];
+    auKeyLens[uCpt]= strlen(acKeys[uCpt]);
+  }
+
+  // Batch and single additions give the same filter
+  pBloomFilter= bloom_filter_create(1000, 5);
+  pBloomFilter2= bloom_filter_create(1000, 5);
+  UTEST_ASSERT(bloom_filter_add_batch(pBloomFilter, apuKeys,
+				      auKeyLens, 50) == 0,
+	       "batch addition failed");
+  for (uCpt= 0; uCpt < 50; uCpt++)
+    bloom_filter_add(pBloomFilter2, apuKeys[uCpt], auKeyLens[uCpt]);
+  UTEST_ASSERT(bloom_filter_equals(pBloomFilter, pBloomFilter2),
+	       "batch and single additions should give the same filter");
+
+  UTEST_ASSERT(bloom_filter_is_member_batch(pBloomFilter, apuKeys, auKeyLens,
+					    100, auResults) == 0,
+	       "batch membership failed");
+  for (uCpt= 0; uCpt < 100; uCpt++)
+    UTEST_ASSERT(auResults[uCpt] ==
+		 bloom_filter_is_member(pBloomFilter, apuKeys[uCpt],
+					auKeyLens[uCpt]),
+		 "batch and single membership differ for %s", acKeys[uCpt]);
+  for (uCpt= 0; uCpt < 50; uCpt++)
+    UTEST_ASSERT(auResults[uCpt] == 1, "%s should be a member", acKeys[uCpt]);
+  UTEST_ASSERT(bloom_filter_is_member_batch(pBloomFilter, apuKeys, auKeyLens,
+					    100, NULL) < 0,
+	       "results can't be NULL");
+  bloom_filter_destroy(&pBloomFilter);
+  bloom_filter_destroy(&pBloomFilter2);
+
+  // More hashes than the stack buffer
+  pBloomFilter= bloom_filter_create(10000, 40);
+  bloom_filter_add_batch(pBloomFilter, apuKeys, auKeyLens, 20);
+  bloom_filter_is_member_batch(pBloomFilter, apuKeys, auKeyLens, 40,
+			       auResults);
+  for (uCpt= 0; uCpt < 20; uCpt++)
+    UTEST_ASSERT(auResults[uCpt] == 1, "%s should be a member", acKeys[uCpt]);
+  bloom_filter_destroy(&pBloomFilter);
+  return UTEST_SUCCESS;
+}
+
+#include <libgds/bloom_scalable.h>
+
+int test_bloom_scalable()
+{
+  gds_bloom_scalable_t * filter;
+  char key[16];
+  unsigned int index, num_fp= 0;
+
+  UTEST_ASSERT(bloom_scalable_create(0, 0.01) == NULL,
+	       "capacity should be > 0");
+  UTEST_ASSERT(bloom_scalable_create(100, 1.5) == NULL,
+	       "false positive rate should be < 1");
+
+  filter= bloom_scalable_create(100, 0.01);
+  UTEST_ASSERT(bloom_scalable_num_slices(filter) == 1,
+	       "filter should have a single slice");
+  for (index= 0; index < 10000; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(bloom_scalable_add(filter, (uint8_t *) key,
+				    strlen(key)) == 0,
+		 "could not add %s", key);
+  }
+  // 100+200+...+6400 < 10000 <= 12700
+  UTEST_ASSERT(bloom_scalable_num_slices(filter) == 7,
+	       "filter should have 7 slices (%u)",
+	       bloom_scalable_num_slices(filter));
+  UTEST_ASSERT(bloom_scalable_num_keys(filter) <= 10000,
+	       "too many keys");
+  for (index= 0; index < 10000; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(bloom_scalable_is_member(filter, (uint8_t *) key,
+					  strlen(key)),
+		 "%s should be part of the filter", key);
+  }
+  for (index= 0; index < 20000; index++) {
+    snprintf(key, sizeof(key), "other-%u", index);
+    if (bloom_scalable_is_member(filter, (uint8_t *) key, strlen(key)))
+      num_fp++;
+  }
+  UTEST_ASSERT(num_fp < 400, "too many false positives (%u)", num_fp);
+  UTEST_ASSERT(bloom_scalable_fp_rate(filter) < 0.02,
+	       "estimated FP rate is too high (%f)",
+	       bloom_scalable_fp_rate(filter));
+  UTEST_ASSERT(bloom_scalable_get_slice(filter, 7) == NULL,
+	       "slice 7 should not exist");
+  bloom_scalable_destroy(&filter);
+  UTEST_ASSERT(filter == NULL, "filter not well destroyed");
+  return UTEST_SUCCESS;
+}
+
+#include <libgds/bloom_counting.h>
+
+int test_bloom_counting_creation_destruction()
+{
+  gds_bloom_counting_t * filter;
+
+  UTEST_ASSERT(bloom_counting_create(0, 7) == NULL,
+	       "bloom filter can't be empty");
+  UTEST_ASSERT(bloom_counting_create(1000, 0) == NULL,
+	       "bloom filter needs at least one hash");
+  filter= bloom_counting_create(1001, 7);
+  UTEST_ASSERT(filter != NULL, "bloom filter could not be created");
+  bloom_counting_destroy(&filter);
+  UTEST_ASSERT(filter == NULL, "bloom filter not well destroyed");
+  return UTEST_SUCCESS;
+}
+
+int test_bloom_counting_add_remove()
+{
+  gds_bloom_counting_t * filter= bloom_counting_create(10000, 7);
+  char key[16];
+  unsigned int index;
+
+  for (index= 0; index < 500; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    bloom_counting_add(filter, (uint8_t *) key, strlen(key));
+  }
+  // The same key is added twice
+  bloom_counting_add(filter, (uint8_t *) msg[0], strlen(msg[0]));
+  bloom_counting_add(filter, (uint8_t *) msg[0], strlen(msg[0]));
+  for (index= 0; index < 500; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(bloom_counting_is_member(filter, (uint8_t *) key,
+					  strlen(key)),
+		 "%s should be part of the bloom filter", key);
+  }
+  UTEST_ASSERT(bloom_counting_remove(filter, (uint8_t *) msg[1],
+				     strlen(msg[1])) < 0,
+	       "%s is not part of the bloom filter", msg[1]);
+
+  // Remove half of the keys, the other half must still be members
+  for (index= 0; index < 500; index+= 2) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(bloom_counting_remove(filter, (uint8_t *) key,
+				       strlen(key)) == 0,
+		 "could not remove %s", key);
+  }
+  for (index= 1; index < 500; index+= 2) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(bloom_counting_is_member(filter, (uint8_t *) key,
+					  strlen(key)),
+		 "%s should still be part of the bloom filter", key);
+  }
+  for (index= 1; index < 500; index+= 2) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    bloom_counting_remove(filter, (uint8_t *) key, strlen(key));
+  }
+
+  // Only msg[0] is left (added twice)
+  UTEST_ASSERT(bloom_counting_remove(filter, (uint8_t *) msg[0],
+				     strlen(msg[0])) == 0,
+	       "could not remove %s", msg[0]);
+  UTEST_ASSERT(bloom_counting_is_member(filter, (uint8_t *) msg[0],
+					strlen(msg[0])),
+	       "%s was added twice, it should still be a member", msg[0]);
+  UTEST_ASSERT(bloom_counting_remove(filter, (uint8_t *) msg[0],
+				     strlen(msg[0])) == 0,
+	       "could not remove %s", msg[0]);
+  for (index= 0; index < 10000; index++)
+    UTEST_ASSERT(bloom_counting_get_counter(filter, index) == 0,
+		 "all counters should be 0");
+  bloom_counting_destroy(&filter);
+  return UTEST_SUCCESS;
+}
+
+int test_bloom_counting_saturation()
+{
+  gds_bloom_counting_t * filter= bloom_counting_create(64, 3);
+  unsigned int index;
+
+  for (index= 0; index < 20; index++)
+    bloom_counting_add(filter, (uint8_t *) msg[0], strlen(msg[0]));
+  UTEST_ASSERT(bloom_counting_num_saturated(filter) > 0,
+	       "counters should be saturated");
+  for (index= 0; index < 64; index++)
+    UTEST_ASSERT(bloom_counting_get_counter(filter, index) <=
+		 BLOOM_COUNTING_MAX, "counter overflow");
+  for (index= 0; index < 20; index++)
+    bloom_counting_remove(filter, (uint8_t *) msg[0], strlen(msg[0]));
+  UTEST_ASSERT(bloom_counting_is_member(filter, (uint8_t *) msg[0],
+					strlen(msg[0])),
+	       "saturated counters should never be decremented");
+  bloom_counting_destroy(&filter);
+  return UTEST_SUCCESS;
+}
+
+int test_bloom_counting_convert()
+{
+  gds_bloom_counting_t * filter= bloom_counting_create(5001, 5);
+  SBloomFilter * bloom_filter;
+  char key[16];
+  unsigned int index;
+
+  for (index= 0; index < 400; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    bloom_counting_add(filter, (uint8_t *) key, strlen(key));
+  }
+  bloom_filter= bloom_counting_to_bloom_filter(filter);
+  UTEST_ASSERT(bloom_filter != NULL, "conversion failed");
+  for (index= 0; index < 1000; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(bloom_filter_is_member(bloom_filter, (uint8_t *) key,
+					strlen(key)) ==
+		 bloom_counting_is_member(filter, (uint8_t *) key,
+					  strlen(key)),
+		 "both filters should answer the same for %s", key);
+  }
+  bloom_filter_destroy(&bloom_filter);
+  bloom_counting_destroy(&filter);
+  return UTEST_SUCCESS;
+}
+
+#include <libgds/bloom_blocked.h>
+
+int test_bloom_blocked_creation_destruction()
+{
+  gds_bloom_blocked_t * filter;
+
+  UTEST_ASSERT(bloom_blocked_create(0, 7) == NULL,
+	       "bloom filter can't be empty");
+  UTEST_ASSERT(bloom_blocked_create(1000, 0) == NULL,
+	       "bloom filter needs at least one hash");
+  filter= bloom_blocked_create(1000, 7);
+  UTEST_ASSERT(filter != NULL, "bloom filter could not be created");
+  UTEST_ASSERT(bloom_blocked_num_bits(filter) == 1024,
+	       "size should be rounded up to a multiple of 512 bits");
+  bloom_blocked_destroy(&filter);
+  UTEST_ASSERT(filter == NULL, "bloom filter not well destroyed");
+  return UTEST_SUCCESS;
+}
+
+int test_bloom_blocked_membership()
+{
+  gds_bloom_blocked_t * filter;
+  char key[16];
+  unsigned int index, num_fp= 0;
+
+  // 1000 keys, 10 bits per key, 7 hashes
+  filter= bloom_blocked_create(10000, 7);
+  for (index= 0; index < 1000; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(bloom_blocked_add(filter, (uint8_t *) key,
+				   strlen(key)) == 0,
+		 "could not add %s", key);
+  }
+  for (index= 0; index < 1000; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(bloom_blocked_is_member(filter, (uint8_t *) key,
+					 strlen(key)),
+		 "%s should be part of the bloom filter", key);
+  }
+  for (index= 0; index < 10000; index++) {
+    snprintf(key, sizeof(key), "other-%u", index);
+    if (bloom_blocked_is_member(filter, (uint8_t *) key, strlen(key)))
+      num_fp++;
+  }
+  UTEST_ASSERT(num_fp < 400, "too many false positives (%u)", num_fp);
+  bloom_blocked_clear(filter);
+  UTEST_ASSERT(!bloom_blocked_is_member(filter, (uint8_t *) "key-0", 5),
+	       "cleared bloom filter should be empty");
+  bloom_blocked_destroy(&filter);
+  return UTEST_SUCCESS;
+}
+
+int test_bloom_blocked_binary_operations()
+{
+  gds_bloom_blocked_t * filter1= bloom_blocked_create(4096, 5);
+  gds_bloom_blocked_t * filter2= bloom_blocked_create(4096, 5);
+  gds_bloom_blocked_t * filter3= bloom_blocked_create(4096, 6);
+  gds_bloom_blocked_t * empty= bloom_blocked_create(4096, 5);
+
+  bloom_blocked_add(filter1, (uint8_t *) msg[0], strlen(msg[0]));
+  bloom_blocked_add(filter2, (uint8_t *) msg[1], strlen(msg[1]));
+  UTEST_ASSERT(bloom_blocked_or(filter1, filter3) < 0,
+	       "filters with different parameters can't be combined");
+  UTEST_ASSERT(!bloom_blocked_equals(filter1, filter2),
+	       "filters should be different");
+
+  // (f1 | f2) contains both keys
+  UTEST_ASSERT(bloom_blocked_or(filter1, filter2) == 0, "or failed");
+  UTEST_ASSERT(bloom_blocked_is_member(filter1, (uint8_t *) msg[0],
+				       strlen(msg[0])) &&
+	       bloom_blocked_is_member(filter1, (uint8_t *) msg[1],
+				       strlen(msg[1])),
+	       "union should contain both keys");
+
+  // (f1 | f2) & f2 == f2
+  UTEST_ASSERT(bloom_blocked_and(filter1, filter2) == 0, "and failed");
+  UTEST_ASSERT(bloom_blocked_equals(filter1, filter2),
+	       "intersection should be equal to the second filter");
+  UTEST_ASSERT(bloom_blocked_and(filter1, empty) == 0, "and failed");
+  UTEST_ASSERT(bloom_blocked_equals(filter1, empty),
+	       "intersection with empty filter should be empty");
+
+  bloom_blocked_destroy(&filter1);
+  bloom_blocked_destroy(&filter2);
+  bloom_blocked_destroy(&filter3);
+  bloom_blocked_destroy(&empty);
+  return UTEST_SUCCESS;
+}
+
+#include <libgds/cuckoo_filter.h>
+
+int test_cuckoo_filter_creation_destruction()
+{
+  gds_cuckoo_filter_t * filter;
+  gds_cuckoo_filter_stats_t stats;
+
+  UTEST_ASSERT(cuckoo_filter_create(0, 8) == NULL,
+	       "cuckoo filter can't be empty");
+  UTEST_ASSERT(cuckoo_filter_create(1000, 0) == NULL,
+	       "fingerprints can't be empty");
+  UTEST_ASSERT(cuckoo_filter_create(1000, 17) == NULL,
+	       "fingerprints are limited to 16 bits");
+  UTEST_ASSERT(cuckoo_filter_create_optimal(1000, 0.00001) == NULL,
+	       "fp rate requires more than 16 bits");
+  filter= cuckoo_filter_create_optimal(1000, 0.01);
+  UTEST_ASSERT(filter != NULL, "cuckoo filter could not be created");
+  UTEST_ASSERT((cuckoo_filter_stats(filter, &stats) == 0) &&
+	       (stats.fp_bits == 10) && (stats.num_buckets == 264) &&
+	       (stats.size == 264*4*2) && (stats.num_items == 0),
+	       "incorrect parameters (%u bits, %u buckets)",
+	       stats.fp_bits, stats.num_buckets);
+  cuckoo_filter_destroy(&filter);
+  UTEST_ASSERT(filter == NULL, "cuckoo filter not well destroyed");
+  return UTEST_SUCCESS;
+}
+
+int test_cuckoo_filter_membership()
+{
+  gds_cuckoo_filter_t * filter= cuckoo_filter_create(10000, 12);
+  gds_cuckoo_filter_stats_t stats;
+  char key[16];
+  unsigned int index, num_fp= 0;
+
+  for (index= 0; index < 10000; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(cuckoo_filter_add(filter, (uint8_t *) key,
+				   strlen(key)) == 0,
+		 "could not add %s", key);
+  }
+  for (index= 0; index < 10000; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(cuckoo_filter_is_member(filter, (uint8_t *) key,
+					 strlen(key)),
+		 "%s should be part of the cuckoo filter", key);
+  }
+  for (index= 0; index < 10000; index++) {
+    snprintf(key, sizeof(key), "other-%u", index);
+    if (cuckoo_filter_is_member(filter, (uint8_t *) key, strlen(key)))
+      num_fp++;
+  }
+  cuckoo_filter_stats(filter, &stats);
+  UTEST_ASSERT(stats.load_factor > 0.9, "incorrect load factor (%f)",
+	       stats.load_factor);
+  UTEST_ASSERT(num_fp < 3 * 10000 * stats.fp_rate,
+	       "too many false positives (%u, expected %f)",
+	       num_fp, 10000 * stats.fp_rate);
+
+  // Remove the even keys
+  for (index= 0; index < 10000; index+= 2) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(cuckoo_filter_remove(filter, (uint8_t *) key,
+				      strlen(key)) == 0,
+		 "could not remove %s", key);
+  }
+  UTEST_ASSERT(cuckoo_filter_num_items(filter) == 5000,
+	       "incorrect number of items");
+  num_fp= 0;
+  for (index= 0; index < 10000; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    if (index & 1) {
+      UTEST_ASSERT(cuckoo_filter_is_member(filter, (uint8_t *) key,
+					   strlen(key)),
+		   "%s should still be part of the cuckoo filter", key);
+    } else if (cuckoo_filter_is_member(filter, (uint8_t *) key, strlen(key)))
+      num_fp++;
+  }
+  UTEST_ASSERT(num_fp < 50, "too many removed keys found (%u)", num_fp);
+  cuckoo_filter_destroy(&filter);
+  return UTEST_SUCCESS;
+}
+
+int test_cuckoo_filter_full()
+{
+  gds_cuckoo_filter_t * filter= cuckoo_filter_create(1000, 16);
+  char key[16];
+  unsigned int index, num_keys;
+
+  for (num_keys= 0; num_keys < 2000; num_keys++) {
+    snprintf(key, sizeof(key), "key-%u", num_keys);
+    if (cuckoo_filter_add(filter, (uint8_t *) key, strlen(key)) < 0)
+      break;
+  }
+  UTEST_ASSERT((num_keys < 2000) && (cuckoo_filter_load_factor(filter) > 0.95),
+	       "filter should be full at a high load (%u keys)", num_keys);
+  for (index= 0; index < num_keys; index++) {
+    snprintf(key, sizeof(key), "key-%u", index);
+    UTEST_ASSERT(cuckoo_filter_is_member(filter, (uint8_t *) key,
+					 strlen(key)),
+		 "%s should be part of the cuckoo filter", key);
+  }
+  // Removing a key makes room for a new one
+  UTEST_ASSERT(cuckoo_filter_remove(filter, (uint8_t *) "key-0", 5) == 0,
+	       "could not remove key-0");
+  snprintf(key, sizeof(key), "key-%u", num_keys);
+  UTEST_ASSERT(cuckoo_filter_add(filter, (uint8_t *) key, strlen(key)) == 0,
+	       "could not add a key after a removal");
+  UTEST_ASSERT(cuckoo_filter_num_items(filter) == num_keys,
+	       "incorrect number of items");
+  cuckoo_filter_destroy(&filter);
+  return UTEST_SUCCESS;
+}
+/////////////////////////////////////////////////////////////////////
+// GDS_CHECK_POOL
+/////////////////////////////////////////////////////////////////////
+#include <libgds/pool.h>
+
+// -----[ _pool_sum_init ]-------------------------------------------
+static void _pool_sum_init(void * part, void * ctx)
+{
+  *((size_t *) part)= 0;
+}
+
+// -----[ _pool_sum_merge ]------------------------------------------
+static void _pool_sum_merge(void * ctx, void * part)
+{
+  *((size_t *) ctx)+= *((size_t *) part);
+}
+
+static gds_pool_reducer_t _pool_sum_reducer= {
+  sizeof(size_t), _pool_sum_init, _pool_sum_merge
+};
+
+// -----[ _pool_list_init ]------------------------------------------
+/** Partial result: the list of the items visited by a task. */
+static void _pool_list_init(void * part, void * ctx)
+{
+  *((ptr_array_t **) part)= ptr_array_create(0, NULL, NULL, NULL);
+}
+
+// -----[ _pool_list_merge ]-----------------------------------------
+static void _pool_list_merge(void * ctx, void * part)
+{
+  ptr_array_t * list= *((ptr_array_t **) part);
+  unsigned int index;
+
+  for (index= 0; index < ptr_array_length(list); index++)
+    ptr_array_append((ptr_array_t *) ctx, list->data[index]);
+  ptr_array_destroy(&list);
+}
+
+static gds_pool_reducer_t _pool_list_reducer= {
+  sizeof(ptr_array_t *), _pool_list_init, _pool_list_merge
+};
+
+// -----[ _pool_array_sum ]------------------------------------------
+static int _pool_array_sum(const void * item, const void * ctx)
+{
+  *((size_t *) ctx)+= *((const uint32_t *) item);
+  return 0;
+}
+
+// -----[ _pool_array_list ]-----------------------------------------
+static int _pool_array_list(const void * item, const void * ctx)
+{
+  void * data= (void *) (size_t) *((const uint32_t *) item);
+  ptr_array_append(*((ptr_array_t **) ctx), data);
+  return 0;
+}
+
+// -----[ _pool_array_fail ]-----------------------------------------
+static int _pool_array_fail(const void * item, const void * ctx)
+{
+  uint32_t value= *((const uint32_t *) item);
+  if ((value % 300) == 299)
+    return (int) value;
+  return 0;
+}
+
+// -----[ _pool_hash_sum ]-------------------------------------------
+static int _pool_hash_sum(void * item, void * ctx)
+{
+  *((size_t *) ctx)+= (size_t) item;
+  return 0;
+}
+
+// -----[ _pool_trie_list ]------------------------------------------
+static int _pool_trie_list(trie_key_t key, trie_key_len_t key_len,
+			   void * data, void * ctx)
+{
+  ptr_array_append(*((ptr_array_t **) ctx), data);
+  return 0;
+}
+
+// -----[ _pool_radix_list ]-----------------------------------------
+static int _pool_radix_list(uint32_t key, uint8_t key_len,
+			    void * data, void * ctx)
+{
+  ptr_array_append(*((ptr_array_t **) ctx), data);
+  return 0;
+}
+
+// -----[ _pool_radix_fail ]-----------------------------------------
+static int _pool_radix_fail(uint32_t key, uint8_t key_len,
+			    void * data, void * ctx)
+{
+  if (key_len == 24)
+    return (int) key_len;
+  return 0;
+}
+
+// -----[ _pool_range_count ]---------------------------------------
+static int _pool_range_count(unsigned int begin, unsigned int end,
+			     void * part, void * ctx)
+{
+  *((size_t *) part)+= end-begin;
+  __atomic_add_fetch((unsigned int *) ctx, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+// -----[ test_pool_run ]--------------------------------------------
+static int test_pool_run()
+{
+  gds_pool_t * pool= pool_create(4);
+  unsigned int num_tasks= 0;
+  size_t count= 0;
+
+  UTEST_ASSERT(pool_num_workers(pool) == 4,
+	       "pool should have 4 workers");
+  UTEST_ASSERT(pool_run(pool, 1000, 7, _pool_range_count, &num_tasks,
+			&_pool_sum_reducer, &count, 0) == 0,
+	       "pool_run() should succeed");
+  UTEST_ASSERT(count == 1000, "all units should be run (%zu)", count);
+  UTEST_ASSERT(num_tasks == 143, "incorrect number of tasks (%u)",
+	       num_tasks);
+  count= 0;
+  UTEST_ASSERT(pool_run(pool, 0, 0, _pool_range_count, &num_tasks,
+			&_pool_sum_reducer, &count, 0) == 0,
+	       "pool_run() should succeed");
+  UTEST_ASSERT(count == 0, "no unit should be run");
+  pool_destroy(&pool);
+  UTEST_ASSERT(pool == NULL, "pool should be NULL when destroyed");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_pool_array ]------------------------------------------
+static int test_pool_array()
+{
+  uint32_array_t * array= uint32_array_create(0);
+  ptr_array_t * list;
+  gds_pool_t * pool;
+  unsigned int num_workers, index;
+  size_t sum= 0, psum;
+  uint32_t value;
+
+  for (index= 0; index < 10000; index++) {
+    value= random() % 1000000;
+    uint32_array_append(array, value);
+    sum+= value;
+  }
+  for (num_workers= 1; num_workers <= 4; num_workers++) {
+    pool= pool_create(num_workers);
+    psum= 0;
+    UTEST_ASSERT(uint32_array_parallel_for_each(array, pool,
+						_pool_array_sum, &psum,
+						&_pool_sum_reducer, 0) == 0,
+		 "parallel for-each should succeed");
+    UTEST_ASSERT(psum == sum, "incorrect sum (%zu instead of %zu)",
+		 psum, sum);
+
+    // Ordered partial results are merged in the order of the array
+    list= ptr_array_create(0, NULL, NULL, NULL);
+    UTEST_ASSERT(uint32_array_parallel_for_each(array, pool,
+						_pool_array_list, list,
+						&_pool_list_reducer,
+						POOL_OPTION_ORDERED) == 0,
+		 "parallel for-each should succeed");
+    UTEST_ASSERT(ptr_array_length(list) == 10000,
+		 "incorrect number of items");
+    for (index= 0; index < 10000; index++)
+      UTEST_ASSERT((size_t) list->data[index] == array->data[index],
+		   "item %u is out of order", index);
+    ptr_array_destroy(&list);
+    pool_destroy(&pool);
+  }
+  uint32_array_destroy(&array);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_pool_hash_set ]---------------------------------------
+static int test_pool_hash_set()
+{
+  gds_hash_set_t * hash= hash_set_create(64, 0, _hash_cmp, NULL,
+					 _hash_compute);
+  gds_pool_t * pool= pool_create(3);
+  size_t sum= 0;
+  unsigned int index;
+
+  for (index= 1; index < 1000; index++)
+    hash_set_add(hash, (void *) (size_t) index);
+  UTEST_ASSERT(hash_set_parallel_for_each(hash, pool, _pool_hash_sum, &sum,
+					  &_pool_sum_reducer, 0) == 0,
+	       "parallel for-each should succeed");
+  UTEST_ASSERT(sum == 499500, "incorrect sum (%zu)", sum);
+  hash_set_destroy(&hash);
+  pool_destroy(&pool);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_pool_trie ]-------------------------------------------
+static int test_pool_trie()
+{
+  gds_trie_t * trie= trie_create(NULL);
+  gds_trie_cursor_t cursor;
+  gds_pool_t * pool= pool_create(4);
+  ptr_array_t * list= ptr_array_create(0, NULL, NULL, NULL);
+  unsigned int index, num= 0;
+  void * data;
+
+  for (index= 1; index <= 5000; index++)
+    if (trie_insert(trie, random(), 8+random() % 25,
+		    (void *) (size_t) index, 0) == TRIE_SUCCESS)
+      num++;
+  UTEST_ASSERT(trie_parallel_for_each(trie, pool, _pool_trie_list, list,
+				      &_pool_list_reducer,
+				      POOL_OPTION_ORDERED) == 0,
+	       "parallel for-each should succeed");
+  UTEST_ASSERT(ptr_array_length(list) == num,
+	       "incorrect number of items (%u instead of %u)",
+	       ptr_array_length(list), num);
+  index= 0;
+  GDS_FOREACH(trie, cursor, trie, NULL, NULL, &data) {
+    UTEST_ASSERT(list->data[index] == data, "item %u is out of order",
+		 index);
+    index++;
+  }
+  ptr_array_destroy(&list);
+  pool_destroy(&pool);
+  trie_destroy(&trie);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_pool_radix_tree ]-------------------------------------
+static int test_pool_radix_tree()
+{
+  gds_radix_tree_t * tree= radix_tree_create(32, NULL);
+  gds_radix_tree_cursor_t cursor;
+  gds_pool_t * pool= pool_create(4);
+  ptr_array_t * list= ptr_array_create(0, NULL, NULL, NULL);
+  unsigned int index, num= 0;
+  uint32_t key;
+  uint8_t key_len;
+  void * data;
+
+  for (index= 1; index <= 5000; index++) {
+    key_len= 8+random() % 17;
+    key= random() & (0xffffffffU << (32-key_len));
+    if (radix_tree_get_exact(tree, key, key_len) != NULL)
+      continue;
+    radix_tree_add(tree, key, key_len, (void *) (size_t) index);
+    num++;
+  }
+  UTEST_ASSERT(radix_tree_parallel_for_each(tree, pool, _pool_radix_list,
+					    list, &_pool_list_reducer,
+					    POOL_OPTION_ORDERED) == 0,
+	       "parallel for-each should succeed");
+  UTEST_ASSERT(ptr_array_length(list) == num,
+	       "incorrect number of items (%u instead of %u)",
+	       ptr_array_length(list), num);
+  index= 0;
+  GDS_FOREACH(radix_tree, cursor, tree, &key, &key_len, &data) {
+    UTEST_ASSERT(list->data[index] == data, "item %u is out of order",
+		 index);
+    index++;
+  }
+  UTEST_ASSERT(radix_tree_parallel_for_each(tree, pool, _pool_radix_fail,
+					    NULL, NULL, 0) == 24,
+	       "parallel for-each should fail");
+  ptr_array_destroy(&list);
+  pool_destroy(&pool);
+  radix_tree_destroy(&tree);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_pool_failure ]----------------------------------------
+static int test_pool_failure()
+{
+  uint32_array_t * array= uint32_array_create(0);
+  gds_pool_t * pool= pool_create(4);
+  uint32_t value;
+  int result;
+
+  for (value= 0; value < 5000; value++)
+    uint32_array_append(array, value);
+  // The lowest failed item wins, whatever the scheduling
+  result= uint32_array_parallel_for_each(array, pool, _pool_array_fail,
+					 NULL, NULL, 0);
+  UTEST_ASSERT(result == 299, "incorrect result (%d)", result);
+  result= uint32_array_parallel_for_each(array, pool, _pool_array_fail,
+					 NULL, NULL, POOL_OPTION_ORDERED);
+  UTEST_ASSERT(result == 299, "incorrect result (%d)", result);
+  pool_destroy(&pool);
+  uint32_array_destroy(&array);
+  return UTEST_SUCCESS;
+}
 /////////////////////////////////////////////////////////////////////
 // MAIN PART
 /////////////////////////////////////////////////////////////////////
@@ -4329,6 +8279,11 @@ unit_test_t STREAM_TESTS[]= {
 unit_test_t FIFO_TESTS[]= {
   {test_fifo_basic, "basic use"},
   {test_fifo_grow, "growable"},
+  {test_fifo_spsc_basic, "SPSC basic use"},
+  {test_fifo_spsc_batch, "SPSC batch"},
+  {test_fifo_spsc_threads, "SPSC threads"},
+  {test_fifo_mpmc_basic, "MPMC basic use"},
+  {test_fifo_mpmc_stress, "MPMC stress"},
 };
 #define FIFO_NTESTS ARRAY_SIZE(FIFO_TESTS)
 
@@ -4342,6 +8297,7 @@ unit_test_t STACK_TESTS[]= {
 
 unit_test_t ENUM_TESTS[]= {
   {test_enum_template, "template"},
+  {test_enum_get_next_n, "get_next_n"},
 };
 #define ENUM_NTESTS ARRAY_SIZE(ENUM_TESTS)
 
@@ -4363,9 +8319,18 @@ unit_test_t PTRARRAY_TESTS[]= {
   {test_ptr_array, "basic use"},
   {test_ptr_array_template, "template"},
   {test_ptr_array_template_sorted, "template (sorted)"},
+  {test_ptr_array_cursor, "cursor"},
 };
 #define PTRARRAY_NTESTS ARRAY_SIZE(PTRARRAY_TESTS)
 
+unit_test_t BTREE_TESTS[]= {
+  {test_btree_basic, "insert/remove"},
+  {test_btree_range, "load/range"},
+  {test_btree_enum, "enum"},
+  {test_btree_owned_keys, "owned keys"},
+};
+#define BTREE_NTESTS ARRAY_SIZE(BTREE_TESTS)
+
 unit_test_t TOKENIZER_TESTS[]= {
   {test_tokenizer_basic, "basic use"},
   {test_tokenizer_quotes, "quotes"},
@@ -4443,6 +8408,9 @@ unit_test_t TRIE_TESTS[]= {
   {test_trie_for_each, "for-each"},
   {test_trie_enum, "enum"},
   {test_trie_complex, "complex"},
+  {test_trie_bulk_load, "bulk load"},
+  {test_trie_cursor, "cursor"},
+  {test_trie_prefix_enum, "prefix enum"},
 };
 #define TRIE_NTESTS ARRAY_SIZE(TRIE_TESTS)
 
@@ -4465,6 +8433,14 @@ unit_test_t TRIE_DICT_TESTS[]= {
   {test_trie_dict_remove_missing, "remove missing"},
   {test_trie_dict_remove_missing_split, "remove missing split"},
   {test_trie_dict_foreach, "for-each"},
+  {test_trie_dict_random, "random"},
+  {test_trie_dict_prefix, "for-each-prefix"},
+  {test_trie_dict_prefix_enum, "prefix enum"},
+  {test_trie_dict_freeze, "freeze"},
+  {test_trie_dict_freeze_corrupted, "freeze (corrupted file)"},
+  {test_trie_dict_freeze_corrupted_bits, "freeze (corrupted bits)"},
+  {test_trie_dict_bulk_load, "bulk load"},
+  {test_trie_dict_bulk_load_long, "bulk load (long keys)"},
   {test_trie_dict_array, "array"},
   {test_trie_dict_enum, "enum"},
 };
@@ -4476,11 +8452,30 @@ unit_test_t ASSOC_TESTS[]= {
   {test_assoc_for_each, "for-each"},
   {test_assoc_enum_keys, "enum (keys)"},
   {test_assoc_enum_values, "enum (values)"},
+  {test_assoc_large, "hash/sorted enum"},
+  {test_assoc_cursor, "cursor"},
 };
 #define ASSOC_NTESTS ARRAY_SIZE(ASSOC_TESTS)
 
+unit_test_t HEAP_TESTS[]= {
+  {test_heap_basic, "basic use"},
+  {test_heap_update, "update/remove"},
+  {test_heap_build, "build"},
+};
+#define HEAP_NTESTS ARRAY_SIZE(HEAP_TESTS)
+
+unit_test_t TIMER_WHEEL_TESTS[]= {
+  {test_timer_wheel_basic, "timing wheel"},
+  {test_timer_wheel_tick, "timing wheel (tick)"},
+  {test_calendar_queue_basic, "calendar queue"},
+  {test_calendar_queue_hold, "calendar queue (hold)"},
+};
+#define TIMER_WHEEL_NTESTS ARRAY_SIZE(TIMER_WHEEL_TESTS)
+
 unit_test_t DLLIST_TESTS[]= {
   {test_dllist_basic, "basic use"},
+  {test_dllist_handles, "handles/splice"},
+  {test_dllist_intrusive, "intrusive"},
 };
 #define DLLIST_NTESTS ARRAY_SIZE(DLLIST_TESTS)
 
@@ -4495,6 +8490,7 @@ unit_test_t HASH_SET_TESTS[]= {
   {test_hash_set_remove_missing, "remove (missing)"},
   {test_hash_set_for_each, "for-each"},
   {test_hash_set_enum, "enum"},
+  {test_hash_set_cursor, "cursor"},
   {test_hash_set_strings, "strings"},
 };
 #define HASH_SET_NTESTS ARRAY_SIZE(HASH_SET_TESTS)
@@ -4511,6 +8507,10 @@ unit_test_t RADIX_TESTS[]= {
   {test_radix_for_each, "for-each"},
   {test_radix_enum, "enum"},
   {test_radix_ipv4, "IPv4"},
+  {test_radix_dir24_8, "DIR-24-8"},
+  {test_radix_bulk_load, "bulk load"},
+  {test_radix_cursor, "cursor"},
+  {test_radix_prefix_enum, "prefix enum"},
 };
 #define RADIX_NTESTS ARRAY_SIZE(RADIX_TESTS)
 
@@ -4519,13 +8519,35 @@ unit_test_t BIT_VECTOR_TESTS[] = {
   { test_bit_vector_representation,	  "to_string/from_string" },
   { test_bit_vector_manipulations,	  "set/unset/get" },
   { test_bit_vector_binary_operations,	  "and/or/xor" },
-  { test_bit_vector_equality,		  "equals" }
+  { test_bit_vector_equality,		  "equals" },
+  { test_bit_vector_popcount,		  "popcount" },
+  { test_bit_vector_andnot_count,	  "andnot/and_count" },
+  { test_bit_vector_simd,		  "SIMD kernels" },
+  { test_bit_vector_set_bits,		  "next_set_bit/for_each" },
+  { test_bit_vector_rank_select,	  "rank/select" }
 };
 #define BIT_VECTOR_NTESTS ARRAY_SIZE(BIT_VECTOR_TESTS)
 
+unit_test_t ROARING_TESTS[] = {
+  { test_roaring_add_remove,		  "add/remove/contains" },
+  { test_roaring_runs,			  "run containers" },
+  { test_roaring_binary_operations,	  "and/or/xor/andnot" },
+  { test_roaring_for_each,		  "for_each" },
+  { test_roaring_serialization,		  "serialization" },
+  { test_roaring_serialization_last,	  "serialization (last values)" }
+};
+#define ROARING_NTESTS ARRAY_SIZE(ROARING_TESTS)
+
+unit_test_t SHA1_TESTS[] = {
+  { test_sha1_vectors,			  "FIPS-180-1 vectors" },
+  { test_sha1_batch,			  "batch" }
+};
+#define SHA1_NTESTS ARRAY_SIZE(SHA1_TESTS)
+
 unit_test_t BLOOM_HASH_TESTS[] = {
   { test_bloom_hash_creation_destruction, "creation/destruction" },
-  { test_bloom_hash_insertion,		  "insertion" }
+  { test_bloom_hash_insertion,		  "insertion" },
+  { test_bloom_hash_indices,		  "indices (double hashing)" }
 };
 #define BLOOM_HASH_NTESTS ARRAY_SIZE(BLOOM_HASH_TESTS)
 
@@ -4533,20 +8555,59 @@ unit_test_t BLOOM_FILTER_TESTS[] = {
   { test_bloom_filter_creation_destruction, "creation/destruction" },
   { test_bloom_filter_insertion,	    "insertion" },
   { test_bloom_filter_membership,	    "membership" },
-  { test_bloom_filter_binary_operations,    "and/or/xor" }
+  { test_bloom_filter_binary_operations,    "and/or/xor" },
+  { test_bloom_filter_sizing,		    "sizing" },
+  { test_bloom_filter_stats,		    "stats" },
+  { test_bloom_filter_batch,		    "batch" },
+  { test_bloom_scalable,		    "scalable" }
 };
 #define BLOOM_FILTER_NTESTS ARRAY_SIZE(BLOOM_FILTER_TESTS)
 
+unit_test_t BLOOM_COUNTING_TESTS[] = {
+  { test_bloom_counting_creation_destruction, "creation/destruction" },
+  { test_bloom_counting_add_remove,	      "add/remove" },
+  { test_bloom_counting_saturation,	      "saturation" },
+  { test_bloom_counting_convert,	      "conversion" },
+};
+#define BLOOM_COUNTING_NTESTS ARRAY_SIZE(BLOOM_COUNTING_TESTS)
+
+unit_test_t BLOOM_BLOCKED_TESTS[] = {
+  { test_bloom_blocked_creation_destruction, "creation/destruction" },
+  { test_bloom_blocked_membership,	     "membership" },
+  { test_bloom_blocked_binary_operations,    "and/or" },
+};
+#define BLOOM_BLOCKED_NTESTS ARRAY_SIZE(BLOOM_BLOCKED_TESTS)
+
+unit_test_t CUCKOO_FILTER_TESTS[] = {
+  { test_cuckoo_filter_creation_destruction, "creation/destruction" },
+  { test_cuckoo_filter_membership,	     "add/remove/is_member" },
+  { test_cuckoo_filter_full,		     "full filter" }
+};
+#define CUCKOO_FILTER_NTESTS ARRAY_SIZE(CUCKOO_FILTER_TESTS)
+
+unit_test_t POOL_TESTS[]= {
+  {test_pool_run, "run"},
+  {test_pool_array, "array"},
+  {test_pool_hash_set, "hash-set"},
+  {test_pool_trie, "trie"},
+  {test_pool_radix_tree, "radix-tree"},
+  {test_pool_failure, "failure"},
+};
+#define POOL_NTESTS ARRAY_SIZE(POOL_TESTS)
+
 unit_test_suite_t SUITES[]= {
   {"String-Utilities", STRUTILS_NTESTS, STRUTILS_TESTS},
   {"Stream", STREAM_NTESTS, STREAM_TESTS},
   {"FIFO", FIFO_NTESTS, FIFO_TESTS},
+  {"Heap", HEAP_NTESTS, HEAP_TESTS},
+  {"Timer-Wheel", TIMER_WHEEL_NTESTS, TIMER_WHEEL_TESTS},
   {"Stack", STACK_NTESTS, STACK_TESTS},
   {"Enumerator", ENUM_NTESTS, ENUM_TESTS},
   {"Array", ARRAY_NTESTS, ARRAY_TESTS,
    test_before_array, NULL},
   {"Pointer-Array", PTRARRAY_NTESTS, PTRARRAY_TESTS},
   {"Associative-Array", ASSOC_NTESTS, ASSOC_TESTS},
+  {"B+-Tree", BTREE_NTESTS, BTREE_TESTS},
   {"List", LIST_NTESTS, LIST_TESTS},
   {"Doubly-Linked-List", DLLIST_NTESTS, DLLIST_TESTS},
   {"Hash-Set", HASH_SET_NTESTS, HASH_SET_TESTS},
@@ -4558,8 +8619,14 @@ unit_test_suite_t SUITES[]= {
   {"Params", PARAMS_NTESTS, PARAMS_TESTS},
   {"CLI", CLI_NTESTS, CLI_TESTS, test_before_cli, test_after_cli},
   {"Bit Vector", BIT_VECTOR_NTESTS, BIT_VECTOR_TESTS},
+  {"Roaring", ROARING_NTESTS, ROARING_TESTS},
+  {"SHA-1", SHA1_NTESTS, SHA1_TESTS},
   {"Bloom Hash", BLOOM_HASH_NTESTS, BLOOM_HASH_TESTS},
-  {"Bloom Filter", BLOOM_FILTER_NTESTS, BLOOM_FILTER_TESTS}
+  {"Bloom Filter", BLOOM_FILTER_NTESTS, BLOOM_FILTER_TESTS},
+  {"Bloom Counting", BLOOM_COUNTING_NTESTS, BLOOM_COUNTING_TESTS},
+  {"Bloom Blocked", BLOOM_BLOCKED_NTESTS, BLOOM_BLOCKED_TESTS},
+  {"Cuckoo Filter", CUCKOO_FILTER_NTESTS, CUCKOO_FILTER_TESTS},
+  {"Pool", POOL_NTESTS, POOL_TESTS}
 };
 #define NUM_SUITES ARRAY_SIZE(SUITES)
 
@@ -347,6 +347,42 @@ int _array_for_each(array_t * array, gds_array_foreach_f foreach,
   return 0;
 }
 
+typedef struct {
+  array_t             * array;
+  gds_array_foreach_f   foreach;
+} _array_parallel_ctx_t;
+
+// ----- _array_parallel_range --------------------------------------
+static int _array_parallel_range(unsigned int begin, unsigned int end,
+				 void * part, void * ctx)
+{
+  _array_parallel_ctx_t * pctx= (_array_parallel_ctx_t *) ctx;
+  unsigned int index;
+  int result;
+
+  for (index= begin; index < end; index++) {
+    result= pctx->foreach(_array_elt_pos(pctx->array, index), part);
+    if (result != 0)
+      return result;
+  }
+  return 0;
+}
+
+// ----- _array_parallel_for_each -----------------------------------
+/**
+ * The units of the traversal are the elements of the array.
+ */
+GDS_EXP_DECL
+int _array_parallel_for_each(array_t * array, gds_pool_t * pool,
+			     gds_array_foreach_f foreach, const void * ctx,
+			     const gds_pool_reducer_t * reducer,
+			     int options)
+{
+  _array_parallel_ctx_t pctx= { array, foreach };
+  return pool_run(pool, _array_length(array), 0, _array_parallel_range,
+		  &pctx, reducer, (void *) ctx, options);
+}
+
 // ----- _array_copy ------------------------------------------------
 /**
  * Make a copy of an entire array.
@@ -534,6 +570,25 @@ static void * _enum_get_next(void * ctx)
   return (void *) _array_elt_pos(enum_ctx->array, enum_ctx->index++);
 }
 
+// -----[ _enum_get_next_n ]-----------------------------------------
+static unsigned int _enum_get_next_n(void * ctx, void ** items,
+				     unsigned int num)
+{
+  _enum_ctx_t * enum_ctx= (_enum_ctx_t *) ctx;
+  unsigned int length= ((_array_t *) enum_ctx->array)->size;
+  unsigned int index;
+
+  if (enum_ctx->index >= length)
+    return 0;
+  if (num > length-enum_ctx->index)
+    num= length-enum_ctx->index;
+  for (index= 0; index < num; index++)
+    items[index]= (void *) _array_elt_pos(enum_ctx->array,
+					  enum_ctx->index+index);
+  enum_ctx->index+= num;
+  return num;
+}
+
 // -----[ _enum_destroy ]--------------------------------------------
 static void _enum_destroy(void * ctx)
 {
@@ -546,10 +601,13 @@ GDS_EXP_DECL
 gds_enum_t * _array_get_enum(array_t * array)
 {
   _enum_ctx_t * ctx= (_enum_ctx_t *) MALLOC(sizeof(_enum_ctx_t));
+  gds_enum_t * enu;
   ctx->array= array;
   ctx->index= 0;
-  return enum_create(ctx,
-		     _enum_has_next,
-		     _enum_get_next,
-		     _enum_destroy);
+  enu= enum_create(ctx,
+		   _enum_has_next,
+		   _enum_get_next,
+		   _enum_destroy);
+  enu->ops.get_next_n= _enum_get_next_n;
+  return enu;
 }
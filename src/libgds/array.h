@@ -49,6 +49,7 @@
 #include <stdlib.h>
 
 #include <libgds/enumerator.h>
+#include <libgds/pool.h>
 #include <libgds/types.h>
 
 /** Option: array will be sorted. */
@@ -79,6 +80,18 @@ typedef struct array_t {
   char * data;
 } array_t;
 
+// -----[ gds_array_cursor_t ]---------------------------------------
+/**
+ * Cursor over the cells of an array (see GDS_FOREACH). The length
+ * of the array is read when the cursor is initialized: the array
+ * must not be modified during the traversal.
+ */
+typedef struct {
+  array_t      * array;
+  unsigned int   index;
+  unsigned int   length;
+} gds_array_cursor_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -242,6 +255,30 @@ extern "C" {
 				   gds_array_foreach_f foreach,
 				   const void * ctx);
 
+  // ----- _array_parallel_for_each ---------------------------------
+  /**
+   * Execute a callback function for each element of an array, in
+   * parallel (see pool_run()). The elements are split in ranges of
+   * consecutive elements.
+   *
+   * \param array   is the array.
+   * \param pool    is the pool of workers.
+   * \param foreach is the callback function.
+   * \param ctx     is the context pointer.
+   * \param reducer is the description of the partial results, passed
+   *   to \a foreach instead of \a ctx (can be NULL).
+   * \param options is a combination of options (POOL_OPTION_*).
+   * \retval 0 in case of success,
+   *   or the first (in the order of the elements) non-zero value
+   *   returned by \a foreach.
+   */
+  GDS_EXP_DECL int _array_parallel_for_each(array_t * array,
+					    gds_pool_t * pool,
+					    gds_array_foreach_f foreach,
+					    const void * ctx,
+					    const gds_pool_reducer_t * reducer,
+					    int options);
+
   // ----- _array_copy ----------------------------------------------
   GDS_EXP_DECL array_t * _array_copy(array_t * array);
 
@@ -292,7 +329,8 @@ extern "C" {
 #define GDS_ARRAY_TEMPLATE_TYPE(N,T)					\
   typedef struct N##_t {						\
     T * data;								\
-  } N##_t;
+  } N##_t;								\
+  typedef gds_array_cursor_t N##_cursor_t;
 
 #define GDS_ARRAY_TEMPLATE_OPS(N,T,OPT,FC,FD,FDC)			\
   static inline N##_t * N##_create(unsigned int size) {			\
@@ -330,6 +368,14 @@ extern "C" {
 				 void * ctx) {				\
     return _array_for_each((array_t *) array, foreach, ctx);		\
   }									\
+  static inline int							\
+  N##_parallel_for_each(N##_t * array, gds_pool_t * pool,		\
+			gds_array_foreach_f foreach, void * ctx,	\
+			const gds_pool_reducer_t * reducer,		\
+			int options) {					\
+    return _array_parallel_for_each((array_t *) array, pool, foreach,	\
+				    ctx, reducer, options);		\
+  }									\
   static inline gds_enum_t * N##_get_enum(N##_t * array) {		\
     return _array_get_enum((array_t *) array);				\
   }									\
@@ -355,6 +401,19 @@ extern "C" {
   }									\
   static inline void N##_add_array(N##_t * array, N##_t * add_array) {	\
     _array_add_array((array_t *) array, (array_t *) add_array);		\
+  }									\
+  static inline void N##_cursor_init(N##_cursor_t * cursor,		\
+				     N##_t * array) {			\
+    cursor->array= (array_t *) array;					\
+    cursor->index= 0;							\
+    cursor->length= _array_length((array_t *) array);			\
+  }									\
+  static inline int N##_cursor_next(N##_cursor_t * cursor,		\
+				    T * item_ref) {			\
+    if (cursor->index >= cursor->length)				\
+      return 0;								\
+    *item_ref= ((N##_t *) cursor->array)->data[cursor->index++];	\
+    return 1;								\
   }
 
 #define GDS_ARRAY_TEMPLATE(NAME,TYPE,OPT,FC,FD,FDC)			\
@@ -381,6 +440,33 @@ typedef struct ptr_array_t {
 #define ptr_array_set_fdestroy(A, F, FDC)	\
   _array_set_fdestroy((array_t *)A, F, FDC)
 
+typedef gds_array_cursor_t ptr_array_cursor_t;
+
+// -----[ ptr_array_cursor_init ]------------------------------------
+static inline void ptr_array_cursor_init(ptr_array_cursor_t * cursor,
+					 ptr_array_t * array)
+{
+  cursor->array= (array_t *) array;
+  cursor->index= 0;
+  cursor->length= _array_length((array_t *) array);
+}
+
+// -----[ ptr_array_cursor_next ]------------------------------------
+/**
+ * Get the next item of a cursor.
+ *
+ * \retval 1 if \a item_ref is set to the next item,
+ *   or 0 if the traversal is over.
+ */
+static inline int ptr_array_cursor_next(ptr_array_cursor_t * cursor,
+					void ** item_ref)
+{
+  if (cursor->index >= cursor->length)
+    return 0;
+  *item_ref= ((ptr_array_t *) cursor->array)->data[cursor->index++];
+  return 1;
+}
+
 #define ARRAY_DESTROY_TEMPLATE(P, T)			\
   inline static void P##_array_destroy(T ** array) {	\
     _array_destroy((array_t **) array); }
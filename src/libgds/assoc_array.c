@@ -6,113 +6,163 @@
 // $Id$
 // ==================================================================
 
+/**
+ * \file
+ * The items (key, value and hash of the key) are stored in a dense
+ * array, in the order of their insertion. An open-addressing table
+ * with linear probing maps the hash of a key to the index of its
+ * item. The table is at most half full and is doubled when needed:
+ * the cached hashes are used to fill the new table, without hashing
+ * the keys again. Comparing the cached hashes first avoids most
+ * string comparisons.
+ *
+ * The array of items sorted by key, used by the sorted enumerations,
+ * is only built when such an enumeration is requested, and kept
+ * until a new key is added.
+ */
+
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <libgds/assoc_array.h>
 #include <libgds/memory.h>
 #include <libgds/str_util.h>
 
+#define ASSOC_ARRAY_MIN_SLOTS 8
+
 typedef struct {
-  char * key;
-  void * value;
+  char     * key;
+  void     * value;
+  uint32_t   hash;
 } _assoc_item_t;
 
-// -----[ _assoc_item_create ]---------------------------------------
-static inline _assoc_item_t * _assoc_item_create(const char * key,
-						 const void * value)
-{
-  _assoc_item_t * item= (_assoc_item_t *) MALLOC(sizeof(_assoc_item_t));
-  item->key= str_create(key);
-  item->value= (void *) value;
-  return item;
-}
+struct gds_assoc_array_t {
+  _assoc_item_t          * items;
+  unsigned int             num_items;
+  unsigned int             capacity;
+  uint32_t               * slots;     /* item index + 1, 0 if empty */
+  uint32_t                 mask;      /* number of slots - 1 */
+  _assoc_item_t         ** sorted;
+  int                      sorted_valid;
+  assoc_array_destroy_f    destroy;
+};
 
-// -----[ _assoc_item_destroy ]--------------------------------------
-static inline void _assoc_item_destroy(_assoc_item_t ** item_ref,
-				       const assoc_array_destroy_f destroy)
+// -----[ _assoc_array_hash ]----------------------------------------
+/** FNV-1a hash of a string. */
+static inline uint32_t _assoc_array_hash(const char * key)
 {
-  if (*item_ref != NULL) {
-    str_destroy(&(*item_ref)->key);
-    if (destroy != NULL)
-      destroy((*item_ref)->value);
-    FREE(*item_ref);
-    *item_ref= NULL;
+  uint32_t hash= 2166136261U;
+
+  while (*key != '\0') {
+    hash^= (uint8_t) *key++;
+    hash*= 16777619U;
   }
+  return hash;
 }
 
-// -----[ _assoc_array_item_compare ]--------------------------------
+// -----[ _assoc_array_find ]----------------------------------------
 /**
- * Private helper function used to compare 2 keys.
+ * Return the slot of a key, or the empty slot where it would be
+ * inserted.
  */
-static int _assoc_array_item_compare(const void * item1,
-				     const void * item2,
-				     unsigned int elt_size)
+static inline uint32_t _assoc_array_find(gds_assoc_array_t * array,
+					 const char * key, uint32_t hash)
 {
-  _assoc_item_t * assoc_item1= *((_assoc_item_t **) item1);
-  _assoc_item_t * assoc_item2= *((_assoc_item_t **) item2);
+  uint32_t slot= hash & array->mask;
+  _assoc_item_t * item;
 
-  return strcmp(assoc_item1->key, assoc_item2->key);
+  while (array->slots[slot] != 0) {
+    item= &array->items[array->slots[slot]-1];
+    if ((item->hash == hash) && !strcmp(item->key, key))
+      break;
+    slot= (slot+1) & array->mask;
+  }
+  return slot;
 }
 
-// -----[ _assoc_array_item_destroy ]--------------------------------
-/**
- * Private helper function used to destroy each item.
- */
-static void _assoc_array_item_destroy(void * item,
-				      const void * ctx)
+// -----[ _assoc_array_resize ]--------------------------------------
+static void _assoc_array_resize(gds_assoc_array_t * array,
+				uint32_t num_slots)
 {
-  _assoc_item_destroy((_assoc_item_t **) item,
-		      (assoc_array_destroy_f) ctx);
+  unsigned int index;
+  uint32_t slot;
+
+  if (array->slots != NULL)
+    FREE(array->slots);
+  array->slots= (uint32_t *) MALLOC(num_slots*sizeof(uint32_t));
+  memset(array->slots, 0, num_slots*sizeof(uint32_t));
+  array->mask= num_slots-1;
+  for (index= 0; index < array->num_items; index++) {
+    slot= array->items[index].hash & array->mask;
+    while (array->slots[slot] != 0)
+      slot= (slot+1) & array->mask;
+    array->slots[slot]= index+1;
+  }
 }
 
 // -----[ assoc_array_create ]---------------------------------------
 gds_assoc_array_t * assoc_array_create(assoc_array_destroy_f destroy)
 {
-  return (gds_assoc_array_t *) ptr_array_create(ARRAY_OPTION_SORTED,
-						_assoc_array_item_compare,
-						_assoc_array_item_destroy,
-						destroy);
+  gds_assoc_array_t * array=
+    (gds_assoc_array_t *) MALLOC(sizeof(gds_assoc_array_t));
+  array->num_items= 0;
+  array->capacity= ASSOC_ARRAY_MIN_SLOTS/2;
+  array->items= (_assoc_item_t *)
+    MALLOC(array->capacity*sizeof(_assoc_item_t));
+  array->slots= NULL;
+  _assoc_array_resize(array, ASSOC_ARRAY_MIN_SLOTS);
+  array->sorted= NULL;
+  array->sorted_valid= 0;
+  array->destroy= destroy;
+  return array;
 }
 
 // -----[ assoc_array_destroy ]--------------------------------------
 void assoc_array_destroy(gds_assoc_array_t ** array_ref)
 {
-  ptr_array_destroy(array_ref);
+  gds_assoc_array_t * array= *array_ref;
+  unsigned int index;
+
+  if (array == NULL)
+    return;
+  for (index= 0; index < array->num_items; index++) {
+    str_destroy(&array->items[index].key);
+    if (array->destroy != NULL)
+      array->destroy(array->items[index].value);
+  }
+  FREE(array->items);
+  FREE(array->slots);
+  if (array->sorted != NULL)
+    FREE(array->sorted);
+  FREE(array);
+  *array_ref= NULL;
 }
 
 // -----[ assoc_array_length ]-------------------------------------
 unsigned int assoc_array_length(gds_assoc_array_t * array)
 {
-  return ptr_array_length(array);
+  return array->num_items;
 }
 
 // -----[ assoc_array_exists ]---------------------------------------
 int assoc_array_exists(gds_assoc_array_t * array, const char * key)
 {
-  _assoc_item_t tmp;
-  _assoc_item_t * tmp_ref= &tmp;
-  unsigned int index;
-
-  tmp.key= (char *) key;
-  if (!ptr_array_sorted_find_index(array, &tmp_ref, &index))
-    return 1;
-  return 0;
+  uint32_t slot= _assoc_array_find(array, key, _assoc_array_hash(key));
+  return (array->slots[slot] != 0)?1:0;
 }
 
 // -----[ assoc_array_get ]------------------------------------------
 void * assoc_array_get(gds_assoc_array_t * array, const char * key)
 {
-  _assoc_item_t tmp;
-  _assoc_item_t * tmp_ref= &tmp;
-  unsigned int index;
+  uint32_t slot= _assoc_array_find(array, key, _assoc_array_hash(key));
 
-  tmp.key= (char *) key;
-  if (!ptr_array_sorted_find_index(array, &tmp_ref, &index))
-    return ((_assoc_item_t *) array->data[index])->value;
-  return NULL;
+  if (array->slots[slot] == 0)
+    return NULL;
+  return array->items[array->slots[slot]-1].value;
 }
 
 // -----[ assoc_array_set ]------------------------------------------
@@ -124,10 +174,32 @@ void * assoc_array_get(gds_assoc_array_t * array, const char * key)
 int assoc_array_set(gds_assoc_array_t * array, const char * key,
 		    const void * value)
 {
-  _assoc_item_t * item= _assoc_item_create(key, value);
-  if (ptr_array_add(array, &item) < 0) {
-    return -1;
+  uint32_t hash= _assoc_array_hash(key);
+  uint32_t slot= _assoc_array_find(array, key, hash);
+  _assoc_item_t * item;
+
+  // Existing key: replace the value
+  if (array->slots[slot] != 0) {
+    item= &array->items[array->slots[slot]-1];
+    if ((array->destroy != NULL) && (item->value != value))
+      array->destroy(item->value);
+    item->value= (void *) value;
+    return 0;
   }
+
+  if (array->num_items >= array->capacity) {
+    array->capacity*= 2;
+    array->items= (_assoc_item_t *)
+      REALLOC(array->items, array->capacity*sizeof(_assoc_item_t));
+  }
+  item= &array->items[array->num_items];
+  item->key= str_create(key);
+  item->value= (void *) value;
+  item->hash= hash;
+  array->slots[slot]= ++array->num_items;
+  array->sorted_valid= 0;
+  if (2*array->num_items > array->mask+1)
+    _assoc_array_resize(array, 2*(array->mask+1));
   return 0;
 }
 
@@ -140,8 +212,8 @@ int assoc_array_for_each(gds_assoc_array_t * array,
   _assoc_item_t * item;
   int result;
 
-  for (index= 0; index < ptr_array_length(array); index++) {
-    item= (_assoc_item_t *) array->data[index];
+  for (index= 0; index < array->num_items; index++) {
+    item= &array->items[index];
     result= foreach(item->key, item->value, ctx);
     if (result)
       return result;
@@ -149,6 +221,31 @@ int assoc_array_for_each(gds_assoc_array_t * array,
   return 0;
 }
 
+// -----[ _assoc_array_sorted_cmp ]----------------------------------
+static int _assoc_array_sorted_cmp(const void * item1, const void * item2)
+{
+  return strcmp((*((_assoc_item_t * const *) item1))->key,
+		(*((_assoc_item_t * const *) item2))->key);
+}
+
+// -----[ _assoc_array_sort ]----------------------------------------
+static void _assoc_array_sort(gds_assoc_array_t * array)
+{
+  unsigned int index;
+
+  if (array->sorted_valid)
+    return;
+  if (array->sorted != NULL)
+    FREE(array->sorted);
+  array->sorted= (_assoc_item_t **)
+    MALLOC((array->num_items+1)*sizeof(_assoc_item_t *));
+  for (index= 0; index < array->num_items; index++)
+    array->sorted[index]= &array->items[index];
+  qsort(array->sorted, array->num_items, sizeof(_assoc_item_t *),
+	_assoc_array_sorted_cmp);
+  array->sorted_valid= 1;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -160,13 +257,14 @@ typedef struct {
   unsigned int         index;
   gds_assoc_array_t  * array;
   int                  key_or_value; // key=0 / value=1
+  int                  sorted;
 } _enum_ctx_t;
 
 // -----[ _enum_has_next ]-------------------------------------------
 static int _enum_has_next(void * ctx)
 {
   _enum_ctx_t * enum_ctx= (_enum_ctx_t *) ctx;
-  return (enum_ctx->index  < _array_length((array_t *) enum_ctx->array));
+  return (enum_ctx->index < enum_ctx->array->num_items);
 }
 
 // -----[ _enum_get_next ]-------------------------------------------
@@ -174,8 +272,11 @@ static void * _enum_get_next(void * ctx)
 {
   _enum_ctx_t * enum_ctx= (_enum_ctx_t *) ctx;
   _assoc_item_t * item;
-  
-  _array_get_at((array_t *) enum_ctx->array, enum_ctx->index, &item);
+
+  if (enum_ctx->sorted)
+    item= enum_ctx->array->sorted[enum_ctx->index];
+  else
+    item= &enum_ctx->array->items[enum_ctx->index];
   enum_ctx->index++;
   switch (enum_ctx->key_or_value) {
   case ASSOC_ARRAY_ENUM_KEYS:
@@ -187,6 +288,22 @@ static void * _enum_get_next(void * ctx)
   }
 }
 
+// -----[ _enum_get_next_n ]-----------------------------------------
+static unsigned int _enum_get_next_n(void * ctx, void ** items,
+				     unsigned int num)
+{
+  _enum_ctx_t * enum_ctx= (_enum_ctx_t *) ctx;
+  unsigned int index;
+
+  if (enum_ctx->index >= enum_ctx->array->num_items)
+    return 0;
+  if (num > enum_ctx->array->num_items-enum_ctx->index)
+    num= enum_ctx->array->num_items-enum_ctx->index;
+  for (index= 0; index < num; index++)
+    items[index]= _enum_get_next(ctx);
+  return num;
+}
+
 // -----[ _enum_destroy ]--------------------------------------------
 static void _enum_destroy(void * ctx)
 {
@@ -200,11 +317,48 @@ gds_enum_t * assoc_array_get_enum(gds_assoc_array_t * array,
 {
   _enum_ctx_t * ctx=
     (_enum_ctx_t *) MALLOC(sizeof(_enum_ctx_t));
+  gds_enum_t * enu;
   ctx->array= array;
   ctx->index= 0;
-  ctx->key_or_value= key_or_value;
-  return enum_create(ctx,
-		     _enum_has_next,
-		     _enum_get_next,
-		     _enum_destroy);
+  ctx->key_or_value= key_or_value & ~ASSOC_ARRAY_ENUM_SORTED;
+  ctx->sorted= (key_or_value & ASSOC_ARRAY_ENUM_SORTED)?1:0;
+  if (ctx->sorted)
+    _assoc_array_sort(array);
+  enu= enum_create(ctx,
+		   _enum_has_next,
+		   _enum_get_next,
+		   _enum_destroy);
+  enu->ops.get_next_n= _enum_get_next_n;
+  return enu;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// CURSOR
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ assoc_array_cursor_init ]----------------------------------
+void assoc_array_cursor_init(gds_assoc_array_cursor_t * cursor,
+			     gds_assoc_array_t * array)
+{
+  cursor->array= array;
+  cursor->index= 0;
+}
+
+// -----[ assoc_array_cursor_next ]----------------------------------
+int assoc_array_cursor_next(gds_assoc_array_cursor_t * cursor,
+			    const char ** key_ref, void ** value_ref)
+{
+  _assoc_item_t * item;
+
+  if (cursor->index >= cursor->array->num_items)
+    return 0;
+  item= &cursor->array->items[cursor->index++];
+  if (key_ref != NULL)
+    *key_ref= item->key;
+  if (value_ref != NULL)
+    *value_ref= item->value;
+  return 1;
 }
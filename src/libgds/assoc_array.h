@@ -11,13 +11,20 @@
  * Provide data structure and functions to manage an associative array,
  * i.e. an array mapping a string key to a data pointer.
  *
+ * The associative array is a hash table. assoc_array_for_each() and
+ * the enumerations traverse the keys in the order of their
+ * insertion. Enumerations in the order of the keys are obtained with
+ * the ASSOC_ARRAY_ENUM_SORTED option: the keys are then sorted when
+ * the enumeration is created, unless no key was added since the
+ * last sort.
+ *
  * Typical example:
  * \code
  * gds_enum_t * enu;
  * gds_assoc_array_t * array= assoc_array_create(NULL);
  * assoc_array_set(array, "foo", "bar");
  * assoc_array_set(array, "cat", "murphy");
- * enu= assoc_array_get_keys_enum(array);
+ * enu= assoc_array_get_sorted_keys_enum(array);
  * while (enum_has_next(enu)) {
  *   key= (char *) enum_get_next(enu);
  *   fprintf(stdout, "key:\"%s\" => value:\"%s\"\n",
@@ -32,10 +39,10 @@
 #ifndef __GDS_ASSOC_ARRAY_H__
 #define __GDS_ASSOC_ARRAY_H__
 
-#include <libgds/array.h>
 #include <libgds/enumerator.h>
+#include <libgds/types.h>
 
-typedef ptr_array_t gds_assoc_array_t;
+typedef struct gds_assoc_array_t gds_assoc_array_t;
 
 /** Callback used to traverse an associative array. */
 typedef int (*assoc_array_foreach_f)(const char * key, void * data,
@@ -43,6 +50,17 @@ typedef int (*assoc_array_foreach_f)(const char * key, void * data,
 /** Callback used to free associated data in an associative array. */
 typedef void (*assoc_array_destroy_f)(void * item);
 
+// -----[ gds_assoc_array_cursor_t ]---------------------------------
+/**
+ * Cursor over the (key, value) pairs of an associative array, in
+ * the order of insertion of the keys (see GDS_FOREACH). The fields
+ * are private.
+ */
+typedef struct {
+  gds_assoc_array_t * array;
+  unsigned int        index;
+} gds_assoc_array_cursor_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -120,7 +138,7 @@ extern "C" {
    * Traverse an associative array.
    *
    * Call the provided callback function \a foreach for each key in
-   * the associative array.
+   * the associative array, in the order of insertion of the keys.
    *
    * \param array   is the associative array.
    * \param foreach is the callback function.
@@ -143,23 +161,47 @@ extern "C" {
    *   values. If \a key_or_value is ASSOC_ARRAY_ENUM_KEYS, the
    *   enumeration will return all distinct keys. If \a key_or_value
    *   is ASSOC_ARRAY_ENUM_VALUES; the enumeration will return all
-   *   values.
+   *   values. If the ASSOC_ARRAY_ENUM_SORTED option is added, the
+   *   enumeration follows the order of the keys, otherwise the order
+   *   of their insertion.
    * \retval en enumeration.
    *
    * \attention
    * If ASSOC_ARRAY_ENUM_VALUES is used, note that the returned
    * values may be reported multiple times if the same value is
    * associated to multiple distinct keys.
+   *
+   * \attention
+   * The enumeration is invalidated when a key is added.
    */
   gds_enum_t * assoc_array_get_enum(gds_assoc_array_t * array,
 				    int key_or_value);
 
+  // -----[ assoc_array_cursor_init ]--------------------------------
+  void assoc_array_cursor_init(gds_assoc_array_cursor_t * cursor,
+			       gds_assoc_array_t * array);
+
+  // -----[ assoc_array_cursor_next ]--------------------------------
+  /**
+   * Get the next (key, value) pair of a cursor.
+   *
+   * \param cursor    is the cursor.
+   * \param key_ref   is set to the key (can be NULL).
+   * \param value_ref is set to the value (can be NULL).
+   * \retval 1 if a pair is returned,
+   *   or 0 if the traversal is over.
+   */
+  int assoc_array_cursor_next(gds_assoc_array_cursor_t * cursor,
+			      const char ** key_ref, void ** value_ref);
+
 #ifdef __cplusplus
 }
 #endif
 
 #define ASSOC_ARRAY_ENUM_KEYS   0
 #define ASSOC_ARRAY_ENUM_VALUES 1
+/** Option: enumerate in the order of the keys. */
+#define ASSOC_ARRAY_ENUM_SORTED 0x02
 
 /** Get an enumeration for the keys in an associative array.
  * \see assoc_array_get_enum */
@@ -171,4 +213,15 @@ extern "C" {
 #define assoc_array_get_values_enum(A) \
   assoc_array_get_enum(A, ASSOC_ARRAY_ENUM_VALUES)
 
+/** Get an enumeration for the keys in an associative array, in
+ * order. \see assoc_array_get_enum */
+#define assoc_array_get_sorted_keys_enum(A) \
+  assoc_array_get_enum(A, ASSOC_ARRAY_ENUM_KEYS | ASSOC_ARRAY_ENUM_SORTED)
+
+/** Get an enumeration for the values in an associative array, in
+ * the order of the keys. \see assoc_array_get_enum */
+#define assoc_array_get_sorted_values_enum(A) \
+  assoc_array_get_enum(A, ASSOC_ARRAY_ENUM_VALUES | \
+		       ASSOC_ARRAY_ENUM_SORTED)
+
 #endif /* __GDS_ASSOC_ARRAY_H__ */
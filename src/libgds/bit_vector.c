@@ -15,23 +15,207 @@
 #include <string.h>
 
 #include <libgds/bit_vector.h>
-#include <libgds/array.h>
 #include <libgds/memory.h>
 
+/**
+ * @file This data structure allows manipulation of user-defined length bit
+ * vector.
+ *
+ * Bits are stored in 64-bit words aligned on BIT_VECTOR_ALIGN bytes.
+ * Bit i is bit (i % 64) of word (i / 64). Bits beyond the size of the
+ * vector are always 0, so that whole words can be compared and
+ * counted.
+ *
+ * Operations on whole vectors (and/or/xor/andnot, popcount) are
+ * implemented by kernels that process 4 words at a time. On x86, a
+ * second set of kernels is compiled for AVX2 (and POPCNT) and
+ * selected at run-time if the processor supports it.
+ */
+
 struct gds_bit_vector_t {
-  unsigned int     size;
-  uint32_array_t * array;
+  unsigned int   size;
+  unsigned int   num_words;
+  uint64_t     * words;
+  void         * raw;
+  /* Rank/select index (see bit_vector_build_index) */
+  uint32_t     * ranks;
+  uint32_t     * samples;
+  unsigned int   num_samples;
+  int            index_valid;
 };
-#define BIT_VECTOR_SEGMENT_LEN 32
 
-/** 
- * @file This data structure allows manipulation of user-defined length bit
- * vector. 
+#define BIT_VECTOR_WORD_LEN 64
+#define BIT_VECTOR_ALIGN    32
+
+#define _WORD(I) ((I) / BIT_VECTOR_WORD_LEN)
+#define _MASK(I) (((uint64_t) 1) << ((I) % BIT_VECTOR_WORD_LEN))
+
+/////////////////////////////////////////////////////////////////////
+//
+// KERNELS
+//
+/////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  void     (*and)(uint64_t * dst, const uint64_t * src1,
+		  const uint64_t * src2, size_t num_words);
+  void     (*or)(uint64_t * dst, const uint64_t * src1,
+		 const uint64_t * src2, size_t num_words);
+  void     (*xor)(uint64_t * dst, const uint64_t * src1,
+		  const uint64_t * src2, size_t num_words);
+  void     (*andnot)(uint64_t * dst, const uint64_t * src1,
+		     const uint64_t * src2, size_t num_words);
+  uint64_t (*popcount)(const uint64_t * src, size_t num_words);
+  uint64_t (*and_count)(const uint64_t * src1, const uint64_t * src2,
+			size_t num_words);
+} _bit_vector_ops_t;
+
+#ifdef __GNUC__
+/* 4 x 64 bits. Lowered to 2 x SSE2 registers by default, to a single
+ * AVX2 register in functions compiled for AVX2. */
+typedef uint64_t _vec_t __attribute__ ((vector_size (32), aligned (8), may_alias));
+# define _VEC_WORDS 4
+# define _VEC_BINARY_OP(EXPR)					\
+  size_t index= 0;							\
+  _vec_t a, b;								\
+  for (; index + _VEC_WORDS <= num_words; index+= _VEC_WORDS) {	\
+    a= *(const _vec_t *) (src1+index);					\
+    b= *(const _vec_t *) (src2+index);					\
+    *(_vec_t *) (dst+index)= EXPR;					\
+  }									\
+  for (; index < num_words; index++) {					\
+    uint64_t a= src1[index], b= src2[index];				\
+    dst[index]= EXPR;							\
+  }
+#else
+# define _VEC_BINARY_OP(EXPR)					\
+  size_t index;								\
+  uint64_t a, b;							\
+  for (index= 0; index < num_words; index++) {				\
+    a= src1[index];							\
+    b= src2[index];							\
+    dst[index]= EXPR;							\
+  }
+#endif
+
+/**
+ * Define a set of kernels. SUFFIX distinguishes the sets and ATTR is
+ * the set of attributes of each function (target instruction set).
+ */
+#define _BIT_VECTOR_KERNELS(SUFFIX, ATTR)				\
+  ATTR static void _and_##SUFFIX(uint64_t * dst, const uint64_t * src1, \
+				 const uint64_t * src2, size_t num_words) \
+  { _VEC_BINARY_OP(a & b) }					\
+  ATTR static void _or_##SUFFIX(uint64_t * dst, const uint64_t * src1,	\
+				const uint64_t * src2, size_t num_words) \
+  { _VEC_BINARY_OP(a | b) }						\
+  ATTR static void _xor_##SUFFIX(uint64_t * dst, const uint64_t * src1, \
+				 const uint64_t * src2, size_t num_words) \
+  { _VEC_BINARY_OP(a ^ b) }					\
+  ATTR static void _andnot_##SUFFIX(uint64_t * dst,			\
+				    const uint64_t * src1,		\
+				    const uint64_t * src2,		\
+				    size_t num_words)			\
+  { _VEC_BINARY_OP(a & ~b) }					\
+  ATTR static uint64_t _popcount_##SUFFIX(const uint64_t * src,	\
+					  size_t num_words)		\
+  {									\
+    uint64_t c0= 0, c1= 0, c2= 0, c3= 0;				\
+    size_t index= 0;							\
+    for (; index + 4 <= num_words; index+= 4) {				\
+      c0+= __builtin_popcountll(src[index]);				\
+      c1+= __builtin_popcountll(src[index+1]);				\
+      c2+= __builtin_popcountll(src[index+2]);				\
+      c3+= __builtin_popcountll(src[index+3]);				\
+    }									\
+    for (; index < num_words; index++)					\
+      c0+= __builtin_popcountll(src[index]);				\
+    return c0 + c1 + c2 + c3;						\
+  }									\
+  ATTR static uint64_t _and_count_##SUFFIX(const uint64_t * src1,	\
+					   const uint64_t * src2,	\
+					   size_t num_words)		\
+  {									\
+    uint64_t c0= 0, c1= 0, c2= 0, c3= 0;				\
+    size_t index= 0;							\
+    for (; index + 4 <= num_words; index+= 4) {				\
+      c0+= __builtin_popcountll(src1[index] & src2[index]);		\
+      c1+= __builtin_popcountll(src1[index+1] & src2[index+1]);	\
+      c2+= __builtin_popcountll(src1[index+2] & src2[index+2]);	\
+      c3+= __builtin_popcountll(src1[index+3] & src2[index+3]);	\
+    }									\
+    for (; index < num_words; index++)					\
+      c0+= __builtin_popcountll(src1[index] & src2[index]);		\
+    return c0 + c1 + c2 + c3;						\
+  }									\
+  static const _bit_vector_ops_t _OPS_##SUFFIX= {			\
+    _and_##SUFFIX, _or_##SUFFIX, _xor_##SUFFIX, _andnot_##SUFFIX,	\
+    _popcount_##SUFFIX, _and_count_##SUFFIX				\
+  };
+
+_BIT_VECTOR_KERNELS(generic, )
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define HAVE_BIT_VECTOR_AVX2
+_BIT_VECTOR_KERNELS(avx2, __attribute__ ((target ("avx2,popcnt"))))
+#endif
+
+static const _bit_vector_ops_t * _ops= NULL;
+static int _use_simd= 1;
+
+// -----[ _bit_vector_ops ]------------------------------------------
+/**
+ * Select the kernels (done once).
+ */
+static inline const _bit_vector_ops_t * _bit_vector_ops()
+{
+  if (_ops != NULL)
+    return _ops;
+#ifdef HAVE_BIT_VECTOR_AVX2
+  __builtin_cpu_init();
+  if (_use_simd &&
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+    _ops= &_OPS_avx2;
+    return _ops;
+  }
+#endif
+  _ops= &_OPS_generic;
+  return _ops;
+}
+
+// -----[ bit_vector_use_simd ]--------------------------------------
+/**
+ * \brief Enable or disable the SIMD kernels.
+ *
+ * SIMD kernels are enabled by default, when the processor supports
+ * them. Disabling them is mainly useful for testing and
+ * benchmarking.
+ *
+ * @param enable 1 to enable the SIMD kernels, 0 to disable them.
+ *
+ * @return 1 if SIMD kernels are in use after the call, else 0.
  */
+int bit_vector_use_simd(int enable)
+{
+  _use_simd= enable;
+  _ops= NULL;
+#ifdef HAVE_BIT_VECTOR_AVX2
+  return (_bit_vector_ops() == &_OPS_avx2);
+#else
+  _bit_vector_ops();
+  return 0;
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// BIT VECTOR
+//
+/////////////////////////////////////////////////////////////////////
 
 // -----[ bit_vector_create ]----------------------------------------
 /**
- * \brief Creates a bit vector of size size.  
+ * \brief Creates a bit vector of size size.
  *
  * @param size the size of the bit vector
  *
@@ -40,21 +224,40 @@ struct gds_bit_vector_t {
 gds_bit_vector_t * bit_vector_create(unsigned int size)
 {
   gds_bit_vector_t * vector= MALLOC(sizeof(gds_bit_vector_t));
-  unsigned int index;
-  unsigned int num_segments;
-
-  num_segments= size / BIT_VECTOR_SEGMENT_LEN;
-  if (size % BIT_VECTOR_SEGMENT_LEN)
-    num_segments++;
+  size_t num_bytes;
 
   vector->size= size;
-  vector->array= uint32_array_create(0);
-  uint32_array_set_size(vector->array, num_segments);
-  for (index = 0; index < uint32_array_size(vector->array); index++)
-    vector->array->data[index]= 0;
+  vector->num_words= (unsigned int)
+    (((uint64_t) size + BIT_VECTOR_WORD_LEN - 1) / BIT_VECTOR_WORD_LEN);
+  num_bytes= (size_t) vector->num_words * sizeof(uint64_t);
+  vector->raw= MALLOC(num_bytes + BIT_VECTOR_ALIGN - 1);
+  vector->words= (uint64_t *)
+    (((size_t) vector->raw + BIT_VECTOR_ALIGN - 1) &
+     ~((size_t) BIT_VECTOR_ALIGN - 1));
+  memset(vector->words, 0, num_bytes);
+  vector->ranks= NULL;
+  vector->samples= NULL;
+  vector->num_samples= 0;
+  vector->index_valid= 0;
   return vector;
 }
 
+// -----[ bit_vector_copy ]------------------------------------------
+/**
+ * \brief Creates a copy of a bit vector.
+ *
+ * @param vector a bit vector
+ *
+ * @return a new bit vector with the same size and bits.
+ */
+gds_bit_vector_t * bit_vector_copy(gds_bit_vector_t * vector)
+{
+  gds_bit_vector_t * copy= bit_vector_create(vector->size);
+  memcpy(copy->words, vector->words,
+	 (size_t) vector->num_words * sizeof(uint64_t));
+  return copy;
+}
+
 // -----[ bit_vector_destroy ]---------------------------------------
 /**
  * \brief destroys the bit vector vector
@@ -65,14 +268,25 @@ gds_bit_vector_t * bit_vector_create(unsigned int size)
 void bit_vector_destroy(gds_bit_vector_t ** vector)
 {
   if (*vector) {
-    if ( (*vector)->array ) {
-      uint32_array_destroy( &(*vector)->array );
+    if ((*vector)->ranks != NULL) {
+      FREE( (*vector)->ranks );
+      FREE( (*vector)->samples );
     }
+    FREE( (*vector)->raw );
     FREE( (*vector) );
     *vector = NULL;
   }
 }
 
+// -----[ bit_vector_size ]------------------------------------------
+/**
+ * \brief Returns the size (number of bits) of a bit vector.
+ */
+unsigned int bit_vector_size(gds_bit_vector_t * vector)
+{
+  return vector->size;
+}
+
 // -----[ bit_vector_set ]-------------------------------------------
 /**
  * \brief set to 1 a specific bit of a bit vector.
@@ -85,23 +299,12 @@ void bit_vector_destroy(gds_bit_vector_t ** vector)
  */
 int8_t bit_vector_set(gds_bit_vector_t * vector, unsigned int index)
 {
-  unsigned int segment_index;
-  unsigned char bit_index;
-  uint32_t segment;
-
   if ((vector == NULL) ||
       (vector->size <= index))
     return -1;
-  
-  // Retrieve the segment which contains the bit to change
-  segment_index= index/BIT_VECTOR_SEGMENT_LEN;
-  segment= vector->array->data[segment_index];
-
-  // Change the value of the concerned bit
-  bit_index= index % BIT_VECTOR_SEGMENT_LEN;
-  segment|= (1 << (BIT_VECTOR_SEGMENT_LEN - bit_index - 1));
-  vector->array->data[segment_index]= segment;
 
+  vector->words[_WORD(index)]|= _MASK(index);
+  vector->index_valid= 0;
   return 0;
 }
 
@@ -117,26 +320,12 @@ int8_t bit_vector_set(gds_bit_vector_t * vector, unsigned int index)
  */
 int8_t bit_vector_clear(gds_bit_vector_t * vector, unsigned int index)
 {
-  unsigned int segment_index;
-  unsigned char bit_index;
-  uint32_t segment;
-  uint32_t bit;
-
-
   if ((vector == NULL) ||
       (vector->size <= index))
     return -1;
 
-  // Retrieve the segment which contains the bit to change
-  segment_index= index/BIT_VECTOR_SEGMENT_LEN;
-  segment= vector->array->data[segment_index];
-
-  // Change the value of the concerned bit
-  bit_index= index % BIT_VECTOR_SEGMENT_LEN;
-  bit= ((segment << bit_index) >> (BIT_VECTOR_SEGMENT_LEN-1));
-  segment^= (bit << (BIT_VECTOR_SEGMENT_LEN - bit_index - 1));
-  vector->array->data[segment_index]= segment;
-
+  vector->words[_WORD(index)]&= ~_MASK(index);
+  vector->index_valid= 0;
   return 0;
 }
 
@@ -152,34 +341,76 @@ int8_t bit_vector_clear(gds_bit_vector_t * vector, unsigned int index)
  */
 int8_t bit_vector_get(gds_bit_vector_t * vector, unsigned int index)
 {
-  unsigned int segment_index;
-  unsigned char bit_index;
-  uint32_t segment;
-    
   if ((vector == NULL) ||
       (vector->size <= index))
     return -1;
 
-  // Retrieve the segment which contains the bit to change
-  segment_index= index/BIT_VECTOR_SEGMENT_LEN;
-  segment= vector->array->data[segment_index];
+  return (vector->words[_WORD(index)] & _MASK(index)) != 0;
+}
 
-  // Change the value of the concerned bit
-  bit_index= index%BIT_VECTOR_SEGMENT_LEN;
-  return ((segment << bit_index) >> (BIT_VECTOR_SEGMENT_LEN-1));
+// -----[ bit_vector_prefetch ]--------------------------------------
+/**
+ * \brief Prefetches the memory that holds a specific bit.
+ *
+ * This is only a hint to the processor, used to overlap the memory
+ * latency of several accesses to a large bit vector.
+ *
+ * @param vector a bit vector
+ * @param index the number of the bit
+ * @param write 1 if the bit will be modified, 0 otherwise
+ */
+void bit_vector_prefetch(gds_bit_vector_t * vector, unsigned int index,
+			 int write)
+{
+  if (index >= vector->size)
+    return;
+#ifdef __GNUC__
+  if (write)
+    __builtin_prefetch(&vector->words[_WORD(index)], 1);
+  else
+    __builtin_prefetch(&vector->words[_WORD(index)], 0);
+#endif
 }
 
-static int _bit_vector_segment_to_string(char ** ppStr, uint32_t segment, uint32_t * uCptBits)
+// -----[ bit_vector_popcount ]--------------------------------------
+/**
+ * \brief Counts the number of bits set to 1 in a bit vector.
+ *
+ * @param vector a bit vector
+ *
+ * @return the number of bits set to 1 (0 if vector is NULL).
+ */
+unsigned int bit_vector_popcount(gds_bit_vector_t * vector)
 {
-  uint32_t uCpt;
+  if (vector == NULL)
+    return 0;
+  return (unsigned int) _bit_vector_ops()->popcount(vector->words,
+						    vector->num_words);
+}
 
-  for (uCpt = 0; uCpt < BIT_VECTOR_SEGMENT_LEN; uCpt++) {
-    (*ppStr)[uCpt] = (1 & (segment >> (BIT_VECTOR_SEGMENT_LEN - uCpt - 1))) + 48;
-    (*uCptBits)--;
-    if (!(*uCptBits))
-      break;
-  }
-  (*ppStr) += BIT_VECTOR_SEGMENT_LEN;
+// -----[ bit_vector_and_count ]-------------------------------------
+/**
+ * \brief Counts the number of bits set to 1 in both bit vectors.
+ *
+ * This is the cardinality of the intersection, computed without
+ * building the intersection.
+ *
+ * @param vector1 the first bit vector
+ * @param vector2 the second bit vector
+ * @param count the number of bits set in both vectors
+ *
+ * @return 0 on success, -1 if one of the bit vectors is NULL or if
+ * their sizes differ.
+ */
+int8_t bit_vector_and_count(gds_bit_vector_t * vector1,
+			    gds_bit_vector_t * vector2,
+			    unsigned int * count)
+{
+  if (!vector1 || !vector2 || (vector1->size != vector2->size))
+    return -1;
+  *count= (unsigned int) _bit_vector_ops()->and_count(vector1->words,
+						      vector2->words,
+						      vector1->num_words);
   return 0;
 }
 
@@ -193,27 +424,17 @@ static int _bit_vector_segment_to_string(char ** ppStr, uint32_t segment, uint32
  */
 char * bit_vector_to_string(gds_bit_vector_t * vector)
 {
-  char * pStr;
-  char * pStrToRet;
-  uint32_t uCptBits;
-  uint32_t segment;
+  char * str;
   unsigned int index;
 
   if (!vector)
     return NULL;
 
-  /* Memory allocation of the string */
-  pStr= MALLOC(vector->size + 1);
-  pStr[vector->size] = '\0';
-  pStrToRet= pStr;
-
-  /* Browse each segments for stringization */
-  uCptBits= vector->size;
-  for (index= 0; index < uint32_array_size(vector->array); index++) {
-    segment= vector->array->data[index];
-    _bit_vector_segment_to_string(&pStr, segment, &uCptBits);
-  }
-  return pStrToRet;
+  str= MALLOC(vector->size + 1);
+  for (index= 0; index < vector->size; index++)
+    str[index]= (vector->words[_WORD(index)] & _MASK(index))?'1':'0';
+  str[vector->size]= '\0';
+  return str;
 }
 
 // -----[ bit_vector_equals ]----------------------------------------
@@ -227,10 +448,6 @@ char * bit_vector_to_string(gds_bit_vector_t * vector)
 int8_t bit_vector_equals(gds_bit_vector_t * vector1,
 			 gds_bit_vector_t * vector2)
 {
-  uint32_t segment1;
-  uint32_t segment2;
-  unsigned int index;
-
   if (!vector1 && !vector2)
     return 1;
   if (!vector1 || !vector2)
@@ -240,14 +457,8 @@ int8_t bit_vector_equals(gds_bit_vector_t * vector1,
   if (vector1->size != vector2->size)
     return 0;
 
-  for (index= 0; index < uint32_array_size(vector1->array); index++) {
-    segment1= vector1->array->data[index];
-    segment2= vector2->array->data[index];
-
-    if (segment1 != segment2)
-      return 0;
-  }
-  return 1;
+  return !memcmp(vector1->words, vector2->words,
+		 (size_t) vector1->num_words * sizeof(uint64_t));
 }
 
 // -----[ bit_vector_cmp ]-------------------------------------------
@@ -259,6 +470,9 @@ int8_t bit_vector_equals(gds_bit_vector_t * vector1,
  *  - one bit vector is greater than another if its size is greater than the second whatever
  *  the value of both bit vectors.
  *
+ * Bit vectors of the same size are compared as strings of bits: the
+ * first bit that differs decides.
+ *
  * @param vector1 the first bit vector of the comparison
  * @param vector2 the second bit vector of the comparison
  *
@@ -268,8 +482,7 @@ int8_t bit_vector_equals(gds_bit_vector_t * vector1,
 int8_t bit_vector_cmp(gds_bit_vector_t * vector1,
 		      gds_bit_vector_t * vector2)
 {
-  uint32_t segment1;
-  uint32_t segment2;
+  uint64_t diff;
   unsigned int index;
 
   /* Tests the NULL value which is the smallest possible */
@@ -284,14 +497,10 @@ int8_t bit_vector_cmp(gds_bit_vector_t * vector1,
   else if (vector1->size > vector2->size)
     return -1;
 
-  for (index= 0; index < uint32_array_size(vector1->array); index++) {
-    segment1= vector1->array->data[index];
-    segment2= vector2->array->data[index];
-
-    if (segment1 < segment2)
-      return -1;
-    else if (segment1 > segment2)
-      return 1;
+  for (index= 0; index < vector1->num_words; index++) {
+    diff= vector1->words[index] ^ vector2->words[index];
+    if (diff != 0)
+      return (vector1->words[index] & (diff & -diff))?1:-1;
   }
   return 0;
 }
@@ -302,61 +511,45 @@ int8_t bit_vector_cmp(gds_bit_vector_t * vector1,
 typedef enum {
   BIT_VECTOR_AND = 1,
   BIT_VECTOR_OR,
-  BIT_VECTOR_XOR
+  BIT_VECTOR_XOR,
+  BIT_VECTOR_ANDNOT
 }EBitVectorOperation;
 
-typedef struct _BitVectorOperation {
-  EBitVectorOperation op;
-  gds_bit_vector_t * vector;
-  uint32_t uNumSegment;
-}gds_bit_vector_tOperation;
-
-static inline
-int _bit_vector_segment_binary_op(const EBitVectorOperation op, 
-				  uint32_t * segment1, 
-				  uint32_t segment2)
-{
-  if (!segment1)
-    return -1;
-
-  switch (op) {
-    case BIT_VECTOR_AND:
-      (*segment1) &= segment2;
-      break;
-    case BIT_VECTOR_OR:
-      (*segment1) |= segment2;
-      break;
-    case BIT_VECTOR_XOR:
-      (*segment1) ^= segment2;
-      break;
-    default:
-      return -1;
-  }
-  return 0;
-}
-
 static inline int _bit_vector_binary_op(const EBitVectorOperation op,
-					gds_bit_vector_t * vector1, 
+					gds_bit_vector_t * result,
+					gds_bit_vector_t * vector1,
 					gds_bit_vector_t * vector2)
 {
-  uint32_t segment1;
-  uint32_t segment2;
-  unsigned int index;
-
-  uint32_t uCptSegment = 0;
+  const _bit_vector_ops_t * ops;
 
-  if (vector1->size != vector2->size)
+  if (!result || !vector1 || !vector2)
     return -1;
 
-  for (index= 0; index < uint32_array_size(vector1->array); index++) {
-    segment1= vector1->array->data[index];
-    segment2= vector2->array->data[index];
-
-    if (_bit_vector_segment_binary_op(op, &segment1, segment2)) 
-      return -1;
+  if ((vector1->size != vector2->size) ||
+      (result->size != vector1->size))
+    return -1;
 
-    vector1->array->data[uCptSegment]= segment1;
-    uCptSegment++;
+  ops= _bit_vector_ops();
+  result->index_valid= 0;
+  switch (op) {
+  case BIT_VECTOR_AND:
+    ops->and(result->words, vector1->words, vector2->words,
+	     vector1->num_words);
+    break;
+  case BIT_VECTOR_OR:
+    ops->or(result->words, vector1->words, vector2->words,
+	    vector1->num_words);
+    break;
+  case BIT_VECTOR_XOR:
+    ops->xor(result->words, vector1->words, vector2->words,
+	     vector1->num_words);
+    break;
+  case BIT_VECTOR_ANDNOT:
+    ops->andnot(result->words, vector1->words, vector2->words,
+		vector1->num_words);
+    break;
+  default:
+    return -1;
   }
   return 0;
 }
@@ -376,10 +569,7 @@ static inline int _bit_vector_binary_op(const EBitVectorOperation op,
  */
 int8_t bit_vector_and(gds_bit_vector_t * vector1, gds_bit_vector_t * vector2)
 {
-  if (!vector1 || !vector2)
-    return -1;
-
-  return _bit_vector_binary_op(BIT_VECTOR_AND, vector1, vector2);
+  return _bit_vector_binary_op(BIT_VECTOR_AND, vector1, vector1, vector2);
 }
 
 /**
@@ -397,31 +587,79 @@ int8_t bit_vector_and(gds_bit_vector_t * vector1, gds_bit_vector_t * vector2)
  */
 int8_t bit_vector_or(gds_bit_vector_t * vector1, gds_bit_vector_t * vector2)
 {
-  if (!vector1 || !vector2)
-    return -1;
-
-  return _bit_vector_binary_op(BIT_VECTOR_OR, vector1, vector2);
+  return _bit_vector_binary_op(BIT_VECTOR_OR, vector1, vector1, vector2);
 }
 
 /**
- * @brief Performs an @em or operation on a bit vector.
+ * @brief Performs an @em xor operation on a bit vector.
  *
- * @param vector1 the vector affected by the \em or operation
- * @param vector2 the vector to and the first with.
+ * @param vector1 the vector affected by the \em xor operation
+ * @param vector2 the vector to xor the first with.
  *
- * @return 0 if vector1 has been ored with vector2, else if one of the
+ * @return 0 if vector1 has been xored with vector2, else if one of the
  * two bit vectors is NULL, -1 is returned. -1 is also returned if the length
  * of the bit vectors aren't the same.
  *
- * @warning It is \em not possible to perform the @em or operation on bit
+ * @warning It is \em not possible to perform the @em xor operation on bit
  * vectors of different lengths. (TODO?)
  */
 int8_t bit_vector_xor(gds_bit_vector_t * vector1, gds_bit_vector_t * vector2)
 {
-  if (!vector1 || !vector2)
-    return -1;
+  return _bit_vector_binary_op(BIT_VECTOR_XOR, vector1, vector1, vector2);
+}
 
-  return _bit_vector_binary_op(BIT_VECTOR_XOR, vector1, vector2);
+/**
+ * @brief Performs an @em and-not operation on a bit vector (clears in
+ * vector1 the bits that are set in vector2).
+ *
+ * @param vector1 the vector affected by the operation
+ * @param vector2 the bits to clear
+ *
+ * @return 0 on success, -1 if one of the bit vectors is NULL or if their
+ * lengths differ.
+ */
+int8_t bit_vector_andnot(gds_bit_vector_t * vector1,
+			 gds_bit_vector_t * vector2)
+{
+  return _bit_vector_binary_op(BIT_VECTOR_ANDNOT, vector1, vector1, vector2);
+}
+
+/**
+ * @brief Out-of-place variants of the binary operations.
+ *
+ * The result of the operation between vector1 and vector2 is stored
+ * in result, which must have the same length. The result may be one of
+ * the operands.
+ *
+ * @return 0 on success, -1 if one of the bit vectors is NULL or if their
+ * lengths differ.
+ */
+int8_t bit_vector_and_to(gds_bit_vector_t * result,
+			 gds_bit_vector_t * vector1,
+			 gds_bit_vector_t * vector2)
+{
+  return _bit_vector_binary_op(BIT_VECTOR_AND, result, vector1, vector2);
+}
+
+int8_t bit_vector_or_to(gds_bit_vector_t * result,
+			gds_bit_vector_t * vector1,
+			gds_bit_vector_t * vector2)
+{
+  return _bit_vector_binary_op(BIT_VECTOR_OR, result, vector1, vector2);
+}
+
+int8_t bit_vector_xor_to(gds_bit_vector_t * result,
+			 gds_bit_vector_t * vector1,
+			 gds_bit_vector_t * vector2)
+{
+  return _bit_vector_binary_op(BIT_VECTOR_XOR, result, vector1, vector2);
+}
+
+int8_t bit_vector_andnot_to(gds_bit_vector_t * result,
+			    gds_bit_vector_t * vector1,
+			    gds_bit_vector_t * vector2)
+{
+  return _bit_vector_binary_op(BIT_VECTOR_ANDNOT, result, vector1, vector2);
 }
 
 // -----[ bit_vector_from_string ]-----------------------------------
@@ -442,7 +680,7 @@ gds_bit_vector_t * bit_vector_from_string(const char * str)
   gds_bit_vector_t * vector;
   size_t len;
   unsigned int index;
- 
+
   len= strlen(str);
   vector= bit_vector_create(len);
 
@@ -452,3 +690,249 @@ gds_bit_vector_t * bit_vector_from_string(const char * str)
   return vector;
 }
 
+/////////////////////////////////////////////////////////////////////
+//
+// SET BITS, RANK AND SELECT
+//
+/////////////////////////////////////////////////////////////////////
+
+/* Number of bits covered by an entry of the rank directory. */
+#define BIT_VECTOR_RANK_BLOCK  512
+#define _RANK_BLOCK_WORDS (BIT_VECTOR_RANK_BLOCK / BIT_VECTOR_WORD_LEN)
+/* Number of set bits between two select samples. */
+#define BIT_VECTOR_SELECT_SAMPLE 4096
+
+// -----[ bit_vector_next_set_bit ]----------------------------------
+/**
+ * \brief Finds the first bit set to 1 at or after a given position.
+ *
+ * Typical use:
+ * \code
+ * for (i= bit_vector_next_set_bit(v, 0); i >= 0;
+ *      i= bit_vector_next_set_bit(v, i+1))
+ *   ...
+ * \endcode
+ *
+ * @param vector a bit vector
+ * @param index the position where the search starts
+ *
+ * @return the position of the bit, or -1 if there is no bit set at or
+ * after index.
+ */
+int64_t bit_vector_next_set_bit(gds_bit_vector_t * vector, uint64_t index)
+{
+  unsigned int word_index;
+  uint64_t word;
+
+  if ((vector == NULL) || (index >= vector->size))
+    return -1;
+
+  word_index= _WORD(index);
+  word= vector->words[word_index] & (~((uint64_t) 0) << (index % 64));
+  while (word == 0) {
+    if (++word_index >= vector->num_words)
+      return -1;
+    word= vector->words[word_index];
+  }
+  return (int64_t) word_index * BIT_VECTOR_WORD_LEN + __builtin_ctzll(word);
+}
+
+// -----[ bit_vector_for_each_set_bit ]------------------------------
+/**
+ * \brief Calls a function for each bit set to 1, in increasing order.
+ *
+ * @param vector a bit vector
+ * @param foreach the function, it receives the position of the bit
+ * @param ctx a context passed to the function
+ *
+ * @return 0 if all the set bits were visited. If the function returns a
+ * non-zero value, the iteration stops and this value is returned.
+ */
+int bit_vector_for_each_set_bit(gds_bit_vector_t * vector,
+				gds_bit_vector_foreach_f foreach,
+				void * ctx)
+{
+  unsigned int word_index;
+  uint64_t word;
+  int result;
+
+  for (word_index= 0; word_index < vector->num_words; word_index++) {
+    word= vector->words[word_index];
+    while (word != 0) {
+      result= foreach(word_index * BIT_VECTOR_WORD_LEN +
+		      __builtin_ctzll(word), ctx);
+      if (result != 0)
+	return result;
+      word&= word - 1;
+    }
+  }
+  return 0;
+}
+
+// -----[ _bit_vector_word_select ]----------------------------------
+/**
+ * Position of the k-th (from 0) bit set in a word. The word must
+ * have more than k bits set.
+ */
+static inline unsigned int _bit_vector_word_select(uint64_t word,
+						   unsigned int k)
+{
+  unsigned int shift= 0;
+  unsigned int count;
+
+  // Skip whole bytes first
+  while ((count= __builtin_popcountll(word & 0xff)) <= k) {
+    k-= count;
+    word>>= 8;
+    shift+= 8;
+  }
+  while (k-- > 0)
+    word&= word - 1;
+  return shift + __builtin_ctzll(word);
+}
+
+// -----[ bit_vector_build_index ]-----------------------------------
+/**
+ * \brief Builds the rank/select index of a bit vector.
+ *
+ * The index stores the number of bits set before each block of
+ * BIT_VECTOR_RANK_BLOCK bits (32 bits per block, i.e. 6.25% of the
+ * size of the vector) and the block of every BIT_VECTOR_SELECT_SAMPLE-th
+ * set bit. With the index, bit_vector_rank() is O(1) and
+ * bit_vector_select() is a short binary search between two samples.
+ *
+ * The index becomes invalid when the bit vector is modified. It is
+ * then ignored until it is built again.
+ *
+ * @param vector a bit vector
+ *
+ * @return 0 on success, -1 if vector is NULL.
+ */
+int8_t bit_vector_build_index(gds_bit_vector_t * vector)
+{
+  unsigned int num_blocks, block, word_index, num_samples;
+  uint32_t count= 0;
+
+  if (vector == NULL)
+    return -1;
+
+  num_blocks= (vector->num_words + _RANK_BLOCK_WORDS - 1) / _RANK_BLOCK_WORDS;
+  if (vector->ranks != NULL) {
+    FREE(vector->ranks);
+    FREE(vector->samples);
+  }
+  vector->ranks= (uint32_t *) MALLOC((num_blocks+1) * sizeof(uint32_t));
+  num_samples= 0;
+  for (block= 0; block < num_blocks; block++) {
+    vector->ranks[block]= count;
+    for (word_index= block * _RANK_BLOCK_WORDS;
+	 (word_index < (block+1) * _RANK_BLOCK_WORDS) &&
+	   (word_index < vector->num_words); word_index++)
+      count+= __builtin_popcountll(vector->words[word_index]);
+  }
+  vector->ranks[num_blocks]= count;
+
+  // Select samples: block that contains set bit j.SAMPLE
+  vector->num_samples= (count + BIT_VECTOR_SELECT_SAMPLE - 1) /
+    BIT_VECTOR_SELECT_SAMPLE;
+  vector->samples= (uint32_t *)
+    MALLOC((vector->num_samples+1) * sizeof(uint32_t));
+  for (block= 0; block < num_blocks; block++)
+    while ((num_samples < vector->num_samples) &&
+	   (vector->ranks[block+1] >
+	    (uint64_t) num_samples * BIT_VECTOR_SELECT_SAMPLE))
+      vector->samples[num_samples++]= block;
+  vector->samples[vector->num_samples]= (num_blocks > 0)?num_blocks-1:0;
+
+  vector->index_valid= 1;
+  return 0;
+}
+
+// -----[ bit_vector_rank ]------------------------------------------
+/**
+ * \brief Counts the bits set to 1 before a given position.
+ *
+ * The function is O(1) if the rank/select index is valid (see
+ * bit_vector_build_index), else linear in index.
+ *
+ * @param vector a bit vector
+ * @param index a position in [0, size]
+ *
+ * @return the number of bits set in [0, index[.
+ */
+unsigned int bit_vector_rank(gds_bit_vector_t * vector, uint64_t index)
+{
+  unsigned int word_index, last_word;
+  unsigned int count;
+
+  if (vector == NULL)
+    return 0;
+  if (index > vector->size)
+    index= vector->size;
+
+  last_word= _WORD(index);
+  if (vector->index_valid) {
+    word_index= (last_word / _RANK_BLOCK_WORDS) * _RANK_BLOCK_WORDS;
+    count= vector->ranks[last_word / _RANK_BLOCK_WORDS];
+  } else {
+    word_index= 0;
+    count= 0;
+  }
+  for (; word_index < last_word; word_index++)
+    count+= __builtin_popcountll(vector->words[word_index]);
+  if (index % BIT_VECTOR_WORD_LEN)
+    count+= __builtin_popcountll(vector->words[last_word] &
+				 (_MASK(index) - 1));
+  return count;
+}
+
+// -----[ bit_vector_select ]----------------------------------------
+/**
+ * \brief Finds the position of the k-th bit set to 1 (from 0).
+ *
+ * With a valid rank/select index, the block of the bit is found by
+ * binary search between two samples, then at most 8 words are
+ * scanned. Otherwise, the vector is scanned from the beginning.
+ *
+ * @param vector a bit vector
+ * @param k the rank of the bit (0 is the first set bit)
+ *
+ * @return the position of the bit, or -1 if less than k+1 bits are set.
+ */
+int64_t bit_vector_select(gds_bit_vector_t * vector, uint64_t k)
+{
+  unsigned int word_index= 0;
+  unsigned int count;
+  unsigned int low, high, middle;
+
+  if (vector == NULL)
+    return -1;
+
+  if (vector->index_valid) {
+    if ((vector->num_samples == 0) ||
+	(k >= vector->ranks[(vector->num_words + _RANK_BLOCK_WORDS - 1) /
+			    _RANK_BLOCK_WORDS]))
+      return -1;
+    // Last block whose rank is <= k
+    low= vector->samples[k / BIT_VECTOR_SELECT_SAMPLE];
+    high= vector->samples[k / BIT_VECTOR_SELECT_SAMPLE + 1];
+    while (low < high) {
+      middle= low + (high - low + 1) / 2;
+      if (vector->ranks[middle] <= k)
+	low= middle;
+      else
+	high= middle - 1;
+    }
+    k-= vector->ranks[low];
+    word_index= low * _RANK_BLOCK_WORDS;
+  }
+
+  for (; word_index < vector->num_words; word_index++) {
+    count= __builtin_popcountll(vector->words[word_index]);
+    if (k < count)
+      return (int64_t) word_index * BIT_VECTOR_WORD_LEN +
+	_bit_vector_word_select(vector->words[word_index], (unsigned int) k);
+    k-= count;
+  }
+  return -1;
+}
@@ -13,14 +13,21 @@
 
 typedef struct gds_bit_vector_t gds_bit_vector_t;
 
+/** Callback function used to traverse the set bits of a bit vector. */
+typedef int (*gds_bit_vector_foreach_f)(unsigned int index, void * ctx);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
   // -----[ bit_vector_create ]--------------------------------------
   gds_bit_vector_t * bit_vector_create(unsigned int size);
+  // -----[ bit_vector_copy ]----------------------------------------
+  gds_bit_vector_t * bit_vector_copy(gds_bit_vector_t * vector);
   // -----[ bit_vector_destroy ]-------------------------------------
   void bit_vector_destroy(gds_bit_vector_t ** vector);
+  // -----[ bit_vector_size ]----------------------------------------
+  unsigned int bit_vector_size(gds_bit_vector_t * vector);
   // -----[ bit_vector_set ]-----------------------------------------
   int8_t bit_vector_set(gds_bit_vector_t * vector,
 			unsigned int index);
@@ -30,6 +37,15 @@ extern "C" {
   // -----[ bit_vector_get ]-----------------------------------------
   int8_t bit_vector_get(gds_bit_vector_t * vector,
 			unsigned int index);
+  // -----[ bit_vector_prefetch ]------------------------------------
+  void bit_vector_prefetch(gds_bit_vector_t * vector, unsigned int index,
+			   int write);
+  // -----[ bit_vector_popcount ]------------------------------------
+  unsigned int bit_vector_popcount(gds_bit_vector_t * vector);
+  // -----[ bit_vector_and_count ]-----------------------------------
+  int8_t bit_vector_and_count(gds_bit_vector_t * vector1,
+			      gds_bit_vector_t * vector2,
+			      unsigned int * count);
   // -----[ bit_vector_to_string ]-----------------------------------
   char * bit_vector_to_string(gds_bit_vector_t * vector);
   // -----[ bit_vector_cmp ]-----------------------------------------
@@ -47,8 +63,42 @@ extern "C" {
   // -----[ bit_vector_xor ]-----------------------------------------
   int8_t bit_vector_xor(gds_bit_vector_t * vector1,
 			gds_bit_vector_t * vector2);
+  // -----[ bit_vector_andnot ]--------------------------------------
+  int8_t bit_vector_andnot(gds_bit_vector_t * vector1,
+			   gds_bit_vector_t * vector2);
+  // -----[ bit_vector_and_to ]--------------------------------------
+  int8_t bit_vector_and_to(gds_bit_vector_t * result,
+			   gds_bit_vector_t * vector1,
+			   gds_bit_vector_t * vector2);
+  // -----[ bit_vector_or_to ]---------------------------------------
+  int8_t bit_vector_or_to(gds_bit_vector_t * result,
+			  gds_bit_vector_t * vector1,
+			  gds_bit_vector_t * vector2);
+  // -----[ bit_vector_xor_to ]--------------------------------------
+  int8_t bit_vector_xor_to(gds_bit_vector_t * result,
+			   gds_bit_vector_t * vector1,
+			   gds_bit_vector_t * vector2);
+  // -----[ bit_vector_andnot_to ]-----------------------------------
+  int8_t bit_vector_andnot_to(gds_bit_vector_t * result,
+			      gds_bit_vector_t * vector1,
+			      gds_bit_vector_t * vector2);
   // -----[ bit_vector_from_string ]---------------------------------
   gds_bit_vector_t * bit_vector_from_string(const char * str);
+  // -----[ bit_vector_next_set_bit ]--------------------------------
+  int64_t bit_vector_next_set_bit(gds_bit_vector_t * vector,
+				  uint64_t index);
+  // -----[ bit_vector_for_each_set_bit ]----------------------------
+  int bit_vector_for_each_set_bit(gds_bit_vector_t * vector,
+				  gds_bit_vector_foreach_f foreach,
+				  void * ctx);
+  // -----[ bit_vector_build_index ]---------------------------------
+  int8_t bit_vector_build_index(gds_bit_vector_t * vector);
+  // -----[ bit_vector_rank ]----------------------------------------
+  unsigned int bit_vector_rank(gds_bit_vector_t * vector, uint64_t index);
+  // -----[ bit_vector_select ]--------------------------------------
+  int64_t bit_vector_select(gds_bit_vector_t * vector, uint64_t k);
+  // -----[ bit_vector_use_simd ]------------------------------------
+  int bit_vector_use_simd(int enable);
 
 #ifdef __cplusplus
 }
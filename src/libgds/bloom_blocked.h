@@ -0,0 +1,56 @@
+// ==================================================================
+// @(#)bloom_blocked.h
+//
+// Cache-line blocked Bloom filter.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __GDS_BLOOM_BLOCKED_H__
+#define __GDS_BLOOM_BLOCKED_H__
+
+#include <libgds/types.h>
+
+/** Size of a block in bytes (one cache line). */
+#define BLOOM_BLOCKED_BLOCK_SIZE 64
+/** Number of bits in a block. */
+#define BLOOM_BLOCKED_BLOCK_BITS (BLOOM_BLOCKED_BLOCK_SIZE*8)
+
+typedef struct gds_bloom_blocked_t gds_bloom_blocked_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ bloom_blocked_create ]-----------------------------------
+  gds_bloom_blocked_t * bloom_blocked_create(uint64_t num_bits,
+					     unsigned int num_hashes);
+  // -----[ bloom_blocked_destroy ]----------------------------------
+  void bloom_blocked_destroy(gds_bloom_blocked_t ** filter_ref);
+  // -----[ bloom_blocked_add ]--------------------------------------
+  int bloom_blocked_add(gds_bloom_blocked_t * filter,
+			const uint8_t * key, uint32_t key_len);
+  // -----[ bloom_blocked_is_member ]--------------------------------
+  int bloom_blocked_is_member(gds_bloom_blocked_t * filter,
+			      const uint8_t * key, uint32_t key_len);
+  // -----[ bloom_blocked_or ]---------------------------------------
+  int bloom_blocked_or(gds_bloom_blocked_t * filter1,
+		       gds_bloom_blocked_t * filter2);
+  // -----[ bloom_blocked_and ]--------------------------------------
+  int bloom_blocked_and(gds_bloom_blocked_t * filter1,
+			gds_bloom_blocked_t * filter2);
+  // -----[ bloom_blocked_equals ]-----------------------------------
+  int bloom_blocked_equals(gds_bloom_blocked_t * filter1,
+			   gds_bloom_blocked_t * filter2);
+  // -----[ bloom_blocked_clear ]------------------------------------
+  void bloom_blocked_clear(gds_bloom_blocked_t * filter);
+  // -----[ bloom_blocked_num_bits ]---------------------------------
+  uint64_t bloom_blocked_num_bits(gds_bloom_blocked_t * filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_BLOOM_BLOCKED_H__ */
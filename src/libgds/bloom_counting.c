@@ -0,0 +1,280 @@
+// ==================================================================
+// @(#)bloom_counting.c
+//
+// Counting Bloom filter (4-bit counters).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * A counting Bloom filter replaces each bit of a Bloom filter by a
+ * small counter, so that keys can be removed. Counters are 4 bits
+ * wide and packed two per byte. A counter that reaches
+ * BLOOM_COUNTING_MAX is saturated and sticks to that value: removing
+ * a key never decrements it, which could otherwise introduce false
+ * negatives.
+ *
+ * The indices of a key are those computed by bloom_hash with the
+ * same size and number of hashes, so that a counting filter can be
+ * converted to an SBloomFilter that answers the same queries.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/bit_vector.h>
+#include <libgds/bloom_counting.h>
+#include <libgds/bloom_hash.h>
+#include <libgds/memory.h>
+
+/* Number of indices that are computed on the stack. */
+#define _STACK_HASHES 32
+
+struct gds_bloom_counting_t {
+  uint8_t          * counters;
+  uint32_t           num_counters;
+  uint32_t           num_hashes;
+  uint32_t           num_saturated;
+  SBloomFilterHash * hash;
+};
+
+// -----[ _counter_get ]---------------------------------------------
+static inline unsigned int _counter_get(gds_bloom_counting_t * filter,
+					uint32_t index)
+{
+  return (filter->counters[index >> 1] >> ((index & 1) << 2)) & 0x0f;
+}
+
+// -----[ _counter_set ]---------------------------------------------
+static inline void _counter_set(gds_bloom_counting_t * filter,
+				uint32_t index, unsigned int value)
+{
+  unsigned int shift= (index & 1) << 2;
+  uint8_t * byte= &filter->counters[index >> 1];
+  *byte= (*byte & ~(0x0f << shift)) | (value << shift);
+}
+
+// -----[ bloom_counting_create ]------------------------------------
+/**
+ * \brief Create a counting Bloom filter.
+ *
+ * \param num_counters is the number of counters.
+ * \param num_hashes   is the number of counters used per key.
+ * \retval a new filter or NULL if one of the parameters is 0.
+ */
+gds_bloom_counting_t * bloom_counting_create(uint32_t num_counters,
+					     uint32_t num_hashes)
+{
+  gds_bloom_counting_t * filter;
+  SBloomFilterHash * hash;
+  size_t size;
+
+  hash= bloom_hash_create(num_counters, num_hashes);
+  if (hash == NULL)
+    return NULL;
+
+  size= ((size_t) num_counters + 1) / 2;
+  filter= (gds_bloom_counting_t *) MALLOC(sizeof(gds_bloom_counting_t));
+  filter->counters= (uint8_t *) MALLOC(size);
+  memset(filter->counters, 0, size);
+  filter->num_counters= num_counters;
+  filter->num_hashes= num_hashes;
+  filter->num_saturated= 0;
+  filter->hash= hash;
+  return filter;
+}
+
+// -----[ bloom_counting_destroy ]-----------------------------------
+void bloom_counting_destroy(gds_bloom_counting_t ** filter_ref)
+{
+  if (*filter_ref != NULL) {
+    bloom_hash_destroy(&(*filter_ref)->hash);
+    FREE((*filter_ref)->counters);
+    FREE(*filter_ref);
+    *filter_ref= NULL;
+  }
+}
+
+// -----[ _bloom_counting_indices ]----------------------------------
+/**
+ * Compute the indices of a key, in 'stack' if there is enough room,
+ * in a new buffer otherwise (to be freed by the caller).
+ */
+static inline uint32_t * _bloom_counting_indices(gds_bloom_counting_t * filter,
+						 const uint8_t * key,
+						 uint32_t key_len,
+						 uint32_t * stack)
+{
+  uint32_t * indices= stack;
+  if (filter->num_hashes > _STACK_HASHES)
+    indices= (uint32_t *) MALLOC(filter->num_hashes*sizeof(uint32_t));
+  bloom_hash_get_indices(filter->hash, key, key_len, indices);
+  return indices;
+}
+
+// -----[ _bloom_counting_test ]-------------------------------------
+static inline int _bloom_counting_test(gds_bloom_counting_t * filter,
+				       uint32_t * indices)
+{
+  uint32_t index;
+
+  for (index= 0; index < filter->num_hashes; index++)
+    if (_counter_get(filter, indices[index]) == 0)
+      return 0;
+  return 1;
+}
+
+// -----[ bloom_counting_add ]---------------------------------------
+/**
+ * \brief Add a key to the filter.
+ *
+ * \retval 0 in case of success, -1 if the filter or the key is NULL.
+ */
+int bloom_counting_add(gds_bloom_counting_t * filter,
+		       const uint8_t * key, uint32_t key_len)
+{
+  uint32_t stack[_STACK_HASHES];
+  uint32_t * indices;
+  uint32_t index;
+  unsigned int value;
+
+  if ((filter == NULL) || (key == NULL))
+    return -1;
+
+  indices= _bloom_counting_indices(filter, key, key_len, stack);
+  for (index= 0; index < filter->num_hashes; index++) {
+    value= _counter_get(filter, indices[index]);
+    if (value < BLOOM_COUNTING_MAX) {
+      _counter_set(filter, indices[index], ++value);
+      if (value == BLOOM_COUNTING_MAX)
+	filter->num_saturated++;
+    }
+  }
+  if (indices != stack)
+    FREE(indices);
+  return 0;
+}
+
+// -----[ bloom_counting_remove ]------------------------------------
+/**
+ * \brief Remove a key from the filter.
+ *
+ * The key must have been added before. A key that is not a member
+ * of the filter is not removed (otherwise, counters of other keys
+ * would be decremented). Saturated counters are left unchanged.
+ *
+ * \retval 0 in case of success, -1 if the key is not a member of the
+ *   filter (or if the filter or the key is NULL).
+ */
+int bloom_counting_remove(gds_bloom_counting_t * filter,
+			  const uint8_t * key, uint32_t key_len)
+{
+  uint32_t stack[_STACK_HASHES];
+  uint32_t * indices;
+  uint32_t index;
+  unsigned int value;
+  int result= -1;
+
+  if ((filter == NULL) || (key == NULL))
+    return -1;
+
+  indices= _bloom_counting_indices(filter, key, key_len, stack);
+  if (_bloom_counting_test(filter, indices)) {
+    for (index= 0; index < filter->num_hashes; index++) {
+      value= _counter_get(filter, indices[index]);
+      if ((value > 0) && (value < BLOOM_COUNTING_MAX))
+	_counter_set(filter, indices[index], value-1);
+    }
+    result= 0;
+  }
+  if (indices != stack)
+    FREE(indices);
+  return result;
+}
+
+// -----[ bloom_counting_is_member ]---------------------------------
+/**
+ * \brief Test if a key belongs to the filter.
+ *
+ * \retval 1 if the key (probably) belongs to the filter, 0 otherwise.
+ */
+int bloom_counting_is_member(gds_bloom_counting_t * filter,
+			     const uint8_t * key, uint32_t key_len)
+{
+  uint32_t stack[_STACK_HASHES];
+  uint32_t * indices;
+  int result;
+
+  if ((filter == NULL) || (key == NULL))
+    return 0;
+
+  indices= _bloom_counting_indices(filter, key, key_len, stack);
+  result= _bloom_counting_test(filter, indices);
+  if (indices != stack)
+    FREE(indices);
+  return result;
+}
+
+// -----[ bloom_counting_get_counter ]-------------------------------
+unsigned int bloom_counting_get_counter(gds_bloom_counting_t * filter,
+					uint32_t index)
+{
+  if (index >= filter->num_counters)
+    return 0;
+  return _counter_get(filter, index);
+}
+
+// -----[ bloom_counting_num_saturated ]-----------------------------
+/**
+ * \brief Return the number of saturated counters.
+ *
+ * A large number of saturated counters means that the filter is too
+ * small for the number of keys it holds: removals are no longer
+ * effective on these counters.
+ */
+uint32_t bloom_counting_num_saturated(gds_bloom_counting_t * filter)
+{
+  return filter->num_saturated;
+}
+
+// -----[ bloom_counting_to_bloom_filter ]---------------------------
+/**
+ * \brief Convert the filter to a plain (bit-based) Bloom filter.
+ *
+ * Each non-zero counter yields a set bit. The resulting filter has
+ * the same size and number of hashes and answers the same
+ * membership queries, with 4 times less memory.
+ *
+ * \attention
+ * The returned filter must be freed by the caller with
+ * bloom_filter_destroy().
+ */
+SBloomFilter * bloom_counting_to_bloom_filter(gds_bloom_counting_t * filter)
+{
+  SBloomFilter * bloom_filter;
+  gds_bit_vector_t * vector;
+  size_t index, num_bytes= ((size_t) filter->num_counters + 1) / 2;
+  uint8_t byte;
+
+  bloom_filter= bloom_filter_create(filter->num_counters,
+				    filter->num_hashes);
+  vector= bloom_filter_get_bit_vector(bloom_filter);
+  // Counters are scanned by pairs (the high nibble of the last byte
+  // is always 0 if the number of counters is odd)
+  for (index= 0; index < num_bytes; index++) {
+    byte= filter->counters[index];
+    if (byte == 0)
+      continue;
+    if (byte & 0x0f)
+      bit_vector_set(vector, index*2);
+    if (byte & 0xf0)
+      bit_vector_set(vector, index*2+1);
+  }
+  return bloom_filter;
+}
@@ -0,0 +1,53 @@
+// ==================================================================
+// @(#)bloom_counting.h
+//
+// Counting Bloom filter (4-bit counters).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __GDS_BLOOM_COUNTING_H__
+#define __GDS_BLOOM_COUNTING_H__
+
+#include <libgds/types.h>
+#include <libgds/bloom_filter.h>
+
+/** Maximum value of a counter. A counter that reaches this value is
+ * saturated: it is neither incremented nor decremented anymore. */
+#define BLOOM_COUNTING_MAX 15
+
+typedef struct gds_bloom_counting_t gds_bloom_counting_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ bloom_counting_create ]----------------------------------
+  gds_bloom_counting_t * bloom_counting_create(uint32_t num_counters,
+					       uint32_t num_hashes);
+  // -----[ bloom_counting_destroy ]---------------------------------
+  void bloom_counting_destroy(gds_bloom_counting_t ** filter_ref);
+  // -----[ bloom_counting_add ]-------------------------------------
+  int bloom_counting_add(gds_bloom_counting_t * filter,
+			 const uint8_t * key, uint32_t key_len);
+  // -----[ bloom_counting_remove ]----------------------------------
+  int bloom_counting_remove(gds_bloom_counting_t * filter,
+			    const uint8_t * key, uint32_t key_len);
+  // -----[ bloom_counting_is_member ]-------------------------------
+  int bloom_counting_is_member(gds_bloom_counting_t * filter,
+			       const uint8_t * key, uint32_t key_len);
+  // -----[ bloom_counting_get_counter ]-----------------------------
+  unsigned int bloom_counting_get_counter(gds_bloom_counting_t * filter,
+					  uint32_t index);
+  // -----[ bloom_counting_num_saturated ]---------------------------
+  uint32_t bloom_counting_num_saturated(gds_bloom_counting_t * filter);
+  // -----[ bloom_counting_to_bloom_filter ]-------------------------
+  SBloomFilter * bloom_counting_to_bloom_filter(gds_bloom_counting_t * filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_BLOOM_COUNTING_H__ */
@@ -9,6 +9,7 @@
 # include <config.h>
 #endif
 
+#include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -34,9 +35,10 @@ struct _BloomFilter {
  * @brief Creates a bloom filter
  *
  * @param uSize size of the bloom filter (size of the bit vector)
- * @param uNbrHash number of hash digest per key (with SHA1, 20 max.)
+ * @param uNbrHash number of hash digest per key
  *
- * @return a new allocated bloom filter.
+ * @return a new allocated bloom filter or NULL if uSize or uNbrHash
+ * is 0.
  *
  * @warning It is the responsibility of the caller to free the returned bloom
  * filter with bloom_filter_destroy().
@@ -59,6 +61,73 @@ SBloomFilter * bloom_filter_create(uint32_t uSize, uint32_t uNbrHash)
   return pBloomFilter;
 }
 
+/**
+ * @brief Computes the optimal size and number of hashes of a bloom filter
+ *
+ * For n keys and a target false positive rate p, the optimal number of
+ * bits is m = -n.ln(p)/ln(2)^2 and the optimal number of hashes is
+ * k = (m/n).ln(2).
+ *
+ * @param uNbrKeys expected number of keys
+ * @param dFPRate target false positive rate, in ]0,1[
+ * @param puSize the optimal size (number of bits)
+ * @param puNbrHash the optimal number of hashes per key
+ *
+ * @return 0 on success, -1 if the parameters are out of range or if the
+ * filter would be larger than 2^32 bits.
+ */
+int8_t bloom_filter_optimal_params(uint32_t uNbrKeys, double dFPRate,
+				  uint32_t * puSize, uint32_t * puNbrHash)
+{
+  double dSize, dNbrHash;
+
+  if ((uNbrKeys == 0) || !(dFPRate > 0) || !(dFPRate < 1))
+    return -1;
+
+  dSize= ceil(-(double) uNbrKeys * log(dFPRate) / (M_LN2 * M_LN2));
+  if (dSize > MAX_UINT32_T)
+    return -1;
+  dNbrHash= round(dSize / uNbrKeys * M_LN2);
+  if (dNbrHash < 1)
+    dNbrHash= 1;
+
+  *puSize= (uint32_t) dSize;
+  *puNbrHash= (uint32_t) dNbrHash;
+  return 0;
+}
+
+/**
+ * @brief Creates a bloom filter sized for a number of keys and a target
+ * false positive rate
+ *
+ * @param uNbrKeys expected number of keys
+ * @param dFPRate target false positive rate, in ]0,1[
+ *
+ * @return a new allocated bloom filter or NULL if the parameters are out
+ * of range (see bloom_filter_optimal_params()).
+ */
+SBloomFilter * bloom_filter_create_optimal(uint32_t uNbrKeys, double dFPRate)
+{
+  uint32_t uSize, uNbrHash;
+
+  if (bloom_filter_optimal_params(uNbrKeys, dFPRate, &uSize, &uNbrHash) < 0)
+    return NULL;
+  return bloom_filter_create(uSize, uNbrHash);
+}
+
+/**
+ * @brief Returns the bit vector of a bloom filter
+ *
+ * @param pBloomFilter the bloom filter
+ *
+ * @return the bit vector. Bit i is set if one of the keys added to the
+ * filter has i as one of its indices (see bloom_hash_get_indices()).
+ */
+gds_bit_vector_t * bloom_filter_get_bit_vector(SBloomFilter * pBloomFilter)
+{
+  return pBloomFilter->pBitVector;
+}
+
 /**
  * @brief Destroys a bloom filter
  *
@@ -78,28 +147,9 @@ void bloom_filter_destroy(SBloomFilter ** ppBloomFilter)
   }
 }
 
-static int _bloom_filter_add_for_each(const void * pItem, const void * pCtx)
-{
-  uint32_t uItem = *(uint32_t *)pItem;
-  SBloomFilter * pBloomFilter = (SBloomFilter *)pCtx;
-
-//  printf("%d|", uItem);
-  bit_vector_set(pBloomFilter->pBitVector, uItem);
-
-  return 0;
-}
-
-static uint32_array_t * _bloom_filter_hash_get(SBloomFilter * pBloomFilter, uint8_t * uKey, uint32_t uKeyLen)
-{
-  if (!uKey || !pBloomFilter)
-    return NULL;
-
-  /* We should reset the hash function as the digest is dependent of the
-   * previous input characters
-   */
-  bloom_hash_reset(pBloomFilter->pBloomHash);
-  return bloom_hash_get(pBloomFilter->pBloomHash, uKey, uKeyLen);
-}
+/* Number of indices that are computed on the stack. Filters with more
+ * hash functions fall back to a heap-allocated buffer. */
+#define BLOOM_FILTER_STACK_HASHES 32
 
 /**
  * @brief Adds a key to a bloom filter
@@ -114,16 +164,20 @@ static uint32_array_t * _bloom_filter_hash_get(SBloomFilter * pBloomFilter, uint
  */
 int8_t bloom_filter_add(SBloomFilter * pBloomFilter, uint8_t *uKey, uint32_t uKeyLen)
 {
-  uint32_array_t * puArray;
+  uint32_t auIndices[BLOOM_FILTER_STACK_HASHES];
+  uint32_t * puIndices= auIndices;
+  uint32_t uCpt;
 
   if (!uKey || !pBloomFilter)
     return -1;
 
-  puArray = _bloom_filter_hash_get(pBloomFilter, uKey, uKeyLen);
-//  printf("bloom filter> add %s:|", uKey);
-  uint32_array_for_each(puArray, _bloom_filter_add_for_each, pBloomFilter);
-// printf("\n");
-  uint32_array_destroy( &puArray );
+  if (pBloomFilter->uNbrHashFn > BLOOM_FILTER_STACK_HASHES)
+    puIndices= MALLOC(pBloomFilter->uNbrHashFn * sizeof(uint32_t));
+  bloom_hash_get_indices(pBloomFilter->pBloomHash, uKey, uKeyLen, puIndices);
+  for (uCpt= 0; uCpt < pBloomFilter->uNbrHashFn; uCpt++)
+    bit_vector_set(pBloomFilter->pBitVector, puIndices[uCpt]);
+  if (puIndices != auIndices)
+    FREE(puIndices);
   return 0;
 }
 
@@ -171,16 +225,6 @@ char * bloom_filter_to_string(SBloomFilter * pBloomFilter)
   return bit_vector_to_string(pBloomFilter->pBitVector);
 }
 
-static int _bloom_filter_is_member_for_each(const void * pItem,
-					    const void * pCtx)
-{
-  uint32_t uItem = *(uint32_t*) pItem;
-  SBloomFilter * pBloomFilter = (SBloomFilter*)pCtx;
-
-  //printf("%d|", uItem);
-  return !(bit_vector_get(pBloomFilter->pBitVector, uItem) == 1);
-}
-
 /**
  * @brief Tests the membership of a key in a bloom filter.
  *
@@ -192,19 +236,144 @@ static int _bloom_filter_is_member_for_each(const void * pItem,
  */
 uint8_t bloom_filter_is_member(SBloomFilter * pBloomFilter, uint8_t * uKey, uint32_t uKeyLen)
 {
-  uint32_array_t * puArray;
-  int iRet;
+  uint32_t auIndices[BLOOM_FILTER_STACK_HASHES];
+  uint32_t * puIndices= auIndices;
+  uint32_t uCpt;
+  uint8_t uRet= 1;
 
   if (!uKey || !pBloomFilter)
     return 0;
 
-  puArray = _bloom_filter_hash_get(pBloomFilter, uKey, uKeyLen);
- // printf("bloom filter> search %s:|", (char*)uKey);
-  iRet = uint32_array_for_each(puArray, _bloom_filter_is_member_for_each, pBloomFilter);
- // printf("\n");
-  uint32_array_destroy( &puArray );
+  if (pBloomFilter->uNbrHashFn > BLOOM_FILTER_STACK_HASHES)
+    puIndices= MALLOC(pBloomFilter->uNbrHashFn * sizeof(uint32_t));
+  bloom_hash_get_indices(pBloomFilter->pBloomHash, uKey, uKeyLen, puIndices);
+  for (uCpt= 0; uCpt < pBloomFilter->uNbrHashFn; uCpt++)
+    if (bit_vector_get(pBloomFilter->pBitVector, puIndices[uCpt]) != 1) {
+      uRet= 0;
+      break;
+    }
+  if (puIndices != auIndices)
+    FREE(puIndices);
+  return uRet;
+}
+
+/* Number of keys processed at once by the batch functions. */
+#define BLOOM_FILTER_BATCH_KEYS 16
+
+/**
+ * @brief Computes and prefetches the indices of a batch of keys
+ *
+ * @return the number of keys in the batch.
+ */
+static uint32_t _bloom_filter_batch_prepare(SBloomFilter * pBloomFilter,
+					    uint8_t ** puKeys,
+					    const uint32_t * puKeyLens,
+					    uint32_t uNbrKeys,
+					    uint32_t * puIndices,
+					    int iWrite)
+{
+  uint32_t uNbrIndices, uCpt;
+
+  if (uNbrKeys > BLOOM_FILTER_BATCH_KEYS)
+    uNbrKeys= BLOOM_FILTER_BATCH_KEYS;
+  for (uCpt= 0; uCpt < uNbrKeys; uCpt++)
+    bloom_hash_get_indices(pBloomFilter->pBloomHash, puKeys[uCpt],
+			   puKeyLens[uCpt],
+			   puIndices + uCpt * pBloomFilter->uNbrHashFn);
+  uNbrIndices= uNbrKeys * pBloomFilter->uNbrHashFn;
+  for (uCpt= 0; uCpt < uNbrIndices; uCpt++)
+    bit_vector_prefetch(pBloomFilter->pBitVector, puIndices[uCpt], iWrite);
+  return uNbrKeys;
+}
+
+/**
+ * @brief Adds an array of keys to a bloom filter
+ *
+ * The keys are processed by batches: the indices of all the keys of a
+ * batch are computed and their memory is prefetched before the bits are
+ * set, so that memory latency is overlapped between keys.
+ *
+ * @param pBloomFilter the bloom filter
+ * @param puKeys the keys
+ * @param puKeyLens the length of each key
+ * @param uNbrKeys the number of keys
+ *
+ * @return 0 if the keys are added to the bloom filter. If the keys or the
+ * bloom filter is NULL, -1 is returned.
+ */
+int8_t bloom_filter_add_batch(SBloomFilter * pBloomFilter, uint8_t ** puKeys,
+			      const uint32_t * puKeyLens, uint32_t uNbrKeys)
+{
+  uint32_t auIndices[BLOOM_FILTER_BATCH_KEYS * BLOOM_FILTER_STACK_HASHES];
+  uint32_t * puIndices= auIndices;
+  uint32_t uOffset, uBatch, uCpt;
+
+  if (!pBloomFilter || !puKeys || !puKeyLens)
+    return -1;
 
-  return (iRet == 0);
+  if (pBloomFilter->uNbrHashFn > BLOOM_FILTER_STACK_HASHES)
+    puIndices= MALLOC(BLOOM_FILTER_BATCH_KEYS * pBloomFilter->uNbrHashFn *
+		      sizeof(uint32_t));
+  for (uOffset= 0; uOffset < uNbrKeys; uOffset+= uBatch) {
+    uBatch= _bloom_filter_batch_prepare(pBloomFilter, puKeys + uOffset,
+					puKeyLens + uOffset,
+					uNbrKeys - uOffset, puIndices, 1);
+    for (uCpt= 0; uCpt < uBatch * pBloomFilter->uNbrHashFn; uCpt++)
+      bit_vector_set(pBloomFilter->pBitVector, puIndices[uCpt]);
+  }
+  if (puIndices != auIndices)
+    FREE(puIndices);
+  return 0;
+}
+
+/**
+ * @brief Tests the membership of an array of keys in a bloom filter
+ *
+ * The keys are processed by batches (see bloom_filter_add_batch()).
+ *
+ * @param pBloomFilter the bloom filter
+ * @param puKeys the keys
+ * @param puKeyLens the length of each key
+ * @param uNbrKeys the number of keys
+ * @param puResults for each key, 1 if the key belongs to the bloom
+ * filter, else 0.
+ *
+ * @return 0 on success. If one of the arrays or the bloom filter is NULL,
+ * -1 is returned.
+ */
+int8_t bloom_filter_is_member_batch(SBloomFilter * pBloomFilter,
+				    uint8_t ** puKeys,
+				    const uint32_t * puKeyLens,
+				    uint32_t uNbrKeys, uint8_t * puResults)
+{
+  uint32_t auIndices[BLOOM_FILTER_BATCH_KEYS * BLOOM_FILTER_STACK_HASHES];
+  uint32_t * puIndices= auIndices;
+  uint32_t * puKeyIndices;
+  uint32_t uOffset, uBatch, uKey, uCpt;
+
+  if (!pBloomFilter || !puKeys || !puKeyLens || !puResults)
+    return -1;
+
+  if (pBloomFilter->uNbrHashFn > BLOOM_FILTER_STACK_HASHES)
+    puIndices= MALLOC(BLOOM_FILTER_BATCH_KEYS * pBloomFilter->uNbrHashFn *
+		      sizeof(uint32_t));
+  for (uOffset= 0; uOffset < uNbrKeys; uOffset+= uBatch) {
+    uBatch= _bloom_filter_batch_prepare(pBloomFilter, puKeys + uOffset,
+					puKeyLens + uOffset,
+					uNbrKeys - uOffset, puIndices, 0);
+    for (uKey= 0; uKey < uBatch; uKey++) {
+      puKeyIndices= puIndices + uKey * pBloomFilter->uNbrHashFn;
+      puResults[uOffset + uKey]= 1;
+      for (uCpt= 0; uCpt < pBloomFilter->uNbrHashFn; uCpt++)
+	if (bit_vector_get(pBloomFilter->pBitVector, puKeyIndices[uCpt]) != 1) {
+	  puResults[uOffset + uKey]= 0;
+	  break;
+	}
+    }
+  }
+  if (puIndices != auIndices)
+    FREE(puIndices);
+  return 0;
 }
 
 /**
@@ -316,3 +485,36 @@ int8_t bloom_filter_equals(SBloomFilter * pBloomFilter1, SBloomFilter * pBloomFi
   return bit_vector_equals(pBloomFilter1->pBitVector, pBloomFilter2->pBitVector);
 }
 
+/**
+ * @brief Computes statistics on a bloom filter
+ *
+ * With X bits set out of m, the fill ratio is X/m and the current false
+ * positive rate is estimated as (X/m)^k. The number of distinct keys
+ * added to the filter is estimated as -(m/k).ln(1 - X/m) (Swamidass &
+ * Baldi). The estimated cardinality is infinite if all bits are set.
+ *
+ * @param pBloomFilter the bloom filter
+ * @param pStats the statistics
+ *
+ * @return 0 on success, -1 if one of the parameters is NULL.
+ */
+int8_t bloom_filter_stats(SBloomFilter * pBloomFilter, SBloomFilterStats * pStats)
+{
+  double dSize;
+
+  if (!pBloomFilter || !pStats)
+    return -1;
+
+  dSize= pBloomFilter->uSize;
+  pStats->uSize= pBloomFilter->uSize;
+  pStats->uNbrHashFn= pBloomFilter->uNbrHashFn;
+  pStats->uNbrBitsSet= bit_vector_popcount(pBloomFilter->pBitVector);
+  pStats->dFillRatio= pStats->uNbrBitsSet / dSize;
+  pStats->dFPRate= pow(pStats->dFillRatio, pBloomFilter->uNbrHashFn);
+  if (pStats->uNbrBitsSet < pBloomFilter->uSize)
+    pStats->dCardinality= -dSize / pBloomFilter->uNbrHashFn *
+      log(1 - pStats->dFillRatio);
+  else
+    pStats->dCardinality= HUGE_VAL;
+  return 0;
+}
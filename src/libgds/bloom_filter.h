@@ -10,18 +10,42 @@
 #define __BLOOM_FILTER_H__
 
 #include <libgds/types.h>
+#include <libgds/bit_vector.h>
 
 typedef struct _BloomFilter SBloomFilter;
 
+/**
+ * Statistics of a bloom filter (see bloom_filter_stats()).
+ */
+typedef struct _BloomFilterStats {
+  uint32_t uSize;          /* number of bits */
+  uint32_t uNbrHashFn;     /* number of hashes per key */
+  uint32_t uNbrBitsSet;    /* number of bits set to 1 */
+  double   dFillRatio;     /* uNbrBitsSet / uSize */
+  double   dFPRate;        /* estimated false positive rate */
+  double   dCardinality;   /* estimated number of distinct keys */
+} SBloomFilterStats;
+
 SBloomFilter * bloom_filter_create(uint32_t uSize, uint32_t uNbrHashFn);
+int8_t bloom_filter_optimal_params(uint32_t uNbrKeys, double dFPRate,
+				  uint32_t * puSize, uint32_t * puNbrHash);
+SBloomFilter * bloom_filter_create_optimal(uint32_t uNbrKeys, double dFPRate);
 void bloom_filter_destroy(SBloomFilter ** pBloomFilter);
+gds_bit_vector_t * bloom_filter_get_bit_vector(SBloomFilter * pBloomFilter);
 int8_t bloom_filter_add(SBloomFilter * pBloomFilter, uint8_t *uKey, uint32_t uKeyLen);
 int8_t bloom_filter_add_array(SBloomFilter * pBloomFilter, uint8_t **uKey);
 uint8_t bloom_filter_is_member(SBloomFilter * pBloomFilter, uint8_t * uKey, uint32_t uKeyLen);
+int8_t bloom_filter_add_batch(SBloomFilter * pBloomFilter, uint8_t ** puKeys,
+			      const uint32_t * puKeyLens, uint32_t uNbrKeys);
+int8_t bloom_filter_is_member_batch(SBloomFilter * pBloomFilter,
+				    uint8_t ** puKeys,
+				    const uint32_t * puKeyLens,
+				    uint32_t uNbrKeys, uint8_t * puResults);
 char * bloom_filter_to_string(SBloomFilter * pBloomFilter);
 int8_t bloom_filter_and(SBloomFilter * pBloomFilter1, SBloomFilter * pBloomFilter2);
 int8_t bloom_filter_or(SBloomFilter * pBloomFilter1, SBloomFilter * pBloomFilter2);
 int8_t bloom_filter_xor(SBloomFilter * pBloomFilter1, SBloomFilter * pBloomFilter2);
 int8_t bloom_filter_equals(SBloomFilter * pBloomFilter1, SBloomFilter * pBloomFilter2);
+int8_t bloom_filter_stats(SBloomFilter * pBloomFilter, SBloomFilterStats * pStats);
 
 #endif /* __BLOOM_FILTER_H__ */
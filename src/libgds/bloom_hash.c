@@ -10,38 +10,64 @@
 # include <config.h>
 #endif
 
+#include <string.h>
+
 #include <libgds/memory.h>
 #include <libgds/sha1.h>
 
 #include <libgds/bloom_hash.h>
 
 struct _BloomFilterHash {
-  uint8_t uNbrHash;
+  uint32_t uNbrHash;
   uint32_t uMaxValue;
-
-  SSHA1Context pSHA1Ctx;
-  /* TODO : if we want to have several digest functions (not only sha1 as now,
-   * md5, others?)
-   * we should put the length of the hash digest here too.
-  FHashDigest fDigest;*/
+  uint8_t  uMode;
 };
 
 #define SHA1_HASH_LENGTH 20
 
 /**
+ * @brief Creates a hash generator for a bloom filter
+ *
+ * The generator uses the default (double hashing) mode.
+ *
+ * @param uMaxValue the indices are in [0, uMaxValue)
+ * @param uNbrHash the number of indices generated per key
+ *
+ * @return a new hash generator or NULL if one of the parameters is 0.
+ */
+SBloomFilterHash * bloom_hash_create(uint32_t uMaxValue, uint32_t uNbrHash)
+{
+  return bloom_hash_create_mode(uMaxValue, uNbrHash, BLOOM_HASH_DOUBLE);
+}
+
+/**
+ * @brief Creates a hash generator with a specific digest mode
  *
+ * @param uMaxValue the indices are in [0, uMaxValue)
+ * @param uNbrHash the number of indices generated per key
+ * @param uMode BLOOM_HASH_DOUBLE or BLOOM_HASH_SHA1
+ *
+ * @return a new hash generator or NULL if the parameters are not
+ * supported (BLOOM_HASH_SHA1 supports at most 20 hashes).
  */
-SBloomFilterHash * bloom_hash_create(uint32_t uMaxValue, uint8_t uNbrHash)
+SBloomFilterHash * bloom_hash_create_mode(uint32_t uMaxValue,
+					  uint32_t uNbrHash,
+					  uint8_t uMode)
 {
   SBloomFilterHash * pBloomHash;
 
-  if (uNbrHash > SHA1_HASH_LENGTH)
+  if ((uMaxValue == 0) || (uNbrHash == 0))
+    return NULL;
+  if (uMode == BLOOM_HASH_SHA1) {
+    if (uNbrHash > SHA1_HASH_LENGTH)
+      return NULL;
+  } else if (uMode != BLOOM_HASH_DOUBLE)
     return NULL;
- 
+
   pBloomHash = MALLOC(sizeof(SBloomFilterHash));
   pBloomHash->uMaxValue = uMaxValue;
   pBloomHash->uNbrHash = uNbrHash;
-  bloom_hash_reset(pBloomHash);
+  pBloomHash->uMode = uMode;
 
   return pBloomHash;
 }
@@ -58,68 +84,230 @@ void bloom_hash_destroy(SBloomFilterHash ** pBloomHash)
 }
 
 /**
+ * @brief Kept for compatibility.
  *
+ * The generator is stateless: each key is hashed independently of
+ * the previous ones, there is nothing to reset anymore.
  */
 void bloom_hash_reset(SBloomFilterHash * pBloomHash)
 {
-  if (!pBloomHash)
-    return;
+}
 
-  sha1_starts(&pBloomHash->pSHA1Ctx);
+/**
+ * @brief Returns the number of indices generated per key.
+ */
+uint32_t bloom_hash_get_nbr(SBloomFilterHash * pBloomHash)
+{
+  return pBloomHash->uNbrHash;
 }
 
+/////////////////////////////////////////////////////////////////////
+//
+// 128-BIT HASH (MurmurHash3, x64 variant)
+//
+/////////////////////////////////////////////////////////////////////
+
+#define _ROTL64(X,R) (((X) << (R)) | ((X) >> (64 - (R))))
+
+// -----[ _fmix64 ]--------------------------------------------------
+static inline uint64_t _fmix64(uint64_t k)
+{
+  k^= k >> 33;
+  k*= 0xff51afd7ed558ccdULL;
+  k^= k >> 33;
+  k*= 0xc4ceb9fe1a85ec53ULL;
+  k^= k >> 33;
+  return k;
+}
+
+// -----[ _load64 ]--------------------------------------------------
+static inline uint64_t _load64(const uint8_t * p)
+{
+  uint64_t k;
+  memcpy(&k, p, sizeof(k));
+  return k;
+}
+
+// -----[ bloom_hash_128 ]-------------------------------------------
 /**
+ * \brief Computes a 128-bit non-cryptographic hash of a key.
  *
+ * The function is MurmurHash3 (x64, 128-bit variant). The digest
+ * depends on the byte order of the host, it should therefore not be
+ * stored or exchanged between hosts.
+ *
+ * \param pKey     is the key.
+ * \param uLen     is the key length (in bytes).
+ * \param uSeed    is the seed.
+ * \param auDigest is the resulting digest.
  */
-static uint32_t _byte_array_to_int(uint8_t uArray[], uint8_t uLen) 
+void bloom_hash_128(const uint8_t * pKey, uint32_t uLen,
+		    uint32_t uSeed, uint64_t auDigest[2])
+{
+  const uint64_t c1= 0x87c37b91114253d5ULL;
+  const uint64_t c2= 0x4cf5ad432745937fULL;
+  const uint32_t uNbrBlocks= uLen / 16;
+  const uint8_t * pTail= pKey + uNbrBlocks * 16;
+  uint64_t h1= uSeed;
+  uint64_t h2= uSeed;
+  uint64_t k1, k2;
+  uint32_t uIndex;
+
+  for (uIndex= 0; uIndex < uNbrBlocks; uIndex++) {
+    k1= _load64(pKey + uIndex * 16);
+    k2= _load64(pKey + uIndex * 16 + 8);
+
+    k1*= c1; k1= _ROTL64(k1, 31); k1*= c2; h1^= k1;
+    h1= _ROTL64(h1, 27); h1+= h2; h1= h1*5+0x52dce729;
+    k2*= c2; k2= _ROTL64(k2, 33); k2*= c1; h2^= k2;
+    h2= _ROTL64(h2, 31); h2+= h1; h2= h2*5+0x38495ab5;
+  }
+
+  k1= 0;
+  k2= 0;
+  switch (uLen & 15) {
+  case 15: k2^= ((uint64_t) pTail[14]) << 48;
+  case 14: k2^= ((uint64_t) pTail[13]) << 40;
+  case 13: k2^= ((uint64_t) pTail[12]) << 32;
+  case 12: k2^= ((uint64_t) pTail[11]) << 24;
+  case 11: k2^= ((uint64_t) pTail[10]) << 16;
+  case 10: k2^= ((uint64_t) pTail[9]) << 8;
+  case  9: k2^= ((uint64_t) pTail[8]);
+    k2*= c2; k2= _ROTL64(k2, 33); k2*= c1; h2^= k2;
+  case  8: k1^= ((uint64_t) pTail[7]) << 56;
+  case  7: k1^= ((uint64_t) pTail[6]) << 48;
+  case  6: k1^= ((uint64_t) pTail[5]) << 40;
+  case  5: k1^= ((uint64_t) pTail[4]) << 32;
+  case  4: k1^= ((uint64_t) pTail[3]) << 24;
+  case  3: k1^= ((uint64_t) pTail[2]) << 16;
+  case  2: k1^= ((uint64_t) pTail[1]) << 8;
+  case  1: k1^= ((uint64_t) pTail[0]);
+    k1*= c1; k1= _ROTL64(k1, 31); k1*= c2; h1^= k1;
+  }
+
+  h1^= uLen;
+  h2^= uLen;
+  h1+= h2;
+  h2+= h1;
+  h1= _fmix64(h1);
+  h2= _fmix64(h2);
+  h1+= h2;
+  h2+= h1;
+
+  auDigest[0]= h1;
+  auDigest[1]= h2;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// INDICES
+//
+/////////////////////////////////////////////////////////////////////
+
+/**
+ *
+ */
+static uint32_t _byte_array_to_int(const uint8_t uArray[], uint8_t uLen)
 {
   uint32_t val = 0;
   uint8_t uCpt;
 
-  if (!uArray)
-    return -1;
-
   for (uCpt = 0; uCpt < uLen; uCpt++) {
     val |= (uArray[uCpt] & 0xff) << ((uLen - 1 - uCpt) * 8);
   }
   return val;
 }
 
+// -----[ _bloom_hash_sha1 ]-----------------------------------------
 /**
- *
+ * Legacy mode: the SHA-1 digest is sliced into uNbrHash integers.
  */
-static uint32_array_t * _bloom_hash_get_int_array(SBloomFilterHash * pBloomHash, uint8_t shaSum[])
+static void _bloom_hash_sha1(SBloomFilterHash * pBloomHash,
+			     const uint8_t * pKey, uint32_t uLen,
+			     uint32_t * puIndices)
 {
-  uint32_array_t * uArray;
+  SSHA1Context tCtx;
+  uint8_t shaSum[SHA1_HASH_LENGTH];
   uint32_t uNbrBytePerInt;
   uint32_t uOffset = 0;
   uint32_t uCpt;
-  uint32_t result;
 
-  if (!pBloomHash)
-    return NULL;
-
-  uArray = uint32_array_create(0);
-  uint32_array_set_size(uArray, pBloomHash->uNbrHash);
+  sha1_starts(&tCtx);
+  sha1_update(&tCtx, pKey, uLen);
+  sha1_finish(&tCtx, shaSum);
 
   uNbrBytePerInt= SHA1_HASH_LENGTH / pBloomHash->uNbrHash;
   for (uCpt = 0; uCpt < pBloomHash->uNbrHash; uCpt++) {
-    result = _byte_array_to_int(shaSum+uOffset, uNbrBytePerInt) % pBloomHash->uMaxValue;
-    uArray->data[uCpt]= result;
+    puIndices[uCpt]= _byte_array_to_int(shaSum+uOffset, uNbrBytePerInt) %
+      pBloomHash->uMaxValue;
     uOffset += uNbrBytePerInt;
   }
-  return uArray;
 }
 
+// -----[ bloom_hash_get_indices ]-----------------------------------
 /**
+ * \brief Computes the indices of a key.
+ *
+ * In the default mode, the indices are obtained by double hashing
+ * (Kirsch & Mitzenmacher): g_i = h1 + i.h2, where h1 and h2 are the
+ * two halves of bloom_hash_128(). Each g_i is mapped to
+ * [0, uMaxValue) with a multiply-shift instead of a modulo.
+ *
+ * The function does not allocate memory.
  *
+ * \param pBloomHash is the hash generator.
+ * \param pKey       is the key.
+ * \param uLen       is the key length (in bytes).
+ * \param puIndices  is a caller-provided buffer that must hold
+ *   bloom_hash_get_nbr() values.
+ * \retval 0 in case of success, -1 otherwise.
  */
-uint32_array_t * bloom_hash_get(SBloomFilterHash * pBloomHash, uint8_t * pKey, uint32_t uLen)
+int bloom_hash_get_indices(SBloomFilterHash * pBloomHash,
+			   const uint8_t * pKey, uint32_t uLen,
+			   uint32_t * puIndices)
 {
-  uint8_t shaSum[SHA1_HASH_LENGTH];
-  sha1_update(&pBloomHash->pSHA1Ctx, pKey, uLen);
-  sha1_finish(&pBloomHash->pSHA1Ctx, shaSum);
+  uint64_t auDigest[2];
+  uint64_t uHash, uStep;
+  uint32_t uIndex;
+
+  if (!pBloomHash || !puIndices || (!pKey && (uLen > 0)))
+    return -1;
+
+  if (pBloomHash->uMode == BLOOM_HASH_SHA1) {
+    _bloom_hash_sha1(pBloomHash, pKey, uLen, puIndices);
+    return 0;
+  }
 
-  return _bloom_hash_get_int_array(pBloomHash, shaSum);
+  bloom_hash_128(pKey, uLen, 0, auDigest);
+  uHash= auDigest[0];
+  // An odd step guarantees distinct g_i modulo 2^64
+  uStep= auDigest[1] | 1;
+  for (uIndex= 0; uIndex < pBloomHash->uNbrHash; uIndex++) {
+    puIndices[uIndex]= (uint32_t) (((uHash >> 32) *
+				    (uint64_t) pBloomHash->uMaxValue) >> 32);
+    uHash+= uStep;
+  }
+  return 0;
 }
 
+// -----[ bloom_hash_get ]-------------------------------------------
+/**
+ * \brief Computes the indices of a key into a new array.
+ *
+ * \attention
+ * The returned array must be freed by the caller. Prefer
+ * bloom_hash_get_indices() which does not allocate memory.
+ */
+uint32_array_t * bloom_hash_get(SBloomFilterHash * pBloomHash,
+				uint8_t * pKey, uint32_t uLen)
+{
+  uint32_array_t * uArray;
+
+  if (!pBloomHash)
+    return NULL;
+
+  uArray = uint32_array_create(0);
+  uint32_array_set_size(uArray, pBloomHash->uNbrHash);
+  bloom_hash_get_indices(pBloomHash, pKey, uLen, uArray->data);
+  return uArray;
+}
@@ -14,16 +14,53 @@
 
 typedef struct _BloomFilterHash SBloomFilterHash;
 
+/**
+ * Available digest modes.
+ *
+ * - BLOOM_HASH_DOUBLE (default) derives the indices from a single
+ *   128-bit non-cryptographic hash using double hashing
+ *   (g_i = h1 + i.h2). Any number of hash functions is supported.
+ * - BLOOM_HASH_SHA1 slices a SHA-1 digest into uNbrHash integers
+ *   (20 hashes max.). Only useful if the indices need to be
+ *   compatible with filters built by previous versions.
+ */
+#define BLOOM_HASH_DOUBLE 0
+#define BLOOM_HASH_SHA1   1
+
+#define BLOOM_HASH_SHA1_MAX 20
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // ----- bloom_hash_create -------------------------------------------
-SBloomFilterHash * bloom_hash_create(uint32_t uMaxValue, 
-				      uint8_t uNbrHash);
+SBloomFilterHash * bloom_hash_create(uint32_t uMaxValue,
+				     uint32_t uNbrHash);
+// ----- bloom_hash_create_mode --------------------------------------
+SBloomFilterHash * bloom_hash_create_mode(uint32_t uMaxValue,
+					  uint32_t uNbrHash,
+					  uint8_t uMode);
 // ----- bloom_hash_destroy ------------------------------------------
 void bloom_hash_destroy(SBloomFilterHash ** pBloomHash);
 // ----- bloom_hash_reset --------------------------------------------
 void bloom_hash_reset(SBloomFilterHash * pBloomHash);
+// ----- bloom_hash_get_nbr ------------------------------------------
+uint32_t bloom_hash_get_nbr(SBloomFilterHash * pBloomHash);
+// ----- bloom_hash_get_indices --------------------------------------
+int bloom_hash_get_indices(SBloomFilterHash * pBloomHash,
+			   const uint8_t * pKey,
+			   uint32_t uLen,
+			   uint32_t * puIndices);
 // ----- bloom_hash_get ----------------------------------------------
-uint32_array_t * bloom_hash_get(SBloomFilterHash * pBloomHash, 
-				uint8_t * pKey, 
+uint32_array_t * bloom_hash_get(SBloomFilterHash * pBloomHash,
+				uint8_t * pKey,
 				uint32_t uLen);
+// ----- bloom_hash_128 ----------------------------------------------
+void bloom_hash_128(const uint8_t * pKey, uint32_t uLen,
+		    uint32_t uSeed, uint64_t auDigest[2]);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* __BLOOM_HASH_H__ */
@@ -0,0 +1,226 @@
+// ==================================================================
+// @(#)bloom_scalable.c
+//
+// Scalable Bloom filter.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * A scalable Bloom filter (Almeida et al., 2007) is a sequence of
+ * Bloom filters (slices). Keys are added to the last slice. When the
+ * last slice holds as many keys as it was sized for, a new slice is
+ * created with BLOOM_SCALABLE_GROWTH times more capacity and a false
+ * positive rate BLOOM_SCALABLE_TIGHTENING times smaller. A key is a
+ * member if it belongs to one of the slices.
+ *
+ * The false positive rate of slice i is p0.r^i, where r is the
+ * tightening ratio. The compounded false positive rate is bounded by
+ * p0/(1-r), hence the first slice is sized for p0 = P.(1-r) where P
+ * is the requested rate.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libgds/bloom_scalable.h>
+#include <libgds/memory.h>
+
+typedef struct {
+  SBloomFilter * filter;
+  uint32_t       capacity;
+  uint32_t       num_keys;
+} _bloom_slice_t;
+
+struct gds_bloom_scalable_t {
+  _bloom_slice_t * slices;
+  unsigned int     num_slices;
+  double           fp_rate;     // false positive rate of the last slice
+  uint64_t         num_keys;
+};
+
+// -----[ _bloom_scalable_add_slice ]--------------------------------
+/**
+ * Append a slice sized for 'capacity' keys. If the slice would
+ * exceed the maximum size of a bloom filter, its capacity is halved
+ * until it fits.
+ */
+static int _bloom_scalable_add_slice(gds_bloom_scalable_t * filter,
+				     uint32_t capacity, double fp_rate)
+{
+  uint32_t size, num_hashes;
+  _bloom_slice_t * slice;
+
+  while (bloom_filter_optimal_params(capacity, fp_rate,
+				     &size, &num_hashes) < 0) {
+    if (capacity <= 1)
+      return -1;
+    capacity/= 2;
+  }
+
+  filter->slices= (_bloom_slice_t *)
+    REALLOC(filter->slices, (filter->num_slices+1)*sizeof(_bloom_slice_t));
+  slice= &filter->slices[filter->num_slices++];
+  slice->filter= bloom_filter_create(size, num_hashes);
+  slice->capacity= capacity;
+  slice->num_keys= 0;
+  filter->fp_rate= fp_rate;
+  return 0;
+}
+
+// -----[ bloom_scalable_create ]------------------------------------
+/**
+ * \brief Create a scalable Bloom filter.
+ *
+ * \param capacity is the number of keys of the first slice.
+ * \param fp_rate  is the target false positive rate, in ]0,1[.
+ * \retval a new filter or NULL if the parameters are out of range.
+ */
+gds_bloom_scalable_t * bloom_scalable_create(uint32_t capacity,
+					     double fp_rate)
+{
+  gds_bloom_scalable_t * filter;
+
+  if ((capacity == 0) || !(fp_rate > 0) || !(fp_rate < 1))
+    return NULL;
+
+  filter= (gds_bloom_scalable_t *) MALLOC(sizeof(gds_bloom_scalable_t));
+  filter->slices= NULL;
+  filter->num_slices= 0;
+  filter->num_keys= 0;
+  if (_bloom_scalable_add_slice(filter, capacity,
+				fp_rate * (1 - BLOOM_SCALABLE_TIGHTENING)) < 0) {
+    FREE(filter);
+    return NULL;
+  }
+  return filter;
+}
+
+// -----[ bloom_scalable_destroy ]-----------------------------------
+void bloom_scalable_destroy(gds_bloom_scalable_t ** filter_ref)
+{
+  unsigned int index;
+
+  if (*filter_ref != NULL) {
+    for (index= 0; index < (*filter_ref)->num_slices; index++)
+      bloom_filter_destroy(&(*filter_ref)->slices[index].filter);
+    FREE((*filter_ref)->slices);
+    FREE(*filter_ref);
+    *filter_ref= NULL;
+  }
+}
+
+// -----[ bloom_scalable_is_member ]---------------------------------
+/**
+ * \brief Test if a key belongs to the filter.
+ *
+ * The most recent (largest) slices are tested first.
+ *
+ * \retval 1 if the key (probably) belongs to the filter, 0 otherwise.
+ */
+int bloom_scalable_is_member(gds_bloom_scalable_t * filter,
+			     const uint8_t * key, uint32_t key_len)
+{
+  unsigned int index;
+
+  if ((filter == NULL) || (key == NULL))
+    return 0;
+
+  for (index= filter->num_slices; index > 0; index--)
+    if (bloom_filter_is_member(filter->slices[index-1].filter,
+			       (uint8_t *) key, key_len))
+      return 1;
+  return 0;
+}
+
+// -----[ bloom_scalable_add ]---------------------------------------
+/**
+ * \brief Add a key to the filter.
+ *
+ * Keys that are already members are not added again, so that they
+ * are not counted twice against the capacity of the last slice.
+ *
+ * \retval 0 in case of success, -1 if the filter or the key is NULL
+ *   or if a new slice could not be created.
+ */
+int bloom_scalable_add(gds_bloom_scalable_t * filter,
+		       const uint8_t * key, uint32_t key_len)
+{
+  _bloom_slice_t * slice;
+  uint64_t capacity;
+
+  if ((filter == NULL) || (key == NULL))
+    return -1;
+
+  if (bloom_scalable_is_member(filter, key, key_len))
+    return 0;
+
+  slice= &filter->slices[filter->num_slices-1];
+  if (slice->num_keys >= slice->capacity) {
+    capacity= (uint64_t) slice->capacity * BLOOM_SCALABLE_GROWTH;
+    if (capacity > MAX_UINT32_T)
+      capacity= MAX_UINT32_T;
+    if (_bloom_scalable_add_slice(filter, (uint32_t) capacity,
+				  filter->fp_rate *
+				  BLOOM_SCALABLE_TIGHTENING) < 0)
+      return -1;
+    slice= &filter->slices[filter->num_slices-1];
+  }
+  bloom_filter_add(slice->filter, (uint8_t *) key, key_len);
+  slice->num_keys++;
+  filter->num_keys++;
+  return 0;
+}
+
+// -----[ bloom_scalable_num_slices ]--------------------------------
+unsigned int bloom_scalable_num_slices(gds_bloom_scalable_t * filter)
+{
+  return filter->num_slices;
+}
+
+// -----[ bloom_scalable_get_slice ]---------------------------------
+/**
+ * \brief Return a slice of the filter (e.g. to obtain its statistics
+ * with bloom_filter_stats()).
+ */
+SBloomFilter * bloom_scalable_get_slice(gds_bloom_scalable_t * filter,
+					unsigned int index)
+{
+  if (index >= filter->num_slices)
+    return NULL;
+  return filter->slices[index].filter;
+}
+
+// -----[ bloom_scalable_num_keys ]----------------------------------
+/**
+ * \brief Return the number of distinct keys added to the filter
+ * (keys that were false positives when added are not counted).
+ */
+uint64_t bloom_scalable_num_keys(gds_bloom_scalable_t * filter)
+{
+  return filter->num_keys;
+}
+
+// -----[ bloom_scalable_fp_rate ]-----------------------------------
+/**
+ * \brief Estimate the current false positive rate of the filter.
+ *
+ * The rate is 1 - prod(1 - p_i), where p_i is the current false
+ * positive rate of slice i as estimated by bloom_filter_stats().
+ */
+double bloom_scalable_fp_rate(gds_bloom_scalable_t * filter)
+{
+  SBloomFilterStats stats;
+  double rate= 1;
+  unsigned int index;
+
+  for (index= 0; index < filter->num_slices; index++) {
+    bloom_filter_stats(filter->slices[index].filter, &stats);
+    rate*= 1 - stats.dFPRate;
+  }
+  return 1 - rate;
+}
@@ -0,0 +1,53 @@
+// ==================================================================
+// @(#)bloom_scalable.h
+//
+// Scalable Bloom filter.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __GDS_BLOOM_SCALABLE_H__
+#define __GDS_BLOOM_SCALABLE_H__
+
+#include <libgds/types.h>
+#include <libgds/bloom_filter.h>
+
+/** Capacity ratio between two consecutive slices. */
+#define BLOOM_SCALABLE_GROWTH     2
+/** False positive rate ratio between two consecutive slices. */
+#define BLOOM_SCALABLE_TIGHTENING 0.5
+
+typedef struct gds_bloom_scalable_t gds_bloom_scalable_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ bloom_scalable_create ]----------------------------------
+  gds_bloom_scalable_t * bloom_scalable_create(uint32_t capacity,
+					       double fp_rate);
+  // -----[ bloom_scalable_destroy ]---------------------------------
+  void bloom_scalable_destroy(gds_bloom_scalable_t ** filter_ref);
+  // -----[ bloom_scalable_add ]-------------------------------------
+  int bloom_scalable_add(gds_bloom_scalable_t * filter,
+			 const uint8_t * key, uint32_t key_len);
+  // -----[ bloom_scalable_is_member ]-------------------------------
+  int bloom_scalable_is_member(gds_bloom_scalable_t * filter,
+			       const uint8_t * key, uint32_t key_len);
+  // -----[ bloom_scalable_num_slices ]------------------------------
+  unsigned int bloom_scalable_num_slices(gds_bloom_scalable_t * filter);
+  // -----[ bloom_scalable_get_slice ]-------------------------------
+  SBloomFilter * bloom_scalable_get_slice(gds_bloom_scalable_t * filter,
+					  unsigned int index);
+  // -----[ bloom_scalable_num_keys ]--------------------------------
+  uint64_t bloom_scalable_num_keys(gds_bloom_scalable_t * filter);
+  // -----[ bloom_scalable_fp_rate ]---------------------------------
+  double bloom_scalable_fp_rate(gds_bloom_scalable_t * filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_BLOOM_SCALABLE_H__ */
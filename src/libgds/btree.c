@@ -0,0 +1,644 @@
+// ==================================================================
+// @(#)btree.c
+//
+// Ordered map (B+-tree).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * All the pairs are stored in the leaves, which are chained in the
+ * order of the keys for range scans. Internal nodes only hold
+ * separators: the subtree at the right of a separator holds the keys
+ * greater than or equal to it.
+ *
+ * A node is a single memory block: the header is followed by the
+ * array of keys, then by the array of values (leaves) or children
+ * (internal nodes). A search in a node is a binary search over the
+ * contiguous keys. The arrays have room for one extra key, so that a
+ * node is split after the insertion.
+ *
+ * Every node except the root holds at least half the maximum number
+ * of keys. A node that falls below this after a removal borrows a
+ * key from a sibling, or is merged with it.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/btree.h>
+#include <libgds/memory.h>
+
+typedef struct _btree_node_t {
+  unsigned int           num_keys;
+  int                    leaf;
+  struct _btree_node_t * next;    /* next leaf */
+  void                ** keys;
+  void                ** ptrs;    /* values or children */
+} _btree_node_t;
+
+struct gds_btree_t {
+  _btree_node_t       * root;
+  unsigned int          node_size;
+  unsigned int          min_keys;
+  unsigned int          size;
+  gds_btree_cmp_f       cmp;
+  gds_btree_destroy_f   destroy;
+};
+
+#define _CHILD(N,I) ((_btree_node_t *) (N)->ptrs[I])
+
+// -----[ _btree_node_create ]---------------------------------------
+static inline _btree_node_t * _btree_node_create(gds_btree_t * tree,
+						 int leaf)
+{
+  _btree_node_t * node= (_btree_node_t *)
+    MALLOC(sizeof(_btree_node_t) +
+	   (2*tree->node_size+3)*sizeof(void *));
+  node->num_keys= 0;
+  node->leaf= leaf;
+  node->next= NULL;
+  node->keys= (void **) (node+1);
+  node->ptrs= node->keys + tree->node_size+1;
+  return node;
+}
+
+// -----[ _btree_node_destroy ]--------------------------------------
+static void _btree_node_destroy(gds_btree_t * tree, _btree_node_t * node)
+{
+  unsigned int index;
+
+  if (node->leaf) {
+    if (tree->destroy != NULL)
+      for (index= 0; index < node->num_keys; index++)
+	tree->destroy(node->keys[index], node->ptrs[index]);
+  } else {
+    for (index= 0; index <= node->num_keys; index++)
+      _btree_node_destroy(tree, _CHILD(node, index));
+  }
+  FREE(node);
+}
+
+// -----[ btree_create ]---------------------------------------------
+gds_btree_t * btree_create(unsigned int node_size, gds_btree_cmp_f cmp,
+			   gds_btree_destroy_f destroy)
+{
+  gds_btree_t * tree;
+
+  if (node_size == 0)
+    node_size= BTREE_DEFAULT_NODE_SIZE;
+  if ((node_size < 4) || (node_size > BTREE_MAX_NODE_SIZE))
+    return NULL;
+  tree= (gds_btree_t *) MALLOC(sizeof(gds_btree_t));
+  tree->node_size= node_size;
+  tree->min_keys= node_size/2;
+  tree->size= 0;
+  tree->cmp= cmp;
+  tree->destroy= destroy;
+  tree->root= _btree_node_create(tree, 1);
+  return tree;
+}
+
+// -----[ btree_destroy ]--------------------------------------------
+void btree_destroy(gds_btree_t ** tree_ref)
+{
+  gds_btree_t * tree= *tree_ref;
+
+  if (tree == NULL)
+    return;
+  _btree_node_destroy(tree, tree->root);
+  FREE(tree);
+  *tree_ref= NULL;
+}
+
+// -----[ _btree_child_index ]---------------------------------------
+/** Return the index of the child whose subtree can hold a key. */
+static inline unsigned int _btree_child_index(gds_btree_t * tree,
+					      _btree_node_t * node,
+					      const void * key)
+{
+  unsigned int low= 0, high= node->num_keys, middle;
+
+  while (low < high) {
+    middle= (low+high)/2;
+    if (tree->cmp(key, node->keys[middle]) >= 0)
+      low= middle+1;
+    else
+      high= middle;
+  }
+  return low;
+}
+
+// -----[ _btree_leaf_index ]----------------------------------------
+/**
+ * Return the index of the first key greater than or equal to a key
+ * in a leaf (or greater than the key if strict is set). The found
+ * flag tells if the key itself is in the leaf.
+ */
+static inline unsigned int _btree_leaf_index(gds_btree_t * tree,
+					     _btree_node_t * leaf,
+					     const void * key, int strict,
+					     int * found)
+{
+  unsigned int low= 0, high= leaf->num_keys, middle;
+  int cmp;
+
+  *found= 0;
+  while (low < high) {
+    middle= (low+high)/2;
+    cmp= tree->cmp(leaf->keys[middle], key);
+    if (cmp == 0)
+      *found= 1;
+    if ((cmp < 0) || (strict && (cmp == 0)))
+      low= middle+1;
+    else
+      high= middle;
+  }
+  return low;
+}
+
+// -----[ _btree_find_leaf ]-----------------------------------------
+static inline _btree_node_t * _btree_find_leaf(gds_btree_t * tree,
+					       const void * key)
+{
+  _btree_node_t * node= tree->root;
+
+  while (!node->leaf)
+    node= _CHILD(node, _btree_child_index(tree, node, key));
+  return node;
+}
+
+// -----[ _btree_shift ]---------------------------------------------
+/** Shift the entries of an array from index on by delta (+1/-1). */
+static inline void _btree_shift(void ** array, unsigned int index,
+				unsigned int num, int delta)
+{
+  if (index < num)
+    memmove(array+index+delta, array+index, (num-index)*sizeof(void *));
+}
+
+// -----[ _btree_insert ]--------------------------------------------
+/**
+ * Insert a pair in the subtree of a node. If the node is split, the
+ * new right node and its separator are returned through up_node and
+ * up_key.
+ *
+ * Returns 1 if the node was split, 0 if it was not, or -1 if the key
+ * is already in the subtree.
+ */
+static int _btree_insert(gds_btree_t * tree, _btree_node_t * node,
+			 void * key, void * value,
+			 void ** up_key, _btree_node_t ** up_node)
+{
+  _btree_node_t * right;
+  unsigned int index, middle;
+  int found, result;
+
+  if (node->leaf) {
+    index= _btree_leaf_index(tree, node, key, 0, &found);
+    if (found)
+      return -1;
+    _btree_shift(node->keys, index, node->num_keys, 1);
+    _btree_shift(node->ptrs, index, node->num_keys, 1);
+    node->keys[index]= key;
+    node->ptrs[index]= value;
+    node->num_keys++;
+    if (node->num_keys <= tree->node_size)
+      return 0;
+
+    // Split: the upper half goes to a new leaf
+    middle= node->num_keys/2;
+    right= _btree_node_create(tree, 1);
+    right->num_keys= node->num_keys-middle;
+    memcpy(right->keys, node->keys+middle, right->num_keys*sizeof(void *));
+    memcpy(right->ptrs, node->ptrs+middle, right->num_keys*sizeof(void *));
+    node->num_keys= middle;
+    right->next= node->next;
+    node->next= right;
+    *up_key= right->keys[0];
+    *up_node= right;
+    return 1;
+  }
+
+  index= _btree_child_index(tree, node, key);
+  result= _btree_insert(tree, _CHILD(node, index), key, value,
+			up_key, up_node);
+  if (result != 1)
+    return result;
+  _btree_shift(node->keys, index, node->num_keys, 1);
+  _btree_shift(node->ptrs, index+1, node->num_keys+1, 1);
+  node->keys[index]= *up_key;
+  node->ptrs[index+1]= *up_node;
+  node->num_keys++;
+  if (node->num_keys <= tree->node_size)
+    return 0;
+
+  // Split: the middle separator moves up
+  middle= node->num_keys/2;
+  right= _btree_node_create(tree, 0);
+  right->num_keys= node->num_keys-middle-1;
+  memcpy(right->keys, node->keys+middle+1,
+	 right->num_keys*sizeof(void *));
+  memcpy(right->ptrs, node->ptrs+middle+1,
+	 (right->num_keys+1)*sizeof(void *));
+  node->num_keys= middle;
+  *up_key= node->keys[middle];
+  *up_node= right;
+  return 1;
+}
+
+// -----[ btree_insert ]---------------------------------------------
+int btree_insert(gds_btree_t * tree, void * key, void * value)
+{
+  _btree_node_t * up_node, * root;
+  void * up_key;
+  int result;
+
+  result= _btree_insert(tree, tree->root, key, value, &up_key, &up_node);
+  if (result < 0)
+    return -1;
+  if (result > 0) {
+    root= _btree_node_create(tree, 0);
+    root->num_keys= 1;
+    root->keys[0]= up_key;
+    root->ptrs[0]= tree->root;
+    root->ptrs[1]= up_node;
+    tree->root= root;
+  }
+  tree->size++;
+  return 0;
+}
+
+// -----[ _btree_merge ]---------------------------------------------
+/** Merge the children index and index+1 of a node. */
+static void _btree_merge(_btree_node_t * node, unsigned int index)
+{
+  _btree_node_t * left= _CHILD(node, index);
+  _btree_node_t * right= _CHILD(node, index+1);
+
+  if (left->leaf) {
+    memcpy(left->keys+left->num_keys, right->keys,
+	   right->num_keys*sizeof(void *));
+    memcpy(left->ptrs+left->num_keys, right->ptrs,
+	   right->num_keys*sizeof(void *));
+    left->num_keys+= right->num_keys;
+    left->next= right->next;
+  } else {
+    left->keys[left->num_keys]= node->keys[index];
+    memcpy(left->keys+left->num_keys+1, right->keys,
+	   right->num_keys*sizeof(void *));
+    memcpy(left->ptrs+left->num_keys+1, right->ptrs,
+	   (right->num_keys+1)*sizeof(void *));
+    left->num_keys+= right->num_keys+1;
+  }
+  FREE(right);
+  _btree_shift(node->keys, index+1, node->num_keys, -1);
+  _btree_shift(node->ptrs, index+2, node->num_keys+1, -1);
+  node->num_keys--;
+}
+
+// -----[ _btree_rebalance ]-----------------------------------------
+/**
+ * Restore the minimum number of keys of a child of a node, by
+ * borrowing a key from a sibling or by merging with a sibling.
+ */
+static void _btree_rebalance(gds_btree_t * tree, _btree_node_t * node,
+			     unsigned int index)
+{
+  _btree_node_t * child= _CHILD(node, index);
+  _btree_node_t * left= (index > 0)?_CHILD(node, index-1):NULL;
+  _btree_node_t * right=
+    (index < node->num_keys)?_CHILD(node, index+1):NULL;
+
+  if ((left != NULL) && (left->num_keys > tree->min_keys)) {
+    // Borrow the last entry of the left sibling
+    _btree_shift(child->keys, 0, child->num_keys, 1);
+    if (child->leaf) {
+      _btree_shift(child->ptrs, 0, child->num_keys, 1);
+      child->keys[0]= left->keys[left->num_keys-1];
+      child->ptrs[0]= left->ptrs[left->num_keys-1];
+      node->keys[index-1]= child->keys[0];
+    } else {
+      _btree_shift(child->ptrs, 0, child->num_keys+1, 1);
+      child->keys[0]= node->keys[index-1];
+      child->ptrs[0]= left->ptrs[left->num_keys];
+      node->keys[index-1]= left->keys[left->num_keys-1];
+    }
+    left->num_keys--;
+    child->num_keys++;
+
+  } else if ((right != NULL) && (right->num_keys > tree->min_keys)) {
+    // Borrow the first entry of the right sibling
+    if (child->leaf) {
+      child->keys[child->num_keys]= right->keys[0];
+      child->ptrs[child->num_keys]= right->ptrs[0];
+      _btree_shift(right->keys, 1, right->num_keys, -1);
+      _btree_shift(right->ptrs, 1, right->num_keys, -1);
+      node->keys[index]= right->keys[0];
+    } else {
+      child->keys[child->num_keys]= node->keys[index];
+      child->ptrs[child->num_keys+1]= right->ptrs[0];
+      node->keys[index]= right->keys[0];
+      _btree_shift(right->keys, 1, right->num_keys, -1);
+      _btree_shift(right->ptrs, 1, right->num_keys+1, -1);
+    }
+    right->num_keys--;
+    child->num_keys++;
+
+  } else if (left != NULL) {
+    _btree_merge(node, index-1);
+  } else {
+    _btree_merge(node, index);
+  }
+}
+
+// -----[ _btree_remove ]--------------------------------------------
+/**
+ * Remove a key from the subtree of a node. The stored key and value
+ * are returned through key_ref and value_ref: they are not destroyed
+ * yet, as the key can still be used as a separator.
+ */
+static int _btree_remove(gds_btree_t * tree, _btree_node_t * node,
+			 const void * key, void ** key_ref,
+			 void ** value_ref)
+{
+  unsigned int index;
+  int found;
+
+  if (node->leaf) {
+    index= _btree_leaf_index(tree, node, key, 0, &found);
+    if (!found)
+      return -1;
+    *key_ref= node->keys[index];
+    *value_ref= node->ptrs[index];
+    _btree_shift(node->keys, index+1, node->num_keys, -1);
+    _btree_shift(node->ptrs, index+1, node->num_keys, -1);
+    node->num_keys--;
+    return 0;
+  }
+
+  index= _btree_child_index(tree, node, key);
+  if (_btree_remove(tree, _CHILD(node, index), key, key_ref, value_ref) < 0)
+    return -1;
+  if (_CHILD(node, index)->num_keys < tree->min_keys)
+    _btree_rebalance(tree, node, index);
+  return 0;
+}
+
+// -----[ _btree_replace_separator ]---------------------------------
+/**
+ * Replace the separator that points to a removed key (if any) by the
+ * smallest key of the subtree at its right.
+ *
+ * The separators are pointers to keys of the leaves, and a key is
+ * used by at most one separator, on the path from the root to the
+ * leaf of the key. The removed key must not be destroyed before it
+ * is replaced.
+ */
+static void _btree_replace_separator(gds_btree_t * tree, void * key)
+{
+  _btree_node_t * node= tree->root, * child;
+  unsigned int index;
+
+  while (!node->leaf) {
+    index= _btree_child_index(tree, node, key);
+    child= _CHILD(node, index);
+    if ((index > 0) && (node->keys[index-1] == key)) {
+      while (!child->leaf)
+	child= _CHILD(child, 0);
+      node->keys[index-1]= child->keys[0];
+      return;
+    }
+    node= child;
+  }
+}
+
+// -----[ btree_remove ]---------------------------------------------
+int btree_remove(gds_btree_t * tree, const void * key)
+{
+  _btree_node_t * root= tree->root;
+  void * removed_key, * removed_value;
+
+  if (_btree_remove(tree, root, key, &removed_key, &removed_value) < 0)
+    return -1;
+  // The root disappears when its last two children are merged
+  if (!root->leaf && (root->num_keys == 0)) {
+    tree->root= _CHILD(root, 0);
+    FREE(root);
+  }
+  _btree_replace_separator(tree, removed_key);
+  if (tree->destroy != NULL)
+    tree->destroy(removed_key, removed_value);
+  tree->size--;
+  return 0;
+}
+
+// -----[ btree_get ]------------------------------------------------
+void * btree_get(gds_btree_t * tree, const void * key)
+{
+  _btree_node_t * leaf= _btree_find_leaf(tree, key);
+  unsigned int index;
+  int found;
+
+  index= _btree_leaf_index(tree, leaf, key, 0, &found);
+  if (!found)
+    return NULL;
+  return leaf->ptrs[index];
+}
+
+// -----[ btree_load ]-----------------------------------------------
+/**
+ * The leaves are built first, then each level of internal nodes
+ * from the level below, until a single node remains. The entries of
+ * a level are spread evenly over ceil(n/max) nodes, so that every
+ * node holds at least the minimum number of keys.
+ */
+int btree_load(gds_btree_t * tree, void * const * keys,
+	       void * const * values, unsigned int num)
+{
+  _btree_node_t ** nodes, * node;
+  void ** mins;
+  unsigned int num_nodes, num_children, index, child, count;
+
+  if (tree->size > 0)
+    return -1;
+  for (index= 1; index < num; index++)
+    if (tree->cmp(keys[index-1], keys[index]) >= 0)
+      return -1;
+  if (num == 0)
+    return 0;
+
+  // Leaves
+  num_nodes= (num+tree->node_size-1)/tree->node_size;
+  nodes= (_btree_node_t **) MALLOC(num_nodes*sizeof(_btree_node_t *));
+  mins= (void **) MALLOC(num_nodes*sizeof(void *));
+  for (index= 0, child= 0; index < num_nodes; index++) {
+    node= _btree_node_create(tree, 1);
+    node->num_keys= num/num_nodes + ((index < num%num_nodes)?1:0);
+    memcpy(node->keys, keys+child, node->num_keys*sizeof(void *));
+    if (values != NULL)
+      memcpy(node->ptrs, values+child, node->num_keys*sizeof(void *));
+    else
+      memset(node->ptrs, 0, node->num_keys*sizeof(void *));
+    child+= node->num_keys;
+    if (index > 0)
+      nodes[index-1]->next= node;
+    nodes[index]= node;
+    mins[index]= node->keys[0];
+  }
+
+  // Internal levels, built in place in the arrays
+  while (num_nodes > 1) {
+    num_children= num_nodes;
+    num_nodes= (num_children+tree->node_size)/(tree->node_size+1);
+    for (index= 0, child= 0; index < num_nodes; index++) {
+      count= num_children/num_nodes +
+	((index < num_children%num_nodes)?1:0);
+      node= _btree_node_create(tree, 0);
+      node->num_keys= count-1;
+      memcpy(node->keys, mins+child+1, (count-1)*sizeof(void *));
+      memcpy(node->ptrs, nodes+child, count*sizeof(void *));
+      mins[index]= mins[child];
+      nodes[index]= node;
+      child+= count;
+    }
+  }
+
+  FREE(tree->root);
+  tree->root= nodes[0];
+  tree->size= num;
+  FREE(mins);
+  FREE(nodes);
+  return 0;
+}
+
+// -----[ btree_size ]-----------------------------------------------
+unsigned int btree_size(gds_btree_t * tree)
+{
+  return tree->size;
+}
+
+// -----[ _btree_iter_check ]----------------------------------------
+/**
+ * Move the iterator to the next leaf if it is past the end of the
+ * current leaf, and terminate it if the upper bound is passed.
+ */
+static inline void _btree_iter_check(gds_btree_iter_t * iter)
+{
+  _btree_node_t * leaf= (_btree_node_t *) iter->leaf;
+  int cmp;
+
+  while ((leaf != NULL) && (iter->index >= leaf->num_keys)) {
+    leaf= leaf->next;
+    iter->index= 0;
+  }
+  if ((leaf != NULL) && (iter->upper != NULL)) {
+    cmp= iter->tree->cmp(leaf->keys[iter->index], iter->upper);
+    if ((cmp > 0) || ((cmp == 0) && (iter->flags & BTREE_EXCLUDE_UPPER)))
+      leaf= NULL;
+  }
+  iter->leaf= leaf;
+}
+
+// -----[ btree_range ]----------------------------------------------
+void btree_range(gds_btree_t * tree, const void * lower,
+		 const void * upper, int flags, gds_btree_iter_t * iter)
+{
+  _btree_node_t * leaf;
+  int found;
+
+  iter->tree= tree;
+  iter->upper= upper;
+  iter->flags= flags;
+  if (lower == NULL) {
+    leaf= tree->root;
+    while (!leaf->leaf)
+      leaf= _CHILD(leaf, 0);
+    iter->index= 0;
+  } else {
+    leaf= _btree_find_leaf(tree, lower);
+    iter->index= _btree_leaf_index(tree, leaf, lower,
+				   flags & BTREE_EXCLUDE_LOWER, &found);
+  }
+  iter->leaf= leaf;
+  _btree_iter_check(iter);
+}
+
+// -----[ btree_iter_has_next ]--------------------------------------
+int btree_iter_has_next(gds_btree_iter_t * iter)
+{
+  return (iter->leaf != NULL);
+}
+
+// -----[ btree_iter_next ]------------------------------------------
+int btree_iter_next(gds_btree_iter_t * iter, void ** key_ref,
+		    void ** value_ref)
+{
+  _btree_node_t * leaf= (_btree_node_t *) iter->leaf;
+
+  if (leaf == NULL)
+    return -1;
+  if (key_ref != NULL)
+    *key_ref= leaf->keys[iter->index];
+  if (value_ref != NULL)
+    *value_ref= leaf->ptrs[iter->index];
+  iter->index++;
+  _btree_iter_check(iter);
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// ENUMERATION
+//
+/////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  gds_btree_iter_t iter;
+  int              key_or_value;
+} _enum_ctx_t;
+
+// -----[ _enum_has_next ]-------------------------------------------
+static int _enum_has_next(void * ctx)
+{
+  _enum_ctx_t * enum_ctx= (_enum_ctx_t *) ctx;
+  return btree_iter_has_next(&enum_ctx->iter);
+}
+
+// -----[ _enum_get_next ]-------------------------------------------
+static void * _enum_get_next(void * ctx)
+{
+  _enum_ctx_t * enum_ctx= (_enum_ctx_t *) ctx;
+  void * key= NULL, * value= NULL;
+
+  btree_iter_next(&enum_ctx->iter, &key, &value);
+  if (enum_ctx->key_or_value == BTREE_ENUM_KEYS)
+    return key;
+  return value;
+}
+
+// -----[ _enum_destroy ]--------------------------------------------
+static void _enum_destroy(void * ctx)
+{
+  FREE(ctx);
+}
+
+// -----[ btree_get_range_enum ]-------------------------------------
+gds_enum_t * btree_get_range_enum(gds_btree_t * tree, const void * lower,
+				  const void * upper, int flags,
+				  int key_or_value)
+{
+  _enum_ctx_t * ctx= (_enum_ctx_t *) MALLOC(sizeof(_enum_ctx_t));
+  btree_range(tree, lower, upper, flags, &ctx->iter);
+  ctx->key_or_value= key_or_value;
+  return enum_create(ctx,
+		     _enum_has_next,
+		     _enum_get_next,
+		     _enum_destroy);
+}
@@ -0,0 +1,193 @@
+// ==================================================================
+// @(#)btree.h
+//
+// Ordered map (B+-tree).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide an ordered map of (key, value) pairs implemented as an
+ * in-memory B+-tree. Keys are distinct and ordered by a comparison
+ * callback function. Insertion, removal and lookup take logarithmic
+ * time and never move more than one node of entries, unlike the
+ * insertion in a sorted array.
+ *
+ * The pairs are traversed in the order of the keys, possibly between
+ * a lower and an upper bound, with an iterator or an enumeration.
+ * Iterators and enumerations are invalidated when the tree is
+ * modified.
+ */
+
+#ifndef __GDS_BTREE_H__
+#define __GDS_BTREE_H__
+
+#include <libgds/enumerator.h>
+#include <libgds/types.h>
+
+/** Default number of keys per node. */
+#define BTREE_DEFAULT_NODE_SIZE 32
+/** Maximum number of keys per node. */
+#define BTREE_MAX_NODE_SIZE     1024
+
+/** Range option: exclude the lower bound. */
+#define BTREE_EXCLUDE_LOWER 0x01
+/** Range option: exclude the upper bound. */
+#define BTREE_EXCLUDE_UPPER 0x02
+
+#define BTREE_ENUM_KEYS   0
+#define BTREE_ENUM_VALUES 1
+
+// -----[ gds_btree_cmp_f ]------------------------------------------
+/** Key comparison callback function. */
+typedef int (*gds_btree_cmp_f)(const void * key1, const void * key2);
+
+// -----[ gds_btree_destroy_f ]--------------------------------------
+/** Callback function used to destroy a (key, value) pair. */
+typedef void (*gds_btree_destroy_f)(void * key, void * value);
+
+typedef struct gds_btree_t gds_btree_t;
+
+// -----[ gds_btree_iter_t ]-----------------------------------------
+/**
+ * Iterator over a range of keys. The fields are private.
+ */
+typedef struct {
+  gds_btree_t  * tree;
+  void         * leaf;
+  unsigned int   index;
+  const void   * upper;
+  int            flags;
+} gds_btree_iter_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ btree_create ]-------------------------------------------
+  /**
+   * Create a B+-tree.
+   *
+   * \param node_size is the maximum number of keys per node (0 for
+   *   the default size, otherwise 4 to BTREE_MAX_NODE_SIZE).
+   * \param cmp is the key comparison callback function.
+   * \param destroy is the destroy callback function (can be NULL).
+   * \retval the new tree, or NULL if the node size is invalid.
+   */
+  gds_btree_t * btree_create(unsigned int node_size, gds_btree_cmp_f cmp,
+			     gds_btree_destroy_f destroy);
+
+  // -----[ btree_destroy ]------------------------------------------
+  /**
+   * Destroy a B+-tree. If the destroy callback is not NULL, it is
+   * called for each pair in the tree.
+   */
+  void btree_destroy(gds_btree_t ** tree_ref);
+
+  // -----[ btree_insert ]-------------------------------------------
+  /**
+   * Insert a (key, value) pair.
+   *
+   * \retval 0 in case of success,
+   *   or -1 if the key is already in the tree.
+   */
+  int btree_insert(gds_btree_t * tree, void * key, void * value);
+
+  // -----[ btree_remove ]-------------------------------------------
+  /**
+   * Remove the pair with the given key. If the destroy callback is
+   * not NULL, it is called for the pair.
+   *
+   * \retval 0 in case of success,
+   *   or -1 if the key is not in the tree.
+   */
+  int btree_remove(gds_btree_t * tree, const void * key);
+
+  // -----[ btree_get ]----------------------------------------------
+  /**
+   * Return the value associated with a key, or NULL if the key is
+   * not in the tree.
+   */
+  void * btree_get(gds_btree_t * tree, const void * key);
+
+  // -----[ btree_load ]---------------------------------------------
+  /**
+   * Build the tree from arrays of keys and values sorted by key. The
+   * nodes are built bottom-up and filled completely.
+   *
+   * \param tree is the target tree. It must be empty.
+   * \param keys is the array of keys, in strictly increasing order.
+   * \param values is the array of values (can be NULL, in which case
+   *   all values are NULL).
+   * \param num is the number of pairs.
+   * \retval 0 in case of success,
+   *   or -1 if the tree is not empty or the keys are not in strictly
+   *   increasing order.
+   */
+  int btree_load(gds_btree_t * tree, void * const * keys,
+		 void * const * values, unsigned int num);
+
+  // -----[ btree_size ]---------------------------------------------
+  /** Return the number of pairs in the tree. */
+  unsigned int btree_size(gds_btree_t * tree);
+
+  // -----[ btree_range ]--------------------------------------------
+  /**
+   * Initialize an iterator over the pairs whose key is between two
+   * bounds, in increasing order of the keys.
+   *
+   * \param tree is the target tree.
+   * \param lower is the lower bound (NULL for no lower bound).
+   * \param upper is the upper bound (NULL for no upper bound).
+   * \param flags is a combination of BTREE_EXCLUDE_LOWER and
+   *   BTREE_EXCLUDE_UPPER (bounds are included by default).
+   * \param iter is the iterator to initialize.
+   */
+  void btree_range(gds_btree_t * tree, const void * lower,
+		   const void * upper, int flags, gds_btree_iter_t * iter);
+
+  // -----[ btree_iter_has_next ]------------------------------------
+  int btree_iter_has_next(gds_btree_iter_t * iter);
+
+  // -----[ btree_iter_next ]----------------------------------------
+  /**
+   * Return the next pair of an iterator.
+   *
+   * \param iter is the iterator.
+   * \param key_ref is set to the key (can be NULL).
+   * \param value_ref is set to the value (can be NULL).
+   * \retval 0 in case of success,
+   *   or -1 if there is no more pair.
+   */
+  int btree_iter_next(gds_btree_iter_t * iter, void ** key_ref,
+		      void ** value_ref);
+
+  // -----[ btree_get_range_enum ]-----------------------------------
+  /**
+   * Get an enumeration of the keys or values of the pairs between
+   * two bounds (see btree_range()).
+   *
+   * \param key_or_value is BTREE_ENUM_KEYS or BTREE_ENUM_VALUES.
+   */
+  gds_enum_t * btree_get_range_enum(gds_btree_t * tree, const void * lower,
+				    const void * upper, int flags,
+				    int key_or_value);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** Get an enumeration for the keys in a B+-tree.
+ * \see btree_get_range_enum */
+#define btree_get_keys_enum(T) \
+  btree_get_range_enum(T, NULL, NULL, 0, BTREE_ENUM_KEYS)
+
+/** Get an enumeration for the values in a B+-tree.
+ * \see btree_get_range_enum */
+#define btree_get_values_enum(T) \
+  btree_get_range_enum(T, NULL, NULL, 0, BTREE_ENUM_VALUES)
+
+#endif /* __GDS_BTREE_H__ */
@@ -0,0 +1,322 @@
+// ==================================================================
+// @(#)calendar_queue.c
+//
+// Calendar queue.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * The time line is divided in intervals of fixed width. Interval k
+ * is mapped to bucket (k mod N) of an array of N buckets, like the
+ * days of a year in a calendar. Each bucket is an intrusive list of
+ * events sorted by time.
+ *
+ * The earliest event is searched from the interval of the last
+ * extracted event: the head of the current bucket is the earliest
+ * event if it belongs to the current interval (and not to a later
+ * "year"), otherwise the next interval is examined. If a whole year
+ * is examined without success, the earliest head is searched
+ * directly.
+ *
+ * The intervals are identified by their integer index and an event
+ * belongs to the interval floor(time/width): the same expression is
+ * used to find the bucket of an event and to check if it belongs to
+ * the current interval, which avoids the drift of accumulated
+ * floating-point bounds.
+ *
+ * The number of buckets is doubled (resp. halved) when the number of
+ * events exceeds twice (resp. falls below half) the number of
+ * buckets. The width is then re-estimated from the average interval
+ * between the earliest events, so that each bucket holds a few
+ * events of the current year.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libgds/calendar_queue.h>
+#include <libgds/memory.h>
+
+#define CALENDAR_QUEUE_MIN_BUCKETS 16
+#define CALENDAR_QUEUE_MAX_BUCKETS (1U << 30)
+/** Number of events sampled to estimate the width. */
+#define CALENDAR_QUEUE_SAMPLES     25
+
+struct gds_calendar_queue_t {
+  gds_dllist_t ** buckets;
+  uint32_t        num_buckets;
+  uint32_t        mask;
+  double          width;
+  uint64_t        current;     /* index of the current interval */
+  double          last_time;
+  uint64_t        size;
+  int             resizing;
+};
+
+#define _EVENT(I) DLLIST_ENTRY(I, gds_calendar_event_t, item)
+
+static void _calendar_queue_resize(gds_calendar_queue_t * queue,
+				   uint32_t num_buckets);
+
+// -----[ _calendar_queue_interval ]---------------------------------
+static inline uint64_t _calendar_queue_interval(gds_calendar_queue_t * queue,
+						double time)
+{
+  return (uint64_t) (time / queue->width);
+}
+
+// -----[ _calendar_queue_buckets ]----------------------------------
+static inline gds_dllist_t ** _calendar_queue_buckets(uint32_t num_buckets)
+{
+  gds_dllist_t ** buckets= (gds_dllist_t **)
+    MALLOC(num_buckets*sizeof(gds_dllist_t *));
+  uint32_t index;
+
+  for (index= 0; index < num_buckets; index++)
+    buckets[index]= dllist_create_intrusive(NULL);
+  return buckets;
+}
+
+// -----[ calendar_queue_create ]------------------------------------
+gds_calendar_queue_t * calendar_queue_create(double width, double start)
+{
+  gds_calendar_queue_t * queue;
+
+  if (!(width > 0) || !(start >= 0))
+    return NULL;
+  queue= (gds_calendar_queue_t *) MALLOC(sizeof(gds_calendar_queue_t));
+  queue->num_buckets= CALENDAR_QUEUE_MIN_BUCKETS;
+  queue->mask= CALENDAR_QUEUE_MIN_BUCKETS-1;
+  queue->buckets= _calendar_queue_buckets(CALENDAR_QUEUE_MIN_BUCKETS);
+  queue->width= width;
+  queue->last_time= start;
+  queue->current= _calendar_queue_interval(queue, start);
+  queue->size= 0;
+  queue->resizing= 0;
+  return queue;
+}
+
+// -----[ calendar_queue_destroy ]-----------------------------------
+void calendar_queue_destroy(gds_calendar_queue_t ** queue_ref)
+{
+  gds_calendar_queue_t * queue= *queue_ref;
+  uint32_t index;
+
+  if (queue == NULL)
+    return;
+  for (index= 0; index < queue->num_buckets; index++)
+    dllist_destroy(&queue->buckets[index]);
+  FREE(queue->buckets);
+  FREE(queue);
+  *queue_ref= NULL;
+}
+
+// -----[ _calendar_queue_link ]-------------------------------------
+/**
+ * Insert an event in its bucket, after the events with a lower or
+ * equal time. The bucket is searched from its tail since new events
+ * are usually later than the queued ones.
+ */
+static inline void _calendar_queue_link(gds_calendar_queue_t * queue,
+					gds_calendar_event_t * event)
+{
+  gds_dllist_t * bucket=
+    queue->buckets[_calendar_queue_interval(queue, event->time) &
+		   queue->mask];
+  gds_dllist_item_t * pos= dllist_tail(bucket);
+
+  while ((pos != NULL) && (_EVENT(pos)->time > event->time))
+    pos= pos->prev;
+  dllist_insert_after(bucket, pos, &event->item);
+}
+
+// -----[ _calendar_queue_link_first ]-------------------------------
+/**
+ * Insert an event in its bucket, before the events with a greater or
+ * equal time. Used to put back the earliest events.
+ */
+static inline void _calendar_queue_link_first(gds_calendar_queue_t * queue,
+					      gds_calendar_event_t * event)
+{
+  gds_dllist_t * bucket=
+    queue->buckets[_calendar_queue_interval(queue, event->time) &
+		   queue->mask];
+  gds_dllist_item_t * pos= dllist_head(bucket);
+
+  while ((pos != NULL) && (_EVENT(pos)->time < event->time))
+    pos= pos->next;
+  dllist_insert_before(bucket, pos, &event->item);
+}
+
+// -----[ calendar_queue_insert ]------------------------------------
+int calendar_queue_insert(gds_calendar_queue_t * queue,
+			  gds_calendar_event_t * event)
+{
+  uint64_t interval;
+
+  if (!(event->time >= queue->last_time))
+    return -1;
+  // The event can be earlier than the current interval if this one
+  // has been moved forward by calendar_queue_peek()
+  interval= _calendar_queue_interval(queue, event->time);
+  if (interval < queue->current)
+    queue->current= interval;
+  _calendar_queue_link(queue, event);
+  queue->size++;
+  if ((queue->size > 2*(uint64_t) queue->num_buckets) &&
+      (queue->num_buckets < CALENDAR_QUEUE_MAX_BUCKETS))
+    _calendar_queue_resize(queue, queue->num_buckets*2);
+  return 0;
+}
+
+// -----[ _calendar_queue_shrink ]-----------------------------------
+static inline void _calendar_queue_shrink(gds_calendar_queue_t * queue)
+{
+  if ((queue->size < queue->num_buckets/2) &&
+      (queue->num_buckets > CALENDAR_QUEUE_MIN_BUCKETS))
+    _calendar_queue_resize(queue, queue->num_buckets/2);
+}
+
+// -----[ calendar_queue_remove ]------------------------------------
+void calendar_queue_remove(gds_calendar_queue_t * queue,
+			   gds_calendar_event_t * event)
+{
+  dllist_unlink(queue->buckets[_calendar_queue_interval(queue, event->time)
+			       & queue->mask], &event->item);
+  queue->size--;
+  _calendar_queue_shrink(queue);
+}
+
+// -----[ calendar_queue_peek ]--------------------------------------
+/**
+ * Find the earliest event and move the current interval to the
+ * interval of this event.
+ */
+gds_calendar_event_t * calendar_queue_peek(gds_calendar_queue_t * queue)
+{
+  gds_dllist_item_t * head, * best;
+  uint64_t current= queue->current;
+  uint32_t index;
+
+  if (queue->size == 0)
+    return NULL;
+
+  for (index= 0; index < queue->num_buckets; index++, current++) {
+    head= dllist_head(queue->buckets[current & queue->mask]);
+    if ((head != NULL) &&
+	(_calendar_queue_interval(queue, _EVENT(head)->time) <= current)) {
+      queue->current= current;
+      return _EVENT(head);
+    }
+  }
+
+  // Sparse events: direct search
+  best= NULL;
+  for (index= 0; index < queue->num_buckets; index++) {
+    head= dllist_head(queue->buckets[index]);
+    if ((head != NULL) &&
+	((best == NULL) || (_EVENT(head)->time < _EVENT(best)->time)))
+      best= head;
+  }
+  queue->current= _calendar_queue_interval(queue, _EVENT(best)->time);
+  return _EVENT(best);
+}
+
+// -----[ calendar_queue_pop ]---------------------------------------
+gds_calendar_event_t * calendar_queue_pop(gds_calendar_queue_t * queue)
+{
+  gds_calendar_event_t * event= calendar_queue_peek(queue);
+
+  if (event == NULL)
+    return NULL;
+  dllist_unlink(queue->buckets[queue->current & queue->mask], &event->item);
+  queue->last_time= event->time;
+  queue->size--;
+  _calendar_queue_shrink(queue);
+  return event;
+}
+
+// -----[ _calendar_queue_width ]------------------------------------
+/**
+ * Estimate the width of a bucket from the earliest events: three
+ * times their average separation, ignoring separations larger than
+ * twice the average. Return 0 if no estimate can be made.
+ */
+static double _calendar_queue_width(gds_calendar_queue_t * queue)
+{
+  gds_calendar_event_t * samples[CALENDAR_QUEUE_SAMPLES];
+  double last_time= queue->last_time;
+  uint64_t current= queue->current;
+  unsigned int num_samples= 0, num_gaps= 0, index;
+  double gap, total= 0, average;
+
+  while ((num_samples < CALENDAR_QUEUE_SAMPLES) &&
+	 ((samples[num_samples]= calendar_queue_pop(queue)) != NULL))
+    num_samples++;
+  // Put back the samples before the events with the same time to
+  // keep the order of insertion
+  for (index= num_samples; index > 0; index--)
+    _calendar_queue_link_first(queue, samples[index-1]);
+  queue->size+= num_samples;
+  queue->last_time= last_time;
+  queue->current= current;
+
+  if (num_samples < 2)
+    return 0;
+  average= (samples[num_samples-1]->time - samples[0]->time)/
+    (num_samples-1);
+  for (index= 1; index < num_samples; index++) {
+    gap= samples[index]->time - samples[index-1]->time;
+    if (gap <= 2*average) {
+      total+= gap;
+      num_gaps++;
+    }
+  }
+  if ((num_gaps == 0) || !(total > 0))
+    return 0;
+  return 3*total/num_gaps;
+}
+
+// -----[ _calendar_queue_resize ]-----------------------------------
+static void _calendar_queue_resize(gds_calendar_queue_t * queue,
+				   uint32_t num_buckets)
+{
+  gds_dllist_t ** buckets= queue->buckets;
+  uint32_t old_num_buckets= queue->num_buckets;
+  gds_dllist_item_t * item;
+  uint32_t index;
+  double width;
+
+  // The sampling pops and inserts events: prevent recursion
+  if (queue->resizing)
+    return;
+  queue->resizing= 1;
+  width= _calendar_queue_width(queue);
+  queue->resizing= 0;
+
+  if (width > 0)
+    queue->width= width;
+  queue->num_buckets= num_buckets;
+  queue->mask= num_buckets-1;
+  queue->buckets= _calendar_queue_buckets(num_buckets);
+  for (index= 0; index < old_num_buckets; index++) {
+    while ((item= dllist_head(buckets[index])) != NULL) {
+      dllist_unlink(buckets[index], item);
+      _calendar_queue_link(queue, _EVENT(item));
+    }
+    dllist_destroy(&buckets[index]);
+  }
+  FREE(buckets);
+  queue->current= _calendar_queue_interval(queue, queue->last_time);
+}
+
+// -----[ calendar_queue_size ]--------------------------------------
+uint64_t calendar_queue_size(gds_calendar_queue_t * queue)
+{
+  return queue->size;
+}
@@ -0,0 +1,98 @@
+// ==================================================================
+// @(#)calendar_queue.h
+//
+// Calendar queue.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a calendar queue (R. Brown, 1988): a priority queue of
+ * events with floating-point timestamps, with constant amortized
+ * time insertion, removal and extraction of the earliest event when
+ * the timestamps are reasonably distributed.
+ *
+ * As in a discrete-event simulation, the time of an inserted event
+ * must not be before the time of the last extracted event.
+ *
+ * Events are embedded in the user's structures (see DLLIST_ENTRY()
+ * to obtain the enclosing structure from an event).
+ */
+
+#ifndef __GDS_CALENDAR_QUEUE_H__
+#define __GDS_CALENDAR_QUEUE_H__
+
+#include <libgds/dllist.h>
+#include <libgds/types.h>
+
+// -----[ gds_calendar_event_t ]-------------------------------------
+/**
+ * Event. The time field must not be modified while the event is in
+ * a queue.
+ */
+typedef struct {
+  gds_dllist_item_t item;
+  double            time;
+} gds_calendar_event_t;
+
+typedef struct gds_calendar_queue_t gds_calendar_queue_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ calendar_queue_create ]----------------------------------
+  /**
+   * Create a calendar queue.
+   *
+   * \param width is the initial width of a bucket, i.e. the expected
+   *   interval between consecutive events. The width is re-estimated
+   *   when the queue is resized.
+   * \param start is the initial time.
+   */
+  gds_calendar_queue_t * calendar_queue_create(double width, double start);
+
+  // -----[ calendar_queue_destroy ]---------------------------------
+  /** Destroy a calendar queue. The events are not freed. */
+  void calendar_queue_destroy(gds_calendar_queue_t ** queue_ref);
+
+  // -----[ calendar_queue_insert ]----------------------------------
+  /**
+   * Insert an event. Events with the same time are extracted in the
+   * order of their insertion.
+   *
+   * \retval 0 in case of success,
+   *   or -1 if the event time is before the last extracted event.
+   */
+  int calendar_queue_insert(gds_calendar_queue_t * queue,
+			    gds_calendar_event_t * event);
+
+  // -----[ calendar_queue_remove ]----------------------------------
+  /** Remove an event from the queue. */
+  void calendar_queue_remove(gds_calendar_queue_t * queue,
+			     gds_calendar_event_t * event);
+
+  // -----[ calendar_queue_peek ]------------------------------------
+  /**
+   * Return the earliest event, or NULL if the queue is empty.
+   */
+  gds_calendar_event_t * calendar_queue_peek(gds_calendar_queue_t * queue);
+
+  // -----[ calendar_queue_pop ]-------------------------------------
+  /**
+   * Remove and return the earliest event, or NULL if the queue is
+   * empty.
+   */
+  gds_calendar_event_t * calendar_queue_pop(gds_calendar_queue_t * queue);
+
+  // -----[ calendar_queue_size ]------------------------------------
+  uint64_t calendar_queue_size(gds_calendar_queue_t * queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_CALENDAR_QUEUE_H__ */
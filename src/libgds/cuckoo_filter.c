@@ -0,0 +1,414 @@
+// ==================================================================
+// @(#)cuckoo_filter.c
+//
+// Cuckoo filter.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * A cuckoo filter (Fan et al., CoNEXT 2014) stores a short
+ * fingerprint of each key in a table of buckets of
+ * CUCKOO_FILTER_BUCKET_SIZE slots. Each key has two candidate
+ * buckets. With partial-key cuckoo hashing, the alternate bucket of
+ * a fingerprint is computed from the current bucket and the
+ * fingerprint only, so that fingerprints can be relocated without
+ * knowing their keys:
+ *
+ *   i2 = h(fp) - i1 (mod num_buckets)
+ *
+ * This relation is an involution for any number of buckets, which
+ * avoids rounding the table to a power of 2.
+ *
+ * Unlike a Bloom filter, keys can be removed. Removing a key that
+ * was never added may remove another key with the same fingerprint
+ * and bucket, and thus introduce a false negative.
+ *
+ * Fingerprints of up to 8 bits are stored in one byte, the others in
+ * two bytes. A whole bucket is tested at once with a word-level
+ * comparison.
+ *
+ * When an insertion fails after CUCKOO_FILTER_MAX_KICKS relocations,
+ * the last evicted fingerprint is kept aside (victim) and the filter
+ * is full: further insertions fail until a key is removed.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include <libgds/bloom_hash.h>
+#include <libgds/cuckoo_filter.h>
+#include <libgds/memory.h>
+
+struct gds_cuckoo_filter_t {
+  uint8_t      * table;
+  uint32_t       num_buckets;
+  unsigned int   fp_bits;
+  unsigned int   slot_size;   /* bytes per fingerprint (1 or 2) */
+  uint64_t       num_items;
+  uint32_t       rand_state;
+  /* Fingerprint that could not be relocated */
+  int            has_victim;
+  uint32_t       victim_index;
+  uint16_t       victim_fp;
+};
+
+#define _BUCKET(F,I) \
+  ((F)->table + (size_t) (I) * CUCKOO_FILTER_BUCKET_SIZE * (F)->slot_size)
+
+// -----[ _cuckoo_filter_rand ]--------------------------------------
+/** Xorshift generator used to choose the fingerprints to evict. */
+static inline uint32_t _cuckoo_filter_rand(gds_cuckoo_filter_t * filter)
+{
+  uint32_t x= filter->rand_state;
+  x^= x << 13;
+  x^= x >> 17;
+  x^= x << 5;
+  filter->rand_state= x;
+  return x;
+}
+
+// -----[ _cuckoo_filter_hash ]--------------------------------------
+/** Compute the first bucket and the fingerprint of a key. */
+static inline void _cuckoo_filter_hash(gds_cuckoo_filter_t * filter,
+				       const uint8_t * key, uint32_t key_len,
+				       uint32_t * index, uint16_t * fp)
+{
+  uint64_t digest[2];
+
+  bloom_hash_128(key, key_len, 0, digest);
+  *index= (uint32_t) (((digest[0] >> 32) * filter->num_buckets) >> 32);
+  *fp= (uint16_t) (digest[1] >> (64 - filter->fp_bits));
+  // 0 denotes an empty slot
+  if (*fp == 0)
+    *fp= 1;
+}
+
+// -----[ _cuckoo_filter_alt ]---------------------------------------
+/** Alternate bucket of a fingerprint. */
+static inline uint32_t _cuckoo_filter_alt(gds_cuckoo_filter_t * filter,
+					  uint32_t index, uint16_t fp)
+{
+  uint32_t hash= (uint32_t)
+    (((uint64_t) (uint32_t) (fp * 0x5bd1e995U) * filter->num_buckets) >> 32);
+  return (hash >= index) ? hash - index : hash + filter->num_buckets - index;
+}
+
+// -----[ _slot_get ]------------------------------------------------
+static inline uint16_t _slot_get(gds_cuckoo_filter_t * filter,
+				 uint8_t * bucket, unsigned int slot)
+{
+  if (filter->slot_size == 1)
+    return bucket[slot];
+  return ((uint16_t *) bucket)[slot];
+}
+
+// -----[ _slot_set ]------------------------------------------------
+static inline void _slot_set(gds_cuckoo_filter_t * filter,
+			     uint8_t * bucket, unsigned int slot,
+			     uint16_t fp)
+{
+  if (filter->slot_size == 1)
+    bucket[slot]= (uint8_t) fp;
+  else
+    ((uint16_t *) bucket)[slot]= fp;
+}
+
+// -----[ _bucket_contains ]-----------------------------------------
+/**
+ * Test if a bucket contains a fingerprint. The bucket is loaded in a
+ * single word and all the slots are compared at once, using the
+ * classic "has zero byte" test on word ^ (fp repeated in each slot).
+ */
+static inline int _bucket_contains(gds_cuckoo_filter_t * filter,
+				   uint32_t index, uint16_t fp)
+{
+  const uint8_t * bucket= _BUCKET(filter, index);
+  uint32_t word32;
+  uint64_t word64;
+
+  if (filter->slot_size == 1) {
+    memcpy(&word32, bucket, sizeof(word32));
+    word32^= fp * 0x01010101U;
+    return ((word32 - 0x01010101U) & ~word32 & 0x80808080U) != 0;
+  }
+  memcpy(&word64, bucket, sizeof(word64));
+  word64^= fp * 0x0001000100010001ULL;
+  return ((word64 - 0x0001000100010001ULL) & ~word64 &
+	  0x8000800080008000ULL) != 0;
+}
+
+// -----[ _bucket_insert ]-------------------------------------------
+static inline int _bucket_insert(gds_cuckoo_filter_t * filter,
+				 uint32_t index, uint16_t fp)
+{
+  uint8_t * bucket= _BUCKET(filter, index);
+  unsigned int slot;
+
+  for (slot= 0; slot < CUCKOO_FILTER_BUCKET_SIZE; slot++)
+    if (_slot_get(filter, bucket, slot) == 0) {
+      _slot_set(filter, bucket, slot, fp);
+      return 1;
+    }
+  return 0;
+}
+
+// -----[ _bucket_remove ]-------------------------------------------
+static inline int _bucket_remove(gds_cuckoo_filter_t * filter,
+				 uint32_t index, uint16_t fp)
+{
+  uint8_t * bucket= _BUCKET(filter, index);
+  unsigned int slot;
+
+  for (slot= 0; slot < CUCKOO_FILTER_BUCKET_SIZE; slot++)
+    if (_slot_get(filter, bucket, slot) == fp) {
+      _slot_set(filter, bucket, slot, 0);
+      return 1;
+    }
+  return 0;
+}
+
+// -----[ _cuckoo_filter_place ]-------------------------------------
+/**
+ * Store a fingerprint in one of its buckets, relocating other
+ * fingerprints if needed. If no room is found, the last evicted
+ * fingerprint becomes the victim.
+ *
+ * \retval 0 if all the fingerprints are stored in the table, -1 if
+ *   there is a victim.
+ */
+static int _cuckoo_filter_place(gds_cuckoo_filter_t * filter,
+				uint32_t index, uint16_t fp)
+{
+  uint32_t alt= _cuckoo_filter_alt(filter, index, fp);
+  unsigned int kick, slot;
+  uint16_t evicted;
+  uint8_t * bucket;
+
+  if (_bucket_insert(filter, index, fp) || _bucket_insert(filter, alt, fp))
+    return 0;
+
+  if (_cuckoo_filter_rand(filter) & 1)
+    index= alt;
+  for (kick= 0; kick < CUCKOO_FILTER_MAX_KICKS; kick++) {
+    bucket= _BUCKET(filter, index);
+    slot= _cuckoo_filter_rand(filter) % CUCKOO_FILTER_BUCKET_SIZE;
+    evicted= _slot_get(filter, bucket, slot);
+    _slot_set(filter, bucket, slot, fp);
+    fp= evicted;
+    index= _cuckoo_filter_alt(filter, index, fp);
+    if (_bucket_insert(filter, index, fp))
+      return 0;
+  }
+  filter->has_victim= 1;
+  filter->victim_index= index;
+  filter->victim_fp= fp;
+  return -1;
+}
+
+// -----[ cuckoo_filter_create ]-------------------------------------
+/**
+ * \brief Create a cuckoo filter.
+ *
+ * \param capacity is the number of keys the filter must hold. The
+ *   table is sized so that it is CUCKOO_FILTER_MAX_LOAD full when it
+ *   holds 'capacity' keys.
+ * \param fp_bits is the length of the fingerprints, in
+ *   [1, CUCKOO_FILTER_MAX_FP_BITS]. The false positive rate is about
+ *   2.CUCKOO_FILTER_BUCKET_SIZE / 2^fp_bits.
+ * \retval a new filter, or NULL if a parameter is not valid.
+ */
+gds_cuckoo_filter_t * cuckoo_filter_create(uint32_t capacity,
+					   unsigned int fp_bits)
+{
+  gds_cuckoo_filter_t * filter;
+  uint64_t num_buckets;
+  size_t size;
+
+  if ((capacity == 0) || (fp_bits == 0) ||
+      (fp_bits > CUCKOO_FILTER_MAX_FP_BITS))
+    return NULL;
+  num_buckets= (uint64_t)
+    ceil(capacity / (CUCKOO_FILTER_BUCKET_SIZE * CUCKOO_FILTER_MAX_LOAD));
+
+  filter= (gds_cuckoo_filter_t *) MALLOC(sizeof(gds_cuckoo_filter_t));
+  filter->num_buckets= (uint32_t) num_buckets;
+  filter->fp_bits= fp_bits;
+  filter->slot_size= (fp_bits <= 8) ? 1 : 2;
+  size= (size_t) num_buckets * CUCKOO_FILTER_BUCKET_SIZE * filter->slot_size;
+  filter->table= (uint8_t *) MALLOC(size);
+  memset(filter->table, 0, size);
+  filter->num_items= 0;
+  filter->rand_state= 2463534242U;
+  filter->has_victim= 0;
+  return filter;
+}
+
+// -----[ cuckoo_filter_create_optimal ]-----------------------------
+/**
+ * \brief Create a cuckoo filter for a target false positive rate.
+ *
+ * \retval a new filter, or NULL if the rate is not in ]0,1[ or would
+ *   require fingerprints longer than CUCKOO_FILTER_MAX_FP_BITS.
+ */
+gds_cuckoo_filter_t * cuckoo_filter_create_optimal(uint32_t capacity,
+						   double fp_rate)
+{
+  double fp_bits;
+
+  if ((fp_rate <= 0) || (fp_rate >= 1))
+    return NULL;
+  // 2b fingerprints are compared, each matches with prob. 1/(2^f-1)
+  fp_bits= ceil(log2(2 * CUCKOO_FILTER_BUCKET_SIZE / fp_rate + 1));
+  if (fp_bits > CUCKOO_FILTER_MAX_FP_BITS)
+    return NULL;
+  return cuckoo_filter_create(capacity, (unsigned int) fp_bits);
+}
+
+// -----[ cuckoo_filter_destroy ]------------------------------------
+void cuckoo_filter_destroy(gds_cuckoo_filter_t ** filter_ref)
+{
+  if (*filter_ref != NULL) {
+    FREE((*filter_ref)->table);
+    FREE(*filter_ref);
+    *filter_ref= NULL;
+  }
+}
+
+// -----[ cuckoo_filter_add ]----------------------------------------
+/**
+ * \brief Add a key to the filter.
+ *
+ * The same key can be added several times (up to
+ * 2.CUCKOO_FILTER_BUCKET_SIZE times). It must then be removed as many
+ * times.
+ *
+ * \retval 0 in case of success, -1 if the filter is full (or if the
+ *   filter or the key is NULL).
+ */
+int cuckoo_filter_add(gds_cuckoo_filter_t * filter,
+		      const uint8_t * key, uint32_t key_len)
+{
+  uint32_t index;
+  uint16_t fp;
+
+  if ((filter == NULL) || (key == NULL) || filter->has_victim)
+    return -1;
+  _cuckoo_filter_hash(filter, key, key_len, &index, &fp);
+  // The key is stored even if a victim is left aside
+  _cuckoo_filter_place(filter, index, fp);
+  filter->num_items++;
+  return 0;
+}
+
+// -----[ cuckoo_filter_is_member ]----------------------------------
+/**
+ * \brief Test if a key belongs to the filter.
+ *
+ * \retval 1 if the key (probably) belongs to the filter, 0 otherwise.
+ */
+int cuckoo_filter_is_member(gds_cuckoo_filter_t * filter,
+			    const uint8_t * key, uint32_t key_len)
+{
+  uint32_t index, alt;
+  uint16_t fp;
+
+  if ((filter == NULL) || (key == NULL))
+    return 0;
+  _cuckoo_filter_hash(filter, key, key_len, &index, &fp);
+  alt= _cuckoo_filter_alt(filter, index, fp);
+  if (_bucket_contains(filter, index, fp) ||
+      _bucket_contains(filter, alt, fp))
+    return 1;
+  return (filter->has_victim && (filter->victim_fp == fp) &&
+	  ((filter->victim_index == index) || (filter->victim_index == alt)));
+}
+
+// -----[ cuckoo_filter_remove ]-------------------------------------
+/**
+ * \brief Remove a key from the filter.
+ *
+ * Only keys that were added must be removed.
+ *
+ * \retval 0 in case of success, -1 if the key was not found.
+ */
+int cuckoo_filter_remove(gds_cuckoo_filter_t * filter,
+			 const uint8_t * key, uint32_t key_len)
+{
+  uint32_t index, alt;
+  uint16_t fp;
+
+  if ((filter == NULL) || (key == NULL))
+    return -1;
+  _cuckoo_filter_hash(filter, key, key_len, &index, &fp);
+  alt= _cuckoo_filter_alt(filter, index, fp);
+
+  if (filter->has_victim && (filter->victim_fp == fp) &&
+      ((filter->victim_index == index) || (filter->victim_index == alt))) {
+    filter->has_victim= 0;
+    filter->num_items--;
+    return 0;
+  }
+  if (!_bucket_remove(filter, index, fp) &&
+      !_bucket_remove(filter, alt, fp))
+    return -1;
+  filter->num_items--;
+  // There is room again for the victim
+  if (filter->has_victim) {
+    filter->has_victim= 0;
+    _cuckoo_filter_place(filter, filter->victim_index, filter->victim_fp);
+  }
+  return 0;
+}
+
+// -----[ cuckoo_filter_num_items ]----------------------------------
+uint64_t cuckoo_filter_num_items(gds_cuckoo_filter_t * filter)
+{
+  return filter->num_items;
+}
+
+// -----[ cuckoo_filter_load_factor ]--------------------------------
+/**
+ * \brief Return the fraction of the slots that are used.
+ */
+double cuckoo_filter_load_factor(gds_cuckoo_filter_t * filter)
+{
+  return ((double) filter->num_items) /
+    ((double) filter->num_buckets * CUCKOO_FILTER_BUCKET_SIZE);
+}
+
+// -----[ cuckoo_filter_stats ]--------------------------------------
+/**
+ * \brief Compute the statistics of a filter.
+ *
+ * The false positive rate is estimated from the load factor: a
+ * lookup compares the fingerprint of the key with the (on average)
+ * 2.CUCKOO_FILTER_BUCKET_SIZE.load fingerprints of its two buckets.
+ *
+ * \retval 0 in case of success, -1 if the filter or stats is NULL.
+ */
+int cuckoo_filter_stats(gds_cuckoo_filter_t * filter,
+			gds_cuckoo_filter_stats_t * stats)
+{
+  if ((filter == NULL) || (stats == NULL))
+    return -1;
+
+  stats->num_buckets= filter->num_buckets;
+  stats->fp_bits= filter->fp_bits;
+  stats->num_items= filter->num_items;
+  stats->size= (uint64_t) filter->num_buckets * CUCKOO_FILTER_BUCKET_SIZE *
+    filter->slot_size;
+  stats->load_factor= cuckoo_filter_load_factor(filter);
+  stats->bits_per_item= (filter->num_items > 0) ?
+    stats->size * 8.0 / filter->num_items : HUGE_VAL;
+  stats->fp_rate= 1 - pow(1 - 1.0 / ((1 << filter->fp_bits) - 1),
+			  2 * CUCKOO_FILTER_BUCKET_SIZE * stats->load_factor);
+  return 0;
+}
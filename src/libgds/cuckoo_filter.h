@@ -0,0 +1,73 @@
+// ==================================================================
+// @(#)cuckoo_filter.h
+//
+// Cuckoo filter.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __GDS_CUCKOO_FILTER_H__
+#define __GDS_CUCKOO_FILTER_H__
+
+#include <libgds/types.h>
+
+/** Number of fingerprints per bucket. */
+#define CUCKOO_FILTER_BUCKET_SIZE 4
+/** Load factor for which the filter is sized by the create functions. */
+#define CUCKOO_FILTER_MAX_LOAD    0.95
+/** Maximum number of relocations per insertion. */
+#define CUCKOO_FILTER_MAX_KICKS   500
+/** Maximum fingerprint length in bits. */
+#define CUCKOO_FILTER_MAX_FP_BITS 16
+
+typedef struct gds_cuckoo_filter_t gds_cuckoo_filter_t;
+
+/**
+ * Statistics of a cuckoo filter (see cuckoo_filter_stats()).
+ */
+typedef struct {
+  uint32_t num_buckets;
+  uint32_t fp_bits;        /* fingerprint length in bits */
+  uint64_t num_items;
+  uint64_t size;           /* size of the table in bytes */
+  double   load_factor;    /* num_items / number of slots */
+  double   bits_per_item;
+  double   fp_rate;        /* estimated false positive rate */
+} gds_cuckoo_filter_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ cuckoo_filter_create ]-----------------------------------
+  gds_cuckoo_filter_t * cuckoo_filter_create(uint32_t capacity,
+					     unsigned int fp_bits);
+  // -----[ cuckoo_filter_create_optimal ]---------------------------
+  gds_cuckoo_filter_t * cuckoo_filter_create_optimal(uint32_t capacity,
+						     double fp_rate);
+  // -----[ cuckoo_filter_destroy ]----------------------------------
+  void cuckoo_filter_destroy(gds_cuckoo_filter_t ** filter_ref);
+  // -----[ cuckoo_filter_add ]--------------------------------------
+  int cuckoo_filter_add(gds_cuckoo_filter_t * filter,
+			const uint8_t * key, uint32_t key_len);
+  // -----[ cuckoo_filter_is_member ]--------------------------------
+  int cuckoo_filter_is_member(gds_cuckoo_filter_t * filter,
+			      const uint8_t * key, uint32_t key_len);
+  // -----[ cuckoo_filter_remove ]-----------------------------------
+  int cuckoo_filter_remove(gds_cuckoo_filter_t * filter,
+			   const uint8_t * key, uint32_t key_len);
+  // -----[ cuckoo_filter_num_items ]--------------------------------
+  uint64_t cuckoo_filter_num_items(gds_cuckoo_filter_t * filter);
+  // -----[ cuckoo_filter_load_factor ]------------------------------
+  double cuckoo_filter_load_factor(gds_cuckoo_filter_t * filter);
+  // -----[ cuckoo_filter_stats ]------------------------------------
+  int cuckoo_filter_stats(gds_cuckoo_filter_t * filter,
+			  gds_cuckoo_filter_stats_t * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_CUCKOO_FILTER_H__ */
@@ -17,30 +17,63 @@
 
 // -----[ _dllist_item_create ]--------------------------------------
 static inline
-gds_dllist_item_t * _dllist_item_create(void * user_data,
-					gds_dllist_item_t * prev,
-					gds_dllist_item_t * next)
+gds_dllist_item_t * _dllist_item_create(void * user_data)
 {
   gds_dllist_item_t * item=
     (gds_dllist_item_t *) MALLOC(sizeof(gds_dllist_item_t));
   item->user_data= user_data;
-  item->prev= prev;
-  item->next= next;
+  item->prev= NULL;
+  item->next= NULL;
   return item;
 }
 
+// -----[ _dllist_item_data ]----------------------------------------
+/**
+ * Return the data passed to callbacks for an item: the item itself
+ * in an intrusive list, its user data otherwise.
+ */
+static inline
+void * _dllist_item_data(gds_dllist_t * list, gds_dllist_item_t * item)
+{
+  if (list->intrusive)
+    return item;
+  return item->user_data;
+}
+
 // -----[ _dllist_item_destroy ]-------------------------------------
 static inline
-void _dllist_item_destroy(gds_dllist_item_t ** item_ref,
-			  gds_dllist_destroy_f destroy)
+void _dllist_item_destroy(gds_dllist_t * list, gds_dllist_item_t * item)
 {
-  gds_dllist_item_t * item= *item_ref;
-  if (item == NULL)
-    return;
-  if (destroy != NULL)
-    destroy(item->user_data);
-  FREE(item);
-  *item_ref= NULL;
+  if (list->destroy != NULL)
+    list->destroy(_dllist_item_data(list, item));
+  if (!list->intrusive)
+    FREE(item);
+}
+
+// -----[ _dllist_item_at ]------------------------------------------
+/**
+ * Return the item at the given index, walking from the closest end
+ * of the list.
+ */
+static inline
+gds_dllist_item_t * _dllist_item_at(gds_dllist_t * list,
+				    unsigned int index)
+{
+  gds_dllist_item_t * item;
+
+  if (index >= list->size)
+    return NULL;
+  if (index < list->size / 2) {
+    item= list->root;
+    while (index-- > 0)
+      item= item->next;
+  } else {
+    item= list->tail;
+    index= list->size - 1 - index;
+    while (index-- > 0)
+      item= item->prev;
+  }
+  return item;
 }
 
 // -----[ dllist_create ]--------------------------------------------
@@ -48,10 +81,21 @@ gds_dllist_t * dllist_create(gds_dllist_destroy_f destroy)
 {
   gds_dllist_t * list= (gds_dllist_t *) MALLOC(sizeof(gds_dllist_t));
   list->root= NULL;
+  list->tail= NULL;
+  list->size= 0;
+  list->intrusive= 0;
   list->destroy= destroy;
   return list;
 }
 
+// -----[ dllist_create_intrusive ]----------------------------------
+gds_dllist_t * dllist_create_intrusive(gds_dllist_destroy_f destroy)
+{
+  gds_dllist_t * list= dllist_create(destroy);
+  list->intrusive= 1;
+  return list;
+}
+
 // -----[ dllist_destroy ]-------------------------------------------
 void dllist_destroy(gds_dllist_t ** list_ref)
 {
@@ -64,36 +108,107 @@ void dllist_destroy(gds_dllist_t ** list_ref)
   while (item != NULL) {
     tmp= item;
     item= item->next;
-    _dllist_item_destroy(&tmp, list->destroy);
+    _dllist_item_destroy(list, tmp);
   }
   FREE(list);
   *list_ref= NULL;
 }
 
+// -----[ dllist_insert_before ]-------------------------------------
+void dllist_insert_before(gds_dllist_t * list, gds_dllist_item_t * pos,
+			  gds_dllist_item_t * item)
+{
+  item->next= pos;
+  if (pos == NULL) {
+    item->prev= list->tail;
+    list->tail= item;
+  } else {
+    item->prev= pos->prev;
+    pos->prev= item;
+  }
+  if (item->prev == NULL)
+    list->root= item;
+  else
+    item->prev->next= item;
+  list->size++;
+}
+
+// -----[ dllist_insert_after ]--------------------------------------
+void dllist_insert_after(gds_dllist_t * list, gds_dllist_item_t * pos,
+			 gds_dllist_item_t * item)
+{
+  dllist_insert_before(list, (pos == NULL) ? list->root : pos->next, item);
+}
+
+// -----[ dllist_unlink ]--------------------------------------------
+void dllist_unlink(gds_dllist_t * list, gds_dllist_item_t * item)
+{
+  if (item->prev == NULL)
+    list->root= item->next;
+  else
+    item->prev->next= item->next;
+  if (item->next == NULL)
+    list->tail= item->prev;
+  else
+    item->next->prev= item->prev;
+  item->prev= NULL;
+  item->next= NULL;
+  list->size--;
+}
+
+// -----[ dllist_remove_item ]---------------------------------------
+void dllist_remove_item(gds_dllist_t * list, gds_dllist_item_t * item)
+{
+  dllist_unlink(list, item);
+  _dllist_item_destroy(list, item);
+}
+
+// -----[ dllist_splice ]--------------------------------------------
+int dllist_splice(gds_dllist_t * list, gds_dllist_item_t * pos,
+		  gds_dllist_t * other)
+{
+  gds_dllist_item_t * prev;
+
+  if (list->intrusive != other->intrusive)
+    return -1;
+  if (other->root == NULL)
+    return 0;
+
+  prev= (pos == NULL) ? list->tail : pos->prev;
+  other->root->prev= prev;
+  if (prev == NULL)
+    list->root= other->root;
+  else
+    prev->next= other->root;
+  other->tail->next= pos;
+  if (pos == NULL)
+    list->tail= other->tail;
+  else
+    pos->prev= other->tail;
+  list->size+= other->size;
+
+  other->root= NULL;
+  other->tail= NULL;
+  other->size= 0;
+  return 0;
+}
+
 // -----[ dllist_insert ]--------------------------------------------
 /**
  * Return value:
  *   0 success
- *   -1 invalid index
+ *   -1 invalid index or intrusive list
  */
 int dllist_insert(gds_dllist_t * list, unsigned int index,
 		  void * user_data)
 {
-  gds_dllist_item_t * item;
+  gds_dllist_item_t * pos= NULL;
 
-  if (index == 0) {
-    list->root= _dllist_item_create(user_data, NULL, list->root);
-    return 0;
-  }
-
-  item= list->root;
-  while ((item != NULL) && (index > 1)) {
-    item= item->next;
-    index--;
-  }
-  if (item == NULL)
+  if (list->intrusive || (index > list->size))
     return -1;
-  item->next= _dllist_item_create(user_data, item, item->next);
+  if (index < list->size)
+    pos= _dllist_item_at(list, index);
+  dllist_insert_before(list, pos, _dllist_item_create(user_data));
   return 0;
 }
 
@@ -105,78 +220,43 @@ int dllist_insert(gds_dllist_t * list, unsigned int index,
  */
 int dllist_remove(gds_dllist_t * list, unsigned int index)
 {
-  gds_dllist_item_t * tmp; // Pointer to item to delete
-  gds_dllist_item_t ** item_ref; // Pointer to pointer of item to delete
-
-  // Not even a single item, abort with error
-  if (list->root == NULL)
-    return -1;
+  gds_dllist_item_t * item= _dllist_item_at(list, index);
 
-  item_ref= &(list->root);
-  while ((index > 0) && (*item_ref != NULL)) {
-    // Note: advance pointer to pointer
-    item_ref= &(*item_ref)->next;
-    index--;
-  }
-  if (*item_ref == NULL)
+  if (item == NULL)
     return -1;
-
-  // Keep reference to current item
-  tmp= *item_ref;
-
-  // Update cross-references
-  if ((*item_ref)->next != NULL)
-    (*item_ref)->next->prev= (*item_ref)->prev;
-  *item_ref= (*item_ref)->next;
-
-  // Destroy temporary item
-  _dllist_item_destroy(&tmp, list->destroy);
+  dllist_remove_item(list, item);
   return 0;
 }
 
 // -----[ dllist_append ]--------------------------------------------
-void dllist_append(gds_dllist_t * list, void * user_data)
+gds_dllist_item_t * dllist_append(gds_dllist_t * list, void * user_data)
 {
   gds_dllist_item_t * item;
 
-  if (list->root == NULL) {
-    list->root= _dllist_item_create(user_data, NULL, NULL);
-    return;
-  }
-
-  item= list->root;
-  while (item->next != NULL)
-    item= item->next;
-  item->next= _dllist_item_create(user_data, item, NULL);
+  // The items of an intrusive list are never allocated by the list
+  if (list->intrusive)
+    return NULL;
+  item= _dllist_item_create(user_data);
+  dllist_insert_before(list, NULL, item);
+  return item;
 }
 
 // -----[ dllist_get ]-----------------------------------------------
 int dllist_get(gds_dllist_t * list, unsigned int index,
 	       void ** user_data_ref)
 {
-  gds_dllist_item_t * item= list->root;
+  gds_dllist_item_t * item= _dllist_item_at(list, index);
 
-  while ((index > 0) && (item != NULL)) {
-    item= item->next;
-    index--;
-  }
   if (item == NULL)
     return -1;
-  *user_data_ref= item->user_data;
+  *user_data_ref= _dllist_item_data(list, item);
   return 0;
 }
 
 // -----[ dllist_size ]-----------------------------------------------
 unsigned int dllist_size(gds_dllist_t * list)
 {
-  gds_dllist_item_t * item= list->root;
-  unsigned int size= 0;
-
-  while (item != NULL) {
-    item= item->next;
-    size++;
-  }
-  return size;
+  return list->size;
 }
 
 // -----[ dllist_for_each ]------------------------------------------
@@ -187,7 +267,7 @@ int dllist_for_each(gds_dllist_t * list, void * ctx,
   int result;
 
   while (item != NULL) {
-    result= foreach(item->user_data, ctx);
+    result= foreach(_dllist_item_data(list, item), ctx);
     if (result != 0)
       return result;
     item= item->next;
@@ -17,7 +17,16 @@
 #ifndef __GDS_DLLIST_H__
 #define __GDS_DLLIST_H__
 
+#include <stddef.h>
+
 // -----[ gds_dllist_item_t ]----------------------------------------
+/**
+ * Item of a doubly-linked list.
+ *
+ * In an intrusive list (see dllist_create_intrusive()), the item is
+ * embedded in the user's structure and its user_data field is not
+ * used. The enclosing structure is obtained with DLLIST_ENTRY().
+ */
 typedef struct gds_dllist_item_t {
   struct gds_dllist_item_t * prev;
   struct gds_dllist_item_t * next;
@@ -29,7 +38,10 @@ typedef struct gds_dllist_item_t {
 typedef int  (*gds_dllist_foreach_f)(void * data, void * ctx);
 
 // -----[ gds_dllist_destroy_f ]-------------------------------------
-/** Callback function used to destroy an item in a list. */
+/**
+ * Callback function used to destroy an item in a list. In an
+ * intrusive list, the callback receives the item itself.
+ */
 typedef void (*gds_dllist_destroy_f)(void * user_data);
 
 // -----[ gds_dllist_t ]---------------------------------------------
@@ -38,9 +50,20 @@ typedef void (*gds_dllist_destroy_f)(void * user_data);
  */
 typedef struct {
   gds_dllist_item_t    * root;
+  gds_dllist_item_t    * tail;
+  unsigned int           size;
+  int                    intrusive;
   gds_dllist_destroy_f   destroy;
 } gds_dllist_t;
 
+// -----[ DLLIST_ENTRY ]---------------------------------------------
+/**
+ * Return a pointer to the structure of type TYPE that embeds the
+ * list item ITEM in its field MEMBER.
+ */
+#define DLLIST_ENTRY(ITEM, TYPE, MEMBER)				\
+  ((TYPE *) (((char *) (ITEM)) - offsetof(TYPE, MEMBER)))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -51,6 +74,22 @@ extern "C" {
    */
   gds_dllist_t * dllist_create(gds_dllist_destroy_f destroy);
 
+  // -----[ dllist_create_intrusive ]--------------------------------
+  /**
+   * Create an intrusive doubly-linked list.
+   *
+   * The items are embedded in the user's structures and are never
+   * allocated nor freed by the list. Only the handle-based functions
+   * (dllist_insert_before(), dllist_insert_after(), dllist_unlink(),
+   * ...) can add items to such a list. The destroy and for-each
+   * callbacks as well as dllist_get() pass the item itself instead
+   * of its user data.
+   *
+   * \param destroy is called with each item still in the list when
+   *   the list is destroyed (can be NULL).
+   */
+  gds_dllist_t * dllist_create_intrusive(gds_dllist_destroy_f destroy);
+
   // -----[ dllist_destroy ]-----------------------------------------
   /**
    * Destroy a doubly-linked list.
@@ -58,6 +97,12 @@ extern "C" {
   void dllist_destroy(gds_dllist_t ** list_ref);
 
   // -----[ dllist_insert ]------------------------------------------
+  /**
+   * Insert data at an index of the list.
+   *
+   * \retval 0 in case of success,
+   *   or -1 if the index is invalid or if the list is intrusive.
+   */
   int dllist_insert(gds_dllist_t * list, unsigned int index,
 		    void * data);
 
@@ -65,7 +110,14 @@ extern "C" {
   int dllist_remove(gds_dllist_t * list, unsigned int index);
 
   // -----[ dllist_append ]------------------------------------------
-  void dllist_append(gds_dllist_t * list, void * data);
+  /**
+   * Append data at the end of the list.
+   *
+   * \retval the new item, which can be used as a handle for the
+   *   data (see dllist_remove_item()),
+   *   or NULL if the list is intrusive.
+   */
+  gds_dllist_item_t * dllist_append(gds_dllist_t * list, void * data);
 
   // -----[ dllist_get ]---------------------------------------------
   int dllist_get(gds_dllist_t * list, unsigned int index,
@@ -78,6 +130,84 @@ extern "C" {
   int dllist_for_each(gds_dllist_t * list, void * ctx,
 		      gds_dllist_foreach_f foreach);
 
+  // -----[ dllist_insert_before ]-----------------------------------
+  /**
+   * Link an item before another one, in constant time.
+   *
+   * \param list is the target list.
+   * \param pos is an item of the list, or NULL to insert the item
+   *   at the end of the list.
+   * \param item is the item to be inserted. It must not belong to
+   *   a list.
+   */
+  void dllist_insert_before(gds_dllist_t * list, gds_dllist_item_t * pos,
+			    gds_dllist_item_t * item);
+
+  // -----[ dllist_insert_after ]------------------------------------
+  /**
+   * Link an item after another one, in constant time.
+   *
+   * \param list is the target list.
+   * \param pos is an item of the list, or NULL to insert the item
+   *   at the beginning of the list.
+   * \param item is the item to be inserted. It must not belong to
+   *   a list.
+   */
+  void dllist_insert_after(gds_dllist_t * list, gds_dllist_item_t * pos,
+			   gds_dllist_item_t * item);
+
+  // -----[ dllist_unlink ]------------------------------------------
+  /**
+   * Remove an item from the list, in constant time. The item is
+   * neither destroyed nor freed.
+   *
+   * \param list is the list the item belongs to.
+   * \param item is the item to be removed.
+   */
+  void dllist_unlink(gds_dllist_t * list, gds_dllist_item_t * item);
+
+  // -----[ dllist_remove_item ]-------------------------------------
+  /**
+   * Remove an item from the list and destroy it, in constant time.
+   * The destroy callback is called and, if the list is not
+   * intrusive, the item is freed.
+   *
+   * \param list is the list the item belongs to.
+   * \param item is the item to be removed.
+   */
+  void dllist_remove_item(gds_dllist_t * list, gds_dllist_item_t * item);
+
+  // -----[ dllist_splice ]------------------------------------------
+  /**
+   * Move all the items of a list into another one, in constant time.
+   *
+   * \param list is the target list.
+   * \param pos is an item of the target list before which the items
+   *   are moved, or NULL to move them at the end of the list.
+   * \param other is the source list. It is empty upon return.
+   * \retval 0 in case of success,
+   *   or -1 if both lists are not of the same kind (intrusive or
+   *   not).
+   */
+  int dllist_splice(gds_dllist_t * list, gds_dllist_item_t * pos,
+		    gds_dllist_t * other);
+
+  // -----[ dllist_head ]--------------------------------------------
+  /**
+   * Return the first item of the list, or NULL if the list is empty.
+   */
+  static inline gds_dllist_item_t * dllist_head(gds_dllist_t * list) {
+    return list->root;
+  }
+
+  // -----[ dllist_tail ]--------------------------------------------
+  /**
+   * Return the last item of the list, or NULL if the list is empty.
+   */
+  static inline gds_dllist_item_t * dllist_tail(gds_dllist_t * list) {
+    return list->tail;
+  }
+
 #ifdef __cplusplus
 }
 #endif
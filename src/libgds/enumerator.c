@@ -29,6 +29,7 @@ gds_enum_t * enum_create(void * ctx,
   enu->ops.has_next= has_next;
   enu->ops.get_next= get_next;
   enu->ops.destroy= destroy;
+  enu->ops.get_next_n= NULL;
   return enu;
 }
 
@@ -43,3 +44,20 @@ void enum_destroy(gds_enum_t ** enum_ref)
     *enum_ref= NULL;
   }
 }
+
+// ----- enum_get_next_n --------------------------------------------
+GDS_EXP_DECL
+unsigned int enum_get_next_n(gds_enum_t * enu, void ** items,
+			     unsigned int num)
+{
+  unsigned int index;
+
+  if (enu->ops.get_next_n != NULL)
+    return enu->ops.get_next_n(enu->ctx, items, num);
+  for (index= 0; index < num; index++) {
+    if (!enu->ops.has_next(enu->ctx))
+      break;
+    items[index]= enu->ops.get_next(enu->ctx);
+  }
+  return index;
+}
@@ -23,11 +23,14 @@
 typedef int    (*gds_enum_has_next_f)(void * ctx);
 typedef void * (*gds_enum_get_next_f)(void * ctx);
 typedef void   (*gds_enum_destroy_f) (void * ctx);
+typedef unsigned int (*gds_enum_get_next_n_f)(void * ctx, void ** items,
+					      unsigned int num);
 
 typedef struct {
-  gds_enum_has_next_f  has_next;
-  gds_enum_get_next_f  get_next;
-  gds_enum_destroy_f   destroy;
+  gds_enum_has_next_f    has_next;
+  gds_enum_get_next_f    get_next;
+  gds_enum_destroy_f     destroy;
+  gds_enum_get_next_n_f  get_next_n; /* optional, can be NULL */
 } enum_ops_t;
 
 typedef struct {
@@ -52,6 +55,9 @@ extern "C" {
    * \param destroy
    *   is a callback function that frees the enumerator's  internal
    *   state.
+   *
+   * The optional batched operation (\a ops.get_next_n) is not set.
+   * An implementation can set it after the creation.
    */
   GDS_EXP_DECL gds_enum_t * enum_create(void * ctx,
 					gds_enum_has_next_f has_next,
@@ -64,6 +70,22 @@ extern "C" {
    * \param enum_ref is a pointer to the enumerator.
    */
   GDS_EXP_DECL void enum_destroy(gds_enum_t ** enum_ref);
+
+  // ----- enum_get_next_n --------------------------------------------
+  /**
+   * Return up to \a num next elements at once. This saves an indirect
+   * call per element and per test if the enumerator provides the
+   * batched operation. Otherwise, the elements are obtained one by
+   * one.
+   *
+   * \param enu   is the target enumerator.
+   * \param items is the array where the elements are stored.
+   * \param num   is the size of \a items.
+   * \retval the number of elements stored in \a items. It is less
+   *   than \a num only if the enumeration is over.
+   */
+  GDS_EXP_DECL unsigned int enum_get_next_n(gds_enum_t * enu, void ** items,
+					    unsigned int num);
   
 #ifdef __cplusplus
 }
@@ -94,6 +116,30 @@ static inline void * enum_get_next(gds_enum_t * enu)
   return enu->ops.get_next(enu->ctx);
 }
 
+// ----- GDS_FOREACH ------------------------------------------------
+/**
+ * Traverse a data structure with a cursor. The cursor is a variable
+ * of the cursor type of the data structure (e.g. gds_trie_cursor_t),
+ * usually on the stack, that is initialized by P_cursor_init(&C, X).
+ * The loop runs as long as P_cursor_next(&C, ...) returns a non-zero
+ * value. No memory is allocated and no callback is involved.
+ *
+ * Example:
+ * \code
+ * ptr_array_cursor_t cursor;
+ * void * item;
+ * GDS_FOREACH(ptr_array, cursor, array, &item)
+ *   printf("%p\n", item);
+ * \endcode
+ *
+ * \param P is the prefix of the data structure functions.
+ * \param C is the cursor variable.
+ * \param X is the traversed data structure.
+ * \param ... are the references passed to \c P_cursor_next.
+ */
+#define GDS_FOREACH(P, C, X, ...)					\
+  for (P##_cursor_init(&(C), X); P##_cursor_next(&(C), __VA_ARGS__); )
+
 #define GDS_ENUM_TEMPLATE_TYPE(N,T)					\
   typedef gds_enum_t N##_t;						\
   typedef T (*N##_get_next_func)(void * ctx);
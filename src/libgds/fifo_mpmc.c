@@ -0,0 +1,320 @@
+// ==================================================================
+// @(#)fifo_mpmc.c
+//
+// Lock-free multi-producer/multi-consumer bounded FIFO queue.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * The queue follows D. Vyukov's bounded MPMC queue. It is a ring of
+ * cells. Each cell holds an item and a sequence number that tells
+ * which operation the cell expects next:
+ * - the cell at position pos is free for the producer that claims
+ *   pos when its sequence number equals pos,
+ * - it holds an item for the consumer that claims pos when its
+ *   sequence number equals pos+1.
+ *
+ * Producers (resp. consumers) claim a position by incrementing the
+ * enqueue (resp. dequeue) counter with a compare-and-swap, then fill
+ * (resp. empty) the cell and publish it by storing its next sequence
+ * number with release semantics. The only contended locations are
+ * thus the two counters, which live in separate cache lines.
+ *
+ * Blocking operations first spin for a short while, then sleep on a
+ * futex (on Linux; elsewhere they yield the processor). A thread
+ * that has to sleep increments a waiter counter, then retries once
+ * before sleeping on an event counter. The opposite side only issues
+ * a wake-up system call when the waiter counter is not 0. Both sides
+ * order their counter update and their access to the queue with a
+ * full barrier, so that at least one of them sees the other's update.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <sched.h>
+#include <string.h>
+#ifdef __linux__
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+#include <libgds/fifo_mpmc.h>
+#include <libgds/memory.h>
+
+#define FIFO_MPMC_CACHE_LINE 64
+/** Number of attempts of a blocking operation before it sleeps. */
+#define FIFO_MPMC_SPIN       64
+
+typedef struct {
+  uint32_t   seq;
+  void     * item;
+} _fifo_mpmc_cell_t;
+
+// -----[ _fifo_mpmc_counter_t ]-------------------------------------
+/** Counter alone in its cache line. */
+typedef struct {
+  uint32_t value;
+  uint8_t  padding[FIFO_MPMC_CACHE_LINE-sizeof(uint32_t)];
+} _fifo_mpmc_counter_t;
+
+// -----[ _fifo_mpmc_wait_t ]----------------------------------------
+/** Threads waiting for a condition (queue not full/not empty). */
+typedef struct {
+  uint32_t event;
+  uint32_t waiters;
+  uint8_t  padding[FIFO_MPMC_CACHE_LINE-2*sizeof(uint32_t)];
+} _fifo_mpmc_wait_t;
+
+struct gds_fifo_mpmc_t {
+  _fifo_mpmc_counter_t   enqueue;
+  _fifo_mpmc_counter_t   dequeue;
+  _fifo_mpmc_wait_t      not_full;
+  _fifo_mpmc_wait_t      not_empty;
+  uint32_t               mask;
+  gds_fifo_destroy_f     destroy;
+  _fifo_mpmc_cell_t    * cells;
+  void                 * raw;
+};
+
+#define _load_relaxed(P) __atomic_load_n((P), __ATOMIC_RELAXED)
+#define _load_acquire(P) __atomic_load_n((P), __ATOMIC_ACQUIRE)
+#define _store_release(P,V) __atomic_store_n((P), (V), __ATOMIC_RELEASE)
+
+// -----[ _futex_wait ]----------------------------------------------
+/**
+ * Sleep while the value at addr equals value. May return early.
+ */
+static inline void _futex_wait(uint32_t * addr, uint32_t value)
+{
+#ifdef __linux__
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+  sched_yield();
+#endif
+}
+
+// -----[ _futex_wake ]----------------------------------------------
+static inline void _futex_wake(uint32_t * addr)
+{
+#ifdef __linux__
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#endif
+}
+
+// -----[ _cpu_relax ]-----------------------------------------------
+static inline void _cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#endif
+}
+
+// -----[ _fifo_mpmc_signal ]----------------------------------------
+/**
+ * Wake up one thread waiting for the given condition, if any.
+ */
+static inline void _fifo_mpmc_signal(_fifo_mpmc_wait_t * wait)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (_load_relaxed(&wait->waiters) != 0) {
+    __atomic_add_fetch(&wait->event, 1, __ATOMIC_SEQ_CST);
+    _futex_wake(&wait->event);
+  }
+}
+
+// -----[ fifo_mpmc_create ]-----------------------------------------
+gds_fifo_mpmc_t * fifo_mpmc_create(uint32_t capacity,
+				   gds_fifo_destroy_f destroy)
+{
+  gds_fifo_mpmc_t * fifo;
+  uint32_t size, index;
+  void * raw;
+
+  if ((capacity == 0) || (capacity > FIFO_MPMC_MAX_CAPACITY))
+    return NULL;
+  size= 2;
+  while (size < capacity)
+    size<<= 1;
+
+  // The control structure is aligned on a cache line
+  raw= MALLOC(sizeof(gds_fifo_mpmc_t) + FIFO_MPMC_CACHE_LINE - 1);
+  fifo= (gds_fifo_mpmc_t *)
+    (((size_t) raw + FIFO_MPMC_CACHE_LINE - 1) &
+     ~((size_t) FIFO_MPMC_CACHE_LINE - 1));
+  memset(fifo, 0, sizeof(gds_fifo_mpmc_t));
+  fifo->raw= raw;
+  fifo->mask= size-1;
+  fifo->destroy= destroy;
+  fifo->cells= (_fifo_mpmc_cell_t *) MALLOC(sizeof(_fifo_mpmc_cell_t)*size);
+  for (index= 0; index < size; index++) {
+    fifo->cells[index].seq= index;
+    fifo->cells[index].item= NULL;
+  }
+  return fifo;
+}
+
+// -----[ fifo_mpmc_destroy ]----------------------------------------
+void fifo_mpmc_destroy(gds_fifo_mpmc_t ** fifo_ref)
+{
+  gds_fifo_mpmc_t * fifo= *fifo_ref;
+  void * item;
+
+  if (fifo != NULL) {
+    if (fifo->destroy != NULL)
+      while (fifo_mpmc_try_pop(fifo, &item) == 0)
+	fifo->destroy(&item);
+    FREE(fifo->cells);
+    FREE(fifo->raw);
+    *fifo_ref= NULL;
+  }
+}
+
+// -----[ _fifo_mpmc_try_push ]--------------------------------------
+static inline int _fifo_mpmc_try_push(gds_fifo_mpmc_t * fifo, void * item)
+{
+  _fifo_mpmc_cell_t * cell;
+  uint32_t pos= _load_relaxed(&fifo->enqueue.value);
+  int32_t diff;
+
+  for (;;) {
+    cell= &fifo->cells[pos & fifo->mask];
+    diff= (int32_t) (_load_acquire(&cell->seq) - pos);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&fifo->enqueue.value, &pos, pos+1,
+				      1, __ATOMIC_RELAXED,
+				      __ATOMIC_RELAXED))
+	break;
+    } else if (diff < 0) {
+      return -1; // The cell still holds the item of the previous round
+    } else {
+      pos= _load_relaxed(&fifo->enqueue.value);
+    }
+  }
+  cell->item= item;
+  _store_release(&cell->seq, pos+1);
+  return 0;
+}
+
+// -----[ _fifo_mpmc_try_pop ]---------------------------------------
+static inline int _fifo_mpmc_try_pop(gds_fifo_mpmc_t * fifo,
+				     void ** item_ref)
+{
+  _fifo_mpmc_cell_t * cell;
+  uint32_t pos= _load_relaxed(&fifo->dequeue.value);
+  int32_t diff;
+
+  for (;;) {
+    cell= &fifo->cells[pos & fifo->mask];
+    diff= (int32_t) (_load_acquire(&cell->seq) - (pos+1));
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&fifo->dequeue.value, &pos, pos+1,
+				      1, __ATOMIC_RELAXED,
+				      __ATOMIC_RELAXED))
+	break;
+    } else if (diff < 0) {
+      return -1; // The cell has not been filled yet
+    } else {
+      pos= _load_relaxed(&fifo->dequeue.value);
+    }
+  }
+  *item_ref= cell->item;
+  _store_release(&cell->seq, pos+fifo->mask+1);
+  return 0;
+}
+
+// -----[ fifo_mpmc_try_push ]---------------------------------------
+int fifo_mpmc_try_push(gds_fifo_mpmc_t * fifo, void * item)
+{
+  if (_fifo_mpmc_try_push(fifo, item) < 0)
+    return -1;
+  _fifo_mpmc_signal(&fifo->not_empty);
+  return 0;
+}
+
+// -----[ fifo_mpmc_try_pop ]----------------------------------------
+int fifo_mpmc_try_pop(gds_fifo_mpmc_t * fifo, void ** item_ref)
+{
+  if (_fifo_mpmc_try_pop(fifo, item_ref) < 0)
+    return -1;
+  _fifo_mpmc_signal(&fifo->not_full);
+  return 0;
+}
+
+// -----[ fifo_mpmc_push ]-------------------------------------------
+void fifo_mpmc_push(gds_fifo_mpmc_t * fifo, void * item)
+{
+  unsigned int spin;
+  uint32_t event;
+
+  // Short wait: spin, then let another thread run
+  for (spin= 0; spin < FIFO_MPMC_SPIN; spin++) {
+    if (fifo_mpmc_try_push(fifo, item) == 0)
+      return;
+    _cpu_relax();
+  }
+  sched_yield();
+
+  while (fifo_mpmc_try_push(fifo, item) < 0) {
+    event= __atomic_load_n(&fifo->not_full.event, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&fifo->not_full.waiters, 1, __ATOMIC_SEQ_CST);
+    if (fifo_mpmc_try_push(fifo, item) == 0) {
+      __atomic_sub_fetch(&fifo->not_full.waiters, 1, __ATOMIC_RELAXED);
+      return;
+    }
+    _futex_wait(&fifo->not_full.event, event);
+    __atomic_sub_fetch(&fifo->not_full.waiters, 1, __ATOMIC_RELAXED);
+  }
+}
+
+// -----[ fifo_mpmc_pop ]--------------------------------------------
+void * fifo_mpmc_pop(gds_fifo_mpmc_t * fifo)
+{
+  unsigned int spin;
+  uint32_t event;
+  void * item;
+
+  for (spin= 0; spin < FIFO_MPMC_SPIN; spin++) {
+    if (fifo_mpmc_try_pop(fifo, &item) == 0)
+      return item;
+    _cpu_relax();
+  }
+  sched_yield();
+
+  while (fifo_mpmc_try_pop(fifo, &item) < 0) {
+    event= __atomic_load_n(&fifo->not_empty.event, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&fifo->not_empty.waiters, 1, __ATOMIC_SEQ_CST);
+    if (fifo_mpmc_try_pop(fifo, &item) == 0) {
+      __atomic_sub_fetch(&fifo->not_empty.waiters, 1, __ATOMIC_RELAXED);
+      return item;
+    }
+    _futex_wait(&fifo->not_empty.event, event);
+    __atomic_sub_fetch(&fifo->not_empty.waiters, 1, __ATOMIC_RELAXED);
+  }
+  return item;
+}
+
+// -----[ fifo_mpmc_depth ]------------------------------------------
+uint32_t fifo_mpmc_depth(gds_fifo_mpmc_t * fifo)
+{
+  uint32_t dequeue= _load_acquire(&fifo->dequeue.value);
+  int32_t depth= (int32_t) (_load_acquire(&fifo->enqueue.value) - dequeue);
+
+  if (depth < 0)
+    return 0;
+  if ((uint32_t) depth > fifo->mask + 1)
+    return fifo->mask + 1;
+  return (uint32_t) depth;
+}
+
+// -----[ fifo_mpmc_capacity ]---------------------------------------
+uint32_t fifo_mpmc_capacity(gds_fifo_mpmc_t * fifo)
+{
+  return fifo->mask + 1;
+}
@@ -0,0 +1,110 @@
+// ==================================================================
+// @(#)fifo_mpmc.h
+//
+// Lock-free multi-producer/multi-consumer bounded FIFO queue.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a bounded FIFO queue that can be shared without lock by
+ * any number of producer and consumer threads.
+ *
+ * The non-blocking functions fifo_mpmc_try_push() and
+ * fifo_mpmc_try_pop() fail immediately when the queue is full
+ * (resp. empty). The blocking functions fifo_mpmc_push() and
+ * fifo_mpmc_pop() put the calling thread to sleep until they
+ * succeed.
+ */
+
+#ifndef __GDS_FIFO_MPMC_H__
+#define __GDS_FIFO_MPMC_H__
+
+#include <libgds/fifo.h>
+#include <libgds/types.h>
+
+/** Maximum capacity of a MPMC FIFO queue. */
+#define FIFO_MPMC_MAX_CAPACITY 0x40000000U
+
+typedef struct gds_fifo_mpmc_t gds_fifo_mpmc_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ fifo_mpmc_create ]---------------------------------------
+  /**
+   * Create a MPMC FIFO queue.
+   *
+   * \param capacity is the minimum capacity. It is rounded up to a
+   *   power of two (at least 2).
+   * \param destroy is the destroy callback function (can be NULL).
+   * \retval the new queue,
+   *   or NULL if the capacity is 0 or larger than
+   *   FIFO_MPMC_MAX_CAPACITY.
+   */
+  gds_fifo_mpmc_t * fifo_mpmc_create(uint32_t capacity,
+				     gds_fifo_destroy_f destroy);
+
+  // -----[ fifo_mpmc_destroy ]--------------------------------------
+  /**
+   * Destroy a MPMC FIFO queue.
+   *
+   * If the destroy callback is not NULL, it will be called for each
+   * item in the queue. No thread may use the queue anymore.
+   */
+  void fifo_mpmc_destroy(gds_fifo_mpmc_t ** fifo_ref);
+
+  // -----[ fifo_mpmc_try_push ]-------------------------------------
+  /**
+   * Push an item onto the queue, without blocking.
+   *
+   * \retval 0 if the item could be pushed,
+   *   or <0 if the queue is full.
+   */
+  int fifo_mpmc_try_push(gds_fifo_mpmc_t * fifo, void * item);
+
+  // -----[ fifo_mpmc_try_pop ]--------------------------------------
+  /**
+   * Pop an item from the queue, without blocking.
+   *
+   * \param item_ref is where the popped item is stored.
+   * \retval 0 if an item could be popped,
+   *   or <0 if the queue is empty.
+   */
+  int fifo_mpmc_try_pop(gds_fifo_mpmc_t * fifo, void ** item_ref);
+
+  // -----[ fifo_mpmc_push ]-----------------------------------------
+  /**
+   * Push an item onto the queue. If the queue is full, wait until
+   * an item is popped.
+   */
+  void fifo_mpmc_push(gds_fifo_mpmc_t * fifo, void * item);
+
+  // -----[ fifo_mpmc_pop ]------------------------------------------
+  /**
+   * Pop an item from the queue. If the queue is empty, wait until
+   * an item is pushed.
+   *
+   * \retval the popped item.
+   */
+  void * fifo_mpmc_pop(gds_fifo_mpmc_t * fifo);
+
+  // -----[ fifo_mpmc_depth ]----------------------------------------
+  /**
+   * Return the depth of the queue. When the queue is in use, the
+   * result is only an estimate.
+   */
+  uint32_t fifo_mpmc_depth(gds_fifo_mpmc_t * fifo);
+
+  // -----[ fifo_mpmc_capacity ]-------------------------------------
+  uint32_t fifo_mpmc_capacity(gds_fifo_mpmc_t * fifo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_FIFO_MPMC_H__ */
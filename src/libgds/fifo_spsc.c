@@ -0,0 +1,214 @@
+// ==================================================================
+// @(#)fifo_spsc.c
+//
+// Lock-free single-producer/single-consumer FIFO queue.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * The queue is a ring buffer indexed by two free-running 32-bit
+ * counters: the head, only written by the consumer, and the tail,
+ * only written by the producer. The capacity being a power of two,
+ * the slot of a counter is obtained with a mask and the depth is
+ * simply (tail - head), even when the counters wrap.
+ *
+ * The producer writes an item in its slot, then publishes it with a
+ * release store of the tail. The consumer reads the tail with an
+ * acquire load before reading the slots, and symmetrically releases
+ * the slots it has read by storing the head. The atomic operations
+ * use GCC's __atomic builtins, which follow the C11 memory model.
+ *
+ * The head and the tail live in separate cache lines so that the
+ * producer and the consumer do not write to the same line. Each
+ * side also keeps a private copy of the other side's counter and
+ * only reloads it when the queue looks full (resp. empty), which
+ * avoids most of the cache line transfers.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/fifo_spsc.h>
+#include <libgds/memory.h>
+
+#define FIFO_SPSC_CACHE_LINE 64
+
+// -----[ _fifo_spsc_side_t ]----------------------------------------
+/**
+ * Counter owned by one side of the queue, together with its copy of
+ * the other side's counter. Fills a whole cache line.
+ */
+typedef struct {
+  uint32_t index;
+  uint32_t other;
+  uint8_t  padding[FIFO_SPSC_CACHE_LINE-2*sizeof(uint32_t)];
+} _fifo_spsc_side_t;
+
+struct gds_fifo_spsc_t {
+  _fifo_spsc_side_t    consumer;  /* head */
+  _fifo_spsc_side_t    producer;  /* tail */
+  uint32_t             mask;
+  gds_fifo_destroy_f   destroy;
+  void              ** items;
+  void               * raw;
+};
+
+#define _load_acquire(P) __atomic_load_n((P), __ATOMIC_ACQUIRE)
+#define _store_release(P,V) __atomic_store_n((P), (V), __ATOMIC_RELEASE)
+
+// -----[ fifo_spsc_create ]-----------------------------------------
+gds_fifo_spsc_t * fifo_spsc_create(uint32_t capacity,
+				   gds_fifo_destroy_f destroy)
+{
+  gds_fifo_spsc_t * fifo;
+  uint32_t size;
+  void * raw;
+
+  if ((capacity == 0) || (capacity > FIFO_SPSC_MAX_CAPACITY))
+    return NULL;
+  size= 1;
+  while (size < capacity)
+    size<<= 1;
+
+  // The control structure is aligned on a cache line
+  raw= MALLOC(sizeof(gds_fifo_spsc_t) + FIFO_SPSC_CACHE_LINE - 1);
+  fifo= (gds_fifo_spsc_t *)
+    (((size_t) raw + FIFO_SPSC_CACHE_LINE - 1) &
+     ~((size_t) FIFO_SPSC_CACHE_LINE - 1));
+  memset(fifo, 0, sizeof(gds_fifo_spsc_t));
+  fifo->raw= raw;
+  fifo->mask= size-1;
+  fifo->destroy= destroy;
+  fifo->items= (void **) MALLOC(sizeof(void *)*size);
+  return fifo;
+}
+
+// -----[ fifo_spsc_destroy ]----------------------------------------
+void fifo_spsc_destroy(gds_fifo_spsc_t ** fifo_ref)
+{
+  gds_fifo_spsc_t * fifo= *fifo_ref;
+  uint32_t index;
+
+  if (fifo != NULL) {
+    if (fifo->destroy != NULL)
+      for (index= fifo->consumer.index; index != fifo->producer.index;
+	   index++)
+	fifo->destroy(&fifo->items[index & fifo->mask]);
+    FREE(fifo->items);
+    FREE(fifo->raw);
+    *fifo_ref= NULL;
+  }
+}
+
+// -----[ _fifo_spsc_copy ]------------------------------------------
+/**
+ * Copy items between the ring and a linear array, starting at the
+ * given counter. The copy is split in two when it wraps.
+ */
+static inline void _fifo_spsc_copy(gds_fifo_spsc_t * fifo, uint32_t index,
+				   void ** items, uint32_t num_items,
+				   int to_ring)
+{
+  uint32_t slot= index & fifo->mask;
+  uint32_t first= fifo->mask + 1 - slot;
+
+  if (first > num_items)
+    first= num_items;
+  if (to_ring) {
+    memcpy(&fifo->items[slot], items, first*sizeof(void *));
+    memcpy(fifo->items, items+first, (num_items-first)*sizeof(void *));
+  } else {
+    memcpy(items, &fifo->items[slot], first*sizeof(void *));
+    memcpy(items+first, fifo->items, (num_items-first)*sizeof(void *));
+  }
+}
+
+// -----[ fifo_spsc_push ]-------------------------------------------
+int fifo_spsc_push(gds_fifo_spsc_t * fifo, void * item)
+{
+  uint32_t tail= fifo->producer.index;
+
+  if (tail - fifo->producer.other > fifo->mask) {
+    fifo->producer.other= _load_acquire(&fifo->consumer.index);
+    if (tail - fifo->producer.other > fifo->mask)
+      return -1;
+  }
+  fifo->items[tail & fifo->mask]= item;
+  _store_release(&fifo->producer.index, tail+1);
+  return 0;
+}
+
+// -----[ fifo_spsc_pop ]--------------------------------------------
+int fifo_spsc_pop(gds_fifo_spsc_t * fifo, void ** item_ref)
+{
+  uint32_t head= fifo->consumer.index;
+
+  if (head == fifo->consumer.other) {
+    fifo->consumer.other= _load_acquire(&fifo->producer.index);
+    if (head == fifo->consumer.other)
+      return -1;
+  }
+  *item_ref= fifo->items[head & fifo->mask];
+  _store_release(&fifo->consumer.index, head+1);
+  return 0;
+}
+
+// -----[ fifo_spsc_push_n ]-----------------------------------------
+uint32_t fifo_spsc_push_n(gds_fifo_spsc_t * fifo, void * const * items,
+			  uint32_t num_items)
+{
+  uint32_t tail= fifo->producer.index;
+  uint32_t space= fifo->mask + 1 - (tail - fifo->producer.other);
+
+  if (space < num_items) {
+    fifo->producer.other= _load_acquire(&fifo->consumer.index);
+    space= fifo->mask + 1 - (tail - fifo->producer.other);
+    if (space < num_items)
+      num_items= space;
+  }
+  if (num_items > 0) {
+    _fifo_spsc_copy(fifo, tail, (void **) items, num_items, 1);
+    _store_release(&fifo->producer.index, tail+num_items);
+  }
+  return num_items;
+}
+
+// -----[ fifo_spsc_pop_n ]------------------------------------------
+uint32_t fifo_spsc_pop_n(gds_fifo_spsc_t * fifo, void ** items,
+			 uint32_t num_items)
+{
+  uint32_t head= fifo->consumer.index;
+  uint32_t depth= fifo->consumer.other - head;
+
+  if (depth < num_items) {
+    fifo->consumer.other= _load_acquire(&fifo->producer.index);
+    depth= fifo->consumer.other - head;
+    if (depth < num_items)
+      num_items= depth;
+  }
+  if (num_items > 0) {
+    _fifo_spsc_copy(fifo, head, items, num_items, 0);
+    _store_release(&fifo->consumer.index, head+num_items);
+  }
+  return num_items;
+}
+
+// -----[ fifo_spsc_depth ]------------------------------------------
+uint32_t fifo_spsc_depth(gds_fifo_spsc_t * fifo)
+{
+  uint32_t head= _load_acquire(&fifo->consumer.index);
+  return _load_acquire(&fifo->producer.index) - head;
+}
+
+// -----[ fifo_spsc_capacity ]---------------------------------------
+uint32_t fifo_spsc_capacity(gds_fifo_spsc_t * fifo)
+{
+  return fifo->mask + 1;
+}
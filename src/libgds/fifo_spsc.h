@@ -0,0 +1,114 @@
+// ==================================================================
+// @(#)fifo_spsc.h
+//
+// Lock-free single-producer/single-consumer FIFO queue.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a bounded FIFO queue that can be shared without lock by
+ * exactly one producer thread and one consumer thread.
+ *
+ * Unlike gds_fifo_t, the queue never grows. Its capacity is rounded
+ * up to a power of two.
+ */
+
+#ifndef __GDS_FIFO_SPSC_H__
+#define __GDS_FIFO_SPSC_H__
+
+#include <libgds/fifo.h>
+#include <libgds/types.h>
+
+/** Maximum capacity of a SPSC FIFO queue. */
+#define FIFO_SPSC_MAX_CAPACITY 0x80000000U
+
+typedef struct gds_fifo_spsc_t gds_fifo_spsc_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ fifo_spsc_create ]---------------------------------------
+  /**
+   * Create a SPSC FIFO queue.
+   *
+   * \param capacity is the minimum capacity. It is rounded up to a
+   *   power of two.
+   * \param destroy is the destroy callback function (can be NULL).
+   * \retval the new queue,
+   *   or NULL if the capacity is 0 or larger than
+   *   FIFO_SPSC_MAX_CAPACITY.
+   */
+  gds_fifo_spsc_t * fifo_spsc_create(uint32_t capacity,
+				     gds_fifo_destroy_f destroy);
+
+  // -----[ fifo_spsc_destroy ]--------------------------------------
+  /**
+   * Destroy a SPSC FIFO queue.
+   *
+   * If the destroy callback is not NULL, it will be called for each
+   * item in the queue. Neither the producer nor the consumer may
+   * use the queue anymore.
+   */
+  void fifo_spsc_destroy(gds_fifo_spsc_t ** fifo_ref);
+
+  // -----[ fifo_spsc_push ]-----------------------------------------
+  /**
+   * Push an item onto the queue. Must only be called by the
+   * producer.
+   *
+   * \retval 0 if the item could be pushed,
+   *   or <0 if the queue is full.
+   */
+  int fifo_spsc_push(gds_fifo_spsc_t * fifo, void * item);
+
+  // -----[ fifo_spsc_pop ]------------------------------------------
+  /**
+   * Pop an item from the queue. Must only be called by the
+   * consumer.
+   *
+   * \param item_ref is where the earliest pushed item is stored.
+   * \retval 0 if an item could be popped,
+   *   or <0 if the queue is empty.
+   */
+  int fifo_spsc_pop(gds_fifo_spsc_t * fifo, void ** item_ref);
+
+  // -----[ fifo_spsc_push_n ]---------------------------------------
+  /**
+   * Push up to num_items items onto the queue, as a single
+   * operation. Must only be called by the producer.
+   *
+   * \retval the number of items pushed (limited by the free space).
+   */
+  uint32_t fifo_spsc_push_n(gds_fifo_spsc_t * fifo, void * const * items,
+			    uint32_t num_items);
+
+  // -----[ fifo_spsc_pop_n ]----------------------------------------
+  /**
+   * Pop up to num_items items from the queue, as a single
+   * operation. Must only be called by the consumer.
+   *
+   * \retval the number of items popped (limited by the depth).
+   */
+  uint32_t fifo_spsc_pop_n(gds_fifo_spsc_t * fifo, void ** items,
+			   uint32_t num_items);
+
+  // -----[ fifo_spsc_depth ]----------------------------------------
+  /**
+   * Return the depth of the queue. When the queue is in use, the
+   * result is only a snapshot.
+   */
+  uint32_t fifo_spsc_depth(gds_fifo_spsc_t * fifo);
+
+  // -----[ fifo_spsc_capacity ]-------------------------------------
+  uint32_t fifo_spsc_capacity(gds_fifo_spsc_t * fifo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_FIFO_SPSC_H__ */
@@ -485,6 +485,52 @@ int hash_set_for_each(const gds_hash_set_t * hash,
   return 0;
 }
 
+typedef struct {
+  const gds_hash_set_t * hash;
+  gds_hash_foreach_f     foreach;
+} _hash_parallel_ctx_t;
+
+// -----[ _hash_set_parallel_range ]---------------------------------
+static int _hash_set_parallel_range(unsigned int begin, unsigned int end,
+				    void * part, void * ctx)
+{
+  _hash_parallel_ctx_t * pctx= (_hash_parallel_ctx_t *) ctx;
+  uint32_t key;
+  unsigned int index;
+  ptr_array_t * pHashItems;
+  void * item;
+  int result;
+
+  for (key= begin; key < end; key++) {
+    pHashItems= pctx->hash->items[key];
+    if (pHashItems != NULL) {
+      for (index= 0; index < ptr_array_length(pHashItems); index++) {
+	item= ((hash_elt_t *) pHashItems->data[index])->item;
+	result= pctx->foreach(item, part);
+	if (result < 0)
+	  return result;
+      }
+    }
+  }
+  return 0;
+}
+
+// -----[ hash_set_parallel_for_each ]-------------------------------
+/**
+ * The units of the traversal are the buckets of the hash table.
+ */
+int hash_set_parallel_for_each(const gds_hash_set_t * hash,
+			       gds_pool_t * pool,
+			       gds_hash_foreach_f foreach,
+			       void * ctx,
+			       const gds_pool_reducer_t * reducer,
+			       int options)
+{
+  _hash_parallel_ctx_t pctx= { hash, foreach };
+  return pool_run(pool, hash->size, 0, _hash_set_parallel_range, &pctx,
+		  reducer, ctx, options);
+}
+
 // -----[ hash_set_dump ]--------------------------------------------
 void hash_set_dump(const gds_hash_set_t * hash)
 {
@@ -560,7 +606,6 @@ void * _enum_get_next(void * ctx)
 {
   _enum_ctx_t * enum_ctx= (_enum_ctx_t *) ctx;
   ptr_array_t * pHashItems= NULL;
-  void * item= NULL;
 
   /* Have we already get all the items? */
   if (enum_ctx->index1 >= enum_ctx->hash->size)
@@ -570,9 +615,7 @@ void * _enum_get_next(void * ctx)
   pHashItems= enum_ctx->hash->items[enum_ctx->index1];
   if ((pHashItems != NULL) &&
       (enum_ctx->index2 < ptr_array_length(pHashItems))) {
-    item= ((hash_elt_t *) pHashItems->data[enum_ctx->index2])->item;
-    enum_ctx->index2++;
-    return &item;
+    return &((hash_elt_t *) pHashItems->data[enum_ctx->index2++])->item;
   }
 
   /* We have to return an item from another array of the hash table */
@@ -587,6 +630,28 @@ void * _enum_get_next(void * ctx)
   return NULL;
 }
 
+// -----[ _enum_get_next_n ]-----------------------------------------
+static unsigned int _enum_get_next_n(void * ctx, void ** items,
+				     unsigned int num)
+{
+  _enum_ctx_t * enum_ctx= (_enum_ctx_t *) ctx;
+  ptr_array_t * pHashItems;
+  unsigned int count= 0;
+
+  while ((count < num) && (enum_ctx->index1 < enum_ctx->hash->size)) {
+    pHashItems= enum_ctx->hash->items[enum_ctx->index1];
+    if ((pHashItems != NULL) &&
+	(enum_ctx->index2 < ptr_array_length(pHashItems))) {
+      items[count++]=
+	&((hash_elt_t *) pHashItems->data[enum_ctx->index2++])->item;
+      continue;
+    }
+    enum_ctx->index1++;
+    enum_ctx->index2= 0;
+  }
+  return count;
+}
+
 // -----[ _enum_destroy ]--------------------------------------------
 void _enum_destroy(void * ctx)
 {
@@ -599,11 +664,48 @@ gds_enum_t * hash_set_get_enum(gds_hash_set_t * hash)
 {
   _enum_ctx_t * ctx=
     (_enum_ctx_t *) MALLOC(sizeof(_enum_ctx_t));
+  gds_enum_t * enu;
   ctx->index1= 0;
   ctx->index2= 0;
   ctx->hash= hash;
-  return enum_create(ctx,
-		     _enum_has_next,
-		     _enum_get_next,
-		     _enum_destroy);
+  enu= enum_create(ctx,
+		   _enum_has_next,
+		   _enum_get_next,
+		   _enum_destroy);
+  enu->ops.get_next_n= _enum_get_next_n;
+  return enu;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// CURSOR
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ hash_set_cursor_init ]-------------------------------------
+void hash_set_cursor_init(gds_hash_set_cursor_t * cursor,
+			  gds_hash_set_t * hash)
+{
+  cursor->hash= hash;
+  cursor->index1= 0;
+  cursor->index2= 0;
+}
+
+// -----[ hash_set_cursor_next ]-------------------------------------
+int hash_set_cursor_next(gds_hash_set_cursor_t * cursor, void ** item_ref)
+{
+  ptr_array_t * pHashItems;
+
+  while (cursor->index1 < cursor->hash->size) {
+    pHashItems= cursor->hash->items[cursor->index1];
+    if ((pHashItems != NULL) &&
+	(cursor->index2 < ptr_array_length(pHashItems))) {
+      *item_ref= ((hash_elt_t *) pHashItems->data[cursor->index2++])->item;
+      return 1;
+    }
+    cursor->index1++;
+    cursor->index2= 0;
+  }
+  return 0;
 }
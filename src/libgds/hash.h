@@ -16,6 +16,7 @@
 #define __GDS_HASH_H__
 
 #include <libgds/enumerator.h>
+#include <libgds/pool.h>
 #include <libgds/types.h>
 
 typedef int      (*gds_hash_cmp_f)     (const void * item1,
@@ -28,6 +29,18 @@ typedef int      (*gds_hash_foreach_f) (void * item, void * ctx);
 
 typedef struct gds_hash_set_t gds_hash_set_t;
 
+// -----[ gds_hash_set_cursor_t ]------------------------------------
+/**
+ * Cursor over the items of a hash-set (see GDS_FOREACH). The fields
+ * are private. The hash-set must not be modified during the
+ * traversal.
+ */
+typedef struct {
+  gds_hash_set_t * hash;
+  unsigned int     index1;
+  unsigned int     index2;
+} gds_hash_set_cursor_t;
+
 /** Operation is successful. */
 #define HASH_SUCCESS        0
 /** An item was unreferenced (not removed). */
@@ -122,12 +135,47 @@ extern "C" {
   int hash_set_for_each(const gds_hash_set_t * hash,
 			gds_hash_foreach_f foreach,
 			void * ctx);
+  // -----[ hash_set_parallel_for_each ]-----------------------------
+  /**
+   * Call a callback function for each item of a hash-set, in
+   * parallel (see pool_run()). The buckets are split in ranges of
+   * consecutive buckets.
+   *
+   * \param hash    is the hash-set.
+   * \param pool    is the pool of workers.
+   * \param foreach is the callback function.
+   * \param ctx     is the context pointer.
+   * \param reducer is the description of the partial results, passed
+   *   to \a foreach instead of \a ctx (can be NULL).
+   * \param options is a combination of options (POOL_OPTION_*).
+   * \retval 0 in case of success,
+   *   or the first (in the order of the buckets) negative value
+   *   returned by \a foreach.
+   */
+  int hash_set_parallel_for_each(const gds_hash_set_t * hash,
+				 gds_pool_t * pool,
+				 gds_hash_foreach_f foreach,
+				 void * ctx,
+				 const gds_pool_reducer_t * reducer,
+				 int options);
   // -----[ hash_set_for_each_key ]----------------------------------
   int hash_set_for_each_key(const gds_hash_set_t * hash,
 			    gds_hash_foreach_f foreach, 
 			    void * ctx);
   // -----[ hash_set_get_enum ]--------------------------------------
   gds_enum_t * hash_set_get_enum(gds_hash_set_t * hash);
+  // -----[ hash_set_cursor_init ]-----------------------------------
+  void hash_set_cursor_init(gds_hash_set_cursor_t * cursor,
+			    gds_hash_set_t * hash);
+  // -----[ hash_set_cursor_next ]-----------------------------------
+  /**
+   * Get the next item of a cursor.
+   *
+   * \retval 1 if \a item_ref is set to the next item,
+   *   or 0 if the traversal is over.
+   */
+  int hash_set_cursor_next(gds_hash_set_cursor_t * cursor,
+			   void ** item_ref);
   // -----[ hash_set_dump ]------------------------------------------
   void hash_dump(const gds_hash_set_t * hash);
 
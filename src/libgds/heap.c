@@ -0,0 +1,307 @@
+// ==================================================================
+// @(#)heap.c
+//
+// Priority queue (4-ary heap).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * The heap is an implicit 4-ary tree stored in a contiguous array:
+ * the children of the entry at position i are at positions 4i+1 to
+ * 4i+4. Compared to a binary heap, the tree is half as deep, so that
+ * insertions and updates compare and move fewer entries, and the 4
+ * children that a removal compares are adjacent in memory.
+ *
+ * Each entry holds the item and its handle. The positions array
+ * maps each handle to the current position of its entry and is
+ * updated whenever an entry moves. Handles of removed items are
+ * recycled through a stack of free handles.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libgds/heap.h>
+#include <libgds/memory.h>
+
+#define HEAP_ARITY 4
+
+#define _PARENT(P) (((P)-1)/HEAP_ARITY)
+#define _FIRST_CHILD(P) ((P)*HEAP_ARITY+1)
+
+typedef struct {
+  void              * item;
+  gds_heap_handle_t   handle;
+} _heap_entry_t;
+
+struct gds_heap_t {
+  unsigned int         size;
+  unsigned int         capacity;
+  unsigned int         num_handles;
+  unsigned int         num_free;
+  _heap_entry_t      * entries;
+  uint32_t           * positions;
+  gds_heap_handle_t  * free_handles;
+  gds_heap_cmp_f       cmp;
+  gds_heap_destroy_f   destroy;
+};
+
+// -----[ heap_create ]----------------------------------------------
+gds_heap_t * heap_create(unsigned int capacity, gds_heap_cmp_f cmp,
+			 gds_heap_destroy_f destroy)
+{
+  gds_heap_t * heap= (gds_heap_t *) MALLOC(sizeof(gds_heap_t));
+  if (capacity < HEAP_ARITY)
+    capacity= HEAP_ARITY;
+  heap->size= 0;
+  heap->capacity= capacity;
+  heap->num_handles= 0;
+  heap->num_free= 0;
+  heap->entries= (_heap_entry_t *) MALLOC(capacity*sizeof(_heap_entry_t));
+  heap->positions= (uint32_t *) MALLOC(capacity*sizeof(uint32_t));
+  heap->free_handles= (gds_heap_handle_t *)
+    MALLOC(capacity*sizeof(gds_heap_handle_t));
+  heap->cmp= cmp;
+  heap->destroy= destroy;
+  return heap;
+}
+
+// -----[ heap_destroy ]---------------------------------------------
+void heap_destroy(gds_heap_t ** heap_ref)
+{
+  gds_heap_t * heap= *heap_ref;
+  unsigned int index;
+
+  if (heap == NULL)
+    return;
+  if (heap->destroy != NULL)
+    for (index= 0; index < heap->size; index++)
+      heap->destroy(heap->entries[index].item);
+  FREE(heap->entries);
+  FREE(heap->positions);
+  FREE(heap->free_handles);
+  FREE(heap);
+  *heap_ref= NULL;
+}
+
+// -----[ _heap_reserve ]--------------------------------------------
+static inline void _heap_reserve(gds_heap_t * heap, unsigned int size)
+{
+  if (size <= heap->capacity)
+    return;
+  while (heap->capacity < size)
+    heap->capacity*= 2;
+  heap->entries= (_heap_entry_t *)
+    REALLOC(heap->entries, heap->capacity*sizeof(_heap_entry_t));
+  heap->positions= (uint32_t *)
+    REALLOC(heap->positions, heap->capacity*sizeof(uint32_t));
+  heap->free_handles= (gds_heap_handle_t *)
+    REALLOC(heap->free_handles, heap->capacity*sizeof(gds_heap_handle_t));
+}
+
+// -----[ _heap_new_handle ]-----------------------------------------
+static inline gds_heap_handle_t _heap_new_handle(gds_heap_t * heap)
+{
+  if (heap->num_free > 0)
+    return heap->free_handles[--heap->num_free];
+  return heap->num_handles++;
+}
+
+// -----[ _heap_free_handle ]----------------------------------------
+static inline void _heap_free_handle(gds_heap_t * heap,
+				     gds_heap_handle_t handle)
+{
+  heap->positions[handle]= HEAP_INVALID_HANDLE;
+  heap->free_handles[heap->num_free++]= handle;
+}
+
+// -----[ _heap_set ]------------------------------------------------
+static inline void _heap_set(gds_heap_t * heap, unsigned int pos,
+			     _heap_entry_t entry)
+{
+  heap->entries[pos]= entry;
+  heap->positions[entry.handle]= pos;
+}
+
+// -----[ _heap_sift_up ]--------------------------------------------
+/**
+ * Move the entry at the given position towards the root. Its
+ * ancestors with a lower priority are shifted down one level and
+ * the entry is written once, at its final position.
+ *
+ * Returns the final position.
+ */
+static inline unsigned int _heap_sift_up(gds_heap_t * heap,
+					 unsigned int pos)
+{
+  _heap_entry_t entry= heap->entries[pos];
+  unsigned int parent;
+
+  while (pos > 0) {
+    parent= _PARENT(pos);
+    if (heap->cmp(entry.item, heap->entries[parent].item) >= 0)
+      break;
+    _heap_set(heap, pos, heap->entries[parent]);
+    pos= parent;
+  }
+  _heap_set(heap, pos, entry);
+  return pos;
+}
+
+// -----[ _heap_sift_down ]------------------------------------------
+/**
+ * Move the entry at the given position towards the leaves, swapping
+ * it with its child of highest priority.
+ */
+static inline void _heap_sift_down(gds_heap_t * heap, unsigned int pos)
+{
+  _heap_entry_t entry= heap->entries[pos];
+  unsigned int child, best, last;
+
+  for (;;) {
+    child= _FIRST_CHILD(pos);
+    if (child >= heap->size)
+      break;
+    last= child + HEAP_ARITY;
+    if (last > heap->size)
+      last= heap->size;
+    best= child;
+    for (child++; child < last; child++)
+      if (heap->cmp(heap->entries[child].item,
+		    heap->entries[best].item) < 0)
+	best= child;
+    if (heap->cmp(heap->entries[best].item, entry.item) >= 0)
+      break;
+    _heap_set(heap, pos, heap->entries[best]);
+    pos= best;
+  }
+  _heap_set(heap, pos, entry);
+}
+
+// -----[ heap_insert ]----------------------------------------------
+gds_heap_handle_t heap_insert(gds_heap_t * heap, void * item)
+{
+  gds_heap_handle_t handle;
+
+  _heap_reserve(heap, heap->size+1);
+  handle= _heap_new_handle(heap);
+  heap->entries[heap->size].item= item;
+  heap->entries[heap->size].handle= handle;
+  heap->size++;
+  _heap_sift_up(heap, heap->size-1);
+  return handle;
+}
+
+// -----[ heap_build ]-----------------------------------------------
+/**
+ * Floyd's construction: the items are appended, then every internal
+ * entry is sifted down, from the last one to the root.
+ */
+void heap_build(gds_heap_t * heap, void * const * items,
+		unsigned int num_items, gds_heap_handle_t * handles)
+{
+  unsigned int index, pos;
+  gds_heap_handle_t handle;
+
+  if (num_items == 0)
+    return;
+  _heap_reserve(heap, heap->size+num_items);
+  for (index= 0; index < num_items; index++) {
+    handle= _heap_new_handle(heap);
+    heap->entries[heap->size].item= items[index];
+    heap->entries[heap->size].handle= handle;
+    heap->positions[handle]= heap->size;
+    heap->size++;
+    if (handles != NULL)
+      handles[index]= handle;
+  }
+  if (heap->size < 2)
+    return;
+  pos= _PARENT(heap->size-1)+1;
+  while (pos-- > 0)
+    _heap_sift_down(heap, pos);
+}
+
+// -----[ heap_peek ]------------------------------------------------
+void * heap_peek(gds_heap_t * heap)
+{
+  if (heap->size == 0)
+    return NULL;
+  return heap->entries[0].item;
+}
+
+// -----[ _heap_remove_at ]------------------------------------------
+static inline void * _heap_remove_at(gds_heap_t * heap, unsigned int pos)
+{
+  void * item= heap->entries[pos].item;
+
+  _heap_free_handle(heap, heap->entries[pos].handle);
+  heap->size--;
+  if (pos < heap->size) {
+    // Fill the hole with the last entry
+    _heap_set(heap, pos, heap->entries[heap->size]);
+    if (_heap_sift_up(heap, pos) == pos)
+      _heap_sift_down(heap, pos);
+  }
+  return item;
+}
+
+// -----[ heap_pop ]-------------------------------------------------
+void * heap_pop(gds_heap_t * heap)
+{
+  if (heap->size == 0)
+    return NULL;
+  return _heap_remove_at(heap, 0);
+}
+
+// -----[ _heap_position ]-------------------------------------------
+static inline uint32_t _heap_position(gds_heap_t * heap,
+				      gds_heap_handle_t handle)
+{
+  if (handle >= heap->num_handles)
+    return HEAP_INVALID_HANDLE;
+  return heap->positions[handle];
+}
+
+// -----[ heap_update ]----------------------------------------------
+int heap_update(gds_heap_t * heap, gds_heap_handle_t handle)
+{
+  uint32_t pos= _heap_position(heap, handle);
+
+  if (pos == HEAP_INVALID_HANDLE)
+    return -1;
+  if (_heap_sift_up(heap, pos) == pos)
+    _heap_sift_down(heap, pos);
+  return 0;
+}
+
+// -----[ heap_remove ]----------------------------------------------
+void * heap_remove(gds_heap_t * heap, gds_heap_handle_t handle)
+{
+  uint32_t pos= _heap_position(heap, handle);
+
+  if (pos == HEAP_INVALID_HANDLE)
+    return NULL;
+  return _heap_remove_at(heap, pos);
+}
+
+// -----[ heap_get ]-------------------------------------------------
+void * heap_get(gds_heap_t * heap, gds_heap_handle_t handle)
+{
+  uint32_t pos= _heap_position(heap, handle);
+
+  if (pos == HEAP_INVALID_HANDLE)
+    return NULL;
+  return heap->entries[pos].item;
+}
+
+// -----[ heap_size ]------------------------------------------------
+unsigned int heap_size(gds_heap_t * heap)
+{
+  return heap->size;
+}
@@ -0,0 +1,139 @@
+// ==================================================================
+// @(#)heap.h
+//
+// Priority queue (4-ary heap).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a data structure and functions to manage priority queues.
+ *
+ * The item with the highest priority is the smallest one according
+ * to the comparison function. Each inserted item gets a handle that
+ * remains valid until the item leaves the queue. The handle is used
+ * to update the position of an item whose priority has changed
+ * (e.g. decrease-key in Dijkstra's algorithm) or to remove it.
+ */
+
+#ifndef __GDS_HEAP_H__
+#define __GDS_HEAP_H__
+
+#include <libgds/types.h>
+
+/** Handle of an item in a heap. */
+typedef uint32_t gds_heap_handle_t;
+
+/** Invalid handle. */
+#define HEAP_INVALID_HANDLE MAX_UINT32_T
+
+// -----[ gds_heap_cmp_f ]-------------------------------------------
+/**
+ * Comparison callback function. Returns <0 if item1 has a higher
+ * priority than item2, >0 if it has a lower priority and 0 if both
+ * have the same priority.
+ */
+typedef int (*gds_heap_cmp_f)(const void * item1, const void * item2);
+
+// -----[ gds_heap_destroy_f ]---------------------------------------
+/** Callback function used to destroy an item in a heap. */
+typedef void (*gds_heap_destroy_f)(void * item);
+
+typedef struct gds_heap_t gds_heap_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ heap_create ]--------------------------------------------
+  /**
+   * Create a heap.
+   *
+   * \param capacity is the initial capacity (the heap grows when
+   *   needed).
+   * \param cmp is the comparison callback function.
+   * \param destroy is the destroy callback function (can be NULL).
+   */
+  gds_heap_t * heap_create(unsigned int capacity, gds_heap_cmp_f cmp,
+			   gds_heap_destroy_f destroy);
+
+  // -----[ heap_destroy ]-------------------------------------------
+  /**
+   * Destroy a heap. If the destroy callback is not NULL, it is
+   * called for each item in the heap.
+   */
+  void heap_destroy(gds_heap_t ** heap_ref);
+
+  // -----[ heap_insert ]--------------------------------------------
+  /**
+   * Insert an item.
+   *
+   * \retval the handle of the item.
+   */
+  gds_heap_handle_t heap_insert(gds_heap_t * heap, void * item);
+
+  // -----[ heap_build ]---------------------------------------------
+  /**
+   * Insert several items at once. The heap order is restored once,
+   * in linear time, after all items have been added.
+   *
+   * \param heap is the target heap.
+   * \param items is the array of items to insert.
+   * \param num_items is the number of items.
+   * \param handles is where the handles of the items are stored
+   *   (can be NULL).
+   */
+  void heap_build(gds_heap_t * heap, void * const * items,
+		  unsigned int num_items, gds_heap_handle_t * handles);
+
+  // -----[ heap_peek ]----------------------------------------------
+  /**
+   * Return the item with the highest priority, or NULL if the heap
+   * is empty.
+   */
+  void * heap_peek(gds_heap_t * heap);
+
+  // -----[ heap_pop ]-----------------------------------------------
+  /**
+   * Remove and return the item with the highest priority, or NULL
+   * if the heap is empty.
+   */
+  void * heap_pop(gds_heap_t * heap);
+
+  // -----[ heap_update ]--------------------------------------------
+  /**
+   * Restore the heap order after the priority of an item has
+   * changed (in either direction).
+   *
+   * \retval 0 in case of success,
+   *   or -1 if the handle is not valid.
+   */
+  int heap_update(gds_heap_t * heap, gds_heap_handle_t handle);
+
+  // -----[ heap_remove ]--------------------------------------------
+  /**
+   * Remove an item. The destroy callback is not called.
+   *
+   * \retval the removed item,
+   *   or NULL if the handle is not valid.
+   */
+  void * heap_remove(gds_heap_t * heap, gds_heap_handle_t handle);
+
+  // -----[ heap_get ]-----------------------------------------------
+  /**
+   * Return the item with the given handle, or NULL if the handle is
+   * not valid.
+   */
+  void * heap_get(gds_heap_t * heap, gds_heap_handle_t handle);
+
+  // -----[ heap_size ]----------------------------------------------
+  unsigned int heap_size(gds_heap_t * heap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_HEAP_H__ */
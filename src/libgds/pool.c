@@ -0,0 +1,365 @@
+// ==================================================================
+// @(#)pool.c
+//
+// Pool of worker threads for parallel traversals.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * The workers are persistent threads that sleep on a condition
+ * variable until a traversal (a job) is published. The job number
+ * is incremented for each traversal, so that a worker that wakes up
+ * knows whether it has a new job to run. The thread that runs the
+ * traversal is worker 0: it runs tasks like the others, then waits
+ * until the last worker is done.
+ *
+ * The tasks are numbered from 0. Each worker owns a deque, that is
+ * the range [head, tail) of the task numbers that remain to be run,
+ * protected by its own mutex. The tasks are initially split in one
+ * block of consecutive tasks per worker. A worker takes its next
+ * task from the head of its deque. When its deque is empty, it
+ * steals the upper half of the deque of another worker and makes it
+ * its own. A worker leaves the job when it finds no task to steal:
+ * the tasks that remain are then owned by workers that still run.
+ * A worker never holds two mutexes at the same time.
+ *
+ * The lowest number of a failed task is kept in the job. Workers
+ * skip the tasks with a higher number, whose result would be
+ * ignored anyway.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <libgds/memory.h>
+#include <libgds/pool.h>
+
+#define POOL_CACHE_LINE   64
+/** Number of tasks per worker when no grain is given. */
+#define POOL_TASKS_PER_WORKER 8
+
+// -----[ _pool_deque_t ]--------------------------------------------
+/** Tasks that remain to be run by a worker, alone in its cache
+ * line(s). */
+typedef struct {
+  pthread_mutex_t mutex;
+  unsigned int    head;
+  unsigned int    tail;
+  uint8_t         padding[POOL_CACHE_LINE-
+			  (sizeof(pthread_mutex_t)+2*sizeof(unsigned int))
+			  % POOL_CACHE_LINE];
+} _pool_deque_t;
+
+typedef struct {
+  unsigned int               num_units;
+  unsigned int               grain;
+  gds_pool_range_f           range;
+  void                     * range_ctx;
+  void                     * ctx;
+  uint8_t                  * parts;
+  size_t                     part_size;
+  int                        ordered;
+  unsigned int               failed;   /* lowest failed task */
+  int                        result;   /* result of this task */
+} _pool_job_t;
+
+struct gds_pool_t {
+  unsigned int      num_workers;
+  pthread_t       * threads;
+  _pool_deque_t   * deques;
+  pthread_mutex_t   lock;
+  pthread_cond_t    start;
+  pthread_cond_t    done;
+  unsigned int      job_number;
+  unsigned int      num_running;
+  int               shutdown;
+  _pool_job_t     * job;
+};
+
+typedef struct {
+  gds_pool_t   * pool;
+  unsigned int   index;
+} _pool_thread_ctx_t;
+
+// -----[ _pool_pop ]------------------------------------------------
+static inline int _pool_pop(_pool_deque_t * deque, unsigned int * task)
+{
+  int found= 0;
+
+  pthread_mutex_lock(&deque->mutex);
+  if (deque->head < deque->tail) {
+    *task= deque->head++;
+    found= 1;
+  }
+  pthread_mutex_unlock(&deque->mutex);
+  return found;
+}
+
+// -----[ _pool_steal ]----------------------------------------------
+/**
+ * Move the upper half of the deque of another worker to the (empty)
+ * deque of a worker.
+ */
+static int _pool_steal(gds_pool_t * pool, unsigned int index)
+{
+  _pool_deque_t * victim;
+  unsigned int i, head= 0, tail= 0;
+
+  for (i= 1; i < pool->num_workers; i++) {
+    victim= &pool->deques[(index+i) % pool->num_workers];
+    pthread_mutex_lock(&victim->mutex);
+    if (victim->head < victim->tail) {
+      tail= victim->tail;
+      head= tail-(tail-victim->head+1)/2;
+      victim->tail= head;
+    }
+    pthread_mutex_unlock(&victim->mutex);
+    if (head < tail) {
+      pthread_mutex_lock(&pool->deques[index].mutex);
+      pool->deques[index].head= head;
+      pool->deques[index].tail= tail;
+      pthread_mutex_unlock(&pool->deques[index].mutex);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// -----[ _pool_work ]-----------------------------------------------
+/** Run tasks of a job until no task remains. */
+static void _pool_work(gds_pool_t * pool, _pool_job_t * job,
+		       unsigned int index)
+{
+  unsigned int task, begin, end;
+  void * part;
+  int result;
+
+  while (1) {
+    if (!_pool_pop(&pool->deques[index], &task)) {
+      if (!_pool_steal(pool, index))
+	break;
+      continue;
+    }
+    if (task > __atomic_load_n(&job->failed, __ATOMIC_RELAXED))
+      continue;
+
+    if (job->parts == NULL)
+      part= job->ctx;
+    else if (job->ordered)
+      part= job->parts + task*job->part_size;
+    else
+      part= job->parts + index*job->part_size;
+    begin= task*job->grain;
+    end= (job->num_units-begin > job->grain)?
+      begin+job->grain:job->num_units;
+    result= job->range(begin, end, part, job->range_ctx);
+
+    if (result != 0) {
+      pthread_mutex_lock(&pool->lock);
+      if (task < job->failed) {
+	__atomic_store_n(&job->failed, task, __ATOMIC_RELAXED);
+	job->result= result;
+      }
+      pthread_mutex_unlock(&pool->lock);
+    }
+  }
+}
+
+// -----[ _pool_thread ]---------------------------------------------
+static void * _pool_thread(void * arg)
+{
+  _pool_thread_ctx_t * thread_ctx= (_pool_thread_ctx_t *) arg;
+  gds_pool_t * pool= thread_ctx->pool;
+  unsigned int index= thread_ctx->index;
+  unsigned int job_number= 0;
+  _pool_job_t * job;
+
+  FREE(thread_ctx);
+  pthread_mutex_lock(&pool->lock);
+  while (1) {
+    while ((pool->job_number == job_number) && !pool->shutdown)
+      pthread_cond_wait(&pool->start, &pool->lock);
+    if (pool->shutdown)
+      break;
+    job_number= pool->job_number;
+    job= pool->job;
+    pthread_mutex_unlock(&pool->lock);
+
+    _pool_work(pool, job, index);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->num_running == 0)
+      pthread_cond_signal(&pool->done);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+// -----[ pool_create ]----------------------------------------------
+gds_pool_t * pool_create(unsigned int num_workers)
+{
+  gds_pool_t * pool= (gds_pool_t *) MALLOC(sizeof(gds_pool_t));
+  _pool_thread_ctx_t * thread_ctx;
+  unsigned int index;
+  long num_cpus;
+
+  if (num_workers == 0) {
+    num_cpus= sysconf(_SC_NPROCESSORS_ONLN);
+    num_workers= (num_cpus > 0)?(unsigned int) num_cpus:1;
+  }
+  pool->threads= (pthread_t *) MALLOC(num_workers*sizeof(pthread_t));
+  pool->deques= (_pool_deque_t *)
+    MALLOC(num_workers*sizeof(_pool_deque_t));
+  for (index= 0; index < num_workers; index++) {
+    pthread_mutex_init(&pool->deques[index].mutex, NULL);
+    pool->deques[index].head= 0;
+    pool->deques[index].tail= 0;
+  }
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->job_number= 0;
+  pool->num_running= 0;
+  pool->shutdown= 0;
+  pool->job= NULL;
+
+  // Worker 0 is the thread that runs a traversal. If a thread cannot
+  // be created, the pool has less workers.
+  pool->num_workers= 1;
+  for (index= 1; index < num_workers; index++) {
+    thread_ctx= (_pool_thread_ctx_t *) MALLOC(sizeof(_pool_thread_ctx_t));
+    thread_ctx->pool= pool;
+    thread_ctx->index= index;
+    if (pthread_create(&pool->threads[index], NULL, _pool_thread,
+		       thread_ctx) != 0) {
+      FREE(thread_ctx);
+      break;
+    }
+    pool->num_workers++;
+  }
+  return pool;
+}
+
+// -----[ pool_destroy ]---------------------------------------------
+void pool_destroy(gds_pool_t ** pool_ref)
+{
+  gds_pool_t * pool= *pool_ref;
+  unsigned int index;
+
+  if (pool == NULL)
+    return;
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown= 1;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (index= 1; index < pool->num_workers; index++)
+    pthread_join(pool->threads[index], NULL);
+  for (index= 0; index < pool->num_workers; index++)
+    pthread_mutex_destroy(&pool->deques[index].mutex);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->start);
+  pthread_cond_destroy(&pool->done);
+  FREE(pool->deques);
+  FREE(pool->threads);
+  FREE(pool);
+  *pool_ref= NULL;
+}
+
+// -----[ pool_num_workers ]-----------------------------------------
+unsigned int pool_num_workers(gds_pool_t * pool)
+{
+  return pool->num_workers;
+}
+
+// -----[ pool_run ]-------------------------------------------------
+int pool_run(gds_pool_t * pool, unsigned int num_units,
+	     unsigned int grain, gds_pool_range_f range,
+	     void * range_ctx, const gds_pool_reducer_t * reducer,
+	     void * ctx, int options)
+{
+  _pool_job_t job;
+  unsigned int num_tasks, num_parts, index;
+  unsigned int num_workers= pool->num_workers;
+
+  if (grain == 0) {
+    grain= (num_units+POOL_TASKS_PER_WORKER*num_workers-1)/
+      (POOL_TASKS_PER_WORKER*num_workers);
+    if (grain == 0)
+      grain= 1;
+  }
+  num_tasks= num_units/grain + ((num_units % grain)?1:0);
+
+  job.num_units= num_units;
+  job.grain= grain;
+  job.range= range;
+  job.range_ctx= range_ctx;
+  job.ctx= ctx;
+  job.ordered= (options & POOL_OPTION_ORDERED)?1:0;
+  job.failed= UINT_MAX;
+  job.result= 0;
+
+  // Partial results, each in its own cache line(s)
+  job.parts= NULL;
+  job.part_size= 0;
+  num_parts= 0;
+  if (reducer != NULL) {
+    job.part_size= (reducer->size+POOL_CACHE_LINE-1) &
+      ~((size_t) POOL_CACHE_LINE-1);
+    if (job.part_size == 0)
+      job.part_size= POOL_CACHE_LINE;
+    num_parts= job.ordered?num_tasks:num_workers;
+    if (num_parts > 0) {
+      job.parts= (uint8_t *) MALLOC(num_parts*job.part_size);
+      memset(job.parts, 0, num_parts*job.part_size);
+      if (reducer->init != NULL)
+	for (index= 0; index < num_parts; index++)
+	  reducer->init(job.parts + index*job.part_size, ctx);
+    }
+  }
+
+  // One block of consecutive tasks per worker
+  for (index= 0; index < num_workers; index++) {
+    pthread_mutex_lock(&pool->deques[index].mutex);
+    pool->deques[index].head=
+      (unsigned int) (((uint64_t) num_tasks*index)/num_workers);
+    pool->deques[index].tail=
+      (unsigned int) (((uint64_t) num_tasks*(index+1))/num_workers);
+    pthread_mutex_unlock(&pool->deques[index].mutex);
+  }
+
+  if ((num_workers > 1) && (num_tasks > 1)) {
+    pthread_mutex_lock(&pool->lock);
+    pool->job= &job;
+    pool->job_number++;
+    pool->num_running= num_workers-1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    _pool_work(pool, &job, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->num_running > 0)
+      pthread_cond_wait(&pool->done, &pool->lock);
+    pool->job= NULL;
+    pthread_mutex_unlock(&pool->lock);
+  } else {
+    _pool_work(pool, &job, 0);
+  }
+
+  if (job.parts != NULL) {
+    for (index= 0; index < num_parts; index++)
+      reducer->merge(ctx, job.parts + index*job.part_size);
+    FREE(job.parts);
+  }
+  return job.result;
+}
@@ -0,0 +1,157 @@
+// ==================================================================
+// @(#)pool.h
+//
+// Pool of worker threads for parallel traversals.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a pool of worker threads that runs a range of tasks in
+ * parallel, with work stealing. The data structures use it to
+ * provide a parallel version of their for-each traversal (e.g.
+ * _array_parallel_for_each(), hash_set_parallel_for_each(),
+ * trie_parallel_for_each() and radix_tree_parallel_for_each()).
+ *
+ * A traversal is split in units (the cells of an array, the buckets
+ * of a hash-set, the subtrees of a trie) and the units are grouped
+ * in tasks of consecutive units. Each worker first runs its own
+ * share of the tasks, in order, then steals half of the remaining
+ * tasks of another worker.
+ *
+ * The callback function of a traversal is called concurrently by
+ * the workers. If a reducer is given, each worker (or each task, see
+ * POOL_OPTION_ORDERED) accumulates its own partial result, passed to
+ * the callback function instead of the context pointer. The partial
+ * results are merged in the context once the traversal is over, so
+ * that the callback function needs no synchronization.
+ *
+ * Example (sum of the items of a hash-set):
+ * \code
+ * static void _init(void * part, void * ctx) {
+ *   *((size_t *) part)= 0;
+ * }
+ * static void _merge(void * ctx, void * part) {
+ *   *((size_t *) ctx)+= *((size_t *) part);
+ * }
+ * static int _sum(void * item, void * part) {
+ *   *((size_t *) part)+= (size_t) item;
+ *   return 0;
+ * }
+ * gds_pool_reducer_t reducer= { sizeof(size_t), _init, _merge };
+ * gds_pool_t * pool= pool_create(0);
+ * size_t sum= 0;
+ * hash_set_parallel_for_each(hash, pool, _sum, &sum, &reducer, 0);
+ * pool_destroy(&pool);
+ * \endcode
+ */
+
+#ifndef __GDS_POOL_H__
+#define __GDS_POOL_H__
+
+#include <stddef.h>
+
+#include <libgds/types.h>
+
+/** Option: partial results per task, merged in the order of the
+ * units. */
+#define POOL_OPTION_ORDERED 0x01
+
+typedef struct gds_pool_t gds_pool_t;
+
+// -----[ gds_pool_range_f ]-----------------------------------------
+/**
+ * Callback function that runs the units [begin, end) of a range.
+ *
+ * \param begin is the first unit.
+ * \param end   is the unit after the last one.
+ * \param part  is the partial result of the task, or the context
+ *   pointer of the traversal if there is no reducer.
+ * \param ctx   is the context pointer of the range function.
+ * \retval 0 to continue, or another value to stop the traversal.
+ */
+typedef int (*gds_pool_range_f)(unsigned int begin, unsigned int end,
+				void * part, void * ctx);
+
+// -----[ gds_pool_init_f ]------------------------------------------
+/** Callback function that initializes a partial result. */
+typedef void (*gds_pool_init_f)(void * part, void * ctx);
+
+// -----[ gds_pool_merge_f ]-----------------------------------------
+/** Callback function that merges a partial result in the context. */
+typedef void (*gds_pool_merge_f)(void * ctx, void * part);
+
+// -----[ gds_pool_reducer_t ]---------------------------------------
+/**
+ * Description of the partial results of a parallel traversal.
+ */
+typedef struct {
+  size_t            size;   /* size of a partial result */
+  gds_pool_init_f   init;   /* can be NULL (zeroed partial result) */
+  gds_pool_merge_f  merge;
+} gds_pool_reducer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ pool_create ]--------------------------------------------
+  /**
+   * Create a pool of worker threads.
+   *
+   * \param num_workers is the number of workers (0 for the number of
+   *   processors). The thread that runs a traversal is one of the
+   *   workers: num_workers-1 threads are created.
+   * \retval the new pool.
+   */
+  gds_pool_t * pool_create(unsigned int num_workers);
+
+  // -----[ pool_destroy ]-------------------------------------------
+  /** Destroy a pool of worker threads. The threads are joined. */
+  void pool_destroy(gds_pool_t ** pool_ref);
+
+  // -----[ pool_num_workers ]---------------------------------------
+  unsigned int pool_num_workers(gds_pool_t * pool);
+
+  // -----[ pool_run ]-----------------------------------------------
+  /**
+   * Run a range of units in parallel.
+   *
+   * The units are grouped in tasks of \a grain consecutive units.
+   * The tasks are run by the workers of the pool, the calling thread
+   * being one of them. A pool runs one traversal at a time.
+   *
+   * Without POOL_OPTION_ORDERED, there is one partial result per
+   * worker and the merge order depends on the scheduling. With this
+   * option, there is one partial result per task and the partial
+   * results are merged in the order of the tasks: for a given grain,
+   * the result does not depend on the scheduling.
+   *
+   * \param pool      is the pool.
+   * \param num_units is the number of units.
+   * \param grain     is the number of units per task (0 for a grain
+   *   that gives 8 tasks per worker).
+   * \param range     is the range callback function.
+   * \param range_ctx is the context pointer of \a range.
+   * \param reducer   is the description of the partial results
+   *   (can be NULL, in which case \a range receives \a ctx).
+   * \param ctx       is the context pointer of the traversal, in
+   *   which the partial results are merged.
+   * \param options   is a combination of options (POOL_OPTION_*).
+   * \retval 0 if all the ranges succeeded,
+   *   or the value returned by the failed task with the lowest index.
+   *   The tasks that follow a failed task may be skipped.
+   */
+  int pool_run(gds_pool_t * pool, unsigned int num_units,
+	       unsigned int grain, gds_pool_range_f range,
+	       void * range_ctx, const gds_pool_reducer_t * reducer,
+	       void * ctx, int options);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_POOL_H__ */
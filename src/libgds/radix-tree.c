@@ -16,6 +16,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <libgds/memory.h>
 #include <libgds/radix-tree.h>
@@ -28,6 +29,35 @@ typedef struct _radix_tree_item_t {
   void                      * data;
 } _radix_tree_item_t;
 
+// -----[ _radix_tree_block_t ]--------------------------------------
+/**
+ * Block of contiguous nodes allocated by radix_tree_bulk_load. The
+ * nodes follow the header. They are released with the tree.
+ */
+typedef struct _radix_tree_block_t {
+  struct _radix_tree_block_t * next;
+  unsigned int                 num_nodes;
+} _radix_tree_block_t;
+
+// -----[ _radix_tree_item_free ]------------------------------------
+/**
+ * Free a node, unless it belongs to a block.
+ */
+static inline void _radix_tree_item_free(gds_radix_tree_t * tree,
+					 _radix_tree_item_t * tree_item)
+{
+  _radix_tree_block_t * block= tree->blocks;
+  _radix_tree_item_t * nodes;
+
+  while (block != NULL) {
+    nodes= (_radix_tree_item_t *) (block+1);
+    if ((tree_item >= nodes) && (tree_item < nodes+block->num_nodes))
+      return;
+    block= block->next;
+  }
+  FREE(tree_item);
+}
+
 // ----- radix_tree_item_create -------------------------------------
 /**
  *
@@ -47,10 +77,11 @@ _radix_tree_item_t * radix_tree_item_create(void * data)
  * Remove an item. Remove also all its children if the parameter
  * 'iSingle' is 1.
  */
-void radix_tree_item_destroy(_radix_tree_item_t ** ptree_item,
-			     FRadixTreeDestroy fDestroy,
+void radix_tree_item_destroy(gds_radix_tree_t * tree,
+			     _radix_tree_item_t ** ptree_item,
 			     int iSingle)
 {
+  FRadixTreeDestroy fDestroy= tree->fDestroy;
   gds_stack_t * stack= stack_create(32);
   _radix_tree_item_t * tree_item= *ptree_item;
 
@@ -65,16 +96,15 @@ void radix_tree_item_destroy(_radix_tree_item_t ** ptree_item,
     }
 
     /* Destroy the item. */
-    if ((tree_item->data != NULL) && (fDestroy != NULL)) {
+    if ((tree_item->data != NULL) && (fDestroy != NULL))
       fDestroy(&tree_item->data);
-      tree_item->data= NULL;
-    }
+    tree_item->data= NULL;
 
     /* If the current item is empty (no child) or if we delete all
        child, then free the item's memory. */
     if (((tree_item->left == NULL) && (tree_item->right == NULL)) ||
 	!iSingle) {
-      FREE(tree_item);
+      _radix_tree_item_free(tree, tree_item);
       *ptree_item= NULL;
     }
 
@@ -99,6 +129,7 @@ gds_radix_tree_t * radix_tree_create(uint8_t key_len,
   tree->root= NULL;
   tree->key_len= key_len;
   tree->fDestroy= fDestroy;
+  tree->blocks= NULL;
   return tree;
 }
 
@@ -108,9 +139,16 @@ gds_radix_tree_t * radix_tree_create(uint8_t key_len,
  */
 void radix_tree_destroy(gds_radix_tree_t ** tree_ref)
 {
+  _radix_tree_block_t * block;
+
   if (*tree_ref != NULL) {
     if ((*tree_ref)->root != NULL)
-      radix_tree_item_destroy(&(*tree_ref)->root, (*tree_ref)->fDestroy, 0);
+      radix_tree_item_destroy(*tree_ref, &(*tree_ref)->root, 0);
+    while ((*tree_ref)->blocks != NULL) {
+      block= (*tree_ref)->blocks;
+      (*tree_ref)->blocks= block->next;
+      FREE(block);
+    }
     FREE(*tree_ref);
     *tree_ref= NULL;
   }
@@ -198,7 +236,7 @@ int radix_tree_remove(gds_radix_tree_t * tree, uint32_t key,
   iEmpty= (((*ptree_item)->left == NULL)
 	   && ((*ptree_item)->right == NULL));
 
-  radix_tree_item_destroy(ptree_item, tree->fDestroy, iSingle);
+  radix_tree_item_destroy(tree, ptree_item, iSingle);
 
   /* If the current item is empty (no key below, go up towards the
      radix-tree's root and clear keys until a non-empty is found. */
@@ -209,7 +247,7 @@ int radix_tree_remove(gds_radix_tree_t * tree, uint32_t key,
     if (((*ptree_item)->left == NULL) &&
 	((*ptree_item)->right == NULL) &&
 	((*ptree_item)->data == NULL)) {
-      radix_tree_item_destroy(ptree_item, tree->fDestroy, 1);
+      radix_tree_item_destroy(tree, ptree_item, 1);
     } else
       break;
   }
@@ -295,83 +333,26 @@ void * radix_tree_get_best(gds_radix_tree_t * tree,
   return result;
 }
 
-// -----[ _stack_ctx_t ]---------------------------------------------
-typedef struct {
-  _radix_tree_item_t * tree_item;
-  uint32_t             key;
-  uint8_t              key_len;
-} _stack_ctx_t;
-
-// -----[ _stack_push ]----------------------------------------------
-static inline void _stack_push(gds_stack_t * stack,
-			       _radix_tree_item_t * item,
-			       uint8_t key_len,
-			       uint32_t key)
-{
-  _stack_ctx_t * stack_ctx= (_stack_ctx_t *)
-    MALLOC(sizeof(_stack_ctx_t));
-  stack_ctx->tree_item= item;
-  stack_ctx->key_len= key_len;
-  stack_ctx->key= key;
-  assert(stack_push(stack, stack_ctx) >= 0);
-}
-
-// -----[ _stack_pop ]-----------------------------------------------
-static inline void _stack_pop(gds_stack_t * stack,
-			      _radix_tree_item_t ** tree_item,
-			      uint8_t * key_len,
-			      uint32_t * key)
-{
-  _stack_ctx_t * stack_ctx= (_stack_ctx_t *) stack_pop(stack);
-  *tree_item= stack_ctx->tree_item;
-  *key_len= stack_ctx->key_len;
-  *key= stack_ctx->key;
-  FREE(stack_ctx);
-}
-
 // ----- radix_tree_for_each ----------------------------------------
 /**
- * Call the 'fForEach' function for each non empty node.
+ * Call the 'fForEach' function for each non empty node, in the order
+ * of the keys.
  */
 int radix_tree_for_each(gds_radix_tree_t * tree,
 			FRadixTreeForEach fForEach,
 			void * ctx)
 {
-  gds_stack_t * stack= stack_create(tree->key_len);
-  _radix_tree_item_t * tree_item;
-  int result= 0;
+  gds_radix_tree_cursor_t cursor;
+  int result;
   uint32_t key;
   uint8_t key_len;
+  void * data;
 
-  tree_item= tree->root;
-  key= 0;
-  key_len= 0;
-
-  // Depth first search
-  while (tree_item != NULL) {
-    if (tree_item->data!= NULL) {
-      result= fForEach(key, key_len, tree_item->data, ctx);
-      if (result != 0)
-	return result;
-    }
-    if (tree_item->left != NULL) {
-      if (tree_item->right != NULL)
-	_stack_push(stack, tree_item->right, key_len+1,
-		    key+(1 << (tree->key_len-key_len-1)));
-      tree_item= tree_item->left;
-      key_len++;
-    } else if (tree_item->right != NULL) {
-      tree_item= tree_item->right;
-      key= key+(1 << (tree->key_len-key_len-1));
-      key_len++;
-    } else {
-      if (stack_depth(stack) > 0)
-	_stack_pop(stack, &tree_item, &key_len, &key);
-      else
-	break;
-    }
+  GDS_FOREACH(radix_tree, cursor, tree, &key, &key_len, &data) {
+    result= fForEach(key, key_len, data, ctx);
+    if (result != 0)
+      return result;
   }
-  stack_destroy(&stack);
   return 0;
 }
 
@@ -397,88 +378,756 @@ int radix_tree_num_nodes(gds_radix_tree_t * tree, int with_data)
 }
 
 
+/////////////////////////////////////////////////////////////////////
+//
+// BULK LOADING
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _radix_tree_bulk_cmp ]-------------------------------------
+/**
+ * Compare two normalized items (keys aligned on the most significant
+ * bit and masked): smaller keys first, then shorter keys first.
+ */
+static int _radix_tree_bulk_cmp(const void * item1, const void * item2)
+{
+  const gds_radix_tree_bulk_item_t * i1=
+    (const gds_radix_tree_bulk_item_t *) item1;
+  const gds_radix_tree_bulk_item_t * i2=
+    (const gds_radix_tree_bulk_item_t *) item2;
+
+  if (i1->key < i2->key)
+    return -1;
+  if (i1->key > i2->key)
+    return 1;
+  if (i1->key_len < i2->key_len)
+    return -1;
+  if (i1->key_len > i2->key_len)
+    return 1;
+  return 0;
+}
+
+// -----[ _radix_tree_bulk_lcp ]-------------------------------------
+/**
+ * Return the length of the longest common prefix of two normalized
+ * items.
+ */
+static inline uint8_t
+_radix_tree_bulk_lcp(const gds_radix_tree_bulk_item_t * item1,
+		     const gds_radix_tree_bulk_item_t * item2)
+{
+  uint8_t lcp= (item1->key_len < item2->key_len)?
+    item1->key_len:item2->key_len;
+  uint32_t diff= item1->key ^ item2->key;
+
+  if ((diff != 0) && (__builtin_clz(diff) < lcp))
+    lcp= __builtin_clz(diff);
+  return lcp;
+}
+
+// -----[ radix_tree_bulk_load ]-------------------------------------
+/**
+ * Nodes are created in key order, i.e. in the order of a preorder
+ * traversal. The path to the previous key is kept so that each key
+ * only creates the nodes below its longest common prefix with the
+ * previous key.
+ */
+int radix_tree_bulk_load(gds_radix_tree_t * tree,
+			 const gds_radix_tree_bulk_item_t * items,
+			 unsigned int num_items)
+{
+  gds_radix_tree_bulk_item_t * sorted;
+  _radix_tree_item_t * path[33];
+  _radix_tree_block_t * block;
+  _radix_tree_item_t * next, * tree_item;
+  unsigned int index, num_nodes;
+  uint8_t depth, lcp;
+  int is_sorted= 1;
+  int cmp;
+
+  if (num_items == 0)
+    return 0;
+
+  // Non-empty tree: add the items one by one, up to the first
+  // invalid one
+  if (tree->root != NULL) {
+    for (index= 0; index < num_items; index++) {
+      if ((items[index].key_len > tree->key_len) ||
+	  (radix_tree_get_exact(tree, items[index].key,
+				items[index].key_len) != NULL))
+	return -1;
+      if (radix_tree_add(tree, items[index].key, items[index].key_len,
+			 items[index].data) < 0)
+	return -1;
+    }
+    return 0;
+  }
+
+  // Normalize keys (align on the most significant bit and mask) in
+  // order to compare them.
+  sorted= (gds_radix_tree_bulk_item_t *)
+    MALLOC(num_items*sizeof(gds_radix_tree_bulk_item_t));
+  for (index= 0; index < num_items; index++) {
+    if (items[index].key_len > tree->key_len) {
+      FREE(sorted);
+      return -1;
+    }
+    sorted[index].key= (uint32_t) (((uint64_t) items[index].key) <<
+				   (32-tree->key_len));
+    if (items[index].key_len == 0)
+      sorted[index].key= 0;
+    else
+      sorted[index].key&= ~((uint32_t) 0) << (32-items[index].key_len);
+    sorted[index].key_len= items[index].key_len;
+    sorted[index].data= items[index].data;
+    if ((index > 0) &&
+	(_radix_tree_bulk_cmp(&sorted[index-1], &sorted[index]) >= 0))
+      is_sorted= 0;
+  }
+  if (!is_sorted)
+    qsort(sorted, num_items, sizeof(gds_radix_tree_bulk_item_t),
+	  _radix_tree_bulk_cmp);
+
+  // Count the nodes (and check for duplicates)
+  num_nodes= sorted[0].key_len+1;
+  for (index= 1; index < num_items; index++) {
+    cmp= _radix_tree_bulk_cmp(&sorted[index-1], &sorted[index]);
+    if (cmp == 0) {
+      FREE(sorted);
+      return -1;
+    }
+    num_nodes+= sorted[index].key_len -
+      _radix_tree_bulk_lcp(&sorted[index-1], &sorted[index]);
+  }
+
+  block= (_radix_tree_block_t *) MALLOC(sizeof(_radix_tree_block_t) +
+					num_nodes*sizeof(_radix_tree_item_t));
+  block->next= tree->blocks;
+  block->num_nodes= num_nodes;
+  tree->blocks= block;
+  next= (_radix_tree_item_t *) (block+1);
+
+  next->left= NULL;
+  next->right= NULL;
+  next->data= NULL;
+  path[0]= next++;
+  tree->root= path[0];
+  lcp= 0;
+  for (index= 0; index < num_items; index++) {
+    if (index > 0)
+      lcp= _radix_tree_bulk_lcp(&sorted[index-1], &sorted[index]);
+    for (depth= lcp+1; depth <= sorted[index].key_len; depth++) {
+      tree_item= next++;
+      tree_item->left= NULL;
+      tree_item->right= NULL;
+      tree_item->data= NULL;
+      if (sorted[index].key & (((uint32_t) 1) << (32-depth)))
+	path[depth-1]->right= tree_item;
+      else
+	path[depth-1]->left= tree_item;
+      path[depth]= tree_item;
+    }
+    path[sorted[index].key_len]->data= sorted[index].data;
+  }
+  assert(next == ((_radix_tree_item_t *) (block+1)) + num_nodes);
+
+  FREE(sorted);
+  return 0;
+}
+
 /////////////////////////////////////////////////////////////////////
 //
 // ENUMERATION
 //
 /////////////////////////////////////////////////////////////////////
 
-// -----[ _enum_ctx_t ]----------------------------------------------
+// -----[ radix_tree_cursor_init ]-----------------------------------
+void radix_tree_cursor_init(gds_radix_tree_cursor_t * cursor,
+			    gds_radix_tree_t * tree)
+{
+  radix_tree_cursor_init_prefix(cursor, tree, 0, 0);
+}
+
+// -----[ radix_tree_cursor_init_prefix ]----------------------------
+/**
+ * The node that holds the prefix is found by following the bits of
+ * the prefix from the root.
+ */
+void radix_tree_cursor_init_prefix(gds_radix_tree_cursor_t * cursor,
+				   gds_radix_tree_t * tree,
+				   uint32_t key, uint8_t key_len)
+{
+  _radix_tree_item_t * item= tree->root;
+  uint8_t index;
+
+  cursor->key_len= tree->key_len;
+  cursor->depth= 0;
+  if (key_len > tree->key_len)
+    return;
+  for (index= 0; (index < key_len) && (item != NULL); index++) {
+    if (key & (1U << (tree->key_len-index-1)))
+      item= item->right;
+    else
+      item= item->left;
+  }
+  if (item == NULL)
+    return;
+  cursor->stack[0].item= item;
+  cursor->stack[0].key= (key_len == 0)?0:
+    (key & ((0xffffffffU >> (32-key_len)) << (tree->key_len-key_len)));
+  cursor->stack[0].key_len= key_len;
+  cursor->depth= 1;
+}
+
+// -----[ _radix_tree_cursor_next_item ]-----------------------------
+/**
+ * Depth-first traversal, the node first, then the left (0) and the
+ * right (1) children. The stack holds at most one right child per
+ * level and the two children of the last node, hence at most 33
+ * nodes for 32-bit keys.
+ */
+static inline
+_radix_tree_item_t * _radix_tree_cursor_next_item(gds_radix_tree_cursor_t * cursor,
+						  uint32_t * key_ref,
+						  uint8_t * key_len_ref)
+{
+  _radix_tree_item_t * item;
+  uint32_t key;
+  uint8_t key_len;
+
+  while (cursor->depth > 0) {
+    cursor->depth--;
+    item= cursor->stack[cursor->depth].item;
+    key= cursor->stack[cursor->depth].key;
+    key_len= cursor->stack[cursor->depth].key_len;
+    if (item->right != NULL) {
+      cursor->stack[cursor->depth].item= item->right;
+      cursor->stack[cursor->depth].key=
+	key | (1U << (cursor->key_len-key_len-1));
+      cursor->stack[cursor->depth].key_len= key_len+1;
+      cursor->depth++;
+    }
+    if (item->left != NULL) {
+      cursor->stack[cursor->depth].item= item->left;
+      cursor->stack[cursor->depth].key= key;
+      cursor->stack[cursor->depth].key_len= key_len+1;
+      cursor->depth++;
+    }
+    if (item->data != NULL) {
+      *key_ref= key;
+      *key_len_ref= key_len;
+      return item;
+    }
+  }
+  return NULL;
+}
+
+// -----[ radix_tree_cursor_next ]-----------------------------------
+int radix_tree_cursor_next(gds_radix_tree_cursor_t * cursor,
+			   uint32_t * key_ref, uint8_t * key_len_ref,
+			   void ** data_ref)
+{
+  _radix_tree_item_t * item;
+  uint32_t key;
+  uint8_t key_len;
+
+  item= _radix_tree_cursor_next_item(cursor, &key, &key_len);
+  if (item == NULL)
+    return 0;
+  if (key_ref != NULL)
+    *key_ref= key;
+  if (key_len_ref != NULL)
+    *key_len_ref= key_len;
+  if (data_ref != NULL)
+    *data_ref= item->data;
+  return 1;
+}
+
+// -----[ _radix_tree_split_t ]--------------------------------------
+/** Unit of a parallel traversal: a whole subtree or a single node. */
 typedef struct {
-  gds_radix_tree_t   * tree;
-  gds_stack_t        * stack;
-  _radix_tree_item_t * tree_item;
+  _radix_tree_item_t * item;
   uint32_t             key;
   uint8_t              key_len;
-  void              ** data;
+  int                  subtree;
+} _radix_tree_split_t;
+
+typedef struct {
+  _radix_tree_split_t * splits;
+  uint8_t               key_len;
+  FRadixTreeForEach     fForEach;
+} _radix_tree_parallel_ctx_t;
+
+// -----[ _radix_tree_split_add ]------------------------------------
+static inline void _radix_tree_split_add(_radix_tree_split_t * split,
+					 _radix_tree_item_t * item,
+					 uint32_t key, uint8_t key_len,
+					 int subtree)
+{
+  split->item= item;
+  split->key= key;
+  split->key_len= key_len;
+  split->subtree= subtree;
+}
+
+// -----[ _radix_tree_split ]----------------------------------------
+/**
+ * Split a radix-tree in units, in the order of the keys. Each pass
+ * replaces each subtree by its root node (if it has data) and the
+ * subtrees of its children, until there are at least \a num_splits
+ * units or no subtree can be split further.
+ */
+static _radix_tree_split_t * _radix_tree_split(gds_radix_tree_t * tree,
+					       unsigned int num_splits,
+					       unsigned int * num_ref)
+{
+  _radix_tree_split_t * splits, * new_splits, * split;
+  unsigned int num= 0, new_num, index;
+  int split_done;
+
+  splits= (_radix_tree_split_t *) MALLOC(sizeof(_radix_tree_split_t));
+  if (tree->root != NULL) {
+    _radix_tree_split_add(&splits[0], tree->root, 0, 0, 1);
+    num= 1;
+  }
+  split_done= 1;
+  while (split_done && (num > 0) && (num < num_splits)) {
+    new_splits= (_radix_tree_split_t *)
+      MALLOC(3*num*sizeof(_radix_tree_split_t));
+    new_num= 0;
+    split_done= 0;
+    for (index= 0; index < num; index++) {
+      split= &splits[index];
+      if (!split->subtree ||
+	  ((split->item->left == NULL) && (split->item->right == NULL))) {
+	new_splits[new_num++]= *split;
+	continue;
+      }
+      split_done= 1;
+      if (split->item->data != NULL)
+	_radix_tree_split_add(&new_splits[new_num++], split->item,
+			      split->key, split->key_len, 0);
+      if (split->item->left != NULL)
+	_radix_tree_split_add(&new_splits[new_num++], split->item->left,
+			      split->key, split->key_len+1, 1);
+      if (split->item->right != NULL)
+	_radix_tree_split_add(&new_splits[new_num++], split->item->right,
+			      split->key |
+			      (1U << (tree->key_len-split->key_len-1)),
+			      split->key_len+1, 1);
+    }
+    FREE(splits);
+    splits= new_splits;
+    num= new_num;
+  }
+  *num_ref= num;
+  return splits;
+}
+
+// -----[ _radix_tree_parallel_range ]-------------------------------
+static int _radix_tree_parallel_range(unsigned int begin,
+				      unsigned int end,
+				      void * part, void * ctx)
+{
+  _radix_tree_parallel_ctx_t * pctx= (_radix_tree_parallel_ctx_t *) ctx;
+  gds_radix_tree_cursor_t cursor;
+  _radix_tree_split_t * split;
+  _radix_tree_item_t * item;
+  unsigned int index;
+  uint32_t key;
+  uint8_t key_len;
+  int result;
+
+  for (index= begin; index < end; index++) {
+    split= &pctx->splits[index];
+    if (!split->subtree) {
+      result= pctx->fForEach(split->key, split->key_len,
+			     split->item->data, part);
+      if (result != 0)
+	return result;
+      continue;
+    }
+    cursor.key_len= pctx->key_len;
+    cursor.stack[0].item= split->item;
+    cursor.stack[0].key= split->key;
+    cursor.stack[0].key_len= split->key_len;
+    cursor.depth= 1;
+    while ((item= _radix_tree_cursor_next_item(&cursor, &key,
+					       &key_len)) != NULL) {
+      result= pctx->fForEach(key, key_len, item->data, part);
+      if (result != 0)
+	return result;
+    }
+  }
+  return 0;
+}
+
+// -----[ radix_tree_parallel_for_each ]-----------------------------
+/**
+ * The tree is split in about 8 units per worker, each unit being
+ * run by a cursor.
+ */
+int radix_tree_parallel_for_each(gds_radix_tree_t * tree,
+				 gds_pool_t * pool,
+				 FRadixTreeForEach fForEach,
+				 void * ctx,
+				 const gds_pool_reducer_t * reducer,
+				 int options)
+{
+  _radix_tree_parallel_ctx_t pctx;
+  unsigned int num_splits;
+  int result;
+
+  pctx.splits= _radix_tree_split(tree, 8*pool_num_workers(pool),
+				 &num_splits);
+  pctx.key_len= tree->key_len;
+  pctx.fForEach= fForEach;
+  result= pool_run(pool, num_splits, 1, _radix_tree_parallel_range,
+		   &pctx, reducer, ctx, options);
+  FREE(pctx.splits);
+  return result;
+}
+
+// -----[ _enum_ctx_t ]----------------------------------------------
+typedef struct {
+  gds_radix_tree_cursor_t   cursor;
+  _radix_tree_item_t      * next;
 } _enum_ctx_t;
 
 // -----[ _radix_tree_enum_has_next ]--------------------------------
 static int _radix_tree_enum_has_next(void * ctx)
 {
   _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
+  uint32_t key;
+  uint8_t key_len;
 
-  // Depth first search
-  while ((ectx->data == NULL) && (ectx->tree_item != NULL)) {
-
-    if (ectx->tree_item->data != NULL)
-      ectx->data= &ectx->tree_item->data;
-
-    // Move to next item
-    if (ectx->tree_item->left != NULL) {
-      if (ectx->tree_item->right != NULL)
-	_stack_push(ectx->stack, ectx->tree_item->right, ectx->key_len+1,
-		    ectx->key+(1 << (ectx->tree->key_len-ectx->key_len-1)));
-      ectx->tree_item= ectx->tree_item->left;
-      ectx->key_len++;
-    } else if (ectx->tree_item->right != NULL) {
-      ectx->tree_item= ectx->tree_item->right;
-      ectx->key= ectx->key+(1 << (ectx->tree->key_len-ectx->key_len-1));
-      ectx->key_len++;
-    } else {
-      if (stack_depth(ectx->stack) > 0)
-	_stack_pop(ectx->stack, &ectx->tree_item, &ectx->key_len, &ectx->key);
-      else
-	ectx->tree_item= NULL;
-    }
-  }
-  return (ectx->data != NULL);
+  if (ectx->next == NULL)
+    ectx->next= _radix_tree_cursor_next_item(&ectx->cursor, &key, &key_len);
+  return (ectx->next != NULL);
 }
 
 // -----[ _radix_tree_enum_get_next ]--------------------------------
 static void * _radix_tree_enum_get_next(void * ctx)
 {
   _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
-  void * data= NULL;
+  _radix_tree_item_t * item;
+
+  if (!_radix_tree_enum_has_next(ctx))
+    return NULL;
+  item= ectx->next;
+  ectx->next= NULL;
+  return &item->data;
+}
+
+// -----[ _radix_tree_enum_get_next_n ]------------------------------
+static unsigned int _radix_tree_enum_get_next_n(void * ctx, void ** items,
+						unsigned int num)
+{
+  _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
+  _radix_tree_item_t * item;
+  unsigned int count= 0;
+  uint32_t key;
+  uint8_t key_len;
 
-  if (_radix_tree_enum_has_next(ctx)) {
-    data= ectx->data;
-    ectx->data= NULL;
+  if ((num > 0) && (ectx->next != NULL)) {
+    items[count++]= &ectx->next->data;
+    ectx->next= NULL;
   }
-  return data;
+  while ((count < num) &&
+	 ((item= _radix_tree_cursor_next_item(&ectx->cursor, &key,
+					      &key_len)) != NULL))
+    items[count++]= &item->data;
+  return count;
 }
 
 // -----[ _radix_tree_enum_destroy ]---------------------------------
 static void _radix_tree_enum_destroy(void * ctx)
 {
   _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
-  stack_destroy(&ectx->stack);
   FREE(ectx);
 }
 
-// -----[ radix_tree_get_enum ]--------------------------------------
-gds_enum_t * radix_tree_get_enum(gds_radix_tree_t * tree)
+// -----[ radix_tree_get_prefix_enum ]-------------------------------
+gds_enum_t * radix_tree_get_prefix_enum(gds_radix_tree_t * tree,
+					uint32_t key, uint8_t key_len)
 {
   _enum_ctx_t * ectx=
     (_enum_ctx_t *) MALLOC(sizeof(_enum_ctx_t));
-  ectx->tree= tree;
-  ectx->stack= stack_create(tree->key_len);
-  ectx->tree_item= tree->root;
-  ectx->key= 0;
-  ectx->key_len= 0;
-  ectx->data= NULL;
-  return enum_create(ectx,
-		     _radix_tree_enum_has_next,
-		     _radix_tree_enum_get_next,
-		     _radix_tree_enum_destroy);
+  gds_enum_t * enu;
+  radix_tree_cursor_init_prefix(&ectx->cursor, tree, key, key_len);
+  ectx->next= NULL;
+  enu= enum_create(ectx,
+		   _radix_tree_enum_has_next,
+		   _radix_tree_enum_get_next,
+		   _radix_tree_enum_destroy);
+  enu->ops.get_next_n= _radix_tree_enum_get_next_n;
+  return enu;
+}
+
+// -----[ radix_tree_get_enum ]--------------------------------------
+gds_enum_t * radix_tree_get_enum(gds_radix_tree_t * tree)
+{
+  return radix_tree_get_prefix_enum(tree, 0, 0);
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// DIR-24-8 LOOKUP TABLE
+//
+/////////////////////////////////////////////////////////////////////
+
+#define _DIR24_8_NO_CHUNK 0xffffffffu
+
+// -----[ _dir24_8_nh_t ]--------------------------------------------
+/** Reverse mapping from a data pointer to its next-hop index. */
+typedef struct {
+  void     * data;
+  uint32_t   index;
+} _dir24_8_nh_t;
+
+// -----[ _dir24_8_nh_cmp ]------------------------------------------
+static int _dir24_8_nh_cmp(const void * item1, const void * item2,
+			   unsigned int item_size)
+{
+  const _dir24_8_nh_t * nh1= (const _dir24_8_nh_t *) item1;
+  const _dir24_8_nh_t * nh2= (const _dir24_8_nh_t *) item2;
+  if (nh1->data < nh2->data)
+    return -1;
+  if (nh1->data > nh2->data)
+    return 1;
+  return 0;
+}
+
+// -----[ _dir24_8_nh_compute ]--------------------------------------
+static uint32_t _dir24_8_nh_compute(const void * item,
+				    unsigned int hash_size)
+{
+  size_t key= (size_t) ((const _dir24_8_nh_t *) item)->data;
+  return (uint32_t) (((key >> 3) * 2654435761u) % hash_size);
+}
+
+// -----[ _dir24_8_nh_destroy ]--------------------------------------
+static void _dir24_8_nh_destroy(void * item)
+{
+  FREE(item);
+}
+
+// -----[ _dir24_8_nexthop ]-----------------------------------------
+/**
+ * Return the next-hop index of a data pointer. A new index is
+ * allocated the first time a data pointer is seen.
+ */
+static uint32_t _dir24_8_nexthop(gds_dir24_8_t * table, void * data)
+{
+  _dir24_8_nh_t search= { .data= data };
+  _dir24_8_nh_t * nh;
+
+  if (data == NULL)
+    return 0;
+
+  nh= (_dir24_8_nh_t *) hash_set_search(table->nexthops_index, &search);
+  if (nh != NULL)
+    return nh->index;
+
+  nh= (_dir24_8_nh_t *) MALLOC(sizeof(_dir24_8_nh_t));
+  nh->data= data;
+  nh->index= ptr_array_append(table->nexthops, data);
+  assert(nh->index < DIR24_8_EXT_FLAG);
+  hash_set_add(table->nexthops_index, nh);
+  return nh->index;
+}
+
+// -----[ _dir24_8_chunk_alloc ]-------------------------------------
+static uint32_t _dir24_8_chunk_alloc(gds_dir24_8_t * table)
+{
+  uint32_t chunk;
+
+  if (table->tbl8_free != _DIR24_8_NO_CHUNK) {
+    chunk= table->tbl8_free;
+    table->tbl8_free= table->tbl8[chunk << 8];
+    return chunk;
+  }
+
+  if (table->tbl8_used >= table->tbl8_size) {
+    table->tbl8_size= (table->tbl8_size == 0)?16:table->tbl8_size*2;
+    assert(table->tbl8_size <= DIR24_8_EXT_FLAG);
+    table->tbl8= (uint32_t *) REALLOC(table->tbl8,
+				      (size_t) table->tbl8_size *
+				      DIR24_8_TBL8_SIZE * sizeof(uint32_t));
+  }
+  return table->tbl8_used++;
+}
+
+// -----[ _dir24_8_chunk_free ]--------------------------------------
+/**
+ * Release a chunk. Free chunks are chained through their first
+ * entry.
+ */
+static inline void _dir24_8_chunk_free(gds_dir24_8_t * table,
+				       uint32_t chunk)
+{
+  table->tbl8[chunk << 8]= table->tbl8_free;
+  table->tbl8_free= chunk;
+}
+
+// -----[ _dir24_8_fill ]--------------------------------------------
+/**
+ * Set all the entries covered by the prefix 'key/depth' to the
+ * next-hop index 'hop'. If the prefix is longer than 24 bits, the
+ * corresponding first level entry must already point to a chunk.
+ */
+static void _dir24_8_fill(gds_dir24_8_t * table, uint32_t key,
+			  uint8_t depth, uint32_t hop)
+{
+  uint32_t index, count, entry;
+
+  if (depth <= 24) {
+    index= key >> 8;
+    count= 1u << (24-depth);
+    while (count-- > 0) {
+      entry= table->tbl24[index];
+      if (entry & DIR24_8_EXT_FLAG)
+	_dir24_8_chunk_free(table, entry & ~DIR24_8_EXT_FLAG);
+      table->tbl24[index++]= hop;
+    }
+  } else {
+    entry= table->tbl24[key >> 8];
+    assert(entry & DIR24_8_EXT_FLAG);
+    index= ((entry & ~DIR24_8_EXT_FLAG) << 8) | (key & 0xff);
+    count= 1u << (32-depth);
+    while (count-- > 0)
+      table->tbl8[index++]= hop;
+  }
+}
+
+// -----[ _dir24_8_paint ]-------------------------------------------
+/**
+ * Recompute all the entries covered by the prefix 'key/depth' which
+ * corresponds to the radix-tree node 'tree_item' (that can be NULL).
+ * The next-hop index 'hop' is the one of the longest prefix that
+ * strictly covers 'key/depth'.
+ */
+static void _dir24_8_paint(gds_dir24_8_t * table,
+			   _radix_tree_item_t * tree_item,
+			   uint32_t key, uint8_t depth, uint32_t hop)
+{
+  uint32_t * entry;
+
+  if (tree_item == NULL) {
+    _dir24_8_fill(table, key, depth, hop);
+    return;
+  }
+
+  if (tree_item->data != NULL)
+    hop= _dir24_8_nexthop(table, tree_item->data);
+
+  if ((depth == 32) ||
+      ((tree_item->left == NULL) && (tree_item->right == NULL))) {
+    _dir24_8_fill(table, key, depth, hop);
+    return;
+  }
+
+  // More specific prefixes below /24 require a second level chunk
+  if (depth == 24) {
+    entry= &table->tbl24[key >> 8];
+    if (!(*entry & DIR24_8_EXT_FLAG))
+      *entry= _dir24_8_chunk_alloc(table) | DIR24_8_EXT_FLAG;
+  }
+
+  _dir24_8_paint(table, tree_item->left, key, depth+1, hop);
+  _dir24_8_paint(table, tree_item->right, key | (1u << (31-depth)),
+		 depth+1, hop);
+}
+
+// -----[ radix_tree_compile_dir24_8 ]-------------------------------
+gds_dir24_8_t * radix_tree_compile_dir24_8(gds_radix_tree_t * tree)
+{
+  gds_dir24_8_t * table;
+  void * no_data= NULL;
+
+  if (tree->key_len != 32)
+    return NULL;
+
+  table= (gds_dir24_8_t *) MALLOC(sizeof(gds_dir24_8_t));
+  table->tree= tree;
+  table->tbl24= (uint32_t *) MALLOC(DIR24_8_TBL24_SIZE * sizeof(uint32_t));
+  table->tbl8= NULL;
+  table->tbl8_size= 0;
+  table->tbl8_used= 0;
+  table->tbl8_free= _DIR24_8_NO_CHUNK;
+  table->nexthops= ptr_array_create_ref(0);
+  table->nexthops_index= hash_set_create(65536, 0,
+					 _dir24_8_nh_cmp,
+					 _dir24_8_nh_destroy,
+					 _dir24_8_nh_compute);
+
+  // Next-hop index 0 means "no match"
+  ptr_array_append(table->nexthops, no_data);
+
+  // Clear the first level so that no entry is mistaken for a chunk
+  // reference before the whole key space is painted.
+  memset(table->tbl24, 0, DIR24_8_TBL24_SIZE * sizeof(uint32_t));
+  _dir24_8_paint(table, tree->root, 0, 0, 0);
+  return table;
+}
+
+// -----[ dir24_8_destroy ]------------------------------------------
+void dir24_8_destroy(gds_dir24_8_t ** table_ref)
+{
+  gds_dir24_8_t * table= *table_ref;
+
+  if (table != NULL) {
+    FREE(table->tbl24);
+    if (table->tbl8 != NULL)
+      FREE(table->tbl8);
+    ptr_array_destroy(&table->nexthops);
+    hash_set_destroy(&table->nexthops_index);
+    FREE(table);
+    *table_ref= NULL;
+  }
+}
+
+// -----[ dir24_8_update ]-------------------------------------------
+int dir24_8_update(gds_dir24_8_t * table, uint32_t key, uint8_t key_len)
+{
+  _radix_tree_item_t * tree_item= table->tree->root;
+  uint8_t depth= 0;
+  uint32_t hop= 0;
+
+  if (key_len > 32)
+    return -1;
+
+  // Prefixes longer than 24 bits only affect a single chunk
+  if (key_len > 24)
+    key_len= 24;
+  key&= ~(0xffffffffu >> key_len);
+
+  // Find the node that corresponds to the prefix (if any) and the
+  // longest prefix that strictly covers it.
+  while ((tree_item != NULL) && (depth < key_len)) {
+    if (tree_item->data != NULL)
+      hop= _dir24_8_nexthop(table, tree_item->data);
+    if (key & (1u << (31-depth)))
+      tree_item= tree_item->right;
+    else
+      tree_item= tree_item->left;
+    depth++;
+  }
+
+  _dir24_8_paint(table, tree_item, key, key_len, hop);
+  return 0;
+}
+
+// -----[ dir24_8_num_chunks ]---------------------------------------
+unsigned int dir24_8_num_chunks(gds_dir24_8_t * table)
+{
+  unsigned int num_chunks= table->tbl8_used;
+  uint32_t chunk= table->tbl8_free;
+
+  while (chunk != _DIR24_8_NO_CHUNK) {
+    num_chunks--;
+    chunk= table->tbl8[chunk << 8];
+  }
+  return num_chunks;
 }
@@ -12,7 +12,10 @@
 #ifndef __GDS_RADIX_TREE_H__
 #define __GDS_RADIX_TREE_H__
 
+#include <libgds/array.h>
 #include <libgds/enumerator.h>
+#include <libgds/hash.h>
+#include <libgds/pool.h>
 #include <libgds/types.h>
 
 // ----- pointer to free function for radix-tree items --------------
@@ -26,8 +29,66 @@ typedef struct gds_radix_tree_t {
   struct _radix_tree_item_t * root;
   uint8_t                     key_len;
   FRadixTreeDestroy           fDestroy;
+  struct _radix_tree_block_t * blocks;
 } gds_radix_tree_t;
 
+// -----[ gds_radix_tree_cursor_t ]----------------------------------
+/**
+ * Cursor over the nodes with data of a radix-tree, in the order of
+ * the keys, a prefix coming before the longer prefixes it contains
+ * (see GDS_FOREACH). The fields are private. The cursor holds a
+ * fixed stack: no memory is allocated. The tree must not be
+ * modified during the traversal.
+ */
+typedef struct {
+  struct {
+    struct _radix_tree_item_t * item;
+    uint32_t                    key;
+    uint8_t                     key_len;
+  }                             stack[33];
+  unsigned int                  depth;
+  uint8_t                       key_len;
+} gds_radix_tree_cursor_t;
+
+// -----[ gds_radix_tree_bulk_item_t ]-------------------------------
+/**
+ * Item of an array passed to \c radix_tree_bulk_load.
+ */
+typedef struct {
+  uint32_t   key;
+  uint8_t    key_len;
+  void     * data;
+} gds_radix_tree_bulk_item_t;
+
+/** Number of entries in the first level of a DIR-24-8 table. */
+#define DIR24_8_TBL24_SIZE (1 << 24)
+/** Number of entries in a second level chunk of a DIR-24-8 table. */
+#define DIR24_8_TBL8_SIZE  (1 << 8)
+/** Flag set in first level entries that point to a second level
+ * chunk (the remaining bits are the chunk index). */
+#define DIR24_8_EXT_FLAG   0x80000000u
+
+// -----[ gds_dir24_8_t ]--------------------------------------------
+/**
+ * DIR-24-8 lookup table compiled from a radix-tree with 32-bit keys.
+ *
+ * The first level is indexed by the 24 most significant bits of the
+ * key. Its entries either contain a next-hop index or, if more
+ * specific prefixes exist, the index of a 256-entry second level
+ * chunk indexed by the 8 least significant bits. Next-hop indices
+ * refer to the \a nexthops array (index 0 means no match).
+ */
+typedef struct gds_dir24_8_t {
+  gds_radix_tree_t * tree;
+  uint32_t         * tbl24;
+  uint32_t         * tbl8;
+  uint32_t           tbl8_size;
+  uint32_t           tbl8_used;
+  uint32_t           tbl8_free;
+  ptr_array_t      * nexthops;
+  gds_hash_set_t   * nexthops_index;
+} gds_dir24_8_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -40,6 +101,32 @@ extern "C" {
   // ----- radix_tree_add ---------------------------------------------
   int radix_tree_add(gds_radix_tree_t * tree, uint32_t key,
 		     uint8_t key_len, void * data);
+  // -----[ radix_tree_bulk_load ]------------------------------------
+  /**
+   * Load an array of items in a radix-tree.
+   *
+   * If the tree is empty, it is built in a single pass, with all its
+   * nodes allocated in one contiguous block. The build is fastest
+   * when the items are sorted by key (most significant bits first,
+   * then shorter keys first). Otherwise, the items are sorted in a
+   * private copy. The array itself is never modified.
+   *
+   * If the tree is not empty, the items are added one by one with
+   * \c radix_tree_add. The load stops at the first key that is too
+   * long or that is already in the tree (including a key that appears
+   * earlier in the array). The items that precede it remain loaded
+   * and the existing keys are left unchanged.
+   *
+   * \param tree      is the radix-tree.
+   * \param items     is the array of items.
+   * \param num_items is the number of items.
+   * \retval 0 in case of success, or <0 if a key is longer than the
+   *   tree's key length or if a key appears more than once (in an
+   *   empty tree, nothing is loaded in this case).
+   */
+  int radix_tree_bulk_load(gds_radix_tree_t * tree,
+			   const gds_radix_tree_bulk_item_t * items,
+			   unsigned int num_items);
   // ----- radix_tree_remove ------------------------------------------
   int radix_tree_remove(gds_radix_tree_t * tree, uint32_t key,
 			uint8_t key_len, int iSingle);
@@ -55,11 +142,138 @@ extern "C" {
   int radix_tree_for_each(gds_radix_tree_t * tree,
 			  FRadixTreeForEach fForEach,
 			  void * ctx);
+  // -----[ radix_tree_parallel_for_each ]---------------------------
+  /**
+   * Call a callback function for each non empty node, in parallel
+   * (see pool_run()). The tree is split in units (subtrees and
+   * single nodes) in the order of the keys.
+   *
+   * \param tree     is the radix-tree.
+   * \param pool     is the pool of workers.
+   * \param fForEach is the callback function.
+   * \param ctx      is the context pointer.
+   * \param reducer  is the description of the partial results,
+   *   passed to \a fForEach instead of \a ctx (can be NULL).
+   * \param options  is a combination of options (POOL_OPTION_*).
+   * \retval 0 in case of success, or the first (in the order of the
+   *   keys) non-zero value returned by \a fForEach.
+   */
+  int radix_tree_parallel_for_each(gds_radix_tree_t * tree,
+				   gds_pool_t * pool,
+				   FRadixTreeForEach fForEach,
+				   void * ctx,
+				   const gds_pool_reducer_t * reducer,
+				   int options);
   
   // ----- radix_tree_num_nodes ---------------------------------------
   int radix_tree_num_nodes(gds_radix_tree_t * tree, int with_data);
   // -----[ radix_tree_get_enum ]--------------------------------------
+  /**
+   * Return an enumeration for the items in the tree. Each element is
+   * a pointer to the data of a node. The nodes are enumerated lazily,
+   * in the order of the keys (see gds_radix_tree_cursor_t): the tree
+   * must not be modified while the enumeration is in use.
+   */
   gds_enum_t * radix_tree_get_enum(gds_radix_tree_t * tree);
+  // -----[ radix_tree_get_prefix_enum ]-------------------------------
+  /**
+   * Return an enumeration for the items whose key starts with a given
+   * prefix, i.e. the prefix itself and the more specific prefixes it
+   * contains. The enumeration directly starts at the node that holds
+   * the prefix.
+   *
+   * \param tree    is the radix-tree.
+   * \param key     is the prefix.
+   * \param key_len is the prefix length (0 matches all the keys).
+   */
+  gds_enum_t * radix_tree_get_prefix_enum(gds_radix_tree_t * tree,
+					  uint32_t key, uint8_t key_len);
+  // -----[ radix_tree_cursor_init ]---------------------------------
+  void radix_tree_cursor_init(gds_radix_tree_cursor_t * cursor,
+			      gds_radix_tree_t * tree);
+  // -----[ radix_tree_cursor_init_prefix ]--------------------------
+  /**
+   * Initialize a cursor over the items whose key starts with a given
+   * prefix (see radix_tree_get_prefix_enum()).
+   */
+  void radix_tree_cursor_init_prefix(gds_radix_tree_cursor_t * cursor,
+				     gds_radix_tree_t * tree,
+				     uint32_t key, uint8_t key_len);
+  // -----[ radix_tree_cursor_next ]---------------------------------
+  /**
+   * Get the next node with data of a cursor.
+   *
+   * \param cursor      is the cursor.
+   * \param key_ref     is set to the key of the node (can be NULL).
+   * \param key_len_ref is set to the key length (can be NULL).
+   * \param data_ref    is set to the data of the node (can be NULL).
+   * \retval 1 if a node is returned,
+   *   or 0 if the traversal is over.
+   */
+  int radix_tree_cursor_next(gds_radix_tree_cursor_t * cursor,
+			     uint32_t * key_ref, uint8_t * key_len_ref,
+			     void ** data_ref);
+
+  // -----[ radix_tree_compile_dir24_8 ]-------------------------------
+  /**
+   * Build a DIR-24-8 lookup table from a radix-tree.
+   *
+   * The table answers longest-match lookups of full 32-bit keys in at
+   * most two table accesses. The table keeps a reference to the
+   * radix-tree. When prefixes are later added to or removed from the
+   * tree, \c dir24_8_update must be called to patch the table.
+   *
+   * \param tree is the radix-tree (its key length must be 32).
+   * \retval a new lookup table,
+   *   or NULL if the tree's key length is not 32.
+   */
+  gds_dir24_8_t * radix_tree_compile_dir24_8(gds_radix_tree_t * tree);
+
+  // -----[ dir24_8_destroy ]------------------------------------------
+  /**
+   * Destroy a DIR-24-8 lookup table. The radix-tree is not affected.
+   *
+   * \param table_ref is a pointer to the table to be destroyed.
+   */
+  void dir24_8_destroy(gds_dir24_8_t ** table_ref);
+
+  // -----[ dir24_8_update ]-------------------------------------------
+  /**
+   * Patch a DIR-24-8 lookup table after the prefix \a key / \a key_len
+   * was added to or removed from the radix-tree.
+   *
+   * Only the table entries covered by the prefix are recomputed.
+   *
+   * \param table   is the lookup table.
+   * \param key     is the added/removed prefix.
+   * \param key_len is the length of the prefix.
+   * \retval 0 in case of success, or <0 if the prefix length is
+   *   invalid.
+   */
+  int dir24_8_update(gds_dir24_8_t * table, uint32_t key, uint8_t key_len);
+
+  // -----[ dir24_8_num_chunks ]---------------------------------------
+  /**
+   * Return the number of second level chunks in use.
+   */
+  unsigned int dir24_8_num_chunks(gds_dir24_8_t * table);
+
+  // -----[ dir24_8_lookup ]-------------------------------------------
+  /**
+   * Perform a longest-match lookup of a full 32-bit key.
+   *
+   * \param table is the lookup table.
+   * \param key   is the searched key.
+   * \retval the data associated with the best matching prefix,
+   *   or NULL if no prefix matches.
+   */
+  static inline void * dir24_8_lookup(gds_dir24_8_t * table, uint32_t key)
+  {
+    uint32_t entry= table->tbl24[key >> 8];
+    if (entry & DIR24_8_EXT_FLAG)
+      entry= table->tbl8[((entry & ~DIR24_8_EXT_FLAG) << 8) | (key & 0xff)];
+    return table->nexthops->data[entry];
+  }
   
 #ifdef __cplusplus
 }
@@ -0,0 +1,1398 @@
+// ==================================================================
+// @(#)roaring.c
+//
+// Compressed bitmap (Roaring).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * A Roaring bitmap stores a set of 32-bit integers. The universe is
+ * split in chunks of 2^16 values that share the same 16 most
+ * significant bits (the key). Only non-empty chunks are stored, in a
+ * sorted array of keys. The 16 least significant bits of the values
+ * of a chunk are stored in a container of one of three types:
+ * - an array container is a sorted array of at most
+ *   ROARING_ARRAY_MAX 16-bit values (sparse chunks);
+ * - a bitmap container is a bitmap of 2^16 bits (dense chunks);
+ * - a run container is a sorted list of runs [start, start+length]
+ *   (chunks with long runs of consecutive values). Run containers
+ *   are only created by roaring_run_optimize() and by
+ *   roaring_deserialize().
+ *
+ * Array and bitmap containers are converted to each other when the
+ * number of values crosses ROARING_ARRAY_MAX. The results of the
+ * binary operations are array or bitmap containers.
+ *
+ * The serialization format is the portable format of the reference
+ * Roaring implementations (all integers are little endian):
+ * - without run containers: cookie 12346 (32 bits) followed by the
+ *   number of containers (32 bits);
+ * - with run containers: cookie 12347 | (number of containers-1) << 16
+ *   (32 bits) followed by a bitset with one bit per container that
+ *   tells if it is a run container;
+ * - for each container, its key and its cardinality-1 (16 bits each);
+ * - if there is no run container or if there are at least 4
+ *   containers, the offset of each container in the buffer (32 bits);
+ * - the containers: runs are stored as the number of runs followed by
+ *   (start, length) pairs, containers with at most ROARING_ARRAY_MAX
+ *   values as sorted arrays and the others as 1024 64-bit words.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/memory.h>
+#include <libgds/roaring.h>
+
+#define _ARRAY   0
+#define _BITMAP  1
+#define _RUN     2
+
+#define _BITMAP_WORDS (65536/64)
+
+#define _SERIAL_COOKIE_NO_RUN  12346
+#define _SERIAL_COOKIE         12347
+#define _NO_OFFSET_THRESHOLD   4
+
+typedef enum {
+  _OP_AND,
+  _OP_OR,
+  _OP_XOR,
+  _OP_ANDNOT,
+} _op_t;
+
+typedef struct {
+  uint16_t start;
+  uint16_t length;  /* the run covers [start, start+length] */
+} _run_t;
+
+typedef struct {
+  uint8_t    type;
+  uint32_t   card;
+  uint32_t   num;       /* number of values (array) or runs (run) */
+  uint32_t   capacity;  /* allocated values (array) or runs (run) */
+  union {
+    uint16_t * values;
+    uint64_t * words;
+    _run_t   * runs;
+  } u;
+} _container_t;
+
+struct gds_roaring_t {
+  uint16_t     * keys;
+  _container_t * containers;
+  uint32_t       size;
+  uint32_t       capacity;
+};
+
+/////////////////////////////////////////////////////////////////////
+//
+// WORDS (bitmap containers)
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _words_set_range ]-----------------------------------------
+/** Set the bits in [start, end]. */
+static inline void _words_set_range(uint64_t * words, uint32_t start,
+				    uint32_t end)
+{
+  uint32_t first= start / 64, last= end / 64, index;
+  uint64_t first_mask= ~((uint64_t) 0) << (start % 64);
+  uint64_t last_mask= ~((uint64_t) 0) >> (63 - (end % 64));
+
+  if (first == last) {
+    words[first]|= first_mask & last_mask;
+    return;
+  }
+  words[first]|= first_mask;
+  for (index= first+1; index < last; index++)
+    words[index]= ~((uint64_t) 0);
+  words[last]|= last_mask;
+}
+
+// -----[ _words_next ]----------------------------------------------
+/**
+ * Return the first bit at or after start that is set (or clear if
+ * complement is 1), or -1 if there is none.
+ */
+static inline int32_t _words_next(const uint64_t * words, uint32_t start,
+				  int complement)
+{
+  uint32_t index= start / 64;
+  uint64_t word;
+  uint64_t flip= complement ? ~((uint64_t) 0) : 0;
+
+  if (start >= 65536)
+    return -1;
+  word= (words[index] ^ flip) & (~((uint64_t) 0) << (start % 64));
+  while (word == 0) {
+    if (++index >= _BITMAP_WORDS)
+      return -1;
+    word= words[index] ^ flip;
+  }
+  return index * 64 + __builtin_ctzll(word);
+}
+
+// -----[ _words_card ]----------------------------------------------
+static inline uint32_t _words_card(const uint64_t * words)
+{
+  uint32_t card= 0, index;
+  for (index= 0; index < _BITMAP_WORDS; index++)
+    card+= __builtin_popcountll(words[index]);
+  return card;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// CONTAINERS
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _array_search ]--------------------------------------------
+/**
+ * Binary search of a value in a sorted array. Return the index of the
+ * value if it is found, or -(insertion point)-1 otherwise.
+ */
+static inline int32_t _array_search(const uint16_t * values, uint32_t num,
+				    uint16_t value)
+{
+  int32_t low= 0, high= (int32_t) num - 1, middle;
+
+  while (low <= high) {
+    middle= (low + high) >> 1;
+    if (values[middle] < value)
+      low= middle + 1;
+    else if (values[middle] > value)
+      high= middle - 1;
+    else
+      return middle;
+  }
+  return -(low + 1);
+}
+
+// -----[ _run_search ]----------------------------------------------
+/** Return the index of the last run that starts at or before value,
+ * or -1 if there is none. */
+static inline int32_t _run_search(const _run_t * runs, uint32_t num,
+				  uint16_t value)
+{
+  int32_t low= 0, high= (int32_t) num - 1, middle;
+
+  while (low <= high) {
+    middle= (low + high) >> 1;
+    if (runs[middle].start <= value)
+      low= middle + 1;
+    else
+      high= middle - 1;
+  }
+  return low - 1;
+}
+
+// -----[ _container_init_array ]------------------------------------
+static inline void _container_init_array(_container_t * c,
+					 uint32_t capacity)
+{
+  c->type= _ARRAY;
+  c->card= 0;
+  c->num= 0;
+  c->capacity= capacity;
+  c->u.values= (uint16_t *) MALLOC(capacity * sizeof(uint16_t));
+}
+
+// -----[ _container_init_bitmap ]-----------------------------------
+static inline void _container_init_bitmap(_container_t * c)
+{
+  c->type= _BITMAP;
+  c->card= 0;
+  c->num= 0;
+  c->capacity= 0;
+  c->u.words= (uint64_t *) MALLOC(_BITMAP_WORDS * sizeof(uint64_t));
+  memset(c->u.words, 0, _BITMAP_WORDS * sizeof(uint64_t));
+}
+
+// -----[ _container_init_run ]--------------------------------------
+static inline void _container_init_run(_container_t * c,
+				       uint32_t capacity)
+{
+  c->type= _RUN;
+  c->card= 0;
+  c->num= 0;
+  c->capacity= capacity;
+  c->u.runs= (_run_t *) MALLOC(capacity * sizeof(_run_t));
+}
+
+// -----[ _container_free ]------------------------------------------
+static inline void _container_free(_container_t * c)
+{
+  FREE(c->u.values);
+}
+
+// -----[ _container_copy ]------------------------------------------
+static inline void _container_copy(_container_t * dst,
+				   const _container_t * src)
+{
+  size_t size;
+
+  *dst= *src;
+  switch (src->type) {
+  case _ARRAY:
+    size= src->num * sizeof(uint16_t);
+    dst->capacity= src->num;
+    break;
+  case _BITMAP:
+    size= _BITMAP_WORDS * sizeof(uint64_t);
+    break;
+  default:
+    size= src->num * sizeof(_run_t);
+    dst->capacity= src->num;
+  }
+  dst->u.values= MALLOC(size > 0 ? size : 1);
+  memcpy(dst->u.values, src->u.values, size);
+}
+
+// -----[ _container_contains ]--------------------------------------
+static inline int _container_contains(const _container_t * c,
+				      uint16_t value)
+{
+  int32_t index;
+
+  switch (c->type) {
+  case _ARRAY:
+    return _array_search(c->u.values, c->num, value) >= 0;
+  case _BITMAP:
+    return (c->u.words[value / 64] >> (value % 64)) & 1;
+  default:
+    index= _run_search(c->u.runs, c->num, value);
+    return ((index >= 0) &&
+	    (value <= (uint32_t) c->u.runs[index].start +
+	     c->u.runs[index].length));
+  }
+}
+
+// -----[ _container_fill_words ]------------------------------------
+/** Set the bits of the container values in a bitmap. */
+static inline void _container_fill_words(const _container_t * c,
+					 uint64_t * words)
+{
+  uint32_t index;
+
+  switch (c->type) {
+  case _ARRAY:
+    for (index= 0; index < c->num; index++)
+      words[c->u.values[index] / 64]|=
+	((uint64_t) 1) << (c->u.values[index] % 64);
+    break;
+  case _BITMAP:
+    for (index= 0; index < _BITMAP_WORDS; index++)
+      words[index]|= c->u.words[index];
+    break;
+  default:
+    for (index= 0; index < c->num; index++)
+      _words_set_range(words, c->u.runs[index].start,
+		       (uint32_t) c->u.runs[index].start +
+		       c->u.runs[index].length);
+  }
+}
+
+// -----[ _container_from_words ]------------------------------------
+/**
+ * Initialize a container from a bitmap. The container takes the
+ * ownership of the bitmap if it is dense, otherwise it becomes an
+ * array container and the bitmap is freed.
+ */
+static inline void _container_from_words(_container_t * c,
+					 uint64_t * words, uint32_t card)
+{
+  uint32_t index;
+  uint64_t word;
+
+  if (card > ROARING_ARRAY_MAX) {
+    c->type= _BITMAP;
+    c->card= card;
+    c->num= 0;
+    c->capacity= 0;
+    c->u.words= words;
+    return;
+  }
+  _container_init_array(c, card > 0 ? card : 1);
+  for (index= 0; index < _BITMAP_WORDS; index++) {
+    word= words[index];
+    while (word != 0) {
+      c->u.values[c->num++]= index * 64 + __builtin_ctzll(word);
+      word&= word - 1;
+    }
+  }
+  c->card= card;
+  FREE(words);
+}
+
+// -----[ _container_to_bitmap ]-------------------------------------
+static inline void _container_to_bitmap(_container_t * c)
+{
+  _container_t bitmap;
+
+  _container_init_bitmap(&bitmap);
+  _container_fill_words(c, bitmap.u.words);
+  bitmap.card= c->card;
+  _container_free(c);
+  *c= bitmap;
+}
+
+// -----[ _container_to_array ]--------------------------------------
+/** Convert a bitmap container with at most ROARING_ARRAY_MAX values
+ * to an array container. */
+static inline void _container_to_array(_container_t * c)
+{
+  _container_from_words(c, c->u.words, c->card);
+}
+
+// -----[ _container_add ]-------------------------------------------
+/** Return 1 if the value was added, 0 if it was already there. */
+static int _container_add(_container_t * c, uint16_t value)
+{
+  int32_t index;
+  uint64_t mask;
+  _run_t * runs;
+  int merge_prev, merge_next;
+
+  switch (c->type) {
+  case _ARRAY:
+    index= _array_search(c->u.values, c->num, value);
+    if (index >= 0)
+      return 0;
+    if (c->num >= ROARING_ARRAY_MAX) {
+      _container_to_bitmap(c);
+      return _container_add(c, value);
+    }
+    index= -index - 1;
+    if (c->num == c->capacity) {
+      c->capacity= (c->capacity < 4) ? 4 : c->capacity * 2;
+      if (c->capacity > ROARING_ARRAY_MAX)
+	c->capacity= ROARING_ARRAY_MAX;
+      c->u.values= (uint16_t *) REALLOC(c->u.values,
+					c->capacity * sizeof(uint16_t));
+    }
+    memmove(&c->u.values[index+1], &c->u.values[index],
+	    (c->num - index) * sizeof(uint16_t));
+    c->u.values[index]= value;
+    c->num++;
+    break;
+
+  case _BITMAP:
+    mask= ((uint64_t) 1) << (value % 64);
+    if (c->u.words[value / 64] & mask)
+      return 0;
+    c->u.words[value / 64]|= mask;
+    break;
+
+  default:
+    runs= c->u.runs;
+    index= _run_search(runs, c->num, value);
+    if ((index >= 0) &&
+	(value <= (uint32_t) runs[index].start + runs[index].length))
+      return 0;
+    merge_prev= ((index >= 0) &&
+		 ((uint32_t) runs[index].start + runs[index].length + 1 ==
+		  value));
+    merge_next= ((index + 1 < (int32_t) c->num) &&
+		 (runs[index+1].start == (uint32_t) value + 1));
+    if (merge_prev && merge_next) {
+      runs[index].length= runs[index+1].start + runs[index+1].length -
+	runs[index].start;
+      memmove(&runs[index+1], &runs[index+2],
+	      (c->num - index - 2) * sizeof(_run_t));
+      c->num--;
+    } else if (merge_prev) {
+      runs[index].length++;
+    } else if (merge_next) {
+      runs[index+1].start--;
+      runs[index+1].length++;
+    } else {
+      if (c->num == c->capacity) {
+	c->capacity= (c->capacity < 4) ? 4 : c->capacity * 2;
+	c->u.runs= runs= (_run_t *) REALLOC(runs,
+					    c->capacity * sizeof(_run_t));
+      }
+      memmove(&runs[index+2], &runs[index+1],
+	      (c->num - index - 1) * sizeof(_run_t));
+      runs[index+1].start= value;
+      runs[index+1].length= 0;
+      c->num++;
+    }
+  }
+  c->card++;
+  return 1;
+}
+
+// -----[ _container_remove ]----------------------------------------
+/** Return 1 if the value was removed, 0 if it was not there. */
+static int _container_remove(_container_t * c, uint16_t value)
+{
+  int32_t index;
+  uint64_t mask;
+  _run_t * runs;
+  uint32_t end;
+
+  switch (c->type) {
+  case _ARRAY:
+    index= _array_search(c->u.values, c->num, value);
+    if (index < 0)
+      return 0;
+    memmove(&c->u.values[index], &c->u.values[index+1],
+	    (c->num - index - 1) * sizeof(uint16_t));
+    c->num--;
+    c->card--;
+    break;
+
+  case _BITMAP:
+    mask= ((uint64_t) 1) << (value % 64);
+    if (!(c->u.words[value / 64] & mask))
+      return 0;
+    c->u.words[value / 64]&= ~mask;
+    if (--c->card <= ROARING_ARRAY_MAX)
+      _container_to_array(c);
+    break;
+
+  default:
+    runs= c->u.runs;
+    index= _run_search(runs, c->num, value);
+    if (index < 0)
+      return 0;
+    end= (uint32_t) runs[index].start + runs[index].length;
+    if (value > end)
+      return 0;
+    if (runs[index].length == 0) {
+      memmove(&runs[index], &runs[index+1],
+	      (c->num - index - 1) * sizeof(_run_t));
+      c->num--;
+    } else if (value == runs[index].start) {
+      runs[index].start++;
+      runs[index].length--;
+    } else if (value == end) {
+      runs[index].length--;
+    } else {
+      // Split the run
+      if (c->num == c->capacity) {
+	c->capacity*= 2;
+	c->u.runs= runs= (_run_t *) REALLOC(runs,
+					    c->capacity * sizeof(_run_t));
+      }
+      memmove(&runs[index+2], &runs[index+1],
+	      (c->num - index - 1) * sizeof(_run_t));
+      runs[index+1].start= value + 1;
+      runs[index+1].length= end - value - 1;
+      runs[index].length= value - runs[index].start - 1;
+      c->num++;
+    }
+    c->card--;
+  }
+  return 1;
+}
+
+// -----[ _container_next ]------------------------------------------
+/** Return the first value at or after start, or -1. The start can
+ * be 0x10000 (the value after the last one). */
+static inline int32_t _container_next(const _container_t * c,
+				      uint32_t start)
+{
+  int32_t index;
+
+  if (start > 0xffff)
+    return -1;
+  switch (c->type) {
+  case _ARRAY:
+    index= _array_search(c->u.values, c->num, (uint16_t) start);
+    if (index < 0)
+      index= -index - 1;
+    return (index < (int32_t) c->num) ? c->u.values[index] : -1;
+  case _BITMAP:
+    return _words_next(c->u.words, start, 0);
+  default:
+    index= _run_search(c->u.runs, c->num, (uint16_t) start);
+    if ((index >= 0) &&
+	(start <= (uint32_t) c->u.runs[index].start +
+	 c->u.runs[index].length))
+      return start;
+    index++;
+    return (index < (int32_t) c->num) ? c->u.runs[index].start : -1;
+  }
+}
+
+// -----[ _container_num_runs ]--------------------------------------
+static uint32_t _container_num_runs(const _container_t * c)
+{
+  uint32_t num_runs= 0, index;
+  uint64_t word, carry= 0;
+
+  switch (c->type) {
+  case _ARRAY:
+    for (index= 0; index < c->num; index++)
+      if ((index == 0) || (c->u.values[index] != c->u.values[index-1] + 1))
+	num_runs++;
+    return num_runs;
+  case _BITMAP:
+    // Count the first bit of each run
+    for (index= 0; index < _BITMAP_WORDS; index++) {
+      word= c->u.words[index];
+      num_runs+= __builtin_popcountll(word & ~((word << 1) | carry));
+      carry= word >> 63;
+    }
+    return num_runs;
+  default:
+    return c->num;
+  }
+}
+
+// -----[ _container_to_run ]----------------------------------------
+static void _container_to_run(_container_t * c, uint32_t num_runs)
+{
+  _container_t run;
+  uint32_t index;
+  int32_t start, end;
+
+  _container_init_run(&run, num_runs);
+  if (c->type == _ARRAY) {
+    for (index= 0; index < c->num; index++) {
+      if ((run.num > 0) &&
+	  ((uint32_t) run.u.runs[run.num-1].start +
+	   run.u.runs[run.num-1].length + 1 == c->u.values[index])) {
+	run.u.runs[run.num-1].length++;
+      } else {
+	run.u.runs[run.num].start= c->u.values[index];
+	run.u.runs[run.num].length= 0;
+	run.num++;
+      }
+    }
+  } else {
+    start= _words_next(c->u.words, 0, 0);
+    while (start >= 0) {
+      end= _words_next(c->u.words, start, 1);
+      if (end < 0)
+	end= 65536;
+      run.u.runs[run.num].start= start;
+      run.u.runs[run.num].length= end - start - 1;
+      run.num++;
+      start= _words_next(c->u.words, end, 0);
+    }
+  }
+  run.card= c->card;
+  _container_free(c);
+  *c= run;
+}
+
+// -----[ _container_op ]--------------------------------------------
+/**
+ * Compute a binary operation between two containers. The result is
+ * an array or bitmap container. Return its cardinality (if it is 0,
+ * the result has not been allocated).
+ */
+static uint32_t _container_op(_op_t op, const _container_t * c1,
+			      const _container_t * c2, _container_t * result)
+{
+  uint64_t * words1, * words2;
+  uint32_t index, index1, index2, card;
+  uint16_t * values;
+  const _container_t * tmp;
+
+  // Intersection is commutative: filter the sparsest array
+  if ((op == _OP_AND) && (c2->type == _ARRAY) &&
+      ((c1->type != _ARRAY) || (c1->num > c2->num))) {
+    tmp= c1; c1= c2; c2= tmp;
+  }
+
+  // Array filtered by the other container
+  if ((c1->type == _ARRAY) && ((op == _OP_AND) || (op == _OP_ANDNOT))) {
+    values= (uint16_t *) MALLOC((c1->num > 0 ? c1->num : 1) *
+				sizeof(uint16_t));
+    card= 0;
+    for (index= 0; index < c1->num; index++)
+      if (_container_contains(c2, c1->u.values[index]) == (op == _OP_AND))
+	values[card++]= c1->u.values[index];
+    if (card == 0) {
+      FREE(values);
+      return 0;
+    }
+    result->type= _ARRAY;
+    result->card= result->num= result->capacity= card;
+    result->u.values= values;
+    return card;
+  }
+
+  // Merge of two arrays
+  if ((c1->type == _ARRAY) && (c2->type == _ARRAY) &&
+      (c1->num + c2->num <= ROARING_ARRAY_MAX)) {
+    values= (uint16_t *) MALLOC((c1->num + c2->num) * sizeof(uint16_t));
+    card= index1= index2= 0;
+    while ((index1 < c1->num) && (index2 < c2->num)) {
+      if (c1->u.values[index1] < c2->u.values[index2]) {
+	values[card++]= c1->u.values[index1++];
+      } else if (c1->u.values[index1] > c2->u.values[index2]) {
+	values[card++]= c2->u.values[index2++];
+      } else {
+	if (op == _OP_OR)
+	  values[card++]= c1->u.values[index1];
+	index1++;
+	index2++;
+      }
+    }
+    while (index1 < c1->num)
+      values[card++]= c1->u.values[index1++];
+    while (index2 < c2->num)
+      values[card++]= c2->u.values[index2++];
+    if (card == 0) {
+      FREE(values);
+      return 0;
+    }
+    result->type= _ARRAY;
+    result->card= result->num= card;
+    result->capacity= c1->num + c2->num;
+    result->u.values= values;
+    return card;
+  }
+
+  // Generic case: bitmap operation
+  words1= (uint64_t *) MALLOC(_BITMAP_WORDS * sizeof(uint64_t));
+  memset(words1, 0, _BITMAP_WORDS * sizeof(uint64_t));
+  _container_fill_words(c1, words1);
+  if (c2->type == _BITMAP) {
+    words2= c2->u.words;
+  } else {
+    words2= (uint64_t *) MALLOC(_BITMAP_WORDS * sizeof(uint64_t));
+    memset(words2, 0, _BITMAP_WORDS * sizeof(uint64_t));
+    _container_fill_words(c2, words2);
+  }
+  switch (op) {
+  case _OP_AND:
+    for (index= 0; index < _BITMAP_WORDS; index++)
+      words1[index]&= words2[index];
+    break;
+  case _OP_OR:
+    for (index= 0; index < _BITMAP_WORDS; index++)
+      words1[index]|= words2[index];
+    break;
+  case _OP_XOR:
+    for (index= 0; index < _BITMAP_WORDS; index++)
+      words1[index]^= words2[index];
+    break;
+  case _OP_ANDNOT:
+    for (index= 0; index < _BITMAP_WORDS; index++)
+      words1[index]&= ~words2[index];
+    break;
+  }
+  if (words2 != c2->u.words)
+    FREE(words2);
+  card= _words_card(words1);
+  if (card == 0) {
+    FREE(words1);
+    return 0;
+  }
+  _container_from_words(result, words1, card);
+  return card;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// BITMAP
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _roaring_search ]------------------------------------------
+static inline int32_t _roaring_search(gds_roaring_t * bitmap, uint16_t key)
+{
+  return _array_search(bitmap->keys, bitmap->size, key);
+}
+
+// -----[ _roaring_reserve ]-----------------------------------------
+static inline void _roaring_reserve(gds_roaring_t * bitmap,
+				    uint32_t capacity)
+{
+  if (capacity <= bitmap->capacity)
+    return;
+  if (capacity < bitmap->capacity * 2)
+    capacity= bitmap->capacity * 2;
+  bitmap->keys= (uint16_t *) REALLOC(bitmap->keys,
+				     capacity * sizeof(uint16_t));
+  bitmap->containers= (_container_t *)
+    REALLOC(bitmap->containers, capacity * sizeof(_container_t));
+  bitmap->capacity= capacity;
+}
+
+// -----[ _roaring_remove_container ]--------------------------------
+static inline void _roaring_remove_container(gds_roaring_t * bitmap,
+					     uint32_t index)
+{
+  _container_free(&bitmap->containers[index]);
+  memmove(&bitmap->keys[index], &bitmap->keys[index+1],
+	  (bitmap->size - index - 1) * sizeof(uint16_t));
+  memmove(&bitmap->containers[index], &bitmap->containers[index+1],
+	  (bitmap->size - index - 1) * sizeof(_container_t));
+  bitmap->size--;
+}
+
+// -----[ roaring_create ]-------------------------------------------
+/**
+ * \brief Create an empty bitmap.
+ */
+gds_roaring_t * roaring_create()
+{
+  gds_roaring_t * bitmap=
+    (gds_roaring_t *) MALLOC(sizeof(gds_roaring_t));
+  bitmap->keys= NULL;
+  bitmap->containers= NULL;
+  bitmap->size= 0;
+  bitmap->capacity= 0;
+  return bitmap;
+}
+
+// -----[ roaring_copy ]---------------------------------------------
+gds_roaring_t * roaring_copy(gds_roaring_t * bitmap)
+{
+  gds_roaring_t * copy= roaring_create();
+  uint32_t index;
+
+  _roaring_reserve(copy, bitmap->size);
+  for (index= 0; index < bitmap->size; index++) {
+    copy->keys[index]= bitmap->keys[index];
+    _container_copy(&copy->containers[index], &bitmap->containers[index]);
+  }
+  copy->size= bitmap->size;
+  return copy;
+}
+
+// -----[ roaring_destroy ]------------------------------------------
+void roaring_destroy(gds_roaring_t ** bitmap_ref)
+{
+  uint32_t index;
+
+  if (*bitmap_ref != NULL) {
+    for (index= 0; index < (*bitmap_ref)->size; index++)
+      _container_free(&(*bitmap_ref)->containers[index]);
+    if ((*bitmap_ref)->keys != NULL) {
+      FREE((*bitmap_ref)->keys);
+      FREE((*bitmap_ref)->containers);
+    }
+    FREE(*bitmap_ref);
+    *bitmap_ref= NULL;
+  }
+}
+
+// -----[ roaring_add ]----------------------------------------------
+/**
+ * \brief Add a value to the bitmap.
+ *
+ * \retval 1 if the value was added, 0 if it was already present.
+ */
+int roaring_add(gds_roaring_t * bitmap, uint32_t value)
+{
+  int32_t index= _roaring_search(bitmap, (uint16_t) (value >> 16));
+
+  if (index < 0) {
+    index= -index - 1;
+    _roaring_reserve(bitmap, bitmap->size + 1);
+    memmove(&bitmap->keys[index+1], &bitmap->keys[index],
+	    (bitmap->size - index) * sizeof(uint16_t));
+    memmove(&bitmap->containers[index+1], &bitmap->containers[index],
+	    (bitmap->size - index) * sizeof(_container_t));
+    bitmap->keys[index]= (uint16_t) (value >> 16);
+    _container_init_array(&bitmap->containers[index], 4);
+    bitmap->size++;
+  }
+  return _container_add(&bitmap->containers[index], (uint16_t) value);
+}
+
+// -----[ roaring_remove ]-------------------------------------------
+/**
+ * \brief Remove a value from the bitmap.
+ *
+ * \retval 1 if the value was removed, 0 if it was not present.
+ */
+int roaring_remove(gds_roaring_t * bitmap, uint32_t value)
+{
+  int32_t index= _roaring_search(bitmap, (uint16_t) (value >> 16));
+
+  if (index < 0)
+    return 0;
+  if (!_container_remove(&bitmap->containers[index], (uint16_t) value))
+    return 0;
+  if (bitmap->containers[index].card == 0)
+    _roaring_remove_container(bitmap, index);
+  return 1;
+}
+
+// -----[ roaring_contains ]-----------------------------------------
+/**
+ * \brief Test if a value belongs to the bitmap.
+ */
+int roaring_contains(gds_roaring_t * bitmap, uint32_t value)
+{
+  int32_t index= _roaring_search(bitmap, (uint16_t) (value >> 16));
+
+  if (index < 0)
+    return 0;
+  return _container_contains(&bitmap->containers[index], (uint16_t) value);
+}
+
+// -----[ roaring_cardinality ]--------------------------------------
+/**
+ * \brief Return the number of values in the bitmap.
+ */
+uint64_t roaring_cardinality(gds_roaring_t * bitmap)
+{
+  uint64_t card= 0;
+  uint32_t index;
+
+  for (index= 0; index < bitmap->size; index++)
+    card+= bitmap->containers[index].card;
+  return card;
+}
+
+// -----[ _roaring_op ]----------------------------------------------
+/**
+ * Compute a binary operation between two bitmaps and store the
+ * result in the first one. The containers of the first bitmap that
+ * are kept unchanged are moved to the result; those of the second
+ * bitmap are copied.
+ */
+static int _roaring_op(_op_t op, gds_roaring_t * bitmap1,
+		       gds_roaring_t * bitmap2)
+{
+  gds_roaring_t result;
+  uint32_t index1= 0, index2= 0;
+  _container_t container;
+  uint16_t key1, key2;
+
+  if ((bitmap1 == NULL) || (bitmap2 == NULL))
+    return -1;
+  if (bitmap1 == bitmap2) {
+    if ((op == _OP_XOR) || (op == _OP_ANDNOT)) {
+      for (index1= 0; index1 < bitmap1->size; index1++)
+	_container_free(&bitmap1->containers[index1]);
+      bitmap1->size= 0;
+    }
+    return 0;
+  }
+
+  result.keys= NULL;
+  result.containers= NULL;
+  result.size= result.capacity= 0;
+  _roaring_reserve(&result, (op == _OP_AND) ?
+		   ((bitmap1->size < bitmap2->size) ?
+		    bitmap1->size : bitmap2->size) :
+		   bitmap1->size + ((op == _OP_ANDNOT) ? 0 : bitmap2->size));
+
+  while ((index1 < bitmap1->size) || (index2 < bitmap2->size)) {
+    key1= (index1 < bitmap1->size) ? bitmap1->keys[index1] : 0;
+    key2= (index2 < bitmap2->size) ? bitmap2->keys[index2] : 0;
+    if ((index2 >= bitmap2->size) ||
+	((index1 < bitmap1->size) && (key1 < key2))) {
+      // Key only in the first bitmap
+      if (op == _OP_AND)
+	_container_free(&bitmap1->containers[index1]);
+      else {
+	result.keys[result.size]= key1;
+	result.containers[result.size++]= bitmap1->containers[index1];
+      }
+      index1++;
+    } else if ((index1 >= bitmap1->size) || (key2 < key1)) {
+      // Key only in the second bitmap
+      if ((op == _OP_OR) || (op == _OP_XOR)) {
+	result.keys[result.size]= key2;
+	_container_copy(&result.containers[result.size++],
+			&bitmap2->containers[index2]);
+      }
+      index2++;
+    } else {
+      if (_container_op(op, &bitmap1->containers[index1],
+			&bitmap2->containers[index2], &container) > 0) {
+	result.keys[result.size]= key1;
+	result.containers[result.size++]= container;
+      }
+      _container_free(&bitmap1->containers[index1]);
+      index1++;
+      index2++;
+    }
+  }
+
+  if (bitmap1->keys != NULL) {
+    FREE(bitmap1->keys);
+    FREE(bitmap1->containers);
+  }
+  *bitmap1= result;
+  return 0;
+}
+
+// -----[ roaring_and ]----------------------------------------------
+/**
+ * \brief Intersection of two bitmaps. The result is stored in the
+ * first bitmap.
+ *
+ * \retval 0 in case of success, -1 if one of the bitmaps is NULL.
+ */
+int roaring_and(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2)
+{
+  return _roaring_op(_OP_AND, bitmap1, bitmap2);
+}
+
+// -----[ roaring_or ]-----------------------------------------------
+/**
+ * \brief Union of two bitmaps. The result is stored in the first
+ * bitmap.
+ *
+ * \retval 0 in case of success, -1 if one of the bitmaps is NULL.
+ */
+int roaring_or(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2)
+{
+  return _roaring_op(_OP_OR, bitmap1, bitmap2);
+}
+
+// -----[ roaring_xor ]----------------------------------------------
+/**
+ * \brief Symmetric difference of two bitmaps. The result is stored
+ * in the first bitmap.
+ *
+ * \retval 0 in case of success, -1 if one of the bitmaps is NULL.
+ */
+int roaring_xor(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2)
+{
+  return _roaring_op(_OP_XOR, bitmap1, bitmap2);
+}
+
+// -----[ roaring_andnot ]-------------------------------------------
+/**
+ * \brief Difference of two bitmaps (values of the first bitmap that
+ * are not in the second one). The result is stored in the first
+ * bitmap.
+ *
+ * \retval 0 in case of success, -1 if one of the bitmaps is NULL.
+ */
+int roaring_andnot(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2)
+{
+  return _roaring_op(_OP_ANDNOT, bitmap1, bitmap2);
+}
+
+// -----[ roaring_equals ]-------------------------------------------
+/**
+ * \brief Test if two bitmaps contain the same values, whatever the
+ * types of their containers.
+ */
+int roaring_equals(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2)
+{
+  _container_t * c1, * c2;
+  uint64_t * words;
+  uint32_t index;
+  int equal= 1;
+
+  if (bitmap1->size != bitmap2->size)
+    return 0;
+  for (index= 0; index < bitmap1->size; index++) {
+    c1= &bitmap1->containers[index];
+    c2= &bitmap2->containers[index];
+    if ((bitmap1->keys[index] != bitmap2->keys[index]) ||
+	(c1->card != c2->card))
+      return 0;
+    if ((c1->type == c2->type) && (c1->type == _ARRAY))
+      equal= !memcmp(c1->u.values, c2->u.values, c1->num * sizeof(uint16_t));
+    else if ((c1->type == c2->type) && (c1->type == _BITMAP))
+      equal= !memcmp(c1->u.words, c2->u.words,
+		     _BITMAP_WORDS * sizeof(uint64_t));
+    else {
+      // Same cardinality: c1 is included in c2 iff they are equal
+      words= (uint64_t *) MALLOC(_BITMAP_WORDS * sizeof(uint64_t));
+      memset(words, 0, _BITMAP_WORDS * sizeof(uint64_t));
+      _container_fill_words(c2, words);
+      _container_fill_words(c1, words);
+      equal= (_words_card(words) == c2->card);
+      FREE(words);
+    }
+    if (!equal)
+      return 0;
+  }
+  return 1;
+}
+
+// -----[ roaring_next ]---------------------------------------------
+/**
+ * \brief Find the smallest value of the bitmap that is greater than
+ * or equal to a given value.
+ *
+ * Typical use:
+ * \code
+ * for (v= roaring_next(r, 0); v >= 0; v= roaring_next(r, v+1))
+ *   ...
+ * \endcode
+ *
+ * \retval the value, or -1 if there is none.
+ */
+int64_t roaring_next(gds_roaring_t * bitmap, uint64_t value)
+{
+  int32_t index, low;
+
+  if (value > MAX_UINT32_T)
+    return -1;
+  index= _roaring_search(bitmap, (uint16_t) (value >> 16));
+
+  if (index >= 0) {
+    low= _container_next(&bitmap->containers[index], value & 0xffff);
+    if (low >= 0)
+      return ((int64_t) bitmap->keys[index] << 16) | low;
+    index++;
+  } else
+    index= -index - 1;
+  if (index >= (int32_t) bitmap->size)
+    return -1;
+  return ((int64_t) bitmap->keys[index] << 16) |
+    _container_next(&bitmap->containers[index], 0);
+}
+
+// -----[ roaring_for_each ]-----------------------------------------
+/**
+ * \brief Call a function for each value of the bitmap, in increasing
+ * order.
+ *
+ * \retval 0 if all the values were visited. If the function returns
+ *   a non-zero value, the iteration stops and this value is returned.
+ */
+int roaring_for_each(gds_roaring_t * bitmap, gds_roaring_foreach_f foreach,
+		     void * ctx)
+{
+  _container_t * c;
+  uint32_t index, i, high, value, end;
+  uint64_t word;
+  int result;
+
+  for (index= 0; index < bitmap->size; index++) {
+    c= &bitmap->containers[index];
+    high= ((uint32_t) bitmap->keys[index]) << 16;
+    switch (c->type) {
+    case _ARRAY:
+      for (i= 0; i < c->num; i++)
+	if ((result= foreach(high | c->u.values[i], ctx)) != 0)
+	  return result;
+      break;
+    case _BITMAP:
+      for (i= 0; i < _BITMAP_WORDS; i++) {
+	word= c->u.words[i];
+	while (word != 0) {
+	  if ((result= foreach(high | (i * 64 + __builtin_ctzll(word)),
+			       ctx)) != 0)
+	    return result;
+	  word&= word - 1;
+	}
+      }
+      break;
+    default:
+      for (i= 0; i < c->num; i++) {
+	end= (uint32_t) c->u.runs[i].start + c->u.runs[i].length;
+	for (value= c->u.runs[i].start; value <= end; value++)
+	  if ((result= foreach(high | value, ctx)) != 0)
+	    return result;
+      }
+    }
+  }
+  return 0;
+}
+
+// -----[ roaring_run_optimize ]-------------------------------------
+/**
+ * \brief Convert each container to the most compact of the three
+ * types. A container is stored as runs if the runs take less space
+ * than an array or a bitmap.
+ *
+ * \retval the number of run containers.
+ */
+unsigned int roaring_run_optimize(gds_roaring_t * bitmap)
+{
+  _container_t * c;
+  uint32_t index, num_runs, run_size, other_size;
+  unsigned int num_run_containers= 0;
+
+  for (index= 0; index < bitmap->size; index++) {
+    c= &bitmap->containers[index];
+    num_runs= _container_num_runs(c);
+    run_size= 2 + 4 * num_runs;
+    other_size= (c->card <= ROARING_ARRAY_MAX) ? 2 * c->card : 8192;
+    if (run_size < other_size) {
+      if (c->type != _RUN)
+	_container_to_run(c, num_runs);
+      num_run_containers++;
+    } else if (c->type == _RUN) {
+      _container_to_bitmap(c);
+      if (c->card <= ROARING_ARRAY_MAX)
+	_container_to_array(c);
+    }
+  }
+  return num_run_containers;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// SERIALIZATION
+//
+/////////////////////////////////////////////////////////////////////
+
+static inline void _put16(uint8_t * buffer, uint16_t value)
+{
+  buffer[0]= (uint8_t) value;
+  buffer[1]= (uint8_t) (value >> 8);
+}
+
+static inline void _put32(uint8_t * buffer, uint32_t value)
+{
+  _put16(buffer, (uint16_t) value);
+  _put16(buffer+2, (uint16_t) (value >> 16));
+}
+
+static inline uint16_t _get16(const uint8_t * buffer)
+{
+  return (uint16_t) (buffer[0] | (buffer[1] << 8));
+}
+
+static inline uint32_t _get32(const uint8_t * buffer)
+{
+  return _get16(buffer) | ((uint32_t) _get16(buffer+2) << 16);
+}
+
+// -----[ _roaring_has_run ]-----------------------------------------
+static inline int _roaring_has_run(gds_roaring_t * bitmap)
+{
+  uint32_t index;
+  for (index= 0; index < bitmap->size; index++)
+    if (bitmap->containers[index].type == _RUN)
+      return 1;
+  return 0;
+}
+
+// -----[ _roaring_header_size ]-------------------------------------
+static inline size_t _roaring_header_size(uint32_t size, int has_run)
+{
+  size_t header= has_run ? 4 + (size + 7) / 8 : 8;
+  header+= 4 * (size_t) size;
+  if (!has_run || (size >= _NO_OFFSET_THRESHOLD))
+    header+= 4 * (size_t) size;
+  return header;
+}
+
+// -----[ _container_serialized_size ]-------------------------------
+static inline size_t _container_serialized_size(const _container_t * c)
+{
+  if (c->type == _RUN)
+    return 2 + 4 * (size_t) c->num;
+  if (c->card <= ROARING_ARRAY_MAX)
+    return 2 * (size_t) c->card;
+  return _BITMAP_WORDS * 8;
+}
+
+// -----[ roaring_serialized_size ]----------------------------------
+/**
+ * \brief Return the number of bytes needed to serialize the bitmap.
+ */
+size_t roaring_serialized_size(gds_roaring_t * bitmap)
+{
+  size_t size= _roaring_header_size(bitmap->size,
+				    _roaring_has_run(bitmap));
+  uint32_t index;
+
+  for (index= 0; index < bitmap->size; index++)
+    size+= _container_serialized_size(&bitmap->containers[index]);
+  return size;
+}
+
+// -----[ roaring_serialize ]----------------------------------------
+/**
+ * \brief Serialize a bitmap in the portable Roaring format.
+ *
+ * \param buffer must be at least roaring_serialized_size() bytes
+ *   long.
+ * \retval the number of bytes written.
+ */
+size_t roaring_serialize(gds_roaring_t * bitmap, uint8_t * buffer)
+{
+  int has_run= _roaring_has_run(bitmap);
+  uint8_t * ptr= buffer;
+  uint8_t * offsets= NULL;
+  _container_t * c;
+  uint32_t index, i;
+  uint64_t * words;
+  int32_t value;
+
+  if (has_run) {
+    _put32(ptr, _SERIAL_COOKIE | ((bitmap->size - 1) << 16));
+    ptr+= 4;
+    memset(ptr, 0, (bitmap->size + 7) / 8);
+    for (index= 0; index < bitmap->size; index++)
+      if (bitmap->containers[index].type == _RUN)
+	ptr[index / 8]|= 1 << (index % 8);
+    ptr+= (bitmap->size + 7) / 8;
+  } else {
+    _put32(ptr, _SERIAL_COOKIE_NO_RUN);
+    _put32(ptr+4, bitmap->size);
+    ptr+= 8;
+  }
+  for (index= 0; index < bitmap->size; index++) {
+    _put16(ptr, bitmap->keys[index]);
+    _put16(ptr+2, (uint16_t) (bitmap->containers[index].card - 1));
+    ptr+= 4;
+  }
+  if (!has_run || (bitmap->size >= _NO_OFFSET_THRESHOLD)) {
+    offsets= ptr;
+    ptr+= 4 * bitmap->size;
+  }
+
+  for (index= 0; index < bitmap->size; index++) {
+    c= &bitmap->containers[index];
+    if (offsets != NULL)
+      _put32(offsets + 4 * index, (uint32_t) (ptr - buffer));
+    if (c->type == _RUN) {
+      _put16(ptr, (uint16_t) c->num);
+      ptr+= 2;
+      for (i= 0; i < c->num; i++, ptr+= 4) {
+	_put16(ptr, c->u.runs[i].start);
+	_put16(ptr+2, c->u.runs[i].length);
+      }
+    } else if (c->card <= ROARING_ARRAY_MAX) {
+      value= _container_next(c, 0);
+      while (value >= 0) {
+	_put16(ptr, (uint16_t) value);
+	ptr+= 2;
+	value= _container_next(c, value + 1);
+      }
+    } else {
+      words= c->u.words;
+      for (i= 0; i < _BITMAP_WORDS; i++, ptr+= 8) {
+	_put32(ptr, (uint32_t) words[i]);
+	_put32(ptr+4, (uint32_t) (words[i] >> 32));
+      }
+    }
+  }
+  return ptr - buffer;
+}
+
+// -----[ _container_deserialize ]-----------------------------------
+/**
+ * Read a container. Return the number of bytes read, or 0 if the
+ * buffer is too short or the container is not valid.
+ */
+static size_t _container_deserialize(_container_t * c, const uint8_t * ptr,
+				     size_t len, uint32_t card, int is_run)
+{
+  uint32_t index, num, start, length, end, next= 0;
+  size_t size;
+
+  if (is_run) {
+    if (len < 2)
+      return 0;
+    num= _get16(ptr);
+    size= 2 + 4 * (size_t) num;
+    if (len < size)
+      return 0;
+    _container_init_run(c, num > 0 ? num : 1);
+    for (index= 0; index < num; index++) {
+      start= _get16(ptr + 2 + 4 * index);
+      length= _get16(ptr + 4 + 4 * index);
+      end= start + length;
+      if ((start < next) || (end > 0xffff))
+	break;
+      c->u.runs[index].start= start;
+      c->u.runs[index].length= length;
+      c->card+= length + 1;
+      next= end + 2;
+    }
+    c->num= num;
+  } else if (card <= ROARING_ARRAY_MAX) {
+    size= 2 * (size_t) card;
+    if (len < size)
+      return 0;
+    _container_init_array(c, card);
+    for (index= 0; index < card; index++) {
+      c->u.values[index]= _get16(ptr + 2 * index);
+      if ((index > 0) && (c->u.values[index] <= c->u.values[index-1]))
+	break;
+    }
+    c->num= c->card= card;
+  } else {
+    size= _BITMAP_WORDS * 8;
+    if (len < size)
+      return 0;
+    _container_init_bitmap(c);
+    for (index= 0; index < _BITMAP_WORDS; index++)
+      c->u.words[index]= _get32(ptr + 8 * index) |
+	((uint64_t) _get32(ptr + 8 * index + 4) << 32);
+    c->card= _words_card(c->u.words);
+    index= num= card;
+  }
+  if ((c->card != card) || (is_run && (index < num)) ||
+      (!is_run && (index < card))) {
+    _container_free(c);
+    return 0;
+  }
+  return size;
+}
+
+// -----[ roaring_deserialize ]--------------------------------------
+/**
+ * \brief Create a bitmap from a buffer in the portable Roaring
+ * format.
+ *
+ * \retval a new bitmap, or NULL if the buffer is not valid.
+ */
+gds_roaring_t * roaring_deserialize(const uint8_t * buffer, size_t len)
+{
+  gds_roaring_t * bitmap;
+  const uint8_t * ptr= buffer;
+  const uint8_t * run_flags= NULL;
+  const uint8_t * descr;
+  uint32_t cookie, size, index, card;
+  size_t header, read;
+  uint16_t key;
+
+  if (len < 4)
+    return NULL;
+  cookie= _get32(ptr);
+  if ((cookie & 0xffff) == _SERIAL_COOKIE) {
+    size= (cookie >> 16) + 1;
+    run_flags= ptr + 4;
+  } else if (cookie == _SERIAL_COOKIE_NO_RUN) {
+    if (len < 8)
+      return NULL;
+    size= _get32(ptr + 4);
+    if (size > 65536)
+      return NULL;
+  } else
+    return NULL;
+  header= _roaring_header_size(size, run_flags != NULL);
+  if (len < header)
+    return NULL;
+  descr= ptr + ((run_flags != NULL) ? 4 + (size + 7) / 8 : 8);
+  ptr+= header;
+  len-= header;
+
+  bitmap= roaring_create();
+  _roaring_reserve(bitmap, size);
+  for (index= 0; index < size; index++) {
+    key= _get16(descr + 4 * index);
+    card= (uint32_t) _get16(descr + 4 * index + 2) + 1;
+    if ((index > 0) && (key <= bitmap->keys[index-1]))
+      break;
+    read= _container_deserialize(&bitmap->containers[index], ptr, len, card,
+				 (run_flags != NULL) &&
+				 (run_flags[index / 8] & (1 << (index % 8))));
+    if (read == 0)
+      break;
+    bitmap->keys[index]= key;
+    bitmap->size++;
+    ptr+= read;
+    len-= read;
+  }
+  if (index < size) {
+    roaring_destroy(&bitmap);
+    return NULL;
+  }
+  return bitmap;
+}
@@ -0,0 +1,72 @@
+// ==================================================================
+// @(#)roaring.h
+//
+// Compressed bitmap (Roaring).
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+#ifndef __GDS_ROARING_H__
+#define __GDS_ROARING_H__
+
+#include <stddef.h>
+
+#include <libgds/types.h>
+
+/** Maximum number of values in an array container. */
+#define ROARING_ARRAY_MAX 4096
+
+typedef struct gds_roaring_t gds_roaring_t;
+
+/** Callback function used to traverse the values of a bitmap. */
+typedef int (*gds_roaring_foreach_f)(uint32_t value, void * ctx);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ roaring_create ]-----------------------------------------
+  gds_roaring_t * roaring_create();
+  // -----[ roaring_copy ]-------------------------------------------
+  gds_roaring_t * roaring_copy(gds_roaring_t * bitmap);
+  // -----[ roaring_destroy ]----------------------------------------
+  void roaring_destroy(gds_roaring_t ** bitmap_ref);
+  // -----[ roaring_add ]--------------------------------------------
+  int roaring_add(gds_roaring_t * bitmap, uint32_t value);
+  // -----[ roaring_remove ]-----------------------------------------
+  int roaring_remove(gds_roaring_t * bitmap, uint32_t value);
+  // -----[ roaring_contains ]---------------------------------------
+  int roaring_contains(gds_roaring_t * bitmap, uint32_t value);
+  // -----[ roaring_cardinality ]------------------------------------
+  uint64_t roaring_cardinality(gds_roaring_t * bitmap);
+  // -----[ roaring_and ]--------------------------------------------
+  int roaring_and(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2);
+  // -----[ roaring_or ]---------------------------------------------
+  int roaring_or(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2);
+  // -----[ roaring_xor ]--------------------------------------------
+  int roaring_xor(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2);
+  // -----[ roaring_andnot ]-----------------------------------------
+  int roaring_andnot(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2);
+  // -----[ roaring_equals ]-----------------------------------------
+  int roaring_equals(gds_roaring_t * bitmap1, gds_roaring_t * bitmap2);
+  // -----[ roaring_next ]-------------------------------------------
+  int64_t roaring_next(gds_roaring_t * bitmap, uint64_t value);
+  // -----[ roaring_for_each ]---------------------------------------
+  int roaring_for_each(gds_roaring_t * bitmap, gds_roaring_foreach_f foreach,
+		       void * ctx);
+  // -----[ roaring_run_optimize ]-----------------------------------
+  unsigned int roaring_run_optimize(gds_roaring_t * bitmap);
+  // -----[ roaring_serialized_size ]--------------------------------
+  size_t roaring_serialized_size(gds_roaring_t * bitmap);
+  // -----[ roaring_serialize ]--------------------------------------
+  size_t roaring_serialize(gds_roaring_t * bitmap, uint8_t * buffer);
+  // -----[ roaring_deserialize ]------------------------------------
+  gds_roaring_t * roaring_deserialize(const uint8_t * buffer, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_ROARING_H__ */
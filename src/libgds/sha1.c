@@ -30,6 +30,11 @@
 #include <string.h>
 #include <libgds/sha1.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define HAVE_SHA1_X86
+# include <immintrin.h>
+#endif
+
 
 
 #define GET_UINT32(n,b,i)                       \
@@ -216,6 +221,237 @@ static void sha1_process( SSHA1Context *ctx, const uint8_t data[64] )
     ctx->state[4] += E;
 }
 
+static void sha1_process_blocks( SSHA1Context *ctx, const uint8_t *data,
+                                 uint32_t blocks )
+{
+    while( blocks-- )
+    {
+        sha1_process( ctx, data );
+        data += 64;
+    }
+}
+
+/*
+ * SHA extensions (SHA-NI). The 80 rounds are computed 4 at a time by
+ * sha1rnds4, sha1nexte derives E from the previous ABCD and sha1msg1/
+ * sha1msg2 compute the message schedule.
+ */
+#ifdef HAVE_SHA1_X86
+
+#define SHANI_LOAD(m,i)                                         \
+{                                                               \
+    m = _mm_loadu_si128( (const __m128i *) ( data + (i) ) );    \
+    m = _mm_shuffle_epi8( m, MASK );                            \
+}
+
+/* Rounds 4i..4i+3, for i in 3..16 */
+#define SHANI_ROUNDS(ec,en,cur,next,prev,prev2,f)               \
+{                                                               \
+    ec = _mm_sha1nexte_epu32( ec, cur );                        \
+    en = ABCD;                                                  \
+    next = _mm_sha1msg2_epu32( next, cur );                     \
+    ABCD = _mm_sha1rnds4_epu32( ABCD, ec, f );                  \
+    prev = _mm_sha1msg1_epu32( prev, cur );                     \
+    prev2 = _mm_xor_si128( prev2, cur );                        \
+}
+
+__attribute__ ((target ("sha,sse4.1")))
+static void sha1_process_blocks_shani( SSHA1Context *ctx,
+                                       const uint8_t *data,
+                                       uint32_t blocks )
+{
+    __m128i ABCD, ABCD_SAVE, E0, E0_SAVE, E1;
+    __m128i MSG0, MSG1, MSG2, MSG3;
+    const __m128i MASK = _mm_set_epi64x( 0x0001020304050607ULL,
+                                         0x08090a0b0c0d0e0fULL );
+
+    ABCD = _mm_loadu_si128( (const __m128i *) ctx->state );
+    ABCD = _mm_shuffle_epi32( ABCD, 0x1B );
+    E0 = _mm_set_epi32( (int) ctx->state[4], 0, 0, 0 );
+
+    while( blocks-- )
+    {
+        ABCD_SAVE = ABCD;
+        E0_SAVE = E0;
+
+        SHANI_LOAD( MSG0, 0 );
+        E0 = _mm_add_epi32( E0, MSG0 );
+        E1 = ABCD;
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E0, 0 );
+
+        SHANI_LOAD( MSG1, 16 );
+        E1 = _mm_sha1nexte_epu32( E1, MSG1 );
+        E0 = ABCD;
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E1, 0 );
+        MSG0 = _mm_sha1msg1_epu32( MSG0, MSG1 );
+
+        SHANI_LOAD( MSG2, 32 );
+        E0 = _mm_sha1nexte_epu32( E0, MSG2 );
+        E1 = ABCD;
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E0, 0 );
+        MSG1 = _mm_sha1msg1_epu32( MSG1, MSG2 );
+        MSG0 = _mm_xor_si128( MSG0, MSG2 );
+
+        SHANI_LOAD( MSG3, 48 );
+        SHANI_ROUNDS( E1, E0, MSG3, MSG0, MSG2, MSG1, 0 );
+        SHANI_ROUNDS( E0, E1, MSG0, MSG1, MSG3, MSG2, 0 );
+        SHANI_ROUNDS( E1, E0, MSG1, MSG2, MSG0, MSG3, 1 );
+        SHANI_ROUNDS( E0, E1, MSG2, MSG3, MSG1, MSG0, 1 );
+        SHANI_ROUNDS( E1, E0, MSG3, MSG0, MSG2, MSG1, 1 );
+        SHANI_ROUNDS( E0, E1, MSG0, MSG1, MSG3, MSG2, 1 );
+        SHANI_ROUNDS( E1, E0, MSG1, MSG2, MSG0, MSG3, 1 );
+        SHANI_ROUNDS( E0, E1, MSG2, MSG3, MSG1, MSG0, 2 );
+        SHANI_ROUNDS( E1, E0, MSG3, MSG0, MSG2, MSG1, 2 );
+        SHANI_ROUNDS( E0, E1, MSG0, MSG1, MSG3, MSG2, 2 );
+        SHANI_ROUNDS( E1, E0, MSG1, MSG2, MSG0, MSG3, 2 );
+        SHANI_ROUNDS( E0, E1, MSG2, MSG3, MSG1, MSG0, 2 );
+        SHANI_ROUNDS( E1, E0, MSG3, MSG0, MSG2, MSG1, 3 );
+        SHANI_ROUNDS( E0, E1, MSG0, MSG1, MSG3, MSG2, 3 );
+
+        /* Rounds 68-79: end of the message schedule */
+        E1 = _mm_sha1nexte_epu32( E1, MSG1 );
+        E0 = ABCD;
+        MSG2 = _mm_sha1msg2_epu32( MSG2, MSG1 );
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E1, 3 );
+        MSG3 = _mm_xor_si128( MSG3, MSG1 );
+
+        E0 = _mm_sha1nexte_epu32( E0, MSG2 );
+        E1 = ABCD;
+        MSG3 = _mm_sha1msg2_epu32( MSG3, MSG2 );
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E0, 3 );
+
+        E1 = _mm_sha1nexte_epu32( E1, MSG3 );
+        E0 = ABCD;
+        ABCD = _mm_sha1rnds4_epu32( ABCD, E1, 3 );
+
+        E0 = _mm_sha1nexte_epu32( E0, E0_SAVE );
+        ABCD = _mm_add_epi32( ABCD, ABCD_SAVE );
+
+        data += 64;
+    }
+
+    ABCD = _mm_shuffle_epi32( ABCD, 0x1B );
+    _mm_storeu_si128( (__m128i *) ctx->state, ABCD );
+    ctx->state[4] = (uint32_t) _mm_extract_epi32( E0, 3 );
+}
+
+#undef SHANI_ROUNDS
+#undef SHANI_LOAD
+
+#endif /* HAVE_SHA1_X86 */
+
+/*
+ * Multi-buffer kernels: compress one block of each of SHA1_MB_LANES
+ * independent messages, one message per 32-bit lane. state and W are
+ * stored word by word: state[i * lanes + lane].
+ */
+#define SHA1_MB_MAX_LANES 8
+
+#ifdef __GNUC__
+
+#define MB_S(x,n) ((x << n) | (x >> (32 - n)))
+
+#define MB_R(t)                                                 \
+(                                                               \
+    temp = W[(t -  3) & 0x0F] ^ W[(t - 8) & 0x0F] ^             \
+           W[(t - 14) & 0x0F] ^ W[ t      & 0x0F],              \
+    ( W[t & 0x0F] = MB_S(temp,1) )                              \
+)
+
+#define MB_STEPS(first,last,F,K)                                \
+    for( t = first; t <= last; t++ )                            \
+    {                                                           \
+        x = ( t < 16 ) ? W[t] : MB_R(t);                        \
+        temp = MB_S(A,5) + F + K + E + x;                       \
+        E = D; D = C; C = MB_S(B,30); B = A; A = temp;          \
+    }
+
+#define SHA1_MB_KERNEL(SUFFIX,ATTR,LANES)                               \
+typedef uint32_t sha1_vec_##SUFFIX                                      \
+    __attribute__ ((vector_size (4 * LANES), aligned (4), may_alias));  \
+ATTR static void sha1_mb_##SUFFIX( uint32_t *state, const uint32_t *w ) \
+{                                                                       \
+    sha1_vec_##SUFFIX W[16], A, B, C, D, E, temp, x;                    \
+    sha1_vec_##SUFFIX *st = (sha1_vec_##SUFFIX *) state;                \
+    int t;                                                              \
+                                                                        \
+    for( t = 0; t < 16; t++ )                                           \
+        W[t] = ((const sha1_vec_##SUFFIX *) w)[t];                      \
+    A = st[0]; B = st[1]; C = st[2]; D = st[3]; E = st[4];              \
+                                                                        \
+    MB_STEPS( 0, 19, (D ^ (B & (C ^ D))), 0x5A827999 )                  \
+    MB_STEPS( 20, 39, (B ^ C ^ D), 0x6ED9EBA1 )                         \
+    MB_STEPS( 40, 59, ((B & C) | (D & (B | C))), 0x8F1BBCDC )           \
+    MB_STEPS( 60, 79, (B ^ C ^ D), 0xCA62C1D6 )                         \
+                                                                        \
+    st[0] += A; st[1] += B; st[2] += C; st[3] += D; st[4] += E;         \
+}
+
+#if defined(__SSE2__)
+# define HAVE_SHA1_SSE2
+SHA1_MB_KERNEL(sse2, , 4)
+#endif
+
+#ifdef HAVE_SHA1_X86
+SHA1_MB_KERNEL(avx2, __attribute__ ((target ("avx2"))), 8)
+#endif
+
+#endif /* __GNUC__ */
+
+/*
+ * Implementation selection (done once).
+ */
+#define SHA1_ACCEL_UNKNOWN -1
+
+static int sha1_accel = SHA1_ACCEL_UNKNOWN;
+static int sha1_accel_mask = SHA1_ACCEL_ALL;
+
+static int sha1_get_accel( void )
+{
+    if( sha1_accel != SHA1_ACCEL_UNKNOWN )
+        return( sha1_accel );
+
+    sha1_accel = 0;
+#ifdef HAVE_SHA1_SSE2
+    sha1_accel |= SHA1_ACCEL_SSE2;
+#endif
+#ifdef HAVE_SHA1_X86
+    __builtin_cpu_init();
+    if( __builtin_cpu_supports( "sha" ) &&
+        __builtin_cpu_supports( "sse4.1" ) )
+        sha1_accel |= SHA1_ACCEL_SHANI;
+    if( __builtin_cpu_supports( "avx2" ) )
+        sha1_accel |= SHA1_ACCEL_AVX2;
+#endif
+    sha1_accel &= sha1_accel_mask;
+    return( sha1_accel );
+}
+
+/*
+ * Select the accelerated implementations that may be used (all of
+ * them by default, when supported by the processor). Returns the set
+ * of accelerations in use (SHA1_ACCEL_* flags).
+ */
+int sha1_use_accel( int mask )
+{
+    sha1_accel_mask = mask;
+    sha1_accel = SHA1_ACCEL_UNKNOWN;
+    return( sha1_get_accel() );
+}
+
+static void sha1_process_n( SSHA1Context *ctx, const uint8_t *data,
+                            uint32_t blocks )
+{
+#ifdef HAVE_SHA1_X86
+    if( sha1_get_accel() & SHA1_ACCEL_SHANI )
+    {
+        sha1_process_blocks_shani( ctx, data, blocks );
+        return;
+    }
+#endif
+    sha1_process_blocks( ctx, data, blocks );
+}
+
 void sha1_update( SSHA1Context *ctx, const uint8_t *input, uint32_t length )
 {
     uint32_t left, fill;
@@ -235,17 +471,17 @@ void sha1_update( SSHA1Context *ctx, const uint8_t *input, uint32_t length )
     {
         memcpy( (void *) (ctx->buffer + left),
                 (const void *) input, fill );
-        sha1_process( ctx, ctx->buffer );
+        sha1_process_n( ctx, ctx->buffer, 1 );
         length -= fill;
         input  += fill;
         left = 0;
     }
 
-    while( length >= 64 )
+    if( length >= 64 )
     {
-        sha1_process( ctx, input );
-        length -= 64;
-        input  += 64;
+        sha1_process_n( ctx, input, length / 64 );
+        input  += length & ~0x3F;
+        length &= 0x3F;
     }
 
     if( length )
@@ -332,6 +568,152 @@ void sha1_hmac( const uint8_t *key, uint32_t keylen, const uint8_t *buf, uint32_
     memset( &ctx, 0, sizeof( SSHA1Context ) );
 }
 
+/*
+ * Batch hashing: count independent messages are hashed. With the SHA
+ * extensions, each message is hashed in turn. Otherwise, the
+ * messages are distributed over the lanes of the multi-buffer kernel:
+ * each lane processes one block of its message per call and gets the
+ * next message as soon as its current one is finished, so that
+ * messages of different lengths keep all the lanes busy.
+ */
+typedef void (*sha1_mb_kernel_f)( uint32_t *state, const uint32_t *w );
+
+typedef struct
+{
+    int32_t msg;            /* current message, -1 if idle */
+    uint32_t block;         /* current block */
+    uint32_t full_blocks;   /* number of blocks read from the message */
+    uint32_t blocks;        /* total number of blocks, with padding */
+    uint8_t tail[128];      /* last (padded) blocks */
+} SSHA1Lane;
+
+static void sha1_lane_start( SSHA1Lane *lane, uint32_t *state,
+                             uint32_t lanes, int32_t msg,
+                             const uint8_t *input, uint32_t length )
+{
+    uint32_t left = length & 0x3F;
+    uint32_t tail_len;
+    uint64_t bits = (uint64_t) length << 3;
+
+    lane->msg = msg;
+    lane->block = 0;
+    lane->full_blocks = length / 64;
+    tail_len = ( left < 56 ) ? 64 : 128;
+    lane->blocks = lane->full_blocks + tail_len / 64;
+
+    memcpy( lane->tail, input + ( length - left ), left );
+    memset( lane->tail + left, 0, tail_len - left );
+    lane->tail[left] = 0x80;
+    PUT_UINT32( (uint32_t) ( bits >> 32 ), lane->tail, tail_len - 8 );
+    PUT_UINT32( (uint32_t) bits,           lane->tail, tail_len - 4 );
+
+    state[0 * lanes] = 0x67452301;
+    state[1 * lanes] = 0xEFCDAB89;
+    state[2 * lanes] = 0x98BADCFE;
+    state[3 * lanes] = 0x10325476;
+    state[4 * lanes] = 0xC3D2E1F0;
+}
+
+static void sha1_batch_mb( sha1_mb_kernel_f kernel, uint32_t lanes,
+                           const uint8_t * const *inputs,
+                           const uint32_t *lengths, uint32_t count,
+                           uint8_t (*digests)[20] )
+{
+    static const uint8_t zero[64];
+    uint32_t state[5 * SHA1_MB_MAX_LANES] __attribute__ ((aligned (32)));
+    uint32_t w[16 * SHA1_MB_MAX_LANES] __attribute__ ((aligned (32)));
+    SSHA1Lane lane[SHA1_MB_MAX_LANES];
+    const uint8_t *block;
+    uint32_t i, j, next = 0, active = 0;
+
+    for( i = 0; i < lanes; i++ )
+    {
+        lane[i].msg = -1;
+        if( next < count )
+        {
+            sha1_lane_start( &lane[i], state + i, lanes, (int32_t) next,
+                             inputs[next], lengths[next] );
+            next++;
+            active++;
+        }
+    }
+
+    while( active > 0 )
+    {
+        /* Transpose the current block of each lane */
+        for( i = 0; i < lanes; i++ )
+        {
+            if( lane[i].msg < 0 )
+                block = zero;
+            else if( lane[i].block < lane[i].full_blocks )
+                block = inputs[lane[i].msg] + 64 * (size_t) lane[i].block;
+            else
+                block = lane[i].tail +
+                    64 * ( lane[i].block - lane[i].full_blocks );
+            for( j = 0; j < 16; j++ )
+                GET_UINT32( w[j * lanes + i], block, 4 * j );
+        }
+
+        kernel( state, w );
+
+        for( i = 0; i < lanes; i++ )
+        {
+            if( lane[i].msg < 0 || ++lane[i].block < lane[i].blocks )
+                continue;
+            for( j = 0; j < 5; j++ )
+                PUT_UINT32( state[j * lanes + i], digests[lane[i].msg],
+                            4 * j );
+            lane[i].msg = -1;
+            active--;
+            if( next < count )
+            {
+                sha1_lane_start( &lane[i], state + i, lanes, (int32_t) next,
+                                 inputs[next], lengths[next] );
+                next++;
+                active++;
+            }
+        }
+    }
+}
+
+/*
+ * Output SHA-1(inputs[i]) in digests[i], for i in [0, count[
+ */
+void sha1_batch( const uint8_t * const *inputs, const uint32_t *lengths,
+                 uint32_t count, uint8_t (*digests)[20] )
+{
+    SSHA1Context ctx;
+    uint32_t i;
+    int accel = sha1_get_accel();
+
+    if( ! ( accel & SHA1_ACCEL_SHANI ) )
+    {
+#ifdef HAVE_SHA1_X86
+        if( accel & SHA1_ACCEL_AVX2 )
+        {
+            sha1_batch_mb( sha1_mb_avx2, 8, inputs, lengths, count,
+                           digests );
+            return;
+        }
+#endif
+#ifdef HAVE_SHA1_SSE2
+        if( accel & SHA1_ACCEL_SSE2 )
+        {
+            sha1_batch_mb( sha1_mb_sse2, 4, inputs, lengths, count,
+                           digests );
+            return;
+        }
+#endif
+    }
+
+    for( i = 0; i < count; i++ )
+    {
+        sha1_starts( &ctx );
+        sha1_update( &ctx, inputs[i], lengths[i] );
+        sha1_finish( &ctx, digests[i] );
+    }
+}
+
 #ifdef TEST
 
 #include <stdlib.h>
@@ -47,5 +47,17 @@ void sha1_hmac( const uint8_t *key,
 		const uint8_t *buf, 
 		uint32_t buflen,
                 uint8_t digest[20] );
+void sha1_batch( const uint8_t * const *inputs,
+		 const uint32_t *lengths,
+		 uint32_t count,
+		 uint8_t (*digests)[20] );
+
+/* Accelerated implementations (see sha1_use_accel) */
+#define SHA1_ACCEL_SHANI 0x01   /* x86 SHA extensions */
+#define SHA1_ACCEL_AVX2  0x02   /* 8 lanes multi-buffer (sha1_batch) */
+#define SHA1_ACCEL_SSE2  0x04   /* 4 lanes multi-buffer (sha1_batch) */
+#define SHA1_ACCEL_ALL   0xFF
+
+int sha1_use_accel( int mask );
 
 #endif /* __CRYPT_SHA1_H__ */
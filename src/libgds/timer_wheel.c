@@ -0,0 +1,312 @@
+// ==================================================================
+// @(#)timer_wheel.c
+//
+// Hierarchical timing wheel.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Each level of the wheel is an array of 2^bits slots, each slot
+ * being an intrusive list of timers. A timer that expires in d ticks
+ * is put in the lowest level i such that d < 2^((i+1)*bits), in the
+ * slot given by bits [i*bits, (i+1)*bits) of its expiry tick.
+ *
+ * When the current tick crosses a multiple of 2^(i*bits), the slot
+ * of level i designated by the current tick is emptied and its
+ * timers are put again in the wheel ("cascade"): they now fall in a
+ * lower level. A timer is thus moved at most once per level and
+ * schedule, cancel and expiry take constant (amortized) time.
+ *
+ * A bitmap of the non-empty slots allows timer_wheel_advance() to
+ * jump over empty level-0 slots instead of visiting each tick.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/memory.h>
+#include <libgds/timer_wheel.h>
+
+struct gds_timer_wheel_t {
+  uint64_t          tick;
+  unsigned int      num_levels;
+  unsigned int      bits;
+  uint32_t          mask;        /* slots per level - 1 */
+  uint32_t          num_slots;   /* slots in all levels */
+  uint64_t          current;     /* current tick */
+  uint64_t          num_timers;
+  gds_dllist_t   ** lists;       /* slots, then list of due timers */
+  uint64_t        * occupied;    /* bitmap of the non-empty slots */
+};
+
+#define _DUE(W) ((W)->num_slots)
+
+// -----[ _timer_wheel_tick ]----------------------------------------
+/** Return the first tick at or after a time. */
+static inline uint64_t _timer_wheel_tick(gds_timer_wheel_t * wheel,
+					 uint64_t time)
+{
+  return time / wheel->tick + ((time % wheel->tick != 0)?1:0);
+}
+
+// -----[ timer_wheel_create ]---------------------------------------
+gds_timer_wheel_t * timer_wheel_create(uint64_t tick,
+				       unsigned int num_levels,
+				       unsigned int bits, uint64_t start)
+{
+  gds_timer_wheel_t * wheel;
+  unsigned int index;
+
+  if ((tick == 0) ||
+      (num_levels < 1) || (num_levels > TIMER_WHEEL_MAX_LEVELS) ||
+      (bits < 1) || (bits > TIMER_WHEEL_MAX_BITS) ||
+      (num_levels*bits > 64))
+    return NULL;
+
+  wheel= (gds_timer_wheel_t *) MALLOC(sizeof(gds_timer_wheel_t));
+  wheel->tick= tick;
+  wheel->num_levels= num_levels;
+  wheel->bits= bits;
+  wheel->mask= (1U << bits)-1;
+  wheel->num_slots= num_levels << bits;
+  wheel->current= start / tick;
+  wheel->num_timers= 0;
+  wheel->lists= (gds_dllist_t **)
+    MALLOC((wheel->num_slots+1)*sizeof(gds_dllist_t *));
+  for (index= 0; index <= wheel->num_slots; index++)
+    wheel->lists[index]= dllist_create_intrusive(NULL);
+  wheel->occupied= (uint64_t *)
+    MALLOC(((wheel->num_slots+63)/64)*sizeof(uint64_t));
+  memset(wheel->occupied, 0, ((wheel->num_slots+63)/64)*sizeof(uint64_t));
+  return wheel;
+}
+
+// -----[ timer_wheel_destroy ]--------------------------------------
+void timer_wheel_destroy(gds_timer_wheel_t ** wheel_ref)
+{
+  gds_timer_wheel_t * wheel= *wheel_ref;
+  gds_dllist_item_t * item;
+  unsigned int index;
+
+  if (wheel == NULL)
+    return;
+  for (index= 0; index <= wheel->num_slots; index++) {
+    while ((item= dllist_head(wheel->lists[index])) != NULL) {
+      dllist_unlink(wheel->lists[index], item);
+      DLLIST_ENTRY(item, gds_timer_t, item)->slot= TIMER_INACTIVE;
+    }
+    dllist_destroy(&wheel->lists[index]);
+  }
+  FREE(wheel->lists);
+  FREE(wheel->occupied);
+  FREE(wheel);
+  *wheel_ref= NULL;
+}
+
+// -----[ _timer_wheel_link ]----------------------------------------
+static inline void _timer_wheel_link(gds_timer_wheel_t * wheel,
+				     gds_timer_t * timer, uint32_t slot)
+{
+  dllist_insert_before(wheel->lists[slot], NULL, &timer->item);
+  timer->slot= slot;
+  if (slot < wheel->num_slots)
+    wheel->occupied[slot/64]|= ((uint64_t) 1) << (slot % 64);
+}
+
+// -----[ _timer_wheel_unlink ]--------------------------------------
+static inline void _timer_wheel_unlink(gds_timer_wheel_t * wheel,
+				       gds_timer_t * timer)
+{
+  uint32_t slot= timer->slot;
+
+  dllist_unlink(wheel->lists[slot], &timer->item);
+  if ((slot < wheel->num_slots) && (dllist_size(wheel->lists[slot]) == 0))
+    wheel->occupied[slot/64]&= ~(((uint64_t) 1) << (slot % 64));
+  timer->slot= TIMER_INACTIVE;
+}
+
+// -----[ _timer_wheel_place ]---------------------------------------
+/**
+ * Put a timer in the slot that corresponds to its expiry tick, or in
+ * the list of due timers.
+ */
+static inline void _timer_wheel_place(gds_timer_wheel_t * wheel,
+				      gds_timer_t * timer)
+{
+  uint64_t expires= _timer_wheel_tick(wheel, timer->expires);
+  uint64_t delta;
+  unsigned int level, range_bits;
+
+  if (expires <= wheel->current) {
+    _timer_wheel_link(wheel, timer, _DUE(wheel));
+    return;
+  }
+  delta= expires - wheel->current;
+  for (level= 0; level < wheel->num_levels-1; level++)
+    if ((delta >> (wheel->bits*(level+1))) == 0)
+      break;
+  // Beyond the range of the wheel: use the farthest slot, the timer
+  // will be placed again when this slot is cascaded
+  range_bits= wheel->bits*wheel->num_levels;
+  if ((range_bits < 64) && ((delta >> range_bits) != 0))
+    expires= wheel->current + (((uint64_t) 1) << range_bits) - 1;
+  _timer_wheel_link(wheel, timer,
+		    (level << wheel->bits) |
+		    ((expires >> (wheel->bits*level)) & wheel->mask));
+}
+
+// -----[ timer_wheel_schedule ]-------------------------------------
+void timer_wheel_schedule(gds_timer_wheel_t * wheel, gds_timer_t * timer,
+			  uint64_t expires)
+{
+  if (timer->slot != TIMER_INACTIVE)
+    _timer_wheel_unlink(wheel, timer);
+  else
+    wheel->num_timers++;
+  timer->expires= expires;
+  _timer_wheel_place(wheel, timer);
+}
+
+// -----[ timer_wheel_cancel ]---------------------------------------
+int timer_wheel_cancel(gds_timer_wheel_t * wheel, gds_timer_t * timer)
+{
+  if (timer->slot == TIMER_INACTIVE)
+    return -1;
+  _timer_wheel_unlink(wheel, timer);
+  wheel->num_timers--;
+  return 0;
+}
+
+// -----[ _timer_wheel_cascade ]-------------------------------------
+/**
+ * Called when the current tick is a multiple of 2^bits: empty the
+ * slots of the upper levels that the current tick designates.
+ */
+static inline void _timer_wheel_cascade(gds_timer_wheel_t * wheel)
+{
+  gds_dllist_item_t * item;
+  gds_timer_t * timer;
+  unsigned int level;
+  uint32_t index, slot;
+
+  for (level= 1; level < wheel->num_levels; level++) {
+    index= (wheel->current >> (wheel->bits*level)) & wheel->mask;
+    slot= (level << wheel->bits) | index;
+    // Timers never fall back in the slot being emptied
+    while ((item= dllist_head(wheel->lists[slot])) != NULL) {
+      timer= DLLIST_ENTRY(item, gds_timer_t, item);
+      _timer_wheel_unlink(wheel, timer);
+      _timer_wheel_place(wheel, timer);
+    }
+    if (index != 0)
+      break;
+  }
+}
+
+// -----[ _timer_wheel_fire ]----------------------------------------
+/**
+ * Fire the expired timers of a list. Timers that are not expired
+ * (beyond the range of the wheel when scheduled) are placed again.
+ */
+static inline uint64_t _timer_wheel_fire(gds_timer_wheel_t * wheel,
+					 uint32_t slot,
+					 gds_timer_wheel_f fire, void * ctx)
+{
+  gds_dllist_item_t * item;
+  gds_timer_t * timer;
+  uint64_t num_fired= 0;
+
+  while ((item= dllist_head(wheel->lists[slot])) != NULL) {
+    timer= DLLIST_ENTRY(item, gds_timer_t, item);
+    _timer_wheel_unlink(wheel, timer);
+    if (_timer_wheel_tick(wheel, timer->expires) > wheel->current) {
+      _timer_wheel_place(wheel, timer);
+      continue;
+    }
+    wheel->num_timers--;
+    num_fired++;
+    fire(timer, ctx);
+  }
+  return num_fired;
+}
+
+// -----[ _timer_wheel_next_slot ]-----------------------------------
+/**
+ * Return the first non-empty slot of level 0 at or after the given
+ * index, or -1 if there is none.
+ */
+static inline int _timer_wheel_next_slot(gds_timer_wheel_t * wheel,
+					 uint32_t index)
+{
+  uint64_t word;
+
+  while (index <= wheel->mask) {
+    word= wheel->occupied[index/64] >> (index % 64);
+    if (word != 0) {
+      // With less than 64 slots per level, the word also holds the
+      // slots of the upper levels
+      index+= __builtin_ctzll(word);
+      return (index <= wheel->mask)?(int) index:-1;
+    }
+    index= (index | 63) + 1;
+  }
+  return -1;
+}
+
+// -----[ timer_wheel_advance ]--------------------------------------
+uint64_t timer_wheel_advance(gds_timer_wheel_t * wheel, uint64_t now,
+			     gds_timer_wheel_f fire, void * ctx)
+{
+  uint64_t target= now / wheel->tick;
+  uint64_t num_fired, next;
+  int index;
+
+  num_fired= _timer_wheel_fire(wheel, _DUE(wheel), fire, ctx);
+  while (wheel->current < target) {
+    if (wheel->num_timers == 0) {
+      wheel->current= target;
+      break;
+    }
+
+    // Jump to the next non-empty slot of level 0, or to the next
+    // cascade
+    next= wheel->current+1;
+    if ((next & wheel->mask) != 0) {
+      index= _timer_wheel_next_slot(wheel, next & wheel->mask);
+      if (index < 0)
+	next= (next | wheel->mask) + 1;
+      else
+	next= (next & ~((uint64_t) wheel->mask)) | index;
+      if (next > target) {
+	wheel->current= target;
+	break;
+      }
+    }
+    wheel->current= next;
+
+    if ((next & wheel->mask) == 0)
+      _timer_wheel_cascade(wheel);
+    num_fired+= _timer_wheel_fire(wheel, next & wheel->mask, fire, ctx);
+    num_fired+= _timer_wheel_fire(wheel, _DUE(wheel), fire, ctx);
+  }
+  return num_fired;
+}
+
+// -----[ timer_wheel_num_timers ]-----------------------------------
+uint64_t timer_wheel_num_timers(gds_timer_wheel_t * wheel)
+{
+  return wheel->num_timers;
+}
+
+// -----[ timer_wheel_time ]-----------------------------------------
+uint64_t timer_wheel_time(gds_timer_wheel_t * wheel)
+{
+  return wheel->current * wheel->tick;
+}
@@ -0,0 +1,155 @@
+// ==================================================================
+// @(#)timer_wheel.h
+//
+// Hierarchical timing wheel.
+//
+// @author agent (agent@local)
+// @date 18/10/2026
+// $Id$
+// ==================================================================
+
+/**
+ * \file
+ * Provide a hierarchical timing wheel: an event scheduler for
+ * integer timestamps with constant time schedule and cancel, and
+ * amortized constant time expiry.
+ *
+ * Time is divided into ticks of a configurable duration. Timers
+ * only fire at tick boundaries: a timer fires during the first call
+ * to timer_wheel_advance() whose time reaches the first tick
+ * boundary at or after its expiry time. With a tick of 1, timers
+ * fire exactly when their expiry time is reached.
+ *
+ * Timers are embedded in the user's structures (see DLLIST_ENTRY()
+ * to obtain the enclosing structure from a timer).
+ */
+
+#ifndef __GDS_TIMER_WHEEL_H__
+#define __GDS_TIMER_WHEEL_H__
+
+#include <libgds/dllist.h>
+#include <libgds/types.h>
+
+/** Maximum number of levels of a timing wheel. */
+#define TIMER_WHEEL_MAX_LEVELS 8
+/** Maximum number of bits per level (256 slots). */
+#define TIMER_WHEEL_MAX_BITS   8
+
+/** Slot of a timer that is not scheduled. */
+#define TIMER_INACTIVE MAX_UINT32_T
+
+// -----[ gds_timer_t ]----------------------------------------------
+/**
+ * Timer. Must be initialized with timer_init() before its first
+ * use. The fields are private.
+ */
+typedef struct {
+  gds_dllist_item_t item;
+  uint64_t          expires;
+  uint32_t          slot;
+} gds_timer_t;
+
+// -----[ gds_timer_wheel_f ]----------------------------------------
+/**
+ * Callback function called for each expired timer. The timer is not
+ * scheduled anymore when the callback is called. The callback can
+ * schedule it again, schedule or cancel other timers.
+ */
+typedef void (*gds_timer_wheel_f)(gds_timer_t * timer, void * ctx);
+
+typedef struct gds_timer_wheel_t gds_timer_wheel_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ timer_init ]---------------------------------------------
+  static inline void timer_init(gds_timer_t * timer) {
+    timer->slot= TIMER_INACTIVE;
+  }
+
+  // -----[ timer_is_active ]----------------------------------------
+  static inline int timer_is_active(gds_timer_t * timer) {
+    return (timer->slot != TIMER_INACTIVE);
+  }
+
+  // -----[ timer_expires ]------------------------------------------
+  /** Return the expiry time of a timer. */
+  static inline uint64_t timer_expires(gds_timer_t * timer) {
+    return timer->expires;
+  }
+
+  // -----[ timer_wheel_create ]-------------------------------------
+  /**
+   * Create a timing wheel.
+   *
+   * The wheel has num_levels levels of 2^bits slots. A slot of level
+   * i spans 2^(i*bits) ticks. Timers that expire beyond the range of
+   * the wheel (2^(num_levels*bits) ticks) are kept in the last level
+   * and cascaded again until they get in range.
+   *
+   * \param tick is the duration of a tick (>0).
+   * \param num_levels is the number of levels (1 to
+   *   TIMER_WHEEL_MAX_LEVELS).
+   * \param bits is the number of bits per level (1 to
+   *   TIMER_WHEEL_MAX_BITS).
+   * \param start is the initial time.
+   * \retval the new wheel, or NULL if a parameter is invalid.
+   */
+  gds_timer_wheel_t * timer_wheel_create(uint64_t tick,
+					 unsigned int num_levels,
+					 unsigned int bits, uint64_t start);
+
+  // -----[ timer_wheel_destroy ]------------------------------------
+  /**
+   * Destroy a timing wheel. The scheduled timers are cancelled.
+   */
+  void timer_wheel_destroy(gds_timer_wheel_t ** wheel_ref);
+
+  // -----[ timer_wheel_schedule ]-----------------------------------
+  /**
+   * Schedule a timer. If the timer is already scheduled, it is
+   * rescheduled. A timer whose expiry time is not after the current
+   * time fires during the next call to timer_wheel_advance().
+   */
+  void timer_wheel_schedule(gds_timer_wheel_t * wheel, gds_timer_t * timer,
+			    uint64_t expires);
+
+  // -----[ timer_wheel_cancel ]-------------------------------------
+  /**
+   * Cancel a timer.
+   *
+   * \retval 0 in case of success,
+   *   or -1 if the timer is not scheduled.
+   */
+  int timer_wheel_cancel(gds_timer_wheel_t * wheel, gds_timer_t * timer);
+
+  // -----[ timer_wheel_advance ]------------------------------------
+  /**
+   * Advance the time of the wheel and fire the expired timers, in
+   * the order of their ticks. Timers scheduled with an expiry time
+   * that was already reached fire first, in the order of their
+   * scheduling.
+   *
+   * \param wheel is the target wheel.
+   * \param now is the new time. If it is before the current time,
+   *   only the timers that are already due fire.
+   * \param fire is the callback function.
+   * \param ctx is the context passed to the callback function.
+   * \retval the number of timers that fired.
+   */
+  uint64_t timer_wheel_advance(gds_timer_wheel_t * wheel, uint64_t now,
+			       gds_timer_wheel_f fire, void * ctx);
+
+  // -----[ timer_wheel_num_timers ]---------------------------------
+  uint64_t timer_wheel_num_timers(gds_timer_wheel_t * wheel);
+
+  // -----[ timer_wheel_time ]---------------------------------------
+  /** Return the current time (start of the current tick). */
+  uint64_t timer_wheel_time(gds_timer_wheel_t * wheel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GDS_TIMER_WHEEL_H__ */
@@ -14,6 +14,8 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <libgds/array.h>
 #include <libgds/memory.h>
@@ -26,10 +28,20 @@ typedef struct _trie_item_t {
   struct _trie_item_t * right;
   trie_key_t            key;
   uint8_t               has_data:1,
-    key_len :7;
+    in_block:1, // node allocated by trie_bulk_load
+    key_len :6;
   void                * data;
 } _trie_item_t;
 
+// -----[ _trie_block_t ]--------------------------------------------
+/**
+ * Block of contiguous nodes allocated by trie_bulk_load. The nodes
+ * follow the header. They are released with the trie.
+ */
+typedef struct _trie_block_t {
+  struct _trie_block_t * next;
+} _trie_block_t;
+
 // -----[ precomputed masks ]----------------------------------------
 static trie_key_t trie_predef_masks[TRIE_KEY_SIZE+1];
 
@@ -78,6 +90,7 @@ _trie_item_t * _trie_item_create_data(trie_key_t key,
   trie_item->key= key;
   trie_item->key_len= key_len;
   trie_item->has_data= 1;
+  trie_item->in_block= 0;
   trie_item->data= data;
   return trie_item;
 }
@@ -93,10 +106,22 @@ _trie_item_t * _trie_item_create_empty(trie_key_t key,
   trie_item->key= key;
   trie_item->key_len= key_len;
   trie_item->has_data= 0;
+  trie_item->in_block= 0;
   trie_item->data= NULL;
   return trie_item;
 }
 
+// -----[ _trie_item_free ]------------------------------------------
+/**
+ * Free a node. Nodes that belong to a block are only released with
+ * the block.
+ */
+static inline void _trie_item_free(_trie_item_t * trie_item)
+{
+  if (!trie_item->in_block)
+    FREE(trie_item);
+}
+
 // -----[ _longest_common_prefix ]------------------------------------
 /**
  * Compute the longest common prefix between two given keys.
@@ -135,6 +160,7 @@ gds_trie_t * trie_create(gds_trie_destroy_f destroy)
   gds_trie_t * trie= (gds_trie_t *) MALLOC(sizeof(gds_trie_t));
   trie->root= NULL;
   trie->destroy= destroy;
+  trie->blocks= NULL;
   return trie;
 }
 
@@ -381,7 +407,7 @@ static inline void _trie_remove_item(_trie_item_t ** item,
       *item= (*item)->left;
     else
       *item= (*item)->right;
-    FREE(tmp);
+    _trie_item_free(tmp);
   }
 }
 
@@ -443,7 +469,7 @@ static int _trie_remove(_trie_item_t ** item, const trie_key_t key,
 	  *item= (*item)->left;
 	else
 	  *item= (*item)->right;
-	FREE(tmp);
+	_trie_item_free(tmp);
       }
     }
     return result;
@@ -555,15 +581,22 @@ static void _trie_destroy(_trie_item_t ** item, gds_trie_destroy_f destroy)
     if ((*item)->right != NULL)
       _trie_destroy(&(*item)->right, destroy);
 
-    FREE(*item);
+    _trie_item_free(*item);
   }
 }
 
 // -----[ trie_destroy ]---------------------------------------------
 void trie_destroy(gds_trie_t ** trie_ref)
 {
+  _trie_block_t * block;
+
   if (*trie_ref != NULL) {
     _trie_destroy(&(*trie_ref)->root, (*trie_ref)->destroy);
+    while ((*trie_ref)->blocks != NULL) {
+      block= (*trie_ref)->blocks;
+      (*trie_ref)->blocks= block->next;
+      FREE(block);
+    }
     FREE(*trie_ref);
     *trie_ref= NULL;
   }
@@ -665,6 +698,192 @@ void trie_to_graphviz(gds_stream_t * stream, gds_trie_t * trie)
   stack_destroy(&stack);
 }
 
+/////////////////////////////////////////////////////////////////////
+//
+// BULK LOADING
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _trie_bulk_cmp ]-------------------------------------------
+/**
+ * Compare two items in key order: masked keys first, then shorter
+ * keys first. This is the order in which keys appear in a preorder
+ * traversal of the trie (a prefix precedes the keys it covers).
+ */
+static int _trie_bulk_cmp(const void * item1, const void * item2)
+{
+  const gds_trie_bulk_item_t * i1= (const gds_trie_bulk_item_t *) item1;
+  const gds_trie_bulk_item_t * i2= (const gds_trie_bulk_item_t *) item2;
+  trie_key_t key1= _trie_mask_key(i1->key, i1->key_len);
+  trie_key_t key2= _trie_mask_key(i2->key, i2->key_len);
+
+  if (key1 < key2)
+    return -1;
+  if (key1 > key2)
+    return 1;
+  if (i1->key_len < i2->key_len)
+    return -1;
+  if (i1->key_len > i2->key_len)
+    return 1;
+  return 0;
+}
+
+// -----[ _trie_bulk_split ]-----------------------------------------
+/**
+ * Compute the node that covers a sorted range of items: its key is
+ * the longest common prefix of the first and last items. If the
+ * first item is equal to this prefix, it is the node's data. The
+ * remaining items are split according to the bit that follows the
+ * prefix: 'mid' is the first item in the right subtree.
+ */
+static inline void _trie_bulk_split(const gds_trie_bulk_item_t * items,
+				    unsigned int lo, unsigned int hi,
+				    trie_key_t * prefix,
+				    trie_key_len_t * prefix_len,
+				    int * has_data,
+				    unsigned int * mid)
+{
+  trie_key_t mask, diff;
+  unsigned int low, high, middle;
+
+  // Longest common prefix of the first and last items
+  *prefix_len= (items[lo].key_len < items[hi-1].key_len)?
+    items[lo].key_len:items[hi-1].key_len;
+  diff= items[lo].key ^ items[hi-1].key;
+  if ((diff != 0) && (__builtin_clz(diff) < *prefix_len))
+    *prefix_len= __builtin_clz(diff);
+  *prefix= _trie_mask_key(items[lo].key, *prefix_len);
+  *has_data= (items[lo].key_len == *prefix_len);
+  low= lo + (*has_data?1:0);
+  high= hi;
+  if ((low < high) && (*prefix_len < TRIE_KEY_SIZE)) {
+    // Items are sorted: those with a 0 after the prefix come first
+    mask= ((trie_key_t) 1) << (TRIE_KEY_SIZE-*prefix_len-1);
+    while (low < high) {
+      middle= (low+high)/2;
+      if (items[middle].key & mask)
+	high= middle;
+      else
+	low= middle+1;
+    }
+  }
+  *mid= low;
+}
+
+// -----[ _trie_bulk_count ]-----------------------------------------
+/**
+ * Return the number of nodes required to store a sorted range of
+ * items.
+ */
+static unsigned int _trie_bulk_count(const gds_trie_bulk_item_t * items,
+				     unsigned int lo, unsigned int hi)
+{
+  trie_key_t prefix;
+  trie_key_len_t prefix_len;
+  int has_data;
+  unsigned int mid;
+  unsigned int count= 1;
+
+  _trie_bulk_split(items, lo, hi, &prefix, &prefix_len, &has_data, &mid);
+  if (has_data)
+    lo++;
+  if (lo < mid)
+    count+= _trie_bulk_count(items, lo, mid);
+  if (mid < hi)
+    count+= _trie_bulk_count(items, mid, hi);
+  return count;
+}
+
+// -----[ _trie_bulk_build ]-----------------------------------------
+/**
+ * Build the subtree that stores a sorted range of items. Nodes are
+ * taken in sequence from a block (preorder).
+ */
+static _trie_item_t * _trie_bulk_build(const gds_trie_bulk_item_t * items,
+				       unsigned int lo, unsigned int hi,
+				       _trie_item_t ** next)
+{
+  _trie_item_t * trie_item= (*next)++;
+  trie_key_t prefix;
+  trie_key_len_t prefix_len;
+  int has_data;
+  unsigned int mid;
+
+  _trie_bulk_split(items, lo, hi, &prefix, &prefix_len, &has_data, &mid);
+  trie_item->key= prefix;
+  trie_item->key_len= prefix_len;
+  trie_item->has_data= has_data;
+  trie_item->in_block= 1;
+  trie_item->data= NULL;
+  trie_item->left= NULL;
+  trie_item->right= NULL;
+  if (has_data)
+    trie_item->data= items[lo++].data;
+  if (lo < mid)
+    trie_item->left= _trie_bulk_build(items, lo, mid, next);
+  if (mid < hi)
+    trie_item->right= _trie_bulk_build(items, mid, hi, next);
+  return trie_item;
+}
+
+// -----[ trie_bulk_load ]-------------------------------------------
+int trie_bulk_load(gds_trie_t * trie, const gds_trie_bulk_item_t * items,
+		   unsigned int num_items)
+{
+  gds_trie_bulk_item_t * sorted= NULL;
+  _trie_block_t * block;
+  _trie_item_t * next;
+  unsigned int index, num_nodes;
+  int cmp;
+
+  if (num_items == 0)
+    return TRIE_SUCCESS;
+
+  // Non-empty trie: insert the items one by one, up to the first
+  // invalid one
+  if (trie->root != NULL) {
+    for (index= 0; index < num_items; index++)
+      if (trie_insert(trie, items[index].key, items[index].key_len,
+		      items[index].data, 0) != TRIE_SUCCESS)
+	return TRIE_ERROR_DUPLICATE;
+    return TRIE_SUCCESS;
+  }
+
+  // Check that the items are sorted, otherwise sort a copy
+  for (index= 1; index < num_items; index++) {
+    cmp= _trie_bulk_cmp(&items[index-1], &items[index]);
+    if (cmp == 0)
+      return TRIE_ERROR_DUPLICATE;
+    if (cmp > 0)
+      break;
+  }
+  if (index < num_items) {
+    sorted= (gds_trie_bulk_item_t *)
+      MALLOC(num_items*sizeof(gds_trie_bulk_item_t));
+    memcpy(sorted, items, num_items*sizeof(gds_trie_bulk_item_t));
+    qsort(sorted, num_items, sizeof(gds_trie_bulk_item_t), _trie_bulk_cmp);
+    for (index= 1; index < num_items; index++)
+      if (_trie_bulk_cmp(&sorted[index-1], &sorted[index]) == 0) {
+	FREE(sorted);
+	return TRIE_ERROR_DUPLICATE;
+      }
+    items= sorted;
+  }
+
+  num_nodes= _trie_bulk_count(items, 0, num_items);
+  block= (_trie_block_t *) MALLOC(sizeof(_trie_block_t) +
+				  num_nodes*sizeof(_trie_item_t));
+  block->next= trie->blocks;
+  trie->blocks= block;
+  next= (_trie_item_t *) (block+1);
+  trie->root= _trie_bulk_build(items, 0, num_items, &next);
+  assert(next == ((_trie_item_t *) (block+1)) + num_nodes);
+
+  if (sorted != NULL)
+    FREE(sorted);
+  return TRIE_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
 //
 // ENUMERATION
@@ -694,47 +913,292 @@ ptr_array_t * _trie_get_array(gds_trie_t * trie)
   return array;
 }
 
+// -----[ _trie_seek ]-----------------------------------------------
+/**
+ * Return the node whose subtree holds exactly the keys that start
+ * with the given prefix, or NULL if there is no such key.
+ */
+static _trie_item_t * _trie_seek(gds_trie_t * trie, trie_key_t key,
+				 trie_key_len_t key_len)
+{
+  _trie_item_t * item= trie->root;
+
+  key= _trie_mask_key(key, key_len);
+  while (item != NULL) {
+    if (item->key_len >= key_len) {
+      if (_trie_mask_key(item->key, key_len) != key)
+	return NULL;
+      return item;
+    }
+    if (_trie_mask_key(key, item->key_len) != item->key)
+      return NULL;
+    if (key & (1U << (TRIE_KEY_SIZE-item->key_len-1)))
+      item= item->right;
+    else
+      item= item->left;
+  }
+  return NULL;
+}
+
+// -----[ trie_cursor_init ]-----------------------------------------
+void trie_cursor_init(gds_trie_cursor_t * cursor, gds_trie_t * trie)
+{
+  cursor->depth= 0;
+  if (trie->root != NULL)
+    cursor->stack[cursor->depth++]= trie->root;
+}
+
+// -----[ trie_cursor_init_prefix ]----------------------------------
+void trie_cursor_init_prefix(gds_trie_cursor_t * cursor, gds_trie_t * trie,
+			     trie_key_t key, trie_key_len_t key_len)
+{
+  _trie_item_t * item= NULL;
+
+  cursor->depth= 0;
+  if (key_len <= TRIE_KEY_SIZE)
+    item= _trie_seek(trie, key, key_len);
+  if (item != NULL)
+    cursor->stack[cursor->depth++]= item;
+}
+
+// -----[ _trie_cursor_next_item ]-----------------------------------
+/**
+ * Depth-first traversal, the node first, then the left (0) and the
+ * right (1) children. The stack holds the nodes still to be visited,
+ * i.e. at most one right child per level and the two children of
+ * the last node, hence at most TRIE_KEY_SIZE+1 nodes.
+ */
+static inline _trie_item_t * _trie_cursor_next_item(gds_trie_cursor_t * cursor)
+{
+  _trie_item_t * item;
+
+  while (cursor->depth > 0) {
+    item= cursor->stack[--cursor->depth];
+    if (item->right != NULL)
+      cursor->stack[cursor->depth++]= item->right;
+    if (item->left != NULL)
+      cursor->stack[cursor->depth++]= item->left;
+    if (item->has_data)
+      return item;
+  }
+  return NULL;
+}
+
+// -----[ trie_cursor_next ]-----------------------------------------
+int trie_cursor_next(gds_trie_cursor_t * cursor, trie_key_t * key_ref,
+		     trie_key_len_t * key_len_ref, void ** data_ref)
+{
+  _trie_item_t * item= _trie_cursor_next_item(cursor);
+
+  if (item == NULL)
+    return 0;
+  if (key_ref != NULL)
+    *key_ref= item->key;
+  if (key_len_ref != NULL)
+    *key_len_ref= item->key_len;
+  if (data_ref != NULL)
+    *data_ref= item->data;
+  return 1;
+}
+
 // ----- _enum_ctx_t -------------------------------------------
 typedef struct {
-  ptr_array_t * array;
-  gds_enum_t  * enu;
+  gds_trie_cursor_t   cursor;
+  _trie_item_t      * next;
 } _enum_ctx_t;
 
 // -----[ _trie_get_enum_has_next ]----------------------------------
 static int _trie_get_enum_has_next(void * ctx)
 {
   _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
-  return enum_has_next(ectx->enu);
+  if (ectx->next == NULL)
+    ectx->next= _trie_cursor_next_item(&ectx->cursor);
+  return (ectx->next != NULL);
 }
 
 // -----[ _trie_get_enum_get_next ]----------------------------------
 static void * _trie_get_enum_get_next(void * ctx)
 {
   _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
-  return enum_get_next(ectx->enu);
+  _trie_item_t * item;
+
+  if (!_trie_get_enum_has_next(ctx))
+    return NULL;
+  item= ectx->next;
+  ectx->next= NULL;
+  return &item->data;
+}
+
+// -----[ _trie_get_enum_get_next_n ]--------------------------------
+static unsigned int _trie_get_enum_get_next_n(void * ctx, void ** items,
+					      unsigned int num)
+{
+  _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
+  _trie_item_t * item;
+  unsigned int count= 0;
+
+  if ((num > 0) && (ectx->next != NULL)) {
+    items[count++]= &ectx->next->data;
+    ectx->next= NULL;
+  }
+  while ((count < num) &&
+	 ((item= _trie_cursor_next_item(&ectx->cursor)) != NULL))
+    items[count++]= &item->data;
+  return count;
 }
 
 // -----[ _trie_get_enum_destroy ]-----------------------------------
 static void _trie_get_enum_destroy(void * ctx)
 {
   _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
-  enum_destroy(&ectx->enu);
-  ptr_array_destroy(&ectx->array);
   FREE(ectx);
 }
 
-// -----[ trie_get_enum ]--------------------------------------------
-gds_enum_t * trie_get_enum(gds_trie_t * trie)
+// -----[ trie_get_prefix_enum ]-------------------------------------
+gds_enum_t * trie_get_prefix_enum(gds_trie_t * trie, trie_key_t key,
+				  trie_key_len_t key_len)
 {
   _enum_ctx_t * ectx=
     (_enum_ctx_t *) MALLOC(sizeof(_enum_ctx_t));
-  ectx->array= _trie_get_array(trie);
-  ectx->enu= _array_get_enum((array_t *) ectx->array);
+  gds_enum_t * enu;
+  trie_cursor_init_prefix(&ectx->cursor, trie, key, key_len);
+  ectx->next= NULL;
+
+  enu= enum_create(ectx,
+		   _trie_get_enum_has_next,
+		   _trie_get_enum_get_next,
+		   _trie_get_enum_destroy);
+  enu->ops.get_next_n= _trie_get_enum_get_next_n;
+  return enu;
+}
+
+// -----[ trie_get_enum ]--------------------------------------------
+gds_enum_t * trie_get_enum(gds_trie_t * trie)
+{
+  return trie_get_prefix_enum(trie, 0, 0);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// PARALLEL TRAVERSAL
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _trie_split_t ]--------------------------------------------
+/** Unit of a parallel traversal: a whole subtree or a single node. */
+typedef struct {
+  _trie_item_t * item;
+  int            subtree;
+} _trie_split_t;
+
+typedef struct {
+  _trie_split_t      * splits;
+  gds_trie_foreach_f   foreach;
+} _trie_parallel_ctx_t;
+
+// -----[ _trie_split ]----------------------------------------------
+/**
+ * Split a trie in units, in the order of the keys. Each pass
+ * replaces each subtree by its root node (if it has data) and the
+ * subtrees of its children, until there are at least \a num_splits
+ * units or no subtree can be split further.
+ */
+static _trie_split_t * _trie_split(gds_trie_t * trie,
+				   unsigned int num_splits,
+				   unsigned int * num_ref)
+{
+  _trie_split_t * splits, * new_splits;
+  unsigned int num= 0, new_num, index;
+  int split;
+
+  splits= (_trie_split_t *) MALLOC(sizeof(_trie_split_t));
+  if (trie->root != NULL) {
+    splits[0].item= trie->root;
+    splits[0].subtree= 1;
+    num= 1;
+  }
+  split= 1;
+  while (split && (num > 0) && (num < num_splits)) {
+    new_splits= (_trie_split_t *) MALLOC(3*num*sizeof(_trie_split_t));
+    new_num= 0;
+    split= 0;
+    for (index= 0; index < num; index++) {
+      if (!splits[index].subtree ||
+	  ((splits[index].item->left == NULL) &&
+	   (splits[index].item->right == NULL))) {
+	new_splits[new_num++]= splits[index];
+	continue;
+      }
+      split= 1;
+      if (splits[index].item->has_data) {
+	new_splits[new_num].item= splits[index].item;
+	new_splits[new_num++].subtree= 0;
+      }
+      if (splits[index].item->left != NULL) {
+	new_splits[new_num].item= splits[index].item->left;
+	new_splits[new_num++].subtree= 1;
+      }
+      if (splits[index].item->right != NULL) {
+	new_splits[new_num].item= splits[index].item->right;
+	new_splits[new_num++].subtree= 1;
+      }
+    }
+    FREE(splits);
+    splits= new_splits;
+    num= new_num;
+  }
+  *num_ref= num;
+  return splits;
+}
+
+// -----[ _trie_parallel_range ]-------------------------------------
+static int _trie_parallel_range(unsigned int begin, unsigned int end,
+				void * part, void * ctx)
+{
+  _trie_parallel_ctx_t * pctx= (_trie_parallel_ctx_t *) ctx;
+  gds_trie_cursor_t cursor;
+  _trie_item_t * item;
+  unsigned int index;
+  int result;
+
+  for (index= begin; index < end; index++) {
+    item= pctx->splits[index].item;
+    if (!pctx->splits[index].subtree) {
+      result= pctx->foreach(item->key, item->key_len, item->data, part);
+      if (result != 0)
+	return result;
+      continue;
+    }
+    cursor.stack[0]= item;
+    cursor.depth= 1;
+    while ((item= _trie_cursor_next_item(&cursor)) != NULL) {
+      result= pctx->foreach(item->key, item->key_len, item->data, part);
+      if (result != 0)
+	return result;
+    }
+  }
+  return 0;
+}
+
+// -----[ trie_parallel_for_each ]-----------------------------------
+/**
+ * The trie is split in about 8 units per worker, each unit being
+ * run by a cursor.
+ */
+int trie_parallel_for_each(gds_trie_t * trie, gds_pool_t * pool,
+			   gds_trie_foreach_f foreach, void * ctx,
+			   const gds_pool_reducer_t * reducer, int options)
+{
+  _trie_parallel_ctx_t pctx;
+  unsigned int num_splits;
+  int result;
 
-  return enum_create(ectx,
-		     _trie_get_enum_has_next,
-		     _trie_get_enum_get_next,
-		     _trie_get_enum_destroy);
+  pctx.splits= _trie_split(trie, 8*pool_num_workers(pool), &num_splits);
+  pctx.foreach= foreach;
+  result= pool_run(pool, num_splits, 1, _trie_parallel_range, &pctx,
+		   reducer, ctx, options);
+  FREE(pctx.splits);
+  return result;
 }
 
 /////////////////////////////////////////////////////////////////////
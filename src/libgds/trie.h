@@ -18,6 +18,7 @@
 #define __GDS_TRIE_H__
 
 #include <libgds/array.h>
+#include <libgds/pool.h>
 #include <libgds/stream.h>
 
 /** Trie key data type. */
@@ -33,6 +34,16 @@ typedef uint8_t trie_key_len_t;
 
 #define TRIE_KEY_SIZE (sizeof(trie_key_t)*8)
 
+// -----[ gds_trie_bulk_item_t ]------------------------------------
+/**
+ * Item of an array passed to \c trie_bulk_load.
+ */
+typedef struct {
+  trie_key_t       key;
+  trie_key_len_t   key_len;
+  void           * data;
+} gds_trie_bulk_item_t;
+
 /** Callback function to traverse whole trie. */
 typedef int  (*gds_trie_foreach_f) (trie_key_t key, trie_key_len_t key_len,
 				    void * data, void * ctx);
@@ -45,10 +56,24 @@ typedef void (*gds_trie_destroy_f) (void ** data);
  * Trie data structure.
  */
 typedef struct gds_trie_t {
-  struct _trie_item_t * root;
-  gds_trie_destroy_f    destroy;
+  struct _trie_item_t  * root;
+  gds_trie_destroy_f     destroy;
+  struct _trie_block_t * blocks;
 } gds_trie_t;
 
+// -----[ gds_trie_cursor_t ]----------------------------------------
+/**
+ * Cursor over the non empty nodes of a trie, in the order of the
+ * keys, a prefix coming before the longer prefixes it contains (see
+ * GDS_FOREACH). The fields are private. The cursor holds a fixed
+ * stack: no memory is allocated. The trie must not be modified
+ * during the traversal.
+ */
+typedef struct {
+  struct _trie_item_t * stack[TRIE_KEY_SIZE+1];
+  unsigned int          depth;
+} gds_trie_cursor_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -121,6 +146,32 @@ extern "C" {
 		  trie_key_len_t key_len, void * data,
 		  int replace);
 
+  // -----[ trie_bulk_load ]-----------------------------------------
+  /**
+   * Load an array of items in a trie.
+   *
+   * If the trie is empty, it is built bottom-up in a single pass,
+   * with all its nodes allocated in one contiguous block. The build
+   * is fastest when the items are sorted by key (masked key, then
+   * key length). Otherwise, a sorted copy of the array is made. The
+   * array itself is never modified.
+   *
+   * If the trie is not empty, the items are inserted one by one
+   * with \c trie_insert. The load stops at the first key that is
+   * already in the trie (including a key that appears earlier in the
+   * array). The items that precede it remain loaded and the existing
+   * keys are left unchanged.
+   *
+   * \param trie      is the trie.
+   * \param items     is the array of items.
+   * \param num_items is the number of items.
+   * \retval TRIE_SUCCESS in case of success, or TRIE_ERROR_DUPLICATE
+   *   if a key appears more than once (in an empty trie, nothing is
+   *   loaded in this case).
+   */
+  int trie_bulk_load(gds_trie_t * trie, const gds_trie_bulk_item_t * items,
+		     unsigned int num_items);
+
   // -----[ trie_remove ]--------------------------------------------
   /**
    * Remove a key from a trie.
@@ -167,6 +218,30 @@ extern "C" {
   int trie_for_each(gds_trie_t * trie, gds_trie_foreach_f foreach,
 		    void * ctx);
 
+  // -----[ trie_parallel_for_each ]---------------------------------
+  /**
+   * Traverse a whole trie in parallel (see pool_run()).
+   *
+   * The trie is split in units (subtrees and single nodes) in the
+   * order of the keys. Unlike trie_for_each(), the nodes of a unit
+   * are visited in the order of the keys (see gds_trie_cursor_t).
+   *
+   * \param trie    is the trie.
+   * \param pool    is the pool of workers.
+   * \param foreach is the callback function.
+   * \param ctx     is the callback context pointer.
+   * \param reducer is the description of the partial results, passed
+   *   to \a foreach instead of \a ctx (can be NULL).
+   * \param options is a combination of options (POOL_OPTION_*).
+   * \retval 0 in case all calls to \a foreach succeeded, or the
+   *   first (in the order of the keys) non-zero value returned by
+   *   \a foreach.
+   */
+  int trie_parallel_for_each(gds_trie_t * trie, gds_pool_t * pool,
+			     gds_trie_foreach_f foreach, void * ctx,
+			     const gds_pool_reducer_t * reducer,
+			     int options);
+
   // -----[ trie_get_array ]-----------------------------------------
   /**
    * Return an array with the items in the trie.
@@ -175,10 +250,53 @@ extern "C" {
 
   // -----[ trie_get_enum ]------------------------------------------
   /**
-   * Return an enumeration for items in the trie.
+   * Return an enumeration for items in the trie. Each element is a
+   * pointer to the data of a node. The nodes are enumerated lazily,
+   * in the order of the keys (see gds_trie_cursor_t): the trie must
+   * not be modified while the enumeration is in use.
    */
   gds_enum_t * trie_get_enum(gds_trie_t * trie);
 
+  // -----[ trie_get_prefix_enum ]-----------------------------------
+  /**
+   * Return an enumeration for the items whose key starts with a given
+   * prefix, i.e. the prefix itself and the more specific prefixes it
+   * contains. The enumeration directly starts at the node that holds
+   * the prefix.
+   *
+   * \param trie    is the trie.
+   * \param key     is the prefix.
+   * \param key_len is the prefix length (0 matches all the keys).
+   */
+  gds_enum_t * trie_get_prefix_enum(gds_trie_t * trie, trie_key_t key,
+				    trie_key_len_t key_len);
+
+  // -----[ trie_cursor_init ]---------------------------------------
+  void trie_cursor_init(gds_trie_cursor_t * cursor, gds_trie_t * trie);
+
+  // -----[ trie_cursor_init_prefix ]--------------------------------
+  /**
+   * Initialize a cursor over the items whose key starts with a given
+   * prefix (see trie_get_prefix_enum()).
+   */
+  void trie_cursor_init_prefix(gds_trie_cursor_t * cursor,
+			       gds_trie_t * trie, trie_key_t key,
+			       trie_key_len_t key_len);
+
+  // -----[ trie_cursor_next ]---------------------------------------
+  /**
+   * Get the next non empty node of a cursor.
+   *
+   * \param cursor      is the cursor.
+   * \param key_ref     is set to the key of the node (can be NULL).
+   * \param key_len_ref is set to the key length (can be NULL).
+   * \param data_ref    is set to the data of the node (can be NULL).
+   * \retval 1 if a node is returned,
+   *   or 0 if the traversal is over.
+   */
+  int trie_cursor_next(gds_trie_cursor_t * cursor, trie_key_t * key_ref,
+		       trie_key_len_t * key_len_ref, void ** data_ref);
+
   // -----[ trie_num_nodes ]-----------------------------------------
   /**
    * Return the number of nodes in the trie.
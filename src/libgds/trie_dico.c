@@ -1,673 +1,771 @@
-
 // ==================================================================
 // @(#)trie_dico.c
 //
 // Dictionnaire  compact trie_dico implementation.
 //
+// The dictionary is an adaptive radix tree (ART). Each node holds a
+// compressed path (prefix), an optional value and a set of children
+// indexed by the next key byte. Depending on the number of children,
+// a node is stored as a leaf (no child) or as a node with room for
+// 4, 16, 48 or 256 children. Full keys are never stored: they are
+// rebuilt during traversals.
+//
 // @author Stefan Beauport (stefan.beauport@umons.ac.be)
 // @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
 // @date 19/08/2010
 // $Id$
 // ==================================================================
 
-#include <string.h>
 #ifdef HAVE_CONFIG_H
 # include <config.h>
 #endif
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
 
 #include <libgds/array.h>
 #include <libgds/memory.h>
 #include <libgds/trie_dico.h>
-#include <libgds/stack.h>
+
+// Node types
+#define _NODE_LEAF 0
+#define _NODE_4    1
+#define _NODE_16   2
+#define _NODE_48   3
+#define _NODE_256  4
 
 // -----[ _trie_dico_item_t ]------------------------------------------------
+/**
+ * Common header of all the node types.
+ */
 typedef struct _trie_dico_item_t {
-  struct _trie_dico_item_t * child;
-  struct _trie_dico_item_t * brother;
-  trie_dico_key_t            key_part;
-  trie_dico_key_t            key;
-  uint8_t                    is_final_data;
+  uint8_t                    type;
+  uint8_t                    is_final_data:1,
+    in_block:1,        // node allocated by trie_dico_bulk_load
+    prefix_in_block:1; // prefix allocated by trie_dico_bulk_load
+  uint16_t                   num_children;
+  uint32_t                   prefix_len;
+  char                     * prefix;
   void                     * data;
 } _trie_dico_item_t;
 
+typedef struct {
+  _trie_dico_item_t   item;
+  uint8_t             keys[4];
+  _trie_dico_item_t * children[4];
+} _trie_dico_node4_t;
 
+typedef struct {
+  _trie_dico_item_t   item;
+  uint8_t             keys[16];
+  _trie_dico_item_t * children[16];
+} _trie_dico_node16_t;
 
-//////////////////////////
-//
-/// Printing stuff
-//
-//////////////////////////
-
-
-static inline
-void _trie_dico_print_item(_trie_dico_item_t * item, int depth)
-{
-    int sizeoftab = 15;
-
-    if (item == NULL )
-        return;
-    // oneself
-    for(int i = 0 ; i < depth; i++ )
-    {
-        printf("-");
-    }
-    printf("%s",item->key_part);
-
-    for(int i = 0 ; i < sizeoftab - strlen(item->key); i++ )
-    {
-        printf(" ");
-    }
-    printf("(%s)", item->key);
-
-    for(int i = 0 ; i < sizeoftab - strlen(item->key); i++ )
-    {
-        printf(" ");
-    }
-    if(item->is_final_data) printf("V");
-    else printf("X");
-
-    if(item->child == NULL) printf("    NO CHILD  ");
-    else                    printf("       CHILD  ");
+typedef struct {
+  _trie_dico_item_t   item;
+  uint8_t             index[256]; // child slot + 1 (0 means no child)
+  _trie_dico_item_t * children[48];
+} _trie_dico_node48_t;
 
-    if(item->brother == NULL) printf("  NO BROTHER  ");
-    else                      printf("     BROTHER  ");
+typedef struct {
+  _trie_dico_item_t   item;
+  _trie_dico_item_t * children[256];
+} _trie_dico_node256_t;
 
+static const size_t _NODE_SIZE[]= {
+  sizeof(_trie_dico_item_t),
+  sizeof(_trie_dico_node4_t),
+  sizeof(_trie_dico_node16_t),
+  sizeof(_trie_dico_node48_t),
+  sizeof(_trie_dico_node256_t),
+};
 
-    printf("\n");
+static const unsigned int _NODE_CAPACITY[]= { 0, 4, 16, 48, 256 };
 
-    // my child
-    _trie_dico_print_item(item->child, depth + strlen(item->key_part));
-    // my brother
-    _trie_dico_print_item(item->brother, depth);
+// -----[ _trie_dico_block_t ]---------------------------------------
+/**
+ * Block of contiguous nodes and prefixes allocated by
+ * trie_dico_bulk_load. They are released with the dictionary.
+ */
+typedef struct _trie_dico_block_t {
+  struct _trie_dico_block_t * next;
+} _trie_dico_block_t;
 
+/////////////////////////////////////////////////////////////////////
+//
+// NODES
+//
+/////////////////////////////////////////////////////////////////////
 
+// -----[ _trie_dico_node_alloc ]------------------------------------
+static inline
+_trie_dico_item_t * _trie_dico_node_alloc(uint8_t type)
+{
+  _trie_dico_item_t * item= (_trie_dico_item_t *) MALLOC(_NODE_SIZE[type]);
+  memset(item, 0, _NODE_SIZE[type]);
+  item->type= type;
+  return item;
 }
 
+// -----[ _trie_dico_node_set_prefix ]-------------------------------
 static inline
-void trie_dico_print(gds_trie_dico_t * trie_dico)
+void _trie_dico_node_set_prefix(_trie_dico_item_t * item,
+				const char * prefix, uint32_t prefix_len)
 {
-    printf("\n*****************\n");
-    _trie_dico_print_item(trie_dico->root,0);
-    printf("*****************\n");
-
+  char * new_prefix= NULL;
+  if (prefix_len > 0) {
+    new_prefix= (char *) MALLOC(prefix_len);
+    memcpy(new_prefix, prefix, prefix_len);
+  }
+  if ((item->prefix != NULL) && !item->prefix_in_block)
+    FREE(item->prefix);
+  item->prefix= new_prefix;
+  item->prefix_len= prefix_len;
+  item->prefix_in_block= 0;
 }
+
+// -----[ _trie_dico_node_release ]----------------------------------
+/**
+ * Free the memory of a node but not its prefix. Nodes that belong
+ * to a block are only released with the block.
+ */
 static inline
-void _trie_dico_print_from(_trie_dico_item_t * root)
+void _trie_dico_node_release(_trie_dico_item_t * item)
 {
-    printf("\n*****************\n");
-    _trie_dico_print_item(root,0);
-    printf("*****************\n");
+  if (!item->in_block)
+    FREE(item);
+}
 
+// -----[ _trie_dico_node_free ]-------------------------------------
+static inline
+void _trie_dico_node_free(_trie_dico_item_t * item)
+{
+  if ((item->prefix != NULL) && !item->prefix_in_block)
+    FREE(item->prefix);
+  _trie_dico_node_release(item);
 }
 
-// -----[ _trie_dico_item_create_data ]-----------------------------------
+// -----[ _trie_dico_leaf_create ]-----------------------------------
 /**
- * Create a new node for the Patricia tree. Note: the function will
- * take care of correctly masking the node's key according to its
- * length.
+ * Create a leaf whose compressed path is the remainder of a key.
  */
 static inline
-_trie_dico_item_t * _trie_dico_item_create_data(trie_dico_key_t key,
-                                      trie_dico_key_t key_part,
-				      void * data)
-{
-  _trie_dico_item_t * trie_dico_item=
-    (_trie_dico_item_t *) MALLOC(sizeof(_trie_dico_item_t));
-  trie_dico_item->child= NULL;
-  trie_dico_item->brother= NULL;
-  trie_dico_item->key= key;
-  trie_dico_item->key_part= key_part;
-  trie_dico_item->is_final_data= 1; // 1 : vrai
-  trie_dico_item->data= data;
-  return trie_dico_item;
-}
-
-// -----[ _trie_dico_item_create_empty ]----------------------------------
-static inline
-_trie_dico_item_t * _trie_dico_item_create_empty(trie_dico_key_t key,
-                                      trie_dico_key_t key_part)
+_trie_dico_item_t * _trie_dico_leaf_create(const char * key, void * data)
 {
-  _trie_dico_item_t * trie_dico_item=
-    (_trie_dico_item_t *) MALLOC(sizeof(_trie_dico_item_t));
-  trie_dico_item->child= NULL;
-  trie_dico_item->brother= NULL;
-  trie_dico_item->key= key;
-  trie_dico_item->key_part= key_part;
-  trie_dico_item->is_final_data= 0; // 0 : faux
-  trie_dico_item->data= NULL;
-  return trie_dico_item;
+  _trie_dico_item_t * item= _trie_dico_node_alloc(_NODE_LEAF);
+  _trie_dico_node_set_prefix(item, key, strlen(key));
+  item->is_final_data= 1;
+  item->data= data;
+  return item;
 }
 
-// -----[ trie_dico_create ]----------------------------------------------
+// -----[ _trie_dico_prefix_match ]----------------------------------
 /**
- * Create a new Dico tree.
+ * Return the number of leading bytes of the node's prefix that match
+ * the given key. The key is NUL-terminated and prefixes never
+ * contain NUL bytes, so that the comparison stops at the key's end.
  */
-gds_trie_dico_t * trie_dico_create(gds_trie_dico_destroy_f destroy)
+static inline
+uint32_t _trie_dico_prefix_match(const _trie_dico_item_t * item,
+				 const char * key)
 {
-  gds_trie_dico_t * trie_dico=
-    (gds_trie_dico_t *) MALLOC(sizeof(gds_trie_dico_t));
-  trie_dico->root= NULL;
-  trie_dico->destroy= destroy;
-  return trie_dico;
+  uint32_t index= 0;
+  while ((index < item->prefix_len) && (item->prefix[index] == key[index]))
+    index++;
+  return index;
 }
 
-// -----[ _find_father ]---------------------------------------------
+// -----[ _node16_find ]---------------------------------------------
 /**
- * we want to insert a key/value pair
- *  this function allows to find the father of our new node.
- *
- * Result: the father of the new node, or NULL if it should be at
- * the first visited floor (root)
+ * Return the slot of the child associated with byte 'c' in a
+ * Node16, or -1 if there is no such child.
  */
-static _trie_dico_item_t * _find_father(_trie_dico_item_t * root,
-					trie_dico_key_t key)
+static inline int _node16_find(const _trie_dico_node16_t * node,
+			       uint8_t c)
 {
-  _trie_dico_item_t * current_father= NULL;
-  _trie_dico_item_t * uncle= root;
-    
-  trie_dico_key_t current_key_part= MALLOC(sizeof(char)*(strlen(key)+1));
-  trie_dico_key_t key_part_tmp= MALLOC(sizeof(char)*(strlen(key)+1));
-
-  strcpy(current_key_part, key);
-    
-  while(uncle != NULL) {
-
-    // pour cette profondeur :
-    // Warning-bqu: requires ISO C99 compiler !
-    int found_ancestor= 0;
-
-    while (!found_ancestor && (uncle != NULL) &&
-	   (strlen(current_key_part) > 0)) {
-
-      if (current_key_part[0] < (uncle->key_part)[0]) {
-
-	// stop, ca ne sert à rien d'aller plus loin dans cet étage
-	// il n'y a pas d'ancetre commun ici ==> prendre celui du
-	// niveau au dessu, cad current_father
-	uncle = NULL;
-
-      } else if (strlen(current_key_part) <= strlen(uncle->key_part)) {
-
-	// l'oncle est trop long pour etre mon father
-	uncle= uncle->brother;
-
-      } else {
-
-	// c'est un father potentiel.
-	// alors c'est p'tete possible avec cet oncle-ci
-	// coupons nous a la taille de l'oncle
-
-	strncpy(key_part_tmp, current_key_part, strlen(uncle->key_part));
-	key_part_tmp[strlen(uncle->key_part)]='\0';
-
-	// on a coupé la key a la taille du uncle,
-	// on va vérifier si ils sont identiques.
-	// s'ils sont identiques, on a un ancetre, si pas, continuer
-	if (strcmp(key_part_tmp , uncle->key_part) == 0) {
+#ifdef __SSE2__
+  __m128i cmp= _mm_cmpeq_epi8(_mm_set1_epi8((char) c),
+			      _mm_loadu_si128((const __m128i *) node->keys));
+  int mask= _mm_movemask_epi8(cmp) & ((1 << node->item.num_children) - 1);
+  if (mask != 0)
+    return __builtin_ctz(mask);
+  return -1;
+#else
+  int index;
+  for (index= 0; index < node->item.num_children; index++)
+    if (node->keys[index] == c)
+      return index;
+  return -1;
+#endif
+}
 
-	  // il s'agit donc d'un ancetre !!
-	  // ils ne sont pas de la meme taille sinon on ne serait pas dans ce if ci!
-	  found_ancestor= 1;
-	  current_father= uncle;
+// -----[ _node16_lower_bound ]--------------------------------------
+/**
+ * Return the slot where byte 'c' must be inserted in a Node16 so
+ * that keys remain sorted.
+ */
+static inline int _node16_lower_bound(const _trie_dico_node16_t * node,
+				      uint8_t c)
+{
+#ifdef __SSE2__
+  // Bytes are compared as signed values: flip their MSB first.
+  const __m128i bias= _mm_set1_epi8((char) 0x80);
+  __m128i cmp=
+    _mm_cmplt_epi8(_mm_xor_si128(_mm_set1_epi8((char) c), bias),
+		   _mm_xor_si128(_mm_loadu_si128((const __m128i *) node->keys),
+				 bias));
+  int mask= _mm_movemask_epi8(cmp) & ((1 << node->item.num_children) - 1);
+  if (mask != 0)
+    return __builtin_ctz(mask);
+  return node->item.num_children;
+#else
+  int index;
+  for (index= 0; index < node->item.num_children; index++)
+    if (c < node->keys[index])
+      break;
+  return index;
+#endif
+}
 
-	} else {
-	  uncle= uncle->brother;
-	}
-      }
+// -----[ _trie_dico_find_child ]------------------------------------
+/**
+ * Return a pointer to the child slot associated with byte 'c', or
+ * NULL if there is no such child.
+ */
+static inline
+_trie_dico_item_t ** _trie_dico_find_child(_trie_dico_item_t * item,
+					   uint8_t c)
+{
+  unsigned int index;
+  int slot;
+
+  switch (item->type) {
+  case _NODE_4:
+    for (index= 0; index < item->num_children; index++)
+      if (((_trie_dico_node4_t *) item)->keys[index] == c)
+	return &((_trie_dico_node4_t *) item)->children[index];
+    break;
+  case _NODE_16:
+    slot= _node16_find((_trie_dico_node16_t *) item, c);
+    if (slot >= 0)
+      return &((_trie_dico_node16_t *) item)->children[slot];
+    break;
+  case _NODE_48:
+    index= ((_trie_dico_node48_t *) item)->index[c];
+    if (index > 0)
+      return &((_trie_dico_node48_t *) item)->children[index-1];
+    break;
+  case _NODE_256:
+    if (((_trie_dico_node256_t *) item)->children[c] != NULL)
+      return &((_trie_dico_node256_t *) item)->children[c];
+    break;
+  }
+  return NULL;
+}
 
+// -----[ _trie_dico_next_child ]------------------------------------
+/**
+ * Iterate over the children of a node in key order. The iterator
+ * 'iter' must be initialized to 0. The function returns the next
+ * child (and its key byte in 'c') or NULL if there is no more
+ * child.
+ */
+static inline
+_trie_dico_item_t * _trie_dico_next_child(_trie_dico_item_t * item,
+					  unsigned int * iter,
+					  uint8_t * c)
+{
+  _trie_dico_node48_t * node48;
+  _trie_dico_node256_t * node256;
+
+  switch (item->type) {
+  case _NODE_4:
+    if (*iter < item->num_children) {
+      *c= ((_trie_dico_node4_t *) item)->keys[*iter];
+      return ((_trie_dico_node4_t *) item)->children[(*iter)++];
     }
+    break;
+  case _NODE_16:
+    if (*iter < item->num_children) {
+      *c= ((_trie_dico_node16_t *) item)->keys[*iter];
+      return ((_trie_dico_node16_t *) item)->children[(*iter)++];
+    }
+    break;
+  case _NODE_48:
+    node48= (_trie_dico_node48_t *) item;
+    while (*iter < 256) {
+      *c= (uint8_t) *iter;
+      if (node48->index[(*iter)++] > 0)
+	return node48->children[node48->index[*c]-1];
+    }
+    break;
+  case _NODE_256:
+    node256= (_trie_dico_node256_t *) item;
+    while (*iter < 256) {
+      *c= (uint8_t) *iter;
+      if (node256->children[(*iter)++] != NULL)
+	return node256->children[*c];
+    }
+    break;
+  }
+  return NULL;
+}
 
-    // search for this depth ended
-    if(!found_ancestor) {
-
-      // on a fait le tour de cet étage, et il n'y a pas
-      //d'ancêtre commun, on arrête la!
-      return current_father;
-
-    } else if(current_father->child == NULL) {
-      // on vient de trouver un ancetre (se trouve dans current_father)
-      // si l'ancêtre  qu'on a trouvé n'a pas de fils, alors c'est
-      // le meilleur ancetre comme père
-      
-      return current_father;
-
-    } else {
-      
-      // on va continuer à descendre dans l'arbre, avec comme oncle potentiel
-      //le premier fils de l'ancetre qu'on vient de trouver
-      // couper les key_part
-      uncle= current_father->child;
-
-      //strcpy(current_key_part, key);
-      // garder la fin de la key (enlever la partie commune avec le père)
-      int new_size= strlen(current_key_part)-strlen(current_father->key_part);
-      for (int i= 0 ; i < new_size ; i++) {
-	current_key_part[i]=
-	  current_key_part[i+strlen(current_father->key_part)];
+// -----[ _trie_dico_node_convert ]----------------------------------
+/**
+ * Move a node into a node of another type. The children are moved
+ * and the old node is freed.
+ */
+static _trie_dico_item_t * _trie_dico_node_convert(_trie_dico_item_t * item,
+						   uint8_t type)
+{
+  _trie_dico_item_t * new_item= _trie_dico_node_alloc(type);
+  _trie_dico_item_t * child;
+  unsigned int iter= 0;
+  unsigned int index= 0;
+  uint8_t c;
+
+  new_item->is_final_data= item->is_final_data;
+  new_item->prefix_len= item->prefix_len;
+  new_item->prefix= item->prefix;
+  new_item->prefix_in_block= item->prefix_in_block;
+  new_item->data= item->data;
+  new_item->num_children= item->num_children;
+
+  if (item->type != _NODE_LEAF) {
+    while ((child= _trie_dico_next_child(item, &iter, &c)) != NULL) {
+      switch (type) {
+      case _NODE_4:
+	((_trie_dico_node4_t *) new_item)->keys[index]= c;
+	((_trie_dico_node4_t *) new_item)->children[index]= child;
+	break;
+      case _NODE_16:
+	((_trie_dico_node16_t *) new_item)->keys[index]= c;
+	((_trie_dico_node16_t *) new_item)->children[index]= child;
+	break;
+      case _NODE_48:
+	((_trie_dico_node48_t *) new_item)->index[c]= index+1;
+	((_trie_dico_node48_t *) new_item)->children[index]= child;
+	break;
+      case _NODE_256:
+	((_trie_dico_node256_t *) new_item)->children[c]= child;
+	break;
+      default:
+	abort();
       }
-      current_key_part[new_size] = '\0';
+      index++;
     }
   }
 
-  return current_father;
+  _trie_dico_node_release(item);
+  return new_item;
 }
 
-
-// -----[ _find_left_brother ]---------------------------------------------
+// -----[ _trie_dico_add_child ]-------------------------------------
 /**
- * we want to insert a key/value pair
- *  this function allows to find the left-brother of our node.
- *  if the answer is NULL, it means that our node does not have a left brother in this tree
- *   it means that it should be the first brother, or that we have to split the first brother.
- *  if the answer is a node, than it is the left brother, meaning that we have to deal with the right brother of this node
- *  that is to insert a new node before the right node, or to split the right brother.
- *
- *
+ * Add a child to the node referenced by 'item_ref'. The node is
+ * grown into a larger node type if it is full.
  *
- *
- * Result: the left brother of the new node (meaning that we have to insert before, or to split the right brother. or NULL if it should be the first brother.
- */
-static _trie_dico_item_t * _find_left_brother(_trie_dico_item_t * father,
-					      _trie_dico_item_t * root,
-					      trie_dico_key_t key)
-{ 
-    _trie_dico_item_t * current_left_brother = NULL;
-    _trie_dico_item_t * temp_left_brother = NULL;
-    trie_dico_key_t key_part;
-
-    // c'est que c'est au tout premier étage (root)
-    if (father == NULL) {
-        temp_left_brother = root;
-        key_part = (trie_dico_key_t) MALLOC( (strlen(key)+1) * sizeof(char) );
-        strcpy(key_part,key);
-    }
-    else
-    {
-        temp_left_brother = father->child;
-        int key_part_len = strlen(key) - strlen(father->key);
-        key_part = (trie_dico_key_t) MALLOC( (key_part_len  +1) * sizeof(char) );
-        for (int i = 0 ; i < key_part_len ; i++)
-        {
-                key_part[i] = key[i + strlen(father->key)];
-        }
-        key_part[key_part_len] = '\0';
-    }
+ * Pre: the node has no child for byte 'c'.
+ */
+static void _trie_dico_add_child(_trie_dico_item_t ** item_ref,
+				 uint8_t c, _trie_dico_item_t * child)
+{
+  _trie_dico_item_t * item= *item_ref;
+  _trie_dico_node4_t * node4;
+  _trie_dico_node16_t * node16;
+  _trie_dico_node48_t * node48;
+  unsigned int index;
+
+  if (item->num_children >= _NODE_CAPACITY[item->type]) {
+    item= _trie_dico_node_convert(item, item->type+1);
+    *item_ref= item;
+  }
 
-    while (temp_left_brother != NULL )
-    {
-        if(temp_left_brother->key_part[0] < key_part[0])
-        {
-            current_left_brother = temp_left_brother;
-            temp_left_brother = temp_left_brother->brother;
-        }
-        else
-            temp_left_brother = NULL;
-    }
+  switch (item->type) {
+  case _NODE_4:
+    node4= (_trie_dico_node4_t *) item;
+    for (index= 0; index < item->num_children; index++)
+      if (c < node4->keys[index])
+	break;
+    memmove(&node4->keys[index+1], &node4->keys[index],
+	    item->num_children-index);
+    memmove(&node4->children[index+1], &node4->children[index],
+	    (item->num_children-index)*sizeof(_trie_dico_item_t *));
+    node4->keys[index]= c;
+    node4->children[index]= child;
+    break;
+  case _NODE_16:
+    node16= (_trie_dico_node16_t *) item;
+    index= _node16_lower_bound(node16, c);
+    memmove(&node16->keys[index+1], &node16->keys[index],
+	    item->num_children-index);
+    memmove(&node16->children[index+1], &node16->children[index],
+	    (item->num_children-index)*sizeof(_trie_dico_item_t *));
+    node16->keys[index]= c;
+    node16->children[index]= child;
+    break;
+  case _NODE_48:
+    node48= (_trie_dico_node48_t *) item;
+    for (index= 0; node48->children[index] != NULL; index++);
+    node48->children[index]= child;
+    node48->index[c]= index+1;
+    break;
+  case _NODE_256:
+    ((_trie_dico_node256_t *) item)->children[c]= child;
+    break;
+  default:
+    abort();
+  }
+  item->num_children++;
+}
 
-    return current_left_brother;
+// -----[ _trie_dico_remove_child ]----------------------------------
+/**
+ * Remove the child associated with byte 'c' from the node
+ * referenced by 'item_ref'. The node is shrunk into a smaller node
+ * type if it becomes sparse.
+ */
+static void _trie_dico_remove_child(_trie_dico_item_t ** item_ref,
+				    uint8_t c)
+{
+  _trie_dico_item_t * item= *item_ref;
+  _trie_dico_node4_t * node4;
+  _trie_dico_node16_t * node16;
+  _trie_dico_node48_t * node48;
+  unsigned int index;
+  uint8_t new_type= item->type;
+
+  switch (item->type) {
+  case _NODE_4:
+    node4= (_trie_dico_node4_t *) item;
+    for (index= 0; node4->keys[index] != c; index++);
+    memmove(&node4->keys[index], &node4->keys[index+1],
+	    item->num_children-index-1);
+    memmove(&node4->children[index], &node4->children[index+1],
+	    (item->num_children-index-1)*sizeof(_trie_dico_item_t *));
+    if (item->num_children == 1)
+      new_type= _NODE_LEAF;
+    break;
+  case _NODE_16:
+    node16= (_trie_dico_node16_t *) item;
+    index= _node16_find(node16, c);
+    memmove(&node16->keys[index], &node16->keys[index+1],
+	    item->num_children-index-1);
+    memmove(&node16->children[index], &node16->children[index+1],
+	    (item->num_children-index-1)*sizeof(_trie_dico_item_t *));
+    if (item->num_children == 4)
+      new_type= _NODE_4;
+    break;
+  case _NODE_48:
+    node48= (_trie_dico_node48_t *) item;
+    node48->children[node48->index[c]-1]= NULL;
+    node48->index[c]= 0;
+    if (item->num_children == 13)
+      new_type= _NODE_16;
+    break;
+  case _NODE_256:
+    ((_trie_dico_node256_t *) item)->children[c]= NULL;
+    if (item->num_children == 37)
+      new_type= _NODE_48;
+    break;
+  default:
+    abort();
+  }
+  item->num_children--;
 
+  if (new_type != item->type)
+    *item_ref= _trie_dico_node_convert(item, new_type);
 }
 
+// -----[ _trie_dico_compact ]---------------------------------------
+/**
+ * Restore the tree invariants after a value or a child was removed
+ * from the node referenced by 'item_ref': a node without value is
+ * removed if it has no child and merged with its child if it has a
+ * single one.
+ */
+static void _trie_dico_compact(_trie_dico_item_t ** item_ref)
+{
+  _trie_dico_item_t * item= *item_ref;
+  _trie_dico_item_t * child;
+  unsigned int iter= 0;
+  char * prefix;
+  uint8_t c;
+
+  if (item->is_final_data)
+    return;
+
+  if (item->num_children == 0) {
+    _trie_dico_node_free(item);
+    *item_ref= NULL;
+  } else if (item->num_children == 1) {
+    child= _trie_dico_next_child(item, &iter, &c);
+    prefix= (char *) MALLOC(item->prefix_len+1+child->prefix_len);
+    if (item->prefix_len > 0)
+      memcpy(prefix, item->prefix, item->prefix_len);
+    prefix[item->prefix_len]= (char) c;
+    if (child->prefix_len > 0)
+      memcpy(prefix+item->prefix_len+1, child->prefix, child->prefix_len);
+    if ((child->prefix != NULL) && !child->prefix_in_block)
+      FREE(child->prefix);
+    child->prefix= prefix;
+    child->prefix_in_block= 0;
+    child->prefix_len+= item->prefix_len+1;
+    _trie_dico_node_free(item);
+    *item_ref= child;
+  }
+}
 
+/////////////////////////////////////////////////////////////////////
+//
+// KEY BUFFER
+//
+/////////////////////////////////////////////////////////////////////
 
-// -----[ _trie_dico_insert ]---------------------------------------------
+// -----[ _trie_dico_key_buf_t ]-------------------------------------
 /**
- * Insert a new (key, value) pair into the Patricia tree. This
- * function is only an helper function. The 'trie_dico_insert' function
- * should be used instead.
- *
- * Pre: (key length <= TRIE_DICO_KEY_SIZE)
- *
- * Result: 0 on success and -1 on error (duplicate key)
- */
-static int _trie_dico_insert(_trie_dico_item_t ** item,
-			     trie_dico_key_t key,
-			     void * data,
-			     gds_trie_dico_destroy_f destroy,
-			     int replace)
-{
-
-  trie_dico_key_t father_s_key;
-
-  _trie_dico_item_t * new_item;
-  _trie_dico_item_t * father= _find_father(*item, key);
-  _trie_dico_item_t * left_brother= _find_left_brother(father, *item, key);
-  _trie_dico_item_t ** ptrTonodetoanalyse= NULL;
-
-  if (left_brother == NULL)
-  {
-    if(father == NULL)  // c'est celui pointé par root qu'il faut analyser
-        ptrTonodetoanalyse = item;
-    else  // c'est le noeud pointé par le fils de father qu'il faut analyser.
-        ptrTonodetoanalyse = &(father->child);    
-  }
-  else // comme on a un left_brother, c'est le noeud pointé par son frère droit qu'il faut analyser
-      ptrTonodetoanalyse = &(left_brother->brother);
- 
-  if(father != NULL)
-       father_s_key = father->key;
-  else  father_s_key = "";
-  
-
-  int end_of_key_len = strlen(key) - strlen(father_s_key) ;
-  trie_dico_key_t end_of_key = (trie_dico_key_t) MALLOC( (end_of_key_len +1 ) * sizeof(char));
-  for (int i= 0; i < end_of_key_len; i++) {
-     end_of_key[i] = key[ i + strlen(father_s_key)];
-  }
-  end_of_key[end_of_key_len]= '\0';
-
-  // si ce qu'il faut pointer est null, alors on crée et on insère.
-  // sinon,
-  // s'il n'a rien en commun (pas de caractère en commun), alors on crée et on insère (on intercale)
-  // sinon s'il y a x caractères en commun
-  //            - et que end_of_key à insérer est épuisé
-  //            - et que end_of_key n'est pas épuisé
-  //       sinon si tout en commun : impossible, sinon aurait été détecté comme 'father' et pas comme brother.
-  //
-
-  if((*ptrTonodetoanalyse)==NULL)
-  {   // créer et insérer là!
-
-       new_item = _trie_dico_item_create_data( key,
-                                       end_of_key,
-                                       data);
-       *ptrTonodetoanalyse = new_item;
-  }
-  else
-  {
-    // si rien en commun (donc première lettre différente) on doit intercaler
-      if(end_of_key[0] != ((*ptrTonodetoanalyse)->key_part)[0])
-      {
-          new_item = _trie_dico_item_create_data( key,
-                                       end_of_key,
-				       data);
-          new_item->brother = (*ptrTonodetoanalyse);
-          *ptrTonodetoanalyse = new_item;
+ * Growable buffer used to rebuild keys during traversals.
+ */
+typedef struct {
+  char   * data;
+  size_t   len;
+  size_t   size;
+} _trie_dico_key_buf_t;
 
-      }
-      else // au moins le premier caractère est identique, continuer pour compter combien.
-      {
-          int i = 1;
-          while(  i < strlen(end_of_key) &&
-                  i < strlen((*ptrTonodetoanalyse)->key_part) &&
-                  end_of_key[i] == ((*ptrTonodetoanalyse)->key_part)[i])
-              i++;
-         // i caractères communs, on doit spliter
-
-          if( i == strlen(end_of_key) ) // end_of_key est épuisé, et l'autre est plus grand (ou égal)
-          {
-             //i caractères communs, cas 1 - on est entièrement contenu dans l'autre
-	    if( i == strlen((*ptrTonodetoanalyse)->key_part)) {
-
-	      // a node with this key already exists. Action depends
-	      // on whether the node contains data or not.
-
-	      if((*ptrTonodetoanalyse)->is_final_data == 0) {
-		(*ptrTonodetoanalyse)->is_final_data = 1;
-		(*ptrTonodetoanalyse)->data = data;
-	      } else {
-		if (replace != TRIE_DICO_INSERT_OR_REPLACE)
-		  return TRIE_DICO_ERROR_DUPLICATE;
-		if (destroy != NULL)
-		  destroy(&(*ptrTonodetoanalyse)->data);
-		(*ptrTonodetoanalyse)->data= data;
-	      }
-
-	    } else {
-
-	      // A node with a longer key was reached. It is needed
-	      // to split it.
-
-                  // concernant le nouvel élément :
-                  new_item = _trie_dico_item_create_data( key,
-                                       end_of_key,
-				       data);
-                  new_item->brother = (*ptrTonodetoanalyse)->brother;
-                  //concernant l'ancien élément qu'on va modifier:
-                  //taille de la chaine :
-
-                  int taille = strlen((*ptrTonodetoanalyse)->key_part) - i ;
-                  trie_dico_key_t modified_key_part = (trie_dico_key_t) MALLOC( (1+taille) * sizeof(char));
-                  for(;i < strlen((*ptrTonodetoanalyse)->key_part);i++)
-                  {
-                      modified_key_part[i-(strlen((*ptrTonodetoanalyse)->key_part) - taille)] = ((*ptrTonodetoanalyse)->key_part)[i];
-                  }
-                  modified_key_part[taille] = '\0';
-                  (*ptrTonodetoanalyse)->key_part = modified_key_part;
-                  (*ptrTonodetoanalyse)->brother = NULL;
-                  new_item->child = *ptrTonodetoanalyse;
-                  *ptrTonodetoanalyse = new_item;
-
-              }
-          }
-          else
-          {   //i caractères communs, cas 2 - on a des parties différentes
-
-              // end_of_key n'est pas épuisé, et l'autre non plus (forcément !) spliter !
-
-              // créer le noeud commun (résultat du splitage)
-              // créer notre nouveau noeud
-              // raccourcir l'ancien noeud qui a une partie commune avec Nous.
-              // placer les pointeurs correctement, selon que l'ancien est plus petit ou plus grand que le nouveau.
-
-              _trie_dico_item_t * new_item_commun = (_trie_dico_item_t *) MALLOC(sizeof(_trie_dico_item_t));
-              int taille_part_commun = i;
-              int taille_commun = strlen(father_s_key) + i;
-              trie_dico_key_t commun_key_part = (trie_dico_key_t ) MALLOC( (1+ taille_part_commun ) * sizeof(char));
-              trie_dico_key_t commun_key = (trie_dico_key_t ) MALLOC( (1+ taille_commun ) * sizeof(char));
-              strncpy(commun_key_part, (*ptrTonodetoanalyse)->key_part ,taille_part_commun);
-              commun_key_part[taille_part_commun]='\0';
-
-              strcpy(commun_key, father_s_key);
-              strcat(commun_key,commun_key_part);
-
-              new_item_commun = _trie_dico_item_create_empty( commun_key,
-                                       commun_key_part);
-              new_item_commun->brother = (*ptrTonodetoanalyse)->brother;
-
-              trie_dico_key_t  new_item_key_part = (trie_dico_key_t ) MALLOC( (1+ strlen(end_of_key) - i ) * sizeof(char));
-              int j =0;
-              while(i < strlen(end_of_key))
-              {
-                   new_item_key_part[j] = end_of_key[i];
-                  i++;
-                   j++;
-              }
-              new_item_key_part[j] = '\0';
-
-              new_item = _trie_dico_item_create_data( key,
-                                       new_item_key_part,
-				       data);
-
-              int nouvelle_taille_part_ancien_noeud = strlen((*ptrTonodetoanalyse)->key_part) - taille_part_commun;
-              trie_dico_key_t  old_item_key_part = (trie_dico_key_t ) MALLOC( (1+nouvelle_taille_part_ancien_noeud) * sizeof(char));
-              for(i=0 ; i < nouvelle_taille_part_ancien_noeud; i++)
-              {
-                  old_item_key_part[i] = ((*ptrTonodetoanalyse)->key_part)[taille_part_commun + i];
-              }
-              old_item_key_part[nouvelle_taille_part_ancien_noeud] = '\0';
-
-              (*ptrTonodetoanalyse)->key_part = old_item_key_part;
-              
-               if( ( (*ptrTonodetoanalyse)->key_part)[0] < new_item->key_part[0])
-               {
-                 // placer l'ancien noeud avant le nouveau
-                   new_item_commun->child = (*ptrTonodetoanalyse);
-                   (*ptrTonodetoanalyse)->brother = new_item;
-               }
-               else
-               {
-		 // placer l'ancien noeud après le nouveau
-                   new_item_commun->child = new_item;
-                   new_item->brother = (*ptrTonodetoanalyse);
-                   (*ptrTonodetoanalyse)->brother = NULL;
-               }
-              (*ptrTonodetoanalyse) = new_item_commun;
-          }
+// -----[ _key_buf_init ]--------------------------------------------
+static inline void _key_buf_init(_trie_dico_key_buf_t * buf)
+{
+  buf->size= 64;
+  buf->len= 0;
+  buf->data= (char *) MALLOC(buf->size);
+  buf->data[0]= '\0';
+}
 
+// -----[ _key_buf_done ]--------------------------------------------
+static inline void _key_buf_done(_trie_dico_key_buf_t * buf)
+{
+  FREE(buf->data);
+}
 
-      }
+// -----[ _key_buf_append ]------------------------------------------
+static inline void _key_buf_append(_trie_dico_key_buf_t * buf,
+				   const char * bytes, size_t len)
+{
+  if (buf->len+len+1 > buf->size) {
+    while (buf->len+len+1 > buf->size)
+      buf->size*= 2;
+    buf->data= (char *) REALLOC(buf->data, buf->size);
   }
- //printf("\nAPRES : ");
- //_trie_dico_print_from(*item);
+  if (len > 0)
+    memcpy(buf->data+buf->len, bytes, len);
+  buf->len+= len;
+  buf->data[buf->len]= '\0';
+}
+
+// -----[ _key_buf_truncate ]----------------------------------------
+static inline void _key_buf_truncate(_trie_dico_key_buf_t * buf,
+				     size_t len)
+{
+  buf->len= len;
+  buf->data[len]= '\0';
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// DICTIONARY
+//
+/////////////////////////////////////////////////////////////////////
 
- return TRIE_DICO_SUCCESS;
+// -----[ trie_dico_create ]----------------------------------------------
+/**
+ * Create a new Dico tree.
+ */
+gds_trie_dico_t * trie_dico_create(gds_trie_dico_destroy_f destroy)
+{
+  gds_trie_dico_t * trie_dico=
+    (gds_trie_dico_t *) MALLOC(sizeof(gds_trie_dico_t));
+  trie_dico->root= NULL;
+  trie_dico->destroy= destroy;
+  trie_dico->blocks= NULL;
+  return trie_dico;
 }
 
 // -----[ trie_dico_insert ]----------------------------------------------
 /**
  * Insert one (key, value) pair into the dico tree.
  *
- * PRECONDITION:
- *  ???
+ * Result: TRIE_DICO_SUCCESS on success and TRIE_DICO_ERROR_DUPLICATE
+ * if the key exists and replacement was not requested.
  */
 int trie_dico_insert(gds_trie_dico_t * trie_dico, trie_dico_key_t key,
 		     void * data, int replace)
-{ 
-  if (trie_dico->root == NULL) {
-    trie_dico->root= _trie_dico_item_create_data(key, key, data);
-    return TRIE_DICO_SUCCESS;
-  }
+{
+  _trie_dico_item_t ** item_ref= &trie_dico->root;
+  _trie_dico_item_t ** child_ref;
+  _trie_dico_item_t * item;
+  _trie_dico_item_t * split;
+  uint32_t match;
 
-  return _trie_dico_insert(&trie_dico->root, key,
-			   data, trie_dico->destroy, replace);
-}
+  while (1) {
+    item= *item_ref;
 
-// -----[ trie_dico_find_exact ]------------------------------------------
-void * trie_dico_find_exact(gds_trie_dico_t * trie_dico,
-			    trie_dico_key_t key)
-{ 
-  _trie_dico_item_t * father = _find_father( trie_dico->root , key ) ; 
-  _trie_dico_item_t * left_brother = _find_left_brother(father, trie_dico->root, key );
-  _trie_dico_item_t * theNode = NULL;
-  
-  if(left_brother == NULL) {
-    if(father == NULL)// c'est celui pointé par root qu'il faut analyser
-      theNode = trie_dico->root;
-    else  // c'est le noeud pointé par le fils de father qu'il faut analyser.
-      theNode = father->child;
-  } else {
-    // comme on a un left_brother, c'est le noeud pointé par son
-    // frère droit qu'il faut analyser
-      theNode = left_brother->brother;
-  }
-  
-  if (theNode != NULL) {
-    // alors s'il est présent, c'est là que devrait se trouver le noeud.
-    if(strcmp(theNode->key,key) == 0) {
-      return theNode->data;
+    if (item == NULL) {
+      *item_ref= _trie_dico_leaf_create(key, data);
+      return TRIE_DICO_SUCCESS;
     }
-  } else
-    return NULL;
-  
-  return NULL;
-}
-
-static _trie_dico_item_t * _trie_dico_find_best(_trie_dico_item_t * item,
-						const trie_dico_key_t key,
-						int with_data)
-{
-  _trie_dico_item_t * best;
-  size_t item_key_len;
 
-  if (item == NULL)
-    return NULL;
+    match= _trie_dico_prefix_match(item, key);
+    if (match < item->prefix_len) {
+      // The key diverges inside the node's prefix (or ends inside
+      // it). Split the prefix.
+      split= _trie_dico_node_alloc(_NODE_4);
+      _trie_dico_node_set_prefix(split, item->prefix, match);
+      _trie_dico_add_child(&split, (uint8_t) item->prefix[match], item);
+      item->prefix_len-= match+1;
+      memmove(item->prefix, item->prefix+match+1, item->prefix_len);
+      if (key[match] == '\0') {
+	split->is_final_data= 1;
+	split->data= data;
+      } else {
+	_trie_dico_add_child(&split, (uint8_t) key[match],
+			     _trie_dico_leaf_create(key+match+1, data));
+      }
+      *item_ref= split;
+      return TRIE_DICO_SUCCESS;
+    }
+    key+= match;
+
+    if (*key == '\0') {
+      if (item->is_final_data) {
+	if (replace != TRIE_DICO_INSERT_OR_REPLACE)
+	  return TRIE_DICO_ERROR_DUPLICATE;
+	if (trie_dico->destroy != NULL)
+	  trie_dico->destroy(&item->data);
+      }
+      item->is_final_data= 1;
+      item->data= data;
+      return TRIE_DICO_SUCCESS;
+    }
 
-  item_key_len= strlen(item->key_part);
+    child_ref= _trie_dico_find_child(item, (uint8_t) *key);
+    if (child_ref == NULL) {
+      _trie_dico_add_child(item_ref, (uint8_t) *key,
+			   _trie_dico_leaf_create(key+1, data));
+      return TRIE_DICO_SUCCESS;
+    }
+    item_ref= child_ref;
+    key++;
+  }
+}
 
-  if ((item->child != NULL) &&
-      !strncmp(key, item->key_part, item_key_len)) {
-    best= _trie_dico_find_best(item->child, key+item_key_len, with_data);
-    if (best != NULL)
-      return best;
-    if (!with_data || item->is_final_data)
-      return item;
-    return NULL;
+// -----[ _trie_dico_find_exact ]------------------------------------
+static _trie_dico_item_t * _trie_dico_find_exact(_trie_dico_item_t * item,
+						 const char * key)
+{
+  _trie_dico_item_t ** child_ref;
+
+  while (item != NULL) {
+    if (_trie_dico_prefix_match(item, key) < item->prefix_len)
+      return NULL;
+    key+= item->prefix_len;
+    if (*key == '\0')
+      return item->is_final_data?item:NULL;
+    child_ref= _trie_dico_find_child(item, (uint8_t) *key);
+    if (child_ref == NULL)
+      return NULL;
+    item= *child_ref;
+    key++;
   }
+  return NULL;
+}
 
-  return _trie_dico_find_best(item->brother, key, with_data);
+// -----[ trie_dico_find_exact ]------------------------------------------
+void * trie_dico_find_exact(gds_trie_dico_t * trie_dico,
+			    trie_dico_key_t key)
+{
+  _trie_dico_item_t * item= _trie_dico_find_exact(trie_dico->root, key);
+  if (item != NULL)
+    return item->data;
+  return NULL;
 }
 
 // -----[ trie_dico_find_best ]-------------------------------------------
+/**
+ * Return the data associated with the longest key that is a prefix
+ * of the searched key.
+ */
 void * trie_dico_find_best(gds_trie_dico_t * trie_dico,
 			   const trie_dico_key_t key)
 {
-  if (trie_dico->root == NULL)
-    return NULL;
-  return _trie_dico_find_best(trie_dico->root, key, 1);
+  _trie_dico_item_t * item= trie_dico->root;
+  _trie_dico_item_t ** child_ref;
+  const char * key_ptr= key;
+  void * best= NULL;
+
+  while (item != NULL) {
+    if (_trie_dico_prefix_match(item, key_ptr) < item->prefix_len)
+      break;
+    key_ptr+= item->prefix_len;
+    if (item->is_final_data)
+      best= item->data;
+    if (*key_ptr == '\0')
+      break;
+    child_ref= _trie_dico_find_child(item, (uint8_t) *key_ptr);
+    if (child_ref == NULL)
+      break;
+    item= *child_ref;
+    key_ptr++;
+  }
+  return best;
 }
 
 // -----[ _trie_dico_remove ]---------------------------------------------
-static int _trie_dico_remove(_trie_dico_item_t ** item,
-			     const trie_dico_key_t key,
+static int _trie_dico_remove(_trie_dico_item_t ** item_ref,
+			     const char * key,
 			     gds_trie_dico_destroy_f destroy)
 {
-  size_t key_len;
-  size_t item_key_len;
+  _trie_dico_item_t * item= *item_ref;
+  _trie_dico_item_t ** child_ref;
+  int result;
 
-  if (*item == NULL)
+  if (item == NULL)
     return TRIE_DICO_ERROR_NO_MATCH;
-
-  key_len= strlen(key);
-  item_key_len= strlen((*item)->key_part);
-
-  if (key_len < item_key_len)
+  if (_trie_dico_prefix_match(item, key) < item->prefix_len)
     return TRIE_DICO_ERROR_NO_MATCH;
+  key+= item->prefix_len;
 
-  if (key_len == item_key_len) {
-    if (strcmp(key, (*item)->key_part))
-      return _trie_dico_remove(&(*item)->brother, key, destroy);
-
-    if (!(*item)->is_final_data)
+  if (*key == '\0') {
+    if (!item->is_final_data)
       return TRIE_DICO_ERROR_NO_MATCH;
-
     if (destroy != NULL)
-      destroy((*item)->data);
-    (*item)->data= NULL;
-    
-    // ... depends on whether there is a single child or multiple children ...
-    if ((*item)->child != NULL) {
-      if ((*item)->child->brother != NULL) {
-	// It is a split-node, node cannot be removed. Do nothing.
-      } else {
-	// It has a single child. Replace with child and free.
-	_trie_dico_item_t * temp= *item;
-
-	*item= (*item)->child;
-	(*item)->brother= temp->brother;
-
-	// update node's key_part (prefix with removed node's key_part)
-	size_t l= strlen(temp->key_part);
-	char * new_key_part= MALLOC(sizeof(char)*(strlen((*item)->key_part)+l+1));
-	strcpy(new_key_part, temp->key_part);
-	strcat(new_key_part+l, (*item)->key_part);
-	FREE((*item)->key_part);
-	(*item)->key_part= new_key_part;
-
-	FREE(temp);
-      }
-    } else {
-      // It is a leaf. Replace with brother and free.
-      _trie_dico_item_t * temp= *item;
-      *item= (*item)->brother;
-      FREE(temp);
-    }
+      destroy(&item->data);
+    item->is_final_data= 0;
+    item->data= NULL;
+    _trie_dico_compact(item_ref);
     return TRIE_DICO_SUCCESS;
   }
 
-  if (key_len > item_key_len) {
-    do {
-      if (((*item)->child != NULL) &&
-	  !strncmp(key, (*item)->key_part, item_key_len))
-	return _trie_dico_remove(&(*item)->child, key+item_key_len, destroy);
-      item= &(*item)->brother;
-    } while (*item != NULL);
+  child_ref= _trie_dico_find_child(item, (uint8_t) *key);
+  if (child_ref == NULL)
+    return TRIE_DICO_ERROR_NO_MATCH;
+  result= _trie_dico_remove(child_ref, key+1, destroy);
+  if ((result == TRIE_DICO_SUCCESS) && (*child_ref == NULL)) {
+    _trie_dico_remove_child(item_ref, (uint8_t) *key);
+    _trie_dico_compact(item_ref);
   }
-
-  return TRIE_DICO_ERROR_NO_MATCH;
+  return result;
 }
 
 // -----[ trie_dico_remove ]----------------------------------------------
@@ -675,69 +773,19 @@ static int _trie_dico_remove(_trie_dico_item_t ** item,
  * Remove the value associated with the given key. Remove any
  * unnecessary nodes in the tree.
  *
- * Pre: (key length < TRIE_DICO_KEY_SIZE)
- *
  * RETURNS:
- *   -1 if key does not exist
- *    0 if key has been removed.
+ *   TRIE_DICO_ERROR_NO_MATCH if key does not exist
+ *   TRIE_DICO_SUCCESS        if key has been removed.
  */
 int trie_dico_remove(gds_trie_dico_t * trie_dico, trie_dico_key_t key)
 {
-  if (trie_dico->root == NULL)
-    return TRIE_DICO_ERROR_NO_MATCH;
-
   return _trie_dico_remove(&trie_dico->root, key, trie_dico->destroy);
 }
 
-// -----[ _trie_dico_replace ]--------------------------------------------
-static int _trie_dico_replace(_trie_dico_item_t * item,
-			      const trie_dico_key_t key,
-			      void * data,
-			      gds_trie_dico_destroy_f destroy)
-{
-  size_t key_len= strlen(key);
-  size_t item_key_len= strlen(item->key_part);
-
-  // requested key is smaller than current => no match found
-  if (key_len < item_key_len)
-    return TRIE_DICO_ERROR_NO_MATCH;
-
-  // requested key has same length
-  if (key_len == item_key_len) {
-    if ((strcmp(key, item->key_part) == 0) && item->is_final_data) {
-      if (destroy != NULL)
-	destroy(&item->data);
-      item->data= data;
-      return TRIE_DICO_SUCCESS;
-    } else
-      return TRIE_DICO_ERROR_NO_MATCH;
-  }
-
-  // requested key is longer => check if common parts match
-  if (key_len > item_key_len) {
-
-    // Note: this search could be sped up if items were sorted in the "brother"
-    // linked list. I don't assume it is sorted right now.
-
-    do {
-      if ((item->child != NULL) &&
-	  strncmp(key, item->key_part, item_key_len) == 0)
-	return _trie_dico_replace(item->child, key+item_key_len,
-				  data, destroy);
-      item= item->brother;
-    } while (item != NULL);
-
-    // None of the brothers has a matching key_part
-  }
-
-  return TRIE_DICO_ERROR_NO_MATCH;
-}
-
-
 // -----[ trie_dico_replace ]---------------------------------------------
 /**
  * Replace an existing key. An existing key is a node which has its
- * 'has_data' field equal to '1'.
+ * 'is_final_data' field equal to '1'.
  *
  * Returns:
  *   TRIE_DICO_SUCCESS
@@ -749,152 +797,229 @@ static int _trie_dico_replace(_trie_dico_item_t * item,
 int trie_dico_replace(gds_trie_dico_t * trie_dico, trie_dico_key_t key,
 		      void * data)
 {
-  if (trie_dico->root == NULL)
-    return TRIE_DICO_ERROR_NO_MATCH;
+  _trie_dico_item_t * item= _trie_dico_find_exact(trie_dico->root, key);
 
-  return _trie_dico_replace(trie_dico->root, key,
-			    data, trie_dico->destroy);
+  if (item == NULL)
+    return TRIE_DICO_ERROR_NO_MATCH;
+  if (trie_dico->destroy != NULL)
+    trie_dico->destroy(&item->data);
+  item->data= data;
+  return TRIE_DICO_SUCCESS;
 }
 
 // -----[ _trie_dico_destroy ]---------------------------------------
-static void _trie_dico_destroy(_trie_dico_item_t ** item,
+static void _trie_dico_destroy(_trie_dico_item_t * item,
 			       gds_trie_dico_destroy_f destroy)
 {
-  if (*item != NULL) {
-    // Destroy content of data item
-    if ((*item)->is_final_data)
-      if (destroy != NULL)
-	destroy(&(*item)->data);
-    
-    // Recursive descent (brother, then child)
-    if ((*item)->brother != NULL)
-      _trie_dico_destroy(&(*item)->brother, destroy);
-    if ((*item)->child != NULL)
-      _trie_dico_destroy(&(*item)->child, destroy);
-    
-    FREE(*item);
-  }
+  _trie_dico_item_t * child;
+  unsigned int iter= 0;
+  uint8_t c;
+
+  if ((item->is_final_data) && (destroy != NULL))
+    destroy(&item->data);
+  while ((child= _trie_dico_next_child(item, &iter, &c)) != NULL)
+    _trie_dico_destroy(child, destroy);
+  _trie_dico_node_free(item);
 }
 
 // -----[ trie_dico_destroy ]----------------------------------------
 void trie_dico_destroy(gds_trie_dico_t ** trie_dico_ref)
 {
+  _trie_dico_block_t * block;
+
   if (*trie_dico_ref != NULL) {
-    _trie_dico_destroy(&(*trie_dico_ref)->root,
-		       (*trie_dico_ref)->destroy);
+    if ((*trie_dico_ref)->root != NULL)
+      _trie_dico_destroy((*trie_dico_ref)->root,
+			 (*trie_dico_ref)->destroy);
+    while ((*trie_dico_ref)->blocks != NULL) {
+      block= (*trie_dico_ref)->blocks;
+      (*trie_dico_ref)->blocks= block->next;
+      FREE(block);
+    }
     FREE(*trie_dico_ref);
     *trie_dico_ref= NULL;
   }
 }
 
+// -----[ _trie_dico_walk_t ]---------------------------------------
+/**
+ * State of a (recursive) traversal.
+ */
+typedef struct {
+  _trie_dico_key_buf_t      key;
+  gds_trie_dico_foreach_f   foreach;
+  void                    * ctx;
+  unsigned int              limit; // 0 means no limit
+  unsigned int              count;
+} _trie_dico_walk_t;
+
 // -----[ _trie_dico_item_for_each ]---------------------------------
 static int _trie_dico_item_for_each(_trie_dico_item_t * item,
-			       gds_trie_dico_foreach_f foreach, void * ctx)
+				    _trie_dico_walk_t * walk)
 {
+  _trie_dico_item_t * child;
+  unsigned int iter= 0;
+  size_t key_len;
+  uint8_t c;
   int result;
 
-  if (item->child != NULL) {
-    result= _trie_dico_item_for_each(item->child, foreach, ctx);
-    if (result != 0)
-      return result;
-  }
+  _key_buf_append(&walk->key, item->prefix, item->prefix_len);
+  key_len= walk->key.len;
 
   if (item->is_final_data) {
-    result = foreach(item->key, item->data, ctx);
+    result= walk->foreach(walk->key.data, item->data, walk->ctx);
     if (result != 0)
       return result;
+    walk->count++;
   }
 
-  if (item->brother != NULL) {
-    result= _trie_dico_item_for_each(item->brother, foreach, ctx);
+  while ((child= _trie_dico_next_child(item, &iter, &c)) != NULL) {
+    if ((walk->limit > 0) && (walk->count >= walk->limit))
+      break;
+    _key_buf_append(&walk->key, (char *) &c, 1);
+    result= _trie_dico_item_for_each(child, walk);
     if (result != 0)
       return result;
+    _key_buf_truncate(&walk->key, key_len);
   }
-  
+
   return 0;
 }
 
-// -----[ trie_dico_for_each ]---------------------------------------
-int trie_dico_for_each(gds_trie_dico_t * trie_dico,
-		       gds_trie_dico_foreach_f foreach, void * ctx)
-{
-  if (trie_dico->root != NULL)
-    return _trie_dico_item_for_each(trie_dico->root, foreach, ctx);
-  return 0;
+// -----[ _trie_dico_seek ]------------------------------------------
+/**
+ * Find the highest node whose keys all start with the given prefix.
+ * The bytes of the keys that precede the node's own prefix are
+ * appended to 'key'.
+ *
+ * Result: the node or NULL if no key starts with the prefix.
+ */
+static _trie_dico_item_t * _trie_dico_seek(_trie_dico_item_t * item,
+					   const char * prefix,
+					   _trie_dico_key_buf_t * key)
+{
+  _trie_dico_item_t ** child_ref;
+  uint32_t match;
+
+  while (item != NULL) {
+    match= _trie_dico_prefix_match(item, prefix);
+    if (prefix[match] == '\0')
+      return item;
+    if (match < item->prefix_len)
+      return NULL;
+    _key_buf_append(key, item->prefix, item->prefix_len);
+    prefix+= match;
+    child_ref= _trie_dico_find_child(item, (uint8_t) *prefix);
+    if (child_ref == NULL)
+      return NULL;
+    _key_buf_append(key, prefix, 1);
+    prefix++;
+    item= *child_ref;
+  }
+  return NULL;
+}
 
+// -----[ trie_dico_for_each_prefix ]--------------------------------
+int trie_dico_for_each_prefix(gds_trie_dico_t * trie_dico,
+			      trie_dico_key_t prefix,
+			      unsigned int limit,
+			      gds_trie_dico_foreach_f foreach, void * ctx)
+{
+  _trie_dico_walk_t walk;
+  _trie_dico_item_t * item;
+  int result= 0;
+
+  walk.foreach= foreach;
+  walk.ctx= ctx;
+  walk.limit= limit;
+  walk.count= 0;
+  _key_buf_init(&walk.key);
+  item= _trie_dico_seek(trie_dico->root, prefix, &walk.key);
+  if (item != NULL)
+    result= _trie_dico_item_for_each(item, &walk);
+  _key_buf_done(&walk.key);
+  return result;
+}
+
+// -----[ trie_dico_for_each ]---------------------------------------
+int trie_dico_for_each(gds_trie_dico_t * trie_dico,
+		       gds_trie_dico_foreach_f foreach, void * ctx)
+{
+  return trie_dico_for_each_prefix(trie_dico, "", 0, foreach, ctx);
 }
 
 // -----[ _trie_dico_num_nodes ]-------------------------------------
 static int _trie_dico_num_nodes(_trie_dico_item_t * item, int with_data)
 {
-  int bro_child;
-
-  if (item != NULL) {
-    bro_child= (_trie_dico_num_nodes(item->child, with_data) +
-		_trie_dico_num_nodes(item->brother, with_data));
-    if (!with_data || item->is_final_data)
-      return 1 + bro_child;
-    else
-      return bro_child;
-  }
-  return 0;
+  _trie_dico_item_t * child;
+  unsigned int iter= 0;
+  int count= 0;
+  uint8_t c;
+
+  if (!with_data || item->is_final_data)
+    count++;
+  while ((child= _trie_dico_next_child(item, &iter, &c)) != NULL)
+    count+= _trie_dico_num_nodes(child, with_data);
+  return count;
 }
 
 // -----[ trie_dico_num_nodes ]--------------------------------------
 /**
  * Count the number of nodes in the trie_dico. The algorithm uses a
  * divide-and-conquer recursive approach.
+ *
+ * Note: a root node with an empty prefix and no data only exists to
+ * hold the first level of keys. It is not counted.
  */
 int trie_dico_num_nodes(gds_trie_dico_t * trie_dico, int with_data)
 {
-  return _trie_dico_num_nodes(trie_dico->root, with_data);
+  _trie_dico_item_t * root= trie_dico->root;
+  int count;
+
+  if (root == NULL)
+    return 0;
+  count= _trie_dico_num_nodes(root, with_data);
+  if (!with_data && (root->prefix_len == 0) && !root->is_final_data)
+    count--;
+  return count;
+}
+
+// -----[ _trie_dico_item_to_graphviz ]-----------------------------
+static void _trie_dico_item_to_graphviz(gds_stream_t * stream,
+					_trie_dico_item_t * item)
+{
+  _trie_dico_item_t * child;
+  unsigned int iter= 0;
+  uint8_t c;
+
+  stream_printf(stream, "  \"%p\" ", item);
+  stream_printf(stream, "[label=\"%.*s\\n", (int) item->prefix_len,
+		(item->prefix != NULL)?item->prefix:"");
+  if (item->is_final_data)
+    stream_printf(stream, "data=%p", item->data);
+  stream_printf(stream, "\"]");
+  stream_printf(stream, " ;\n");
+
+  while ((child= _trie_dico_next_child(item, &iter, &c)) != NULL) {
+    stream_printf(stream, "  \"%p\" -> \"%p\" [label=\"%c\"];\n",
+		  item, child, c);
+    _trie_dico_item_to_graphviz(stream, child);
+  }
 }
 
 // -----[ trie_dico_to_graphviz ]------------------------------------
 void trie_dico_to_graphviz(gds_stream_t * stream,
 			   gds_trie_dico_t * trie_dico)
 {
-  gds_stack_t * stack= stack_create(32);
-  _trie_dico_item_t * item;
-
   stream_printf(stream, "digraph trie_dico {\n");
-
   if (trie_dico->root != NULL)
-    stack_push(stack, trie_dico->root);
-
-  while (!stack_is_empty(stack)) {
-    item= (_trie_dico_item_t *) stack_pop(stack);
-
-    stream_printf(stream, "  \"%s/%s\" ", item->key, item->key_part);
-    stream_printf(stream, "[label=\"%s/%s\\n", item->key, item->key_part);
-    if (item->is_final_data)
-      stream_printf(stream, "data=%p", item->data);
-    stream_printf(stream, "\"]");
-    stream_printf(stream, " ;\n");
-
-    if (item->brother != NULL) {
-      stack_push(stack, item->brother);
-      stream_printf(stream, "  \"%s/%s\" -> \"%s/%s\" "
-		    "[style=\"dashed\",label=\"brother\"];\n",
-		    item->key, item->key_part,
-		    item->brother->key, item->brother->key_part);
-    }
-    if (item->child != NULL) {
-      stack_push(stack, item->child);
-      stream_printf(stream, "  \"%s/%s\" -> \"%s/%s\" ;\n",
-		    item->key, item->key_part,
-		    item->child->key, item->child->key_part);
-    }
-  }
-
+    _trie_dico_item_to_graphviz(stream, trie_dico->root);
   stream_printf(stream, "}\n");
-
-  stack_destroy(&stack);
 }
 
 // -----[ _trie_dico_get_array_for_each ]---------------------------------
 static int _trie_dico_get_array_for_each(trie_dico_key_t key,
-				    void * data, void * ctx)
+					 void * data, void * ctx)
 {
   ptr_array_t * array= (ptr_array_t *) ctx;
   if (ptr_array_append(array, data) < 0)
@@ -919,53 +1044,1397 @@ ptr_array_t * trie_dico_get_array(gds_trie_dico_t * trie_dico)
 //
 /////////////////////////////////////////////////////////////////////
 
-// ----- _enum_ctx_t -------------------------------------------
+// -----[ _prefix_enum_frame_t ]-------------------------------------
 typedef struct {
-  ptr_array_t * array;
-  gds_enum_t  * enu;
-} _enum_ctx_t;
+  _trie_dico_item_t * item;
+  unsigned int        iter;
+  size_t              key_len;  // key length up to the node's prefix
+  int                 visited;
+} _prefix_enum_frame_t;
 
-// -----[ _trie_dico_get_enum_has_next ]----------------------------------
-static int _trie_dico_get_enum_has_next(void * ctx)
+// -----[ _prefix_enum_ctx_t ]---------------------------------------
+/**
+ * Lazy pre-order traversal with an explicit stack. The stack holds
+ * one frame per node on the path from the starting node to the
+ * current node.
+ */
+typedef struct {
+  _prefix_enum_frame_t * frames;
+  unsigned int           depth;
+  unsigned int           size;
+  _trie_dico_key_buf_t   key;
+  _trie_dico_item_t    * next;
+  _trie_dico_item_t    * last;
+  unsigned int           limit;
+  unsigned int           count;
+} _prefix_enum_ctx_t;
+
+// -----[ _prefix_enum_push ]----------------------------------------
+static inline void _prefix_enum_push(_prefix_enum_ctx_t * ectx,
+				     _trie_dico_item_t * item)
 {
-  _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
-  return enum_has_next(ectx->enu);
+  _prefix_enum_frame_t * frame;
+
+  if (ectx->depth >= ectx->size) {
+    ectx->size*= 2;
+    ectx->frames= (_prefix_enum_frame_t *)
+      REALLOC(ectx->frames, ectx->size*sizeof(_prefix_enum_frame_t));
+  }
+  frame= &ectx->frames[ectx->depth++];
+  frame->item= item;
+  frame->iter= 0;
+  frame->key_len= 0;
+  frame->visited= 0;
 }
 
-// -----[ _trie_dico_get_enum_get_next ]----------------------------------
-static void * _trie_dico_get_enum_get_next(void * ctx)
+// -----[ _prefix_enum_has_next ]------------------------------------
+static int _prefix_enum_has_next(void * ctx)
 {
-  _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
-  return enum_get_next(ectx->enu);
+  _prefix_enum_ctx_t * ectx= (_prefix_enum_ctx_t *) ctx;
+  _prefix_enum_frame_t * frame;
+  _trie_dico_item_t * child;
+  uint8_t c;
+
+  if ((ectx->limit > 0) && (ectx->count >= ectx->limit))
+    return 0;
+
+  while ((ectx->next == NULL) && (ectx->depth > 0)) {
+    frame= &ectx->frames[ectx->depth-1];
+
+    if (!frame->visited) {
+      // The key buffer holds the bytes that precede the node's prefix
+      _key_buf_append(&ectx->key, frame->item->prefix,
+		      frame->item->prefix_len);
+      frame->key_len= ectx->key.len;
+      frame->visited= 1;
+      if (frame->item->is_final_data)
+	ectx->next= frame->item;
+      continue;
+    }
+
+    _key_buf_truncate(&ectx->key, frame->key_len);
+    child= _trie_dico_next_child(frame->item, &frame->iter, &c);
+    if (child != NULL) {
+      _key_buf_append(&ectx->key, (char *) &c, 1);
+      _prefix_enum_push(ectx, child);
+    } else
+      ectx->depth--;
+  }
+  return (ectx->next != NULL);
 }
 
-// -----[ _trie_dico_get_enum_destroy ]-----------------------------------
-static void _trie_dico_get_enum_destroy(void * ctx)
+// -----[ _prefix_enum_get_next ]------------------------------------
+static void * _prefix_enum_get_next(void * ctx)
 {
-  _enum_ctx_t * ectx= (_enum_ctx_t *) ctx;
-  enum_destroy(&ectx->enu);
-  ptr_array_destroy(&ectx->array);
+  _prefix_enum_ctx_t * ectx= (_prefix_enum_ctx_t *) ctx;
+
+  if (!_prefix_enum_has_next(ctx))
+    return NULL;
+  ectx->last= ectx->next;
+  ectx->next= NULL;
+  ectx->count++;
+  return &ectx->last->data;
+}
+
+// -----[ _prefix_enum_destroy ]-------------------------------------
+static void _prefix_enum_destroy(void * ctx)
+{
+  _prefix_enum_ctx_t * ectx= (_prefix_enum_ctx_t *) ctx;
+  _key_buf_done(&ectx->key);
+  FREE(ectx->frames);
   FREE(ectx);
 }
 
+// -----[ trie_dico_get_prefix_enum ]--------------------------------
+gds_enum_t * trie_dico_get_prefix_enum(gds_trie_dico_t * trie_dico,
+				       trie_dico_key_t prefix,
+				       unsigned int limit)
+{
+  _prefix_enum_ctx_t * ectx=
+    (_prefix_enum_ctx_t *) MALLOC(sizeof(_prefix_enum_ctx_t));
+  _trie_dico_item_t * item;
+
+  ectx->size= 16;
+  ectx->depth= 0;
+  ectx->frames= (_prefix_enum_frame_t *)
+    MALLOC(ectx->size*sizeof(_prefix_enum_frame_t));
+  ectx->next= NULL;
+  ectx->last= NULL;
+  ectx->limit= limit;
+  ectx->count= 0;
+  _key_buf_init(&ectx->key);
+  item= _trie_dico_seek(trie_dico->root, prefix, &ectx->key);
+  if (item != NULL)
+    _prefix_enum_push(ectx, item);
+
+  return enum_create(ectx,
+		     _prefix_enum_has_next,
+		     _prefix_enum_get_next,
+		     _prefix_enum_destroy);
+}
+
 // -----[ trie_dico_get_enum ]--------------------------------------------
 gds_enum_t * trie_dico_get_enum(gds_trie_dico_t * trie_dico)
 {
-  _enum_ctx_t * ectx=
-    (_enum_ctx_t *) MALLOC(sizeof(_enum_ctx_t));
-  ectx->array= trie_dico_get_array(trie_dico);
-  ectx->enu= _array_get_enum((array_t *) ectx->array);
+  return trie_dico_get_prefix_enum(trie_dico, (trie_dico_key_t) "", 0);
+}
 
-  return enum_create(ectx,
-		     _trie_dico_get_enum_has_next,
-		     _trie_dico_get_enum_get_next,
-		     _trie_dico_get_enum_destroy);
+// -----[ trie_dico_enum_get_key ]-----------------------------------
+trie_dico_key_t trie_dico_enum_get_key(gds_enum_t * enu)
+{
+  _prefix_enum_ctx_t * ectx= (_prefix_enum_ctx_t *) enu->ctx;
+
+  assert(enu->ops.get_next == _prefix_enum_get_next);
+  if (ectx->last == NULL)
+    return NULL;
+  return ectx->key.data;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// BULK LOADING
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _trie_dico_bulk_frame_t ]----------------------------------
+/**
+ * Node under construction during a bulk load. The node's string is
+ * the first 'len' bytes of 'src'. Its children are the pending
+ * children from index 'children'.
+ */
+typedef struct {
+  const char   * src;
+  size_t         len;
+  unsigned int   children;
+  int            has_data;
+  void         * data;
+} _trie_dico_bulk_frame_t;
+
+// Minimum size of a block allocated by a bulk load
+#define _TRIE_DICO_BLOCK_SIZE (1 << 20)
+
+// -----[ _trie_dico_bulk_t ]----------------------------------------
+/**
+ * State of a bulk load. Nodes and prefixes are carved out of large
+ * blocks that are chained in the dictionary.
+ */
+typedef struct {
+  gds_trie_dico_t          * trie_dico;
+  _trie_dico_bulk_frame_t  * frames;
+  unsigned int               depth;
+  unsigned int               frames_size;
+  uint8_t                  * pending_keys;
+  _trie_dico_item_t       ** pending;
+  unsigned int               num_pending;
+  unsigned int               pending_size;
+  char                     * next;
+  size_t                     left;
+} _trie_dico_bulk_t;
+
+// -----[ _trie_dico_bulk_cmp ]--------------------------------------
+static int _trie_dico_bulk_cmp(const void * item1, const void * item2)
+{
+  return strcmp(((const gds_trie_dico_bulk_item_t *) item1)->key,
+		((const gds_trie_dico_bulk_item_t *) item2)->key);
+}
+
+// -----[ _trie_dico_bulk_alloc ]------------------------------------
+/**
+ * Allocate memory from the current block. Node sizes are multiples
+ * of 8 bytes: the allocation is aligned on 8 bytes when 'size' is.
+ */
+static inline void * _trie_dico_bulk_alloc(_trie_dico_bulk_t * bulk,
+					   size_t size)
+{
+  _trie_dico_block_t * block;
+  size_t block_size;
+  void * ptr;
+
+  if (bulk->left < size) {
+    block_size= (size > _TRIE_DICO_BLOCK_SIZE)?size:_TRIE_DICO_BLOCK_SIZE;
+    block= (_trie_dico_block_t *) MALLOC(sizeof(_trie_dico_block_t) +
+					 block_size);
+    block->next= bulk->trie_dico->blocks;
+    bulk->trie_dico->blocks= block;
+    bulk->next= (char *) (block+1);
+    bulk->left= block_size;
+  }
+  ptr= bulk->next;
+  bulk->next+= size;
+  bulk->left-= size;
+  return ptr;
+}
+
+// -----[ _trie_dico_bulk_sort_t ]-----------------------------------
+/**
+ * Item being sorted. The 8 bytes of the key that are being compared
+ * are cached in 'head' (big-endian, padded with 0) so that the sort
+ * accesses each key only once per 8 bytes.
+ */
+typedef struct {
+  uint64_t       head;
+  unsigned int   index;
+} _trie_dico_bulk_sort_t;
+
+// Runs shorter than this are sorted by insertion
+#define _TRIE_DICO_SORT_INSERTION 32
+
+#define _SORT_DIGIT(E,B) ((uint8_t) ((E).head >> (8*(B))))
+
+// -----[ _trie_dico_bulk_sort_heads ]-------------------------------
+/**
+ * Sort entries by head with an in-place MSD radix sort (American
+ * flag sort), from byte 'byte' (7 is the most significant) down. The
+ * more significant bytes are the same in all the entries.
+ */
+static void _trie_dico_bulk_sort_heads(_trie_dico_bulk_sort_t * entries,
+				       unsigned int num_entries, int byte)
+{
+  unsigned int next[256], end[256];
+  _trie_dico_bulk_sort_t entry, swap;
+  unsigned int index, pos;
+  uint8_t digit;
+
+  if (num_entries < _TRIE_DICO_SORT_INSERTION) {
+    for (index= 1; index < num_entries; index++) {
+      entry= entries[index];
+      for (pos= index; (pos > 0) && (entries[pos-1].head > entry.head); pos--)
+	entries[pos]= entries[pos-1];
+      entries[pos]= entry;
+    }
+    return;
+  }
+
+  // Skip the bytes that are the same in all the entries
+  for (; byte >= 0; byte--) {
+    memset(end, 0, sizeof(end));
+    for (index= 0; index < num_entries; index++)
+      end[_SORT_DIGIT(entries[index], byte)]++;
+    if (end[_SORT_DIGIT(entries[0], byte)] < num_entries)
+      break;
+  }
+  if (byte < 0)
+    return;
+  for (index= 0, pos= 0; index < 256; index++) {
+    next[index]= pos;
+    pos+= end[index];
+    end[index]= pos;
+  }
+
+  // Move each entry to its bucket, following cycles
+  for (index= 0; index < 256; index++) {
+    while (next[index] < end[index]) {
+      entry= entries[next[index]];
+      digit= _SORT_DIGIT(entry, byte);
+      while (digit != index) {
+	swap= entries[next[digit]];
+	entries[next[digit]++]= entry;
+	entry= swap;
+	digit= _SORT_DIGIT(entry, byte);
+      }
+      entries[next[index]++]= entry;
+    }
+  }
+
+  if (byte > 0)
+    for (index= 0, pos= 0; index < 256; pos= end[index++])
+      if (end[index]-pos > 1)
+	_trie_dico_bulk_sort_heads(entries+pos, end[index]-pos, byte-1);
+}
+
+// -----[ _trie_dico_bulk_sort_run ]---------------------------------
+/**
+ * Sort entries whose keys are equal up to byte 'offset'. The entries
+ * are sorted by the next 8 bytes of their keys, then each run of
+ * entries with the same 8 bytes is sorted on the following bytes,
+ * unless their keys end in these 8 bytes (they are then equal).
+ *
+ * \retval 0 if the keys are distinct,
+ *   or -1 if a key appears more than once.
+ */
+static int _trie_dico_bulk_sort_run(const gds_trie_dico_bulk_item_t * items,
+				    _trie_dico_bulk_sort_t * entries,
+				    unsigned int num_entries, size_t offset)
+{
+  unsigned int index, pos;
+  uint64_t head;
+  const char * key;
+
+  for (index= 0; index < num_entries; index++) {
+    key= items[entries[index].index].key+offset;
+    head= 0;
+    for (pos= 0; (pos < 8) && (key[pos] != '\0'); pos++)
+      head|= ((uint64_t) (uint8_t) key[pos]) << (56-8*pos);
+    entries[index].head= head;
+  }
+  _trie_dico_bulk_sort_heads(entries, num_entries, 7);
+
+  for (index= 0; index < num_entries; index= pos) {
+    for (pos= index+1; (pos < num_entries) &&
+	   (entries[pos].head == entries[index].head); pos++);
+    if (pos-index == 1)
+      continue;
+    if ((entries[index].head & 0xff) == 0)
+      return -1;
+    if (_trie_dico_bulk_sort_run(items, entries+index, pos-index,
+				 offset+8) < 0)
+      return -1;
+  }
+  return 0;
+}
+
+// -----[ _trie_dico_bulk_sort ]-------------------------------------
+/**
+ * Return a sorted copy of an array of items, or NULL if a key
+ * appears more than once.
+ */
+static gds_trie_dico_bulk_item_t *
+_trie_dico_bulk_sort(const gds_trie_dico_bulk_item_t * items,
+		     unsigned int num_items)
+{
+  _trie_dico_bulk_sort_t * entries= (_trie_dico_bulk_sort_t *)
+    MALLOC(num_items*sizeof(_trie_dico_bulk_sort_t));
+  gds_trie_dico_bulk_item_t * sorted= NULL;
+  unsigned int index;
+
+  for (index= 0; index < num_items; index++)
+    entries[index].index= index;
+  if (_trie_dico_bulk_sort_run(items, entries, num_items, 0) == 0) {
+    sorted= (gds_trie_dico_bulk_item_t *)
+      MALLOC(num_items*sizeof(gds_trie_dico_bulk_item_t));
+    for (index= 0; index < num_items; index++)
+      sorted[index]= items[entries[index].index];
+  }
+  FREE(entries);
+  return sorted;
+}
+
+// -----[ _trie_dico_bulk_push ]-------------------------------------
+static inline void _trie_dico_bulk_push(_trie_dico_bulk_t * bulk,
+					const char * src, size_t len,
+					int has_data, void * data)
+{
+  _trie_dico_bulk_frame_t * frame;
+
+  if (bulk->depth >= bulk->frames_size) {
+    bulk->frames_size*= 2;
+    bulk->frames= (_trie_dico_bulk_frame_t *)
+      REALLOC(bulk->frames,
+	      bulk->frames_size*sizeof(_trie_dico_bulk_frame_t));
+  }
+  frame= &bulk->frames[bulk->depth++];
+  frame->src= src;
+  frame->len= len;
+  frame->children= bulk->num_pending;
+  frame->has_data= has_data;
+  frame->data= data;
+}
+
+// -----[ _trie_dico_bulk_add_child ]--------------------------------
+static inline void _trie_dico_bulk_add_child(_trie_dico_bulk_t * bulk,
+					     uint8_t c,
+					     _trie_dico_item_t * child)
+{
+  if (bulk->num_pending >= bulk->pending_size) {
+    bulk->pending_size*= 2;
+    bulk->pending_keys= (uint8_t *)
+      REALLOC(bulk->pending_keys, bulk->pending_size);
+    bulk->pending= (_trie_dico_item_t **)
+      REALLOC(bulk->pending,
+	      bulk->pending_size*sizeof(_trie_dico_item_t *));
+  }
+  bulk->pending_keys[bulk->num_pending]= c;
+  bulk->pending[bulk->num_pending]= child;
+  bulk->num_pending++;
+}
+
+// -----[ _trie_dico_bulk_close ]------------------------------------
+/**
+ * Complete a node once all its children are known. The node's
+ * prefix starts at byte 'start' of its string.
+ */
+static _trie_dico_item_t *
+_trie_dico_bulk_close(_trie_dico_bulk_t * bulk,
+		      const _trie_dico_bulk_frame_t * frame,
+		      size_t start)
+{
+  unsigned int num_children= bulk->num_pending-frame->children;
+  size_t prefix_len= frame->len-start;
+  _trie_dico_item_t * item;
+  _trie_dico_item_t * child;
+  unsigned int index;
+  uint8_t type, c;
+
+  for (type= _NODE_LEAF; _NODE_CAPACITY[type] < num_children; type++);
+  bulk->num_pending= frame->children;
+
+  // The prefix is stored right after the node, then padded
+  item= (_trie_dico_item_t *)
+    _trie_dico_bulk_alloc(bulk, _NODE_SIZE[type] + ((prefix_len+7) & ~7));
+  memset(item, 0, _NODE_SIZE[type]);
+  item->type= type;
+  item->in_block= 1;
+  if (prefix_len > 0) {
+    item->prefix= ((char *) item) + _NODE_SIZE[type];
+    item->prefix_in_block= 1;
+    item->prefix_len= prefix_len;
+    memcpy(item->prefix, frame->src+start, prefix_len);
+  }
+  item->is_final_data= frame->has_data;
+  item->data= frame->data;
+  item->num_children= num_children;
+
+  // Pending children are sorted by key byte
+  for (index= 0; index < num_children; index++) {
+    c= bulk->pending_keys[frame->children+index];
+    child= bulk->pending[frame->children+index];
+    switch (type) {
+    case _NODE_4:
+      ((_trie_dico_node4_t *) item)->keys[index]= c;
+      ((_trie_dico_node4_t *) item)->children[index]= child;
+      break;
+    case _NODE_16:
+      ((_trie_dico_node16_t *) item)->keys[index]= c;
+      ((_trie_dico_node16_t *) item)->children[index]= child;
+      break;
+    case _NODE_48:
+      ((_trie_dico_node48_t *) item)->index[c]= index+1;
+      ((_trie_dico_node48_t *) item)->children[index]= child;
+      break;
+    case _NODE_256:
+      ((_trie_dico_node256_t *) item)->children[c]= child;
+      break;
+    default:
+      abort();
+    }
+  }
+  return item;
+}
+
+// -----[ _trie_dico_bulk_pop ]--------------------------------------
+/**
+ * Complete the node on top of the stack and add it to its parent.
+ * If 'len' is larger than the string length of the node below, a
+ * new node with length 'len' is inserted in between.
+ */
+static inline void _trie_dico_bulk_pop(_trie_dico_bulk_t * bulk,
+				       size_t len)
+{
+  _trie_dico_bulk_frame_t frame= bulk->frames[--bulk->depth];
+  size_t parent_len= bulk->frames[bulk->depth-1].len;
+  _trie_dico_item_t * item;
+
+  if (parent_len < len)
+    parent_len= len;
+  item= _trie_dico_bulk_close(bulk, &frame, parent_len+1);
+  if (parent_len > bulk->frames[bulk->depth-1].len)
+    _trie_dico_bulk_push(bulk, frame.src, parent_len, 0, NULL);
+  _trie_dico_bulk_add_child(bulk, (uint8_t) frame.src[parent_len], item);
+}
+
+// -----[ _trie_dico_bulk_build ]------------------------------------
+/**
+ * Build the tree from sorted keys in a single pass. The stack holds
+ * the path from the root to the node of the previous key. For each
+ * key, the nodes deeper than its longest common prefix with the
+ * previous key are completed (bottom-up) and the key's node is
+ * pushed.
+ */
+static _trie_dico_item_t *
+_trie_dico_bulk_build(_trie_dico_bulk_t * bulk,
+		      const gds_trie_dico_bulk_item_t * items,
+		      unsigned int num_items)
+{
+  const char * first= items[0].key;
+  const char * last= items[num_items-1].key;
+  const char * prev, * key;
+  unsigned int index;
+  size_t lcp, len;
+
+  // The root's string is the prefix common to all the keys
+  lcp= 0;
+  while ((first[lcp] != '\0') && (first[lcp] == last[lcp]))
+    lcp++;
+  bulk->depth= 0;
+  bulk->num_pending= 0;
+  _trie_dico_bulk_push(bulk, first, lcp, 0, NULL);
+
+  prev= NULL;
+  for (index= 0; index < num_items; index++) {
+    key= items[index].key;
+    if (prev != NULL)
+      while ((key[lcp] != '\0') && (key[lcp] == prev[lcp]))
+	lcp++;
+    while (bulk->frames[bulk->depth-1].len > lcp)
+      _trie_dico_bulk_pop(bulk, lcp);
+    len= lcp+strlen(key+lcp);
+    if (len == lcp) {
+      bulk->frames[bulk->depth-1].has_data= 1;
+      bulk->frames[bulk->depth-1].data= items[index].data;
+    } else {
+      _trie_dico_bulk_push(bulk, key, len, 1, items[index].data);
+    }
+    prev= key;
+    lcp= bulk->frames[0].len;
+  }
+  while (bulk->depth > 1)
+    _trie_dico_bulk_pop(bulk, 0);
+  return _trie_dico_bulk_close(bulk, &bulk->frames[0], 0);
+}
+
+// -----[ trie_dico_bulk_load ]--------------------------------------
+int trie_dico_bulk_load(gds_trie_dico_t * trie_dico,
+			const gds_trie_dico_bulk_item_t * items,
+			unsigned int num_items)
+{
+  gds_trie_dico_bulk_item_t * sorted= NULL;
+  _trie_dico_bulk_t bulk;
+  unsigned int index;
+  int cmp;
+
+  if (num_items == 0)
+    return TRIE_DICO_SUCCESS;
+
+  // Non-empty dictionary: insert the items one by one, up to the
+  // first invalid one
+  if (trie_dico->root != NULL) {
+    for (index= 0; index < num_items; index++)
+      if (trie_dico_insert(trie_dico, items[index].key,
+			   items[index].data, 0) != TRIE_DICO_SUCCESS)
+	return TRIE_DICO_ERROR_DUPLICATE;
+    return TRIE_DICO_SUCCESS;
+  }
+
+  // Check that the items are sorted, otherwise sort a copy
+  for (index= 1; index < num_items; index++) {
+    cmp= _trie_dico_bulk_cmp(&items[index-1], &items[index]);
+    if (cmp == 0)
+      return TRIE_DICO_ERROR_DUPLICATE;
+    if (cmp > 0)
+      break;
+  }
+  if (index < num_items) {
+    sorted= _trie_dico_bulk_sort(items, num_items);
+    if (sorted == NULL)
+      return TRIE_DICO_ERROR_DUPLICATE;
+    items= sorted;
+  }
+
+  bulk.trie_dico= trie_dico;
+  bulk.next= NULL;
+  bulk.left= 0;
+  bulk.frames_size= 32;
+  bulk.frames= (_trie_dico_bulk_frame_t *)
+    MALLOC(bulk.frames_size*sizeof(_trie_dico_bulk_frame_t));
+  bulk.pending_size= 256;
+  bulk.pending_keys= (uint8_t *) MALLOC(bulk.pending_size);
+  bulk.pending= (_trie_dico_item_t **)
+    MALLOC(bulk.pending_size*sizeof(_trie_dico_item_t *));
+  trie_dico->root= _trie_dico_bulk_build(&bulk, items, num_items);
+
+  FREE(bulk.frames);
+  FREE(bulk.pending_keys);
+  FREE(bulk.pending);
+  if (sorted != NULL)
+    FREE(sorted);
+  return TRIE_DICO_SUCCESS;
 }
 
 /////////////////////////////////////////////////////////////////////
 //
-// INITIALIZATION PART
+// FROZEN DICTIONARY
+//
+// The frozen dictionary is a LOUDS encoding of the tree. Nodes are
+// numbered in level order (root is 0) and the children of a node
+// have consecutive numbers. The LOUDS bit-vector contains, for each
+// node, its number of children in unary (1^d 0). The children of
+// node i start at 1 + select0(i-1) + 1 - i. The other node fields
+// are stored in flat arrays: the label of the edge towards each
+// node, a bit-vector of nodes with data (values are located with
+// rank1) and a bit-vector of nodes with a compressed path (paths
+// are located with rank1 in an offset table).
+//
+// The whole structure is a single pointer-free image that can be
+// written to a file and mapped back in memory.
 //
 /////////////////////////////////////////////////////////////////////
 
+#define _FROZEN_MAGIC      "GDSDICO1"
+#define _FROZEN_BYTE_ORDER 0x01020304u
 
+// -----[ _frozen_header_t ]-----------------------------------------
+/**
+ * Image header. Section offsets are relative to the beginning of the
+ * image and aligned on 8 bytes.
+ */
+typedef struct {
+  char     magic[8];
+  uint32_t byte_order;
+  uint32_t num_nodes;
+  uint32_t num_keys;
+  uint32_t num_prefixes;
+  uint64_t louds_off;
+  uint64_t louds_select_off;
+  uint64_t labels_off;
+  uint64_t data_bits_off;
+  uint64_t data_rank_off;
+  uint64_t prefix_bits_off;
+  uint64_t prefix_rank_off;
+  uint64_t prefix_offsets_off;
+  uint64_t prefix_pool_off;
+  uint64_t values_off;
+  uint64_t size;
+} _frozen_header_t;
+
+// -----[ gds_trie_dico_frozen_t ]-----------------------------------
+struct gds_trie_dico_frozen_t {
+  uint8_t                * image;
+  int                      mapped;
+  const _frozen_header_t * header;
+  const uint64_t         * louds;
+  const uint32_t         * louds_select;
+  const uint8_t          * labels;
+  const uint64_t         * data_bits;
+  const uint32_t         * data_rank;
+  const uint64_t         * prefix_bits;
+  const uint32_t         * prefix_rank;
+  const uint32_t         * prefix_offsets;
+  const char             * prefix_pool;
+  const uint64_t         * values;
+};
+
+// Number of bits covered by a rank sample (8 words)
+#define _RANK_BLOCK_BITS   512
+// Number of zeros between two select samples
+#define _SELECT_SAMPLE     256
+
+// -----[ _bits_words ]----------------------------------------------
+static inline size_t _bits_words(size_t num_bits)
+{
+  return (num_bits+63)/64;
+}
+
+// -----[ _bits_get ]------------------------------------------------
+static inline int _bits_get(const uint64_t * bits, uint32_t index)
+{
+  return (bits[index >> 6] >> (index & 63)) & 1;
+}
+
+// -----[ _bits_set ]------------------------------------------------
+static inline void _bits_set(uint64_t * bits, uint32_t index)
+{
+  bits[index >> 6]|= ((uint64_t) 1) << (index & 63);
+}
+
+// -----[ _bits_rank1 ]----------------------------------------------
+/**
+ * Return the number of bits set in [0, index).
+ */
+static inline uint32_t _bits_rank1(const uint64_t * bits,
+				   const uint32_t * rank,
+				   uint32_t index)
+{
+  uint32_t word= (index/_RANK_BLOCK_BITS)*(_RANK_BLOCK_BITS/64);
+  uint32_t count= rank[index/_RANK_BLOCK_BITS];
+
+  for (; word < (index >> 6); word++)
+    count+= __builtin_popcountll(bits[word]);
+  if (index & 63)
+    count+= __builtin_popcountll(bits[word] &
+				 ((((uint64_t) 1) << (index & 63))-1));
+  return count;
+}
+
+// -----[ _bits_select0 ]--------------------------------------------
+/**
+ * Return the position of the n-th (from 0) cleared bit.
+ */
+static inline uint32_t _bits_select0(const uint64_t * bits,
+				     const uint32_t * samples,
+				     uint32_t n)
+{
+  uint32_t pos= samples[n/_SELECT_SAMPLE];
+  uint32_t remaining= n % _SELECT_SAMPLE;
+  uint32_t word_index;
+  uint64_t word;
+  uint32_t count;
+
+  if (remaining == 0)
+    return pos;
+
+  pos++;
+  word_index= pos >> 6;
+  word= ~bits[word_index] & (~((uint64_t) 0) << (pos & 63));
+  while (1) {
+    count= __builtin_popcountll(word);
+    if (remaining <= count)
+      break;
+    remaining-= count;
+    word= ~bits[++word_index];
+  }
+  while (--remaining > 0)
+    word&= word-1;
+  return (word_index << 6) + __builtin_ctzll(word);
+}
+
+// -----[ _frozen_children ]-----------------------------------------
+/**
+ * Return the number of children of a node and the number of its
+ * first child.
+ */
+static inline uint32_t _frozen_children(const gds_trie_dico_frozen_t * frozen,
+					uint32_t node, uint32_t * first)
+{
+  uint32_t start= 0;
+  uint32_t degree= 0;
+  uint32_t word_index;
+  uint64_t word;
+  uint32_t ones;
+
+  if (node > 0)
+    start= _bits_select0(frozen->louds, frozen->louds_select, node-1)+1;
+  *first= 1 + start - node;
+
+  // Count the 1s that follow the start position
+  word_index= start >> 6;
+  word= frozen->louds[word_index] >> (start & 63);
+  ones= (~word == 0)?64:__builtin_ctzll(~word);
+  degree= ones;
+  if (ones == 64 - (start & 63)) {
+    do {
+      word= frozen->louds[++word_index];
+      ones= (~word == 0)?64:__builtin_ctzll(~word);
+      degree+= ones;
+    } while (ones == 64);
+  }
+  return degree;
+}
+
+// -----[ _frozen_find_child ]---------------------------------------
+/**
+ * Return the child of a node along the edge labelled 'c', or 0 if
+ * there is no such child (0 is the root, it is never a child).
+ */
+static inline uint32_t _frozen_find_child(const gds_trie_dico_frozen_t * frozen,
+					  uint32_t node, uint8_t c)
+{
+  uint32_t first;
+  uint32_t degree= _frozen_children(frozen, node, &first);
+  uint32_t low= first, high= first+degree;
+  uint32_t middle;
+
+  // Labels of the children are sorted
+  while (low < high) {
+    middle= (low+high)/2;
+    if (frozen->labels[middle] < c)
+      low= middle+1;
+    else
+      high= middle;
+  }
+  if ((low < first+degree) && (frozen->labels[low] == c))
+    return low;
+  return 0;
+}
+
+// -----[ _frozen_prefix ]-------------------------------------------
+static inline uint32_t _frozen_prefix(const gds_trie_dico_frozen_t * frozen,
+				      uint32_t node, const char ** prefix)
+{
+  uint32_t index;
+
+  if (!_bits_get(frozen->prefix_bits, node)) {
+    *prefix= "";
+    return 0;
+  }
+  index= _bits_rank1(frozen->prefix_bits, frozen->prefix_rank, node);
+  *prefix= frozen->prefix_pool + frozen->prefix_offsets[index];
+  return frozen->prefix_offsets[index+1]-frozen->prefix_offsets[index];
+}
+
+// -----[ _frozen_data ]---------------------------------------------
+/**
+ * Return 1 and the node's data if the node holds a key, 0
+ * otherwise.
+ */
+static inline int _frozen_data(const gds_trie_dico_frozen_t * frozen,
+			       uint32_t node, void ** data)
+{
+  if (!_bits_get(frozen->data_bits, node))
+    return 0;
+  *data= (void *) (size_t)
+    frozen->values[_bits_rank1(frozen->data_bits, frozen->data_rank, node)];
+  return 1;
+}
+
+// -----[ _frozen_prefix_match ]-------------------------------------
+static inline int _frozen_prefix_match(const char * prefix,
+				       uint32_t prefix_len,
+				       const char * key)
+{
+  uint32_t index= 0;
+  while ((index < prefix_len) && (prefix[index] == key[index]))
+    index++;
+  return index;
+}
+
+// -----[ _frozen_bind ]---------------------------------------------
+/**
+ * Setup the section pointers of a frozen dictionary from its image.
+ */
+static void _frozen_bind(gds_trie_dico_frozen_t * frozen)
+{
+  const _frozen_header_t * header= (const _frozen_header_t *) frozen->image;
+  frozen->header= header;
+  frozen->louds= (const uint64_t *) (frozen->image + header->louds_off);
+  frozen->louds_select=
+    (const uint32_t *) (frozen->image + header->louds_select_off);
+  frozen->labels= frozen->image + header->labels_off;
+  frozen->data_bits= (const uint64_t *) (frozen->image + header->data_bits_off);
+  frozen->data_rank= (const uint32_t *) (frozen->image + header->data_rank_off);
+  frozen->prefix_bits=
+    (const uint64_t *) (frozen->image + header->prefix_bits_off);
+  frozen->prefix_rank=
+    (const uint32_t *) (frozen->image + header->prefix_rank_off);
+  frozen->prefix_offsets=
+    (const uint32_t *) (frozen->image + header->prefix_offsets_off);
+  frozen->prefix_pool= (const char *) (frozen->image + header->prefix_pool_off);
+  frozen->values= (const uint64_t *) (frozen->image + header->values_off);
+}
+
+// -----[ _frozen_section_fits ]-------------------------------------
+/**
+ * Test that a section of an image is aligned and lies between a
+ * lower bound (the end of the previous section) and the end of the
+ * image.
+ */
+static inline int _frozen_section_fits(uint64_t off, uint64_t len,
+				       uint64_t align, uint64_t min,
+				       uint64_t size)
+{
+  return ((off % align) == 0) && (off >= min) && (off <= size) &&
+    (len <= size-off);
+}
+
+// -----[ _frozen_check_bits ]--------------------------------------
+/**
+ * Check that the bits past the last node are cleared, that the rank
+ * samples of a bit vector match the bits and that the number of bits
+ * set is the expected one.
+ */
+static int _frozen_check_bits(const uint64_t * bits, const uint32_t * rank,
+			      uint32_t num_bits, uint32_t num_set)
+{
+  size_t num_words= _bits_words(num_bits);
+  uint32_t count= 0;
+  size_t word;
+
+  if ((num_bits & 63) && (bits[num_words-1] >> (num_bits & 63)))
+    return -1;
+  for (word= 0; word < num_words; word++) {
+    if ((word % (_RANK_BLOCK_BITS/64) == 0) &&
+	(rank[word/(_RANK_BLOCK_BITS/64)] != count))
+      return -1;
+    count+= __builtin_popcountll(bits[word]);
+  }
+  if ((rank[(num_words+(_RANK_BLOCK_BITS/64)-1)/(_RANK_BLOCK_BITS/64)] !=
+       count) || (count != num_set))
+    return -1;
+  return 0;
+}
+
+// -----[ _frozen_check_louds ]--------------------------------------
+/**
+ * Check that the LOUDS bits describe a tree of num_nodes nodes and
+ * that the select samples match the bits.
+ *
+ * There must be num_nodes-1 1s (edges) and num_nodes 0s (ends of the
+ * nodes), the last bit being a 0. The i-th 1 is the edge towards node
+ * i+1: it must lie after the start of its parent, so that a child has
+ * a higher number than its parent and the walks terminate.
+ */
+static int _frozen_check_louds(const gds_trie_dico_frozen_t * frozen,
+			       uint32_t num_nodes)
+{
+  uint32_t num_bits, bit, ones= 0, zeros= 0;
+
+  if (num_nodes == 0)
+    return 0;
+  num_bits= 2*num_nodes-1;
+  if (((num_bits & 63) && (frozen->louds[num_bits >> 6] >> (num_bits & 63))) ||
+      _bits_get(frozen->louds, num_bits-1))
+    return -1;
+  for (bit= 0; bit < num_bits; bit++) {
+    if (_bits_get(frozen->louds, bit)) {
+      // The parent is the node whose 0 comes next (number 'zeros')
+      if (++ones <= zeros)
+	return -1;
+    } else {
+      if ((zeros < num_nodes-1) && (zeros % _SELECT_SAMPLE == 0) &&
+	  (frozen->louds_select[zeros/_SELECT_SAMPLE] != bit))
+	return -1;
+      zeros++;
+    }
+  }
+  if ((ones != num_nodes-1) || (zeros != num_nodes))
+    return -1;
+  return 0;
+}
+
+// -----[ _frozen_check ]--------------------------------------------
+/**
+ * Check that the sections described by the header of an image fit in
+ * the image, in the order of the layout built by trie_dico_freeze(),
+ * that the compressed paths lie in the pool of paths, and that the
+ * bit vectors and their rank and select samples are consistent with
+ * the numbers of nodes, keys and paths. This takes time linear in the
+ * number of nodes, but the queries then need no bound check.
+ *
+ * \retval 0 if the image is consistent,
+ *   or -1 otherwise.
+ */
+static int _frozen_check(const gds_trie_dico_frozen_t * frozen)
+{
+  const _frozen_header_t * header= frozen->header;
+  uint64_t size= header->size;
+  uint64_t num_nodes= header->num_nodes;
+  uint64_t num_louds_words=
+    _bits_words((num_nodes > 0)?2*num_nodes-1:0);
+  uint64_t num_node_words= _bits_words(num_nodes);
+  uint64_t rank_len= (num_nodes/_RANK_BLOCK_BITS+2)*sizeof(uint32_t);
+  uint64_t pool_len;
+  uint32_t index;
+
+  if ((header->num_keys > num_nodes) || (header->num_prefixes > num_nodes) ||
+      !_frozen_section_fits(header->louds_off, num_louds_words*8, 8,
+			    sizeof(_frozen_header_t), size) ||
+      !_frozen_section_fits(header->louds_select_off,
+			    (num_nodes/_SELECT_SAMPLE+1)*sizeof(uint32_t),
+			    4, header->louds_off+num_louds_words*8, size) ||
+      !_frozen_section_fits(header->labels_off, num_nodes, 1,
+			    header->louds_select_off+
+			    (num_nodes/_SELECT_SAMPLE+1)*sizeof(uint32_t),
+			    size) ||
+      !_frozen_section_fits(header->data_bits_off, num_node_words*8, 8,
+			    header->labels_off+num_nodes, size) ||
+      !_frozen_section_fits(header->data_rank_off, rank_len, 4,
+			    header->data_bits_off+num_node_words*8, size) ||
+      !_frozen_section_fits(header->prefix_bits_off, num_node_words*8, 8,
+			    header->data_rank_off+rank_len, size) ||
+      !_frozen_section_fits(header->prefix_rank_off, rank_len, 4,
+			    header->prefix_bits_off+num_node_words*8, size) ||
+      !_frozen_section_fits(header->prefix_offsets_off,
+			    (header->num_prefixes+1)*sizeof(uint32_t), 4,
+			    header->prefix_rank_off+rank_len, size) ||
+      !_frozen_section_fits(header->prefix_pool_off, 0, 1,
+			    header->prefix_offsets_off+
+			    (header->num_prefixes+1)*sizeof(uint32_t),
+			    size) ||
+      !_frozen_section_fits(header->values_off,
+			    header->num_keys*sizeof(uint64_t), 8,
+			    header->prefix_pool_off, size))
+    return -1;
+
+  // The paths are delimited by increasing offsets in the pool
+  pool_len= header->values_off-header->prefix_pool_off;
+  if (frozen->prefix_offsets[0] != 0)
+    return -1;
+  for (index= 0; index < header->num_prefixes; index++)
+    if ((frozen->prefix_offsets[index+1] < frozen->prefix_offsets[index]) ||
+	(frozen->prefix_offsets[index+1] > pool_len))
+      return -1;
+
+  if ((_frozen_check_louds(frozen, header->num_nodes) < 0) ||
+      (_frozen_check_bits(frozen->data_bits, frozen->data_rank,
+			  header->num_nodes, header->num_keys) < 0) ||
+      (_frozen_check_bits(frozen->prefix_bits, frozen->prefix_rank,
+			  header->num_nodes, header->num_prefixes) < 0))
+    return -1;
+  return 0;
+}
+
+// -----[ _frozen_build_rank ]---------------------------------------
+static void _frozen_build_rank(const uint64_t * bits, size_t num_words,
+			       uint32_t * rank)
+{
+  uint32_t count= 0;
+  size_t word;
+
+  for (word= 0; word < num_words; word++) {
+    if (word % (_RANK_BLOCK_BITS/64) == 0)
+      rank[word/(_RANK_BLOCK_BITS/64)]= count;
+    count+= __builtin_popcountll(bits[word]);
+  }
+  rank[(num_words+(_RANK_BLOCK_BITS/64)-1)/(_RANK_BLOCK_BITS/64)]= count;
+}
+
+// -----[ _align8 ]--------------------------------------------------
+static inline uint64_t _align8(uint64_t offset)
+{
+  return (offset+7) & ~((uint64_t) 7);
+}
+
+// -----[ trie_dico_freeze ]-----------------------------------------
+gds_trie_dico_frozen_t * trie_dico_freeze(gds_trie_dico_t * trie_dico)
+{
+  gds_trie_dico_frozen_t * frozen;
+  _frozen_header_t header;
+  ptr_array_t * nodes= ptr_array_create_ref(0);
+  _trie_dico_key_buf_t labels;
+  _trie_dico_item_t * item, * child;
+  uint32_t node, num_nodes, num_louds_bits, bit, zeros;
+  uint32_t num_prefix_bytes= 0;
+  uint32_t prefix_index= 0, key_index= 0;
+  size_t num_louds_words, num_node_words;
+  unsigned int iter;
+  uint64_t * louds, * data_bits, * prefix_bits;
+  uint32_t * louds_select, * prefix_offsets;
+  uint8_t c;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, _FROZEN_MAGIC, sizeof(header.magic));
+  header.byte_order= _FROZEN_BYTE_ORDER;
+
+  // Number the nodes in level order. The labels buffer records the
+  // label of the edge towards each node (the root has none).
+  _key_buf_init(&labels);
+  c= 0;
+  if (trie_dico->root != NULL) {
+    ptr_array_append(nodes, trie_dico->root);
+    _key_buf_append(&labels, (char *) &c, 1);
+  }
+  for (node= 0; node < ptr_array_length(nodes); node++) {
+    item= (_trie_dico_item_t *) nodes->data[node];
+    if (item->is_final_data)
+      header.num_keys++;
+    if (item->prefix_len > 0) {
+      header.num_prefixes++;
+      num_prefix_bytes+= item->prefix_len;
+    }
+    iter= 0;
+    while ((child= _trie_dico_next_child(item, &iter, &c)) != NULL) {
+      ptr_array_append(nodes, child);
+      _key_buf_append(&labels, (char *) &c, 1);
+    }
+  }
+  num_nodes= ptr_array_length(nodes);
+  header.num_nodes= num_nodes;
+  num_louds_bits= (num_nodes > 0)?2*num_nodes-1:0;
+  num_louds_words= _bits_words(num_louds_bits);
+  num_node_words= _bits_words(num_nodes);
+
+  // Layout of the image
+  header.louds_off= _align8(sizeof(_frozen_header_t));
+  header.louds_select_off= header.louds_off + num_louds_words*8;
+  header.labels_off=
+    _align8(header.louds_select_off +
+	    (num_nodes/_SELECT_SAMPLE+1)*sizeof(uint32_t));
+  header.data_bits_off= _align8(header.labels_off + num_nodes);
+  header.data_rank_off= header.data_bits_off + num_node_words*8;
+  header.prefix_bits_off=
+    _align8(header.data_rank_off +
+	    (num_nodes/_RANK_BLOCK_BITS+2)*sizeof(uint32_t));
+  header.prefix_rank_off= header.prefix_bits_off + num_node_words*8;
+  header.prefix_offsets_off=
+    _align8(header.prefix_rank_off +
+	    (num_nodes/_RANK_BLOCK_BITS+2)*sizeof(uint32_t));
+  header.prefix_pool_off=
+    header.prefix_offsets_off + (header.num_prefixes+1)*sizeof(uint32_t);
+  header.values_off= _align8(header.prefix_pool_off + num_prefix_bytes);
+  header.size= header.values_off + header.num_keys*sizeof(uint64_t);
+
+  frozen= (gds_trie_dico_frozen_t *) MALLOC(sizeof(gds_trie_dico_frozen_t));
+  frozen->image= (uint8_t *) MALLOC(header.size);
+  frozen->mapped= 0;
+  memset(frozen->image, 0, header.size);
+  memcpy(frozen->image, &header, sizeof(header));
+  _frozen_bind(frozen);
+
+  louds= (uint64_t *) (frozen->image + header.louds_off);
+  louds_select= (uint32_t *) (frozen->image + header.louds_select_off);
+  data_bits= (uint64_t *) (frozen->image + header.data_bits_off);
+  prefix_bits= (uint64_t *) (frozen->image + header.prefix_bits_off);
+  prefix_offsets= (uint32_t *) (frozen->image + header.prefix_offsets_off);
+  if (num_nodes > 0)
+    memcpy(frozen->image + header.labels_off, labels.data, num_nodes);
+  _key_buf_done(&labels);
+
+  bit= 0;
+  zeros= 0;
+  for (node= 0; node < num_nodes; node++) {
+    item= (_trie_dico_item_t *) nodes->data[node];
+
+    // Degree in unary (the last 0 is implicit)
+    bit+= item->num_children;
+    if (node < num_nodes-1) {
+      if (zeros % _SELECT_SAMPLE == 0)
+	louds_select[zeros/_SELECT_SAMPLE]= bit;
+      zeros++;
+    }
+    bit++;
+
+    if (item->is_final_data) {
+      _bits_set(data_bits, node);
+      ((uint64_t *) frozen->values)[key_index++]= (uint64_t) (size_t) item->data;
+    }
+    if (item->prefix_len > 0) {
+      _bits_set(prefix_bits, node);
+      memcpy((char *) frozen->prefix_pool + prefix_offsets[prefix_index],
+	     item->prefix, item->prefix_len);
+      prefix_offsets[prefix_index+1]=
+	prefix_offsets[prefix_index] + item->prefix_len;
+      prefix_index++;
+    }
+  }
+  // Set the 1s of the unary degrees
+  bit= 0;
+  for (node= 0; node < num_nodes; node++) {
+    item= (_trie_dico_item_t *) nodes->data[node];
+    for (iter= 0; iter < item->num_children; iter++)
+      _bits_set(louds, bit++);
+    bit++;
+  }
+  _frozen_build_rank(data_bits, num_node_words,
+		     (uint32_t *) (frozen->image + header.data_rank_off));
+  _frozen_build_rank(prefix_bits, num_node_words,
+		     (uint32_t *) (frozen->image + header.prefix_rank_off));
+
+  ptr_array_destroy(&nodes);
+  return frozen;
+}
+
+// -----[ trie_dico_frozen_destroy ]---------------------------------
+void trie_dico_frozen_destroy(gds_trie_dico_frozen_t ** frozen_ref)
+{
+  gds_trie_dico_frozen_t * frozen= *frozen_ref;
+
+  if (frozen != NULL) {
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+    if (frozen->mapped)
+      munmap(frozen->image, frozen->header->size);
+    else
+#endif
+      FREE(frozen->image);
+    FREE(frozen);
+    *frozen_ref= NULL;
+  }
+}
+
+// -----[ trie_dico_frozen_find_exact ]------------------------------
+void * trie_dico_frozen_find_exact(gds_trie_dico_frozen_t * frozen,
+				   trie_dico_key_t key)
+{
+  const char * prefix;
+  uint32_t prefix_len;
+  uint32_t node= 0;
+  void * data;
+
+  if (frozen->header->num_nodes == 0)
+    return NULL;
+
+  while (1) {
+    prefix_len= _frozen_prefix(frozen, node, &prefix);
+    if (_frozen_prefix_match(prefix, prefix_len, key) < prefix_len)
+      return NULL;
+    key+= prefix_len;
+    if (*key == '\0') {
+      if (_frozen_data(frozen, node, &data))
+	return data;
+      return NULL;
+    }
+    node= _frozen_find_child(frozen, node, (uint8_t) *key);
+    if (node == 0)
+      return NULL;
+    key++;
+  }
+}
+
+// -----[ trie_dico_frozen_find_best ]-------------------------------
+void * trie_dico_frozen_find_best(gds_trie_dico_frozen_t * frozen,
+				  trie_dico_key_t key)
+{
+  const char * prefix;
+  uint32_t prefix_len;
+  uint32_t node= 0;
+  void * best= NULL;
+  void * data;
+
+  if (frozen->header->num_nodes == 0)
+    return NULL;
+
+  while (1) {
+    prefix_len= _frozen_prefix(frozen, node, &prefix);
+    if (_frozen_prefix_match(prefix, prefix_len, key) < prefix_len)
+      break;
+    key+= prefix_len;
+    if (_frozen_data(frozen, node, &data))
+      best= data;
+    if (*key == '\0')
+      break;
+    node= _frozen_find_child(frozen, node, (uint8_t) *key);
+    if (node == 0)
+      break;
+    key++;
+  }
+  return best;
+}
+
+// -----[ _frozen_for_each ]-----------------------------------------
+static int _frozen_for_each(const gds_trie_dico_frozen_t * frozen,
+			    uint32_t node, _trie_dico_walk_t * walk)
+{
+  const char * prefix;
+  uint32_t prefix_len= _frozen_prefix(frozen, node, &prefix);
+  uint32_t first, degree, child;
+  size_t key_len;
+  void * data;
+  int result;
+
+  _key_buf_append(&walk->key, prefix, prefix_len);
+  key_len= walk->key.len;
+
+  if (_frozen_data(frozen, node, &data)) {
+    result= walk->foreach(walk->key.data, data, walk->ctx);
+    if (result != 0)
+      return result;
+    walk->count++;
+  }
+
+  degree= _frozen_children(frozen, node, &first);
+  for (child= first; child < first+degree; child++) {
+    if ((walk->limit > 0) && (walk->count >= walk->limit))
+      break;
+    _key_buf_append(&walk->key, (char *) &frozen->labels[child], 1);
+    result= _frozen_for_each(frozen, child, walk);
+    if (result != 0)
+      return result;
+    _key_buf_truncate(&walk->key, key_len);
+  }
+  return 0;
+}
+
+// -----[ trie_dico_frozen_for_each_prefix ]-------------------------
+int trie_dico_frozen_for_each_prefix(gds_trie_dico_frozen_t * frozen,
+				     trie_dico_key_t prefix,
+				     unsigned int limit,
+				     gds_trie_dico_foreach_f foreach,
+				     void * ctx)
+{
+  _trie_dico_walk_t walk;
+  const char * node_prefix;
+  uint32_t node_prefix_len, match;
+  uint32_t node= 0;
+  int result= 0;
+
+  if (frozen->header->num_nodes == 0)
+    return 0;
+
+  walk.foreach= foreach;
+  walk.ctx= ctx;
+  walk.limit= limit;
+  walk.count= 0;
+  _key_buf_init(&walk.key);
+
+  // Descend to the highest node whose keys all start with the prefix
+  while (1) {
+    node_prefix_len= _frozen_prefix(frozen, node, &node_prefix);
+    match= _frozen_prefix_match(node_prefix, node_prefix_len, prefix);
+    if (prefix[match] == '\0') {
+      result= _frozen_for_each(frozen, node, &walk);
+      break;
+    }
+    if (match < node_prefix_len)
+      break;
+    _key_buf_append(&walk.key, node_prefix, node_prefix_len);
+    prefix+= match;
+    node= _frozen_find_child(frozen, node, (uint8_t) *prefix);
+    if (node == 0)
+      break;
+    _key_buf_append(&walk.key, prefix, 1);
+    prefix++;
+  }
+
+  _key_buf_done(&walk.key);
+  return result;
+}
+
+// -----[ trie_dico_frozen_num_keys ]--------------------------------
+unsigned int trie_dico_frozen_num_keys(gds_trie_dico_frozen_t * frozen)
+{
+  return frozen->header->num_keys;
+}
+
+// -----[ trie_dico_frozen_size ]------------------------------------
+size_t trie_dico_frozen_size(gds_trie_dico_frozen_t * frozen)
+{
+  return (size_t) frozen->header->size;
+}
+
+// -----[ trie_dico_frozen_save ]------------------------------------
+int trie_dico_frozen_save(gds_trie_dico_frozen_t * frozen,
+			  const char * filename)
+{
+  FILE * file= fopen(filename, "wb");
+  size_t size= (size_t) frozen->header->size;
+  int result= 0;
+
+  if (file == NULL)
+    return -1;
+  if (fwrite(frozen->image, 1, size, file) != size)
+    result= -1;
+  if (fclose(file) != 0)
+    result= -1;
+  return result;
+}
+
+// -----[ trie_dico_frozen_load ]------------------------------------
+gds_trie_dico_frozen_t * trie_dico_frozen_load(const char * filename)
+{
+  gds_trie_dico_frozen_t * frozen;
+  _frozen_header_t header;
+  uint8_t * image;
+  struct stat st;
+  int fd;
+
+  fd= open(filename, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  if ((fstat(fd, &st) != 0) ||
+      (st.st_size < (off_t) sizeof(header)) ||
+      (read(fd, &header, sizeof(header)) != sizeof(header)) ||
+      (memcmp(header.magic, _FROZEN_MAGIC, sizeof(header.magic)) != 0) ||
+      (header.byte_order != _FROZEN_BYTE_ORDER) ||
+      (header.size != (uint64_t) st.st_size)) {
+    close(fd);
+    return NULL;
+  }
+
+  frozen= (gds_trie_dico_frozen_t *) MALLOC(sizeof(gds_trie_dico_frozen_t));
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+  image= (uint8_t *) mmap(NULL, (size_t) header.size, PROT_READ,
+			  MAP_SHARED, fd, 0);
+  if (image == MAP_FAILED) {
+    FREE(frozen);
+    close(fd);
+    return NULL;
+  }
+  frozen->mapped= 1;
+#else
+  image= (uint8_t *) MALLOC((size_t) header.size);
+  if ((lseek(fd, 0, SEEK_SET) != 0) ||
+      (read(fd, image, (size_t) header.size) != (ssize_t) header.size)) {
+    FREE(image);
+    FREE(frozen);
+    close(fd);
+    return NULL;
+  }
+  frozen->mapped= 0;
+#endif
+  close(fd);
+  frozen->image= image;
+  _frozen_bind(frozen);
+  if (_frozen_check(frozen) < 0) {
+    trie_dico_frozen_destroy(&frozen);
+    return NULL;
+  }
+  return frozen;
+}
@@ -38,10 +38,23 @@ typedef void (*gds_trie_dico_destroy_f) (void ** data);
  * Trie data structure.
  */
 typedef struct gds_trie_dico_t {
-  struct _trie_dico_item_t * root;
-  gds_trie_dico_destroy_f    destroy;
+  struct _trie_dico_item_t  * root;
+  gds_trie_dico_destroy_f     destroy;
+  struct _trie_dico_block_t * blocks;
 } gds_trie_dico_t;
 
+// -----[ gds_trie_dico_bulk_item_t ]--------------------------------
+/**
+ * Item of an array passed to \c trie_dico_bulk_load.
+ */
+typedef struct {
+  trie_dico_key_t   key;
+  void            * data;
+} gds_trie_dico_bulk_item_t;
+
+/** Immutable, compact form of a trie_dico. */
+typedef struct gds_trie_dico_frozen_t gds_trie_dico_frozen_t;
+
 #ifdef	__cplusplus
 extern "C" {
 #endif
@@ -112,6 +125,33 @@ extern "C" {
   int trie_dico_insert(gds_trie_dico_t * trie_dico, trie_dico_key_t key,
 		       void * data, int replace);
 
+  // -----[ trie_dico_bulk_load ]----------------------------------------
+  /**
+   * Load an array of items in a trie_dico.
+   *
+   * If the trie_dico is empty, it is built bottom-up, with all its
+   * nodes and compressed paths allocated in one contiguous block.
+   * The build is fastest when the items are sorted by key (\c strcmp
+   * order). Otherwise, a sorted copy of the array is made. The array
+   * itself is never modified. Keys are copied.
+   *
+   * If the trie_dico is not empty, the items are inserted one by
+   * one with \c trie_dico_insert. The load stops at the first key
+   * that is already in the trie_dico (including a key that appears
+   * earlier in the array). The items that precede it remain loaded
+   * and the existing keys are left unchanged.
+   *
+   * \param trie_dico is the trie_dico.
+   * \param items     is the array of items.
+   * \param num_items is the number of items.
+   * \retval TRIE_DICO_SUCCESS in case of success, or
+   *   TRIE_DICO_ERROR_DUPLICATE if a key appears more than once (in
+   *   an empty trie_dico, nothing is loaded in this case).
+   */
+  int trie_dico_bulk_load(gds_trie_dico_t * trie_dico,
+			  const gds_trie_dico_bulk_item_t * items,
+			  unsigned int num_items);
+
   // -----[ trie_dico_remove ]--------------------------------------------
   /**
    * Remove a key from a trie_dico.
@@ -144,7 +184,10 @@ extern "C" {
    * Traverse a whole trie_dico.
    *
    * For each non empty node in the trie_dico, the provided \a foreach
-   * callback function will be called.
+   * callback function will be called. Keys are traversed in
+   * lexicographic order. Keys are not stored in the trie_dico: the
+   * key passed to the callback is rebuilt in a temporary buffer that
+   * is only valid during the call.
    *
    * \param trie_dico is the trie_dico.
    * \param foreach is the callback function.
@@ -158,6 +201,63 @@ extern "C" {
 			 gds_trie_dico_foreach_f foreach,
 			 void * ctx);
 
+  // -----[ trie_dico_for_each_prefix ]----------------------------------
+  /**
+   * Traverse the keys of a trie_dico that start with a given prefix.
+   *
+   * The traversal directly descends to the node that holds the
+   * prefix, then calls \a foreach for each key below in
+   * lexicographic order. The key passed to the callback is only
+   * valid during the call.
+   *
+   * \param trie_dico is the trie_dico.
+   * \param prefix    is the prefix ("" matches all the keys).
+   * \param limit     is the maximum number of keys to traverse
+   *   (0 means no limit).
+   * \param foreach   is the callback function.
+   * \param ctx       is the callback context pointer.
+   * \retval 0 in case all calls to \a foreach succeeded, or the
+   *   first non-zero value returned by \a foreach.
+   */
+  int trie_dico_for_each_prefix(gds_trie_dico_t * trie_dico,
+				trie_dico_key_t prefix,
+				unsigned int limit,
+				gds_trie_dico_foreach_f foreach,
+				void * ctx);
+
+  // -----[ trie_dico_get_prefix_enum ]----------------------------------
+  /**
+   * Return a lazy enumeration of the keys that start with a given
+   * prefix.
+   *
+   * Items are produced in lexicographic key order, one at a time,
+   * without building an intermediate array. Each element is a
+   * pointer to the data associated with a key.
+   *
+   * The trie_dico must not be modified while the enumeration is in
+   * use.
+   *
+   * \param trie_dico is the trie_dico.
+   * \param prefix    is the prefix ("" matches all the keys).
+   * \param limit     is the maximum number of items to enumerate
+   *   (0 means no limit).
+   */
+  gds_enum_t * trie_dico_get_prefix_enum(gds_trie_dico_t * trie_dico,
+					 trie_dico_key_t prefix,
+					 unsigned int limit);
+
+  // -----[ trie_dico_enum_get_key ]-------------------------------------
+  /**
+   * Return the key of the last item returned by an enumeration
+   * obtained with \c trie_dico_get_prefix_enum or
+   * \c trie_dico_get_enum.
+   *
+   * \retval the key, or NULL if no item was returned yet. The key is
+   *   only valid until the next call to \c enum_has_next or
+   *   \c enum_get_next.
+   */
+  trie_dico_key_t trie_dico_enum_get_key(gds_enum_t * enu);
+
   // -----[ trie_dico_get_array ]-----------------------------------------
   /**
    * Return an array with the items in the trie_dico.
@@ -166,7 +266,9 @@ extern "C" {
 
   // -----[ trie_dico_get_enum ]------------------------------------------
   /**
-   * Return an enumeration for items in the trie_dico.
+   * Return an enumeration for items in the trie_dico. This is the
+   * lazy enumeration of all the keys, in lexicographic order (see
+   * \c trie_dico_get_prefix_enum).
    */
   gds_enum_t * trie_dico_get_enum(gds_trie_dico_t * trie_dico);
 
@@ -189,6 +291,95 @@ extern "C" {
   void trie_dico_to_graphviz(gds_stream_t * stream,
 			     gds_trie_dico_t * trie_dico);
 
+  ///////////////////////////////////////////////////////////////////
+  // FROZEN DICTIONARY
+  ///////////////////////////////////////////////////////////////////
+
+  // -----[ trie_dico_freeze ]-------------------------------------------
+  /**
+   * Build an immutable, compact copy of a trie_dico.
+   *
+   * The frozen dictionary is stored in a single pointer-free memory
+   * block (LOUDS tree encoding with rank/select directories). It
+   * supports exact, best match and prefix lookups and can be saved
+   * to a file then mapped back with \c trie_dico_frozen_load.
+   *
+   * Data pointers are stored as 64-bit integers. A saved frozen
+   * dictionary is only meaningful for data that does not depend on
+   * the address space (e.g. integers or offsets). Files use the
+   * native byte order.
+   *
+   * \param trie_dico is the source trie_dico (not modified).
+   * \retval a new frozen dictionary.
+   */
+  gds_trie_dico_frozen_t * trie_dico_freeze(gds_trie_dico_t * trie_dico);
+
+  // -----[ trie_dico_frozen_destroy ]-----------------------------------
+  /**
+   * Destroy a frozen dictionary (or unmap it if it was loaded from a
+   * file). Data items are not destroyed.
+   */
+  void trie_dico_frozen_destroy(gds_trie_dico_frozen_t ** frozen_ref);
+
+  // -----[ trie_dico_frozen_find_exact ]--------------------------------
+  /**
+   * Perform an exact match lookup in a frozen dictionary.
+   */
+  void * trie_dico_frozen_find_exact(gds_trie_dico_frozen_t * frozen,
+				     trie_dico_key_t key);
+
+  // -----[ trie_dico_frozen_find_best ]---------------------------------
+  /**
+   * Perform a best match lookup in a frozen dictionary.
+   */
+  void * trie_dico_frozen_find_best(gds_trie_dico_frozen_t * frozen,
+				    trie_dico_key_t key);
+
+  // -----[ trie_dico_frozen_for_each_prefix ]---------------------------
+  /**
+   * Traverse the keys of a frozen dictionary that start with a given
+   * prefix, in lexicographic order. Same semantics as
+   * \c trie_dico_for_each_prefix.
+   */
+  int trie_dico_frozen_for_each_prefix(gds_trie_dico_frozen_t * frozen,
+				       trie_dico_key_t prefix,
+				       unsigned int limit,
+				       gds_trie_dico_foreach_f foreach,
+				       void * ctx);
+
+  // -----[ trie_dico_frozen_num_keys ]----------------------------------
+  /**
+   * Return the number of keys in a frozen dictionary.
+   */
+  unsigned int trie_dico_frozen_num_keys(gds_trie_dico_frozen_t * frozen);
+
+  // -----[ trie_dico_frozen_size ]--------------------------------------
+  /**
+   * Return the size in bytes of the frozen dictionary image.
+   */
+  size_t trie_dico_frozen_size(gds_trie_dico_frozen_t * frozen);
+
+  // -----[ trie_dico_frozen_save ]--------------------------------------
+  /**
+   * Write a frozen dictionary to a file.
+   *
+   * \retval 0 in case of success, or <0 in case of error.
+   */
+  int trie_dico_frozen_save(gds_trie_dico_frozen_t * frozen,
+			    const char * filename);
+
+  // -----[ trie_dico_frozen_load ]--------------------------------------
+  /**
+   * Load a frozen dictionary from a file.
+   *
+   * When mmap() is available, the file is mapped read-only and
+   * queried in place, without any deserialization.
+   *
+   * \retval the frozen dictionary, or NULL if the file could not be
+   *   read or is not a valid frozen dictionary.
+   */
+  gds_trie_dico_frozen_t * trie_dico_frozen_load(const char * filename);
+
 #ifdef __cplusplus
 }
 #endif